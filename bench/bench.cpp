@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include <json.h>
+#include <thread.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <unistd.h>
+
+#ifndef SPL_BENCH_COMMIT
+#define SPL_BENCH_COMMIT "unknown"
+#endif
+
+using namespace bench;
+using namespace spl;
+
+using Key = std::tuple<std::string, size_t, size_t>;
+
+std::vector<Benchmark *> & bench::registry() {
+    static std::vector<Benchmark *> benchmarks;
+    return benchmarks;
+}
+
+Benchmark & bench::add(const char *module, const char *name) {
+    registry().push_back(new Benchmark(module, name));
+    return *registry().back();
+}
+
+static std::string __cpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+static std::string __hostname() {
+    char name[256] = { };
+    gethostname(name, sizeof(name) - 1);
+    return name;
+}
+
+// reads the medians of a previous run, keyed by name, size and threads
+static std::map<Key, double> __readBaseline(const char *path) {
+    std::map<Key, double> medians;
+    std::ifstream in(path);
+    if (! in) throw DynamicMessageError("Cannot open baseline '", path, "'");
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+
+        JSONReader reader(line.data(), line.size());
+        std::string key, type, name;
+        size_t size = 0, threads = 0;
+        double median = 0;
+        JSONReader::Event e;
+        while ((e = reader.next()) != JSONReader::END) {
+            if (e == JSONReader::KEY) key = reader.value().str();
+            else if (e == JSONReader::STRING && key == "type") type = reader.value().str();
+            else if (e == JSONReader::STRING && key == "name") name = reader.value().str();
+            else if (e == JSONReader::NUMBER && key == "size") size = reader.number<size_t>();
+            else if (e == JSONReader::NUMBER && key == "threads") threads = reader.number<size_t>();
+            else if (e == JSONReader::NUMBER && key == "median_ns") median = reader.number<double>();
+        }
+        if (type == "result") medians[Key(name, size, threads)] = median;
+    }
+    return medians;
+}
+
+// a JSON object written on a single line
+class __Line {
+
+private:
+
+    std::string _str = "{";
+
+public:
+
+    template <typename T>
+    __Line & add(const char *key, const T &val) {
+        if (_str.size() > 1) _str += ", ";
+        _str += JSON::encode(key);
+        _str += ": ";
+        _str += JSON::encode(val);
+        return *this;
+    }
+
+    void print() const {
+        printf("%s}\n", _str.c_str());
+        fflush(stdout);
+    }
+};
+
+static void __usage(const char *argv0) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --filter SUBSTRING    run only benchmarks whose name contains SUBSTRING\n"
+        "  --repetitions N       measured repetitions per configuration (default = 5)\n"
+        "  --compare FILE        report speedups over the results in FILE\n"
+        "  --oversubscribe       also run thread counts above the number of CPUs\n"
+        "  --list                list the benchmarks and exit\n",
+        argv0
+    );
+}
+
+Runner::Result Runner::_run(const Benchmark &b, size_t size, size_t threads, size_t repetitions) {
+    Result result;
+    for (size_t r = 0; r <= repetitions; ++r) {
+        State state(size, threads);
+        uint64_t begin = State::now();
+        b._body(state);
+        uint64_t end = State::now();
+        if (state._start != 0) begin = state._start;
+        if (state._stop != 0) end = state._stop;
+
+        // the first run warms up caches, allocators and lazily started threads
+        if (r == 0) continue;
+        result.ops = state._ops;
+        result.bytes = state._bytes;
+        result.nsPerOp.push_back((double) (end - begin) / state._ops);
+        result.samples.insert(result.samples.end(), state._samples.begin(), state._samples.end());
+    }
+    std::sort(result.nsPerOp.begin(), result.nsPerOp.end());
+    std::sort(result.samples.begin(), result.samples.end());
+    return result;
+}
+
+int Runner::main(int argc, const char * const *argv) {
+    const char *filter = "";
+    const char *compare = nullptr;
+    size_t repetitions = 5;
+    bool oversubscribe = false;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasParam = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasParam) filter = argv[++i];
+        else if (strcmp(argv[i], "--compare") == 0 && hasParam) compare = argv[++i];
+        else if (strcmp(argv[i], "--repetitions") == 0 && hasParam) repetitions = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--oversubscribe") == 0) oversubscribe = true;
+        else if (strcmp(argv[i], "--list") == 0) list = true;
+        else {
+            __usage(argv[0]);
+            return 1;
+        }
+    }
+    if (repetitions == 0) repetitions = 1;
+
+    if (list) {
+        for (const Benchmark *b : registry()) printf("%s\n", b->fullName().c_str());
+        return 0;
+    }
+
+    std::map<Key, double> baseline;
+    if (compare != nullptr) {
+        try {
+            baseline = __readBaseline(compare);
+        }
+        catch (const std::exception &e) {
+            fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+
+    size_t cpus = Thread::availableCPUs();
+    __Line()
+        .add("type", "context")
+        .add("commit", SPL_BENCH_COMMIT)
+        .add("host", __hostname())
+        .add("cpu", __cpuModel())
+        .add("cpus", cpus)
+        .add("compiler", __VERSION__)
+        .add("timestamp", (uint64_t) time(nullptr))
+        .add("repetitions", repetitions)
+        .print();
+
+    for (const Benchmark *b : registry()) {
+        std::string name = b->fullName();
+        if (name.find(filter) == std::string::npos) continue;
+
+        for (size_t size : b->_sizes) {
+            for (size_t threads : b->_threads) {
+                if (threads > cpus && ! oversubscribe) continue;
+
+                Result r = _run(*b, size, threads, repetitions);
+                double median = r.nsPerOp[r.nsPerOp.size() / 2];
+
+                __Line line;
+                line.add("type", "result")
+                    .add("name", name)
+                    .add("size", size)
+                    .add("threads", threads)
+                    .add("ops", r.ops)
+                    .add("median_ns", median)
+                    .add("min_ns", r.nsPerOp.front())
+                    .add("max_ns", r.nsPerOp.back())
+                    .add("ops_per_sec", 1e9 / median);
+
+                if (r.bytes != 0) {
+                    line.add("bytes_per_sec", r.bytes * 1e9 / (median * r.ops));
+                }
+                if (! r.samples.empty()) {
+                    const auto &x = r.samples;
+                    line.add("samples", x.size())
+                        .add("p50_ns", x[x.size() / 2])
+                        .add("p90_ns", x[x.size() * 9 / 10])
+                        .add("p99_ns", x[x.size() * 99 / 100])
+                        .add("p999_ns", x[x.size() * 999 / 1000])
+                        .add("max_sample_ns", x.back());
+                }
+
+                auto it = baseline.find(Key(name, size, threads));
+                if (it != baseline.end()) {
+                    line.add("baseline_median_ns", it->second)
+                        .add("speedup", it->second / median);
+                }
+                line.print();
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    return Runner::main(argc, argv);
+}
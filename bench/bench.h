@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief The parameters and measurements of a single benchmark run.
+ *
+ * A run is timed from start() to stop(). Bodies that do not call them are
+ * timed as a whole, so only bodies with setup or teardown worth excluding
+ * need to mark their measured region. Bodies that measure individual
+ * operations, such as request round trips, also record them with sample()
+ * to have their latency percentiles reported.
+ */
+class State {
+
+    friend class Runner;
+
+private:
+
+    size_t _size;
+    size_t _threads;
+    size_t _ops;
+    size_t _bytes = 0;
+    uint64_t _start = 0;
+    uint64_t _stop = 0;
+    std::vector<uint64_t> _samples;
+
+public:
+
+    /**
+     * @return The current time in nanoseconds, for timing samples.
+     */
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    State(size_t size, size_t threads)
+    :   _size(size),
+        _threads(threads),
+        _ops(size > 0 ? size : 1)
+    { }
+
+    /**
+     * @return The problem size of this run, or 0 if the benchmark is not
+     * parameterized by size.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @return The number of threads of this run.
+     */
+    size_t threads() const {
+        return _threads;
+    }
+
+    /**
+     * @brief Begins the measured region.
+     */
+    void start() {
+        _start = now();
+    }
+
+    /**
+     * @brief Ends the measured region.
+     */
+    void stop() {
+        _stop = now();
+    }
+
+    /**
+     * @brief Sets the number of operations performed by the measured region,
+     * which results are normalized by. (default = size(), or 1 if the
+     * benchmark is not parameterized by size)
+     *
+     * @param ops The number of operations.
+     */
+    void setOps(size_t ops) {
+        _ops = ops;
+    }
+
+    /**
+     * @brief Sets the number of bytes processed by the measured region, to
+     * have the throughput in bytes per second reported.
+     *
+     * @param bytes The number of bytes.
+     */
+    void setBytes(size_t bytes) {
+        _bytes = bytes;
+    }
+
+    /**
+     * @brief Records the duration of a single operation.
+     *
+     * @param nanos The duration in nanoseconds.
+     */
+    void sample(uint64_t nanos) {
+        _samples.push_back(nanos);
+    }
+};
+
+/**
+ * @brief A registered benchmark, run once for every combination of its sizes
+ * and thread counts.
+ */
+class Benchmark {
+
+    friend class Runner;
+
+private:
+
+    std::string _module;
+    std::string _name;
+    std::vector<size_t> _sizes = { 0 };
+    std::vector<size_t> _threads = { 1 };
+    std::function<void(State &)> _body;
+
+public:
+
+    Benchmark(const char *module, const char *name)
+    :   _module(module),
+        _name(name)
+    { }
+
+    /**
+     * @brief Sets the problem sizes to run the benchmark with.
+     */
+    Benchmark & sizes(const std::initializer_list<size_t> &sizes) {
+        _sizes = sizes;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the thread counts to run the benchmark with. Counts larger
+     * than the number of available CPUs are skipped.
+     */
+    Benchmark & threads(const std::initializer_list<size_t> &threads) {
+        _threads = threads;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the body of the benchmark.
+     */
+    Benchmark & body(const std::function<void(State &)> &body) {
+        _body = body;
+        return *this;
+    }
+
+    /**
+     * @return The full name of the benchmark, module/name.
+     */
+    std::string fullName() const {
+        return _module + "/" + _name;
+    }
+};
+
+/**
+ * @return All registered benchmarks, in registration order.
+ */
+std::vector<Benchmark *> & registry();
+
+/**
+ * @brief Registers a new benchmark.
+ */
+Benchmark & add(const char *module, const char *name);
+
+/**
+ * @brief Prevents the compiler from optimizing away a computed value.
+ */
+template <typename T>
+inline void doNotOptimize(const T &val) {
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+/**
+ * @brief Runs the registered benchmarks and reports their results.
+ */
+class Runner {
+
+private:
+
+    struct Result {
+        size_t ops;
+        size_t bytes;
+        std::vector<double> nsPerOp;    // one per repetition, sorted
+        std::vector<uint64_t> samples;  // of all repetitions, sorted
+    };
+
+    static Result _run(const Benchmark &b, size_t size, size_t threads, size_t repetitions);
+
+public:
+
+    /**
+     * @brief Parses the command line, then runs every matching benchmark once
+     * as a warm-up and then repeatedly for each combination of its sizes and
+     * thread counts, writing one result per line to stdout.
+     *
+     * @return The exit status.
+     */
+    static int main(int argc, const char * const *argv);
+};
+
+} // namespace bench
+
+#define __BENCH_CAT2(a, b) a##b
+#define __BENCH_CAT(a, b) __BENCH_CAT2(a, b)
+
+/**
+ * @brief Registers a benchmark, configured by chaining sizes(), threads() and
+ * body().
+ */
+#define benchmark(module, name) \
+    static bench::Benchmark &__BENCH_CAT(__benchmark_, __COUNTER__) = bench::add(module, name)
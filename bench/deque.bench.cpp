@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include <deque.h>
+#include <core/parallel.h>
+
+using namespace spl;
+
+benchmark("deque", "enqueue-dequeue")
+.sizes({ 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    Deque<uint64_t> q;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < s.size(); ++i) q.enqueue(i);
+    for (size_t i = 0; i < s.size(); ++i) sum += q.dequeue();
+    bench::doNotOptimize(sum);
+});
+
+// half of the threads produce and the other half consume, each handling an
+// equal share of the elements
+benchmark("parallel::deque", "producer-consumer")
+.sizes({ 1000 * 1000 })
+.threads({ 2, 4, 8, 16 })
+.body([] (bench::State &s) {
+    parallel::Deque<uint64_t> q;
+    size_t pairs = s.threads() / 2;
+    size_t share = s.size() / pairs;
+    s.setOps(share * pairs);
+
+    core::parallelFor(2 * pairs, 2 * pairs, [&q, pairs, share] (size_t p) {
+        if (p < pairs) {
+            for (size_t i = 0; i < share; ++i) q.enqueue(i);
+        }
+        else {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < share; ++i) sum += q.dequeue();
+            bench::doNotOptimize(sum);
+        }
+    });
+});
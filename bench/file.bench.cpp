@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include "io.h"
+#include <file.h>
+
+using namespace spl;
+
+#define FILE_SIZE (64 * 1024 * 1024)
+#define RECORD_SIZE (1024)
+
+// File writes go to the page cache and are not synced, so these measure the
+// cost of the serializers and system calls rather than of the device. Sizes
+// are serializer buffer sizes.
+
+static File __tempFile() {
+    File f(File::uniquePath(".", "spl-bench-"));
+    f.open(File::READ_WRITE | File::CREATE);
+    f.close();
+    return f;
+}
+
+static void __writeRecords(const File &f, size_t bufferSize) {
+    std::vector<uint8_t> record(RECORD_SIZE, 0x5a);
+    OutputFileSerializer out(f, SIZE_MAX, bufferSize);
+    for (size_t i = 0; i < FILE_SIZE / RECORD_SIZE; ++i) out.put(record.data(), RECORD_SIZE);
+    out.flush();
+}
+
+template <typename In>
+static void __readRecords(In &in) {
+    std::vector<uint8_t> record(RECORD_SIZE);
+    for (size_t i = 0; i < FILE_SIZE / RECORD_SIZE; ++i) in.get(record.data(), RECORD_SIZE);
+}
+
+benchmark("file", "write")
+.sizes({ 4 * 1024, 64 * 1024, 1024 * 1024 })
+.body([] (bench::State &s) {
+    File f = __tempFile();
+    s.start();
+    __writeRecords(f, s.size());
+    s.stop();
+    s.setOps(FILE_SIZE / RECORD_SIZE);
+    s.setBytes(FILE_SIZE);
+    f.remove();
+});
+
+benchmark("file", "read")
+.sizes({ 4 * 1024, 64 * 1024, 1024 * 1024 })
+.body([] (bench::State &s) {
+    File f = __tempFile();
+    __writeRecords(f, 1024 * 1024);
+    InputFileSerializer in(f, s.size());
+    s.start();
+    __readRecords(in);
+    s.stop();
+    s.setOps(FILE_SIZE / RECORD_SIZE);
+    s.setBytes(FILE_SIZE);
+    f.remove();
+});
+
+benchmark("file", "read(readahead)")
+.sizes({ 4 * 1024, 64 * 1024, 1024 * 1024 })
+.body([] (bench::State &s) {
+    File f = __tempFile();
+    __writeRecords(f, 1024 * 1024);
+    InputFileSerializer in(f, s.size(), true);
+    s.start();
+    __readRecords(in);
+    s.stop();
+    s.setOps(FILE_SIZE / RECORD_SIZE);
+    s.setBytes(FILE_SIZE);
+    f.remove();
+});
+
+benchmark("file", "write-graph")
+.sizes({ 100 * 1000 })
+.body([] (bench::State &s) {
+    auto g = bench::graph(s.size());
+    File f = __tempFile();
+    s.start();
+    OutputFileSerializer out(f, SIZE_MAX, 64 * 1024);
+    out << g;
+    out.flush();
+    s.stop();
+    s.setBytes(f.info().length());
+    f.remove();
+});
+
+benchmark("file", "read-graph")
+.sizes({ 100 * 1000 })
+.body([] (bench::State &s) {
+    File f = __tempFile();
+    {
+        OutputFileSerializer out(f, SIZE_MAX, 64 * 1024);
+        out << bench::graph(s.size());
+        out.flush();
+    }
+    bench::Graph g;
+    s.start();
+    InputFileSerializer in(f, 64 * 1024);
+    in >> g;
+    s.stop();
+    s.setBytes(f.info().length());
+    f.remove();
+});
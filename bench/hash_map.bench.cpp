@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include <hash_map.h>
+#include <hash_set.h>
+#include <core/parallel.h>
+#include <random>
+
+using namespace spl;
+
+// distinct random keys; the upper half is used for misses
+static std::vector<uint64_t> __keys(size_t n) {
+    std::mt19937_64 rng(n);
+    HashSet<uint64_t> seen(2 * n);
+    std::vector<uint64_t> keys;
+    keys.reserve(2 * n);
+    while (keys.size() < 2 * n) {
+        uint64_t k = rng();
+        if (! seen.contains(k)) {
+            seen.put(k);
+            keys.push_back(k);
+        }
+    }
+    return keys;
+}
+
+benchmark("hash-map", "insert")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    HashMap<uint64_t, uint64_t> m;
+    s.start();
+    for (size_t i = 0; i < s.size(); ++i) m.put(keys[i], i);
+    s.stop();
+});
+
+benchmark("hash-map", "get-hit")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    HashMap<uint64_t, uint64_t> m;
+    for (size_t i = 0; i < s.size(); ++i) m.put(keys[i], i);
+    uint64_t sum = 0;
+    s.start();
+    for (size_t i = 0; i < s.size(); ++i) sum += m.get(keys[i]);
+    s.stop();
+    bench::doNotOptimize(sum);
+});
+
+benchmark("hash-map", "get-miss")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    HashMap<uint64_t, uint64_t> m;
+    for (size_t i = 0; i < s.size(); ++i) m.put(keys[i], i);
+    size_t found = 0;
+    s.start();
+    for (size_t i = s.size(); i < 2 * s.size(); ++i) found += m.contains(keys[i]);
+    s.stop();
+    bench::doNotOptimize(found);
+});
+
+benchmark("hash-map", "erase")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    HashMap<uint64_t, uint64_t> m;
+    for (size_t i = 0; i < s.size(); ++i) m.put(keys[i], i);
+    s.start();
+    for (size_t i = 0; i < s.size(); ++i) m.erase(keys[i]);
+    s.stop();
+});
+
+benchmark("hash-set", "insert")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    HashSet<uint64_t> set;
+    s.start();
+    for (size_t i = 0; i < s.size(); ++i) set.put(keys[i]);
+    s.stop();
+});
+
+benchmark("hash-set", "contains-hit")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    HashSet<uint64_t> set;
+    for (size_t i = 0; i < s.size(); ++i) set.put(keys[i]);
+    size_t found = 0;
+    s.start();
+    for (size_t i = 0; i < s.size(); ++i) found += set.contains(keys[i]);
+    s.stop();
+    bench::doNotOptimize(found);
+});
+
+benchmark("hash-set", "contains-miss")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    HashSet<uint64_t> set;
+    for (size_t i = 0; i < s.size(); ++i) set.put(keys[i]);
+    size_t found = 0;
+    s.start();
+    for (size_t i = s.size(); i < 2 * s.size(); ++i) found += set.contains(keys[i]);
+    s.stop();
+    bench::doNotOptimize(found);
+});
+
+// each thread works on its own contiguous slice of the keys
+template <typename F>
+static void __slices(const bench::State &s, F f) {
+    size_t n = s.size(), t = s.threads();
+    core::parallelFor(t, t, [n, t, &f] (size_t p) {
+        f(n * p / t, n * (p + 1) / t);
+    });
+}
+
+benchmark("parallel::hash-map", "insert")
+.sizes({ 64 * 1000, 1000 * 1000 })
+.threads({ 1, 2, 4, 8, 16 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    parallel::HashMap<uint64_t, uint64_t> m;
+    s.start();
+    __slices(s, [&keys, &m] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) m.put(keys[i], i);
+    });
+    s.stop();
+});
+
+benchmark("parallel::hash-map", "get-hit")
+.sizes({ 64 * 1000, 1000 * 1000 })
+.threads({ 1, 2, 4, 8, 16 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    parallel::HashMap<uint64_t, uint64_t> m;
+    for (size_t i = 0; i < s.size(); ++i) m.put(keys[i], i);
+    s.start();
+    __slices(s, [&keys, &m] (size_t begin, size_t end) {
+        uint64_t sum = 0;
+        for (size_t i = begin; i < end; ++i) sum += m.get(keys[i]);
+        bench::doNotOptimize(sum);
+    });
+    s.stop();
+});
+
+benchmark("parallel::hash-map", "get-miss")
+.sizes({ 64 * 1000, 1000 * 1000 })
+.threads({ 1, 2, 4, 8, 16 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    parallel::HashMap<uint64_t, uint64_t> m;
+    for (size_t i = 0; i < s.size(); ++i) m.put(keys[i], i);
+    size_t n = s.size();
+    s.start();
+    __slices(s, [&keys, &m, n] (size_t begin, size_t end) {
+        size_t found = 0;
+        for (size_t i = begin; i < end; ++i) found += m.contains(keys[n + i]);
+        bench::doNotOptimize(found);
+    });
+    s.stop();
+});
+
+benchmark("parallel::hash-map", "erase")
+.sizes({ 64 * 1000, 1000 * 1000 })
+.threads({ 1, 2, 4, 8, 16 })
+.body([] (bench::State &s) {
+    auto keys = __keys(s.size());
+    parallel::HashMap<uint64_t, uint64_t> m;
+    for (size_t i = 0; i < s.size(); ++i) m.put(keys[i], i);
+    s.start();
+    __slices(s, [&keys, &m] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) m.erase(keys[i]);
+    });
+    s.stop();
+});
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include <heap.h>
+#include <random>
+
+using namespace spl;
+
+template <size_t Arity>
+static void __pushPop(bench::State &s) {
+    std::mt19937_64 rng(s.size());
+    std::vector<uint64_t> values(s.size());
+    for (auto &x : values) x = rng();
+
+    Heap<uint64_t, std::less<uint64_t>, Arity> h;
+    uint64_t sum = 0;
+    s.start();
+    for (uint64_t x : values) h.push(x);
+    for (size_t i = 0; i < s.size(); ++i) sum += h.pop();
+    s.stop();
+    bench::doNotOptimize(sum);
+}
+
+benchmark("heap", "push-pop")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body(__pushPop<2>);
+
+benchmark("heap", "push-pop(4-ary)")
+.sizes({ 1000, 64 * 1000, 1000 * 1000 })
+.body(__pushPop<4>);
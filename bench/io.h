@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <hash_map.h>
+#include <list.h>
+#include <serialization.h>
+#include <std_serialization.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief A representative container graph: string keys mapping to lists of
+ * 1 to 16 integers.
+ */
+using Graph = spl::HashMap<std::string, spl::List<int64_t>>;
+
+inline Graph graph(size_t n) {
+    Graph g(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto &l = g["some-key-" + std::to_string(i)];
+        for (size_t j = 0; j <= i % 16; ++j) l.append((int64_t) (i * j));
+    }
+    return g;
+}
+
+/**
+ * @brief An output serializer that collects its data in memory.
+ */
+class MemoryOutputSerializer
+:   public spl::OutputStreamSerializer
+{
+
+private:
+
+    std::vector<uint8_t> _data;
+
+protected:
+
+    void _write(const void *data, size_t len) override {
+        _data.insert(_data.end(), (const uint8_t *) data, (const uint8_t *) data + len);
+    }
+
+public:
+
+    MemoryOutputSerializer(size_t bufferSize)
+    :   OutputStreamSerializer(bufferSize)
+    { }
+
+    const std::vector<uint8_t> & data() {
+        flush();
+        return _data;
+    }
+};
+
+/**
+ * @brief An input serializer that reads from a block of memory.
+ */
+class MemoryInputSerializer
+:   public spl::InputStreamSerializer
+{
+
+private:
+
+    const uint8_t *_data;
+    size_t _len;
+    size_t _pos = 0;
+
+protected:
+
+    size_t _read(void *data, size_t minLen, size_t maxLen) override {
+        size_t l = std::min(maxLen, _len - _pos);
+        if (l < minLen) throw spl::OutOfRangeError();
+        memcpy(data, _data + _pos, l);
+        _pos += l;
+        return l;
+    }
+
+public:
+
+    MemoryInputSerializer(const std::vector<uint8_t> &data, size_t bufferSize)
+    :   InputStreamSerializer(bufferSize),
+        _data(data.data()),
+        _len(data.size())
+    { }
+};
+
+} // namespace bench
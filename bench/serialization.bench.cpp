@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include "io.h"
+
+using namespace spl;
+
+#define BUFFER_SIZE (64 * 1024)
+
+// serialization to memory, measuring the serializers alone
+benchmark("serialization", "serialize-graph")
+.sizes({ 1000, 100 * 1000 })
+.body([] (bench::State &s) {
+    auto g = bench::graph(s.size());
+    bench::MemoryOutputSerializer out(BUFFER_SIZE);
+    s.start();
+    out << g;
+    out.flush();
+    s.stop();
+    s.setBytes(out.data().size());
+});
+
+benchmark("serialization", "deserialize-graph")
+.sizes({ 1000, 100 * 1000 })
+.body([] (bench::State &s) {
+    bench::MemoryOutputSerializer out(BUFFER_SIZE);
+    out << bench::graph(s.size());
+    const auto &data = out.data();
+
+    bench::Graph g;
+    bench::MemoryInputSerializer in(data, BUFFER_SIZE);
+    s.start();
+    in >> g;
+    s.stop();
+    s.setBytes(data.size());
+    if (g.size() != s.size()) throw RuntimeError("Graph mismatch");
+});
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include "io.h"
+#include <tcp_socket.h>
+#include <thread>
+
+using namespace spl;
+
+#define STREAM_SIZE (256 * 1024 * 1024)
+#define RECORD_SIZE (1024)
+#define ROUND_TRIPS (20 * 1000)
+
+// Everything runs over loopback, with the server on a separate thread.
+
+// sizes are serializer buffer sizes
+benchmark("tcp", "stream")
+.sizes({ 4 * 1024, 64 * 1024, 1024 * 1024 })
+.body([] (bench::State &s) {
+    TCPServerSocket server(0, 1);
+    size_t bufferSize = s.size();
+    std::thread receiver([&server, bufferSize] {
+        InputTCPSocketSerializer in(server.accept(), bufferSize);
+        std::vector<uint8_t> record(RECORD_SIZE);
+        for (size_t i = 0; i < STREAM_SIZE / RECORD_SIZE; ++i) in.get(record.data(), RECORD_SIZE);
+    });
+
+    std::vector<uint8_t> record(RECORD_SIZE, 0x5a);
+    OutputTCPSocketSerializer out(TCPSocket(server.address()), bufferSize);
+    s.start();
+    for (size_t i = 0; i < STREAM_SIZE / RECORD_SIZE; ++i) out.put(record.data(), RECORD_SIZE);
+    out.flush();
+    receiver.join();
+    s.stop();
+    s.setOps(STREAM_SIZE / RECORD_SIZE);
+    s.setBytes(STREAM_SIZE);
+});
+
+// sizes are request and response sizes
+benchmark("tcp", "request-response")
+.sizes({ 64, 4 * 1024 })
+.body([] (bench::State &s) {
+    TCPServerSocket server(0, 1);
+    size_t len = s.size();
+    std::thread echo([&server, len] {
+        TCPSocket conn = server.accept();
+        std::vector<uint8_t> msg(len);
+        for (size_t i = 0; i < ROUND_TRIPS; ++i) {
+            conn.recv(msg.data(), len);
+            conn.send(msg.data(), len);
+        }
+    });
+
+    TCPSocket client(server.address());
+    std::vector<uint8_t> msg(len, 0x5a);
+    s.start();
+    for (size_t i = 0; i < ROUND_TRIPS; ++i) {
+        uint64_t t = bench::State::now();
+        client.send(msg.data(), len);
+        client.recv(msg.data(), len);
+        s.sample(bench::State::now() - t);
+    }
+    s.stop();
+    echo.join();
+    s.setOps(ROUND_TRIPS);
+    s.setBytes(2 * len * ROUND_TRIPS);
+});
+
+benchmark("tcp", "graph")
+.sizes({ 100 * 1000 })
+.body([] (bench::State &s) {
+    auto g = bench::graph(s.size());
+    bench::MemoryOutputSerializer sized(64 * 1024);
+    sized << g;
+    s.setBytes(sized.data().size());
+
+    TCPServerSocket server(0, 1);
+    size_t n = s.size();
+    std::thread receiver([&server, n] {
+        bench::Graph g;
+        InputTCPSocketSerializer in(server.accept(), 64 * 1024);
+        in >> g;
+        if (g.size() != n) throw RuntimeError("Graph mismatch");
+    });
+
+    OutputTCPSocketSerializer out(TCPSocket(server.address()), 64 * 1024);
+    s.start();
+    out << g;
+    out.flush();
+    receiver.join();
+    s.stop();
+});
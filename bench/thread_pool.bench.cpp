@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include "bench.h"
+#include <thread_pool.h>
+#include <atomic>
+#include <thread>
+
+using namespace spl;
+
+// time from the first run() until every task has finished
+benchmark("thread-pool", "spawn")
+.sizes({ 100 * 1000 })
+.threads({ 1, 2, 4, 8, 16 })
+.body([] (bench::State &s) {
+    ThreadPool<> pool(s.threads());
+    std::atomic_size_t done(0);
+    s.start();
+    for (size_t i = 0; i < s.size(); ++i) {
+        pool.run([&done] (ExecutionContext &) { ++done; });
+    }
+    while (done != s.size()) std::this_thread::yield();
+    s.stop();
+    pool.terminate();
+});
+
+// two tasks resume each other in turn; every operation is one resume and
+// one suspension
+benchmark("thread-pool", "suspend-resume")
+.sizes({ 100 * 1000 })
+.threads({ 1, 2 })
+.body([] (bench::State &s) {
+    ThreadPool<> pool(s.threads());
+    size_t n = s.size() / 2;
+    ResumeHandle a, b;
+    std::atomic_bool done(false);
+
+    s.start();
+    pool.run([&pool, &a, &b, &done, n] (ExecutionContext &ctx) {
+        a = ctx.resumeHandle();
+        pool.run([&a, &b, n] (ExecutionContext &ctx) {
+            b = ctx.resumeHandle();
+            a();
+            for (size_t i = 0; i < n; ++i) {
+                ctx.suspend();
+                a();
+            }
+        });
+        ctx.suspend();
+        for (size_t i = 0; i < n; ++i) {
+            b();
+            ctx.suspend();
+        }
+        done = true;
+    });
+    while (! done) std::this_thread::yield();
+    s.stop();
+    s.setOps(2 * n);
+    pool.terminate();
+});
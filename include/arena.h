@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception.h>
+
+namespace spl {
+
+/**
+ * @brief A monotonic bump allocator. Memory is carved sequentially out of
+ * large chunks and is never freed individually; reset() makes all of it
+ * available again at once while keeping the chunks for reuse, and the
+ * destructor returns the chunks to the system.
+ *
+ * Containers draw from an arena through ArenaAllocator, which allocates from
+ * the arena that is in scope on the calling thread (see Arena::Scope).
+ */
+class Arena {
+
+private:
+
+    struct Chunk {
+        Chunk *next;
+        size_t size;    // usable bytes following the header
+    };
+
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    size_t _chunkSize;
+    Chunk *_chunks = nullptr;   // in use, most recent first
+    Chunk *_spare = nullptr;    // kept by reset()
+    uintptr_t _ptr = 0;
+    uintptr_t _end = 0;
+    size_t _allocated = 0;
+
+    static Chunk * _newChunk(size_t size);
+
+    void * _allocateSlow(size_t size, size_t align);
+
+public:
+
+    /**
+     * @brief An RAII guard that makes an arena the current arena of the
+     * calling thread for its lifetime. Scopes may be nested.
+     */
+    class Scope {
+    private:
+        Arena *_prev;
+
+    public:
+
+        /**
+         * @brief Construct a new Scope object.
+         *
+         * @param arena The arena to make current.
+         */
+        Scope(Arena &arena);
+
+        Scope(const Scope &) = delete;
+
+        Scope(Scope &&) = delete;
+
+        ~Scope();
+
+        Scope & operator=(const Scope &) = delete;
+
+        Scope & operator=(Scope &&) = delete;
+    };
+
+    /**
+     * @brief Construct a new Arena object.
+     *
+     * @param chunkSize The size of the memory chunks requested from the
+     * system. Larger allocations get a dedicated chunk. (default = 64 KiB)
+     */
+    Arena(size_t chunkSize = DEFAULT_CHUNK_SIZE)
+    :   _chunkSize(chunkSize)
+    { }
+
+    Arena(const Arena &) = delete;
+
+    Arena(Arena &&) = delete;
+
+    ~Arena() {
+        release();
+    }
+
+    Arena & operator=(const Arena &) = delete;
+
+    Arena & operator=(Arena &&) = delete;
+
+    /**
+     * @brief Allocates memory from this arena.
+     *
+     * @param size The number of bytes to allocate.
+     * @param align The alignment of the allocation, a power of 2.
+     * @return A pointer to the allocated memory.
+     */
+    void * allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        uintptr_t p = (_ptr + align - 1) & ~(uintptr_t) (align - 1);
+        if (_ptr != 0 && p + size <= _end) {
+            _ptr = p + size;
+            _allocated += size;
+            return reinterpret_cast<void *>(p);
+        }
+        return _allocateSlow(size, align);
+    }
+
+    /**
+     * @brief Discards every allocation made from this arena at once. Chunks of
+     * the regular size are kept for subsequent allocations.
+     *
+     * @return A reference to this object for chaining.
+     */
+    Arena & reset();
+
+    /**
+     * @brief Discards every allocation made from this arena and returns all
+     * memory to the system.
+     *
+     * @return A reference to this object for chaining.
+     */
+    Arena & release();
+
+    /**
+     * @return The number of bytes allocated since the last reset.
+     */
+    size_t allocated() const {
+        return _allocated;
+    }
+
+    /**
+     * @return The total size of the chunks held by this arena.
+     */
+    size_t capacity() const;
+
+    /**
+     * @return The arena in scope on the calling thread, or nullptr.
+     */
+    static Arena * current();
+};
+
+/**
+ * @brief An allocator serving objects of type T from the arena in scope on
+ * the calling thread. Releasing memory is a no-op; it is reclaimed when the
+ * arena is reset. A container using this allocator must only grow while its
+ * arena is in scope and must not outlive the arena's next reset.
+ *
+ * @throws Error if no arena is in scope.
+ */
+template <typename T>
+struct ArenaAllocator {
+
+private:
+
+    static Arena & _arena() {
+        Arena *a = Arena::current();
+        if (a == nullptr) throw Error("No arena is in scope");
+        return *a;
+    }
+
+public:
+
+    static void * allocate() {
+        return _arena().allocate(sizeof(T), alignof(T));
+    }
+
+    static void release(void *) { }
+
+    static void * allocate(size_t count, size_t align) {
+        return _arena().allocate(count * sizeof(T), align > alignof(T) ? align : alignof(T));
+    }
+
+    static void release(void *, size_t) { }
+};
+
+}   // namespace spl
@@ -6,6 +6,9 @@
 #pragma once
 
 #include <cstdlib>
+#include <cstring>
+#include <serialization.h>
+#include <exception.h>
 
 namespace spl {
 
@@ -15,9 +18,51 @@ namespace spl {
 class Base64 {
 public:
 
+    /**
+     * @return The length of the base64 representation of a data block of
+     * length len, including padding.
+     */
+    static constexpr size_t encodedLength(size_t len) {
+        return 4 * ((len + 2) / 3);
+    }
+
+    /**
+     * @return An upper bound on the length of the data decoded from a base64
+     * string of length len.
+     */
+    static constexpr size_t maxDecodedLength(size_t len) {
+        return len / 4 * 3;
+    }
+
+    /**
+     * @brief Encodes a given data block into a caller-provided buffer. No
+     * null terminator is written.
+     *
+     * @param[in] data Const pointer to a data block.
+     * @param[in] len Length of the input data block.
+     * @param[out] out Pointer to a buffer of at least encodedLength(len)
+     * characters.
+     * @return The number of characters written, encodedLength(len).
+     */
+    static size_t encode(const void *data, size_t len, char *out);
+
+    /**
+     * @brief Decodes a base64 string into a caller-provided buffer.
+     *
+     * @param[in] data Const pointer to a base64 string.
+     * @param[in] len Length of the input string, a multiple of 4.
+     * @param[out] out Pointer to a buffer of at least maxDecodedLength(len)
+     * bytes.
+     * @throws InvalidArgument if len is not a multiple of 4, or if the input
+     * contains characters outside of the base64 alphabet or misplaced
+     * padding.
+     * @return The number of bytes written.
+     */
+    static size_t decode(const char *data, size_t len, void *out);
+
     /**
      * @brief Encodes a given data block to a base64 C-style string.
-     * 
+     *
      * @param[in] data Const pointer to a data block.
      * @param[in] inputLength Length of the input data block.
      * @param[out] outputLength Length of the output data.
@@ -28,7 +73,7 @@ public:
 
     /**
      * @brief Decodes a base64 C-style string.
-     * 
+     *
      * @param[in] data Const pointer to a base64 C-style string.
      * @param[in] inputLength Length of the input string
      * @param[out] outputLength Length of the output data.
@@ -37,4 +82,166 @@ public:
     static void * decode(const char *data, size_t inputLength, size_t &outputLength);
 };
 
+/**
+ * @brief An output stream serializer that writes the base64 representation of
+ * the serialized data to another output stream serializer. Up to two bytes
+ * are held back between writes so that only whole groups are encoded;
+ * finish() encodes them with padding and terminates the stream.
+ */
+class OutputBase64Serializer
+:   public OutputStreamSerializer
+{
+private:
+
+    static constexpr size_t __CHUNK_SIZE = 3 * 1024;
+
+    OutputStreamSerializer &_sink;
+    uint8_t _carry[3];
+    size_t _carryLen = 0;
+    char _text[Base64::encodedLength(__CHUNK_SIZE)];
+
+protected:
+
+    void _write(const void *data, size_t len) override {
+        const uint8_t *in = (const uint8_t *) data;
+
+        if (_carryLen > 0) {
+            while (_carryLen < 3 && len > 0) {
+                _carry[_carryLen++] = *in++;
+                --len;
+            }
+            if (_carryLen < 3) return;
+            _sink.put(_text, Base64::encode(_carry, 3, _text));
+            _carryLen = 0;
+        }
+
+        while (len >= 3) {
+            size_t l = len < __CHUNK_SIZE ? len - len % 3 : __CHUNK_SIZE;
+            _sink.put(_text, Base64::encode(in, l, _text));
+            in += l;
+            len -= l;
+        }
+
+        memcpy(_carry, in, len);
+        _carryLen = len;
+    }
+
+public:
+
+    /**
+     * @brief Construct a new OutputBase64Serializer object.
+     *
+     * @param sink The serializer to write the base64 text to.
+     */
+    OutputBase64Serializer(OutputStreamSerializer &sink)
+    :   _sink(sink)
+    { }
+
+    /**
+     * @brief Construct a new OutputBase64Serializer object.
+     *
+     * @param sink The serializer to write the base64 text to.
+     * @param bufferSize Size of the internal serializer buffer.
+     */
+    OutputBase64Serializer(OutputStreamSerializer &sink, size_t bufferSize)
+    :   OutputStreamSerializer(bufferSize),
+        _sink(sink)
+    { }
+
+    /**
+     * @brief Flushes the internal buffer, writes the final, padded group, and
+     * flushes the underlying serializer. Nothing may be written afterwards.
+     *
+     * @return A reference to this object for chaining.
+     */
+    OutputBase64Serializer & finish() {
+        flush();
+        if (_carryLen > 0) {
+            _sink.put(_text, Base64::encode(_carry, _carryLen, _text));
+            _carryLen = 0;
+        }
+        _sink.flush();
+        return *this;
+    }
+};
+
+/**
+ * @brief An input stream serializer that reads base64 text from another input
+ * stream serializer and decodes it. Text already buffered in the source is
+ * consumed ahead of demand, so the source should carry nothing but the
+ * encoded stream.
+ */
+class InputBase64Serializer
+:   public InputStreamSerializer
+{
+private:
+
+    static constexpr size_t __BLOCK_GROUPS = 1024;
+
+    InputStreamSerializer &_source;
+    char _text[4 * __BLOCK_GROUPS];
+    uint8_t _block[3 * __BLOCK_GROUPS];
+    size_t _len = 0;
+    size_t _pos = 0;
+    bool _ended = false;
+
+    void _nextBlock(size_t need) {
+        if (_ended) throw InvalidArgument("Unexpected end of base64 stream");
+
+        size_t groups = need < 3 * __BLOCK_GROUPS ? (need + 2) / 3 : __BLOCK_GROUPS;
+        _source.get(_text, 4 * groups);
+        if (_text[4 * groups - 1] != '=') {
+            size_t extra = __BLOCK_GROUPS - groups;
+            while (extra > 0 && ! _source.peek(_text + 4 * groups, 4 * extra)) extra /= 2;
+            if (extra > 0) {
+                _source.get(_text + 4 * groups, 4 * extra);
+                groups += extra;
+            }
+        }
+
+        _len = Base64::decode(_text, 4 * groups, _block);
+        _pos = 0;
+        _ended = _text[4 * groups - 1] == '=';
+    }
+
+protected:
+
+    size_t _read(void *data, size_t minLen, size_t maxLen) override {
+        size_t n = 0;
+        while (n < maxLen) {
+            if (_pos == _len) {
+                if (n >= minLen) break;
+                _nextBlock(minLen - n);
+            }
+            size_t l = std::min(maxLen - n, _len - _pos);
+            memcpy((uint8_t *) data + n, _block + _pos, l);
+            _pos += l;
+            n += l;
+        }
+        return n;
+    }
+
+public:
+
+    /**
+     * @brief Construct a new InputBase64Serializer object.
+     *
+     * @param source The serializer to read the base64 text from.
+     */
+    InputBase64Serializer(InputStreamSerializer &source)
+    :   _source(source)
+    { }
+
+    /**
+     * @brief Construct a new InputBase64Serializer object.
+     *
+     * @param source The serializer to read the base64 text from.
+     * @param bufferSize Size of the internal serializer buffer.
+     */
+    InputBase64Serializer(InputStreamSerializer &source, size_t bufferSize)
+    :   InputStreamSerializer(bufferSize),
+        _source(source)
+    { }
+};
+
 }
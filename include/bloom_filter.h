@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <core/hash_table.h>
+#include <hash.h>
+#include <exception.h>
+#include <serialization.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief Extracts the key of a container element: the element itself for
+ * sets, and the key of the node for maps.
+ */
+template <typename T>
+inline const T & elementKey(const T &x) {
+    return x;
+}
+
+template <typename Key, typename Val>
+inline const Key & elementKey(const MapNode<Key, Val> &n) {
+    return n.k;
+}
+
+}   // namespace core
+
+/**
+ * @brief A blocked Bloom filter, answering approximate set membership queries
+ * from a small bit array: a key that was added is always reported as possibly
+ * present, while a key that was not is reported as absent with high
+ * probability. Placed in front of a large or remote HashSet or HashMap, it
+ * answers most lookups of missing keys without touching the container.
+ *
+ * The filter is split into 256-bit blocks. A key sets one bit in each of the
+ * eight 32-bit words of a single block, so a query reads one cache line, and
+ * is a handful of AVX2 instructions where available.
+ *
+ * Keys cannot be removed. To keep the filter in sync with a container, add
+ * every key inserted into the container; keys erased from the container only
+ * raise the false positive rate until the filter is rebuilt.
+ *
+ * Modifying the filter is not thread-safe. Queries may run concurrently with
+ * each other.
+ *
+ * @tparam Key The key type.
+ * @tparam KeyHash A functor to calculate the hash code of the key type. The
+ * default functor is Hash<Key>. Filters exchanged between processes must hash
+ * keys the same way.
+ */
+template <typename Key, typename KeyHash = Hash<Key>>
+class BloomFilter
+:   public Serializable
+{
+private:
+
+    static constexpr size_t __WORDS = 8;    // 32-bit words per block
+
+    KeyHash _hash;
+    std::vector<uint32_t> _words;
+    size_t _blocks;
+    size_t _size;
+
+    static size_t _blocksFor(size_t expectedElements, double falsePositiveRate) {
+        if (falsePositiveRate <= 0 || falsePositiveRate >= 1) {
+            throw InvalidArgument("The false positive rate must be between 0 and 1");
+        }
+        if (expectedElements == 0) expectedElements = 1;
+
+        // bits per key of a Bloom filter setting 8 bits per key, with some
+        // slack for blocks filling unevenly
+        double bitsPerKey = -1.2 * __WORDS / std::log(1 - std::pow(falsePositiveRate, 1.0 / __WORDS));
+        double bits = bitsPerKey * expectedElements;
+        return (size_t) std::ceil(bits / (32 * __WORDS));
+    }
+
+    uint32_t * _block(size_t h) {
+        return &_words[(((h >> 32) * _blocks) >> 32) * __WORDS];
+    }
+
+    const uint32_t * _block(size_t h) const {
+        return &_words[(((h >> 32) * _blocks) >> 32) * __WORDS];
+    }
+
+#if defined(__AVX2__)
+
+    static __m256i _mask(uint32_t h) {
+        const __m256i salt = _mm256_setr_epi32(
+            0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+            0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31
+        );
+        __m256i bit = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(h), salt), 27);
+        return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+    }
+
+    static void _set(uint32_t *block, uint32_t h) {
+        __m256i b = _mm256_loadu_si256((const __m256i *) block);
+        _mm256_storeu_si256((__m256i *) block, _mm256_or_si256(b, _mask(h)));
+    }
+
+    static bool _test(const uint32_t *block, uint32_t h) {
+        __m256i b = _mm256_loadu_si256((const __m256i *) block);
+        return _mm256_testc_si256(b, _mask(h));
+    }
+
+#else
+
+    static uint32_t _bit(uint32_t h, size_t i) {
+        static constexpr uint32_t salt[__WORDS] = {
+            0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+            0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31
+        };
+        return 1u << ((h * salt[i]) >> 27);
+    }
+
+    static void _set(uint32_t *block, uint32_t h) {
+        for (size_t i = 0; i < __WORDS; ++i) block[i] |= _bit(h, i);
+    }
+
+    static bool _test(const uint32_t *block, uint32_t h) {
+        for (size_t i = 0; i < __WORDS; ++i) {
+            if ((block[i] & _bit(h, i)) == 0) return false;
+        }
+        return true;
+    }
+
+#endif
+
+public:
+
+    /**
+     * @brief Construct a new BloomFilter object.
+     *
+     * @param expectedElements The number of keys the filter is sized for.
+     * Adding more keys raises the false positive rate.
+     * @param falsePositiveRate The target probability of reporting a key that
+     * was not added as possibly present (default = 1%).
+     * @throws InvalidArgument if the false positive rate is not within (0, 1).
+     */
+    BloomFilter(size_t expectedElements, double falsePositiveRate = 0.01)
+    :   _words(_blocksFor(expectedElements, falsePositiveRate) * __WORDS, 0),
+        _blocks(_words.size() / __WORDS),
+        _size(0)
+    { }
+
+    /**
+     * @brief Construct a new BloomFilter object, sized for and holding the keys
+     * of a container.
+     *
+     * @param seq A HashSet, a HashMap, or any iterable container of keys or
+     * MapNode objects.
+     * @param falsePositiveRate The target probability of reporting a key that
+     * was not added as possibly present (default = 1%).
+     * @throws InvalidArgument if the false positive rate is not within (0, 1).
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_integral<Sequence>::value, int>::type = 0
+    >
+    BloomFilter(const Sequence &seq, double falsePositiveRate = 0.01)
+    :   BloomFilter(seq.size(), falsePositiveRate)
+    {
+        addAll(seq);
+    }
+
+    BloomFilter(const BloomFilter &) = default;
+
+    BloomFilter(BloomFilter &&) = default;
+
+    BloomFilter & operator=(const BloomFilter &) = default;
+
+    BloomFilter & operator=(BloomFilter &&) = default;
+
+    void writeObject(OutputStreamSerializer &serializer) const override {
+        serializer << _blocks << _size;
+        serializer.put(_words.data(), _words.size() * sizeof(uint32_t));
+    }
+
+    void readObject(InputStreamSerializer &serializer) override {
+        serializer >> _blocks >> _size;
+        _words.assign(_blocks * __WORDS, 0);
+        serializer.get(_words.data(), _words.size() * sizeof(uint32_t));
+    }
+
+    /**
+     * @return The number of keys added since the filter was created or
+     * cleared, counting repeated keys every time.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @return A boolean indicating whether no key was added to the filter.
+     */
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @return The size of the bit array, in bytes.
+     */
+    size_t sizeInBytes() const {
+        return _words.size() * sizeof(uint32_t);
+    }
+
+    /**
+     * @brief Adds a key to the filter.
+     *
+     * @param k The key to add.
+     * @return A reference to this filter for chaining.
+     */
+    template <typename K>
+    BloomFilter & add(const K &k) {
+        size_t h = _hash(k);
+        _set(_block(h), (uint32_t) h);
+        ++_size;
+        return *this;
+    }
+
+    /**
+     * @brief Adds the keys of a container to the filter.
+     *
+     * @param seq A HashSet, a HashMap, or any iterable container of keys or
+     * MapNode objects.
+     * @return A reference to this filter for chaining.
+     */
+    template <typename Sequence>
+    BloomFilter & addAll(const Sequence &seq) {
+        for (const auto &x : seq) add(core::elementKey(x));
+        return *this;
+    }
+
+    /**
+     * @brief Tests whether a key may have been added to the filter.
+     *
+     * @param k The key to search for.
+     * @return False if the key was definitely not added, true otherwise.
+     */
+    template <typename K>
+    bool mightContain(const K &k) const {
+        size_t h = _hash(k);
+        return _test(_block(h), (uint32_t) h);
+    }
+
+    /**
+     * @brief Adds the keys of another filter to this one. Both filters must
+     * have the same size.
+     *
+     * @param rhs The filter to merge.
+     * @throws InvalidArgument if the filters differ in size.
+     * @return A reference to this filter for chaining.
+     */
+    BloomFilter & merge(const BloomFilter &rhs) {
+        if (rhs._blocks != _blocks) {
+            throw InvalidArgument("Cannot merge Bloom filters of different sizes");
+        }
+        for (size_t i = 0; i < _words.size(); ++i) _words[i] |= rhs._words[i];
+        _size += rhs._size;
+        return *this;
+    }
+
+    /**
+     * @brief Removes all keys from the filter.
+     *
+     * @return A reference to this filter for chaining.
+     */
+    BloomFilter & clear() {
+        std::fill(_words.begin(), _words.end(), 0);
+        _size = 0;
+        return *this;
+    }
+
+    /**
+     * @brief Clears the filter and adds the keys of a container, dropping keys
+     * since erased from it.
+     *
+     * @param seq A HashSet, a HashMap, or any iterable container of keys or
+     * MapNode objects.
+     * @return A reference to this filter for chaining.
+     */
+    template <typename Sequence>
+    BloomFilter & rebuild(const Sequence &seq) {
+        clear();
+        return addAll(seq);
+    }
+};
+
+}   // namespace spl
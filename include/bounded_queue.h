@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <exception.h>
+
+namespace spl {
+
+namespace parallel {
+
+/**
+ * @brief A bounded, lock-free multi-producer multi-consumer FIFO queue backed by
+ * a ring buffer. Each slot carries a sequence number that tells producers and
+ * consumers whether it is free or filled, so that enqueue and dequeue only
+ * contend on a single atomic counter each and never allocate. Blocking
+ * operations only take a lock when they actually have to wait.
+ *
+ * @tparam T The type of queue elements.
+ */
+template <typename T>
+class BoundedQueue {
+
+private:
+
+    struct Cell {
+        std::atomic_size_t seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T * data() {
+            return reinterpret_cast<T *>(&storage);
+        }
+    };
+
+    Cell *_cells;
+    size_t _mask;
+
+    // producers and consumers each keep to their own cache line
+    char _pad0[64];
+    std::atomic_size_t _enqueuePos;
+    char _pad1[64 - sizeof(std::atomic_size_t)];
+    std::atomic_size_t _dequeuePos;
+    char _pad2[64 - sizeof(std::atomic_size_t)];
+
+    std::atomic_size_t _waitingProducers;
+    std::atomic_size_t _waitingConsumers;
+    std::mutex _mtx;
+    std::condition_variable _notFull;
+    std::condition_variable _notEmpty;
+
+    static size_t _roundCapacity(size_t capacity) {
+        size_t c = 2;
+        while (c < capacity) c <<= 1;
+        return c;
+    }
+
+    bool _readable() const {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        return _cells[pos & _mask].seq.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    bool _writable() const {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        return _cells[pos & _mask].seq.load(std::memory_order_acquire) == pos;
+    }
+
+    void _notify(std::condition_variable &cv, std::atomic_size_t &waiting) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lk(_mtx);
+            cv.notify_one();
+        }
+    }
+
+    /**
+     * @brief Blocks until ready() might hold or a deadline is reached.
+     *
+     * @return False if the deadline was reached, true otherwise.
+     */
+    template <typename Ready>
+    bool _await(
+        std::condition_variable &cv,
+        std::atomic_size_t &waiting,
+        Ready ready,
+        const std::chrono::steady_clock::time_point *deadline = nullptr
+    ) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        waiting.fetch_add(1, std::memory_order_seq_cst);
+
+        bool ok = true;
+        while (! ready()) {
+            if (deadline == nullptr) {
+                cv.wait(lk);
+            }
+            else if (cv.wait_until(lk, *deadline) == std::cv_status::timeout) {
+                ok = ready();
+                break;
+            }
+        }
+
+        waiting.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    template <typename U>
+    bool _tryEnqueue(U &&elem) {
+        Cell *c;
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+
+        while (true) {
+            c = &_cells[pos & _mask];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+            if (diff == 0) {
+                if (
+                    _enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)
+                ) break;
+            }
+            else if (diff < 0) {
+                // full
+                return false;
+            }
+            else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (c->data()) T(std::forward<U>(elem));
+        c->seq.store(pos + 1, std::memory_order_release);
+
+        _notify(_notEmpty, _waitingConsumers);
+        return true;
+    }
+
+    bool _tryDequeue(T &elem) {
+        Cell *c;
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+
+        while (true) {
+            c = &_cells[pos & _mask];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+            if (diff == 0) {
+                if (
+                    _dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)
+                ) break;
+            }
+            else if (diff < 0) {
+                // empty
+                return false;
+            }
+            else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        elem = std::move(*c->data());
+        c->data()->~T();
+        c->seq.store(pos + _mask + 1, std::memory_order_release);
+
+        _notify(_notFull, _waitingProducers);
+        return true;
+    }
+
+    template <typename U>
+    void _enqueue(U &&elem) {
+        while (! _tryEnqueue(std::forward<U>(elem))) {
+            _await(_notFull, _waitingProducers, [this] { return _writable(); });
+        }
+    }
+
+public:
+
+    /**
+     * @brief Construct a new BoundedQueue object.
+     *
+     * @param capacity The maximum number of elements in the queue, rounded up
+     * to a power of 2.
+     */
+    BoundedQueue(size_t capacity)
+    :   _mask(_roundCapacity(capacity) - 1),
+        _enqueuePos(0),
+        _dequeuePos(0),
+        _waitingProducers(0),
+        _waitingConsumers(0)
+    {
+        void *mem;
+        if (posix_memalign(&mem, 64, (_mask + 1) * sizeof(Cell)) != 0) throw std::bad_alloc();
+        _cells = static_cast<Cell *>(mem);
+        for (size_t i = 0; i <= _mask; ++i) {
+            new (&_cells[i].seq) std::atomic_size_t(i);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+
+    BoundedQueue(BoundedQueue &&) = delete;
+
+    ~BoundedQueue() {
+        size_t end = _enqueuePos.load(std::memory_order_relaxed);
+        for (size_t pos = _dequeuePos.load(std::memory_order_relaxed); pos != end; ++pos) {
+            _cells[pos & _mask].data()->~T();
+        }
+        free(_cells);
+    }
+
+    BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+    BoundedQueue & operator=(BoundedQueue &&) = delete;
+
+    /**
+     * @return The maximum number of elements in the queue.
+     */
+    size_t capacity() const {
+        return _mask + 1;
+    }
+
+    /**
+     * @return The number of elements in the queue. The value is only a snapshot
+     * when other threads are operating on the queue.
+     */
+    size_t size() const {
+        size_t d = _dequeuePos.load(std::memory_order_relaxed);
+        size_t e = _enqueuePos.load(std::memory_order_relaxed);
+        return e > d ? e - d : 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return size() != 0;
+    }
+
+    /**
+     * @brief Enqueues an element to the back of the queue, or blocks until
+     * there is room for it.
+     *
+     * @param[in] elem An element to enqueue.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & enqueue(const T &elem) {
+        _enqueue(elem);
+        return *this;
+    }
+
+    /**
+     * @brief Enqueues an element to the back of the queue, or blocks until
+     * there is room for it.
+     *
+     * @param[in] elem An element to enqueue.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & enqueue(T &&elem) {
+        _enqueue(std::move(elem));
+        return *this;
+    }
+
+    /**
+     * @brief Enqueues an element to the back of the queue, or blocks until
+     * there is room for it.
+     *
+     * @param[in] elem An element to enqueue.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & operator<<(const T &elem) {
+        return enqueue(elem);
+    }
+
+    /**
+     * @brief Enqueues an element to the back of the queue, or blocks until
+     * there is room for it.
+     *
+     * @param[in] elem An element to enqueue.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & operator<<(T &&elem) {
+        return enqueue(std::move(elem));
+    }
+
+    /**
+     * @brief Attempts to enqueue an element to the back of the queue or
+     * returns immediately if the queue is full.
+     *
+     * @param[in] elem An element to enqueue.
+     * @return True if the element was enqueued, false if the queue is full.
+     */
+    bool tryEnqueue(const T &elem) {
+        return _tryEnqueue(elem);
+    }
+
+    /**
+     * @brief Attempts to enqueue an element to the back of the queue or
+     * returns immediately if the queue is full.
+     *
+     * @param[in] elem An element to enqueue. It is left untouched if the
+     * queue is full.
+     * @return True if the element was enqueued, false if the queue is full.
+     */
+    bool tryEnqueue(T &&elem) {
+        return _tryEnqueue(std::move(elem));
+    }
+
+    /**
+     * @brief Dequeues an element from the front of the queue or blocks until an
+     * element is available.
+     *
+     * @return The element at the front of the queue.
+     */
+    T dequeue() {
+        T elem;
+        dequeue(elem);
+        return elem;
+    }
+
+    /**
+     * @brief Dequeues an element from the front of the queue or blocks until an
+     * element is available.
+     *
+     * @param[out] elem A reference to an element.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & dequeue(T &elem) {
+        while (! _tryDequeue(elem)) {
+            _await(_notEmpty, _waitingConsumers, [this] { return _readable(); });
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Dequeues an element from the front of the queue or blocks until an
+     * element is available.
+     *
+     * @param[out] elem A reference to an element.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & operator>>(T &elem) {
+        return dequeue(elem);
+    }
+
+    /**
+     * @brief Dequeues an element from the front of the queue or blocks for the
+     * indicated timeout duration. If timeout is reached, a TimeoutError
+     * exception is thrown.
+     *
+     * @param[in] timeoutNanos The timeout duration in nanoseconds.
+     * @throws TimeoutError if timeout is reached.
+     * @return The element at the front of the queue.
+     */
+    T dequeueOrTimeout(uint64_t timeoutNanos = 10000lu) {
+        T elem;
+        dequeueOrTimeout(elem, timeoutNanos);
+        return elem;
+    }
+
+    /**
+     * @brief Dequeues an element from the front of the queue or blocks for the
+     * indicated timeout duration. If timeout is reached, a TimeoutError
+     * exception is thrown.
+     *
+     * @param[out] elem A reference to an element.
+     * @param[in] timeoutNanos The timeout duration in nanoseconds.
+     * @throws TimeoutError if timeout is reached.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & dequeueOrTimeout(T &elem, uint64_t timeoutNanos = 10000lu) {
+        if (! tryDequeueFor(elem, timeoutNanos)) throw TimeoutError();
+        return *this;
+    }
+
+    /**
+     * @brief Dequeues an element from the front of the queue or blocks for the
+     * indicated timeout duration. Unlike dequeueOrTimeout, reaching the
+     * timeout is reported through the return value, which keeps polling loops
+     * free of exceptions.
+     *
+     * @param[out] elem A reference to an element.
+     * @param[in] timeoutNanos The timeout duration in nanoseconds.
+     * @return True if an element was dequeued, false if timeout was reached.
+     */
+    bool tryDequeueFor(T &elem, uint64_t timeoutNanos) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeoutNanos);
+        while (! _tryDequeue(elem)) {
+            if (
+                ! _await(_notEmpty, _waitingConsumers, [this] { return _readable(); }, &deadline)
+            ) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Attempts to dequeue an element from the front of the queue or
+     * returns immediately if no elements are currently available.
+     *
+     * @param[in] defaultValue A default value to return if there are no
+     * elements to dequeue.
+     * @return The element at the front of the queue or defaultValue.
+     */
+    T tryDequeue(const T &defaultValue) {
+        T elem;
+        if (! _tryDequeue(elem)) return defaultValue;
+        return elem;
+    }
+
+    /**
+     * @brief Attempts to dequeue an element from the front of the queue or
+     * returns immediately if no elements are currently available.
+     *
+     * @param[out] elem A reference to an element.
+     * @param[in] defaultValue A default value to assign if there are no
+     * elements to dequeue.
+     * @return A reference to this container for chaining.
+     */
+    BoundedQueue & tryDequeue(T &elem, const T &defaultValue) {
+        if (! _tryDequeue(elem)) elem = defaultValue;
+        return *this;
+    }
+};
+
+}   // namespace parallel
+
+}   // namespace spl
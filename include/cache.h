@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <core/hash_table.h>
+#include <functional>       // std::equal_to
+#include <memory>
+#include <mutex>
+#include <hash.h>
+#include <exception.h>
+#include <sharded_counter.h>
+#include <thread.h>
+
+namespace spl {
+
+/**
+ * @brief The default weigher of a Cache, giving every entry a weight of 1, so
+ * that the capacity of the cache is a number of entries.
+ */
+struct UnitWeigher {
+
+    template <typename Key, typename Val>
+    size_t operator()(const Key &, const Val &) const {
+        return 1;
+    }
+};
+
+namespace core {
+
+/**
+ * @brief The value stored in the table of a cache shard, along with its weight
+ * and CLOCK reference bit.
+ */
+template <typename Val>
+struct CacheEntry {
+
+    Val v;
+    size_t weight;
+    mutable std::atomic_bool referenced;
+
+    CacheEntry(const Val &v, size_t weight)
+    :   v(v),
+        weight(weight),
+        referenced(false)
+    { }
+
+    CacheEntry(Val &&v, size_t weight)
+    :   v(std::move(v)),
+        weight(weight),
+        referenced(false)
+    { }
+
+    CacheEntry(const CacheEntry &rhs)
+    :   v(rhs.v),
+        weight(rhs.weight),
+        referenced(rhs.referenced.load(std::memory_order_relaxed))
+    { }
+
+    CacheEntry(CacheEntry &&rhs)
+    :   v(std::move(rhs.v)),
+        weight(rhs.weight),
+        referenced(rhs.referenced.load(std::memory_order_relaxed))
+    { }
+
+    CacheEntry & operator=(const CacheEntry &rhs) {
+        v = rhs.v;
+        weight = rhs.weight;
+        referenced.store(rhs.referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    CacheEntry & operator=(CacheEntry &&rhs) {
+        v = std::move(rhs.v);
+        weight = rhs.weight;
+        referenced.store(rhs.referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    /**
+     * @brief Marks the entry as recently used. The bit is tested first, so
+     * repeated hits on a hot entry do not keep dirtying its cache line.
+     */
+    void touch() const {
+        if (! referenced.load(std::memory_order_relaxed)) {
+            referenced.store(true, std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * @brief One shard of a Cache: a hash table whose slots double as the ring
+ * swept by the CLOCK hand. Modifications are serialized by a mutex and
+ * published through the controller's version, so that lookups of trivially
+ * copyable values run optimistically without taking any lock.
+ */
+template <typename Key, typename Val, typename KeyHash, typename KeyEqual>
+class CacheShard
+:   protected HashTable<
+        Key,
+        AtomicHashMapNode<Key, CacheEntry<Val>>,
+        KeyHash,
+        HashMapNodeKeyEqual<KeyEqual>,
+        ConcurrentHashTableController,
+        size_t
+    >
+{
+private:
+
+    using base = HashTable<
+        Key,
+        AtomicHashMapNode<Key, CacheEntry<Val>>,
+        KeyHash,
+        HashMapNodeKeyEqual<KeyEqual>,
+        ConcurrentHashTableController,
+        size_t
+    >;
+
+    using storage_node = typename base::storage_node;
+
+    using base::__NPOS;
+    using base::_controller;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_size;
+    using base::_end;
+    using base::_next;
+    using base::_findIndex;
+    using base::_findOrGetFreeIndex;
+    using base::_optimisticFind;
+
+    mutable std::mutex _mtx;
+    size_t _capacity = 0;
+    size_t _weight = 0;
+    size_t _hand = 0;   // index at which the CLOCK sweep resumes
+
+    /**
+     * @brief Sweeps the CLOCK hand over the table, evicting entries that were
+     * not referenced since the last pass, until the shard is within capacity.
+     * Must be called with the mutex held, within an update.
+     *
+     * @return The number of evicted entries.
+     */
+    size_t _evict() {
+        size_t evicted = 0;
+        while (_weight > _capacity && _size > 0) {
+            size_t i = _next(_hand);
+            if (i >= _end()) {
+                _hand = 0;
+                continue;
+            }
+            _hand = i + 1;
+
+            CacheEntry<Val> &e = _at(i).storage.n.v;
+            if (e.referenced.load(std::memory_order_relaxed)) {
+                e.referenced.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            _weight -= e.weight;
+            _release(i);
+            --_size;
+            ++evicted;
+        }
+        return evicted;
+    }
+
+    template <
+        typename K,
+        typename X = Val,
+        typename std::enable_if<
+            std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<X>::value,
+            int
+        >::type = 0
+    >
+    bool _get(size_t h, const K &k, Val &v) const {
+        typename base::ReadSection section(_controller);
+        size_t version;
+        while (true) {
+            const storage_node *n = _optimisticFind(h, k, version);
+            if (n == nullptr) return false;
+            Val retval = n->v.v;
+            if (_controller.readValidate(version)) {
+                n->v.touch();
+                v = retval;
+                return true;
+            }
+        }
+    }
+
+    template <
+        typename K,
+        typename X = Val,
+        typename std::enable_if<
+            ! std::is_trivially_copyable<Key>::value || ! std::is_trivially_copyable<X>::value,
+            int
+        >::type = 0
+    >
+    bool _get(size_t h, const K &k, Val &v) const {
+        // comparing the key or copying the value may follow pointers a
+        // concurrent writer frees, so it cannot be validated after the fact
+        std::lock_guard<std::mutex> lock(_mtx);
+        size_t i = _findIndex(h, k);
+        if (i == __NPOS) return false;
+        const CacheEntry<Val> &e = _at(i).storage.n.v;
+        e.touch();
+        v = e.v;
+        return true;
+    }
+
+public:
+
+    CacheShard() = default;
+
+    CacheShard(const CacheShard &) = delete;
+
+    CacheShard & operator=(const CacheShard &) = delete;
+
+    void init(size_t capacity) {
+        _capacity = capacity;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    size_t weight() const {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _weight;
+    }
+
+    template <typename K>
+    bool contains(size_t h, const K &k) const {
+        if (! std::is_trivially_copyable<Key>::value) {
+            std::lock_guard<std::mutex> lock(_mtx);
+            return _findIndex(h, k) != __NPOS;
+        }
+        typename base::ReadSection section(_controller);
+        size_t version;
+        while (true) {
+            bool found = _optimisticFind(h, k, version) != nullptr;
+            if (_controller.readValidate(version)) return found;
+        }
+    }
+
+    template <typename K>
+    bool get(size_t h, const K &k, Val &v) const {
+        return _get(h, k, v);
+    }
+
+    /**
+     * @return The number of entries evicted to make room.
+     */
+    template <typename K, typename V>
+    size_t put(size_t h, K &&k, V &&v, size_t weight) {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _controller.enter();
+        size_t i = _findOrGetFreeIndex(h, k);
+        _controller.beginUpdate();
+
+        if (_at(i).occupied()) {
+            CacheEntry<Val> &e = _at(i).storage.n.v;
+            _weight -= e.weight;
+            e.v = std::forward<V>(v);
+            e.weight = weight;
+            e.touch();
+        }
+        else {
+            _set(i, h, { std::forward<K>(k), CacheEntry<Val>(std::forward<V>(v), weight) });
+            ++_size;
+        }
+        _weight += weight;
+        size_t evicted = _evict();
+
+        _controller.endUpdate();
+        _controller.exit();
+        return evicted;
+    }
+
+    template <typename K>
+    bool erase(size_t h, const K &k) {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _controller.enter();
+        size_t i = _findIndex(h, k);
+        if (i != __NPOS) {
+            _controller.beginUpdate();
+            _weight -= _at(i).storage.n.v.weight;
+            _release(i);
+            --_size;
+            _controller.endUpdate();
+        }
+        _controller.exit();
+        return i != __NPOS;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mtx);
+        base::clear();
+        _weight = 0;
+        _hand = 0;
+    }
+};
+
+}   // namespace core
+
+/**
+ * @brief A thread-safe cache holding up to a fixed total weight of entries,
+ * evicting the least recently used ones (approximately) to make room.
+ *
+ * Entries are spread over independent shards by key hash. Each shard indexes
+ * its entries in a single hash table, whose slots also form the ring of a
+ * CLOCK replacement policy: a hit only sets the entry's reference bit, and the
+ * clock hand evicts entries that were not referenced since it last passed.
+ * Hits therefore cost one table probe and no list manipulation. Lookups of
+ * trivially copyable values take no lock at all; other values are copied under
+ * the shard's lock. Insertions and erasures lock their shard only.
+ *
+ * The capacity is split evenly between shards, so a shard may evict while
+ * others still have room.
+ *
+ * @tparam Key The key type.
+ * @tparam Val The value type.
+ * @tparam KeyHash A functor to calculate the hash code of the key type. The
+ * default functor is Hash<Key>.
+ * @tparam KeyEqual A functor to test for key equality. The default functor is
+ * std::equal_to<Key>.
+ * @tparam Weigher A functor returning the weight of an entry, given its key and
+ * value. The default weigher gives every entry a weight of 1.
+ */
+template <
+    typename Key,
+    typename Val,
+    typename KeyHash = Hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Weigher = UnitWeigher
+>
+class Cache {
+
+private:
+
+    using shard_type = core::CacheShard<Key, Val, KeyHash, KeyEqual>;
+
+    static constexpr size_t __MINIMUM_SHARD_CAPACITY = 64;
+
+    KeyHash _hash;
+    Weigher _weigher;
+
+    size_t _capacity;
+    size_t _shardBits;
+    std::unique_ptr<shard_type[]> _shards;
+
+    mutable ShardedCounter<> _hits;
+    mutable ShardedCounter<> _misses;
+    ShardedCounter<> _evictions;
+
+    /**
+     * @return The shard holding hash `h`. The shard is picked from bits of a
+     * multiplicative mix of the hash that neither the bucket nor the control
+     * byte of the shard's table depend on.
+     */
+    shard_type & _shard(size_t h) const {
+        if (_shardBits == 0) return _shards[0];
+        return _shards[((h * 0x9e3779b97f4a7c15lu) >> (57 - _shardBits)) & ((1lu << _shardBits) - 1)];
+    }
+
+public:
+
+    /**
+     * @brief Construct a new Cache object.
+     *
+     * @param capacity The maximum total weight of the entries held.
+     * @param shards The number of shards, rounded down to a power of 2, or 0
+     * to pick one from the number of CPUs. Fewer shards are used if each would
+     * otherwise hold less than a small minimum weight.
+     */
+    Cache(size_t capacity, size_t shards = 0)
+    :   _capacity(capacity),
+        _shardBits(0)
+    {
+        if (shards == 0) shards = 4 * Thread::availableCPUs();
+        size_t maxShards = capacity / __MINIMUM_SHARD_CAPACITY;
+        if (shards > maxShards) shards = maxShards;
+        while (_shardBits < 6 && (2lu << _shardBits) <= shards) ++_shardBits;
+
+        size_t n = 1lu << _shardBits;
+        _shards.reset(new shard_type[n]);
+        for (size_t i = 0; i < n; ++i) {
+            _shards[i].init((capacity + n - 1) / n);
+        }
+    }
+
+    Cache(const Cache &) = delete;
+
+    Cache & operator=(const Cache &) = delete;
+
+    /**
+     * @return The maximum total weight of the entries held.
+     */
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    /**
+     * @return The number of shards.
+     */
+    size_t shards() const {
+        return 1lu << _shardBits;
+    }
+
+    /**
+     * @return The number of entries in the cache. Concurrent modifications may
+     * or may not be reflected.
+     */
+    size_t size() const {
+        size_t sz = 0;
+        for (size_t i = 0; i < shards(); ++i) sz += _shards[i].size();
+        return sz;
+    }
+
+    /**
+     * @return The total weight of the entries in the cache. Concurrent
+     * modifications may or may not be reflected.
+     */
+    size_t weight() const {
+        size_t w = 0;
+        for (size_t i = 0; i < shards(); ++i) w += _shards[i].weight();
+        return w;
+    }
+
+    /**
+     * @return A boolean indicating whether the cache is empty.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @return The number of lookups that found their key.
+     */
+    size_t hits() const {
+        return _hits;
+    }
+
+    /**
+     * @return The number of lookups that did not find their key.
+     */
+    size_t misses() const {
+        return _misses;
+    }
+
+    /**
+     * @return The number of entries evicted to make room for others.
+     */
+    size_t evictions() const {
+        return _evictions;
+    }
+
+    /**
+     * @brief Tests whether an entry exists for some key, without marking it as
+     * recently used or counting a hit or miss.
+     *
+     * @param k The key to search for.
+     * @return True if the key exists, false otherwise.
+     */
+    template <typename K>
+    bool contains(const K &k) const {
+        size_t h = _hash(k);
+        return _shard(h).contains(h, k);
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key, without throwing
+     * on a miss, and marks the entry as recently used.
+     *
+     * @param[in] k The key to search for.
+     * @param[out] v Receives a copy of the value, if the key is found.
+     * @return True if the key is found, false otherwise.
+     */
+    template <typename K>
+    bool tryGet(const K &k, Val &v) const {
+        size_t h = _hash(k);
+        if (_shard(h).get(h, k, v)) {
+            ++_hits;
+            return true;
+        }
+        ++_misses;
+        return false;
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key, and marks the
+     * entry as recently used. If the key is not found, an ElementNotFoundError
+     * will be thrown.
+     *
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A copy of the corresponding value.
+     */
+    template <typename K>
+    Val get(const K &k) const {
+        Val v;
+        if (tryGet(k, v)) return v;
+        throw ElementNotFoundError();
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key, and marks the
+     * entry as recently used. If the key is not found, the default value will
+     * be returned.
+     *
+     * @param k The key to search for.
+     * @param defaultValue The default value to return if the key is not found.
+     * @return A copy of the value corresponding to the given key, or the
+     * default value.
+     */
+    template <typename K>
+    Val getOr(const K &k, const Val &defaultValue) const {
+        Val v;
+        if (tryGet(k, v)) return v;
+        return defaultValue;
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key, loading and
+     * inserting it on a miss. The loader is called without holding any lock,
+     * so concurrent misses on the same key may each call it; the last value
+     * loaded is kept.
+     *
+     * @param k The key to search for.
+     * @param load A functor returning the value of a key, called as load(k).
+     * @return A copy of the corresponding value.
+     */
+    template <typename F>
+    Val getOrLoad(const Key &k, F load) {
+        Val v;
+        if (tryGet(k, v)) return v;
+        v = load(k);
+        put(k, v);
+        return v;
+    }
+
+    /**
+     * @brief Inserts or replaces an entry, evicting others as needed to stay
+     * within capacity. An entry heavier than its shard's share of the capacity
+     * is evicted right away.
+     *
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this cache for chaining.
+     */
+    Cache & put(const Key &k, const Val &v) {
+        size_t h = _hash(k);
+        _evictions += _shard(h).put(h, k, v, _weigher(k, v));
+        return *this;
+    }
+
+    /**
+     * @brief Inserts or replaces an entry, evicting others as needed to stay
+     * within capacity. An entry heavier than its shard's share of the capacity
+     * is evicted right away.
+     *
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this cache for chaining.
+     */
+    Cache & put(Key &&k, Val &&v) {
+        size_t h = _hash(k);
+        size_t w = _weigher(k, v);
+        _evictions += _shard(h).put(h, std::move(k), std::move(v), w);
+        return *this;
+    }
+
+    /**
+     * @brief Erases the entry of some key. If the key does not exist, the
+     * function does nothing.
+     *
+     * @param k The key to erase.
+     * @return True if an entry was erased, false otherwise.
+     */
+    template <typename K>
+    bool erase(const K &k) {
+        size_t h = _hash(k);
+        return _shard(h).erase(h, k);
+    }
+
+    /**
+     * @brief Erases all entries. Statistics are kept.
+     *
+     * @return A reference to this cache for chaining.
+     */
+    Cache & clear() {
+        for (size_t i = 0; i < shards(); ++i) _shards[i].clear();
+        return *this;
+    }
+};
+
+}   // namespace spl
@@ -11,51 +11,43 @@
 namespace spl {
 
 /**
- * @brief A class representing a call stack snapshot.
+ * @brief A class representing a call stack snapshot. Frames are stored inline,
+ * so taking a snapshot never allocates; symbols are only resolved when the
+ * snapshot is printed.
+ *
+ * Whether snapshots are actually taken is controlled process-wide by
+ * CallStack::setCapture(). Capturing is on by default, and off by default in
+ * builds defining NDEBUG.
 */
 class CallStack {
+public:
+
+    /**
+     * @brief Policies for taking call stack snapshots.
+     */
+    enum class Capture : int {
+        NONE,       // never capture, snapshots are empty
+        SAMPLED,    // capture one snapshot out of every n, per thread
+        FULL,       // always capture
+    };
+
 private:
     static const int _MAX_STACK_FRAMES = 32;
+    static const int _MAX_SKIP = 8;
 
-    void **_stack = nullptr;
+    void *_stack[_MAX_STACK_FRAMES + _MAX_SKIP];
     int _len = 0;
     int _skip = 0;
 
-    void _dispose() {
-        if (_stack != nullptr) free(_stack);
-    }
-
-    void _invalidate() {
-        _stack = nullptr;
-        _len = 0;
-        _skip = 0;
-    }
-
-    void _move(CallStack &rhs) {
-        _stack = rhs._stack;
-        _len = rhs._len;
-        _skip = rhs._skip;
-    }
-
     void _copy(const CallStack &rhs) {
         _len = rhs._len;
-        _stack = (void **) malloc(_len * sizeof(void *));
-        memcpy(_stack, rhs._stack, _len * sizeof(void *));
         _skip = rhs._skip;
+        memcpy(_stack, rhs._stack, _len * sizeof(void *));
     }
 
-    /**
-     * @brief Construct a new CallStack object.
-     * 
-     * @param len Number of callstack framesin the buffer.
-     * @param stack The callsatack buffer.
-     * @param skip The number of frames to ignore.
-     */
-    CallStack(int len, void **stack, int skip)
-    :   _stack(stack),
-        _len(len),
-        _skip(skip)
-    { }
+    CallStack() = default;
+
+    static bool _shouldCapture();
 
 public:
 
@@ -63,40 +55,35 @@ public:
         _copy(rhs);
     }
 
-    CallStack(CallStack &&rhs) {
-        _move(rhs);
-        rhs._invalidate();
-    }
-
     /**
-     * @brief Produces a call stack snapshot instance.
+     * @brief Produces a call stack snapshot instance, subject to the capture
+     * policy.
      * 
      * @param[in] skip the number of stack frames to not include. By default the
      * trace() function will not include itself. In addition a few more stack
      * frames may be omitted, if needed.
-     * @return A Callstack instance.
+     * @return A Callstack instance, empty if the capture policy skipped it.
      */
     static CallStack trace(int skip = 0);
 
-    ~CallStack() {
-        _dispose();
-        _invalidate();
-    }
+    /**
+     * @brief Sets the process-wide capture policy.
+     *
+     * @param capture The policy.
+     * @param sampleInterval Under Capture::SAMPLED, each thread captures one
+     * snapshot out of every sampleInterval. (default = 64)
+     */
+    static void setCapture(Capture capture, unsigned sampleInterval = 64);
 
-    CallStack & operator=(const CallStack &rhs) {
-        if (this != &rhs) {
-            _dispose();
-            _copy(rhs);
-        }
-        return *this;
-    }
+    /**
+     * @return The process-wide capture policy.
+     */
+    static Capture capture();
 
-    CallStack & operator=(CallStack &&rhs) {
-        if (this != &rhs) {
-            _dispose();
-            _move(rhs);
-            rhs._invalidate();
-        }
+    ~CallStack() = default;
+
+    CallStack & operator=(const CallStack &rhs) {
+        if (this != &rhs) _copy(rhs);
         return *this;
     }
 
@@ -118,6 +105,13 @@ public:
     size_t size() const {
         return _len - _skip;
     }
+
+    /**
+     * @return A boolean indicating whether this snapshot holds any frames.
+     */
+    bool empty() const {
+        return _len <= _skip;
+    }
 };
 
 }
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <serialization.h>
+#include <thread.h>
+#include <lz4.h>
+#include <exception>
+#include <cstring>
+
+namespace spl {
+
+/**
+ * @brief An output stream serializer that compresses the serialized data and
+ * writes it to another output stream serializer. The data is framed into
+ * independently compressed blocks, each preceded by its uncompressed and
+ * compressed lengths, so that it can be decompressed as a stream by
+ * InputCompressedSerializer.
+ *
+ * In pipelined mode (the default), blocks are compressed and written to the
+ * underlying serializer on a helper thread, overlapping compression with both
+ * serialization and I/O. The underlying serializer must then not be used
+ * directly until sync() is called or this object is destroyed.
+ */
+class OutputCompressedSerializer
+:   public OutputStreamSerializer
+{
+private:
+
+    static constexpr size_t __DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    struct Block {
+        uint8_t *data = nullptr;
+        size_t len = 0;
+    };
+
+    OutputStreamSerializer &_sink;
+    size_t _blockSize;
+    uint8_t *_packed;
+    Block _blocks[2];
+    int _next = 0;
+    Semaphore _free;
+    Semaphore _ready;
+    Thread *_worker = nullptr;
+    std::exception_ptr _error;
+
+    void _encode(const void *data, size_t len) {
+        size_t packedLen = LZ4::compress(data, len, _packed, len);
+        _sink << (uint32_t) len << (uint32_t) packedLen;
+        if (packedLen == 0) {
+            // incompressible, stored as is
+            _sink.put(data, len);
+        }
+        else {
+            _sink.put(_packed, packedLen);
+        }
+    }
+
+    void _run() {
+        for (int i = 0; ; i ^= 1) {
+            _ready.wait();
+            Block &b = _blocks[i];
+            if (b.len == 0) break;
+
+            if (! _error) {
+                try {
+                    _encode(b.data, b.len);
+                }
+                catch (...) {
+                    _error = std::current_exception();
+                }
+            }
+            _free.notify();
+        }
+    }
+
+    void _rethrow() {
+        if (_error) {
+            std::exception_ptr e = _error;
+            _error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    void _submit(const void *data, size_t len) {
+        _free.wait();
+        if (len > 0 && _error) {
+            _free.notify();
+            _rethrow();
+        }
+        Block &b = _blocks[_next];
+        _next ^= 1;
+        if (len > 0) memcpy(b.data, data, len);
+        b.len = len;
+        _ready.notify();
+    }
+
+    void _drain() {
+        _free.wait();
+        _free.wait();
+        _free.notify(2);
+    }
+
+protected:
+
+    void _write(const void *data, size_t len) override {
+        while (len > 0) {
+            size_t l = std::min(len, _blockSize);
+            if (_worker == nullptr) {
+                _encode(data, l);
+            }
+            else {
+                _submit(data, l);
+            }
+            data = (const uint8_t *) data + l;
+            len -= l;
+        }
+    }
+
+public:
+
+    /**
+     * @brief Construct a new OutputCompressedSerializer object.
+     *
+     * @param sink The serializer to write the compressed stream to.
+     * @param blockSize The uncompressed size of a compressed block
+     * (default = 64 KiB).
+     * @param pipelined Whether to compress on a helper thread
+     * (default = true).
+     */
+    OutputCompressedSerializer(
+        OutputStreamSerializer &sink,
+        size_t blockSize = __DEFAULT_BLOCK_SIZE,
+        bool pipelined = true
+    )
+    :   OutputStreamSerializer(blockSize),
+        _sink(sink),
+        _blockSize(blockSize),
+        _packed(new uint8_t[blockSize]),
+        _free(2)
+    {
+        if (pipelined) {
+            _blocks[0].data = new uint8_t[blockSize];
+            _blocks[1].data = new uint8_t[blockSize];
+            _worker = new Thread([this] { _run(); });
+        }
+    }
+
+    ~OutputCompressedSerializer() {
+        if (_worker != nullptr) {
+            _submit(nullptr, 0);
+            _worker->join();
+            delete _worker;
+        }
+        delete[] _blocks[0].data;
+        delete[] _blocks[1].data;
+        delete[] _packed;
+    }
+
+    /**
+     * @brief Flushes the internal buffer, waits until all compressed data has
+     * been handed to the underlying serializer, and flushes it.
+     *
+     * @return A reference to this object for chaining.
+     */
+    OutputCompressedSerializer & sync() {
+        flush();
+        if (_worker != nullptr) {
+            _drain();
+            _rethrow();
+        }
+        _sink.flush();
+        return *this;
+    }
+
+    /**
+     * @return The uncompressed size of a compressed block.
+     */
+    size_t blockSize() const {
+        return _blockSize;
+    }
+};
+
+/**
+ * @brief An input stream serializer that reads and decompresses a stream
+ * produced by OutputCompressedSerializer from another input stream
+ * serializer.
+ */
+class InputCompressedSerializer
+:   public InputStreamSerializer
+{
+private:
+
+    InputStreamSerializer &_source;
+    uint8_t *_block = nullptr;
+    uint8_t *_packed = nullptr;
+    size_t _capacity = 0;
+    size_t _len = 0;
+    size_t _pos = 0;
+
+    void _reserve(size_t capacity) {
+        if (capacity <= _capacity) return;
+
+        delete[] _block;
+        delete[] _packed;
+        _block = nullptr;
+        _packed = nullptr;
+        _capacity = 0;
+
+        _block = new uint8_t[capacity];
+        _packed = new uint8_t[capacity];
+        _capacity = capacity;
+    }
+
+    void _nextBlock() {
+        uint32_t len, packedLen;
+        _source >> len >> packedLen;
+
+        if (len == 0 || packedLen > len) {
+            throw InvalidArgument("Malformed compressed stream");
+        }
+        _reserve(len);
+
+        if (packedLen == 0) {
+            _source.get(_block, len);
+        }
+        else {
+            _source.get(_packed, packedLen);
+            if (LZ4::decompress(_packed, packedLen, _block, len) != len) {
+                throw InvalidArgument("Malformed compressed stream");
+            }
+        }
+        _len = len;
+        _pos = 0;
+    }
+
+protected:
+
+    size_t _read(void *data, size_t minLen, size_t maxLen) override {
+        size_t n = 0;
+        while (n < maxLen) {
+            if (_pos == _len) {
+                if (n >= minLen) break;
+                _nextBlock();
+            }
+            size_t l = std::min(maxLen - n, _len - _pos);
+            memcpy((uint8_t *) data + n, _block + _pos, l);
+            _pos += l;
+            n += l;
+        }
+        return n;
+    }
+
+public:
+
+    /**
+     * @brief Construct a new InputCompressedSerializer object.
+     *
+     * @param source The serializer to read the compressed stream from.
+     */
+    InputCompressedSerializer(InputStreamSerializer &source)
+    :   _source(source)
+    { }
+
+    /**
+     * @brief Construct a new InputCompressedSerializer object.
+     *
+     * @param source The serializer to read the compressed stream from.
+     * @param bufferSize Size of the internal serializer buffer.
+     */
+    InputCompressedSerializer(InputStreamSerializer &source, size_t bufferSize)
+    :   InputStreamSerializer(bufferSize),
+        _source(source)
+    { }
+
+    ~InputCompressedSerializer() {
+        delete[] _block;
+        delete[] _packed;
+    }
+};
+
+}
@@ -5,6 +5,13 @@
 
 #pragma once
 
+#include <vector>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <iterator_view.h>
+#include <core/parallel.h>
+
 namespace spl {
 
 /**
@@ -26,8 +33,98 @@ private:
         return *static_cast<ContainerType *>(this);
     }
 
+    /**
+     * @return The number of partitions to split this container into for a
+     * parallel operation running on the given number of threads. Partitions
+     * outnumber threads so that uneven partitions still balance out.
+     */
+    static size_t _parallelPartitions(size_t &threads) {
+        threads = core::parallelThreads(threads);
+        return threads == 1 ? 1 : 4 * threads;
+    }
+
+    /**
+     * @brief Calls body(p) for every partition index p in [0, n), spreading
+     * the calls over the given number of threads. The first exception thrown
+     * by any call is rethrown once all threads are done.
+     */
+    template <typename F>
+    static void _parallelFor(size_t n, size_t threads, F body) {
+        core::parallelFor(n, threads, body);
+    }
+
+protected:
+
+    /**
+     * @brief Splits a sequence into n partitions of nearly equal length by
+     * walking it once.
+     *
+     * @return n + 1 iterators, where partition p spans [bounds[p], bounds[p + 1]).
+     */
+    template <typename It>
+    static std::vector<It> _partitionSequence(It it, const It &end, size_t size, size_t n) {
+        std::vector<It> bounds;
+        bounds.reserve(n + 1);
+        for (size_t p = 0; p < n; ++p) {
+            bounds.push_back(it);
+            for (size_t i = size / n + (p < size % n ? 1 : 0); i > 0; --i) ++it;
+        }
+        bounds.push_back(end);
+        return bounds;
+    }
+
+    /**
+     * @brief Splits this container into n partitions that can be traversed
+     * independently. Containers with indexed storage hide this with a version
+     * that splits by index instead of walking the elements.
+     *
+     * @return n + 1 iterators, where partition p spans [bounds[p], bounds[p + 1]).
+     */
+    template <typename C = ContainerType>
+    auto _partition(size_t n) const -> std::vector<decltype(std::declval<const C &>().begin())> {
+        return _partitionSequence(container().begin(), container().end(), container().size(), n);
+    }
+
+    /**
+     * @brief Splits this container into n partitions that can be traversed
+     * independently. Containers with indexed storage hide this with a version
+     * that splits by index instead of walking the elements.
+     *
+     * @return n + 1 iterators, where partition p spans [bounds[p], bounds[p + 1]).
+     */
+    template <typename C = ContainerType>
+    auto _partition(size_t n) -> std::vector<decltype(std::declval<C &>().begin())> {
+        return _partitionSequence(container().begin(), container().end(), container().size(), n);
+    }
+
 public:
 
+    /**
+     * @return A lazy view over the elements of this container, on which
+     * adapters such as filter() and transform() can be chained without
+     * copying any elements.
+     */
+    template <typename C = ContainerType>
+    auto view() const -> IterableView<decltype(std::declval<const C &>().begin())> {
+        return IterableView<decltype(std::declval<const C &>().begin())>(
+            container().begin(),
+            container().end()
+        );
+    }
+
+    /**
+     * @return A lazy view over the elements of this container, on which
+     * adapters such as filter() and transform() can be chained without
+     * copying any elements.
+     */
+    template <typename C = ContainerType>
+    auto view() -> IterableView<decltype(std::declval<C &>().begin())> {
+        return IterableView<decltype(std::declval<C &>().begin())>(
+            container().begin(),
+            container().end()
+        );
+    }
+
     /**
      * @brief Iterates over the elements of this container applying the given
      * function.
@@ -135,6 +232,143 @@ public:
         }
         return res;
     }
+
+    /**
+     * @brief Applies the given function to the elements of this container in
+     * parallel. The container is split into partitions that are traversed
+     * concurrently; hash tables and heaps are split by index range, other
+     * containers by walking their elements once.
+     *
+     * @param[in] f The functor to call for every element. It may be called
+     * concurrently from several threads.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    template <typename F>
+    const ContainerType & parallelForeach(F f, size_t threads = 0) const {
+        size_t n = _parallelPartitions(threads);
+        auto bounds = container()._partition(n);
+        _parallelFor(n, threads, [&bounds, &f] (size_t p) {
+            for (auto it = bounds[p]; it != bounds[p + 1]; ++it) f(*it);
+        });
+        return container();
+    }
+
+    /**
+     * @brief Applies the given function to the elements of this container in
+     * parallel. The container is split into partitions that are traversed
+     * concurrently; hash tables and heaps are split by index range, other
+     * containers by walking their elements once.
+     *
+     * @param[in] f The functor to call for every element. It may be called
+     * concurrently from several threads, but never twice for the same element.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    template <typename F>
+    ContainerType & parallelForeach(F f, size_t threads = 0) {
+        size_t n = _parallelPartitions(threads);
+        auto bounds = container()._partition(n);
+        _parallelFor(n, threads, [&bounds, &f] (size_t p) {
+            for (auto it = bounds[p]; it != bounds[p + 1]; ++it) f(*it);
+        });
+        return container();
+    }
+
+    /**
+     * @brief Maps the elements of this container using the given function, in
+     * parallel. The mapped elements are inserted into the new container
+     * sequentially.
+     *
+     * @tparam MappedType Type of the mapped container.
+     * @param[in] mapper A mapping functor that transforms the elements. It may
+     * be called concurrently from several threads.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     * @return A new container with the mapped elements.
+     */
+    template <typename MappedType = ContainerType, typename F>
+    MappedType parallelMap(F mapper, size_t threads = 0) const {
+        using R = typename std::decay<decltype(mapper(*container().begin()))>::type;
+
+        size_t n = _parallelPartitions(threads);
+        auto bounds = container()._partition(n);
+        std::vector<std::vector<R>> parts(n);
+        _parallelFor(n, threads, [&bounds, &parts, &mapper] (size_t p) {
+            for (auto it = bounds[p]; it != bounds[p + 1]; ++it) parts[p].push_back(mapper(*it));
+        });
+
+        std::vector<R> mapped;
+        mapped.reserve(container().size());
+        for (auto &part : parts) {
+            for (auto &x : part) mapped.push_back(std::move(x));
+        }
+        return MappedType::create(mapped.begin(), mapped.end(), mapped.size());
+    }
+
+    /**
+     * @brief Reduces the elements of this container to a single value, in
+     * parallel. Each partition is reduced separately, and the partial results
+     * are then reduced with the same function.
+     *
+     * @param[in] reducer A reducing functor that combines two elements into
+     * one. The reducing function should be associative and commutative as no
+     * order of execution is guaranteed. It may be called concurrently from
+     * several threads.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     * @return A single value after applying the reducing function to all
+     * elements.
+     */
+    template <typename T, typename F>
+    T parallelReduce(F reducer, size_t threads = 0) const {
+        return parallelReduce<T>(
+            [] (const T &x) { return x; },
+            reducer,
+            reducer,
+            threads
+        );
+    }
+
+    /**
+     * @brief Reduces the elements of this container to a single value, in
+     * parallel. Each partition is reduced separately, and the partial results
+     * are then combined.
+     *
+     * @param[in] initialMapper An initial mapping functor that is invoked for
+     * the first element of every partition.
+     * @param[in] reducer A reducing functor that combines an accumulator with
+     * a new element. It may be called concurrently from several threads.
+     * @param[in] combiner A functor that combines two partial results into
+     * one. The combining function should be associative and commutative as no
+     * order of execution is guaranteed.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     * @return A single value after applying the reducing function to all
+     * elements, or a value-initialized T if the container is empty.
+     */
+    template <typename T, typename Init, typename F, typename Combine>
+    T parallelReduce(Init initialMapper, F reducer, Combine combiner, size_t threads = 0) const {
+        size_t n = _parallelPartitions(threads);
+        auto bounds = container()._partition(n);
+        std::vector<T> partial(n);
+        std::vector<char> found(n, false);
+        _parallelFor(n, threads, [&] (size_t p) {
+            auto it = bounds[p];
+            if (it == bounds[p + 1]) return;
+            T res = initialMapper(*it);
+            while (++it != bounds[p + 1]) {
+                res = reducer(res, *it);
+            }
+            partial[p] = std::move(res);
+            found[p] = true;
+        });
+
+        T res = T();
+        bool first = true;
+        for (size_t p = 0; p < n; ++p) {
+            if (! found[p]) continue;
+            if (first) res = std::move(partial[p]);
+            else res = combiner(res, partial[p]);
+            first = false;
+        }
+        return res;
+    }
 };
 
 }   // namespace spl
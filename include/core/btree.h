@@ -0,0 +1,915 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <core/hash_table.h>    // MapNode
+#include <exception.h>
+#include <iterator.h>
+#include <serialization.h>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief Access to the key and the serialized form of a tree element. Set
+ * elements are their own keys.
+ */
+template <typename T>
+struct TreeElement {
+
+    static const T & key(const T &x) {
+        return x;
+    }
+
+    static void write(OutputStreamSerializer &serializer, const T &x) {
+        serializer << x;
+    }
+
+    static void read(InputStreamSerializer &serializer, T &x) {
+        serializer >> x;
+    }
+};
+
+template <typename Key, typename Val>
+struct TreeElement<MapNode<Key, Val>> {
+
+    static const Key & key(const MapNode<Key, Val> &n) {
+        return n.k;
+    }
+
+    static void write(OutputStreamSerializer &serializer, const MapNode<Key, Val> &n) {
+        serializer << n.k << n.v;
+    }
+
+    static void read(InputStreamSerializer &serializer, MapNode<Key, Val> &n) {
+        serializer >> *const_cast<Key *>(&n.k) >> n.v;
+    }
+};
+
+/**
+ * @brief A B+-tree. Elements are kept sorted in leaves of a few hundred bytes,
+ * linked in order, so that lookups touch one node per level and ordered scans
+ * walk arrays. Inner nodes hold copies of keys only.
+ *
+ * @tparam Key The key type.
+ * @tparam T The element type, either the key type or a MapNode.
+ * @tparam Compare A functor defining a strict weak order on keys.
+ */
+template <typename Key, typename T, typename Compare>
+class BTree {
+
+    template <typename TreeType> friend struct BTreeTester;
+
+protected:
+
+    using storage_node = T;
+    using element = TreeElement<T>;
+
+    static constexpr size_t __NODE_BYTES = 512;
+
+    static constexpr size_t __LEAF_CAPACITY =
+        (__NODE_BYTES - 4 * sizeof(void *)) / sizeof(T) > 8
+        ? (__NODE_BYTES - 4 * sizeof(void *)) / sizeof(T)
+        : 8;
+
+    static constexpr size_t __INNER_CAPACITY =
+        (__NODE_BYTES - 2 * sizeof(void *)) / (sizeof(Key) + sizeof(void *)) > 8
+        ? (__NODE_BYTES - 2 * sizeof(void *)) / (sizeof(Key) + sizeof(void *))
+        : 8;
+
+    struct Node {
+        size_t n;       // elements of a leaf, keys of an inner node
+        bool leaf;
+
+        Node(bool leaf)
+        :   n(0),
+            leaf(leaf)
+        { }
+    };
+
+    // one spare slot to insert into a full node before splitting it
+    struct Leaf : Node {
+        Leaf *prev = nullptr;
+        Leaf *next = nullptr;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type data[__LEAF_CAPACITY + 1];
+
+        Leaf()
+        :   Node(true)
+        { }
+
+        ~Leaf() {
+            for (size_t i = 0; i < this->n; ++i) at(i)->~T();
+        }
+
+        T * at(size_t i) {
+            return reinterpret_cast<T *>(&data[i]);
+        }
+
+        const T * at(size_t i) const {
+            return reinterpret_cast<const T *>(&data[i]);
+        }
+
+        const Key & key(size_t i) const {
+            return element::key(*at(i));
+        }
+    };
+
+    // child i holds keys below key i, child i + 1 keys from key i on
+    struct Inner : Node {
+        typename std::aligned_storage<sizeof(Key), alignof(Key)>::type keys[__INNER_CAPACITY + 1];
+        Node *children[__INNER_CAPACITY + 2];
+
+        Inner()
+        :   Node(false)
+        { }
+
+        ~Inner() {
+            for (size_t i = 0; i < this->n; ++i) key(i)->~Key();
+        }
+
+        Key * key(size_t i) {
+            return reinterpret_cast<Key *>(&keys[i]);
+        }
+
+        const Key * key(size_t i) const {
+            return reinterpret_cast<const Key *>(&keys[i]);
+        }
+    };
+
+    /**
+     * @brief A child split off during an insertion, to be linked into the
+     * parent node.
+     */
+    struct Split {
+        Node *right = nullptr;
+        Key *separator = nullptr;
+        bool owned = false;     // the separator slot must be destroyed once moved
+    };
+
+    template <typename X>
+    class TreeIterator
+    :   public ForwardIterator<TreeIterator<X>, X> {
+
+        friend class BTree;
+        template <typename Y> friend class TreeIterator;
+
+    private:
+
+        Leaf *_leaf;
+        size_t _pos;
+
+        TreeIterator(Leaf *leaf, size_t pos)
+        :   _leaf(leaf),
+            _pos(pos)
+        {
+            if (_leaf != nullptr && _pos == _leaf->n) {
+                _leaf = _leaf->next;
+                _pos = 0;
+            }
+        }
+
+    public:
+
+        using reference = typename ForwardIterator<TreeIterator<X>, X>::reference;
+        using pointer = typename ForwardIterator<TreeIterator<X>, X>::pointer;
+
+        TreeIterator(const TreeIterator &) = default;
+
+        TreeIterator(TreeIterator &&) = default;
+
+        template <
+            typename Y,
+            typename std::enable_if<std::is_convertible<Y *, X *>::value && ! std::is_same<X, Y>::value, int>::type = 0
+        >
+        TreeIterator(const TreeIterator<Y> &rhs)
+        :   _leaf(rhs._leaf),
+            _pos(rhs._pos)
+        { }
+
+        ~TreeIterator() = default;
+
+        TreeIterator & operator=(const TreeIterator &) = default;
+
+        TreeIterator & operator=(TreeIterator &&) = default;
+
+        bool operator==(const TreeIterator &rhs) const {
+            return _leaf == rhs._leaf && _pos == rhs._pos;
+        }
+
+        bool operator!=(const TreeIterator &rhs) const {
+            return ! operator==(rhs);
+        }
+
+        reference operator*() const {
+            return *_leaf->at(_pos);
+        }
+
+        pointer operator->() const {
+            return _leaf->at(_pos);
+        }
+
+        TreeIterator & operator++() {
+            if (++_pos == _leaf->n) {
+                _leaf = _leaf->next;
+                _pos = 0;
+            }
+            return *this;
+        }
+
+        TreeIterator operator++(int) {
+            TreeIterator current = *this;
+            operator++();
+            return current;
+        }
+    };
+
+    Node *_root = nullptr;
+    Leaf *_head = nullptr;
+    Leaf *_tail = nullptr;
+    size_t _size = 0;
+    Compare _less;
+
+    template <typename A, typename B>
+    bool _lt(const A &a, const B &b) const {
+        return _less(a, b);
+    }
+
+    /**
+     * @return The index of the child of an inner node that may hold a key.
+     */
+    template <typename K>
+    size_t _childIndex(const Inner *in, const K &k) const {
+        size_t lo = 0, hi = in->n;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (_lt(k, *in->key(mid))) hi = mid;
+            else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    /**
+     * @return The index of the first element of a leaf not less than a key.
+     */
+    template <typename K>
+    size_t _lowerIndex(const Leaf *leaf, const K &k) const {
+        size_t lo = 0, hi = leaf->n;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (_lt(leaf->key(mid), k)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * @return The index of the first element of a leaf greater than a key.
+     */
+    template <typename K>
+    size_t _upperIndex(const Leaf *leaf, const K &k) const {
+        size_t lo = 0, hi = leaf->n;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (_lt(k, leaf->key(mid))) hi = mid;
+            else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    template <typename K>
+    Leaf * _findLeaf(const K &k) const {
+        Node *node = _root;
+        if (node == nullptr) return nullptr;
+        while (! node->leaf) {
+            const Inner *in = static_cast<const Inner *>(node);
+            node = in->children[_childIndex(in, k)];
+        }
+        return static_cast<Leaf *>(node);
+    }
+
+    template <typename K>
+    T * _find(const K &k) const {
+        Leaf *leaf = _findLeaf(k);
+        if (leaf == nullptr) return nullptr;
+        size_t i = _lowerIndex(leaf, k);
+        if (i < leaf->n && ! _lt(k, leaf->key(i))) return leaf->at(i);
+        return nullptr;
+    }
+
+    template <typename K>
+    std::pair<Leaf *, size_t> _lowerBound(const K &k) const {
+        Leaf *leaf = _findLeaf(k);
+        if (leaf == nullptr) return { nullptr, 0 };
+        return { leaf, _lowerIndex(leaf, k) };
+    }
+
+    template <typename K>
+    std::pair<Leaf *, size_t> _upperBound(const K &k) const {
+        Leaf *leaf = _findLeaf(k);
+        if (leaf == nullptr) return { nullptr, 0 };
+        return { leaf, _upperIndex(leaf, k) };
+    }
+
+    template <typename X>
+    static TreeIterator<X> _iterator(const std::pair<Leaf *, size_t> &pos) {
+        return TreeIterator<X>(pos.first, pos.second);
+    }
+
+    /**
+     * @brief Splits the elements into n partitions of nearly equal length by
+     * walking the leaves.
+     *
+     * @return n + 1 iterators, where partition p spans [bounds[p], bounds[p + 1]).
+     */
+    template <typename X>
+    std::vector<TreeIterator<X>> _partitionLeaves(size_t n) const {
+        std::vector<TreeIterator<X>> bounds;
+        bounds.reserve(n + 1);
+        Leaf *leaf = _head;
+        size_t before = 0;      // elements in the leaves before the current one
+        for (size_t p = 0; p < n; ++p) {
+            size_t target = _size / n * p + std::min(p, _size % n);
+            while (leaf != nullptr && before + leaf->n <= target) {
+                before += leaf->n;
+                leaf = leaf->next;
+            }
+            bounds.push_back(TreeIterator<X>(leaf, leaf == nullptr ? 0 : target - before));
+        }
+        bounds.push_back(TreeIterator<X>(nullptr, 0));
+        return bounds;
+    }
+
+    template <typename X>
+    static void _shiftRight(X *a, size_t from, size_t n) {
+        for (size_t j = n; j > from; --j) {
+            new (&a[j]) X(std::move(a[j - 1]));
+            a[j - 1].~X();
+        }
+    }
+
+    template <typename X>
+    static void _shiftLeft(X *a, size_t from, size_t n) {
+        for (size_t j = from; j + 1 < n; ++j) {
+            new (&a[j]) X(std::move(a[j + 1]));
+            a[j + 1].~X();
+        }
+    }
+
+    template <typename X>
+    static void _moveRange(X *dst, X *src, size_t n) {
+        for (size_t j = 0; j < n; ++j) {
+            new (&dst[j]) X(std::move(src[j]));
+            src[j].~X();
+        }
+    }
+
+    static void _shiftChildrenRight(Inner *in, size_t from, size_t n) {
+        for (size_t j = n; j > from; --j) in->children[j] = in->children[j - 1];
+    }
+
+    static void _shiftChildrenLeft(Inner *in, size_t from, size_t n) {
+        for (size_t j = from; j + 1 < n; ++j) in->children[j] = in->children[j + 1];
+    }
+
+    void _linkAfter(Leaf *leaf, Leaf *right) {
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next != nullptr) leaf->next->prev = right;
+        else _tail = right;
+        leaf->next = right;
+    }
+
+    void _unlink(Leaf *leaf) {
+        if (leaf->prev != nullptr) leaf->prev->next = leaf->next;
+        else _head = leaf->next;
+        if (leaf->next != nullptr) leaf->next->prev = leaf->prev;
+        else _tail = leaf->prev;
+    }
+
+    static const Key & _minKey(const Node *node) {
+        while (! node->leaf) node = static_cast<const Inner *>(node)->children[0];
+        return static_cast<const Leaf *>(node)->key(0);
+    }
+
+    /**
+     * @brief Splits an overfull leaf in half.
+     */
+    void _splitLeaf(Leaf *leaf, Split &split) {
+        Leaf *right = new Leaf();
+        size_t mid = leaf->n / 2;
+        _moveRange(right->at(0), leaf->at(mid), leaf->n - mid);
+        right->n = leaf->n - mid;
+        leaf->n = mid;
+        _linkAfter(leaf, right);
+
+        split.right = right;
+        split.separator = const_cast<Key *>(&right->key(0));
+        split.owned = false;
+    }
+
+    /**
+     * @brief Splits an overfull inner node in half, moving the middle key up.
+     */
+    void _splitInner(Inner *in, Split &split) {
+        Inner *right = new Inner();
+        size_t mid = in->n / 2;
+        _moveRange(right->key(0), in->key(mid + 1), in->n - mid - 1);
+        for (size_t j = mid + 1; j <= in->n; ++j) right->children[j - mid - 1] = in->children[j];
+        right->n = in->n - mid - 1;
+        in->n = mid;
+
+        // the middle key is left in its slot until the parent takes it
+        split.right = right;
+        split.separator = in->key(mid);
+        split.owned = true;
+    }
+
+    /**
+     * @brief Links a child split off into its parent node.
+     */
+    void _link(Inner *in, size_t c, Split &split) {
+        _shiftRight(in->key(0), c, in->n);
+        _shiftChildrenRight(in, c + 1, in->n + 1);
+        if (split.owned) {
+            new (in->key(c)) Key(std::move(*split.separator));
+            split.separator->~Key();
+        }
+        else {
+            new (in->key(c)) Key(*split.separator);
+        }
+        in->children[c + 1] = split.right;
+        ++in->n;
+
+        split.right = nullptr;
+        if (in->n > __INNER_CAPACITY) _splitInner(in, split);
+    }
+
+    /**
+     * @brief Finds a key, or inserts an element constructed from some
+     * arguments if the key is not found.
+     *
+     * @return A pointer to the element, and a boolean indicating whether it
+     * was inserted.
+     */
+    template <typename K, typename... Args>
+    std::pair<T *, bool> _insert(Node *node, const K &k, Split &split, Args&&... args) {
+        if (node->leaf) {
+            Leaf *leaf = static_cast<Leaf *>(node);
+            size_t i = _lowerIndex(leaf, k);
+            if (i < leaf->n && ! _lt(k, leaf->key(i))) return { leaf->at(i), false };
+
+            _shiftRight(leaf->at(0), i, leaf->n);
+            new (leaf->at(i)) T(std::forward<Args>(args)...);
+            ++leaf->n;
+            ++_size;
+
+            if (leaf->n <= __LEAF_CAPACITY) return { leaf->at(i), true };
+            _splitLeaf(leaf, split);
+            if (i < leaf->n) return { leaf->at(i), true };
+            return { static_cast<Leaf *>(split.right)->at(i - leaf->n), true };
+        }
+
+        Inner *in = static_cast<Inner *>(node);
+        size_t c = _childIndex(in, k);
+        auto res = _insert(in->children[c], k, split, std::forward<Args>(args)...);
+        if (split.right != nullptr) _link(in, c, split);
+        return res;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<T *, bool> _insert(const K &k, Args&&... args) {
+        if (_root == nullptr) {
+            Leaf *leaf = new Leaf();
+            _root = _head = _tail = leaf;
+        }
+
+        Split split;
+        auto res = _insert(_root, k, split, std::forward<Args>(args)...);
+        if (split.right != nullptr) {
+            Inner *root = new Inner();
+            root->children[0] = _root;
+            root->n = 0;
+            _root = root;
+            _link(root, 0, split);
+        }
+        return res;
+    }
+
+    /**
+     * @brief Inserts an element, or replaces the element with the same key.
+     */
+    template <typename X>
+    T * _put(X &&x) {
+        auto res = _insert(element::key(x), std::forward<X>(x));
+        if (! res.second) *res.first = std::forward<X>(x);
+        return res.first;
+    }
+
+    /**
+     * @brief Removes child c of an inner node, along with the key separating
+     * it from its left sibling, or from its right sibling if it is the first
+     * child.
+     */
+    void _removeChild(Inner *in, size_t c) {
+        size_t k = c > 0 ? c - 1 : 0;
+        in->key(k)->~Key();
+        _shiftLeft(in->key(0), k, in->n);
+        _shiftChildrenLeft(in, c, in->n + 1);
+        --in->n;
+    }
+
+    /**
+     * @brief Merges or evens out children l and l + 1 of an inner node.
+     */
+    void _rebalanceLeaves(Inner *in, size_t l) {
+        Leaf *left = static_cast<Leaf *>(in->children[l]);
+        Leaf *right = static_cast<Leaf *>(in->children[l + 1]);
+
+        if (left->n + right->n <= __LEAF_CAPACITY) {
+            _moveRange(left->at(left->n), right->at(0), right->n);
+            left->n += right->n;
+            right->n = 0;
+            _unlink(right);
+            delete right;
+            _removeChild(in, l + 1);
+            return;
+        }
+
+        size_t total = left->n + right->n;
+        if (left->n < right->n) {
+            size_t m = total / 2 - left->n;
+            _moveRange(left->at(left->n), right->at(0), m);
+            left->n += m;
+            for (size_t j = m; j < right->n; ++j) {
+                new (right->at(j - m)) T(std::move(*right->at(j)));
+                right->at(j)->~T();
+            }
+            right->n -= m;
+        }
+        else {
+            size_t m = total / 2 - right->n;
+            for (size_t j = right->n; j > 0; --j) {
+                new (right->at(j - 1 + m)) T(std::move(*right->at(j - 1)));
+                right->at(j - 1)->~T();
+            }
+            _moveRange(right->at(0), left->at(left->n - m), m);
+            left->n -= m;
+            right->n += m;
+        }
+        *in->key(l) = right->key(0);
+    }
+
+    /**
+     * @brief Merges or evens out children l and l + 1 of an inner node,
+     * rotating keys through the parent.
+     */
+    void _rebalanceInners(Inner *in, size_t l) {
+        Inner *left = static_cast<Inner *>(in->children[l]);
+        Inner *right = static_cast<Inner *>(in->children[l + 1]);
+
+        if (left->n + 1 + right->n <= __INNER_CAPACITY) {
+            new (left->key(left->n)) Key(std::move(*in->key(l)));
+            _moveRange(left->key(left->n + 1), right->key(0), right->n);
+            for (size_t j = 0; j <= right->n; ++j) {
+                left->children[left->n + 1 + j] = right->children[j];
+            }
+            left->n += 1 + right->n;
+            right->n = 0;
+            delete right;
+            _removeChild(in, l + 1);
+            return;
+        }
+
+        while (left->n + 1 < right->n) {
+            new (left->key(left->n)) Key(std::move(*in->key(l)));
+            left->children[left->n + 1] = right->children[0];
+            ++left->n;
+            *in->key(l) = std::move(*right->key(0));
+            right->key(0)->~Key();
+            _shiftLeft(right->key(0), 0, right->n);
+            _shiftChildrenLeft(right, 0, right->n + 1);
+            --right->n;
+        }
+        while (right->n + 1 < left->n) {
+            _shiftRight(right->key(0), 0, right->n);
+            _shiftChildrenRight(right, 0, right->n + 1);
+            new (right->key(0)) Key(std::move(*in->key(l)));
+            right->children[0] = left->children[left->n];
+            ++right->n;
+            *in->key(l) = std::move(*left->key(left->n - 1));
+            left->key(left->n - 1)->~Key();
+            --left->n;
+        }
+    }
+
+    void _rebalance(Inner *in, size_t c) {
+        Node *child = in->children[c];
+        size_t min = child->leaf ? __LEAF_CAPACITY / 4 : __INNER_CAPACITY / 4;
+        if (child->n >= min) return;
+
+        if (in->n == 0) {
+            // an only child, which may only happen under the root
+            if (child->leaf && child->n == 0) {
+                _unlink(static_cast<Leaf *>(child));
+                delete static_cast<Leaf *>(child);
+                in->children[0] = nullptr;
+            }
+            return;
+        }
+
+        size_t l = c > 0 ? c - 1 : c;
+        if (child->leaf) _rebalanceLeaves(in, l);
+        else _rebalanceInners(in, l);
+    }
+
+    template <typename K>
+    bool _erase(Node *node, const K &k) {
+        if (node->leaf) {
+            Leaf *leaf = static_cast<Leaf *>(node);
+            size_t i = _lowerIndex(leaf, k);
+            if (i == leaf->n || _lt(k, leaf->key(i))) return false;
+            leaf->at(i)->~T();
+            _shiftLeft(leaf->at(0), i, leaf->n);
+            --leaf->n;
+            --_size;
+            return true;
+        }
+
+        Inner *in = static_cast<Inner *>(node);
+        size_t c = _childIndex(in, k);
+        if (! _erase(in->children[c], k)) return false;
+        _rebalance(in, c);
+        return true;
+    }
+
+    /**
+     * @brief Erases a key.
+     *
+     * @return True if the key was erased, false otherwise.
+     */
+    template <typename K>
+    bool _erase(const K &k) {
+        if (_root == nullptr || ! _erase(_root, k)) return false;
+
+        // shrink the tree from the top
+        while (! _root->leaf && static_cast<Inner *>(_root)->n == 0) {
+            Inner *root = static_cast<Inner *>(_root);
+            _root = root->children[0];
+            delete root;
+            if (_root == nullptr) break;
+        }
+        if (_root != nullptr && _root->leaf && _root->n == 0) {
+            delete static_cast<Leaf *>(_root);
+            _root = nullptr;
+        }
+        if (_root == nullptr) _head = _tail = nullptr;
+        return true;
+    }
+
+    /**
+     * @brief Appends an element past the last leaf, while building a tree
+     * from sorted elements. The index over the leaves is built afterwards by
+     * _buildIndex().
+     */
+    template <typename X>
+    void _append(X &&x) {
+        if (_tail == nullptr || _tail->n == __LEAF_CAPACITY) {
+            Leaf *leaf = new Leaf();
+            if (_tail == nullptr) _head = leaf;
+            else _linkAfter(_tail, leaf);
+            _tail = leaf;
+        }
+        new (_tail->at(_tail->n)) T(std::forward<X>(x));
+        ++_tail->n;
+        ++_size;
+    }
+
+    /**
+     * @brief Builds the inner nodes over a list of leaves, level by level,
+     * spreading children evenly over full-sized nodes.
+     */
+    void _buildIndex() {
+        if (_head == nullptr) return;
+
+        // leave the last leaf at least a quarter full
+        if (_tail != _head && _tail->n < __LEAF_CAPACITY / 4) {
+            Leaf *prev = _tail->prev;
+            size_t m = (prev->n + _tail->n) / 2 - _tail->n;
+            for (size_t j = _tail->n; j > 0; --j) {
+                new (_tail->at(j - 1 + m)) T(std::move(*_tail->at(j - 1)));
+                _tail->at(j - 1)->~T();
+            }
+            _moveRange(_tail->at(0), prev->at(prev->n - m), m);
+            prev->n -= m;
+            _tail->n += m;
+        }
+
+        std::vector<Node *> level;
+        for (Leaf *leaf = _head; leaf != nullptr; leaf = leaf->next) level.push_back(leaf);
+
+        while (level.size() > 1) {
+            size_t fanout = __INNER_CAPACITY + 1;
+            size_t nodes = (level.size() + fanout - 1) / fanout;
+            std::vector<Node *> parents;
+            parents.reserve(nodes);
+
+            size_t pos = 0;
+            for (size_t p = 0; p < nodes; ++p) {
+                size_t count = (level.size() - pos) / (nodes - p);
+                Inner *in = new Inner();
+                in->children[0] = level[pos];
+                for (size_t j = 1; j < count; ++j) {
+                    new (in->key(j - 1)) Key(_minKey(level[pos + j]));
+                    in->children[j] = level[pos + j];
+                }
+                in->n = count - 1;
+                parents.push_back(in);
+                pos += count;
+            }
+            level.swap(parents);
+        }
+        _root = level[0];
+    }
+
+    /**
+     * @brief Loads elements into an empty tree. Elements are appended to
+     * fresh leaves for as long as they come in increasing key order, and the
+     * remainder, if any, is inserted one by one.
+     */
+    template <typename Begin, typename End>
+    void _load(Begin it, const End &end) {
+        if (_root == nullptr) {
+            for (; it != end; ++it) {
+                if (_tail != nullptr && ! _lt(_tail->key(_tail->n - 1), element::key(*it))) break;
+                _append(*it);
+            }
+            _buildIndex();
+        }
+        for (; it != end; ++it) _put(*it);
+    }
+
+    template <typename Begin, typename End>
+    void _loadMove(Begin it, const End &end) {
+        if (_root == nullptr) {
+            for (; it != end; ++it) {
+                if (_tail != nullptr && ! _lt(_tail->key(_tail->n - 1), element::key(*it))) break;
+                _append(std::move(*it));
+            }
+            _buildIndex();
+        }
+        for (; it != end; ++it) _put(std::move(*it));
+    }
+
+    static void _destroy(Node *node) {
+        if (node->leaf) {
+            delete static_cast<Leaf *>(node);
+            return;
+        }
+        Inner *in = static_cast<Inner *>(node);
+        for (size_t i = 0; i <= in->n; ++i) {
+            if (in->children[i] != nullptr) _destroy(in->children[i]);
+        }
+        delete in;
+    }
+
+    void _clear() {
+        if (_root != nullptr) _destroy(_root);
+        _root = nullptr;
+        _head = _tail = nullptr;
+        _size = 0;
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<SupportsSerialization<X>::value, int>::type = 0
+    >
+    void _serialize(OutputStreamSerializer &serializer) const {
+        serializer << _size;
+        for (Leaf *leaf = _head; leaf != nullptr; leaf = leaf->next) {
+            for (size_t i = 0; i < leaf->n; ++i) element::write(serializer, *leaf->at(i));
+        }
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<! SupportsSerialization<X>::value, int>::type = 0
+    >
+    void _serialize(OutputStreamSerializer &serializer) const {
+        throw DynamicMessageError(
+            "Type '", typeid(T).name(), "' cannot be serialized."
+        );
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<SupportsSerialization<X>::value && std::is_constructible<X>::value, int>::type = 0
+    >
+    void _deserialize(InputStreamSerializer &serializer) {
+        _clear();
+
+        // elements are written in order
+        size_t sz;
+        serializer >> sz;
+        for (size_t i = 0; i < sz; ++i) {
+            T x;
+            element::read(serializer, x);
+            _append(std::move(x));
+        }
+        _buildIndex();
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<! SupportsSerialization<X>::value || ! std::is_constructible<X>::value, int>::type = 0
+    >
+    void _deserialize(InputStreamSerializer &serializer) {
+        throw DynamicMessageError(
+            "Type '", typeid(T).name(), "' cannot be deserialized."
+        );
+    }
+
+public:
+
+    BTree() = default;
+
+    BTree(const BTree &rhs)
+    :   _less(rhs._less)
+    {
+        _load(rhs.begin(), rhs.end());
+    }
+
+    BTree(BTree &&rhs)
+    :   _root(rhs._root),
+        _head(rhs._head),
+        _tail(rhs._tail),
+        _size(rhs._size),
+        _less(std::move(rhs._less))
+    {
+        rhs._root = nullptr;
+        rhs._head = rhs._tail = nullptr;
+        rhs._size = 0;
+    }
+
+    ~BTree() {
+        _clear();
+    }
+
+    BTree & operator=(const BTree &rhs) {
+        if (this != &rhs) {
+            _clear();
+            _less = rhs._less;
+            _load(rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+
+    BTree & operator=(BTree &&rhs) {
+        if (this != &rhs) {
+            _clear();
+            _root = rhs._root;
+            _head = rhs._head;
+            _tail = rhs._tail;
+            _size = rhs._size;
+            _less = std::move(rhs._less);
+            rhs._root = nullptr;
+            rhs._head = rhs._tail = nullptr;
+            rhs._size = 0;
+        }
+        return *this;
+    }
+
+    TreeIterator<T> begin() {
+        return TreeIterator<T>(_head, 0);
+    }
+
+    TreeIterator<const T> begin() const {
+        return TreeIterator<const T>(_head, 0);
+    }
+
+    TreeIterator<T> end() {
+        return TreeIterator<T>(nullptr, 0);
+    }
+
+    TreeIterator<const T> end() const {
+        return TreeIterator<const T>(nullptr, 0);
+    }
+
+    size_t size() const {
+        return _size;
+    }
+};
+
+}   // namespace core
+
+}   // namespace spl
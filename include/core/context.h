@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+// The hand-written context switch is used on x86-64 and aarch64 unless
+// SPL_USE_UCONTEXT is defined at build time.
+#if ! defined(SPL_USE_UCONTEXT) && (defined(__x86_64__) || defined(__aarch64__))
+#define SPL_ASM_CONTEXT_SWITCH
+#else
+#include <ucontext.h>
+#endif
+
+namespace spl {
+
+namespace core {
+
+#if defined(SPL_ASM_CONTEXT_SWITCH)
+
+extern "C" {
+
+/**
+ * @brief Saves the callee-saved registers on the current stack, stores the
+ * stack pointer into from, then restores the registers saved on the stack to
+ * and returns into the context that saved them.
+ */
+void __spl_switch_context(void **from, void *to);
+
+/**
+ * @brief The first return address of a prepared context, which calls the entry
+ * function stored among its saved registers.
+ */
+void __spl_start_context();
+
+}
+
+#endif
+
+/**
+ * @brief The saved execution state of a coroutine. With the hand-written
+ * switch, only the callee-saved registers are kept (on the coroutine's own
+ * stack) and switching costs a few dozen instructions. Otherwise, this falls
+ * back to ucontext, which also saves the signal mask with a system call at
+ * every switch.
+ */
+class MachineContext {
+
+private:
+
+#if defined(SPL_ASM_CONTEXT_SWITCH)
+    void *_sp = nullptr;
+#else
+    ucontext_t _uctx;
+#endif
+
+public:
+
+    /**
+     * @brief Prepares this context so that switching into it starts executing a
+     * function on a new stack. The function must never return; it must leave
+     * by switching to another context.
+     *
+     * @param stack The lowest address of the stack.
+     * @param size The size of the stack in bytes.
+     * @param entry The function to execute.
+     */
+    void prepare(void *stack, size_t size, void (*entry)()) {
+#if defined(SPL_ASM_CONTEXT_SWITCH)
+        uintptr_t top = (reinterpret_cast<uintptr_t>(stack) + size) & ~uintptr_t(15);
+        void **frame;
+
+    #if defined(__x86_64__)
+        // [csr] r15 r14 r13 r12 rbx rbp [ret], with the return address placed
+        // such that the stack is 16-byte aligned at the call to entry
+        frame = reinterpret_cast<void **>(top - 80);
+        uint32_t *csr = reinterpret_cast<uint32_t *>(frame);
+        csr[0] = 0x1f80;                                // default mxcsr
+        csr[1] = 0x037f;                                // default x87 control word
+        for (int i = 1; i < 7; ++i) frame[i] = nullptr;
+        frame[3] = reinterpret_cast<void *>(entry);     // r13
+        frame[7] = reinterpret_cast<void *>(__spl_start_context);
+        frame[8] = nullptr;
+    #else
+        // d8-d15 x19-x28 x29 x30
+        frame = reinterpret_cast<void **>(top - 160);
+        for (int i = 0; i < 20; ++i) frame[i] = nullptr;
+        frame[8] = reinterpret_cast<void *>(entry);     // x19
+        frame[19] = reinterpret_cast<void *>(__spl_start_context);
+    #endif
+
+        _sp = frame;
+#else
+        getcontext(&_uctx);
+        _uctx.uc_stack.ss_sp = stack;
+        _uctx.uc_stack.ss_size = size;
+        _uctx.uc_link = nullptr;
+        makecontext(&_uctx, entry, 0);
+#endif
+    }
+
+    /**
+     * @brief Saves the current execution state into one context and resumes
+     * another. Returns when some other context switches back into from.
+     *
+     * @param from The context to save the current state into.
+     * @param to The context to resume.
+     */
+    static void swap(MachineContext &from, MachineContext &to) {
+#if defined(SPL_ASM_CONTEXT_SWITCH)
+        __spl_switch_context(&from._sp, to._sp);
+#else
+        swapcontext(&from._uctx, &to._uctx);
+#endif
+    }
+
+    /**
+     * @brief Resumes a context, abandoning the current execution state.
+     *
+     * @param to The context to resume.
+     */
+    static void jump(MachineContext &to) {
+#if defined(SPL_ASM_CONTEXT_SWITCH)
+        void *discarded;
+        __spl_switch_context(&discarded, to._sp);
+#else
+        setcontext(&to._uctx);
+#endif
+    }
+};
+
+}   // namespace core
+
+}   // namespace spl
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief Process-wide epoch-based reclamation. Readers announce the epoch they
+ * entered in a per-thread record (never in shared state), and writers use
+ * quiescent() to decide when memory retired at some epoch can no longer be
+ * referenced by any reader.
+ */
+class Epoch {
+
+private:
+
+    struct alignas(64) Record {
+        std::atomic<uint64_t> epoch;    // 0 when the owner is quiescent
+        std::atomic_bool used;
+        size_t depth;                   // nesting depth, owner-only
+        Record *next;
+    };
+
+    struct LocalRecord {
+        Record *r = nullptr;
+
+        ~LocalRecord() {
+            if (r != nullptr) r->used.store(false, std::memory_order_release);
+        }
+    };
+
+    static std::atomic<uint64_t> _global;
+    static std::atomic<Record *> _records;
+    static thread_local LocalRecord _local;
+
+    static Record * _acquire();
+
+    static Record * _record() {
+        Record *r = _local.r;
+        if (r == nullptr) r = _local.r = _acquire();
+        return r;
+    }
+
+public:
+
+    /**
+     * @brief Enters a read-side critical section. Sections may be nested.
+     */
+    static void enter() {
+        Record *r = _record();
+        if (r->depth++ == 0) {
+            r->epoch.store(_global.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    /**
+     * @brief Exits a read-side critical section.
+     */
+    static void exit() {
+        Record *r = _local.r;
+        if (--r->depth == 0) {
+            r->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Advances the global epoch. Memory unlinked before calling this
+     * function may be freed once quiescent() returns true for the returned
+     * epoch.
+     *
+     * @return The new epoch.
+     */
+    static uint64_t advance() {
+        return _global.fetch_add(1, std::memory_order_seq_cst) + 1;
+    }
+
+    /**
+     * @brief Tests whether all readers have left the critical sections they
+     * entered before some epoch.
+     *
+     * @param epoch An epoch returned by advance().
+     * @return True if no reader may still reference memory retired at the
+     * given epoch, false otherwise.
+     */
+    static bool quiescent(uint64_t epoch);
+};
+
+}   // namespace core
+
+}   // namespace spl
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief Thin wrappers around process-private futex operations on 32-bit
+ * atomic words.
+ */
+struct Futex {
+
+    /**
+     * @brief Number of times a waiter polls its condition before going to
+     * sleep in the kernel.
+     */
+    static constexpr int SPIN = 128;
+
+    /**
+     * @brief Hints the processor that the caller is spinning.
+     */
+    static void pause() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    /**
+     * @brief Sleeps as long as the word holds the expected value, until woken
+     * or until the timeout expires. Spurious wakeups are possible.
+     *
+     * @param word The futex word.
+     * @param expected The value the word must hold for the caller to sleep.
+     * @param timeout The relative timeout, or nullptr to wait indefinitely.
+     */
+    static void wait(
+        std::atomic<uint32_t> &word,
+        uint32_t expected,
+        const struct timespec *timeout = nullptr
+    ) {
+        syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+    }
+
+    /**
+     * @brief Wakes up to count threads sleeping on the word.
+     */
+    static void wake(std::atomic<uint32_t> &word, int count = INT_MAX) {
+        syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+
+    /**
+     * @return The current time of the monotonic clock in nanoseconds.
+     */
+    static uint64_t now() {
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec * 1000000000lu + t.tv_nsec;
+    }
+};
+
+}   // namespace core
+
+}   // namespace spl
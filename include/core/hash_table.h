@@ -7,12 +7,23 @@
 
 #include <atomic>
 #include <mutex>
+#include <vector>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 #include <iterator.h>
 #include <serialization.h>
 #include <type_traits>
 #include <exception.h>
+#include <sharded_counter.h>
+#include <hash_table_stats.h>
+#include <core/epoch.h>
+#include <core/node_pool.h>
+#include <core/parallel.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace spl {
 
@@ -23,9 +34,16 @@ namespace core {
         typename KeyHash,
         typename NodeKeyEqual,
         typename Controller,
-        typename size_type
+        typename size_type,
+        typename table_allocator = HeapAllocator<node>
     >
     class HashTable;
+
+    /**
+     * @brief Tag selecting the MapNode constructor that builds the value in
+     * place from the remaining arguments.
+     */
+    struct EmplaceTag { };
 }
 
 /**
@@ -43,7 +61,8 @@ class MapNode {
         typename KeyHash,
         typename NodeKeyEqual,
         typename Controller,
-        typename size_type
+        typename size_type,
+        typename table_allocator
     >
     friend class core::HashTable;
 
@@ -90,6 +109,12 @@ public:
         v(std::move(v))
     { }
 
+    template <typename K, typename... Args>
+    MapNode(core::EmplaceTag, K &&k, Args&&... args)
+    :   k(std::forward<K>(k)),
+        v(std::forward<Args>(args)...)
+    { }
+
     MapNode(const MapNode &) = default;
 
     MapNode(MapNode &&) = default;
@@ -198,9 +223,41 @@ struct HashTableNode {
         status = UNOCCUPIED;
     }
 
+    /**
+     * @brief Gives up a node claimed with occupyIfFree() before anything was
+     * stored in it.
+     */
+    void vacate() {
+        status = UNOCCUPIED;
+    }
+
     bool occupied() {
         return status == OCCUPIED;
     }
+
+    template <typename... Args>
+    void emplace(size_t hash, Args&&... args) {
+        new (&storage) storage_type(std::forward<Args>(args)...);
+        h = hash;
+        status = OCCUPIED;
+    }
+
+    void lock() {
+    }
+
+    void unlock() {
+    }
+
+    void resetLock() {
+    }
+
+    size_t readBegin() const {
+        return 0;
+    }
+
+    bool readValidate(size_t version) const {
+        return true;
+    }
 };
 
 template <typename Node>
@@ -210,6 +267,7 @@ struct AtomicHashTableNode {
 
     size_t h;
     std::atomic<uint8_t> status;
+    std::atomic<uint16_t> seq;      // odd while the element is modified in place
     union storage {
         alignas(storage_type) unsigned char buf[sizeof(storage_type)];
         storage_type n;
@@ -268,14 +326,73 @@ struct AtomicHashTableNode {
     }
 
     void release() {
+        lock();
         status.store(TENTATIVELY_OCCUPIED, std::memory_order_release);
         storage.n.~storage_type();
         status.store(UNOCCUPIED, std::memory_order_release);
+        unlock();
+    }
+
+    /**
+     * @brief Gives up a node claimed with occupyIfFree() before anything was
+     * stored in it.
+     */
+    void vacate() {
+        status.store(UNOCCUPIED, std::memory_order_release);
     }
 
     bool occupied() {
         return status.load(std::memory_order_relaxed) == OCCUPIED;
     }
+
+    template <typename... Args>
+    void emplace(size_t hash, Args&&... args) {
+        new (&storage) storage_type(std::forward<Args>(args)...);
+        h = hash;
+        status.store(OCCUPIED, std::memory_order_release);
+    }
+
+    /**
+     * @brief Locks the element for modification in place. Optimistic readers
+     * of the element retry until it is unlocked.
+     */
+    void lock() {
+        uint16_t s = seq.load(std::memory_order_relaxed);
+        while (true) {
+            if ((s & 1) == 0 && seq.compare_exchange_weak(
+                s, s + 1, std::memory_order_acquire, std::memory_order_relaxed
+            )) {
+                break;
+            }
+            if (s & 1) {
+                sched_yield();
+                s = seq.load(std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void unlock() {
+        seq.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Clears a lock left in the bits of a table loaded as is.
+     */
+    void resetLock() {
+        seq.store(0, std::memory_order_relaxed);
+    }
+
+    size_t readBegin() const {
+        uint16_t s;
+        while ((s = seq.load(std::memory_order_acquire)) & 1) sched_yield();
+        return s;
+    }
+
+    bool readValidate(size_t version) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq.load(std::memory_order_relaxed) == version;
+    }
 };
 
 template <typename Key, typename Val>
@@ -290,6 +407,26 @@ using HashSetNode = HashTableNode<Key>;
 template <typename Key>
 using AtomicHashSetNode = AtomicHashTableNode<Key>;
 
+/**
+ * @brief Whether the elements of a table can be read optimistically, i.e.
+ * compared and copied while a writer may be modifying them. A copy of a
+ * trivially copyable type that races with a writer is merely torn, and is
+ * discarded when validation fails. Copying or comparing other types may follow
+ * pointers the writer frees.
+ */
+template <typename T>
+struct OptimisticallyReadable
+:   std::is_trivially_copyable<T>
+{ };
+
+template <typename Key, typename Val>
+struct OptimisticallyReadable<MapNode<Key, Val>>
+:   std::integral_constant<
+        bool,
+        std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Val>::value
+    >
+{ };
+
 template <typename KeyEqual> 
 struct HashMapNodeKeyEqual {
     KeyEqual _eq;
@@ -324,10 +461,113 @@ struct HashRange {
     }
 };
 
+/**
+ * @brief Matches a group of control bytes against a hash fragment. HashTable
+ * keeps one control byte per slot in a dense array next to the node table:
+ * EMPTY for a slot that holds no element, or a 7-bit fragment of the hash with
+ * the high bit set for an occupied one. Probing compares a whole group of
+ * control bytes at a time, so nodes are only touched on a fragment match.
+ */
+struct ControlGroup {
+
+#if defined(__AVX2__)
+    static constexpr size_t WIDTH = 32;
+#elif defined(__SSE2__)
+    static constexpr size_t WIDTH = 16;
+#else
+    static constexpr size_t WIDTH = 8;
+#endif
+
+    static constexpr uint8_t EMPTY = 0;
+
+    /**
+     * @return The control byte of an occupied slot holding hash `h`. The
+     * fragment is taken from the high bits of a multiplicative mix of the
+     * hash, since the low bits already select the bucket.
+     */
+    static uint8_t tag(size_t h) {
+        return 0x80 | static_cast<uint8_t>((h * 0x9e3779b97f4a7c15lu) >> 57);
+    }
+
+    /**
+     * @return A mask with bit i set if `ctrl[i] == tag`, for i < WIDTH.
+     */
+    static uint32_t match(const uint8_t *ctrl, uint8_t tag) {
+#if defined(__AVX2__)
+        __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ctrl));
+        __m256i eq = _mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(tag)));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+#elif defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+        __m128i eq = _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(tag)));
+        return static_cast<uint32_t>(_mm_movemask_epi8(eq));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < WIDTH; ++i) {
+            if (ctrl[i] == tag) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /**
+     * @return A mask with bit i set if slot i holds an element, for i < WIDTH.
+     */
+    static uint32_t occupied(const uint8_t *ctrl) {
+#if defined(__AVX2__)
+        __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ctrl));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(group));
+#elif defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+        return static_cast<uint32_t>(_mm_movemask_epi8(group));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < WIDTH; ++i) {
+            if (ctrl[i] & 0x80) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /**
+     * @return The first slot in [i, end) that holds an element, or `end` if
+     * there is none.
+     */
+    static size_t next(const uint8_t *ctrl, size_t i, size_t end) {
+        for (; i < end; i += WIDTH) {
+            uint32_t mask = occupied(ctrl + i);
+            if (mask != 0) {
+                i += __builtin_ctz(mask);
+                return i < end ? i : end;
+            }
+        }
+        return end;
+    }
+
+    /**
+     * @return A mask selecting the first `n` slots of a group, n <= WIDTH.
+     */
+    static uint32_t first(size_t n) {
+        return n >= 32 ? ~0u : (1u << n) - 1;
+    }
+
+    /**
+     * @brief Allocates a zeroed control array for a table. The array is padded
+     * by one group so that a group may be loaded starting at any slot.
+     */
+    static uint8_t * allocate(size_t tableSize) {
+        return static_cast<uint8_t *>(calloc(tableSize + WIDTH, 1));
+    }
+
+    static void dispose(void *ctrl, size_t) {
+        free(ctrl);
+    }
+};
+
 struct HashTableController {
 
     static constexpr size_t LINEAR_INCREMENT_THRESHOLD = 100000000lu;
-    static constexpr size_t BUCKET_SEARCH = 16;               // max number of buckets to search in for a key
+    static constexpr size_t BUCKET_SEARCH = 32;               // max number of buckets to search in for a key
     static constexpr size_t INITIAL_BUCKET_SIZE = 1;          // initial size of a bucket with matching hash values
 
     size_t bucketSize = 0; // bucket size
@@ -340,6 +580,22 @@ struct HashTableController {
         tableSize = nBuckets * bucketSize;
     }
 
+    /**
+     * @brief Sets up a geometry with room for `n` elements at the current
+     * bucket size, leaving half of the slots free.
+     *
+     * @param n The number of elements.
+     * @param minimumSize The smallest table size to configure.
+     */
+    void reserve(size_t n, size_t minimumSize) {
+        if (bucketSize == 0) bucketSize = INITIAL_BUCKET_SIZE;
+
+        size_t sz = 2 * n < minimumSize ? minimumSize : 2 * n;
+
+        nBuckets = (sz + bucketSize - 1) / bucketSize;
+        tableSize = nBuckets * bucketSize;
+    }
+
     size_t increaseBucketSize(size_t sz, size_t hashCollisions) {
         if (bucketSize != sz) return 0;
 
@@ -399,18 +655,75 @@ struct HashTableController {
 
     void unlock() {
     }
+
+    size_t lockRange(size_t h) {
+        return 0;
+    }
+
+    void unlockRange(size_t token) {
+    }
+
+    void enterRead() const {
+    }
+
+    void exitRead() const {
+    }
+
+    size_t readBegin() const {
+        return 0;
+    }
+
+    bool readValidate(size_t version) const {
+        return true;
+    }
+
+    void beginUpdate() {
+    }
+
+    void endUpdate() {
+    }
+
+    void retire(void *table, size_t tableSize, void (*dispose)(void *, size_t)) {
+        dispose(table, tableSize);
+    }
 };
 
 struct ConcurrentHashTableController
 :   HashTableController
 {
+    struct Retired {
+        void *table;
+        size_t tableSize;
+        void (*dispose)(void *, size_t);
+        uint64_t epoch;
+        Retired *next;
+    };
+
     std::mutex _mtx;
     std::atomic_bool _hold;
-    std::atomic_size_t _resident;
+    mutable ShardedCounter<> _resident;
+    std::atomic_size_t _version;    // odd while a structural update is in progress
+    Retired *_retired = nullptr;    // guarded by _mtx
+
+    void _reclaim(bool force) {
+        Retired **r = &_retired;
+        while (*r != nullptr) {
+            Retired *x = *r;
+            if (force || Epoch::quiescent(x->epoch)) {
+                *r = x->next;
+                x->dispose(x->table, x->tableSize);
+                delete x;
+            }
+            else {
+                r = &x->next;
+            }
+        }
+    }
 
     ConcurrentHashTableController() {
         _hold = false;
         _resident = 0;
+        _version = 0;
     }
 
     ConcurrentHashTableController(const ConcurrentHashTableController &rhs)
@@ -418,6 +731,7 @@ struct ConcurrentHashTableController
     {
         _hold = false;
         _resident = 0;
+        _version = 0;
     }
 
     ConcurrentHashTableController(ConcurrentHashTableController &&rhs)
@@ -425,6 +739,11 @@ struct ConcurrentHashTableController
     {
         _hold = false;
         _resident = 0;
+        _version = 0;
+    }
+
+    ~ConcurrentHashTableController() {
+        _reclaim(true);
     }
 
     ConcurrentHashTableController & operator=(const ConcurrentHashTableController &rhs) {
@@ -439,25 +758,337 @@ struct ConcurrentHashTableController
 
     void enter() const {
         while (_hold.load(std::memory_order_relaxed)) sched_yield();
-        ++const_cast<ConcurrentHashTableController *>(this)->_resident;
+        ++_resident;
     }
 
     void exit() const {
-        --const_cast<ConcurrentHashTableController *>(this)->_resident;
+        --_resident;
     }
 
     void lock() {
         --_resident;
         _mtx.lock();
         _hold.store(true, std::memory_order_release);
-        while (_resident.load(std::memory_order_relaxed) > 0) sched_yield();
+        while (_resident.load() > 0) sched_yield();
     }
 
     void unlock() {
+        if (_retired != nullptr) _reclaim(false);
         ++_resident;
         _hold.store(false, std::memory_order_release);
         _mtx.unlock();
     }
+
+    size_t lockRange(size_t h) {
+        lock();
+        return 0;
+    }
+
+    void unlockRange(size_t token) {
+        unlock();
+    }
+
+    // Optimistic readers do not register with _resident. Instead, they pin
+    // retired tables through Epoch and validate against _version, so a lookup
+    // never writes to a cache line shared with other readers.
+
+    void enterRead() const {
+        Epoch::enter();
+    }
+
+    void exitRead() const {
+        Epoch::exit();
+    }
+
+    size_t readBegin() const {
+        size_t v;
+        while ((v = _version.load(std::memory_order_acquire)) & 1) sched_yield();
+        return v;
+    }
+
+    bool readValidate(size_t version) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _version.load(std::memory_order_relaxed) == version;
+    }
+
+    void beginUpdate() {
+        _version.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endUpdate() {
+        _version.fetch_add(1, std::memory_order_release);
+    }
+
+    void retire(void *table, size_t tableSize, void (*dispose)(void *, size_t)) {
+        _retired = new Retired { table, tableSize, dispose, Epoch::advance(), _retired };
+    }
+};
+
+/**
+ * @brief A concurrent controller that stripes the lock taken by insertions
+ * over independently locked segments of the table. An insertion only locks the
+ * segments covered by its key's hash range, so puts of unrelated keys do not
+ * serialize on a single mutex. Resizing and locked (_l) operations lock every
+ * segment.
+ *
+ * @tparam STRIPES The number of segments (at most 64).
+ */
+template <size_t STRIPES = 64>
+struct StripedHashTableController
+:   ConcurrentHashTableController
+{
+    static_assert(STRIPES > 0 && STRIPES <= 64, "STRIPES must be between 1 and 64");
+
+    struct alignas(64) Stripe {
+        std::mutex mtx;
+    };
+
+    Stripe _stripes[STRIPES];
+
+    uint64_t _stripeMask(const HashRange &range) const {
+        size_t len = range.end > range.pos
+            ? range.end - range.pos
+            : range.end + range.size - range.pos;
+
+        if (len >= tableSize) return STRIPES == 64 ? ~0ul : (1ul << STRIPES) - 1;
+
+        size_t width = (tableSize + STRIPES - 1) / STRIPES;
+        size_t first = range.pos / width;
+        size_t last = ((range.pos + len - 1) % tableSize) / width;
+
+        uint64_t mask = 0;
+        for (size_t s = first; ; s = (s + 1) % STRIPES) {
+            mask |= 1ul << s;
+            if (s == last) break;
+        }
+        return mask;
+    }
+
+    void _lockStripes(uint64_t mask) {
+        // always in ascending order to avoid deadlocks
+        for (uint64_t m = mask; m != 0; m &= m - 1) {
+            _stripes[__builtin_ctzl(m)].mtx.lock();
+        }
+    }
+
+    void _unlockStripes(uint64_t mask) {
+        for (uint64_t m = mask; m != 0; m &= m - 1) {
+            _stripes[__builtin_ctzl(m)].mtx.unlock();
+        }
+    }
+
+    StripedHashTableController() = default;
+
+    StripedHashTableController(const StripedHashTableController &rhs)
+    :   ConcurrentHashTableController(rhs)
+    { }
+
+    StripedHashTableController(StripedHashTableController &&rhs)
+    :   ConcurrentHashTableController(std::move(rhs))
+    { }
+
+    StripedHashTableController & operator=(const StripedHashTableController &rhs) {
+        ConcurrentHashTableController::operator=(rhs);
+        return *this;
+    }
+
+    StripedHashTableController & operator=(StripedHashTableController &&rhs) {
+        ConcurrentHashTableController::operator=(std::move(rhs));
+        return *this;
+    }
+
+    void lock() {
+        --_resident;
+        _lockStripes(~0ul >> (64 - STRIPES));
+        _hold.store(true, std::memory_order_release);
+        while (_resident.load() > 0) sched_yield();
+    }
+
+    void unlock() {
+        if (_retired != nullptr) _reclaim(false);
+        ++_resident;
+        _hold.store(false, std::memory_order_release);
+        _unlockStripes(~0ul >> (64 - STRIPES));
+    }
+
+    size_t lockRange(size_t h) {
+        // not counted as resident while waiting, so that a thread holding all
+        // stripes in lock() is not kept waiting on us
+        --_resident;
+        while (true) {
+            size_t v = readBegin();
+            uint64_t mask = _stripeMask(hashRange(h));
+            _lockStripes(mask);
+
+            // the geometry cannot change while we hold any stripe
+            if (readValidate(v)) {
+                ++_resident;
+                return mask;
+            }
+            _unlockStripes(mask);
+        }
+    }
+
+    void unlockRange(size_t token) {
+        _unlockStripes(token);
+    }
+};
+
+/**
+ * @brief Probing primitives over a table of nodes and its control bytes,
+ * shared by hash tables that keep their tables in different storage.
+ */
+template <typename node>
+struct TableProbe {
+
+    static constexpr size_t NPOS = (size_t) -1;
+
+    // how far past a full range, in range lengths, displacement looks for a
+    // free slot
+    static constexpr size_t __DISPLACEMENT_SEARCH = 16;
+
+    /**
+     * @brief Searches a range of some table for a key, a group of control
+     * bytes at a time. On a match, the range is advanced past the returned
+     * index so that the search may be resumed.
+     */
+    template <typename K, typename NodeKeyEqual>
+    static size_t find(
+        node *table,
+        const uint8_t *ctrl,
+        HashRange &range,
+        size_t h,
+        const K &k,
+        const NodeKeyEqual &eq
+    ) {
+        const uint8_t tag = ControlGroup::tag(h);
+
+        do {
+            // contiguous slots left before the end of the range or the table
+            size_t n = range.end > range.pos ? range.end - range.pos : range.size - range.pos;
+            if (n > ControlGroup::WIDTH) n = ControlGroup::WIDTH;
+
+            uint32_t match = ControlGroup::match(ctrl + range.pos, tag) & ControlGroup::first(n);
+            while (match != 0) {
+                size_t i = range.pos + __builtin_ctz(match);
+                if (table[i].occupied() && table[i].h == h && eq(table[i], k)) {
+                    range.pos = i;
+                    range.next();
+                    return i;
+                }
+                match &= match - 1;
+            }
+
+            range.pos = (range.pos + n) % range.size;
+        } while (range.nonEmpty());
+
+        return NPOS;
+    }
+
+    /**
+     * @brief Claims a free slot in a range of some table. Only slots whose
+     * control byte is EMPTY are tried, so nodes holding elements are not
+     * touched.
+     */
+    static size_t freeIndex(node *table, const uint8_t *ctrl, HashRange range) {
+        do {
+            size_t n = range.end > range.pos ? range.end - range.pos : range.size - range.pos;
+            if (n > ControlGroup::WIDTH) n = ControlGroup::WIDTH;
+
+            uint32_t free = ~ControlGroup::occupied(ctrl + range.pos) & ControlGroup::first(n);
+            while (free != 0) {
+                size_t i = range.pos + __builtin_ctz(free);
+                if (table[i].occupyIfFree()) return i;
+                free &= free - 1;
+            }
+
+            range.pos = (range.pos + n) % range.size;
+        } while (range.nonEmpty());
+
+        return NPOS;
+    }
+
+    /**
+     * @brief Makes room in a full range of some table, hopscotch style: the
+     * nearest free slot past the range is moved back towards it, one hop at a
+     * time, each hop moving an element to a later slot still within that
+     * element's own range. Elements never leave their range, so lookups never
+     * search further and erasing needs no tombstones, while the table fills to
+     * a much higher load before it has to grow. Must be called with the table
+     * locked against concurrent access.
+     *
+     * @return The index freed in the range, claimed for the caller, or NPOS if
+     * no free slot could be moved into it.
+     */
+    static size_t displace(
+        node *table,
+        uint8_t *ctrl,
+        const HashTableController &geometry,
+        HashRange range
+    ) {
+        const size_t size = range.size;
+        const size_t len = (range.end + size - range.pos) % size;
+        if (len == 0) return NPOS;      // the range spans the whole table
+
+        auto distance = [size] (size_t from, size_t to) {
+            return (to + size - from) % size;
+        };
+
+        // nearest free slot past the range
+        size_t limit = __DISPLACEMENT_SEARCH * len < size ? __DISPLACEMENT_SEARCH * len : size;
+        size_t e = range.end;
+        while (ctrl[e] != ControlGroup::EMPTY || ! table[e].occupyIfFree()) {
+            e = (e + 1) % size;
+            if (e == range.pos || distance(range.pos, e) >= limit) return NPOS;
+        }
+
+        while (distance(range.pos, e) >= len) {
+            // the earliest element before e whose range covers e
+            size_t j = (e + size - len + 1) % size;
+            for (; j != e; j = (j + 1) % size) {
+                if (ctrl[j] == ControlGroup::EMPTY) continue;
+                HashRange own = geometry.hashRange(table[j].h);
+                if (distance(own.pos, e) < (own.end + size - own.pos) % size) break;
+            }
+            if (j == e) {
+                table[e].vacate();
+                return NPOS;
+            }
+
+            table[e].set(table[j].h, std::move(table[j].storage.n));
+            ctrl[e] = ctrl[j];
+            ctrl[j] = ControlGroup::EMPTY;
+            table[j].release();
+            table[j].occupyIfFree();
+            e = j;
+        }
+
+        return e;
+    }
+
+    /**
+     * @return The number of elements in a range of some table with hash `h`.
+     */
+    static size_t collisions(node *table, const uint8_t *ctrl, HashRange range, size_t h) {
+        const uint8_t tag = ControlGroup::tag(h);
+        size_t count = 0;
+
+        do {
+            size_t n = range.end > range.pos ? range.end - range.pos : range.size - range.pos;
+            if (n > ControlGroup::WIDTH) n = ControlGroup::WIDTH;
+
+            uint32_t match = ControlGroup::match(ctrl + range.pos, tag) & ControlGroup::first(n);
+            while (match != 0) {
+                if (table[range.pos + __builtin_ctz(match)].h == h) ++count;
+                match &= match - 1;
+            }
+
+            range.pos = (range.pos + n) % range.size;
+        } while (range.nonEmpty());
+
+        return count;
+    }
 };
 
 template <
@@ -466,24 +1097,48 @@ template <
     typename KeyHash,
     typename NodeKeyEqual,
     typename Controller,
-    typename size_type
+    typename size_type,
+    typename table_allocator
 >
-class HashTable {
+class HashTable
+:   protected HashTableRecorder     // empty unless SPL_HASH_TABLE_STATS is defined
+{
 protected:
 
     using storage_node = typename node::storage_type;
 
-    static constexpr size_t __INITIAL_TABLE_SIZE = 128;
     static constexpr size_t __MINIMUM_TABLE_SIZE = 8;
     static constexpr size_t __NPOS = (size_t) -1;
+    static constexpr size_t __MIGRATION_STEP = 256;   // slots migrated per insertion while resizing
+    static constexpr size_t __BATCH_SIZE = 16;        // elements hashed and prefetched ahead by batch operations
+    static constexpr size_t __CHUNK_SLOTS = 64 * 1024; // slots per chunk of a parallel serialization
+    static constexpr size_t __SCAN_SEGMENT = 4096;    // hash positions copied per step of a weakly consistent scan
 
     KeyHash _hash;
     NodeKeyEqual _eq;
 
     Controller _controller;
     node *_table;       // table
+    uint8_t *_ctrl;     // control bytes of _table, see ControlGroup
     size_type _size;    // number of elements
 
+    // While a resize is in progress, elements are incrementally moved from
+    // _old to _table. Indices at or past _controller.tableSize refer to _old.
+    node *_old = nullptr;
+    uint8_t *_oldCtrl = nullptr;
+    HashTableController _oldGeometry;
+    size_t _migrated = 0;
+
+    /**
+     * @brief A range of indices where some key may exist, spanning both the
+     * current table and, while resizing, the table being migrated from.
+     */
+    struct TableRange {
+        HashRange range;
+        HashRange oldRange;
+        int phase;      // 0: current table, 1: old table, 2: exhausted
+    };
+
     template <typename X>
     class HashTableIterator
     :   public BidirectionalIterator<HashTableIterator<X>, X>
@@ -493,7 +1148,41 @@ protected:
         size_t _i = 0;
         const HashTable *_ht = nullptr;
         node *_table = nullptr;
+        const uint8_t *_ctrl = nullptr;
         size_t _size = 0;
+        node *_old = nullptr;
+        const uint8_t *_oldCtrl = nullptr;
+        size_t _end = 0;
+
+        void _fetch() {
+            _table = _ht->_table;
+            _ctrl = _ht->_ctrl;
+            _size = _ht->_controller.tableSize;
+            _old = _ht->_old;
+            _oldCtrl = _ht->_oldCtrl;
+            _end = _ht->_end();
+        }
+
+        node & _node(size_t i) {
+            return i < _size ? _table[i] : _old[i - _size];
+        }
+
+        bool _occupied(size_t i) {
+            return (i < _size ? _ctrl[i] : _oldCtrl[i - _size]) != ControlGroup::EMPTY;
+        }
+
+        /**
+         * @return The first index at or after `i` that holds an element, found
+         * from the control bytes alone.
+         */
+        size_t _next(size_t i) {
+            if (i < _size) {
+                i = ControlGroup::next(_ctrl, i, _size);
+                if (i < _size) return i;
+            }
+            if (_old == nullptr) return _end;
+            return _size + ControlGroup::next(_oldCtrl, i - _size, _end - _size);
+        }
 
     public:
 
@@ -506,14 +1195,13 @@ protected:
             _ht(ht)
         {
             _ht->_controller.enter();
-            _table = _ht->_table;
-            _size = _ht->_controller.tableSize;
+            _fetch();
 
             if (ht->_size == 0) {
-                _i = _size;
+                _i = _end;
             }
             else {
-                while (_i < _size && ! _table[_i].occupied()) ++_i;
+                _i = _next(_i);
             }
         }
 
@@ -522,15 +1210,18 @@ protected:
             _ht(rhs._ht)
         {
             _ht->_controller.enter();
-            _table = _ht->_table;
-            _size = _ht->_controller.tableSize;
+            _fetch();
         }
 
         HashTableIterator(HashTableIterator &&rhs)
         :   _i(rhs._i),
             _ht(rhs._ht),
             _table(rhs._table),
-            _size(rhs._size)
+            _ctrl(rhs._ctrl),
+            _size(rhs._size),
+            _old(rhs._old),
+            _oldCtrl(rhs._oldCtrl),
+            _end(rhs._end)
         {
             rhs._ht = nullptr;
         }
@@ -547,8 +1238,7 @@ protected:
                 _ht = rhs._ht;
 
                 _ht->_controller.enter();
-                _table = _ht->_table;
-                _size = _ht->_controller.tableSize;
+                _fetch();
             }
             return *this;
         }
@@ -560,7 +1250,11 @@ protected:
                 _i = rhs._i;
                 _ht = rhs._ht;
                 _table = rhs._table;
+                _ctrl = rhs._ctrl;
                 _size = rhs._size;
+                _old = rhs._old;
+                _oldCtrl = rhs._oldCtrl;
+                _end = rhs._end;
 
                 rhs._ht = nullptr;
             }
@@ -575,17 +1269,15 @@ protected:
         bool operator>=(const HashTableIterator &rhs) const { return _i >= rhs._i; }
 
         reference operator*() {
-            return _table[_i].storage.n;
+            return _node(_i).storage.n;
         }
 
         pointer operator->() {
-            return &_table[_i].storage.n;
+            return &_node(_i).storage.n;
         }
 
         HashTableIterator & operator++() {
-            do {
-                ++_i;
-            } while (_i < _size && ! _table[_i].occupied());
+            _i = _next(_i + 1);
             return *this;
         }
 
@@ -598,7 +1290,7 @@ protected:
         HashTableIterator & operator--() {
             do {
                 --_i;
-            } while (_i > 0 && ! _table[_i].occupied());
+            } while (_i > 0 && ! _occupied(_i));
             return *this;
         }
 
@@ -609,96 +1301,926 @@ protected:
         }
     };
 
-    void _resize(size_t hashCollisions) {
-        // more collisions than current bucket size
-        if (
-            _controller.needToExpandBucket(hashCollisions)
-            || _controller.tableSize >= 2 * _size
-        ) {
-            // snapshot of bucketSize before lock
-            size_t s = _controller.bucketSize;
+    /**
+     * @brief RAII guard for an optimistic read-side section. Tables retired
+     * while a section is active are not freed until it ends.
+     */
+    class ReadSection {
+    private:
 
-            // bucket size may change while we acquire the lock
-            _controller.lock();
+        const Controller &_controller;
 
-            // if we are actually responsible for an increase, rehash
-            size_t oldTableSize = _controller.increaseBucketSize(s, hashCollisions);
-            if (oldTableSize != 0) {
-                if (_controller.tableSize == _size) {
-                    _controller.increaseNumberOfBuckets(_controller.nBuckets);
-                }
-                _rehash(oldTableSize);
-            }
+    public:
 
-            _controller.unlock();
+        ReadSection(const Controller &controller)
+        :   _controller(controller)
+        {
+            _controller.enterRead();
         }
-        else {
-            // snapshot of the number of buckets before lock
-            size_t s = _controller.nBuckets;
 
-            // number of buckets may change while we acquire the lock
-            _controller.lock();
-
-            // if we are actually responsible for an increase, rehash
-            size_t oldTableSize = _controller.increaseNumberOfBuckets(s);
-            if (oldTableSize != 0){
-                _rehash(oldTableSize);
-            }
+        ReadSection(const ReadSection &) = delete;
 
-            _controller.unlock();
+        ~ReadSection() {
+            _controller.exitRead();
         }
-    }
 
-    HashRange _findRange(size_t h) const {
-        return _controller.hashRange(h);
-    }
+        ReadSection & operator=(const ReadSection &) = delete;
+    };
 
-    template <typename K>
-    size_t _findNext(HashRange &range, size_t h, const K &k) const {
-        do {
-            if (
-                _table[range.pos].occupied()
-                && _table[range.pos].h == h
-                && _eq(_table[range.pos], k)
-            ) {
-                size_t retval = range.pos;
+    /**
+     * @brief RAII guard for a lookup with _read() or _readCopy(): an
+     * optimistic read-side section if elements are OptimisticallyReadable,
+     * otherwise registration with the controller, which keeps resizes from
+     * moving elements while they are compared.
+     */
+    class LookupSection {
+    private:
+
+        const Controller &_controller;
+
+    public:
+
+        LookupSection(const Controller &controller)
+        :   _controller(controller)
+        {
+            if (_OPTIMISTIC) _controller.enterRead();
+            else _controller.enter();
+        }
+
+        LookupSection(const LookupSection &) = delete;
+
+        ~LookupSection() {
+            if (_OPTIMISTIC) _controller.exitRead();
+            else _controller.exit();
+        }
+
+        LookupSection & operator=(const LookupSection &) = delete;
+    };
+
+    static node * _newTable(size_t tableSize) {
+        node *t = static_cast<node *>(table_allocator::allocate(tableSize, alignof(node)));
+        memset((void *) t, 0, tableSize * sizeof(node));
+        for (size_t i = 0; i < tableSize; ++i) new (t + i) node();
+        return t;
+    }
+
+    /**
+     * @return A table shared by all empty hash tables of this type. Empty
+     * tables point to it rather than allocating their own, so that empty
+     * containers hold no memory until their first insertion. Nothing is ever
+     * stored in it.
+     */
+    static node * _emptyTable() {
+        static node table[__MINIMUM_TABLE_SIZE];
+        return table;
+    }
+
+    static uint8_t * _emptyCtrl() {
+        static uint8_t ctrl[__MINIMUM_TABLE_SIZE + ControlGroup::WIDTH] = { };
+        return ctrl;
+    }
+
+    static void _deleteTable(node *t, size_t tableSize) {
+        if (t == _emptyTable()) return;
+        for (size_t i = 0; i < tableSize; ++i) t[i].~node();
+        table_allocator::release(t, tableSize);
+    }
+
+    static void _disposeTable(void *table, size_t tableSize) {
+        node *t = static_cast<node *>(table);
+        if (! std::is_trivially_destructible<storage_node>::value) {
+            for (size_t i = 0; i < tableSize; ++i) {
+                if (t[i].occupied()) t[i].release();
+            }
+        }
+        _deleteTable(t, tableSize);
+    }
+
+    static void _disposeCtrl(void *ctrl, size_t) {
+        if (ctrl != _emptyCtrl()) ControlGroup::dispose(ctrl, 0);
+    }
+
+    void _retire() {
+        if (_table != nullptr) {
+            _controller.retire(_table, _controller.tableSize, &_disposeTable);
+            _controller.retire(_ctrl, 0, &_disposeCtrl);
+        }
+        if (_old != nullptr) {
+            _controller.retire(_old, _oldGeometry.tableSize, &_disposeTable);
+            _controller.retire(_oldCtrl, 0, &_disposeCtrl);
+            _old = nullptr;
+            _oldCtrl = nullptr;
+        }
+    }
+
+    void _allocate() {
+        _table = _newTable(_controller.tableSize);
+        _ctrl = ControlGroup::allocate(_controller.tableSize);
+    }
+
+    /**
+     * @brief Empties the table without allocating, pointing it to the shared
+     * empty table. Any current table must have been retired.
+     */
+    void _reset() {
+        _controller.init(__MINIMUM_TABLE_SIZE);
+        _table = _emptyTable();
+        _ctrl = _emptyCtrl();
+        _size = 0;
+    }
+
+    /**
+     * @brief Allocates a table of the smallest size in place of the shared
+     * empty table, ahead of the first insertion.
+     */
+    void _materialize() {
+        _controller.lock();
+        if (_table == _emptyTable()) {
+            _controller.beginUpdate();
+            _allocate();
+            _controller.endUpdate();
+        }
+        _controller.unlock();
+    }
+
+    /**
+     * @return The end of the index space, including the table being migrated
+     * from while resizing.
+     */
+    size_t _end() const {
+        return _controller.tableSize + (_old != nullptr ? _oldGeometry.tableSize : 0);
+    }
+
+    node & _at(size_t i) const {
+        return i < _controller.tableSize ? _table[i] : _old[i - _controller.tableSize];
+    }
+
+    uint8_t & _ctrlAt(size_t i) const {
+        return i < _controller.tableSize ? _ctrl[i] : _oldCtrl[i - _controller.tableSize];
+    }
+
+    void _set(size_t i, size_t h, const storage_node &n) {
+        _at(i).set(h, n);
+        _ctrlAt(i) = ControlGroup::tag(h);
+    }
+
+    void _set(size_t i, size_t h, storage_node &&n) {
+        _at(i).set(h, std::move(n));
+        _ctrlAt(i) = ControlGroup::tag(h);
+    }
+
+    void _release(size_t i) {
+        _ctrlAt(i) = ControlGroup::EMPTY;
+        _at(i).release();
+    }
+
+    /**
+     * @return The first index at or after `i` that holds an element, or
+     * _end() if there is none.
+     */
+    size_t _next(size_t i) const {
+        size_t tableSize = _controller.tableSize;
+        if (i < tableSize) {
+            i = ControlGroup::next(_ctrl, i, tableSize);
+            if (i < tableSize) return i;
+        }
+        if (_old == nullptr) return tableSize;
+        return tableSize + ControlGroup::next(_oldCtrl, i - tableSize, _oldGeometry.tableSize);
+    }
+
+    /**
+     * @brief Splits the index space into n ranges of equal width, for
+     * traversing the table in parallel.
+     *
+     * @return n + 1 iterators, where partition p spans [bounds[p], bounds[p + 1]).
+     */
+    std::vector<HashTableIterator<const storage_node>> _partition(size_t n) const {
+        std::vector<HashTableIterator<const storage_node>> bounds;
+        bounds.reserve(n + 1);
+        size_t end = _end();
+        for (size_t p = 0; p <= n; ++p) bounds.emplace_back(end / n * p + std::min(p, end % n), this);
+        return bounds;
+    }
+
+    /**
+     * @brief Splits the index space into n ranges of equal width, for
+     * traversing the table in parallel.
+     *
+     * @return n + 1 iterators, where partition p spans [bounds[p], bounds[p + 1]).
+     */
+    std::vector<HashTableIterator<storage_node>> _partition(size_t n) {
+        std::vector<HashTableIterator<storage_node>> bounds;
+        bounds.reserve(n + 1);
+        size_t end = _end();
+        for (size_t p = 0; p <= n; ++p) bounds.emplace_back(end / n * p + std::min(p, end % n), this);
+        return bounds;
+    }
+
+    /**
+     * @brief Hints the processor to fetch the control bytes and the first node
+     * of the range where hash `h` may exist.
+     */
+    void _prefetch(size_t h) const {
+        size_t i = _controller.hashRange(h).pos;
+        __builtin_prefetch(_ctrl + i);
+        __builtin_prefetch(_table + i);
+    }
+
+    /**
+     * @brief Calls `f(h, it)` for every iterator `it` in [begin, end), where
+     * `h` is the hash of `key(*it)`. Every element of a batch is hashed and
+     * its range prefetched before the first one is resolved, so that the cache
+     * misses of independent lookups overlap instead of being paid one after
+     * another. The batch runs within whatever read-side section or controller
+     * registration the caller holds, which is thus taken once per call rather
+     * than once per key.
+     */
+    template <typename It, typename EndIt, typename KeyOf, typename F>
+    void _batch(const It &begin, const EndIt &end, KeyOf key, F f) const {
+        size_t h[__BATCH_SIZE];
+        It it = begin;
+
+        while (it != end) {
+            It first = it;
+            size_t n = 0;
+
+            for (; n < __BATCH_SIZE && it != end; ++n, ++it) {
+                h[n] = _hash(key(*it));
+                _prefetch(h[n]);
+            }
+
+            for (size_t j = 0; j < n; ++j, ++first) f(h[j], first);
+        }
+    }
+
+    /**
+     * @brief Rebuilds the control bytes of _table from its nodes.
+     */
+    void _rebuildControl() {
+        for (size_t i = 0; i < _controller.tableSize; ++i) {
+            _table[i].resetLock();
+            _ctrl[i] = _table[i].occupied() ? ControlGroup::tag(_table[i].h) : ControlGroup::EMPTY;
+        }
+    }
+
+    template <typename K>
+    static size_t _findIn(
+        node *table,
+        const uint8_t *ctrl,
+        HashRange &range,
+        size_t h,
+        const K &k,
+        const NodeKeyEqual &eq
+    ) {
+        return TableProbe<node>::find(table, ctrl, range, h, k, eq);
+    }
+
+    static size_t _freeIndexIn(node *table, const uint8_t *ctrl, HashRange range) {
+        return TableProbe<node>::freeIndex(table, ctrl, range);
+    }
+
+    static size_t _collisionsIn(node *table, const uint8_t *ctrl, HashRange range, size_t h) {
+        return TableProbe<node>::collisions(table, ctrl, range, h);
+    }
+
+    /**
+     * @brief Moves up to `count` slots of the old table into the current one,
+     * as a single update of the controller version. Must be called with the
+     * controller locked.
+     */
+    void _migrate(size_t count) {
+        if (_old == nullptr) return;
+
+        _controller.beginUpdate();
+        _migrateLocked(count);
+        _controller.endUpdate();
+    }
+
+    /**
+     * @brief Moves up to `count` slots of the old table into the current one.
+     * Must be called with the controller locked, within an update of the
+     * controller version.
+     */
+    void _migrateLocked(size_t count) {
+        if (_old == nullptr) return;
+
+        HashTableRecorder::RehashTimer timer(*this);
+
+        size_t end = _migrated + count < _oldGeometry.tableSize
+            ? _migrated + count
+            : _oldGeometry.tableSize;
+
+        for (; _migrated < end; ++_migrated) {
+            _migrated = ControlGroup::next(_oldCtrl, _migrated, end);
+            if (_migrated == end) break;
+
+            node &n = _old[_migrated];
+            if (n.occupied()) {
+                HashRange range = _controller.hashRange(n.h);
+                size_t j = _freeIndexIn(_table, _ctrl, range);
+                if (j == __NPOS) j = TableProbe<node>::displace(_table, _ctrl, _controller, range);
+                if (j == __NPOS) {
+                    // newly inserted keys filled the target range, so the
+                    // current table must grow before migration can continue
+                    HashTableController geometry = _controller;
+                    geometry.increaseNumberOfBuckets(geometry.nBuckets);
+                    _reshape(geometry);
+                    return;
+                }
+                _table[j].set(n.h, std::move(n.storage.n));
+                _ctrl[j] = ControlGroup::tag(n.h);
+                _oldCtrl[_migrated] = ControlGroup::EMPTY;
+                n.release();
+            }
+        }
+
+        if (_migrated == _oldGeometry.tableSize) {
+            _controller.retire(_old, 0, &_disposeTable);
+            _controller.retire(_oldCtrl, 0, &_disposeCtrl);
+            _old = nullptr;
+            _oldCtrl = nullptr;
+        }
+    }
+
+    /**
+     * @brief Moves every element of the current and old tables into a new
+     * table using the current geometry, ending any migration in progress. Must
+     * be called with the controller locked.
+     *
+     * @param tableSize The size of the current table, which may differ from
+     * the current geometry.
+     */
+    void _rebuild(size_t tableSize) {
+        node *table = _newTable(_controller.tableSize);
+        uint8_t *ctrl = ControlGroup::allocate(_controller.tableSize);
+
+        auto moveAll = [this, table, ctrl] (node *from, const uint8_t *fromCtrl, size_t begin, size_t end) {
+            for (size_t i = ControlGroup::next(fromCtrl, begin, end); i < end; i = ControlGroup::next(fromCtrl, i + 1, end)) {
+                if (from[i].occupied()) {
+                    size_t j = _freeIndexIn(table, ctrl, _controller.hashRange(from[i].h));
+                    if (j == __NPOS) throw 0;       // shouldn't get here
+                    table[j].set(from[i].h, std::move(from[i].storage.n));
+                    ctrl[j] = ControlGroup::tag(from[i].h);
+                    from[i].release();
+                }
+            }
+        };
+
+        moveAll(_table, _ctrl, 0, tableSize);
+        if (_old != nullptr) {
+            moveAll(_old, _oldCtrl, _migrated, _oldGeometry.tableSize);
+            _controller.retire(_old, 0, &_disposeTable);
+            _controller.retire(_oldCtrl, 0, &_disposeCtrl);
+            _old = nullptr;
+            _oldCtrl = nullptr;
+        }
+
+        _controller.retire(_table, 0, &_disposeTable);
+        _controller.retire(_ctrl, 0, &_disposeCtrl);
+        _table = table;
+        _ctrl = ctrl;
+    }
+
+    /**
+     * @brief Tests whether every element fits in a table of some geometry,
+     * placing them in the order _rebuild() would.
+     *
+     * @param[out] collisions If an element does not fit, the number of
+     * elements sharing its hash code.
+     */
+    bool _fits(const HashTableController &geometry, size_t &collisions) const {
+        uint8_t *ctrl = ControlGroup::allocate(geometry.tableSize);
+        bool fits = true;
+        size_t h = 0;
+
+        for (size_t i = _next(0), n = _end(); fits && i < n; i = _next(i + 1)) {
+            h = _at(i).h;
+            HashRange range = geometry.hashRange(h);
+            fits = false;
+            do {
+                if (ctrl[range.pos] == ControlGroup::EMPTY) {
+                    ctrl[range.pos] = ControlGroup::tag(0);
+                    fits = true;
+                    break;
+                }
                 range.next();
-                return retval;
+            } while (range.nonEmpty());
+        }
+
+        ControlGroup::dispose(ctrl, 0);
+
+        collisions = 0;
+        if (! fits) {
+            for (size_t i = _next(0), n = _end(); i < n; i = _next(i + 1)) {
+                if (_at(i).h == h) ++collisions;
             }
-            range.next();
-        } while (range.nonEmpty());
+        }
+        return fits;
+    }
+
+    /**
+     * @brief Moves every element into a new table of some geometry, growing
+     * the geometry first if the elements would not fit. Must be called with
+     * the controller locked.
+     */
+    void _reshape(HashTableController geometry) {
+        HashTableRecorder::RehashTimer timer(*this);
+        size_t collisions;
+        bool spread = false;
+        while (! _fits(geometry, collisions)) {
+            // more buckets cannot spread a run of equal hash codes, nor,
+            // if they did not help the last time, runs of consecutive ones
+            // that each overflow into the next bucket
+            if (spread || geometry.needToExpandBucket(collisions)) {
+                geometry.increaseBucketSize(geometry.bucketSize, collisions);
+                spread = false;
+            }
+            else {
+                geometry.increaseNumberOfBuckets(geometry.nBuckets);
+                spread = true;
+            }
+        }
+
+        size_t tableSize = _controller.tableSize;
+        _recordResize(static_cast<const HashTableController &>(_controller), geometry, static_cast<size_t>(_size));
+        static_cast<HashTableController &>(_controller) = geometry;
+        _rebuild(tableSize);
+    }
+
+    void _resize(size_t hashCollisions) {
+        // more collisions than current bucket size
+        if (
+            _controller.needToExpandBucket(hashCollisions)
+            || _controller.tableSize >= 2 * _size
+        ) {
+            // snapshot of bucketSize before lock
+            size_t s = _controller.bucketSize;
+
+            // bucket size may change while we acquire the lock
+            _controller.lock();
+            _controller.beginUpdate();
+
+            // a previous resize must be complete before starting a new one
+            _migrateLocked(_oldGeometry.tableSize);
+            HashTableController geometry = _controller;
+
+            // if we are actually responsible for an increase, rehash
+            size_t oldTableSize = _controller.increaseBucketSize(s, hashCollisions);
+            if (oldTableSize != 0) {
+                if (_controller.tableSize == _size) {
+                    _controller.increaseNumberOfBuckets(_controller.nBuckets);
+                }
+                _rehash(geometry);
+            }
+
+            _controller.endUpdate();
+            _controller.unlock();
+        }
+        else {
+            // snapshot of the number of buckets before lock
+            size_t s = _controller.nBuckets;
 
+            // number of buckets may change while we acquire the lock
+            _controller.lock();
+            _controller.beginUpdate();
+
+            // a previous resize must be complete before starting a new one
+            _migrateLocked(_oldGeometry.tableSize);
+            HashTableController geometry = _controller;
+
+            // if we are actually responsible for an increase, rehash
+            size_t oldTableSize = _controller.increaseNumberOfBuckets(s);
+            if (oldTableSize != 0){
+                _rehash(geometry);
+            }
+
+            _controller.endUpdate();
+            _controller.unlock();
+        }
+    }
+
+    TableRange _findRange(size_t h) const {
+        TableRange r;
+        r.range = _controller.hashRange(h);
+        r.oldRange = _old != nullptr ? _oldGeometry.hashRange(h) : r.range;
+        r.phase = 0;
+        return r;
+    }
+
+    template <typename K>
+    size_t _findNext(TableRange &r, size_t h, const K &k) const {
+        if (r.phase == 0) {
+            size_t i = _findIn(_table, _ctrl, r.range, h, k, _eq);
+            if (i == __NPOS || ! r.range.nonEmpty()) r.phase = _old != nullptr ? 1 : 2;
+            if (i != __NPOS) return i;
+        }
+        if (r.phase == 1) {
+            size_t i = _findIn(_old, _oldCtrl, r.oldRange, h, k, _eq);
+            if (i == __NPOS || ! r.oldRange.nonEmpty()) r.phase = 2;
+            if (i != __NPOS) return _controller.tableSize + i;
+        }
         return __NPOS;
     }
 
     template <typename K>
     size_t _findIndex(size_t h, const K &k) const {
-        // range of indices where our key should exist
-        HashRange range = _controller.hashRange(h);
+        size_t i = _findIndex(_table, _ctrl, _controller.hashRange(h), h, k);
+        if (i != __NPOS || _old == nullptr) return i;
 
-        do {
-            if (
-                _table[range.pos].occupied()
-                && _table[range.pos].h == h
-                && _eq(_table[range.pos], k)
-            ) return range.pos;
-            range.next();
-        } while (range.nonEmpty());
+        i = _findIndex(_old, _oldCtrl, _oldGeometry.hashRange(h), h, k);
+        return i == __NPOS ? i : _controller.tableSize + i;
+    }
 
-        return __NPOS;
+    template <typename K>
+    size_t _findIndex(node *table, const uint8_t *ctrl, HashRange range, size_t h, const K &k) const {
+        return _findIn(table, ctrl, range, h, k, _eq);
+    }
+
+    /**
+     * @brief Looks up a key without registering with the controller. Must be
+     * called within a ReadSection. Anything read from the returned node must
+     * be validated with `_controller.readValidate(version)` before use, and
+     * the lookup repeated if validation fails.
+     *
+     * @return A pointer to the node holding the key, or nullptr if the key does
+     * not exist.
+     */
+    template <typename K>
+    const storage_node * _optimisticFind(size_t h, const K &k, size_t &version) const {
+        const node *x = _optimisticFindNode(h, k, version);
+        return x != nullptr ? &x->storage.n : nullptr;
+    }
+
+    /**
+     * @brief Copies out of the element holding a key without registering
+     * with the controller, retrying until the copy is consistent with
+     * concurrent resizes and in-place updates. Must be called within a
+     * ReadSection.
+     *
+     * @param read A functor called with the element; it may be called again
+     * if the element changed while it was read.
+     * @return True if the key was found, false otherwise.
+     */
+    template <typename K, typename F>
+    bool _optimisticRead(size_t h, const K &k, F read) const {
+        size_t version;
+        while (true) {
+            const node *x = _optimisticFindNode(h, k, version);
+            if (x == nullptr) return false;
+            size_t seq = x->readBegin();
+            read(x->storage.n);
+            if (x->readValidate(seq) && _controller.readValidate(version)) return true;
+        }
+    }
+
+    static constexpr bool _OPTIMISTIC = OptimisticallyReadable<storage_node>::value;
+
+    /**
+     * @brief Reads the element holding a key consistently with concurrent
+     * writers: optimistically if elements are OptimisticallyReadable,
+     * otherwise with the element locked. Must be called within a
+     * LookupSection.
+     *
+     * @param read A functor called with the element; it may be called again
+     * if the element changed while it was read.
+     * @return True if the key was found, false otherwise.
+     */
+    template <typename K, typename F>
+    bool _read(size_t h, const K &k, F read) const {
+        return _read(h, k, read, std::integral_constant<bool, _OPTIMISTIC>());
+    }
+
+    template <typename K, typename F>
+    bool _read(size_t h, const K &k, F &read, std::true_type) const {
+        return _optimisticRead(h, k, read);
+    }
+
+    template <typename K, typename F>
+    bool _read(size_t h, const K &k, F &read, std::false_type) const {
+        HashTable *self = const_cast<HashTable *>(this);
+        return self->_lockedApply(h, k, [&read] (const storage_node &n) { read(n); });
+    }
+
+    /**
+     * @brief Copies something out of the element holding a key, like
+     * _read(), for types that need not be default constructible. Must be
+     * called within a LookupSection.
+     *
+     * @param copy A functor returning the copy made from the element.
+     * @param missing A functor returning the result if the key is not found,
+     * or throwing.
+     */
+    template <typename K, typename C, typename M>
+    auto _readCopy(size_t h, const K &k, C copy, M missing) const
+    -> decltype(copy(std::declval<const storage_node &>()))
+    {
+        return _readCopy(h, k, copy, missing, std::integral_constant<bool, _OPTIMISTIC>());
+    }
+
+    template <typename K, typename C, typename M>
+    auto _readCopy(size_t h, const K &k, C &copy, M &missing, std::true_type) const
+    -> decltype(copy(std::declval<const storage_node &>()))
+    {
+        size_t version;
+        while (true) {
+            const node *x = _optimisticFindNode(h, k, version);
+            if (x == nullptr) return missing();
+            size_t seq = x->readBegin();
+            auto retval = copy(x->storage.n);
+            if (x->readValidate(seq) && _controller.readValidate(version)) return retval;
+        }
+    }
+
+    template <typename K, typename C, typename M>
+    auto _readCopy(size_t h, const K &k, C &copy, M &missing, std::false_type) const
+    -> decltype(copy(std::declval<const storage_node &>()))
+    {
+        HashTable *self = const_cast<HashTable *>(this);
+        while (true) {
+            size_t i = self->_findIndex(h, k);
+            if (i == __NPOS) return missing();
+            node &x = self->_at(i);
+            NodeLock lock(x);
+            if (x.occupied() && x.h == h && _eq(x, k)) return copy(x.storage.n);
+        }
+    }
+
+    struct NodeLock {
+        node &x;
+
+        NodeLock(node &x)
+        :   x(x)
+        {
+            x.lock();
+        }
+
+        NodeLock(const NodeLock &) = delete;
+
+        ~NodeLock() {
+            x.unlock();
+        }
+
+        NodeLock & operator=(const NodeLock &) = delete;
+    };
+
+    /**
+     * @brief Applies a function to the element holding a key, with the
+     * element locked against concurrent updates and erasure. Must be called
+     * between `_controller.enter()` and `_controller.exit()`.
+     *
+     * @return True if the key was found, false otherwise.
+     */
+    template <typename K, typename F>
+    bool _lockedApply(size_t h, const K &k, F f) {
+        while (true) {
+            size_t i = _findIndex(h, k);
+            if (i == __NPOS) return false;
+            if (_lockedApplyAt(i, h, k, f)) return true;
+        }
+    }
+
+    /**
+     * @brief Applies a function to the element at index i with the element
+     * locked, if the element still holds the key once locked.
+     *
+     * @return True if the function was applied, false if the key moved away.
+     */
+    template <typename K, typename F>
+    bool _lockedApplyAt(size_t i, size_t h, const K &k, F &f) {
+        node &x = _at(i);
+        NodeLock lock(x);
+        if (! x.occupied() || x.h != h || ! _eq(x, k)) return false;
+        f(x.storage.n);
+        return true;
+    }
+
+    /**
+     * @brief Applies `update` to the element holding a key with the element
+     * locked, or, if the key is not found, calls `insert` with a claimed free
+     * index. Must be called between `_controller.enter()` and
+     * `_controller.exit()`.
+     */
+    template <typename K, typename U, typename I>
+    void _updateOrInsert(size_t h, const K &k, U update, I insert) {
+        while (true) {
+            size_t i = _findOrGetFreeIndex(h, k);
+            if (! _at(i).occupied()) {
+                insert(i);
+                return;
+            }
+            if (_lockedApplyAt(i, h, k, update)) return;
+        }
+    }
+
+    template <typename... Args>
+    void _emplace(size_t i, size_t h, Args&&... args) {
+        _at(i).emplace(h, std::forward<Args>(args)...);
+        _ctrlAt(i) = ControlGroup::tag(h);
+    }
+
+    /**
+     * @brief Looks up the node of a key like _optimisticFind().
+     */
+    template <typename K>
+    const node * _optimisticFindNode(size_t h, const K &k, size_t &version) const {
+        while (true) {
+            version = _controller.readBegin();
+            node *table = _table;
+            const uint8_t *ctrl = _ctrl;
+            node *old = _old;
+            const uint8_t *oldCtrl = _oldCtrl;
+            HashRange range = _controller.hashRange(h);
+            HashRange oldRange = old != nullptr ? _oldGeometry.hashRange(h) : range;
+            if (! _controller.readValidate(version)) continue;
+
+            size_t i = _findIndex(table, ctrl, range, h, k);
+            if (i != __NPOS) return &table[i];
+
+            if (old != nullptr) {
+                i = _findIndex(old, oldCtrl, oldRange, h, k);
+                if (i != __NPOS) return &old[i];
+            }
+
+            if (_controller.readValidate(version)) return nullptr;
+        }
+    }
+
+    /**
+     * @brief The progress of a weakly consistent scan under one table
+     * geometry: every element whose hash range starts before `cursor` in that
+     * geometry has been visited.
+     */
+    struct ScanLevel {
+        HashTableController geometry;
+        size_t cursor;
+    };
+
+    static bool _sameGeometry(const HashTableController &a, const HashTableController &b) {
+        return a.tableSize == b.tableSize && a.nBuckets == b.nBuckets && a.bucketSize == b.bucketSize;
+    }
+
+    /**
+     * @return True if an element with hash h was visited under a geometry the
+     * scan has since left behind.
+     */
+    static bool _scannedBefore(const std::vector<ScanLevel> &levels, size_t h) {
+        for (size_t j = 0; j + 1 < levels.size(); ++j) {
+            if (levels[j].geometry.hashRange(h).pos < levels[j].cursor) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Copies the elements of slots [begin, end) of a table whose hash
+     * range starts in [from, to) and that were not visited under an earlier
+     * geometry. Each copy is validated against the element's own lock if
+     * elements are OptimisticallyReadable, and made with the element locked
+     * otherwise.
+     */
+    static void _scanSlots(
+        node *table,
+        const uint8_t *ctrl,
+        size_t begin,
+        size_t end,
+        size_t from,
+        size_t to,
+        const std::vector<ScanLevel> &levels,
+        std::vector<storage_node> &out
+    ) {
+        const HashTableController &geometry = levels.back().geometry;
+        for (size_t i = ControlGroup::next(ctrl, begin, end); i < end; i = ControlGroup::next(ctrl, i + 1, end)) {
+            node &x = table[i];
+            if (! _OPTIMISTIC) {
+                NodeLock lock(x);
+                if (! x.occupied()) continue;
+                size_t pos = geometry.hashRange(x.h).pos;
+                if (pos >= from && pos < to && ! _scannedBefore(levels, x.h)) out.push_back(x.storage.n);
+                continue;
+            }
+            while (true) {
+                size_t seq = x.readBegin();
+                if (! x.occupied()) break;
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                size_t pos = geometry.hashRange(x.h).pos;
+                bool copied = pos >= from && pos < to && ! _scannedBefore(levels, x.h);
+                if (copied) out.push_back(x.storage.n);
+
+                if (x.readValidate(seq)) break;
+                if (copied) out.pop_back();
+            }
+        }
+    }
+
+    /**
+     * @brief Moves one step of a pending migration, as an insertion would.
+     */
+    void _migrationStep() {
+        _controller.enter();
+        _controller.lock();
+        _migrate(__MIGRATION_STEP);
+        _controller.unlock();
+        _controller.exit();
+    }
+
+    /**
+     * @brief Applies a function to a copy of every element without holding
+     * the controller lock across the scan, so concurrent writers are only ever
+     * held up for one migration step.
+     *
+     * Elements are visited in the order of the start of their hash range,
+     * one segment of positions at a time. A segment is copied within a
+     * ReadSection and validated against the controller version, and is
+     * copied again if the table changed meanwhile; the function is then called
+     * on the copies outside of the section. If a resize changes the geometry
+     * mid-scan, the scan continues under the new geometry, skipping elements
+     * whose range starts before the cursor of a geometry already left behind.
+     * A migration in progress is finished by the scan itself, in the same
+     * steps that insertions take.
+     *
+     * Every element present for the whole scan is visited exactly once.
+     * Elements inserted or erased during the scan may or may not be visited,
+     * and an element updated in place is visited with either its old or its
+     * new value.
+     */
+    template <typename F>
+    void _scan(F f) const {
+        HashTable *self = const_cast<HashTable *>(this);
+        std::vector<ScanLevel> levels;
+        std::vector<storage_node> batch;
+
+        while (true) {
+            bool migrating = false;
+            bool done = false;
+            {
+                ReadSection section(_controller);
+                size_t version = _controller.readBegin();
+                node *table = _table;
+                const uint8_t *ctrl = _ctrl;
+                migrating = _old != nullptr;
+                HashTableController geometry = _controller;
+                if (! _controller.readValidate(version)) continue;
+
+                if (! migrating) {
+                    if (geometry.tableSize == 0) return;
+                    if (levels.empty() || ! _sameGeometry(levels.back().geometry, geometry)) {
+                        levels.push_back({ geometry, 0 });
+                    }
+
+                    // elements starting in [from, to) lie within a window of
+                    // bucket search ranges past `to`
+                    size_t window = HashTableController::BUCKET_SEARCH * geometry.bucketSize;
+                    size_t from = levels.back().cursor;
+                    size_t to = from + (window > __SCAN_SEGMENT ? window : __SCAN_SEGMENT);
+                    if (to > geometry.tableSize) to = geometry.tableSize;
+                    size_t len = std::min(to - from + window, geometry.tableSize);
+
+                    batch.clear();
+                    size_t end = std::min(from + len, geometry.tableSize);
+                    _scanSlots(table, ctrl, from, end, from, to, levels, batch);
+                    if (from + len > geometry.tableSize) {
+                        _scanSlots(table, ctrl, 0, from + len - geometry.tableSize, from, to, levels, batch);
+                    }
+                    if (! _controller.readValidate(version)) continue;
+
+                    levels.back().cursor = to;
+                    done = to == geometry.tableSize;
+                }
+            }
+
+            if (migrating) {
+                self->_migrationStep();
+                continue;
+            }
+
+            for (const storage_node &x : batch) f(x);
+            if (done) return;
+        }
     }
 
     size_t _getFreeIndex(size_t h) {
+        if (_table == _emptyTable()) _materialize();
+
         begin:
+        if (_old != nullptr) {
+            _controller.lock();
+            _migrate(__MIGRATION_STEP);
+            _controller.unlock();
+        }
+
         // range of indices where our key should exist
         HashRange range = _controller.hashRange(h);
-        size_t collisions = 1;          // count hash collisions
 
-        do {
-            if (_table[range.pos].occupyIfFree()) return range.pos;
-            if (_table[range.pos].h == h) ++collisions;
-            range.next();
-        } while (range.nonEmpty());
+        size_t i = _freeIndexIn(_table, _ctrl, range);
+        if (i != __NPOS) return i;
+
+        size_t collisions = 1 + _collisionsIn(_table, _ctrl, range, h);
+        if (! _controller.needToExpandBucket(collisions)) {
+            _controller.lock();
+            i = _freeOrDisplacedIndex(h);
+            _controller.unlock();
+            if (i != __NPOS) return i;
+        }
 
         _resize(collisions);
         goto begin;
@@ -706,103 +2228,165 @@ protected:
 
     template <typename K>
     size_t _findOrGetFreeIndex(size_t h, const K &k) {
+        if (_table == _emptyTable()) _materialize();
+
         begin:
+        if (_old != nullptr) {
+            _controller.lock();
+            _migrate(__MIGRATION_STEP);
+            _controller.unlock();
+        }
+
+        // serializes insertions of the same key
+        size_t token = _controller.lockRange(h);
+
         // range of indices where our key should exist
         HashRange range = _controller.hashRange(h);
 
-        _controller.lock();
+        size_t i = _findIndex(_table, _ctrl, range, h, k);
+        if (i != __NPOS) {
+            _controller.unlockRange(token);
+            return i;
+        }
 
-        do {
-            if (_table[range.pos].h == h) {
-                if (_eq(_table[range.pos], k)) {
-                    _controller.unlock();
-                    return range.pos;
-                }
+        if (_old != nullptr) {
+            i = _findIndex(_old, _oldCtrl, _oldGeometry.hashRange(h), h, k);
+            if (i != __NPOS) {
+                _controller.unlockRange(token);
+                return _controller.tableSize + i;
             }
-            range.next();
-        } while (range.nonEmpty());
+        }
 
-        range = _controller.hashRange(h);
+        i = _freeIndexIn(_table, _ctrl, range);
+        if (i != __NPOS) {
+            _controller.unlockRange(token);
+            return i;
+        }
 
-        size_t collisions = 1;          // count hash collisions
+        size_t collisions = 1 + _collisionsIn(_table, _ctrl, range, h);
 
-        do {
-            if (_table[range.pos].occupyIfFree()) {
-                _controller.unlock();
-                return range.pos;
-            }
-            if (_table[range.pos].h == h) ++collisions;
-            range.next();
-        } while (range.nonEmpty());
+        _controller.unlockRange(token);
+
+        if (! _controller.needToExpandBucket(collisions)) {
+            _controller.lock();
+            // the key may have been inserted while the range was unlocked
+            i = _findIndex(h, k);
+            if (i == __NPOS) i = _freeOrDisplacedIndex(h);
+            _controller.unlock();
+            if (i != __NPOS) return i;
+        }
 
-        _controller.unlock();
         _resize(collisions);
         goto begin;
     }
 
-    size_t _getFreeIndex_noResize(size_t h) {
+    /**
+     * @brief Claims a free slot for hash `h` in the current table, displacing
+     * an element of its range if the range is full. Must be called with the
+     * controller locked.
+     *
+     * @return The claimed index, or __NPOS if the table must grow.
+     */
+    size_t _freeOrDisplacedIndex(size_t h) {
         HashRange range = _controller.hashRange(h);
+        size_t i = _freeIndexIn(_table, _ctrl, range);
+        if (i != __NPOS) return i;
 
-        do {
-            if (_table[range.pos].occupyIfFree()) return range.pos;
-            range.next();
-        } while (range.nonEmpty());
+        _controller.beginUpdate();
+        i = TableProbe<node>::displace(_table, _ctrl, _controller, range);
+        _controller.endUpdate();
+        return i;
+    }
 
-        throw 0;        // shouldn't get here
+    size_t _getFreeIndex_noResize(size_t h) {
+        size_t i = _freeIndexIn(_table, _ctrl, _controller.hashRange(h));
+        if (i == __NPOS) throw 0;        // shouldn't get here
+        return i;
     }
 
-    void _rehash(size_t oldTableSize) {
-        node *old = _table;
-        _table = new node[_controller.tableSize];
+    /**
+     * @brief Starts migrating the elements of the current table into a new
+     * table using the current geometry. Elements are moved a few slots at a time
+     * by subsequent insertions, so no single operation pays for the entire
+     * rehash. Must be called with the controller locked, within an update of
+     * the controller version.
+     *
+     * @param oldGeometry The geometry of the current table.
+     */
+    void _rehash(const HashTableController &oldGeometry) {
+        HashTableRecorder::RehashTimer timer(*this);
+        _recordResize(oldGeometry, static_cast<const HashTableController &>(_controller), static_cast<size_t>(_size));
 
-        for (size_t i = 0; i < oldTableSize; ++i) {
-            if (old[i].occupied()) {
-                size_t j = _getFreeIndex_noResize(old[i].h);
-                _table[j].set(old[i].h, std::move(old[i].storage.n));
-                old[i].release();
-            }
-        }
+        _old = _table;
+        _oldCtrl = _ctrl;
+        _oldGeometry = oldGeometry;
+        _migrated = 0;
+        _allocate();
 
-        delete[] old;
+        _migrateLocked(__MIGRATION_STEP);
     }
 
     void _move(HashTable &rhs) {
+        HashTableRecorder::operator=(rhs);
         _controller = rhs._controller;
         _table = rhs._table;
+        _ctrl = rhs._ctrl;
         _size = static_cast<size_t>(rhs._size);
+        _old = rhs._old;
+        _oldCtrl = rhs._oldCtrl;
+        _oldGeometry = rhs._oldGeometry;
+        _migrated = rhs._migrated;
     }
 
     void _copy(const HashTable &rhs) {
+        HashTableRecorder::operator=(HashTableRecorder());
+        if (rhs._table == _emptyTable()) {
+            _reset();
+            return;
+        }
+
         rhs._controller.enter();
         _controller = rhs._controller;
-        _table = new node[_controller.tableSize];
+        _allocate();
         _size = static_cast<size_t>(rhs._size);
-        for (size_t i = 0; i < _controller.tableSize; ++i) {
-            if (rhs._table[i].occupied()) {
-                size_t j = _getFreeIndex_noResize(rhs._table[i].h);
-                _table[j].set(rhs._table[i].h, rhs._table[i].storage.n);
+        for (size_t i = rhs._next(0), n = rhs._end(); i < n; i = rhs._next(i + 1)) {
+            node &x = rhs._at(i);
+            if (x.occupied()) {
+                _set(_getFreeIndex_noResize(x.h), x.h, x.storage.n);
             }
         }
         rhs._controller.exit();
     }
 
     void _freeNodes() {
-        for (size_t i = 0, sz = _size; i < _controller.tableSize && sz > 0; ++i) {
-            if (_table[i].occupied()) {
-                _table[i].release();
+        if (std::is_trivially_destructible<storage_node>::value) return;
+
+        for (size_t i = _next(0), n = _end(), sz = _size; i < n && sz > 0; i = _next(i + 1)) {
+            if (_at(i).occupied()) {
+                _at(i).release();
                 --sz;
             }
         }
     }
 
     void _dispose() {
-        if (_table != nullptr) delete[] _table;
+        if (_table != nullptr) {
+            _deleteTable(_table, _controller.tableSize);
+            _disposeCtrl(_ctrl, 0);
+        }
+        if (_old != nullptr) {
+            _deleteTable(_old, _oldGeometry.tableSize);
+            _disposeCtrl(_oldCtrl, 0);
+        }
     }
 
     void _invalidate() {
+        HashTableRecorder::operator=(HashTableRecorder());
         _controller = Controller();
-        _table = nullptr;
-        _size = 0;
+        _reset();
+        _old = nullptr;
+        _oldCtrl = nullptr;
+        _migrated = 0;
     }
 
     template <
@@ -812,20 +2396,26 @@ protected:
         , int>::type = 0
     >
     void _serialize(OutputStreamSerializer &serializer) const {
+        if (_old != nullptr && serializer.level() == SerializationLevel::PLAIN) {
+            // the plain layout is a dump of a single table
+            HashTable(*this)._serialize(serializer);
+            return;
+        }
+
         _controller.enter();
 
         size_t sz = static_cast<size_t>(_size);
 
-        serializer << _controller << sz;
+        serializer << static_cast<const HashTableController &>(_controller) << sz;
 
         if (serializer.level() == SerializationLevel::PLAIN) {
             serializer.put(_table, sizeof(node) * _controller.tableSize);
         }
         else {
-            for (size_t i = 0; i < _controller.tableSize && sz > 0; ++i) {
-                if (_table[i].occupied()) {
-                    serializer << _table[i].h;
-                    serializer << _table[i].storage.n;
+            for (size_t i = _next(0), n = _end(); i < n && sz > 0; i = _next(i + 1)) {
+                if (_at(i).occupied()) {
+                    serializer << _at(i).h;
+                    serializer << _at(i).storage.n;
                     --sz;
                 }
             }
@@ -842,18 +2432,23 @@ protected:
         , int>::type = 0
     >
     void _deserialize(InputStreamSerializer &serializer) {
-        _freeNodes();
-        _dispose();
+        _retire();
 
         size_t sz;
 
-        serializer >> _controller >> sz;
+        serializer >> static_cast<HashTableController &>(_controller) >> sz;
 
-        _table = new node[_controller.tableSize];
+        // a plain dump holds the table as is, otherwise size it for its elements
+        if (serializer.level() != SerializationLevel::PLAIN) {
+            _controller.reserve(sz, __MINIMUM_TABLE_SIZE);
+        }
+
+        _allocate();
         _size = sz;
 
         if (serializer.level() == SerializationLevel::PLAIN) {
             serializer.get(_table, sizeof(node) * _controller.tableSize);
+            _rebuildControl();
         }
         else {
             for (size_t i = 0; i < sz ; ++i) {
@@ -861,8 +2456,7 @@ protected:
                 storage_node n;
                 serializer >> h;
                 serializer >> n;
-                size_t j = _getFreeIndex_noResize(h);
-                _table[j].set(h, std::move(n));
+                _set(_getFreeIndex(h), h, std::move(n));
             }
         }
     }
@@ -878,12 +2472,12 @@ protected:
 
         size_t sz = static_cast<size_t>(_size);
 
-        serializer << _controller << sz;
+        serializer << static_cast<const HashTableController &>(_controller) << sz;
 
-        for (size_t i = 0; i < _controller.tableSize && sz > 0; ++i) {
-            if (_table[i].occupied()) {
-                serializer << _table[i].h;
-                _table[i].storage.n.writeObject(serializer);
+        for (size_t i = _next(0), n = _end(); i < n && sz > 0; i = _next(i + 1)) {
+            if (_at(i).occupied()) {
+                serializer << _at(i).h;
+                _at(i).storage.n.writeObject(serializer);
                 --sz;
             }
         }
@@ -898,14 +2492,14 @@ protected:
         , int>::type = 0
     >
     void _deserialize(InputStreamSerializer &serializer) {
-        _freeNodes();
-        _dispose();
+        _retire();
 
         size_t sz;
 
-        serializer >> _controller >> sz;
+        serializer >> static_cast<HashTableController &>(_controller) >> sz;
+        _controller.reserve(sz, __MINIMUM_TABLE_SIZE);
 
-        _table = new node[_controller.tableSize];
+        _allocate();
         _size = sz;
 
         for (size_t i = 0; i < sz ; ++i) {
@@ -913,8 +2507,7 @@ protected:
             storage_node n;
             serializer >> h;
             n.readObject(serializer);
-            size_t j = _getFreeIndex_noResize(h);
-            _table[j].set(h, std::move(n));
+            _set(_getFreeIndex(h), h, std::move(n));
         }
     }
 
@@ -938,12 +2531,228 @@ protected:
         );
     }
 
+    /**
+     * @brief The location of a chunk of a parallel serialization.
+     */
+    struct ChunkInfo {
+        size_t offset;  // absolute position of the chunk
+        size_t length;  // length of the chunk in bytes
+        size_t count;   // number of elements in the chunk
+    };
+
+    template <
+        typename X = storage_node,
+        typename std::enable_if<SupportsCustomSerialization<X>::value, int>::type = 0
+    >
+    static void _putNode(OutputStreamSerializer &serializer, const storage_node &n) {
+        n.writeObject(serializer);
+    }
+
+    template <
+        typename X = storage_node,
+        typename std::enable_if<! SupportsCustomSerialization<X>::value, int>::type = 0
+    >
+    static void _putNode(OutputStreamSerializer &serializer, const storage_node &n) {
+        serializer << n;
+    }
+
+    template <
+        typename X = storage_node,
+        typename std::enable_if<SupportsCustomSerialization<X>::value, int>::type = 0
+    >
+    static void _getNode(InputStreamSerializer &serializer, storage_node &n) {
+        n.readObject(serializer);
+    }
+
+    template <
+        typename X = storage_node,
+        typename std::enable_if<! SupportsCustomSerialization<X>::value, int>::type = 0
+    >
+    static void _getNode(InputStreamSerializer &serializer, storage_node &n) {
+        serializer >> n;
+    }
+
+    /**
+     * @brief Serializes the table as a header, an index, and one chunk per
+     * __CHUNK_SLOTS slots. Chunks are encoded and written concurrently, each
+     * at a position claimed once its length is known, and the index recording
+     * those positions is filled in last. A chunk is a dump of its slots at the
+     * PLAIN level, and otherwise holds its elements with their slot offsets,
+     * so that they can be put back in place without probing.
+     */
+    template <
+        typename X = storage_node,
+        typename std::enable_if<SupportsSerialization<X>::value, int>::type = 0
+    >
+    void _serializeChunked(OutputRandomAccessSerializer &serializer, size_t threads) const {
+        if (_old != nullptr) {
+            // chunks are taken from a single table
+            HashTable(*this)._serializeChunked(serializer, threads);
+            return;
+        }
+
+        _controller.enter();
+
+        size_t sz = static_cast<size_t>(_size);
+        size_t tableSize = _controller.tableSize;
+        size_t n = (tableSize + __CHUNK_SLOTS - 1) / __CHUNK_SLOTS;
+        bool raw = ! SupportsCustomSerialization<storage_node>::value
+            && serializer.level() == SerializationLevel::PLAIN;
+
+        serializer << static_cast<const HashTableController &>(_controller) << sz << n;
+
+        std::vector<ChunkInfo> index(n);
+        size_t indexPosition = serializer.tell();
+        serializer.put(index.data(), n * sizeof(ChunkInfo));
+        serializer.flush();
+
+        std::atomic<size_t> end(serializer.tell());
+
+        try {
+            parallelFor(n, parallelThreads(threads), [&] (size_t p) {
+                size_t begin = p * __CHUNK_SLOTS;
+                size_t last = std::min(begin + __CHUNK_SLOTS, tableSize);
+                ChunkInfo &c = index[p];
+
+                if (raw) {
+                    c.length = (last - begin) * sizeof(node);
+                    c.offset = end.fetch_add(c.length);
+                    c.count = 0;
+                    serializer.writeAt(c.offset, _table + begin, c.length);
+                    return;
+                }
+
+                OutputChunkSerializer chunk(serializer);
+                size_t prev = begin;
+                c.count = 0;
+                for (size_t i = ControlGroup::next(_ctrl, begin, last); i < last; i = ControlGroup::next(_ctrl, i + 1, last)) {
+                    if (_table[i].occupied()) {
+                        chunk << static_cast<uint32_t>(i - prev) << _table[i].h;
+                        _putNode(chunk, _table[i].storage.n);
+                        prev = i;
+                        ++c.count;
+                    }
+                }
+
+                const std::vector<uint8_t> &data = chunk.data();
+                c.length = data.size();
+                c.offset = end.fetch_add(c.length);
+                serializer.writeAt(c.offset, data.data(), c.length);
+            });
+        }
+        catch (...) {
+            _controller.exit();
+            throw;
+        }
+
+        _controller.exit();
+
+        serializer.seekTo(indexPosition);
+        serializer.put(index.data(), n * sizeof(ChunkInfo));
+        serializer.seekTo(end);
+    }
+
+    /**
+     * @brief Deserializes a table written by _serializeChunked(), decoding and
+     * placing its chunks concurrently. The table takes the geometry it was
+     * serialized with.
+     */
+    template <
+        typename X = storage_node,
+        typename std::enable_if<
+            SupportsSerialization<X>::value && std::is_constructible<X>::value
+        , int>::type = 0
+    >
+    void _deserializeChunked(InputRandomAccessSerializer &serializer, size_t threads) {
+        _retire();
+
+        size_t sz, n;
+
+        serializer >> static_cast<HashTableController &>(_controller) >> sz >> n;
+
+        size_t tableSize = _controller.tableSize;
+        if (n != (tableSize + __CHUNK_SLOTS - 1) / __CHUNK_SLOTS) {
+            _reset();
+            throw InvalidArgument("Malformed chunk index");
+        }
+
+        std::vector<ChunkInfo> index(n);
+        serializer.get(index.data(), n * sizeof(ChunkInfo));
+
+        _allocate();
+        _size = sz;
+
+        bool raw = ! SupportsCustomSerialization<storage_node>::value
+            && serializer.level() == SerializationLevel::PLAIN;
+
+        parallelFor(n, parallelThreads(threads), [&] (size_t p) {
+            size_t begin = p * __CHUNK_SLOTS;
+            size_t last = std::min(begin + __CHUNK_SLOTS, tableSize);
+            const ChunkInfo &c = index[p];
+
+            if (raw) {
+                if (c.length != (last - begin) * sizeof(node)) {
+                    throw InvalidArgument("Malformed chunk index");
+                }
+                serializer.readAt(c.offset, _table + begin, c.length);
+                for (size_t i = begin; i < last; ++i) {
+                    _ctrl[i] = _table[i].occupied() ? ControlGroup::tag(_table[i].h) : ControlGroup::EMPTY;
+                }
+                return;
+            }
+
+            std::vector<uint8_t> data(c.length);
+            serializer.readAt(c.offset, data.data(), c.length);
+            InputChunkSerializer chunk(serializer, data.data(), data.size());
+
+            size_t i = begin;
+            for (size_t k = 0; k < c.count; ++k) {
+                uint32_t delta;
+                size_t h;
+                storage_node x;
+                chunk >> delta >> h;
+                _getNode(chunk, x);
+                i += delta;
+                if (i >= last) throw InvalidArgument("Malformed chunk index");
+                _set(i, h, std::move(x));
+            }
+        });
+
+        size_t end = serializer.tell();
+        for (auto &c : index) end = std::max(end, c.offset + c.length);
+        serializer.seekTo(end);
+    }
+
+    template <
+        typename X = storage_node,
+        typename std::enable_if<! SupportsSerialization<X>::value, int>::type = 0
+    >
+    void _serializeChunked(OutputRandomAccessSerializer &serializer, size_t threads) const {
+        throw DynamicMessageError(
+            "Type '", typeid(storage_node).name(), "' cannot be serialized."
+        );
+    }
+
+    template <
+        typename X = storage_node,
+        typename std::enable_if<! SupportsSerialization<X>::value || ! std::is_constructible<X>::value, int>::type = 0
+    >
+    void _deserializeChunked(InputRandomAccessSerializer &serializer, size_t threads) {
+        throw DynamicMessageError(
+            "Type '", typeid(storage_node).name(), "' cannot be deserialized."
+        );
+    }
+
 public:
 
-    HashTable(size_t initialSize = __INITIAL_TABLE_SIZE) {
+    HashTable() {
+        _reset();
+    }
+
+    HashTable(size_t initialSize) {
         if (initialSize < __MINIMUM_TABLE_SIZE) initialSize = __MINIMUM_TABLE_SIZE;
         _controller.init(initialSize);
-        _table = new node[_controller.tableSize];
+        _allocate();
         _size = 0;
     }
 
@@ -967,9 +2776,10 @@ public:
         if (this != &rhs) {
             _controller.enter();
             _controller.lock();
-            _freeNodes();
-            _dispose();
+            _controller.beginUpdate();
+            _retire();
             _copy(rhs);
+            _controller.endUpdate();
             _controller.unlock();
             _controller.exit();
         }
@@ -980,10 +2790,11 @@ public:
         if (this != &rhs) {
             _controller.enter();
             _controller.lock();
-            _freeNodes();
-            _dispose();
+            _controller.beginUpdate();
+            _retire();
             _move(rhs);
             rhs._invalidate();
+            _controller.endUpdate();
             _controller.unlock();
             _controller.exit();
         }
@@ -1009,26 +2820,129 @@ public:
     }
 
     HashTableIterator<const storage_node> cend() const {
-        return HashTableIterator<const storage_node>(_controller.tableSize, this);
+        return HashTableIterator<const storage_node>(_end(), this);
     }
     HashTableIterator<storage_node> end() {
-        return HashTableIterator<storage_node>(_controller.tableSize, this);
+        return HashTableIterator<storage_node>(_end(), this);
     }
     HashTableIterator<const storage_node> end() const {
         return cend();
     }
 
+    /**
+     * @brief Grows the table to hold at least `n` elements without resizing.
+     */
+    void reserve(size_t n) {
+        _controller.enter();
+        _controller.lock();
+        _controller.beginUpdate();
+
+        HashTableController geometry = _controller;
+        geometry.reserve(n, __MINIMUM_TABLE_SIZE);
+        if (geometry.tableSize > _controller.tableSize) _reshape(geometry);
+
+        _controller.endUpdate();
+        _controller.unlock();
+        _controller.exit();
+    }
+
+    /**
+     * @brief Shrinks the table to the size its current elements need, and
+     * completes any resize in progress.
+     */
+    void shrinkToFit() {
+        _controller.enter();
+        _controller.lock();
+        _controller.beginUpdate();
+
+        HashTableController geometry = _controller;
+        geometry.reserve(_size, __MINIMUM_TABLE_SIZE);
+        if (geometry.tableSize < _controller.tableSize) _reshape(geometry);
+        else if (_old != nullptr) _reshape(_controller);
+
+        _controller.endUpdate();
+        _controller.unlock();
+        _controller.exit();
+    }
+
     void clear() {
         _controller.enter();
         _controller.lock();
-        _freeNodes();
-        _dispose();
-        _controller.init(__INITIAL_TABLE_SIZE);
-        _table = new node[_controller.tableSize];
-        _size = 0;
+        _controller.beginUpdate();
+        _retire();
+        _reset();
+        _controller.endUpdate();
         _controller.unlock();
         _controller.exit();
     }
+
+    /**
+     * @brief Scans the table to report its layout, along with its resize
+     * history if SPL_HASH_TABLE_STATS is defined. Takes time and temporary
+     * memory linear in the size of the table, and blocks writers of
+     * concurrent tables while scanning.
+     */
+    HashTableStats stats() const {
+        HashTable *self = const_cast<HashTable *>(this);
+        self->_controller.enter();
+        self->_controller.lock();
+
+        HashTableStats s;
+        s.size = static_cast<size_t>(_size);
+        s.tableSize = _controller.tableSize;
+        s.bucketSize = _controller.bucketSize;
+        s.buckets = _controller.nBuckets;
+        s.loadFactor = s.tableSize == 0 ? 0 : (double) s.size / s.tableSize;
+        s.migrating = _old != nullptr;
+
+        std::vector<size_t> loads(s.buckets, 0);
+        std::vector<size_t> hashes;
+        hashes.reserve(s.size);
+        size_t probes = 0;
+
+        for (size_t i = _next(0), n = _end(); i < n; i = _next(i + 1)) {
+            node &x = _at(i);
+            if (! x.occupied()) continue;
+
+            // elements not yet migrated are placed by the old geometry
+            bool old = i >= _controller.tableSize;
+            const HashTableController &geometry = old ? _oldGeometry : _controller;
+            size_t j = old ? i - _controller.tableSize : i;
+            size_t d = (j + geometry.tableSize - geometry.hashRange(x.h).pos) % geometry.tableSize;
+
+            if (d >= s.probeLengths.size()) s.probeLengths.resize(d + 1, 0);
+            ++s.probeLengths[d];
+            probes += d;
+            if (d >= geometry.bucketSize) ++s.overflowed;
+
+            ++loads[x.h % s.buckets];
+            hashes.push_back(x.h);
+        }
+
+        if (! hashes.empty()) {
+            s.maxProbeLength = s.probeLengths.size() - 1;
+            s.meanProbeLength = (double) probes / hashes.size();
+        }
+
+        for (size_t k : loads) {
+            if (k >= s.bucketLoads.size()) s.bucketLoads.resize(k + 1, 0);
+            ++s.bucketLoads[k];
+        }
+        if (! s.bucketLoads.empty()) s.maxBucketLoad = s.bucketLoads.size() - 1;
+
+        std::sort(hashes.begin(), hashes.end());
+        for (size_t i = 0, j; i < hashes.size(); i = j) {
+            for (j = i + 1; j < hashes.size() && hashes[j] == hashes[i]; ++j);
+            if (j - i > 1) s.duplicateHashes += j - i;
+            if (j - i > s.maxSameHash) s.maxSameHash = j - i;
+        }
+
+        _recordedStats(s);
+
+        self->_controller.unlock();
+        self->_controller.exit();
+        return s;
+    }
 };
 
 }   // core
@@ -10,6 +10,7 @@
 #include <exception.h>
 #include <iterator.h>
 #include <serialization.h>
+#include <core/node_pool.h>
 #include <type_traits>
 
 namespace spl {
@@ -186,7 +187,17 @@ struct AtomicSinglyLinkedNode {
 };
 
 
-template <typename T, typename node_type, typename size_type>
+/**
+ * @tparam node_allocator A type with static members `void * allocate()` and
+ * `void release(void *)` that provides memory for nodes. Defaults to a
+ * thread-caching core::NodePool.
+ */
+template <
+    typename T,
+    typename node_type,
+    typename size_type,
+    typename node_allocator = core::PooledAllocator<node_type>
+>
 class ListBase {
 
 protected:
@@ -274,12 +285,67 @@ protected:
         }
     };
 
-    static node * _mkNode(const T &data) {
-        return new node(data);
+    template <typename U>
+    static node * _mkNode(U &&data) {
+        void *mem = node_allocator::allocate();
+        try {
+            return new (mem) node(std::forward<U>(data));
+        }
+        catch (...) {
+            node_allocator::release(mem);
+            throw;
+        }
+    }
+
+    static void _freeNode(node *n) {
+        n->~node();
+        node_allocator::release(n);
+    }
+
+    template <typename Begin, typename End>
+    static node * _mkChain(const Begin &begin, const End &end, node *&last, size_type &count) {
+        node *first = nullptr;
+        last = nullptr;
+        count = 0;
+        try {
+            for (auto it = begin; it != end; ++it) {
+                node *n = _mkNode(*it);
+                if (last == nullptr) first = n;
+                else last->next = n;
+                last = n;
+                ++count;
+            }
+        }
+        catch (...) {
+            _freeChain(first);
+            throw;
+        }
+        return first;
     }
 
-    static node * _mkNode(T &&data) {
-        return new node(std::move(data));
+    static void _freeChain(node *first) {
+        while (first != nullptr) {
+            node *n = first;
+            first = first->next;
+            _freeNode(n);
+        }
+    }
+
+    template <typename OutputIt>
+    static void _drainChain(node *first, OutputIt &out) {
+        try {
+            while (first != nullptr) {
+                node *n = first;
+                *out = std::move(n->data);
+                ++out;
+                first = first->next;
+                _freeNode(n);
+            }
+        }
+        catch (...) {
+            _freeChain(first);
+            throw;
+        }
     }
 
     template <typename Begin, typename End>
@@ -342,7 +408,18 @@ protected:
 
     template <
         typename X = T,
-        typename std::enable_if<SupportsSerialization<X>::value, int>::type = 0
+        typename std::enable_if<
+            SupportsTrivialSerialization<X>::value && ! SupportsCustomSerialization<X>::value
+        , int>::type = 0
+    >
+    void _serialize(OutputStreamSerializer &serializer) const {
+        serializer << static_cast<size_t>(_size);
+        serializer.putRange<T>(begin(), _size);
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<SupportsCustomSerialization<X>::value, int>::type = 0
     >
     void _serialize(OutputStreamSerializer &serializer) const {
         serializer << static_cast<size_t>(_size);
@@ -363,7 +440,24 @@ protected:
 
     template <
         typename X = T,
-        typename std::enable_if<SupportsSerialization<X>::value && std::is_constructible<X>::value, int>::type = 0
+        typename std::enable_if<
+            SupportsTrivialSerialization<X>::value && ! SupportsCustomSerialization<X>::value
+            && std::is_constructible<X>::value
+        , int>::type = 0
+    >
+    void _deserialize(InputStreamSerializer &serializer) {
+        size_t sz;
+        serializer >> sz;
+        serializer.getRange<T>(sz, [this] (const T &elem) {
+            append(_mkNode(elem));
+        });
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<
+            SupportsCustomSerialization<X>::value && std::is_constructible<X>::value
+        , int>::type = 0
     >
     void _deserialize(InputStreamSerializer &serializer) {
         size_t sz;
@@ -404,7 +498,7 @@ public:
 
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_base_of<ListBase<T, node, size_type>, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_base_of<ListBase, Sequence>::value, int>::type = 0
     >
     ListBase(const Sequence &seq) {
         _copy(seq.begin(), seq.end());
@@ -412,7 +506,8 @@ public:
 
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_base_of<ListBase<T, node, size_type>, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_base_of<ListBase, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     ListBase(Sequence &&seq) {
         _move(seq.begin(), seq.end());
@@ -475,7 +570,7 @@ public:
     void clear() {
         while (_size > 0) {
             --_size;
-            delete static_cast<node *>(_head)->remove(nullptr, _head, _tail);
+            _freeNode(static_cast<node *>(_head)->remove(nullptr, _head, _tail));
         }
     }
 
@@ -491,6 +586,106 @@ public:
         ++_size;
     }
 
+    void appendChain(node *first, node *last, size_type count) {
+        // not thread safe
+
+        node *t = _tail;
+        if (t == nullptr) _head = first;
+        else t->next = first;
+        _tail = last;
+        _size += count;
+    }
+
+    node * takeFrontChain(size_type count) {
+        // not thread safe, count must be in [1, size]
+
+        node *first = _head;
+        node *last = first;
+        for (size_type i = 1; i < count; ++i) last = last->next;
+        _head = last->next;
+        if (_head == nullptr) _tail = nullptr;
+        last->next = nullptr;
+        _size -= count;
+        return first;
+    }
+
+    template <typename Compare>
+    void sort(Compare &comp) {
+        // not thread safe; a stable bottom-up merge sort that relinks nodes
+        // and never moves elements
+
+        size_t n = _size;
+        if (n < 2) return;
+
+        node *list = _head;
+        node *last = nullptr;
+        for (size_t width = 1; width < n; width *= 2) {
+            node *rest = list;
+            list = last = nullptr;
+            while (rest != nullptr) {
+                node *a = rest;
+                node *b = _splitChain(a, width);
+                rest = _splitChain(b, width);
+
+                node *first;
+                node *end;
+                _mergeChains(a, b, first, end, comp);
+                if (last == nullptr) list = first;
+                else last->next = first;
+                last = end;
+            }
+        }
+        _head = list;
+        _tail = last;
+    }
+
+private:
+
+    static node * _splitChain(node *first, size_t count) {
+        // cuts a chain after count nodes and returns the rest of it
+
+        if (first == nullptr) return nullptr;
+        for (size_t i = 1; i < count; ++i) {
+            node *n = first->next;
+            if (n == nullptr) return nullptr;
+            first = n;
+        }
+        node *rest = first->next;
+        first->next = nullptr;
+        return rest;
+    }
+
+    template <typename Compare>
+    static void _mergeChains(node *a, node *b, node *&first, node *&last, Compare &comp) {
+        // nodes of a come first among equal elements, which keeps sort() stable
+
+        first = last = nullptr;
+        while (a != nullptr && b != nullptr) {
+            node *n;
+            if (comp(b->data, a->data)) {
+                n = b;
+                b = b->next;
+            }
+            else {
+                n = a;
+                a = a->next;
+            }
+            if (last == nullptr) first = n;
+            else last->next = n;
+            last = n;
+        }
+
+        node *rest = a != nullptr ? a : b;
+        if (last == nullptr) first = rest;
+        else last->next = rest;
+        if (rest != nullptr) {
+            last = rest;
+            for (node *n = last->next; n != nullptr; n = n->next) last = n;
+        }
+    }
+
+public:
+
     void insertBefore(const IteratorBase &pos, node *n) {
         if (pos._node == nullptr) {
             append(n);
@@ -507,7 +702,7 @@ public:
 
     void insertAfter(const IteratorBase &pos, node *n) {
         if (pos._node == nullptr) {
-            delete n;
+            _freeNode(n);
             throw OutOfRangeError("Attempt to insert an element after a past-the-end iterator");
         }
         pos._node->insertAfter(n, _tail);
@@ -523,11 +718,11 @@ public:
         auto it = pos;
         pos._skipOne();
         --_size;
-        delete it._node->remove(
+        _freeNode(it._node->remove(
             it._prev,
             it._prev == nullptr ? _head : it._prev->next,
             _tail
-        );
+        ));
     }
 
     T remove(ListForwardIterator<T> &pos) {
@@ -545,7 +740,7 @@ public:
             _tail
         );
         T data = std::move(node->data);
-        delete node;
+        _freeNode(node);
         return data;
     }
 
@@ -558,7 +753,7 @@ public:
         } while(n == nullptr);
 
         T data = std::move(n->data);
-        delete n;
+        _freeNode(n);
         --_size;
         return data;
     }
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief A thread-caching pool of fixed-size memory blocks. Each thread keeps a
+ * private free list that serves allocations and releases without any
+ * synchronization. Threads exchange blocks with a shared free list in batches
+ * of __BATCH, and fresh blocks are carved out of contiguous slabs so that
+ * blocks allocated together lie close together in memory. Memory is never
+ * returned to the system.
+ *
+ * @tparam Size The block size.
+ * @tparam Align The block alignment.
+ */
+template <size_t Size, size_t Align>
+class NodePool {
+
+private:
+
+    struct Block {
+        Block *next;
+        Block *nextBatch;   // only used in the shared list
+    };
+
+    static constexpr size_t __MIN_SIZE = Size > sizeof(Block) ? Size : sizeof(Block);
+    static constexpr size_t __ALIGN = Align > alignof(Block) ? Align : alignof(Block);
+    static constexpr size_t __BLOCK_SIZE = (__MIN_SIZE + __ALIGN - 1) / __ALIGN * __ALIGN;
+    static constexpr size_t __SLAB_ALIGN = __ALIGN > 64 ? __ALIGN : 64;
+    static constexpr size_t __BATCH = 64;
+    static constexpr size_t __SLAB_BLOCKS = 256;
+
+    struct Cache {
+        Block *head;
+        size_t count;
+        bool registered;
+        bool dead;          // the thread is exiting
+    };
+
+    struct Flusher {
+        bool active = false;
+
+        ~Flusher() {
+            Cache &c = _cache;
+            while (c.count >= __BATCH) _flushBatch(c);
+
+            Central &central = _central();
+            std::lock_guard<std::mutex> lk(central.mtx);
+            while (c.head != nullptr) {
+                Block *b = c.head;
+                c.head = b->next;
+                b->next = central.loose;
+                central.loose = b;
+            }
+            c.count = 0;
+            c.dead = true;
+        }
+    };
+
+    struct Central {
+        std::mutex mtx;
+        Block *batches = nullptr;   // full batches, linked through nextBatch
+        Block *loose = nullptr;     // single blocks
+    };
+
+    static thread_local Cache _cache;
+    static thread_local Flusher _flusher;
+
+    static Central & _central() {
+        // never destroyed, since blocks may be released during static destruction
+        static Central *central = new Central();
+        return *central;
+    }
+
+    static void _register(Cache &c) {
+        _flusher.active = true;
+        c.registered = true;
+    }
+
+    static void _flushBatch(Cache &c) {
+        Block *batch = c.head;
+        Block *last = batch;
+        for (size_t i = 1; i < __BATCH; ++i) last = last->next;
+        c.head = last->next;
+        c.count -= __BATCH;
+        last->next = nullptr;
+
+        Central &central = _central();
+        std::lock_guard<std::mutex> lk(central.mtx);
+        batch->nextBatch = central.batches;
+        central.batches = batch;
+    }
+
+    static Block * _carve(Block *&head) {
+        void *mem;
+        if (posix_memalign(&mem, __SLAB_ALIGN, __BLOCK_SIZE * __SLAB_BLOCKS) != 0) {
+            throw std::bad_alloc();
+        }
+
+        char *slab = static_cast<char *>(mem);
+        for (size_t i = __SLAB_BLOCKS - 1; i > 0; --i) {
+            Block *b = reinterpret_cast<Block *>(slab + i * __BLOCK_SIZE);
+            b->next = head;
+            head = b;
+        }
+        return reinterpret_cast<Block *>(slab);
+    }
+
+    static void * _allocateSlow() {
+        Cache &c = _cache;
+        Central &central = _central();
+
+        if (c.dead) {
+            std::lock_guard<std::mutex> lk(central.mtx);
+            if (central.loose == nullptr) {
+                if (central.batches != nullptr) {
+                    central.loose = central.batches;
+                    central.batches = central.batches->nextBatch;
+                }
+                else {
+                    return _carve(central.loose);
+                }
+            }
+            Block *b = central.loose;
+            central.loose = b->next;
+            return b;
+        }
+
+        if (! c.registered) _register(c);
+
+        {
+            std::lock_guard<std::mutex> lk(central.mtx);
+
+            if (central.batches != nullptr) {
+                Block *batch = central.batches;
+                central.batches = batch->nextBatch;
+                c.head = batch->next;
+                c.count = __BATCH - 1;
+                return batch;
+            }
+
+            if (central.loose != nullptr) {
+                Block *b = central.loose;
+                c.head = b->next;
+                central.loose = nullptr;
+                c.count = 0;
+                for (Block *n = c.head; n != nullptr; n = n->next) ++c.count;
+                return b;
+            }
+        }
+
+        Block *b = _carve(c.head);
+        c.count = __SLAB_BLOCKS - 1;
+        return b;
+    }
+
+public:
+
+    /**
+     * @return A block of at least Size bytes aligned to Align.
+     */
+    static void * allocate() {
+        Cache &c = _cache;
+        Block *b = c.head;
+        if (b != nullptr) {
+            c.head = b->next;
+            --c.count;
+            return b;
+        }
+        return _allocateSlow();
+    }
+
+    /**
+     * @brief Returns a block to the pool. The block may have been allocated by
+     * any thread.
+     *
+     * @param p A block previously returned by allocate().
+     */
+    static void release(void *p) {
+        Block *b = static_cast<Block *>(p);
+        Cache &c = _cache;
+
+        if (c.dead) {
+            Central &central = _central();
+            std::lock_guard<std::mutex> lk(central.mtx);
+            b->next = central.loose;
+            central.loose = b;
+            return;
+        }
+
+        if (! c.registered) _register(c);
+
+        b->next = c.head;
+        c.head = b;
+        if (++c.count >= 2 * __BATCH) _flushBatch(c);
+    }
+};
+
+template <size_t Size, size_t Align>
+thread_local typename NodePool<Size, Align>::Cache NodePool<Size, Align>::_cache = {
+    nullptr, 0, false, false
+};
+
+template <size_t Size, size_t Align>
+thread_local typename NodePool<Size, Align>::Flusher NodePool<Size, Align>::_flusher;
+
+/**
+ * @brief Allocates storage for count objects of type T from the global heap,
+ * aligned to at least align.
+ */
+template <typename T>
+void * allocateArray(size_t count, size_t align) {
+    void *mem;
+    if (align < alignof(T)) align = alignof(T);
+    if (align < sizeof(void *)) align = sizeof(void *);
+    if (posix_memalign(&mem, align, count * sizeof(T)) != 0) throw std::bad_alloc();
+    return mem;
+}
+
+/**
+ * @brief An allocator serving nodes of type T from a NodePool. Arrays are
+ * served from the global heap.
+ *
+ * All spl allocators are stateless policies providing allocate() and
+ * release(p) for a single T, and allocate(count, align) and release(p, count)
+ * for arrays of T.
+ */
+template <typename T>
+struct PooledAllocator {
+
+    static void * allocate() {
+        return NodePool<sizeof(T), alignof(T)>::allocate();
+    }
+
+    static void release(void *p) {
+        NodePool<sizeof(T), alignof(T)>::release(p);
+    }
+
+    static void * allocate(size_t count, size_t align) {
+        return allocateArray<T>(count, align);
+    }
+
+    static void release(void *p, size_t) {
+        free(p);
+    }
+};
+
+/**
+ * @brief An allocator serving objects of type T from the global heap.
+ */
+template <typename T>
+struct HeapAllocator {
+
+    static void * allocate() {
+        return ::operator new(sizeof(T));
+    }
+
+    static void release(void *p) {
+        ::operator delete(p);
+    }
+
+    static void * allocate(size_t count, size_t align) {
+        return allocateArray<T>(count, align);
+    }
+
+    static void release(void *p, size_t) {
+        free(p);
+    }
+};
+
+}   // namespace core
+
+}   // namespace spl
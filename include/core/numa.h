@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief The NUMA topology of the machine, read once from sysfs. Nodes are
+ * numbered densely from 0 in the order the kernel lists them. On machines (or
+ * containers) without NUMA information, a single node holding every CPU is
+ * reported.
+ */
+class Numa {
+
+public:
+
+    /**
+     * @return The number of NUMA nodes, at least 1.
+     */
+    static size_t nodes();
+
+    /**
+     * @return The CPUs belonging to the given node.
+     */
+    static const std::vector<int> & cpus(size_t node);
+
+    /**
+     * @return The node of the CPU the calling thread is currently running on.
+     */
+    static size_t currentNode();
+
+    /**
+     * @brief Sets the preferred node for the pages of a memory range that have
+     * not been touched yet. This is a hint; failures are ignored.
+     *
+     * @param mem The page-aligned start of the range.
+     * @param len The length of the range.
+     * @param node The preferred node.
+     */
+    static void bind(void *mem, size_t len, size_t node);
+};
+
+}   // namespace core
+
+}   // namespace spl
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @return The number of threads a parallel operation should use, given the
+ * number requested by the caller: as many as OpenMP allows if 0 is requested,
+ * and always 1 without OpenMP.
+ */
+inline size_t parallelThreads(size_t threads) {
+#ifdef _OPENMP
+    if (threads == 0) threads = omp_get_max_threads();
+#else
+    threads = 1;
+#endif
+    return threads;
+}
+
+/**
+ * @brief Calls body(p) for every index p in [0, n), spreading the calls over
+ * the given number of threads. The first exception thrown by any call is
+ * rethrown once all threads are done.
+ */
+template <typename F>
+void parallelFor(size_t n, size_t threads, F body) {
+    std::exception_ptr error;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+#endif
+    for (size_t p = 0; p < n; ++p) {
+        try {
+            body(p);
+        }
+        catch (...) {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            if (! error) error = std::current_exception();
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+}
+
+}   // namespace core
+
+}   // namespace spl
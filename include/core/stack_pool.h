@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <cstddef>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <exception.h>
+#include <core/numa.h>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief A pool of fixed-size stacks for coroutines. Stacks are carved out of
+ * mmap'd slabs, each stack sitting directly above a PROT_NONE guard page so
+ * that overflowing it faults instead of silently corrupting its neighbor.
+ * Released stacks are reused in LIFO order, so the most recently used (and
+ * likely cache-warm) stack is handed out first. Memory is only returned to the
+ * system when the pool is destroyed. A pool may be tied to a NUMA node, in
+ * which case its slabs are placed on that node.
+ *
+ * This class is thread safe.
+ */
+class StackPool {
+
+private:
+
+    struct Slab {
+        void *mem;
+        size_t size;
+        Slab *next;
+    };
+
+    size_t _pageSize;
+    size_t _stackSize;
+    size_t _stacksPerSlab;
+    long _node;
+    std::mutex _mtx;
+    void *_free = nullptr;          // LIFO list, linked through each stack's top word
+    Slab *_slabs = nullptr;
+
+    void *& _link(void *stack) const {
+        return *reinterpret_cast<void **>(static_cast<char *>(stack) + _stackSize - sizeof(void *));
+    }
+
+    void _grow() {
+        size_t stride = _pageSize + _stackSize;
+        size_t size = stride * _stacksPerSlab;
+
+        void *mem = mmap(
+            nullptr,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE,
+            -1,
+            0
+        );
+        if (mem == MAP_FAILED) throw ErrnoRuntimeError();
+        if (_node >= 0) Numa::bind(mem, size, _node);
+
+        _slabs = new Slab { mem, size, _slabs };
+
+        // stacks grow down, so each guard page goes below its stack; push in
+        // reverse so that the slab is handed out in address order
+        for (size_t i = _stacksPerSlab; i > 0; --i) {
+            char *guard = static_cast<char *>(mem) + (i - 1) * stride;
+            if (mprotect(guard, _pageSize, PROT_NONE) != 0) throw ErrnoRuntimeError();
+
+            void *stack = guard + _pageSize;
+            _link(stack) = _free;
+            _free = stack;
+        }
+    }
+
+public:
+
+    /**
+     * @brief Construct a new StackPool object.
+     *
+     * @param stackSize The minimum usable size of each stack. The actual size
+     * is rounded up to a multiple of the page size.
+     * @param stacksPerSlab The number of stacks allocated at once whenever the
+     * pool runs out. (default = 16)
+     * @param node The NUMA node to place the stacks on, or -1 to leave
+     * placement to the first touch. (default = -1)
+     */
+    StackPool(size_t stackSize, size_t stacksPerSlab = 16, long node = -1)
+    :   _pageSize(sysconf(_SC_PAGESIZE)),
+        _stacksPerSlab(stacksPerSlab > 0 ? stacksPerSlab : 1),
+        _node(node)
+    {
+        _stackSize = (stackSize + _pageSize - 1) / _pageSize * _pageSize;
+        if (_stackSize == 0) _stackSize = _pageSize;
+    }
+
+    StackPool(const StackPool &) = delete;
+
+    StackPool(StackPool &&) = delete;
+
+    ~StackPool() {
+        while (_slabs != nullptr) {
+            Slab *next = _slabs->next;
+            munmap(_slabs->mem, _slabs->size);
+            delete _slabs;
+            _slabs = next;
+        }
+    }
+
+    StackPool & operator=(const StackPool &) = delete;
+
+    StackPool & operator=(StackPool &&) = delete;
+
+    /**
+     * @return The usable size of each stack in bytes.
+     */
+    size_t stackSize() const {
+        return _stackSize;
+    }
+
+    /**
+     * @brief Takes a stack from the pool, allocating a new slab if needed.
+     *
+     * @return A pointer to the lowest address of the stack, which spans
+     * stackSize() bytes.
+     */
+    void * allocate() {
+        std::lock_guard<std::mutex> lk(_mtx);
+        if (_free == nullptr) _grow();
+        void *stack = _free;
+        _free = _link(stack);
+        return stack;
+    }
+
+    /**
+     * @brief Returns a stack to the pool.
+     *
+     * @param stack A stack previously returned by allocate().
+     */
+    void release(void *stack) {
+        std::lock_guard<std::mutex> lk(_mtx);
+        _link(stack) = _free;
+        _free = stack;
+    }
+};
+
+}   // namespace core
+
+}   // namespace spl
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <stdint.h>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief A hierarchical timer wheel. Timers are inserted in constant time into
+ * one of __LEVELS wheels of __SLOTS slots each, where each level covers __SLOTS
+ * times the span of the level below it. Advancing the wheel fires the timers of
+ * the level-0 slot of every elapsed tick, cascading the slots of higher levels
+ * down as their span is reached. Timers never fire before their expiry time,
+ * and at most one tick after it.
+ *
+ * This class is not thread safe.
+ *
+ * @tparam T The type of values associated with timers.
+ */
+template <typename T>
+class TimerWheel {
+
+public:
+
+    using Clock = std::chrono::high_resolution_clock;
+    using TimePoint = Clock::time_point;
+
+private:
+
+    static constexpr unsigned __TICK_SHIFT = 16;    // 2^16 ns (~65 us) per tick
+    static constexpr unsigned __SLOT_BITS = 6;
+    static constexpr size_t __SLOTS = 1 << __SLOT_BITS;
+    static constexpr unsigned __LEVELS = 4;
+
+    struct Node {
+        T value;
+        uint64_t expiry;
+        Node *next;
+    };
+
+    Node *_slots[__LEVELS][__SLOTS];
+    uint64_t _occupied[__LEVELS];       // one bit per non-empty slot
+    Node *_due = nullptr;               // expired, not yet fired
+    Node *_free = nullptr;              // recycled nodes
+    uint64_t _now;                      // current tick
+    size_t _size = 0;
+    size_t _pending = 0;                // timers in the wheel but not due
+
+    static uint64_t _nanos(const TimePoint &t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t.time_since_epoch()
+        ).count();
+    }
+
+    static TimePoint _time(uint64_t tick) {
+        return TimePoint(
+            std::chrono::duration_cast<Clock::duration>(
+                std::chrono::nanoseconds(tick << __TICK_SHIFT)
+            )
+        );
+    }
+
+    static void _deleteAll(Node *n) {
+        while (n != nullptr) {
+            Node *next = n->next;
+            delete n;
+            n = next;
+        }
+    }
+
+    void _place(Node *n) {
+        if (n->expiry <= _now) {
+            n->next = _due;
+            _due = n;
+            return;
+        }
+
+        uint64_t delta = n->expiry - _now;
+        uint64_t expiry = n->expiry;
+
+        unsigned level = 0;
+        while (level < __LEVELS - 1 && delta >> (__SLOT_BITS * (level + 1)) != 0) ++level;
+
+        // beyond the span of the wheel, park in the farthest slot and re-place
+        // when it cascades
+        if (delta >> (__SLOT_BITS * __LEVELS) != 0) {
+            expiry = _now + (uint64_t(1) << (__SLOT_BITS * __LEVELS)) - 1;
+        }
+
+        size_t slot = (expiry >> (__SLOT_BITS * level)) & (__SLOTS - 1);
+        n->next = _slots[level][slot];
+        _slots[level][slot] = n;
+        _occupied[level] |= uint64_t(1) << slot;
+        ++_pending;
+    }
+
+    void _replace(unsigned level, size_t slot) {
+        Node *n = _slots[level][slot];
+        _slots[level][slot] = nullptr;
+        _occupied[level] &= ~(uint64_t(1) << slot);
+
+        while (n != nullptr) {
+            Node *next = n->next;
+            --_pending;
+            _place(n);
+            n = next;
+        }
+    }
+
+    /**
+     * @return The earliest tick after the current one at which the wheel has
+     * something to fire or cascade.
+     */
+    uint64_t _nextEvent() const {
+        size_t pos = _now & (__SLOTS - 1);
+        uint64_t ahead = _occupied[0] & ~((uint64_t(2) << pos) - 1);
+        if (ahead != 0) return (_now & ~uint64_t(__SLOTS - 1)) + __builtin_ctzll(ahead);
+        return (_now | (__SLOTS - 1)) + 1;
+    }
+
+    void _step() {
+        ++_now;
+
+        for (unsigned level = 1; level < __LEVELS; ++level) {
+            if ((_now & ((uint64_t(1) << (__SLOT_BITS * level)) - 1)) != 0) break;
+            _replace(level, (_now >> (__SLOT_BITS * level)) & (__SLOTS - 1));
+        }
+
+        _replace(0, _now & (__SLOTS - 1));
+    }
+
+public:
+
+    TimerWheel()
+    :   _now(_nanos(Clock::now()) >> __TICK_SHIFT)
+    {
+        for (unsigned l = 0; l < __LEVELS; ++l) {
+            for (size_t s = 0; s < __SLOTS; ++s) _slots[l][s] = nullptr;
+            _occupied[l] = 0;
+        }
+    }
+
+    TimerWheel(const TimerWheel &) = delete;
+
+    TimerWheel(TimerWheel &&) = delete;
+
+    ~TimerWheel() {
+        for (unsigned l = 0; l < __LEVELS; ++l) {
+            for (size_t s = 0; s < __SLOTS; ++s) _deleteAll(_slots[l][s]);
+        }
+        _deleteAll(_due);
+        _deleteAll(_free);
+    }
+
+    TimerWheel & operator=(const TimerWheel &) = delete;
+
+    TimerWheel & operator=(TimerWheel &&) = delete;
+
+    /**
+     * @brief Inserts a timer.
+     *
+     * @param value The value associated with the timer.
+     * @param expiry The time at which the timer fires.
+     * @return A reference to this object for chaining.
+     */
+    TimerWheel & insert(const T &value, const TimePoint &expiry) {
+        Node *n = _free;
+        if (n != nullptr) {
+            _free = n->next;
+            n->value = value;
+        }
+        else {
+            n = new Node { value, 0, nullptr };
+        }
+
+        // round up so that timers never fire early
+        n->expiry = (_nanos(expiry) + (uint64_t(1) << __TICK_SHIFT) - 1) >> __TICK_SHIFT;
+
+        _place(n);
+        ++_size;
+        return *this;
+    }
+
+    /**
+     * @brief Advances the wheel up to some time, firing expired timers.
+     *
+     * @param now The current time.
+     * @param f A function `void f(T &value)` called for the value of every
+     * expired timer.
+     * @return The number of timers fired.
+     */
+    template <typename Fn>
+    size_t advance(const TimePoint &now, Fn f) {
+        uint64_t target = _nanos(now) >> __TICK_SHIFT;
+
+        while (_now < target) {
+            uint64_t next = _pending > 0 ? _nextEvent() : target;
+            if (next > target) next = target;
+            _now = next - 1;
+            _step();
+        }
+
+        size_t count = 0;
+        while (_due != nullptr) {
+            Node *n = _due;
+            _due = n->next;
+            f(n->value);
+            n->next = _free;
+            _free = n;
+            ++count;
+        }
+
+        _size -= count;
+        return count;
+    }
+
+    /**
+     * @return A lower bound on the expiry time of the next timer to fire, or
+     * TimePoint::max() if there are no timers.
+     */
+    TimePoint nextExpiry() const {
+        if (_size == 0) return TimePoint::max();
+        if (_due != nullptr) return _time(_now);
+        return _time(_nextEvent());
+    }
+
+    /**
+     * @return The number of timers in the wheel.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @return A boolean indicating whether the wheel has no timers.
+     */
+    bool empty() const {
+        return _size == 0;
+    }
+};
+
+}   // namespace core
+
+}   // namespace spl
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <stdint.h>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief A Chase-Lev work-stealing deque. A single owner thread pushes and pops
+ * elements at the bottom without taking any lock, while any number of thief
+ * threads steal from the top. The buffer grows as needed; retired buffers are
+ * kept until destruction since thieves may still be reading from them.
+ *
+ * @tparam T The element type, which must be trivially copyable. A thief may
+ * copy a slot that is concurrently being overwritten, in which case its steal
+ * fails and the copy is discarded.
+ */
+template <typename T>
+class WorkStealingDeque {
+
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+private:
+
+    static constexpr size_t __INITIAL_CAPACITY = 256;
+
+    struct Buffer {
+        size_t mask;
+        Buffer *prev;
+        T data[1];
+
+        static Buffer * create(size_t capacity, Buffer *prev) {
+            void *mem = malloc(sizeof(Buffer) + (capacity - 1) * sizeof(T));
+            if (mem == nullptr) throw std::bad_alloc();
+            Buffer *b = static_cast<Buffer *>(mem);
+            b->mask = capacity - 1;
+            b->prev = prev;
+            return b;
+        }
+
+        T & at(int64_t i) {
+            return data[static_cast<size_t>(i) & mask];
+        }
+    };
+
+    // the owner's and the thieves' indices are kept on separate cache lines
+    std::atomic<int64_t> _top;
+    char _pad0[64 - sizeof(std::atomic<int64_t>)];
+    std::atomic<int64_t> _bottom;
+    char _pad1[64 - sizeof(std::atomic<int64_t>)];
+    std::atomic<Buffer *> _buffer;
+
+    Buffer * _grow(Buffer *a, int64_t t, int64_t b) {
+        Buffer *grown = Buffer::create(2 * (a->mask + 1), a);
+        for (int64_t i = t; i < b; ++i) grown->at(i) = a->at(i);
+        _buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+public:
+
+    WorkStealingDeque()
+    :   _top(0),
+        _bottom(0),
+        _buffer(Buffer::create(__INITIAL_CAPACITY, nullptr))
+    { }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+    WorkStealingDeque(WorkStealingDeque &&) = delete;
+
+    ~WorkStealingDeque() {
+        Buffer *b = _buffer.load(std::memory_order_relaxed);
+        while (b != nullptr) {
+            Buffer *prev = b->prev;
+            free(b);
+            b = prev;
+        }
+    }
+
+    WorkStealingDeque & operator=(const WorkStealingDeque &) = delete;
+
+    WorkStealingDeque & operator=(WorkStealingDeque &&) = delete;
+
+    /**
+     * @brief Pushes an element to the bottom of the deque. Must only be called
+     * by the owner thread.
+     *
+     * @param elem The element to push.
+     */
+    void push(const T &elem) {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_acquire);
+        Buffer *a = _buffer.load(std::memory_order_relaxed);
+
+        if (b - t > static_cast<int64_t>(a->mask)) a = _grow(a, t, b);
+
+        a->at(b) = elem;
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Pops the most recently pushed element from the bottom of the
+     * deque. Must only be called by the owner thread.
+     *
+     * @param[out] elem Receives the popped element.
+     * @return True if an element was popped, false if the deque is empty.
+     */
+    bool pop(T &elem) {
+        int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Buffer *a = _buffer.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // empty
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        elem = a->at(b);
+        if (t == b) {
+            // last element, race against thieves
+            bool won = _top.compare_exchange_strong(
+                t,
+                t + 1,
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed
+            );
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Steals the least recently pushed element from the top of the
+     * deque. May be called by any thread.
+     *
+     * @param[out] elem Receives the stolen element.
+     * @return True if an element was stolen, false if the deque is empty or
+     * the steal lost a race with another thread.
+     */
+    bool steal(T &elem) {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = _bottom.load(std::memory_order_acquire);
+
+        if (t >= b) return false;
+
+        Buffer *a = _buffer.load(std::memory_order_acquire);
+        elem = a->at(t);
+        return _top.compare_exchange_strong(
+            t,
+            t + 1,
+            std::memory_order_seq_cst,
+            std::memory_order_relaxed
+        );
+    }
+
+    /**
+     * @return The number of elements in the deque. The value is only a
+     * snapshot when other threads are operating on the deque.
+     */
+    size_t size() const {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    /**
+     * @return A boolean indicating whether the deque is empty. The value is
+     * only a snapshot when other threads are operating on the deque.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+};
+
+}   // namespace core
+
+}   // namespace spl
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <initializer_list>
 
 #include <core/linked_list.h>
@@ -20,18 +21,20 @@ namespace spl {
  * @brief Double-ended queue supporting O(1) enqueue and dequeue operations.
  * 
  * @tparam T The type of queue elements.
+ * @tparam Allocator The allocator policy used for queue nodes. The default
+ * allocator serves nodes from a thread-caching node pool.
 */
-template <typename T>
+template <typename T, template <typename> class Allocator = core::PooledAllocator>
 class Deque
-:   protected __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t>,
-    public ForwardIterableContainer<Deque<T>>,
+:   protected __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t, Allocator<__LinkedList::SinglyLinkedNode<T>>>,
+    public ForwardIterableContainer<Deque<T, Allocator>>,
     public Serializable
 {
 
     template <typename DequeType> friend struct DequeTester;
 
 protected:
-    using base = typename __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t>;
+    using base = typename __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t, Allocator<__LinkedList::SinglyLinkedNode<T>>>;
     using node = typename base::node;
     using base::_head;
     using base::_tail;
@@ -81,7 +84,10 @@ public:
      * 
      * @param seq An iterable container of type T objects.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     Deque(Sequence &&seq)
     :   base(std::move(seq))
     { }
@@ -120,8 +126,8 @@ public:
      * @return A new Deque object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static Deque<typename It::value_type> create(const It &begin, const EndIt &end) {
-        return Deque<typename It::value_type>(begin, end);
+    static Deque<typename It::value_type, Allocator> create(const It &begin, const EndIt &end) {
+        return Deque<typename It::value_type, Allocator>(begin, end);
     }
 
     /**
@@ -136,8 +142,8 @@ public:
      * @return A new Deque object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static Deque<typename It::value_type> create(const It &begin, const EndIt &end, size_t size) {
-        return Deque<typename It::value_type>(begin, end, size);
+    static Deque<typename It::value_type, Allocator> create(const It &begin, const EndIt &end, size_t size) {
+        return Deque<typename It::value_type, Allocator>(begin, end, size);
     }
 
     ~Deque() = default;
@@ -327,6 +333,22 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Enqueues all elements in a range to the back of the queue.
+     * 
+     * @param[in] begin A beginning iterator over type T objects.
+     * @param[in] end An end iterator over type T objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    Deque & enqueueAll(const Begin &begin, const End &end) {
+        node *last;
+        size_t count;
+        node *first = base::_mkChain(begin, end, last, count);
+        if (count > 0) base::appendChain(first, last, count);
+        return *this;
+    }
+
     /**
      * @brief Dequeues an element from the front of the queue.
      * 
@@ -358,6 +380,20 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Dequeues up to maxCount elements from the front of the queue.
+     * 
+     * @param[out] out An output iterator receiving the dequeued elements.
+     * @param[in] maxCount The maximum number of elements to dequeue.
+     * @return The number of elements dequeued.
+     */
+    template <typename OutputIt>
+    size_t dequeueUpTo(OutputIt out, size_t maxCount) {
+        size_t count = maxCount < base::size() ? maxCount : base::size();
+        if (count > 0) base::_drainChain(base::takeFrontChain(count), out);
+        return count;
+    }
+
     /**
      * @brief Inserts an element directly before an iterator position.
      * 
@@ -535,7 +571,10 @@ public:
      * 
      * @param seq An iterable container of type T objects.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     Deque(Sequence &&seq)
     :   base(std::move(seq)),
         _sem((int32_t) _size)
@@ -822,6 +861,27 @@ public:
         return enqueue(std::move(elem));
     }
 
+    /**
+     * @brief Enqueues all elements in a range to the back of the queue. The
+     * elements are linked outside the lock and spliced in at once.
+     * 
+     * @param[in] begin A beginning iterator over type T objects.
+     * @param[in] end An end iterator over type T objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    Deque & enqueueAll(const Begin &begin, const End &end) {
+        node *last;
+        size_t count;
+        node *first = base::_mkChain(begin, end, last, count);
+        if (count == 0) return *this;
+        _mtx.lock();
+        base::appendChain(first, last, count);
+        _mtx.unlock();
+        _sem.notify((uint32_t) count);
+        return *this;
+    }
+
     /**
      * @brief Dequeues an element from the front of the queue or blocks until an
      * element is available.
@@ -877,6 +937,24 @@ public:
         return data;
     }
 
+    /**
+     * @brief Dequeues an element from the front of the queue or blocks for the
+     * indicated timeout duration. Unlike dequeueOrTimeout, reaching the
+     * timeout is reported through the return value, which keeps polling loops
+     * free of exceptions.
+     * 
+     * @param[out] elem A reference to an element, left untouched on timeout.
+     * @param[in] timeoutNanos The timeout duration in nanoseconds.
+     * @return True if an element was dequeued, false if timeout was reached.
+     */
+    bool tryDequeueFor(T &elem, uint64_t timeoutNanos) {
+        if (! _sem.wait(timeoutNanos)) return false;
+        _mtx.lock();
+        elem = base::takeFront();
+        _mtx.unlock();
+        return true;
+    }
+
     /**
      * @brief Dequeues an element from the front of the queue or blocks for the
      * indicated timeout duration. If timeout is reached, a TimeoutError
@@ -923,6 +1001,32 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Dequeues up to maxCount elements from the front of the queue,
+     * blocking for the indicated timeout duration until at least one element
+     * is available. The elements are unlinked at once and moved out after the
+     * lock is released.
+     * 
+     * @param[out] out An output iterator receiving the dequeued elements.
+     * @param[in] maxCount The maximum number of elements to dequeue.
+     * @param[in] timeoutNanos The timeout duration in nanoseconds.
+     * @return The number of elements dequeued, or 0 if timeout is reached.
+     */
+    template <typename OutputIt>
+    size_t dequeueUpTo(OutputIt out, size_t maxCount, uint64_t timeoutNanos = 10000lu) {
+        if (maxCount == 0 || ! _sem.wait(timeoutNanos)) return 0;
+
+        uint32_t extra = maxCount - 1 > UINT32_MAX ? UINT32_MAX : (uint32_t) (maxCount - 1);
+        size_t count = 1 + _sem.tryWait(extra);
+
+        _mtx.lock();
+        node *first = base::takeFrontChain(count);
+        _mtx.unlock();
+
+        base::_drainChain(first, out);
+        return count;
+    }
+
     /**
      * @brief Inserts an element directly before an iterator position.
      * 
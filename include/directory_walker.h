@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <file.h>
+#include <thread.h>
+#include <functional>
+
+namespace spl {
+
+/**
+ * @brief Traverses directory trees in parallel. Directories are listed
+ * directly with getdents64(2), and entries are inspected and removed relative
+ * to the file descriptor of their directory, so that no list of the tree is
+ * ever built and no entry is stat()ed unless its type cannot be determined
+ * from the listing. Every subdirectory is listed as a separate task on a
+ * ThreadPool, so a traversal uses all workers of the walker.
+ *
+ * Symbolic links are never followed. A walker runs one traversal at a time.
+ */
+class DirectoryWalker {
+
+public:
+
+    /**
+     * @brief A function called for each entry found during a walk. The
+     * PathInfo object has the file type of the entry already filled in from
+     * the directory listing whenever possible; any other information is
+     * retrieved on first use. For directories, the return value indicates
+     * whether to descend into the directory; it is ignored for other entries.
+     * Visitors are called concurrently from multiple threads.
+     */
+    using Visitor = std::function<bool(const PathInfo &)>;
+
+private:
+
+    struct State;
+
+    State *_state;
+
+public:
+
+    /**
+     * @brief Construct a new DirectoryWalker object.
+     *
+     * @param threads The number of threads used for traversal. Zero indicates
+     * that traversals run sequentially on the calling thread.
+     * (default = Thread::availableCPUs())
+     */
+    DirectoryWalker(size_t threads = Thread::availableCPUs());
+
+    DirectoryWalker(const DirectoryWalker &) = delete;
+
+    DirectoryWalker(DirectoryWalker &&) = delete;
+
+    ~DirectoryWalker();
+
+    DirectoryWalker & operator=(const DirectoryWalker &) = delete;
+
+    DirectoryWalker & operator=(DirectoryWalker &&) = delete;
+
+    /**
+     * @brief Visits every entry below a directory, each directory before its
+     * contents. Blocks until the traversal is complete. If an error occurs,
+     * the traversal is stopped and the first error is rethrown.
+     *
+     * @param root The directory to traverse. The directory itself is not
+     * visited.
+     * @param visit The function called for each entry.
+     * @return A reference to this object for chaining.
+     */
+    DirectoryWalker & walk(const Path &root, const Visitor &visit);
+
+    /**
+     * @brief Removes a file, or a directory and all of its contents. Files
+     * are unlinked while their directory is listed, and each directory is
+     * removed once all of its contents are gone. Blocks until the traversal
+     * is complete. If an error occurs, the traversal is stopped and the first
+     * error is rethrown.
+     *
+     * @param root The file or directory to remove.
+     * @return A reference to this object for chaining.
+     */
+    DirectoryWalker & remove(const Path &root);
+
+    /**
+     * @return The number of threads used for traversal.
+     */
+    size_t threads() const;
+};
+
+}
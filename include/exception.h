@@ -224,7 +224,7 @@ public:
             s << _type;
             s << " at \"" << _function << "\" (" << _file << ":" << _line << "): ";
             s << _msg;
-            s << "\nCallstack:\n" << _callstack.toString();
+            if (! _callstack.empty()) s << "\nCallstack:\n" << _callstack.toString();
             const_cast<TraceableError *>(this)->_msg = strdup(s.str().c_str());
             const_cast<TraceableError *>(this)->_msgPrepared = true;
         }
@@ -11,16 +11,52 @@
 
 namespace spl {
 
+namespace core {
+
 /**
- * @brief Repository for class factory functions.
+ * @brief A registered factory: either a plain function pointer, called
+ * directly, or a type-erased std::function.
+ */
+struct FactoryEntry {
+    size_t code;
+    void (*fn)();               // void *(*)(Args...), or nullptr
+    void *function;             // std::function<void *(Args...)> *, or nullptr
+
+    bool empty() const {
+        return fn == nullptr && function == nullptr;
+    }
+};
+
+class FactoryCache;
+
+}   // namespace core
+
+/**
+ * @brief Repository for class factory functions. The repository is an
+ * open-addressed table that is rebuilt on every registration and published
+ * atomically, so lookups take no locks. Registrations normally all happen
+ * during static initialization.
 */
 class Factory {
 
+    friend class core::FactoryCache;
+
 private:
 
-    static void _put(size_t hashCode, void *factory);
+    static void _put(size_t hashCode, void (*fn)(), void *function);
 
-    static void * _get(size_t hashCode);
+    static const core::FactoryEntry * _find(size_t hashCode);
+
+    static const core::FactoryEntry & _get(size_t hashCode);
+
+    template <typename T, typename ...Args>
+    static T * _create(const core::FactoryEntry &e, Args ...args) {
+        return static_cast<T *>(
+            e.fn != nullptr
+                ? reinterpret_cast<void *(*)(Args...)>(e.fn)(args...)
+                : (*static_cast<std::function<void *(Args...)> *>(e.function))(args...)
+        );
+    }
 
     static size_t _hash(size_t code) {
         return code;
@@ -57,7 +93,7 @@ public:
         const std::type_info &type,
         const std::function<void *()> &factory
     ) {
-        _put(_hash(type), new std::function<void *()>(factory));
+        _put(_hash(type), nullptr, new std::function<void *()>(factory));
     }
 
     /**
@@ -73,7 +109,25 @@ public:
         const std::type_info &type,
         const std::function<void *(Args...)> &factory
     ) {
-        _put(_hash<Args...>(type), new std::function<void *(Args...)>(factory));
+        _put(_hash<Args...>(type), nullptr, new std::function<void *(Args...)>(factory));
+    }
+
+    /**
+     * @brief Registers the given class type and corresponding factory function.
+     * Plain function pointers are called directly when creating objects,
+     * without going through a std::function.
+     * 
+     * @tparam Args Factory function argument types.
+     * 
+     * @param[in] type Typeid of the class.
+     * @param[in] factory Factory function of the indicated class type.
+     */
+    template <typename ...Args>
+    static void registerFactory(
+        const std::type_info &type,
+        void *(*factory)(Args...)
+    ) {
+        _put(_hash<Args...>(type), reinterpret_cast<void (*)()>(factory), nullptr);
     }
 
     /**
@@ -81,15 +135,12 @@ public:
      * 
      * @tparam T Return type (only affects return pointer type).
      * @param[in] hashCode Hash code of the typeid of the actual desired class.
+     * @throws InvalidArgument if no factory is registered for the type.
      * @return A new instance of the desired type.
      */
     template <typename T>
     static T * createObject(size_t hashCode) {
-        return static_cast<T *>(
-            static_cast<std::function<void *()> *>(
-                _get(_hash(hashCode))
-            )->operator()()
-        );
+        return _create<T>(_get(_hash(hashCode)));
     }
 
     /**
@@ -98,15 +149,12 @@ public:
      * @tparam T Return type (only affects return pointer type).
      * @param[in] hashCode Hash code of the typeid of the actual desired class.
      * @param[in] args Factory function arguments.
+     * @throws InvalidArgument if no factory is registered for the type.
      * @return A new instance of the desired type.
      */
     template <typename T, typename ...Args>
     static T * createObject(size_t hashCode, Args ...args) {
-        return static_cast<T *>(
-            static_cast<std::function<void *(Args...)> *>(
-                _get(_hash<Args...>(hashCode))
-            )->operator()(args...)
-        );
+        return _create<T, Args...>(_get(_hash<Args...>(hashCode)), args...);
     }
 
     /**
@@ -114,6 +162,7 @@ public:
      * 
      * @tparam T Return type (only affects return pointer type).
      * @param[in] type [optional] Typeid of the actual desired class.
+     * @throws InvalidArgument if no factory is registered for the type.
      * @return A new instance of the desired type.
      */
     template <typename T>
@@ -127,14 +176,51 @@ public:
      * @tparam T Return type (only affects return pointer type).
      * @param[in] type Typeid of the actual desired class.
      * @param[in] args Factory function arguments.
+     * @throws InvalidArgument if no factory is registered for the type.
      * @return A new instance of the desired type.
      */
     template <typename T, typename ...Args>
     static T * createObject(const std::type_info &type, Args ...args) {
-        return createObject<T, Args...>(_hash<Args...>(type), args...);
+        return createObject<T, Args...>(_hash(type), args...);
+    }
+};
+
+namespace core {
+
+/**
+ * @brief A small direct-mapped cache of factory lookups, for callers that
+ * repeatedly create objects of a few types, such as deserializers. A hit costs
+ * a compare and a direct call of the factory.
+ */
+class FactoryCache {
+
+private:
+
+    static constexpr size_t __SLOTS = 4;
+
+    const FactoryEntry *_entries[__SLOTS] = { };
+
+public:
+
+    /**
+     * @brief Creates a new instance of the indicated object type, using a
+     * factory without arguments.
+     * 
+     * @tparam T Return type (only affects return pointer type).
+     * @param[in] hashCode Hash code of the typeid of the actual desired class.
+     * @throws InvalidArgument if no factory is registered for the type.
+     * @return A new instance of the desired type.
+     */
+    template <typename T>
+    T * createObject(size_t hashCode) {
+        const FactoryEntry *&e = _entries[hashCode & (__SLOTS - 1)];
+        if (e == nullptr || e->code != hashCode) e = &Factory::_get(hashCode);
+        return Factory::_create<T>(*e);
     }
 };
 
+}   // namespace core
+
 /**
  * @brief Registers a constructor as a factory method for the type T.
  * 
@@ -148,15 +234,14 @@ private:
         // to prevent the compiler from optimizing-out this entire struct
         bool initialized = false;
         _Init() {
-            Factory::registerFactory<Args...>(
-                typeid(T),
-                std::function<void *(Args...)>([] (Args... args) {
-                    return new T(args...);
-                })
-            );
+            Factory::registerFactory<Args...>(typeid(T), &_create);
         }
     } __init;
 
+    static void * _create(Args... args) {
+        return new T(args...);
+    }
+
 public:
     WithFactory() {
         __init.initialized = true;
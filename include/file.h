@@ -10,6 +10,9 @@
 #include <stdint.h>
 #include <limits.h>
 #include <string>
+#include <cstring>
+#include <algorithm>
+#include <new>
 #include <libgen.h>
 #include <sys/stat.h>
 #include <chrono>
@@ -19,97 +22,294 @@
 #include <list.h>
 #include <stdarg.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 #include <serialization.h>
+#include <io_ring.h>
 
 namespace spl {
 
+class DirectoryWalker;
+
 /**
- * @brief Represents the path of an object in the filesystem.
+ * @brief A non-owning reference to a path, or part of a path, in the
+ * filesystem. The referenced characters are not necessarily null-terminated,
+ * and must outlive the view.
+ */
+class PathView {
+
+private:
+
+    const char *_ptr = nullptr;
+    size_t _len = 0;
+
+    static constexpr char __SEPARATOR = '/';
+
+public:
+
+    /**
+     * @brief Construct a new empty PathView object.
+     */
+    PathView() = default;
+
+    /**
+     * @brief Construct a new PathView object.
+     * 
+     * @param path A null-terminated path.
+     */
+    PathView(const char *path)
+    :   _ptr(path),
+        _len(path == nullptr ? 0 : strlen(path))
+    { }
+
+    /**
+     * @brief Construct a new PathView object.
+     * 
+     * @param path The characters of the path.
+     * @param len The number of characters.
+     */
+    PathView(const char *path, size_t len)
+    :   _ptr(path),
+        _len(len)
+    { }
+
+    /**
+     * @brief Construct a new PathView object.
+     * 
+     * @param path The path to reference.
+     */
+    PathView(const std::string &path)
+    :   _ptr(path.data()),
+        _len(path.length())
+    { }
+
+    bool operator==(const PathView &rhs) const {
+        return _len == rhs._len && memcmp(_ptr, rhs._ptr, _len) == 0;
+    }
+
+    bool operator!=(const PathView &rhs) const {
+        return ! operator==(rhs);
+    }
+
+    /**
+     * @return A pointer to the characters of the path. These are not
+     * necessarily null-terminated.
+     */
+    const char * data() const {
+        return _ptr;
+    }
+
+    /**
+     * @return The number of characters in the path.
+     */
+    size_t length() const {
+        return _len;
+    }
+
+    /**
+     * @return True if the view is empty, false otherwise.
+     */
+    bool empty() const {
+        return _len == 0;
+    }
+
+    /**
+     * @brief Finds the parent of this path, following the semantics of
+     * dirname(3); e.g. the parent of "/a/b/" is "/a", and the parent of "a" is
+     * ".".
+     * 
+     * @return A view of the parent path, referencing the same characters.
+     */
+    PathView parent() const {
+        size_t len = _len;
+        while (len > 1 && _ptr[len - 1] == __SEPARATOR) --len;
+        while (len > 0 && _ptr[len - 1] != __SEPARATOR) --len;
+        if (len == 0) return PathView(".", 1);
+        while (len > 1 && _ptr[len - 1] == __SEPARATOR) --len;
+        return PathView(_ptr, len);
+    }
+
+    /**
+     * @brief Finds the base name of this path, following the semantics of
+     * basename(3); e.g. the base name of "/a/b/" is "b".
+     * 
+     * @return A view of the base name, referencing the same characters.
+     */
+    PathView base() const {
+        if (_len == 0) return PathView(".", 1);
+
+        size_t end = _len;
+        while (end > 1 && _ptr[end - 1] == __SEPARATOR) --end;
+        if (end == 1 && _ptr[0] == __SEPARATOR) return PathView(_ptr, 1);
+
+        size_t start = end;
+        while (start > 0 && _ptr[start - 1] != __SEPARATOR) --start;
+        return PathView(_ptr + start, end - start);
+    }
+
+    /**
+     * @return A string holding a copy of the path.
+     */
+    std::string str() const {
+        return std::string(_ptr, _len);
+    }
+};
+
+/**
+ * @brief Represents the path of an object in the filesystem. Paths shorter
+ * than INLINE_CAPACITY are held within the object without a heap allocation,
+ * and push() and pop() modify a path in place, reusing its buffer.
  */
 class Path {
 
+public:
+
+    static constexpr char SEPARATOR = '/';
+
+    /**
+     * @brief The size of the inline buffer, including the terminating null
+     * character.
+     */
+    static constexpr size_t INLINE_CAPACITY = 128;
+
 private:
 
     char *_path = nullptr;
+    size_t _len = 0;
+    size_t _capacity = 0;
+    char _inline[INLINE_CAPACITY];
 
-    static size_t _appendCount(const char *p) {
-        return strlen(p);
+    bool _onHeap() const {
+        return _path != nullptr && _path != _inline;
     }
 
-    template <typename ...C>
-    static size_t _appendCount(const char *p1, C ...p2) {
-        return strlen(p1) + 1 + _appendCount(p2...);
+    void _release() {
+        if (_onHeap()) free(_path);
+        _path = nullptr;
+        _len = 0;
+        _capacity = 0;
     }
 
-    static void _append(char *&ptr, const char *child) {
-        if (*(ptr - 1) != SEPARATOR) *ptr++ = SEPARATOR;
-        size_t l = strlen(child);
-        memcpy(ptr, child, l);
-        ptr += l;
+    /**
+     * @brief Makes room for a path of len characters, keeping the current
+     * contents.
+     */
+    void _reserve(size_t len) {
+        if (_path == nullptr && len < INLINE_CAPACITY) {
+            _path = _inline;
+            _capacity = INLINE_CAPACITY;
+            _path[0] = '\0';
+        }
+        if (len < _capacity) return;
+
+        size_t capacity = std::max(len + 1, 2 * _capacity);
+        char *p = (char *) malloc(capacity);
+        if (p == nullptr) throw std::bad_alloc();
+        if (_path != nullptr) memcpy(p, _path, _len + 1);
+        else p[0] = '\0';
+        if (_onHeap()) free(_path);
+        _path = p;
+        _capacity = capacity;
+    }
+
+    void _assign(const char *path, size_t len) {
+        _reserve(len);
+        memmove(_path, path, len);
+        _path[len] = '\0';
+        _len = len;
+    }
+
+    void _steal(Path &rhs) {
+        if (rhs._onHeap()) {
+            _path = rhs._path;
+            _len = rhs._len;
+            _capacity = rhs._capacity;
+        }
+        else if (rhs._path != nullptr) {
+            _assign(rhs._path, rhs._len);
+        }
+        rhs._path = nullptr;
+        rhs._len = 0;
+        rhs._capacity = 0;
+    }
+
+    static size_t _appendCount() {
+        return 0;
     }
 
     template <typename ...C>
-    static void _append(char *&ptr, const char *child, C ...c) {
-        _append(ptr, child);
-        _append(ptr, c...);
+    static size_t _appendCount(const char *child, C ...c) {
+        return 1 + strlen(child) + _appendCount(c...);
     }
 
-public:
+    void _push() { }
 
-    static constexpr char SEPARATOR = '/';
+    template <typename ...C>
+    void _push(const char *child, C ...c) {
+        size_t l = strlen(child);
+        if (_len > 0 && _path[_len - 1] != SEPARATOR) _path[_len++] = SEPARATOR;
+        memcpy(_path + _len, child, l);
+        _len += l;
+        _push(c...);
+    }
+
+public:
 
     /**
      * @brief Construct a new uninitialized Path object.
      */
-    Path()
-    :   _path(nullptr)
-    { }
+    Path() { }
 
     /**
      * @brief Construct a new Path object.
      * 
      * @param path The desired path to hold.
      */
-    Path(const char *path)
-    :   _path(strdup(path))
-    { }
+    Path(const char *path) {
+        _assign(path, strlen(path));
+    }
 
     /**
      * @brief Construct a new Path object.
      * 
      * @param path The desired path to hold.
      */
-    Path(const std::string &path)
-    :   Path(path.c_str())
-    { }
+    Path(const std::string &path) {
+        _assign(path.data(), path.length());
+    }
 
-    Path(const Path &rhs)
-    :   _path(rhs._path == nullptr ? nullptr : strdup(rhs._path))
-    { }
+    /**
+     * @brief Construct a new Path object.
+     * 
+     * @param path The desired path to hold.
+     */
+    Path(const PathView &path) {
+        _assign(path.data(), path.length());
+    }
 
-    Path(Path &&rhs)
-    :   _path(rhs._path)
-    {
-        rhs._path = nullptr;
+    Path(const Path &rhs) {
+        if (rhs._path != nullptr) _assign(rhs._path, rhs._len);
+    }
+
+    Path(Path &&rhs) {
+        _steal(rhs);
     }
 
     ~Path() {
-        if (_path != nullptr) free(_path);
+        _release();
     }
 
     Path & operator=(const Path& rhs) {
         if (this != &rhs) {
-            if (_path != nullptr) free(_path);
-            _path = rhs._path == nullptr ? nullptr : strdup(rhs._path);
+            if (rhs._path == nullptr) _release();
+            else _assign(rhs._path, rhs._len);
         }
         return *this;
     }
 
     Path & operator=(Path &&rhs) {
         if (this != &rhs) {
-            if (_path != nullptr) free(_path);
-            _path = rhs._path;
-            rhs._path = nullptr;
+            if (rhs._onHeap() || rhs._path == nullptr) _release();
+            _steal(rhs);
         }
         return *this;
     }
@@ -117,7 +317,8 @@ public:
     bool operator==(const Path &rhs) const {
         return _path != nullptr
             && rhs._path != nullptr
-            && strcmp(_path, rhs._path) == 0;
+            && _len == rhs._len
+            && memcmp(_path, rhs._path, _len) == 0;
     }
 
     bool operator!=(const Path &rhs) const {
@@ -131,6 +332,21 @@ public:
         return _path;
     }
 
+    /**
+     * @return The number of characters in the path.
+     */
+    size_t length() const {
+        return _len;
+    }
+
+    /**
+     * @return A non-owning view of this path, valid until this object is
+     * modified or destroyed.
+     */
+    PathView view() const {
+        return PathView(_path, _len);
+    }
+
     /**
      * @brief Fetches the real path to return a fully canonicalized path without
      * symbolic links.
@@ -138,12 +354,36 @@ public:
      * @return A new Path object that has the new real path.
      */
     Path realpath() const {
-        Path p;
-        p._path = ::realpath(_path, nullptr);
-        if (p._path == nullptr) {
+        char buf[PATH_MAX];
+        if (::realpath(_path, buf) == nullptr) {
             throw ErrnoRuntimeError();
         }
-        return p;
+        return Path(buf);
+    }
+
+    /**
+     * @brief Appends one or more children to this path object in place,
+     * growing the internal buffer only if needed.
+     * 
+     * @return A reference to this object for chaining.
+     */
+    template <typename ...Children>
+    Path & push(const char *child, Children... children) {
+        _reserve(_len + _appendCount(child, children...));
+        _push(child, children...);
+        _path[_len] = '\0';
+        return *this;
+    }
+
+    /**
+     * @brief Replaces this path by its parent in place (see parent()).
+     * 
+     * @return A reference to this object for chaining.
+     */
+    Path & pop() {
+        PathView p = view().parent();
+        _assign(p.data(), p.length());
+        return *this;
     }
 
     /**
@@ -153,18 +393,9 @@ public:
      */
     Path append(const char *child) const {
         Path p;
-        size_t l1 = strlen(_path);
-        size_t l2 = strlen(child);
-        p._path = (char *) malloc(l1 + l2 + 2);
-        char *ptr = p._path;
-
-        memcpy(ptr, _path, l1);
-        ptr += l1;
-
-        _append(ptr, child);
-
-        *ptr = '\0';
-
+        p._reserve(_len + _appendCount(child));
+        p._assign(_path, _len);
+        p.push(child);
         return p;
     }
 
@@ -176,17 +407,9 @@ public:
     template <typename ...Children>
     Path append(const char *child, Children... children) const {
         Path p;
-        p._path = (char *) malloc(_appendCount(_path, child, children...));
-
-        char *ptr = p._path;
-        size_t l1 = strlen(_path);
-        memcpy(ptr, _path, l1);
-        ptr += l1;
-
-        _append(ptr, child, children...);
-
-        *ptr = '\0';
-
+        p._reserve(_len + _appendCount(child, children...));
+        p._assign(_path, _len);
+        p.push(child, children...);
         return p;
     }
 
@@ -196,9 +419,7 @@ public:
      * @return A new Path object that has the paren't path.
      */
     Path parent() const {
-        Path p(*this);
-        dirname(p._path);
-        return p;
+        return Path(view().parent());
     }
 
     /**
@@ -207,10 +428,7 @@ public:
      * @return The base name.
      */
     std::string base() const {
-        char *p = strdup(_path);
-        std::string b(basename(p));
-        free(p);
-        return b;
+        return view().base().str();
     }
 };
 
@@ -220,10 +438,13 @@ public:
  */
 class PathInfo {
 
+    friend class DirectoryWalker;
+
 private:
 
     Path _path;
     struct stat *_stat;
+    mode_t _type = 0;   // file type known without a stat, e.g. from a directory listing
 
     void _fetchStat() const {
         if (_stat == nullptr) {
@@ -234,6 +455,36 @@ private:
         }
     }
 
+    mode_t _mode() const {
+        if (_stat == nullptr && _type != 0) return _type;
+        _fetchStat();
+        return _stat->st_mode;
+    }
+
+    /**
+     * @brief Construct a new PathInfo object whose file type is already known.
+     * 
+     * @param path Path of some filesystem object.
+     * @param type The file type bits (S_IFMT) of the object.
+     */
+    PathInfo(Path &&path, mode_t type)
+    :   _path(std::move(path)),
+        _stat(nullptr),
+        _type(type & S_IFMT)
+    { }
+
+    /**
+     * @brief Construct a new PathInfo object from already retrieved
+     * information.
+     * 
+     * @param path Path of some filesystem object.
+     * @param st The information of the object.
+     */
+    PathInfo(Path &&path, const struct stat &st)
+    :   _path(std::move(path)),
+        _stat(new struct stat(st))
+    { }
+
 public:
 
     /**
@@ -265,12 +516,14 @@ public:
 
     PathInfo(const PathInfo &rhs)
     :   _path(rhs._path),
-        _stat(rhs._stat == nullptr ? nullptr : new struct stat(*rhs._stat))
+        _stat(rhs._stat == nullptr ? nullptr : new struct stat(*rhs._stat)),
+        _type(rhs._type)
     { }
 
     PathInfo(PathInfo &&rhs)
     :   _path(std::move(rhs._path)),
-        _stat(std::move(rhs._stat))
+        _stat(std::move(rhs._stat)),
+        _type(rhs._type)
     {
         rhs._stat = nullptr;
     }
@@ -285,6 +538,7 @@ public:
 
             _path = rhs._path;
             _stat = rhs._stat == nullptr ? nullptr : new struct stat(*rhs._stat);
+            _type = rhs._type;
         }
         return *this;
     }
@@ -295,6 +549,7 @@ public:
 
             _path = std::move(rhs._path);
             _stat = rhs._stat;
+            _type = rhs._type;
             rhs._stat = nullptr;
         }
         return *this;
@@ -320,6 +575,7 @@ public:
             delete _stat;
             _stat = nullptr;
         }
+        _type = 0;
         return *this;
     }
 
@@ -345,40 +601,35 @@ public:
      * @return True if the object is a file, false otherwise.
      */
     bool isFile() const {
-        _fetchStat();
-        return S_ISREG(_stat->st_mode);
+        return S_ISREG(_mode());
     }
 
     /**
      * @return True if the object is a directory, false otherwise.
      */
     bool isDir() const {
-        _fetchStat();
-        return S_ISDIR(_stat->st_mode);
+        return S_ISDIR(_mode());
     }
 
     /**
      * @return True if the object is a character device, false otherwise.
      */
     bool isCharacterDevice() const {
-        _fetchStat();
-        return S_ISCHR(_stat->st_mode);
+        return S_ISCHR(_mode());
     }
 
     /**
      * @return True if the object is a block device, false otherwise.
      */
     bool isBlockDevice() const {
-        _fetchStat();
-        return S_ISBLK(_stat->st_mode);
+        return S_ISBLK(_mode());
     }
 
     /**
      * @return True if the object is a named pipe, false otherwise.
      */
     bool isPipe() const {
-        _fetchStat();
-        return S_ISFIFO(_stat->st_mode);
+        return S_ISFIFO(_mode());
     }
 
     /**
@@ -499,6 +750,7 @@ private:
 
     void *_mem = nullptr;
     size_t _size = 0;
+    bool _writeable = false;
 
     void _unmap() {
         if (_mem != nullptr) {
@@ -506,26 +758,86 @@ private:
         }
     }
 
+    /**
+     * @brief Extends a region to page boundaries, as required by the memory
+     * management system calls.
+     * 
+     * @param offset Offset of the region, rounded down to a page boundary.
+     * @param len Length of the region, rounded up to cover the original
+     * region. Zero indicates that the region extends to the end of the
+     * mapping.
+     * @return Pointer to the start of the region.
+     */
+    void * _region(size_t &offset, size_t &len) const {
+        if (offset > _size) throw OutOfRangeError("Region is outside the memory mapping");
+        if (len == 0 || len > _size - offset) len = _size - offset;
+
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t start = offset / page * page;
+        len += offset - start;
+        offset = start;
+        return (uint8_t *) _mem + start;
+    }
+
     /**
      * @brief Construct a new MemoryMapping object.
      * 
      * @param mem Pointer to the mapped memory.
      * @param size Size of the memory mapping.
+     * @param writeable Whether the memory mapping is writeable.
      */
-    MemoryMapping(void *mem, size_t size)
+    MemoryMapping(void *mem, size_t size, bool writeable)
     :   _mem(mem),
-        _size(size)
+        _size(size),
+        _writeable(writeable)
     { }
 
 public:
 
+    /**
+     * @brief An access hint indicating no special treatment.
+     */
+    static constexpr int NORMAL = MADV_NORMAL;
+
+    /**
+     * @brief An access hint indicating that the region will be accessed
+     * sequentially, so pages can be read ahead aggressively and freed soon
+     * after they are accessed.
+     */
+    static constexpr int SEQUENTIAL = MADV_SEQUENTIAL;
+
+    /**
+     * @brief An access hint indicating that the region will be accessed in
+     * random order, so reading ahead is not useful.
+     */
+    static constexpr int RANDOM = MADV_RANDOM;
+
+    /**
+     * @brief An access hint indicating that the region will be accessed soon,
+     * so its pages should be read ahead.
+     */
+    static constexpr int WILL_NEED = MADV_WILLNEED;
+
+    /**
+     * @brief An access hint indicating that the region will not be accessed
+     * soon, so its pages may be freed.
+     */
+    static constexpr int DONT_NEED = MADV_DONTNEED;
+
+    /**
+     * @brief A hint to back the region with transparent huge pages, reducing
+     * TLB misses. Only supported by some mappings; see madvise(2).
+     */
+    static constexpr int HUGE_PAGE = MADV_HUGEPAGE;
+
     MemoryMapping() = default;
 
     MemoryMapping(const MemoryMapping &) = delete;
 
     MemoryMapping(MemoryMapping &&rhs)
     :   _mem(rhs._mem),
-        _size(rhs._size)
+        _size(rhs._size),
+        _writeable(rhs._writeable)
     {
         rhs._mem = nullptr;
         rhs._size = 0;
@@ -543,6 +855,7 @@ public:
 
             _mem = rhs._mem;
             _size = rhs._size;
+            _writeable = rhs._writeable;
 
             rhs._mem = nullptr;
             rhs._size = 0;
@@ -595,6 +908,91 @@ public:
         flags |= block ? MS_SYNC : MS_ASYNC;
         if (msync(_mem, _size, flags) != 0) throw ErrnoRuntimeError();
     }
+
+    /**
+     * @return True if the memory mapping is writeable, false otherwise.
+     */
+    bool writeable() const {
+        return _writeable;
+    }
+
+    /**
+     * @brief Declares an expected access pattern for a region of the memory
+     * mapping. The region is extended to page boundaries.
+     * 
+     * @param advice One of the access hints; e.g. SEQUENTIAL or HUGE_PAGE.
+     * @param offset Offset of the region.
+     * @param len Length of the region. Zero indicates that the region extends
+     * to the end of the mapping.
+     * @return A reference to this object for chaining.
+     */
+    MemoryMapping & advise(int advice, size_t offset = 0, size_t len = 0) {
+        void *p = _region(offset, len);
+        if (madvise(p, len, advice) != 0) throw ErrnoRuntimeError();
+        return *this;
+    }
+
+    /**
+     * @brief Faults in all pages of a region of the memory mapping, reading
+     * them from the underlying storage if needed, so that subsequent accesses
+     * do not incur page faults. Writeable mappings are prefaulted for writing.
+     * 
+     * @param offset Offset of the region.
+     * @param len Length of the region. Zero indicates that the region extends
+     * to the end of the mapping.
+     * @return A reference to this object for chaining.
+     */
+    MemoryMapping & prefault(size_t offset = 0, size_t len = 0);
+
+    /**
+     * @brief Locks the pages of a region of the memory mapping in memory,
+     * faulting them in, so that they are never paged out (see mlock(2)).
+     * 
+     * @param offset Offset of the region.
+     * @param len Length of the region. Zero indicates that the region extends
+     * to the end of the mapping.
+     * @return A reference to this object for chaining.
+     */
+    MemoryMapping & lock(size_t offset = 0, size_t len = 0) {
+        void *p = _region(offset, len);
+        if (mlock(p, len) != 0) throw ErrnoRuntimeError();
+        return *this;
+    }
+
+    /**
+     * @brief Unlocks the pages of a region of the memory mapping previously
+     * locked by lock().
+     * 
+     * @param offset Offset of the region.
+     * @param len Length of the region. Zero indicates that the region extends
+     * to the end of the mapping.
+     * @return A reference to this object for chaining.
+     */
+    MemoryMapping & unlock(size_t offset = 0, size_t len = 0) {
+        void *p = _region(offset, len);
+        if (munlock(p, len) != 0) throw ErrnoRuntimeError();
+        return *this;
+    }
+
+    /**
+     * @brief Grows or shrinks the memory mapping in place when possible,
+     * without unmapping the existing pages (see mremap(2)). When growing a
+     * file mapping, the file should first be extended to cover the new size;
+     * accessing pages beyond the end of the file raises SIGBUS.
+     * 
+     * @param size The new size of the memory mapping.
+     * @param mayMove Whether the mapping may be relocated if it cannot be
+     * resized in place (default = true). If relocated, ptr() changes and
+     * pointers into the old mapping become invalid.
+     * @return A reference to this object for chaining.
+     */
+    MemoryMapping & resize(size_t size, bool mayMove = true) {
+        void *p = mremap(_mem, _size, size, mayMove ? MREMAP_MAYMOVE : 0);
+        if (p == MAP_FAILED) throw ErrnoRuntimeError();
+        _mem = p;
+        _size = size;
+        return *this;
+    }
 };
 
 /**
@@ -819,7 +1217,9 @@ public:
     }
 
     /**
-     * @brief Removes a directory and all of its contents.
+     * @brief Removes a directory and all of its contents. Symbolic links are
+     * removed without following them. See DirectoryWalker::remove() for a
+     * parallel variant.
      * 
      * @param[in] path The path of the directory to remove.
      */
@@ -993,6 +1393,22 @@ public:
         return _fd;
     }
 
+    /**
+     * @return True if this file has been open()ed for direct I/O, bypassing
+     * the page cache, false otherwise.
+     */
+    bool direct() const;
+
+    /**
+     * @brief Enables or disables direct I/O on this file, opening it if
+     * necessary. In direct mode, the addresses, lengths and offsets of reads
+     * and writes must be aligned to the block size of the underlying device.
+     * 
+     * @param enable Whether to bypass the page cache.
+     * @return A reference to this object for chaining.
+     */
+    File & setDirect(bool enable = true);
+
     /**
      * @brief Closes the underlying file descriptor associated with this file.
      * 
@@ -1175,6 +1591,27 @@ public:
      */
     void write(off_t offset, const void *buf, size_t len);
 
+    /**
+     * @brief Writes a sequence of data blocks, in order, starting at the
+     * current file position, using vectored writes.
+     * 
+     * @param[in] iov Array of data blocks.
+     * @param[in] count Number of data blocks.
+     */
+    void write(const iovec *iov, int count);
+
+    /**
+     * @brief Writes a sequence of data blocks, in order, starting at the
+     * specified offset, using vectored writes. The internal file position is
+     * unaffected by this function.
+     * 
+     * @param[in] offset The offset (from the beginning of the file) to start
+     * the write operation.
+     * @param[in] iov Array of data blocks.
+     * @param[in] count Number of data blocks.
+     */
+    void write(off_t offset, const iovec *iov, int count);
+
     /**
      * @return The current file position.
      */
@@ -1216,6 +1653,15 @@ public:
      */
     File & allocate(off_t offset, off_t len);
 
+    /**
+     * @brief Truncates or extends the file to the given length. Extended
+     * regions read as zeros.
+     * 
+     * @param len The new length of the file.
+     * @return A reference to this object for chaining.
+     */
+    File & truncate(off_t len);
+
     /**
      * @brief Deallocated disk space within a file, leaving a hole.
      * 
@@ -1244,6 +1690,96 @@ public:
      */
     File & collapse(off_t offset, off_t len);
 
+    /**
+     * @brief Queues an asynchronous read of a block of data starting at the
+     * specified offset. The operation is sent to the kernel with the next
+     * submit() on the ring, and its completion is retrieved from the ring.
+     * 
+     * @param[in] offset The offset (from the beginning of the file) to start
+     * the read operation.
+     * @param[out] buf The destination buffer, which must remain valid until the
+     * operation completes.
+     * @param[in] len The number of bytes to read.
+     * @param[in] tag A value returned with the completion.
+     * @param[in] ring The ring to queue the operation on (default = the ring of
+     * the calling thread).
+     * @return A reference to this object for chaining.
+     */
+    File & readAsync(off_t offset, void *buf, size_t len, uint64_t tag, IORing &ring = IORing::local()) {
+        if (_fd == -1) open();
+        ring.read(_fd, offset, buf, len, tag);
+        return *this;
+    }
+
+    /**
+     * @brief Queues an asynchronous write of a block of data starting at the
+     * specified offset. The operation is sent to the kernel with the next
+     * submit() on the ring, and its completion is retrieved from the ring.
+     * 
+     * @param[in] offset The offset (from the beginning of the file) to start
+     * the write operation.
+     * @param[in] buf The source buffer, which must remain valid and unmodified
+     * until the operation completes.
+     * @param[in] len The number of bytes to write.
+     * @param[in] tag A value returned with the completion.
+     * @param[in] ring The ring to queue the operation on (default = the ring of
+     * the calling thread).
+     * @return A reference to this object for chaining.
+     */
+    File & writeAsync(off_t offset, const void *buf, size_t len, uint64_t tag, IORing &ring = IORing::local()) {
+        if (_fd == -1) open();
+        ring.write(_fd, offset, buf, len, tag);
+        _info.clear();
+        return *this;
+    }
+
+    /**
+     * @brief Queues an asynchronous synchronization of the file with its
+     * storage device.
+     * 
+     * @param[in] tag A value returned with the completion.
+     * @param[in] dataOnly If true, only data and the metadata required to
+     * retrieve it are synchronized (default = false).
+     * @param[in] ring The ring to queue the operation on (default = the ring of
+     * the calling thread).
+     * @return A reference to this object for chaining.
+     */
+    File & syncAsync(uint64_t tag, bool dataOnly = false, IORing &ring = IORing::local()) {
+        if (_fd == -1) open();
+        ring.sync(_fd, dataOnly, tag);
+        return *this;
+    }
+
+    /**
+     * @brief Queues an asynchronous allocation of disk space within the file.
+     * 
+     * @param offset Offset of the allocated area.
+     * @param len Length of the allocated area.
+     * @param[in] tag A value returned with the completion.
+     * @param[in] ring The ring to queue the operation on (default = the ring of
+     * the calling thread).
+     * @return A reference to this object for chaining.
+     */
+    File & allocateAsync(off_t offset, off_t len, uint64_t tag, IORing &ring = IORing::local()) {
+        if (_fd == -1) open();
+        ring.allocate(_fd, 0, offset, len, tag);
+        _info.clear();
+        return *this;
+    }
+
+    /**
+     * @brief Declares an expected access pattern for a region of the file,
+     * allowing the kernel to optimize caching and readahead accordingly.
+     * 
+     * @param advice One of the POSIX_FADV_* constants; e.g.
+     * POSIX_FADV_SEQUENTIAL or POSIX_FADV_WILLNEED.
+     * @param offset Offset of the region.
+     * @param len Length of the region. Zero indicates that the region extends
+     * to the end of the file.
+     * @return A reference to this object for chaining.
+     */
+    File & advise(int advice, off_t offset = 0, off_t len = 0);
+
     /**
      * @brief Creates a memory mapping of a region in the file.
      * 
@@ -1252,9 +1788,12 @@ public:
      * @param writeable Determines whether the memory mapping should be
      * writeable. If the writable=false, then the memory mapping will be
      * write-protected.
+     * @param populate Whether to read the whole region and fault in its pages
+     * when it is mapped, so that first accesses do not incur page faults
+     * (default = false).
      * @return The memory mapped buffer.
      */
-    MemoryMapping map(off_t offset, size_t len, bool writeable = true);
+    MemoryMapping map(off_t offset, size_t len, bool writeable = true, bool populate = false);
 
     /**
      * @brief Creates a memory mapping of the entire file.
@@ -1262,10 +1801,13 @@ public:
      * @param writeable Determines whether the memory mapping should be
      * writeable. If the writable=false, then the memory mapping will be
      * write-protected.
+     * @param populate Whether to read the whole file and fault in its pages
+     * when it is mapped, so that first accesses do not incur page faults
+     * (default = false).
      * @return The memory mapped buffer.
      */
-    MemoryMapping map(bool writeable = true) {
-        return map(0, (size_t) _info.clear().length(), writeable);
+    MemoryMapping map(bool writeable = true, bool populate = false) {
+        return map(0, (size_t) _info.clear().length(), writeable, populate);
     }
 
     /**
@@ -1339,11 +1881,46 @@ private:
 
     File _f;
     size_t _maxLen;
+    size_t _blockSize = 0;      // non-zero in direct mode
+    uint8_t *_bounce = nullptr;
+    size_t _bounceSize = 0;
+    size_t _end = 0;            // length of the data in the file in direct mode
+
+    void _startDirect();
+
+    void _writeDirect(size_t position, const void *data, size_t len);
 
 protected:
 
     void _writeAt(size_t position, const void *data, size_t len) override {
-        _f.write(position, data, len);
+        if (_blockSize != 0) {
+            _writeDirect(position, data, len);
+        }
+        else {
+            _f.write(position, data, len);
+        }
+    }
+
+    void _writevAt(size_t position, const iovec *iov, int count) override {
+        if (_blockSize != 0) {
+            for (int i = 0; i < count; ++i) {
+                _writeDirect(position, iov[i].iov_base, iov[i].iov_len);
+                position += iov[i].iov_len;
+            }
+        }
+        else {
+            _f.write(position, iov, count);
+        }
+    }
+
+    void _writeAtShared(size_t position, const void *data, size_t len) override {
+        // direct writes share the bounce buffer
+        if (_blockSize != 0) {
+            OutputRandomAccessSerializer::_writeAtShared(position, data, len);
+        }
+        else {
+            _f.write(position, data, len);
+        }
     }
 
     size_t _getLength() const override {
@@ -1399,6 +1976,59 @@ public:
         _f(std::move(f)),
         _maxLen(maxLength)
     { }
+
+    /**
+     * @brief Construct a new OutputFileSerializer object.
+     * 
+     * @param f A file object to use for serialization.
+     * @param maxLength The maximum allowed file length (default = SIZE_MAX).
+     * @param bufferSize Size of the internal serializer buffer.
+     * @param direct If true, the file is written with direct I/O, bypassing
+     * the page cache. The internal buffer is then aligned to the block size of
+     * the file and its size is rounded up to a multiple of it, so that full
+     * buffers are written without copying. Writes at unaligned offsets, such as
+     * a partially filled buffer on flush(), go through a separate block-aligned
+     * buffer, and the file is truncated back to the length of the serialized
+     * data.
+     */
+    OutputFileSerializer(const File &f, size_t maxLength, size_t bufferSize, bool direct)
+    :   OutputRandomAccessSerializer(bufferSize),
+        _f(f),
+        _maxLen(maxLength)
+    {
+        if (direct) _startDirect();
+    }
+
+    /**
+     * @brief Construct a new OutputFileSerializer object.
+     * 
+     * @param f A file object to use for serialization.
+     * @param maxLength The maximum allowed file length (default = SIZE_MAX).
+     * @param bufferSize Size of the internal serializer buffer.
+     * @param direct If true, the file is written with direct I/O, bypassing
+     * the page cache. The internal buffer is then aligned to the block size of
+     * the file and its size is rounded up to a multiple of it, so that full
+     * buffers are written without copying. Writes at unaligned offsets, such as
+     * a partially filled buffer on flush(), go through a separate block-aligned
+     * buffer, and the file is truncated back to the length of the serialized
+     * data.
+     */
+    OutputFileSerializer(File &&f, size_t maxLength, size_t bufferSize, bool direct)
+    :   OutputRandomAccessSerializer(bufferSize),
+        _f(std::move(f)),
+        _maxLen(maxLength)
+    {
+        if (direct) _startDirect();
+    }
+
+    ~OutputFileSerializer();
+
+    /**
+     * @return True if the file is accessed with direct I/O, false otherwise.
+     */
+    bool direct() const {
+        return _blockSize != 0;
+    }
 };
 
 /**
@@ -1410,12 +2040,30 @@ class InputFileSerializer
 {
 private:
 
+    struct Readahead;
+
     File _f;
+    Readahead *_readahead = nullptr;
+    size_t _blockSize = 0;      // non-zero in direct mode
+    uint8_t *_bounce = nullptr;
+    size_t _bounceSize = 0;
+
+    void _startReadahead();
+
+    void _startDirect();
+
+    size_t _readFile(size_t position, void *data, size_t len);
 
 protected:
 
-    void _readAt(size_t position, void *data, size_t len) override {
-        if (_f.read(position, data, len) != len) {
+    void _readAt(size_t position, void *data, size_t len) override;
+
+    void _readAtShared(size_t position, void *data, size_t len) override {
+        // direct reads share the bounce buffer; buffered ones bypass readahead
+        if (_blockSize != 0) {
+            InputRandomAccessSerializer::_readAtShared(position, data, len);
+        }
+        else if (_f.read(position, data, len) != len) {
             throw RuntimeError("Failed to read the required bytes from file");
         }
     }
@@ -1465,6 +2113,281 @@ public:
     :   InputRandomAccessSerializer(bufferSize),
         _f(std::move(f))
     { }
+
+    /**
+     * @brief Construct a new InputFileSerializer object.
+     * 
+     * @param f A file object to use for serialization.
+     * @param bufferSize Size of the internal serializer buffer.
+     * @param readahead If true, the file is read sequentially ahead of the
+     * serializer on a background thread: while the internal buffer is being
+     * consumed, the next bufferSize bytes are read into a second buffer, so
+     * that deserialization overlaps disk I/O. The kernel is also advised of
+     * the sequential access pattern.
+     * @param direct If true, the file is read with direct I/O, bypassing the
+     * page cache (default = false). The internal buffers are then aligned to
+     * the block size of the file and their size is rounded up to a multiple of
+     * it. Reads at unaligned offsets or into unaligned memory go through a
+     * separate block-aligned buffer.
+     */
+    InputFileSerializer(const File &f, size_t bufferSize, bool readahead, bool direct = false)
+    :   InputRandomAccessSerializer(bufferSize),
+        _f(f)
+    {
+        if (direct) _startDirect();
+        if (readahead) _startReadahead();
+    }
+
+    /**
+     * @brief Construct a new InputFileSerializer object.
+     * 
+     * @param f A file object to use for serialization.
+     * @param bufferSize Size of the internal serializer buffer.
+     * @param readahead If true, the file is read sequentially ahead of the
+     * serializer on a background thread: while the internal buffer is being
+     * consumed, the next bufferSize bytes are read into a second buffer, so
+     * that deserialization overlaps disk I/O. The kernel is also advised of
+     * the sequential access pattern.
+     * @param direct If true, the file is read with direct I/O, bypassing the
+     * page cache (default = false). The internal buffers are then aligned to
+     * the block size of the file and their size is rounded up to a multiple of
+     * it. Reads at unaligned offsets or into unaligned memory go through a
+     * separate block-aligned buffer.
+     */
+    InputFileSerializer(File &&f, size_t bufferSize, bool readahead, bool direct = false)
+    :   InputRandomAccessSerializer(bufferSize),
+        _f(std::move(f))
+    {
+        if (direct) _startDirect();
+        if (readahead) _startReadahead();
+    }
+
+    ~InputFileSerializer();
+
+    /**
+     * @return True if the file is accessed with direct I/O, false otherwise.
+     */
+    bool direct() const {
+        return _blockSize != 0;
+    }
+};
+
+/**
+ * @brief An output random-access serializer writing directly into a memory
+ * mapping. The length of the serialization region is the size of the mapping.
+ */
+class OutputMappedSerializer
+:   public OutputRandomAccessSerializer
+{
+private:
+
+    MemoryMapping _m;
+
+protected:
+
+    void _writeAt(size_t position, const void *data, size_t len) override {
+        memcpy((uint8_t *) _m.ptr() + position, data, len);
+    }
+
+    void _writeAtShared(size_t position, const void *data, size_t len) override {
+        _writeAt(position, data, len);
+    }
+
+    size_t _getLength() const override {
+        return _m.size();
+    }
+
+public:
+
+    /**
+     * @brief Construct a new OutputMappedSerializer object.
+     * 
+     * @param m A writeable memory mapping to serialize into.
+     */
+    OutputMappedSerializer(MemoryMapping &&m)
+    :   _m(std::move(m))
+    { }
+
+    /**
+     * @brief Construct a new OutputMappedSerializer object.
+     * 
+     * @param m A writeable memory mapping to serialize into.
+     * @param bufferSize Size of the internal serializer buffer.
+     */
+    OutputMappedSerializer(MemoryMapping &&m, size_t bufferSize)
+    :   OutputRandomAccessSerializer(bufferSize),
+        _m(std::move(m))
+    { }
+
+    /**
+     * @brief Construct a new OutputMappedSerializer object. The file is
+     * extended to the given length and mapped in its entirety.
+     * 
+     * @param f A file object to use for serialization.
+     * @param length The length of the serialization region.
+     */
+    OutputMappedSerializer(File &f, size_t length)
+    :   _m(f.allocate(0, length).map(0, length, true))
+    { }
+
+    /**
+     * @return The underlying memory mapping.
+     */
+    MemoryMapping & mapping() {
+        return _m;
+    }
+
+    /**
+     * @brief Reserves space for count objects of type T at the current
+     * position and returns a pointer to it, allowing the objects to be
+     * constructed in place. The position is moved past the reserved space.
+     * 
+     * @param count The number of objects.
+     * @return A pointer to the reserved space within the mapping.
+     * @throws OutOfRangeError if the space extends beyond the mapping.
+     * @throws Error if the current position is not suitably aligned for T.
+     */
+    template <
+        typename T,
+        typename std::enable_if<
+            SupportsTrivialSerialization<T>::value && ! SupportsCustomSerialization<T>::value,
+            int
+        >::type = 0
+    >
+    T * reserve(size_t count = 1) {
+        flush();
+
+        size_t p = tell();
+        size_t len = count * sizeof(T);
+        uint8_t *ptr = (uint8_t *) _m.ptr() + p;
+
+        if (len > length() - p) {
+            throw OutOfRangeError(
+                "Attempt to write beyond the available serialization region"
+            );
+        }
+        if ((uintptr_t) ptr % alignof(T) != 0) {
+            throw Error("Misaligned access into a memory mapping");
+        }
+
+        seekTo(p + len);
+        _totalByteCount += len;
+        return (T *) ptr;
+    }
+};
+
+/**
+ * @brief An input random-access serializer reading directly from a memory
+ * mapping. In addition to the regular copying operations, trivially
+ * serializable objects and arrays may be accessed in place through view(),
+ * so that loading data costs page faults rather than a copy.
+ */
+class InputMappedSerializer
+:   public InputRandomAccessSerializer
+{
+private:
+
+    MemoryMapping _m;
+
+protected:
+
+    void _readAt(size_t position, void *data, size_t len) override {
+        memcpy(data, (const uint8_t *) _m.ptr() + position, len);
+    }
+
+    void _readAtShared(size_t position, void *data, size_t len) override {
+        _readAt(position, data, len);
+    }
+
+    size_t _getLength() const override {
+        return _m.size();
+    }
+
+public:
+
+    /**
+     * @brief Construct a new InputMappedSerializer object.
+     * 
+     * @param m A memory mapping to deserialize from.
+     */
+    InputMappedSerializer(MemoryMapping &&m)
+    :   _m(std::move(m))
+    { }
+
+    /**
+     * @brief Construct a new InputMappedSerializer object.
+     * 
+     * @param m A memory mapping to deserialize from.
+     * @param bufferSize Size of the internal serializer buffer.
+     */
+    InputMappedSerializer(MemoryMapping &&m, size_t bufferSize)
+    :   InputRandomAccessSerializer(bufferSize),
+        _m(std::move(m))
+    { }
+
+    /**
+     * @brief Construct a new InputMappedSerializer object. The entire file is
+     * mapped write-protected.
+     * 
+     * @param f A file object to use for serialization.
+     */
+    InputMappedSerializer(File &f)
+    :   _m(f.map(false))
+    { }
+
+    /**
+     * @return The underlying memory mapping.
+     */
+    const MemoryMapping & mapping() const {
+        return _m;
+    }
+
+    /**
+     * @brief Returns a pointer to the next len bytes within the mapping and
+     * moves the position past them.
+     * 
+     * @param len The number of bytes.
+     * @return A const pointer into the mapping, valid for the lifetime of this
+     * serializer.
+     * @throws OutOfRangeError if the bytes extend beyond the mapping.
+     */
+    const void * viewBytes(size_t len) {
+        size_t p = tell();
+
+        if (len > length() - p) {
+            throw OutOfRangeError(
+                "Attempt to read beyond the available serialization region"
+            );
+        }
+
+        seekTo(p + len);
+        _totalByteCount += len;
+        return (const uint8_t *) _m.ptr() + p;
+    }
+
+    /**
+     * @brief Returns a pointer to the next count objects of type T within the
+     * mapping, without copying them, and moves the position past them.
+     * 
+     * @param count The number of objects.
+     * @return A const pointer into the mapping, valid for the lifetime of this
+     * serializer.
+     * @throws OutOfRangeError if the objects extend beyond the mapping.
+     * @throws Error if the current position is not suitably aligned for T.
+     */
+    template <
+        typename T,
+        typename std::enable_if<
+            SupportsTrivialSerialization<T>::value && ! SupportsCustomSerialization<T>::value,
+            int
+        >::type = 0
+    >
+    const T * view(size_t count = 1) {
+        if (((uintptr_t) _m.ptr() + tell()) % alignof(T) != 0) {
+            throw Error("Misaligned access into a memory mapping");
+        }
+        return (const T *) viewBytes(count * sizeof(T));
+    }
 };
 
 }
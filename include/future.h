@@ -0,0 +1,569 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <exception.h>
+#include <core/futex.h>
+
+namespace spl {
+
+/**
+ * @brief A type-erased handle that resumes a task suspended in a ThreadPool.
+ * Handles are obtained through ExecutionContext::resumeHandle(), and may be
+ * invoked before the task has actually suspended, in which case its next
+ * suspension ends right away.
+ */
+class ResumeHandle {
+
+private:
+
+    void *_pool = nullptr;
+    void *_task = nullptr;
+    void (*_resume)(void *, void *) = nullptr;
+
+public:
+
+    ResumeHandle() = default;
+
+    ResumeHandle(void *pool, void *task, void (*resume)(void *, void *))
+    :   _pool(pool),
+        _task(task),
+        _resume(resume)
+    { }
+
+    /**
+     * @brief Resumes the task.
+     */
+    void operator()() const {
+        _resume(_pool, _task);
+    }
+};
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+namespace core {
+
+/**
+ * @brief The state shared by a promise and its futures, minus the value. The
+ * state word doubles as a futex, so that threads blocked on the result sleep,
+ * while tasks waiting on it register a ResumeHandle and suspend.
+ */
+class FutureStateBase {
+
+private:
+
+    static constexpr uint32_t __PENDING = 0;
+    static constexpr uint32_t __SLEEPING = 1;   // pending, with blocked threads
+    static constexpr uint32_t __READY = 2;
+
+    std::atomic<uint32_t> _state;
+    std::atomic<size_t> _refs;
+    std::mutex _mtx;
+    std::vector<ResumeHandle> _waiters;
+    std::vector<std::function<void()>> _continuations;
+    std::exception_ptr _error;
+
+protected:
+
+    FutureStateBase()
+    :   _state(__PENDING),
+        _refs(1)
+    { }
+
+    /**
+     * @brief Stores the result using the given function and marks the state
+     * ready, then wakes blocked threads, resumes waiting tasks, and runs the
+     * continuations.
+     *
+     * @throws RuntimeError if the result has already been set.
+     */
+    template <typename Store>
+    void _complete(Store store) {
+        std::vector<ResumeHandle> waiters;
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            if (_state.load(std::memory_order_relaxed) == __READY) {
+                throw RuntimeError("Promise already satisfied");
+            }
+            store();
+            if (_state.exchange(__READY) == __SLEEPING) Futex::wake(_state);
+            waiters.swap(_waiters);
+            continuations.swap(_continuations);
+        }
+        for (auto &w : waiters) w();
+        for (auto &c : continuations) c();
+    }
+
+public:
+
+    FutureStateBase(const FutureStateBase &) = delete;
+
+    virtual ~FutureStateBase() = default;
+
+    FutureStateBase & operator=(const FutureStateBase &) = delete;
+
+    void retain() {
+        _refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+        if (_refs.fetch_sub(1) == 1) delete this;
+    }
+
+    bool ready() const {
+        return _state.load() == __READY;
+    }
+
+    /**
+     * @brief Blocks the calling thread until the state is ready.
+     */
+    void wait() {
+        for (int i = 0; i < Futex::SPIN; ++i) {
+            if (ready()) return;
+            Futex::pause();
+        }
+
+        uint32_t s;
+        while ((s = _state.load()) != __READY) {
+            if (s == __PENDING && ! _state.compare_exchange_weak(s, __SLEEPING)) continue;
+            Futex::wait(_state, __SLEEPING);
+        }
+    }
+
+    /**
+     * @brief Suspends the task running in ctx until the state is ready.
+     */
+    template <typename Context>
+    void wait(Context &ctx) {
+        if (ready()) return;
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            if (ready()) return;
+            _waiters.push_back(ctx.resumeHandle());
+        }
+        ctx.suspend();
+    }
+
+    /**
+     * @brief Registers a function to call once the state is ready. If it
+     * already is, the function is called right away.
+     */
+    void addContinuation(std::function<void()> &&f) {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            if (! ready()) {
+                _continuations.push_back(std::move(f));
+                return;
+            }
+        }
+        f();
+    }
+
+    void setException(std::exception_ptr e) {
+        _complete([this, &e] () { _error = e; });
+    }
+
+    void rethrow() const {
+        if (_error) std::rethrow_exception(_error);
+    }
+};
+
+template <typename T>
+class FutureState
+:   public FutureStateBase
+{
+
+private:
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+    bool _hasValue = false;
+
+public:
+
+    using reference = const T &;
+
+    ~FutureState() {
+        if (_hasValue) reinterpret_cast<T *>(&_storage)->~T();
+    }
+
+    template <typename U>
+    void setValue(U &&value) {
+        _complete([this, &value] () {
+            new (&_storage) T(std::forward<U>(value));
+            _hasValue = true;
+        });
+    }
+
+    reference value() const {
+        rethrow();
+        return *reinterpret_cast<const T *>(&_storage);
+    }
+};
+
+template <>
+class FutureState<void>
+:   public FutureStateBase
+{
+
+public:
+
+    using reference = void;
+
+    void setValue() {
+        _complete([] () { });
+    }
+
+    void value() const {
+        rethrow();
+    }
+};
+
+template <typename R>
+struct FulfillPromise;
+
+}   // namespace core
+
+/**
+ * @brief A handle to a result that becomes available later, typically the
+ * return value of a task submitted to a ThreadPool. Futures are cheap to copy,
+ * and all copies share the same result.
+ *
+ * A result can be waited for from any thread with wait() and get(), which
+ * block the calling thread, or from within a ThreadPool task with wait(ctx)
+ * and get(ctx), which suspend the task and free its worker until the result
+ * is set.
+ *
+ * @tparam T The type of the result, possibly void.
+ */
+template <typename T>
+class Future {
+
+    friend class Promise<T>;
+
+    template <typename U>
+    friend class Future;
+
+    template <typename... U>
+    friend Future<void> whenAll(const Future<U> &...futures);
+
+    template <typename U>
+    friend Future<void> whenAll(const std::vector<Future<U>> &futures);
+
+private:
+
+    core::FutureState<T> *_state = nullptr;
+
+    explicit Future(core::FutureState<T> *state)
+    :   _state(state)
+    {
+        _state->retain();
+    }
+
+public:
+
+    using reference = typename core::FutureState<T>::reference;
+
+    /**
+     * @brief Construct an invalid Future object, not associated with any
+     * result.
+     */
+    Future() = default;
+
+    Future(const Future &rhs)
+    :   _state(rhs._state)
+    {
+        if (_state != nullptr) _state->retain();
+    }
+
+    Future(Future &&rhs)
+    :   _state(rhs._state)
+    {
+        rhs._state = nullptr;
+    }
+
+    ~Future() {
+        if (_state != nullptr) _state->release();
+    }
+
+    Future & operator=(const Future &rhs) {
+        if (rhs._state != nullptr) rhs._state->retain();
+        if (_state != nullptr) _state->release();
+        _state = rhs._state;
+        return *this;
+    }
+
+    Future & operator=(Future &&rhs) {
+        if (this != &rhs) {
+            if (_state != nullptr) _state->release();
+            _state = rhs._state;
+            rhs._state = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @return A boolean indicating whether this future is associated with a
+     * result.
+     */
+    bool valid() const {
+        return _state != nullptr;
+    }
+
+    /**
+     * @return A boolean indicating whether the result is available.
+     */
+    bool ready() const {
+        return _state->ready();
+    }
+
+    /**
+     * @brief Blocks the calling thread until the result is available.
+     */
+    void wait() const {
+        _state->wait();
+    }
+
+    /**
+     * @brief Suspends the calling task until the result is available. The
+     * task's worker runs other tasks in the meantime.
+     *
+     * @param ctx The context of the calling task.
+     */
+    template <typename Context>
+    void wait(Context &ctx) const {
+        _state->wait(ctx);
+    }
+
+    /**
+     * @brief Blocks the calling thread until the result is available.
+     *
+     * @throws The exception the result was set to, if any.
+     * @return The result.
+     */
+    reference get() const {
+        _state->wait();
+        return _state->value();
+    }
+
+    /**
+     * @brief Suspends the calling task until the result is available.
+     *
+     * @param ctx The context of the calling task.
+     * @throws The exception the result was set to, if any.
+     * @return The result.
+     */
+    template <typename Context>
+    reference get(Context &ctx) const {
+        _state->wait(ctx);
+        return _state->value();
+    }
+
+    /**
+     * @brief Schedules a function to run on a thread pool once the result is
+     * available. The function is called as f(ctx, future), where future is a
+     * ready copy of this future.
+     *
+     * @param pool The pool to run the continuation on.
+     * @param f The continuation.
+     * @return A future for the value returned by f, or for the exception f
+     * throws. If the pool rejects the continuation, the returned future holds
+     * a TaskRejectedError.
+     */
+    template <typename Pool, typename F>
+    Future<typename std::result_of<F(typename Pool::Context &, const Future &)>::type>
+    then(Pool &pool, F f) const {
+        using R = typename std::result_of<F(typename Pool::Context &, const Future &)>::type;
+
+        Promise<R> p;
+        Future<R> res = p.future();
+        Future self = *this;
+
+        _state->addContinuation([&pool, self, f, p] () mutable {
+            try {
+                pool.run(typename Pool::Task(
+                    [self, f, p] (typename Pool::Context &ctx) mutable {
+                        try {
+                            core::FulfillPromise<R>::run(p, f, ctx, self);
+                        }
+                        catch (...) {
+                            p.setException(std::current_exception());
+                        }
+                    }
+                ));
+            }
+            catch (...) {
+                p.setException(std::current_exception());
+            }
+        });
+
+        return res;
+    }
+};
+
+/**
+ * @brief The producing side of a Future. Copies of a promise share the same
+ * result, which can be set only once.
+ *
+ * @tparam T The type of the result, possibly void.
+ */
+template <typename T>
+class Promise {
+
+private:
+
+    core::FutureState<T> *_state;
+
+public:
+
+    Promise()
+    :   _state(new core::FutureState<T>())
+    { }
+
+    Promise(const Promise &rhs)
+    :   _state(rhs._state)
+    {
+        _state->retain();
+    }
+
+    ~Promise() {
+        _state->release();
+    }
+
+    Promise & operator=(const Promise &rhs) {
+        rhs._state->retain();
+        _state->release();
+        _state = rhs._state;
+        return *this;
+    }
+
+    /**
+     * @return A future for the result of this promise.
+     */
+    Future<T> future() const {
+        return Future<T>(_state);
+    }
+
+    /**
+     * @brief Sets the result, waking up everything waiting on it. Takes no
+     * argument for Promise<void>.
+     *
+     * @throws RuntimeError if the result has already been set.
+     */
+    template <typename... U>
+    void set(U &&...value) {
+        _state->setValue(std::forward<U>(value)...);
+    }
+
+    /**
+     * @brief Sets the result to an exception, which is rethrown by the
+     * futures' get().
+     *
+     * @throws RuntimeError if the result has already been set.
+     */
+    void setException(std::exception_ptr e) {
+        _state->setException(e);
+    }
+};
+
+namespace core {
+
+/**
+ * @brief Calls a function and sets its result, if any, as the value of a
+ * promise.
+ */
+template <typename R>
+struct FulfillPromise {
+
+    template <typename F, typename... Args>
+    static void run(Promise<R> &p, F &f, Args &&... args) {
+        p.set(f(std::forward<Args>(args)...));
+    }
+};
+
+template <>
+struct FulfillPromise<void> {
+
+    template <typename F, typename... Args>
+    static void run(Promise<void> &p, F &f, Args &&... args) {
+        f(std::forward<Args>(args)...);
+        p.set();
+    }
+};
+
+/**
+ * @brief Completes a promise once a number of futures are ready.
+ */
+struct WhenAll {
+
+    std::atomic<size_t> remaining;
+    Promise<void> promise;
+
+    WhenAll(size_t n)
+    :   remaining(n + 1)
+    { }
+
+    void add(FutureStateBase *state) {
+        state->addContinuation([this] () { done(); });
+    }
+
+    void done() {
+        if (--remaining == 0) {
+            promise.set();
+            delete this;
+        }
+    }
+};
+
+}   // namespace core
+
+/**
+ * @brief Combines a set of futures into a future that becomes ready once all
+ * of them are. The results themselves, including exceptions, are retrieved
+ * from the individual futures.
+ *
+ * @param futures The futures to wait for.
+ * @return A future that is ready when all of the given futures are.
+ */
+template <typename T>
+Future<void> whenAll(const std::vector<Future<T>> &futures) {
+    core::WhenAll *w = new core::WhenAll(futures.size());
+    Future<void> res = w->promise.future();
+    for (const auto &f : futures) w->add(f._state);
+    w->done();
+    return res;
+}
+
+/**
+ * @brief Combines futures of possibly different types into a future that
+ * becomes ready once all of them are.
+ *
+ * @param futures The futures to wait for.
+ * @return A future that is ready when all of the given futures are.
+ */
+template <typename... T>
+Future<void> whenAll(const Future<T> &...futures) {
+    core::WhenAll *w = new core::WhenAll(sizeof...(T));
+    Future<void> res = w->promise.future();
+    core::FutureStateBase *states[] = { futures._state..., nullptr };
+    for (size_t i = 0; i < sizeof...(T); ++i) w->add(states[i]);
+    w->done();
+    return res;
+}
+
+}   // namespace spl
@@ -9,6 +9,8 @@
 #include <type_traits>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <string>
 #include <functional>
 
 namespace spl {
@@ -35,41 +37,202 @@ namespace spl {
         return hash_combine(hash1, hash...);
     }
 
+    /**
+     * @brief The djb2 string hash (http://www.cse.yorku.ca/~oz/hash.html),
+     * consuming one byte per iteration. Kept for hash codes that must remain
+     * stable; prefer WyHash.
+     */
+    struct Djb2 {
+
+        static size_t hash(const void *data, size_t len) {
+            const char *s = (const char *) data;
+            const char *end = s + len;
+            size_t h = 5381;
+            int c;
+            while (s != end) {
+                c = *s++;
+                h = ((h << 5) + h) + c;
+            }
+            return h;
+        }
+
+        static size_t hash(const char *str) {
+            size_t h = 5381;
+            int c;
+            while (*str != '\0') {
+                c = *str++;
+                h = ((h << 5) + h) + c;
+            }
+            return h;
+        }
+    };
+
+    /**
+     * @brief The wyhash function (Wang Yi, https://github.com/wangyi-fudan/wyhash,
+     * final version 4), consuming up to 48 bytes per iteration with 64x64-bit
+     * multiplications. The low bits of the result are well distributed, as
+     * required by tables that reduce hash codes modulo their size.
+     */
+    struct WyHash {
+
+        __extension__ typedef unsigned __int128 uint128;
+
+        static constexpr uint64_t SECRET0 = 0x2d358dccaa6c78a5ull;
+        static constexpr uint64_t SECRET1 = 0x8bb84b93962eacc9ull;
+        static constexpr uint64_t SECRET2 = 0x4b33a62ed433d4a3ull;
+        static constexpr uint64_t SECRET3 = 0x4d5a2da51de1aa47ull;
+
+        /**
+         * @return The xor of the high and low words of the 128-bit product
+         * of a and b.
+         */
+        static uint64_t mix(uint64_t a, uint64_t b) {
+            uint128 r = (uint128) a * b;
+            return (uint64_t) r ^ (uint64_t) (r >> 64);
+        }
+
+        static size_t hash(const void *data, size_t len, uint64_t seed = 0) {
+            const uint8_t *p = (const uint8_t *) data;
+            uint64_t a, b;
+
+            seed ^= mix(seed ^ SECRET0, SECRET1);
+            if (len <= 16) {
+                if (len >= 4) {
+                    a = (_read4(p) << 32) | _read4(p + ((len >> 3) << 2));
+                    b = (_read4(p + len - 4) << 32) | _read4(p + len - 4 - ((len >> 3) << 2));
+                }
+                else if (len > 0) {
+                    a = ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 8) | p[len - 1];
+                    b = 0;
+                }
+                else {
+                    a = b = 0;
+                }
+            }
+            else {
+                size_t i = len;
+                if (i >= 48) {
+                    uint64_t seed1 = seed, seed2 = seed;
+                    do {
+                        seed = mix(_read8(p) ^ SECRET1, _read8(p + 8) ^ seed);
+                        seed1 = mix(_read8(p + 16) ^ SECRET2, _read8(p + 24) ^ seed1);
+                        seed2 = mix(_read8(p + 32) ^ SECRET3, _read8(p + 40) ^ seed2);
+                        p += 48;
+                        i -= 48;
+                    } while (i >= 48);
+                    seed ^= seed1 ^ seed2;
+                }
+                while (i > 16) {
+                    seed = mix(_read8(p) ^ SECRET1, _read8(p + 8) ^ seed);
+                    p += 16;
+                    i -= 16;
+                }
+                a = _read8(p + i - 16);
+                b = _read8(p + i - 8);
+            }
+
+            uint128 r = (uint128) (a ^ SECRET1) * (b ^ seed);
+            return mix((uint64_t) r ^ SECRET0 ^ len, (uint64_t) (r >> 64) ^ SECRET1);
+        }
+
+        static size_t hash(const char *str) {
+            return hash(str, strlen(str));
+        }
+
+    private:
+
+        static uint64_t _read8(const uint8_t *p) {
+            uint64_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        static uint64_t _read4(const uint8_t *p) {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+    };
+
+    /**
+     * @brief The 64-bit FNV-1a hash (http://www.isthe.com/chongo/tech/comp/fnv/),
+     * consuming one byte per iteration. Null-terminated strings can be hashed
+     * at compile time, making it suitable for hash codes of string literals
+     * that are used as constants, such as Factory codes and switch labels.
+     * Compile-time evaluation recurses once per byte, so literals are bounded
+     * by the compiler's constexpr depth limit (512 by default).
+     */
+    struct Fnv1a {
+
+        static constexpr uint64_t OFFSET = 0xcbf29ce484222325ull;
+        static constexpr uint64_t PRIME = 0x100000001b3ull;
+
+        static size_t hash(const void *data, size_t len) {
+            const uint8_t *s = (const uint8_t *) data;
+            const uint8_t *end = s + len;
+            uint64_t h = OFFSET;
+            while (s != end) {
+                h = (h ^ *s++) * PRIME;
+            }
+            return (size_t) h;
+        }
+
+        static constexpr size_t hash(const char *str) {
+            return (size_t) _hash(str, OFFSET);
+        }
+
+    private:
+
+        static constexpr uint64_t _hash(const char *str, uint64_t h) {
+            return *str == '\0' ? h : _hash(str + 1, (h ^ (uint8_t) *str) * PRIME);
+        }
+    };
+
     /**
      * @brief Calculates the hash code of a stream of bytes.
      * 
+     * @tparam Algorithm The hash function, Djb2, Fnv1a, or WyHash (default).
      * @param[in] data Pointer to data.
      * @param[in] len Length in bytes.
      * @return The calculated hash code.
      */
+    template <typename Algorithm = WyHash>
     inline size_t hash(const void *data, size_t len) {
-        const char *s = (const char *) data;
-        const char *end = s + len;
-        // http://www.cse.yorku.ca/~oz/hash.html
-        size_t h = 5381;
-        int c;
-        while (s != end) {
-            c = *s++;
-            h = ((h << 5) + h) + c;
-        }
-        return h;
+        return Algorithm::hash(data, len);
     }
 
     /**
      * @brief Calculates the hash code of a null-terminated string.
      * 
+     * @tparam Algorithm The hash function, Djb2, Fnv1a, or WyHash (default).
      * @param[in] str Pointer to a null-terminate string.
      * @return The calculated hash code.
      */
+    template <typename Algorithm = WyHash>
     inline size_t hash(const char *str) {
-        // http://www.cse.yorku.ca/~oz/hash.html
-        size_t h = 5381;
-        int c;
-        while (*str != '\0') {
-            c = *str++;
-            h = ((h << 5) + h) + c;
-        }
-        return h;
+        return Algorithm::hash(str);
+    }
+
+    /**
+     * @brief Calculates the Fnv1a hash code of a null-terminated string at
+     * compile time when the string is a constant expression.
+     * 
+     * @param[in] str Pointer to a null-terminate string.
+     * @return The calculated hash code, equal to hash<Fnv1a>(str).
+     */
+    constexpr size_t const_hash(const char *str) {
+        return Fnv1a::hash(str);
+    }
+
+    /**
+     * @brief Scrambles an integral key so that every bit of the result
+     * depends on every bit of the key.
+     * 
+     * @param[in] x An integral key.
+     * @return The mixed hash code.
+     */
+    inline size_t hash_mix(uint64_t x) {
+        return WyHash::mix(x ^ WyHash::SECRET0, WyHash::SECRET1);
     }
 
     /**
@@ -95,7 +258,9 @@ namespace spl {
     /**
      * @brief The default functor for calculating the hash codes of objects. If
      * the object supports the Hashable trait, the `hash() const` function is
-     * used. Otherwise, std::hash is used to evaluate a hash code.
+     * used. Integral, enum, and pointer keys are scrambled with hash_mix(),
+     * and strings are hashed with WyHash. Otherwise, std::hash is used to
+     * evaluate a hash code.
      */
     template <typename T>
     struct Hash {
@@ -109,7 +274,41 @@ namespace spl {
 
         template <
             typename X = T,
-            typename std::enable_if<! std::is_base_of<Hashable, X>::value, int>::type = 0
+            typename std::enable_if<
+                std::is_integral<X>::value || std::is_enum<X>::value,
+                int
+            >::type = 0
+        >
+        size_t operator()(const T &t) const {
+            return hash_mix((uint64_t) t);
+        }
+
+        template <
+            typename X = T,
+            typename std::enable_if<std::is_pointer<X>::value, int>::type = 0
+        >
+        size_t operator()(const T &t) const {
+            return hash_mix((uint64_t) (uintptr_t) t);
+        }
+
+        template <
+            typename X = T,
+            typename std::enable_if<std::is_same<X, std::string>::value, int>::type = 0
+        >
+        size_t operator()(const T &t) const {
+            return hash(t.data(), t.size());
+        }
+
+        template <
+            typename X = T,
+            typename std::enable_if<
+                ! std::is_base_of<Hashable, X>::value
+                    && ! std::is_integral<X>::value
+                    && ! std::is_enum<X>::value
+                    && ! std::is_pointer<X>::value
+                    && ! std::is_same<X, std::string>::value,
+                int
+            >::type = 0
         >
         size_t operator()(const T &t) const {
             return std::hash<T>{}(t);
@@ -7,6 +7,7 @@
 
 #include <core/hash_table.h>
 #include <functional>       // std::equal_to
+#include <vector>
 #include <hash.h>
 #include <container.h>
 #include <exception.h>
@@ -23,12 +24,15 @@ namespace spl {
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
+ * @tparam Allocator The allocator policy used for the hash table storage. The
+ * default allocator uses the global heap.
 */
 template <
     typename Key,
     typename Val,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    template <typename> class Allocator = core::HeapAllocator
 >
 class HashMap
 :   protected core::HashTable<
@@ -37,9 +41,10 @@ class HashMap
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashMapNode<Key, Val>>
     >,
-    public ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual, Allocator>>,
     public Serializable
 {
 
@@ -53,21 +58,30 @@ private:
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashMapNode<Key, Val>>
     >;
 
-    using container_base = ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual, Allocator>>;
+
+    friend container_base;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
     using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
     using base::_size;
     using base::_hash;
     using base::_findIndex;
     using base::_findRange;
     using base::_findNext;
+    using base::_partition;
     using base::_findOrGetFreeIndex;
+    using base::_emplace;
 
 public:
 
@@ -135,7 +149,8 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashMap, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<HashMap, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     HashMap(Sequence &&seq)
     :   base(seq.size())
@@ -184,11 +199,17 @@ public:
     template <typename It, typename EndIt>
     static HashMap<
         typename It::value_type::key_type,
-        typename It::value_type::value_type
+        typename It::value_type::value_type,
+        Hash<typename It::value_type::key_type>,
+        std::equal_to<typename It::value_type::key_type>,
+        Allocator
     > create(const It &begin, const EndIt &end) {
         return HashMap<
             typename It::value_type::key_type,
-            typename It::value_type::value_type
+            typename It::value_type::value_type,
+            Hash<typename It::value_type::key_type>,
+            std::equal_to<typename It::value_type::key_type>,
+            Allocator
         >(begin, end);
     }
 
@@ -207,11 +228,17 @@ public:
     template <typename It, typename EndIt>
     static HashMap<
         typename It::value_type::key_type,
-        typename It::value_type::value_type
+        typename It::value_type::value_type,
+        Hash<typename It::value_type::key_type>,
+        std::equal_to<typename It::value_type::key_type>,
+        Allocator
     > create(const It &begin, const EndIt &end, size_t size) {
         return HashMap<
             typename It::value_type::key_type,
-            typename It::value_type::value_type
+            typename It::value_type::value_type,
+            Hash<typename It::value_type::key_type>,
+            std::equal_to<typename It::value_type::key_type>,
+            Allocator
         >(begin, end, size);
     }
 
@@ -235,6 +262,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -308,6 +361,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashMap & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashMap & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether a mapping for some key exists.
      * 
@@ -333,7 +421,7 @@ public:
     Val get(const K &k) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n.v;
+        if (i != __NPOS) return _at(i).storage.n.v;
         throw ElementNotFoundError();
     }
 
@@ -350,10 +438,132 @@ public:
     Val getOr(const K &k, const Val &defaultValue) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n.v;
+        if (i != __NPOS) return _at(i).storage.n.v;
         return defaultValue;
     }
 
+    /**
+     * @brief Looks up the value corresponding to some key, without throwing
+     * on a miss.
+     * 
+     * @param k The key to search for.
+     * @return A pointer to the value, or nullptr if the key is not found. The
+     * pointer is invalidated by any modification of the map.
+     */
+    template <typename K>
+    Val * find(const K &k) {
+        size_t h = _hash(k);
+        size_t i = _findIndex(h, k);
+        return i != __NPOS ? &_at(i).storage.n.v : nullptr;
+    }
+
+    /**
+     * @brief Looks up the value corresponding to some key, without throwing
+     * on a miss.
+     * 
+     * @param k The key to search for.
+     * @return A const pointer to the value, or nullptr if the key is not
+     * found. The pointer is invalidated by any modification of the map.
+     */
+    template <typename K>
+    const Val * find(const K &k) const {
+        size_t h = _hash(k);
+        size_t i = _findIndex(h, k);
+        return i != __NPOS ? &_at(i).storage.n.v : nullptr;
+    }
+
+    /**
+     * @brief Applies a function to the value corresponding to some key,
+     * without copying it.
+     * 
+     * @param k The key to search for.
+     * @param f A functor called with a const reference to the value.
+     * @return True if the key is found, false otherwise.
+     */
+    template <typename K, typename F>
+    bool visit(const K &k, F f) const {
+        const Val *v = find(k);
+        if (v == nullptr) return false;
+        f(*v);
+        return true;
+    }
+
+    /**
+     * @brief Modifies the value corresponding to some key in place.
+     * 
+     * @param k The key to search for.
+     * @param f A functor called with a reference to the value.
+     * @return True if the key is found, false otherwise.
+     */
+    template <typename K, typename F>
+    bool update(const K &k, F f) {
+        Val *v = find(k);
+        if (v == nullptr) return false;
+        f(*v);
+        return true;
+    }
+
+    /**
+     * @brief Modifies the value corresponding to some key in place, inserting
+     * a value created with the parameterless constructor `Val()` first if the
+     * key is not found.
+     * 
+     * @param k The key to search for.
+     * @param f A functor called with a reference to the value.
+     * @return A reference to this container for chaining.
+     */
+    template <typename K, typename F>
+    HashMap & compute(K &&k, F f) {
+        size_t h = _hash(k);
+        size_t i = _findOrGetFreeIndex(h, k);
+        if (! _at(i).occupied()) {
+            _emplace(i, h, core::EmplaceTag(), std::forward<K>(k));
+            ++_size;
+        }
+        f(_at(i).storage.n.v);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping, constructing the value in place from some
+     * arguments. If the key exists, its value is replaced.
+     * 
+     * @param k Key.
+     * @param args Arguments to the constructor of Val.
+     * @return A reference to this container for chaining.
+     */
+    template <typename K, typename... Args>
+    HashMap & emplace(K &&k, Args&&... args) {
+        size_t h = _hash(k);
+        size_t i = _findOrGetFreeIndex(h, k);
+        if (_at(i).occupied()) {
+            _at(i).storage.n.v = Val(std::forward<Args>(args)...);
+        }
+        else {
+            _emplace(i, h, core::EmplaceTag(), std::forward<K>(k), std::forward<Args>(args)...);
+            ++_size;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping, constructing the value in place from some
+     * arguments, unless the key exists. Nothing is constructed if it does.
+     * 
+     * @param k Key.
+     * @param args Arguments to the constructor of Val.
+     * @return True if the mapping was inserted, false if the key exists.
+     */
+    template <typename K, typename... Args>
+    bool tryEmplace(K &&k, Args&&... args) {
+        size_t h = _hash(k);
+        size_t i = _findOrGetFreeIndex(h, k);
+        if (_at(i).occupied()) return false;
+        _emplace(i, h, core::EmplaceTag(), std::forward<K>(k), std::forward<Args>(args)...);
+        ++_size;
+        return true;
+    }
+
     /**
      * @brief Retrieves the node corresponding to some key. If the key is not
      * found, an ElementNotFoundError will be thrown.
@@ -366,7 +576,7 @@ public:
     storage_node getNode(const K &k) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n;
+        if (i != __NPOS) return _at(i).storage.n;
         throw ElementNotFoundError();
     }
 
@@ -380,11 +590,11 @@ public:
     HashMap & put(const Key &k, const Val &v) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = v;
+        if (_at(i).occupied()) {
+            _at(i).storage.n.v = v;
         }
         else {
-            _table[i].set(h, { k, v });
+            _set(i, h, { k, v });
             ++_size;
         }
         return *this;
@@ -400,11 +610,11 @@ public:
     HashMap & put(const Key &k, Val &&v) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = std::move(v);
+        if (_at(i).occupied()) {
+            _at(i).storage.n.v = std::move(v);
         }
         else {
-            _table[i].set(h, { k, std::move(v) });
+            _set(i, h, { k, std::move(v) });
             ++_size;
         }
         return *this;
@@ -420,11 +630,11 @@ public:
     HashMap & put(Key &&k, const Val &v) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = v;
+        if (_at(i).occupied()) {
+            _at(i).storage.n.v = v;
         }
         else {
-            _table[i].set(h, { std::move(k), v });
+            _set(i, h, { std::move(k), v });
             ++_size;
         }
         return *this;
@@ -440,11 +650,11 @@ public:
     HashMap & put(Key &&k, Val &&v) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = std::move(v);
+        if (_at(i).occupied()) {
+            _at(i).storage.n.v = std::move(v);
         }
         else {
-            _table[i].set(h, { std::move(k), std::move(v) });
+            _set(i, h, { std::move(k), std::move(v) });
             ++_size;
         }
         return *this;
@@ -484,7 +694,10 @@ public:
      * @param seq An iterable container of type MapNode<Key, Val> objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashMap & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -495,6 +708,109 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    throw ElementNotFoundError();
+                }
+                *out = _at(i).storage.n.v;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Val &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    *out = defaultValue;
+                    ++out;
+                    return;
+                }
+                *out = _at(i).storage.n.v;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashMap & putBatch(const Begin &begin, const End &end) {
+        _batch(
+            begin,
+            end,
+            [] (const storage_node &x) -> const Key & { return x.k; },
+            [this] (size_t h, Begin &it) {
+                size_t i = _findOrGetFreeIndex(h, (*it).k);
+                if (_at(i).occupied()) {
+                    _at(i).storage.n.v = (*it).v;
+                }
+                else {
+                    _set(i, h, { (*it).k, (*it).v });
+                    ++_size;
+                }
+            }
+        );
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashMap & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Retrieves a reference to the value corresponding to some key. If
      * the mapping does not exist, a new Val type object will be created using
@@ -506,11 +822,11 @@ public:
     Val & operator[](const Key &k) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, { k, Val() });
+        if (! _at(i).occupied()) {
+            _set(i, h, { k, Val() });
             ++_size;
         }
-        return _table[i].storage.n.v;
+        return _at(i).storage.n.v;
     }
 
     /**
@@ -524,11 +840,11 @@ public:
     Val & operator[](Key &&k) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, { std::move(k), Val() });
+        if (! _at(i).occupied()) {
+            _set(i, h, { std::move(k), Val() });
             ++_size;
         }
-        return _table[i].storage.n.v;
+        return _at(i).storage.n.v;
     }
 
     /**
@@ -544,7 +860,7 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        return _table[i].storage.n.v;
+        return _at(i).storage.n.v;
     }
 
     /**
@@ -560,7 +876,7 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -580,8 +896,8 @@ public:
         bool retval = false;
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS && predicate(_table[i].storage.n)) {
-            _table[i].release();
+        if (i != __NPOS && predicate(_at(i).storage.n)) {
+            _release(i);
             --_size;
             retval = true;
         }
@@ -601,8 +917,8 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        Val retval = std::move(_table[i].storage.n.v);
-        _table[i].release();
+        Val retval = std::move(_at(i).storage.n.v);
+        _release(i);
         --_size;
         return retval;
     }
@@ -621,9 +937,9 @@ public:
     Val remove(const K &k, Pred predicate) {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) throw ElementNotFoundError();
-        Val retval = std::move(_table[i].storage.n.v);
-        _table[i].release();
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) throw ElementNotFoundError();
+        Val retval = std::move(_at(i).storage.n.v);
+        _release(i);
         --_size;
         return retval;
     }
@@ -641,8 +957,8 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        storage_node retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        storage_node retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         return retval;
     }
@@ -661,9 +977,9 @@ public:
     storage_node removeNode(const K &k, Pred predicate) {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) throw ElementNotFoundError();
-        storage_node retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) throw ElementNotFoundError();
+        storage_node retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         return retval;
     }
@@ -680,7 +996,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
@@ -697,7 +1013,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
@@ -714,12 +1030,16 @@ namespace parallel {
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
+ * @tparam Controller The concurrency control policy. The default policy is
+ * core::ConcurrentHashTableController. core::StripedHashTableController
+ * allows concurrent insertions of unrelated keys.
 */
 template <
     typename Key,
     typename Val,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    typename Controller = core::ConcurrentHashTableController
 >
 class HashMap
 :   protected core::HashTable<
@@ -727,10 +1047,10 @@ class HashMap
         core::AtomicHashMapNode<Key, Val>,
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        Controller,
+        ShardedCounter<>
     >,
-    public ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual, Controller>>,
     public Serializable
 {
 
@@ -743,23 +1063,52 @@ private:
         core::AtomicHashMapNode<Key, Val>,
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        Controller,
+        ShardedCounter<>
     >;
 
-    using container_base = ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<HashMap<Key, Val, KeyHash, KeyEqual, Controller>>;
+
+    friend container_base;
+
+    using node = core::AtomicHashMapNode<Key, Val>;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
     using base::_controller;
     using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
     using base::_size;
     using base::_hash;
     using base::_findIndex;
+    using base::_read;
+    using base::_readCopy;
     using base::_findRange;
     using base::_findNext;
+    using base::_partition;
     using base::_findOrGetFreeIndex;
+    using base::_lockedApply;
+    using base::_updateOrInsert;
+    using base::_emplace;
+
+    template <typename K, typename V>
+    void _put(size_t h, K &&k, V &&v) {
+        _controller.enter();
+        _updateOrInsert(
+            h,
+            k,
+            [&v] (storage_node &n) { n.v = std::forward<V>(v); },
+            [this, h, &k, &v] (size_t i) {
+                _set(i, h, { std::forward<K>(k), std::forward<V>(v) });
+                ++_size;
+            }
+        );
+        _controller.exit();
+    }
 
 public:
 
@@ -827,7 +1176,8 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashMap, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<HashMap, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     HashMap(Sequence &&seq)
     :   base(seq.size())
@@ -927,6 +1277,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -1000,6 +1376,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashMap & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashMap & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether a mapping for some key exists.
      * 
@@ -1009,10 +1420,8 @@ public:
     template <typename K>
     bool contains(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        _controller.exit();
-        return i != __NPOS;
+        typename base::LookupSection section(_controller);
+        return _read(h, k, [] (const storage_node &) { });
     }
 
     /**
@@ -1026,15 +1435,13 @@ public:
     template <typename K>
     Val get(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Val retval = _table[i].storage.n.v;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        throw ElementNotFoundError();
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n.v; },
+            [] () -> Val { throw ElementNotFoundError(); }
+        );
     }
 
     /**
@@ -1049,15 +1456,28 @@ public:
     template <typename K>
     Val getOr(const K &k, const Val &defaultValue) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Val retval = _table[i].storage.n.v;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        return defaultValue;
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n.v; },
+            [&defaultValue] () { return defaultValue; }
+        );
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key, without throwing
+     * on a miss.
+     * 
+     * @param[in] k The key to search for.
+     * @param[out] v Receives a copy of the value, if the key is found.
+     * @return True if the key is found, false otherwise.
+     */
+    template <typename K>
+    bool tryGet(const K &k, Val &v) const {
+        size_t h = _hash(k);
+        typename base::LookupSection section(_controller);
+        return _read(h, k, [&v] (const storage_node &n) { v = n.v; });
     }
 
     /**
@@ -1070,111 +1490,208 @@ public:
      */
     template <typename K>
     storage_node getNode(const K &k) const {
+        size_t h = _hash(k);
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n; },
+            [] () -> storage_node { throw ElementNotFoundError(); }
+        );
+    }
+
+    /**
+     * @brief Applies a function to the value corresponding to some key,
+     * without copying it. The function runs with the element locked, so it
+     * observes no concurrent update of the value; it must not access this map.
+     * 
+     * @param k The key to search for.
+     * @param f A functor called with a const reference to the value.
+     * @return True if the key is found, false otherwise.
+     */
+    template <typename K, typename F>
+    bool visit(const K &k, F f) const {
         size_t h = _hash(k);
         _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            storage_node retval = _table[i].storage.n;
+        bool found;
+        try {
+            found = const_cast<HashMap *>(this)->_lockedApply(h, k, [&f] (const storage_node &n) {
+                f(n.v);
+            });
+        }
+        catch (...) {
             _controller.exit();
-            return retval;
+            throw;
         }
         _controller.exit();
-        throw ElementNotFoundError();
+        return found;
     }
 
     /**
-     * @brief Inserts a new mapping.
+     * @brief Modifies the value corresponding to some key in place. Only the
+     * element holding the key is locked while the function runs, so updates of
+     * other keys proceed concurrently; the function must not access this map.
      * 
-     * @param k Key.
-     * @param v Value.
-     * @return A reference to this container for chaining.
+     * @param k The key to search for.
+     * @param f A functor called with a reference to the value.
+     * @return True if the key is found, false otherwise.
      */
-    HashMap & put(const Key &k, const Val &v) {
+    template <typename K, typename F>
+    bool update(const K &k, F f) {
         size_t h = _hash(k);
         _controller.enter();
-        size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = v;
+        bool found;
+        try {
+            found = _lockedApply(h, k, [&f] (storage_node &n) { f(n.v); });
         }
-        else {
-            _table[i].set(h, { k, v });
-            ++_size;
+        catch (...) {
+            _controller.exit();
+            throw;
         }
         _controller.exit();
-        return *this;
+        return found;
     }
 
     /**
-     * @brief Inserts a new mapping.
+     * @brief Modifies the value corresponding to some key in place, inserting
+     * a value created with the parameterless constructor `Val()` first if the
+     * key is not found. See update().
      * 
-     * @param k Key.
-     * @param v Value.
+     * @param k The key to search for.
+     * @param f A functor called with a reference to the value.
      * @return A reference to this container for chaining.
      */
-    HashMap & put(const Key &k, Val &&v) {
+    template <typename K, typename F>
+    HashMap & compute(K &&k, F f) {
         size_t h = _hash(k);
         _controller.enter();
-        size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = std::move(v);
+        try {
+            _updateOrInsert(
+                h,
+                k,
+                [&f] (storage_node &n) { f(n.v); },
+                [this, h, &k, &f] (size_t i) {
+                    Val v = Val();
+                    f(v);
+                    _emplace(i, h, core::EmplaceTag(), std::forward<K>(k), std::move(v));
+                    ++_size;
+                }
+            );
         }
-        else {
-            _table[i].set(h, { k, std::move(v) });
-            ++_size;
+        catch (...) {
+            _controller.exit();
+            throw;
         }
         _controller.exit();
         return *this;
     }
 
     /**
-     * @brief Inserts a new mapping.
+     * @brief Inserts a new mapping, constructing the value in place from some
+     * arguments. If the key exists, its value is replaced with the element
+     * locked.
      * 
      * @param k Key.
-     * @param v Value.
+     * @param args Arguments to the constructor of Val.
      * @return A reference to this container for chaining.
      */
-    HashMap & put(Key &&k, const Val &v) {
+    template <typename K, typename... Args>
+    HashMap & emplace(K &&k, Args&&... args) {
         size_t h = _hash(k);
         _controller.enter();
-        size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = v;
-        }
-        else {
-            _table[i].set(h, { std::move(k), v });
-            ++_size;
-        }
+        _updateOrInsert(
+            h,
+            k,
+            [&args...] (storage_node &n) { n.v = Val(std::forward<Args>(args)...); },
+            [this, h, &k, &args...] (size_t i) {
+                _emplace(i, h, core::EmplaceTag(), std::forward<K>(k), std::forward<Args>(args)...);
+                ++_size;
+            }
+        );
         _controller.exit();
         return *this;
     }
 
     /**
-     * @brief Inserts a new mapping.
+     * @brief Inserts a new mapping, constructing the value in place from some
+     * arguments, unless the key exists. Nothing is constructed if it does.
      * 
      * @param k Key.
-     * @param v Value.
-     * @return A reference to this container for chaining.
+     * @param args Arguments to the constructor of Val.
+     * @return True if the mapping was inserted, false if the key exists.
      */
-    HashMap & put(Key &&k, Val &&v) {
+    template <typename K, typename... Args>
+    bool tryEmplace(K &&k, Args&&... args) {
         size_t h = _hash(k);
+        bool inserted = false;
         _controller.enter();
-        size_t i = _findOrGetFreeIndex(h, k);
-        if (_table[i].occupied()) {
-            _table[i].storage.n.v = std::move(v);
-        }
-        else {
-            _table[i].set(h, { std::move(k), std::move(v) });
-            ++_size;
-        }
+        _updateOrInsert(
+            h,
+            k,
+            [] (storage_node &) { },
+            [this, h, &k, &args..., &inserted] (size_t i) {
+                _emplace(i, h, core::EmplaceTag(), std::forward<K>(k), std::forward<Args>(args)...);
+                ++_size;
+                inserted = true;
+            }
+        );
         _controller.exit();
-        return *this;
+        return inserted;
     }
 
     /**
-     * @brief Inserts a range of elements.
+     * @brief Inserts a new mapping.
      * 
-     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
-     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    HashMap & put(const Key &k, const Val &v) {
+        _put(_hash(k), k, v);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     * 
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    HashMap & put(const Key &k, Val &&v) {
+        _put(_hash(k), k, std::move(v));
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     * 
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    HashMap & put(Key &&k, const Val &v) {
+        _put(_hash(k), std::move(k), v);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     * 
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    HashMap & put(Key &&k, Val &&v) {
+        _put(_hash(k), std::move(k), std::move(v));
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a range of elements.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
      * @return A reference to this container for chaining.
      */
     template <typename Begin, typename End>
@@ -1204,7 +1721,10 @@ public:
      * @param seq An iterable container of type MapNode<Key, Val> objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashMap & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -1215,6 +1735,114 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n.v; },
+                    [] () -> Val { throw ElementNotFoundError(); }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Val &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n.v; },
+                    [&defaultValue] () { return defaultValue; }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashMap & putBatch(const Begin &begin, const End &end) {
+        _controller.enter();
+        _batch(
+            begin,
+            end,
+            [] (const storage_node &x) -> const Key & { return x.k; },
+            [this] (size_t h, Begin &it) {
+                _updateOrInsert(
+                    h,
+                    (*it).k,
+                    [&it] (storage_node &n) { n.v = (*it).v; },
+                    [this, h, &it] (size_t i) {
+                        _set(i, h, { (*it).k, (*it).v });
+                        ++_size;
+                    }
+                );
+            }
+        );
+        _controller.exit();
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashMap & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Retrieves a reference to the value corresponding to some key. If
      * the mapping does not exist, a new Val type object will be created using
@@ -1228,12 +1856,12 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, { k, Val() });
+        if (! _at(i).occupied()) {
+            _set(i, h, { k, Val() });
             ++_size;
         }
         _controller.exit();
-        return _table[i].storage.n.v;
+        return _at(i).storage.n.v;
     }
 
     /**
@@ -1249,12 +1877,12 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, { std::move(k), Val() });
+        if (! _at(i).occupied()) {
+            _set(i, h, { std::move(k), Val() });
             ++_size;
         }
         _controller.exit();
-        return _table[i].storage.n.v;
+        return _at(i).storage.n.v;
     }
 
     /**
@@ -1271,7 +1899,7 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        return _table[i].storage.n.v;
+        return _at(i).storage.n.v;
     }
 
     /**
@@ -1288,7 +1916,7 @@ public:
         _controller.enter();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1313,7 +1941,7 @@ public:
         _controller.lock();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1336,8 +1964,8 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findIndex(h, k);
-        if (i != __NPOS && predicate(_table[i].storage.n)) {
-            _table[i].release();
+        if (i != __NPOS && predicate(_at(i).storage.n)) {
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1362,8 +1990,8 @@ public:
         _controller.enter();
         _controller.lock();
         size_t i = _findIndex(h, k);
-        if (i != __NPOS && predicate(_table[i].storage.n)) {
-            _table[i].release();
+        if (i != __NPOS && predicate(_at(i).storage.n)) {
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1389,8 +2017,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Val retval = std::move(_table[i].storage.n.v);
-        _table[i].release();
+        Val retval = std::move(_at(i).storage.n.v);
+        _release(i);
         --_size;
         _controller.exit();
         return retval;
@@ -1417,8 +2045,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Val retval = std::move(_table[i].storage.n.v);
-        _table[i].release();
+        Val retval = std::move(_at(i).storage.n.v);
+        _release(i);
         --_size;
         _controller.unlock();
         _controller.exit();
@@ -1440,12 +2068,12 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) {
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) {
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Val retval = std::move(_table[i].storage.n.v);
-        _table[i].release();
+        Val retval = std::move(_at(i).storage.n.v);
+        _release(i);
         --_size;
         _controller.exit();
         return retval;
@@ -1469,13 +2097,13 @@ public:
         _controller.enter();
         _controller.lock();
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) {
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) {
             _controller.unlock();
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Val retval = std::move(_table[i].storage.n.v);
-        _table[i].release();
+        Val retval = std::move(_at(i).storage.n.v);
+        _release(i);
         --_size;
         _controller.unlock();
         _controller.exit();
@@ -1499,8 +2127,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        storage_node retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        storage_node retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.exit();
         return retval;
@@ -1527,8 +2155,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        storage_node retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        storage_node retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.unlock();
         _controller.exit();
@@ -1550,12 +2178,12 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) {
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) {
             _controller.exit();
             throw ElementNotFoundError();
         }
-        storage_node retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        storage_node retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.exit();
         return retval;
@@ -1579,13 +2207,13 @@ public:
         _controller.enter();
         _controller.lock();
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) {
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) {
             _controller.unlock();
             _controller.exit();
             throw ElementNotFoundError();
         }
-        storage_node retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        storage_node retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.unlock();
         _controller.exit();
@@ -1605,7 +2233,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -1624,7 +2252,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -1646,7 +2274,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
@@ -1669,12 +2297,33 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
         return *this;
     }
+
+    /**
+     * @brief Applies a function to a copy of every element, without blocking
+     * concurrent writers for the length of the scan. Unlike iterators and
+     * foreach(), which must not run concurrently with resizes, and the _l
+     * variants, which lock out every writer, the scan is weakly consistent:
+     * every element present for the whole scan is visited exactly once,
+     * elements inserted or erased during the scan may or may not be visited,
+     * and an element updated in place is visited with either its old or its new
+     * value. Writers are held up at most for one migration step when the scan
+     * finishes a resize in progress.
+     * 
+     * @param f The function to apply, called with a const reference to a copy
+     * of each element. It runs outside of any lock and may access this container.
+     * @return A reference to this container for chaining.
+     */
+    template <typename F>
+    const HashMap & scan(F f) const {
+        base::_scan(f);
+        return *this;
+    }
 };
 
 }   // namespace parallel
@@ -1688,12 +2337,15 @@ public:
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
+ * @tparam Allocator The allocator policy used for the hash table storage. The
+ * default allocator uses the global heap.
 */
 template <
     typename Key,
     typename Val,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    template <typename> class Allocator = core::HeapAllocator
 >
 class HashMultiMap
 :   protected core::HashTable<
@@ -1702,9 +2354,10 @@ class HashMultiMap
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashMapNode<Key, Val>>
     >,
-    public ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual, Allocator>>,
     public Serializable
 {
 
@@ -1718,20 +2371,28 @@ private:
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashMapNode<Key, Val>>
     >;
 
-    using container_base = ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual, Allocator>>;
+
+    friend container_base;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
     using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
     using base::_size;
     using base::_hash;
     using base::_findIndex;
     using base::_findRange;
     using base::_findNext;
+    using base::_partition;
     using base::_getFreeIndex;
 
 public:
@@ -1800,7 +2461,8 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashMultiMap, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<HashMultiMap, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     HashMultiMap(Sequence &&seq)
     :   base(seq.size())
@@ -1849,11 +2511,17 @@ public:
     template <typename It, typename EndIt>
     static HashMultiMap<
         typename It::value_type::key_type,
-        typename It::value_type::value_type
+        typename It::value_type::value_type,
+        Hash<typename It::value_type::key_type>,
+        std::equal_to<typename It::value_type::key_type>,
+        Allocator
     > create(const It &begin, const EndIt &end) {
         return HashMultiMap<
             typename It::value_type::key_type,
-            typename It::value_type::value_type
+            typename It::value_type::value_type,
+            Hash<typename It::value_type::key_type>,
+            std::equal_to<typename It::value_type::key_type>,
+            Allocator
         >(begin, end);
     }
 
@@ -1872,11 +2540,17 @@ public:
     template <typename It, typename EndIt>
     static HashMultiMap<
         typename It::value_type::key_type,
-        typename It::value_type::value_type
+        typename It::value_type::value_type,
+        Hash<typename It::value_type::key_type>,
+        std::equal_to<typename It::value_type::key_type>,
+        Allocator
     > create(const It &begin, const EndIt &end, size_t size) {
         return HashMultiMap<
             typename It::value_type::key_type,
-            typename It::value_type::value_type
+            typename It::value_type::value_type,
+            Hash<typename It::value_type::key_type>,
+            std::equal_to<typename It::value_type::key_type>,
+            Allocator
         >(begin, end, size);
     }
 
@@ -1900,6 +2574,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -1973,6 +2673,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashMultiMap & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashMultiMap & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether a mapping for some key exists.
      * 
@@ -1998,7 +2733,7 @@ public:
     Val get(const K &k) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n.v;
+        if (i != __NPOS) return _at(i).storage.n.v;
         throw ElementNotFoundError();
     }
 
@@ -2015,10 +2750,42 @@ public:
     Val getOr(const K &k, const Val &defaultValue) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n.v;
+        if (i != __NPOS) return _at(i).storage.n.v;
         return defaultValue;
     }
 
+    /**
+     * @brief Looks up the value corresponding to some key, without throwing
+     * on a miss. If the key has multiple mappings, any one of them is
+     * returned.
+     * 
+     * @param k The key to search for.
+     * @return A pointer to the value, or nullptr if the key is not found. The
+     * pointer is invalidated by any modification of the map.
+     */
+    template <typename K>
+    Val * find(const K &k) {
+        size_t h = _hash(k);
+        size_t i = _findIndex(h, k);
+        return i != __NPOS ? &_at(i).storage.n.v : nullptr;
+    }
+
+    /**
+     * @brief Looks up the value corresponding to some key, without throwing
+     * on a miss. If the key has multiple mappings, any one of them is
+     * returned.
+     * 
+     * @param k The key to search for.
+     * @return A const pointer to the value, or nullptr if the key is not
+     * found. The pointer is invalidated by any modification of the map.
+     */
+    template <typename K>
+    const Val * find(const K &k) const {
+        size_t h = _hash(k);
+        size_t i = _findIndex(h, k);
+        return i != __NPOS ? &_at(i).storage.n.v : nullptr;
+    }
+
     /**
      * @brief Retrieves a node corresponding to some key. If the key is not
      * found, an ElementNotFoundError will be thrown.
@@ -2031,7 +2798,7 @@ public:
     storage_node getNode(const K &k) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n;
+        if (i != __NPOS) return _at(i).storage.n;
         throw ElementNotFoundError();
     }
 
@@ -2045,7 +2812,7 @@ public:
     HashMultiMap & put(const Key &k, const Val &v) {
         size_t h = _hash(k);
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { k, v });
+        _set(i, h, { k, v });
         ++_size;
         return *this;
     }
@@ -2060,7 +2827,7 @@ public:
     HashMultiMap & put(const Key &k, Val &&v) {
         size_t h = _hash(k);
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { k, std::move(v) });
+        _set(i, h, { k, std::move(v) });
         ++_size;
         return *this;
     }
@@ -2075,7 +2842,7 @@ public:
     HashMultiMap & put(Key &&k, const Val &v) {
         size_t h = _hash(k);
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { std::move(k), v });
+        _set(i, h, { std::move(k), v });
         ++_size;
         return *this;
     }
@@ -2090,7 +2857,7 @@ public:
     HashMultiMap & put(Key &&k, Val &&v) {
         size_t h = _hash(k);
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { std::move(k), std::move(v) });
+        _set(i, h, { std::move(k), std::move(v) });
         ++_size;
         return *this;
     }
@@ -2129,7 +2896,10 @@ public:
      * @param seq An iterable container of type MapNode<Key, Val> objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashMultiMap & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -2140,6 +2910,104 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    throw ElementNotFoundError();
+                }
+                *out = _at(i).storage.n.v;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Val &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    *out = defaultValue;
+                    ++out;
+                    return;
+                }
+                *out = _at(i).storage.n.v;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashMultiMap & putBatch(const Begin &begin, const End &end) {
+        _batch(
+            begin,
+            end,
+            [] (const storage_node &x) -> const Key & { return x.k; },
+            [this] (size_t h, Begin &it) {
+                size_t i = _getFreeIndex(h);
+                _set(i, h, { (*it).k, (*it).v });
+                ++_size;
+            }
+        );
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashMultiMap & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Erases a key from this map. If the key does not exist, the
      * function does nothing. If more than one key matches the given key, only
@@ -2154,7 +3022,7 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -2177,8 +3045,8 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 retval = true;
                 break;
@@ -2200,7 +3068,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            _table[i].release();
+            _release(i);
             --_size;
             ++retval;
         }
@@ -2221,8 +3089,8 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 ++retval;
             }
@@ -2244,8 +3112,8 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        Val retval = std::move(_table[i].storage.n.v);
-        _table[i].release();
+        Val retval = std::move(_at(i).storage.n.v);
+        _release(i);
         --_size;
         return retval;
     }
@@ -2266,9 +3134,9 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                Val retval = std::move(_table[i].storage.n.v);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                Val retval = std::move(_at(i).storage.n.v);
+                _release(i);
                 --_size;
                 return retval;
             }
@@ -2290,8 +3158,8 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        storage_node retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        storage_node retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         return retval;
     }
@@ -2312,9 +3180,9 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                storage_node retval = std::move(_table[i].storage.n);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                storage_node retval = std::move(_at(i).storage.n);
+                _release(i);
                 --_size;
                 return retval;
             }
@@ -2334,7 +3202,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
@@ -2351,17 +3219,19 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
 };
 
-namespace parallel {
-
 /**
- * @brief A hash multi-map supporting thread-safe, O(1) lookup, insert, and
- * delete.
+ * @brief A hash multi-map that groups the values of each key together: every
+ * distinct key occupies a single slot holding a contiguous vector of its
+ * values. Compared to HashMultiMap, which stores every mapping in a slot of
+ * its own, visiting the values of a key is a sequential scan, and keys with
+ * many values neither lengthen probe ranges nor force the table to grow.
+ * Iteration visits each key once, together with all of its values.
  * 
  * @tparam Key The key type.
  * @tparam Val The value type.
@@ -2369,23 +3239,27 @@ namespace parallel {
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
+ * @tparam Allocator The allocator policy used for the hash table storage. The
+ * default allocator uses the global heap.
 */
 template <
     typename Key,
     typename Val,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    template <typename> class Allocator = core::HeapAllocator
 >
-class HashMultiMap
+class GroupedHashMultiMap
 :   protected core::HashTable<
         Key,
-        core::AtomicHashMapNode<Key, Val>,
+        core::HashMapNode<Key, std::vector<Val>>,
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        core::HashTableController,
+        size_t,
+        Allocator<core::HashMapNode<Key, std::vector<Val>>>
     >,
-    public ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<GroupedHashMultiMap<Key, Val, KeyHash, KeyEqual, Allocator>>,
     public Serializable
 {
 
@@ -2395,133 +3269,805 @@ private:
 
     using base = typename core::HashTable<
         Key,
-        core::AtomicHashMapNode<Key, Val>,
+        core::HashMapNode<Key, std::vector<Val>>,
         KeyHash,
         core::HashMapNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        core::HashTableController,
+        size_t,
+        Allocator<core::HashMapNode<Key, std::vector<Val>>>
     >;
 
-    using container_base = ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<GroupedHashMultiMap<Key, Val, KeyHash, KeyEqual, Allocator>>;
+
+    friend container_base;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
-    using base::_controller;
-    using base::_table;
-    using base::_size;
+    using base::_at;
+    using base::_release;
     using base::_hash;
     using base::_findIndex;
-    using base::_findRange;
-    using base::_findNext;
+    using base::_findOrGetFreeIndex;
     using base::_getFreeIndex;
+    using base::_emplace;
+
+    std::vector<typename base::template HashTableIterator<const storage_node>> _partition(size_t n) const {
+        return base::_partition(n);
+    }
+
+    size_t _count = 0;
+
+    template <typename K>
+    std::vector<Val> & _group(K &&k) {
+        size_t h = _hash(k);
+        size_t i = _findOrGetFreeIndex(h, k);
+        if (! _at(i).occupied()) {
+            _emplace(i, h, core::EmplaceTag(), std::forward<K>(k));
+            ++base::_size;
+        }
+        return _at(i).storage.n.v;
+    }
+
+    template <typename K>
+    const std::vector<Val> * _findGroup(const K &k) const {
+        size_t i = _findIndex(_hash(k), k);
+        return i != __NPOS ? &_at(i).storage.n.v : nullptr;
+    }
+
+    template <typename K>
+    std::vector<Val> * _findGroup(const K &k) {
+        size_t i = _findIndex(_hash(k), k);
+        return i != __NPOS ? &_at(i).storage.n.v : nullptr;
+    }
+
+    /**
+     * @brief Erases values of a key that satisfy a predicate, stopping after
+     * `limit` values. The slot of the key is released once it has no values.
+     *
+     * @return The number of values erased.
+     */
+    template <typename K, typename Pred>
+    size_t _eraseValues(const K &k, Pred predicate, size_t limit) {
+        size_t i = _findIndex(_hash(k), k);
+        if (i == __NPOS) return 0;
+
+        std::vector<Val> &values = _at(i).storage.n.v;
+        size_t erased = 0;
+        for (size_t j = values.size(); j > 0 && erased < limit; --j) {
+            if (predicate(values[j - 1])) {
+                values.erase(values.begin() + (j - 1));
+                ++erased;
+            }
+        }
+        _count -= erased;
+        if (values.empty()) {
+            _release(i);
+            --base::_size;
+        }
+        return erased;
+    }
 
 public:
 
-    using Iterator = typename base::template HashTableIterator<storage_node>;
+    // values may be modified through foreach() and find(), but the groups
+    // cannot be resized behind the container's back
+    using Iterator = typename base::template HashTableIterator<const storage_node>;
     using ConstIterator = typename base::template HashTableIterator<const storage_node>;
 
     using container_base::foreach;
 
     /**
-     * @brief Construct a new HashMultiMap object
+     * @brief Construct a new GroupedHashMultiMap object.
      */
-    HashMultiMap()
+    GroupedHashMultiMap()
     :   base()
     { }
 
     /**
-     * @brief Construct a new HashMultiMap object.
+     * @brief Construct a new GroupedHashMultiMap object.
      * 
      * @param initialSize The initial size of the internal hash table. This
      * value could be used to efficiently pre-allocate space, if the number of
-     * elements (or an estimate) is known.
+     * distinct keys (or an estimate) is known.
      */
-    HashMultiMap(size_t initialSize)
+    GroupedHashMultiMap(size_t initialSize)
     :   base(initialSize)
     { }
 
-    HashMultiMap(const HashMultiMap &rhs)
-    :   base(rhs)
+    GroupedHashMultiMap(const GroupedHashMultiMap &rhs)
+    :   base(rhs),
+        _count(rhs._count)
     { }
 
-    HashMultiMap(HashMultiMap &&rhs)
-    :   base(std::move(rhs))
-    { }
+    GroupedHashMultiMap(GroupedHashMultiMap &&rhs)
+    :   base(std::move(rhs)),
+        _count(rhs._count)
+    {
+        rhs._count = 0;
+    }
 
     /**
-     * @brief Construct a new HashMultiMap object.
+     * @brief Construct a new GroupedHashMultiMap object.
      * 
      * @param list An initializer list of objects of type MapNode<Key, Val>.
      */
-    HashMultiMap(const std::initializer_list<storage_node> &list)
-    :   base(list.size())
+    GroupedHashMultiMap(const std::initializer_list<MapNode<Key, Val>> &list)
+    :   base()
     {
         putAll(list);
     }
 
     /**
-     * @brief Construct a new HashMultiMap object.
+     * @brief Construct a new GroupedHashMultiMap object.
      * 
      * @param seq An iterable container of type MapNode<Key, Val> objects.
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashMultiMap, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<GroupedHashMultiMap, Sequence>::value, int>::type = 0
     >
-    HashMultiMap(const Sequence &seq)
-    :   base(seq.size())
+    GroupedHashMultiMap(const Sequence &seq)
+    :   base()
     {
         putAll(seq);
     }
 
     /**
-     * @brief Construct a new HashMultiMap object.
+     * @brief Construct a new GroupedHashMultiMap object.
      * 
      * @param seq An iterable container of type MapNode<Key, Val> objects.
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashMultiMap, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<GroupedHashMultiMap, typename std::decay<Sequence>::type>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
-    HashMultiMap(Sequence &&seq)
-    :   base(seq.size())
+    GroupedHashMultiMap(Sequence &&seq)
+    :   base()
     {
         putAll(std::move(seq));
     }
 
     /**
-     * @brief Construct a new HashMultiMap object.
+     * @brief Construct a new GroupedHashMultiMap object.
      * 
      * @param begin A beginning iterator over type MapNode<Key, Val> objects.
      * @param end An end iterator over type MapNode<Key, Val> objects.
      */
     template <typename Begin, typename End>
-    HashMultiMap(const Begin &begin, const End &end)
+    GroupedHashMultiMap(const Begin &begin, const End &end)
     :   base()
     {
         putAll(begin, end);
     }
 
-    /**
-     * @brief Construct a new HashMultiMap object.
-     * 
-     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
-     * @param end An end iterator over type MapNode<Key, Val> objects.
-     * @param size The number of elements between begin and end.
-     */
-    template <typename Begin, typename End>
-    HashMultiMap(const Begin &begin, const End &end, size_t size)
-    :   base(size)
-    {
-        putAll(begin, end);
+    ~GroupedHashMultiMap() = default;
+
+    GroupedHashMultiMap & operator=(const GroupedHashMultiMap &rhs) {
+        base::operator=(rhs);
+        _count = rhs._count;
+        return *this;
     }
 
-    /**
-     * @brief Construct a new HashMultiMap object.
-     * 
-     * @tparam It A beginning iterator type that defines the typename
-     * `value_type` which will determine the resulting type. Note that
+    GroupedHashMultiMap & operator=(GroupedHashMultiMap &&rhs) {
+        base::operator=(std::move(rhs));
+        _count = rhs._count;
+        rhs._count = 0;
+        return *this;
+    }
+
+    void writeObject(OutputStreamSerializer &serializer) const override {
+        serializer << base::size() << _count;
+        for (const auto &x : *this) {
+            serializer << x.k << x.v.size();
+            for (const Val &v : x.v) serializer << v;
+        }
+    }
+
+    void readObject(InputStreamSerializer &serializer) override {
+        size_t keys;
+        serializer >> keys >> _count;
+        base::clear();
+        base::reserve(keys);
+        for (size_t i = 0; i < keys; ++i) {
+            Key k;
+            size_t n;
+            serializer >> k >> n;
+            size_t h = _hash(k);
+            size_t j = _getFreeIndex(h);
+            _emplace(j, h, core::EmplaceTag(), std::move(k));
+            std::vector<Val> &values = _at(j).storage.n.v;
+            values.resize(n);
+            for (Val &v : values) serializer >> v;
+        }
+        base::_size = keys;
+    }
+
+    /**
+     * @return The number of values in this container, over all keys.
+     */
+    size_t size() const {
+        return _count;
+    }
+
+    /**
+     * @return The number of distinct keys in this container.
+     */
+    size_t keyCount() const {
+        return base::size();
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return _count == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return _count != 0;
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator cbegin() const {
+        return base::cbegin();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator cend() const {
+        return base::cend();
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator begin() const {
+        return base::cbegin();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator end() const {
+        return base::cend();
+    }
+
+    /**
+     * @brief Erases all elements in this container.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiMap & clear() {
+        base::clear();
+        _count = 0;
+        return *this;
+    }
+
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * distinct keys without further resizing.
+     * 
+     * @param n The number of keys to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiMap & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current keys
+     * need, releasing the memory held after erasing many keys.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiMap & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
+    /**
+     * @brief Tests whether a mapping for some key exists.
+     * 
+     * @param k The key to search for.
+     * @return True if the key exists, false otherwise.
+     */
+    template <typename K>
+    bool contains(const K &k) const {
+        return _findGroup(k) != nullptr;
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return The number of values mapped to the given key.
+     */
+    template <typename K>
+    size_t count(const K &k) const {
+        const std::vector<Val> *values = _findGroup(k);
+        return values != nullptr ? values->size() : 0;
+    }
+
+    /**
+     * @brief Looks up all values mapped to some key, in insertion order.
+     * 
+     * @param k The key to search for.
+     * @return A pointer to the values of the key, or nullptr if the key is not
+     * found. The pointer is invalidated by any insertion or erasure.
+     */
+    template <typename K>
+    const std::vector<Val> * values(const K &k) const {
+        return _findGroup(k);
+    }
+
+    /**
+     * @brief Retrieves the first value mapped to some key. If the key is not
+     * found, an ElementNotFoundError will be thrown.
+     * 
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A copy of the first value of the key.
+     */
+    template <typename K>
+    Val get(const K &k) const {
+        const std::vector<Val> *values = _findGroup(k);
+        if (values == nullptr) throw ElementNotFoundError();
+        return values->front();
+    }
+
+    /**
+     * @brief Retrieves the first value mapped to some key. If the key is not
+     * found, the default value will be returned.
+     * 
+     * @param k The key to search for.
+     * @param defaultValue The default value to return if the key is not found.
+     * @return A copy of the first value of the key, or the default value.
+     */
+    template <typename K>
+    Val getOr(const K &k, const Val &defaultValue) const {
+        const std::vector<Val> *values = _findGroup(k);
+        return values != nullptr ? values->front() : defaultValue;
+    }
+
+    /**
+     * @brief Looks up the first value mapped to some key, without throwing on
+     * a miss.
+     * 
+     * @param k The key to search for.
+     * @return A pointer to the first value of the key, or nullptr if the key
+     * is not found.
+     */
+    template <typename K>
+    Val * find(const K &k) {
+        std::vector<Val> *values = _findGroup(k);
+        return values != nullptr ? &values->front() : nullptr;
+    }
+
+    /**
+     * @brief Looks up the first value mapped to some key, without throwing on
+     * a miss.
+     * 
+     * @param k The key to search for.
+     * @return A pointer to the first value of the key, or nullptr if the key
+     * is not found.
+     */
+    template <typename K>
+    const Val * find(const K &k) const {
+        const std::vector<Val> *values = _findGroup(k);
+        return values != nullptr ? &values->front() : nullptr;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     * 
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiMap & put(const Key &k, const Val &v) {
+        _group(k).push_back(v);
+        ++_count;
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     * 
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiMap & put(const Key &k, Val &&v) {
+        _group(k).push_back(std::move(v));
+        ++_count;
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     * 
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiMap & put(Key &&k, const Val &v) {
+        _group(std::move(k)).push_back(v);
+        ++_count;
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     * 
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiMap & put(Key &&k, Val &&v) {
+        _group(std::move(k)).push_back(std::move(v));
+        ++_count;
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a range of elements.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    GroupedHashMultiMap & putAll(const Begin &begin, const End &end) {
+        auto it = begin;
+        while (it != end) {
+            put((*it).k, (*it).v);
+            ++it;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container.
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    GroupedHashMultiMap & putAll(const Sequence &seq) {
+        return putAll(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container.
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
+    GroupedHashMultiMap & putAll(Sequence &&seq) {
+        auto it = seq.begin();
+        auto end = seq.end();
+        while (it != end) {
+            put(std::move((*it).k), std::move((*it).v));
+            ++it;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Erases the most recently inserted value of a key. If the key does
+     * not exist, the function does nothing.
+     * 
+     * @param k The key to erase.
+     * @return True if a value was erased, false otherwise.
+     */
+    template <typename K>
+    bool erase(const K &k) {
+        return _eraseValues(k, [] (const Val &) { return true; }, 1) != 0;
+    }
+
+    /**
+     * @brief Erases the most recently inserted value of a key that satisfies a
+     * given predicate. If no such value exists, the function does nothing.
+     * 
+     * @param k The key to erase.
+     * @param predicate A predicate functor over values.
+     * @return True if a value was erased, false otherwise.
+     */
+    template <typename K, typename Pred>
+    bool erase(const K &k, Pred predicate) {
+        return _eraseValues(k, predicate, 1) != 0;
+    }
+
+    /**
+     * @brief Erases a key and all of its values. If the key does not exist,
+     * the function does nothing.
+     * 
+     * @param k The key to erase.
+     * @return Number of values erased.
+     */
+    template <typename K>
+    size_t eraseAll(const K &k) {
+        size_t i = _findIndex(_hash(k), k);
+        if (i == __NPOS) return 0;
+        size_t erased = _at(i).storage.n.v.size();
+        _release(i);
+        --base::_size;
+        _count -= erased;
+        return erased;
+    }
+
+    /**
+     * @brief Erases all values of a key that satisfy a given predicate. The key
+     * is erased once it has no values left.
+     * 
+     * @param k The key to erase.
+     * @param predicate A predicate functor over values.
+     * @return Number of values erased.
+     */
+    template <typename K, typename Pred>
+    size_t eraseAll(const K &k, Pred predicate) {
+        return _eraseValues(k, predicate, __NPOS);
+    }
+
+    /**
+     * @brief Erases the most recently inserted value of a key and returns it.
+     * If the key does not exist, an ElementNotFoundError will be thrown.
+     * 
+     * @param k The key to erase.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return The erased value.
+     */
+    template <typename K>
+    Val remove(const K &k) {
+        size_t i = _findIndex(_hash(k), k);
+        if (i == __NPOS) throw ElementNotFoundError();
+        std::vector<Val> &values = _at(i).storage.n.v;
+        Val retval = std::move(values.back());
+        values.pop_back();
+        --_count;
+        if (values.empty()) {
+            _release(i);
+            --base::_size;
+        }
+        return retval;
+    }
+
+    /**
+     * @brief Applies a function, in insertion order, to all values mapped to a
+     * given key.
+     * 
+     * @param k The key to search for.
+     * @param f The function to apply.
+     * @return A reference to this container for chaining.
+     */
+    template <typename K, typename F>
+    const GroupedHashMultiMap & foreach(const K &k, F f) const {
+        const std::vector<Val> *values = _findGroup(k);
+        if (values != nullptr) {
+            for (const Val &v : *values) f(v);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Applies a function, in insertion order, to all values mapped to a
+     * given key. The function may modify the values.
+     * 
+     * @param k The key to search for.
+     * @param f The function to apply.
+     * @return A reference to this container for chaining.
+     */
+    template <typename K, typename F>
+    GroupedHashMultiMap & foreach(const K &k, F f) {
+        std::vector<Val> *values = _findGroup(k);
+        if (values != nullptr) {
+            for (Val &v : *values) f(v);
+        }
+        return *this;
+    }
+};
+
+namespace parallel {
+
+/**
+ * @brief A hash multi-map supporting thread-safe, O(1) lookup, insert, and
+ * delete.
+ * 
+ * @tparam Key The key type.
+ * @tparam Val The value type.
+ * @tparam KeyHash A functor to calculate the hash code of the key type. The
+ * default functor is Hash<Key>.
+ * @tparam KeyEqual A functor to test for key equality. The default functor is
+ * std::equal_to<Key>.
+ * @tparam Controller The concurrency control policy. The default policy is
+ * core::ConcurrentHashTableController. core::StripedHashTableController
+ * allows concurrent insertions of unrelated keys.
+*/
+template <
+    typename Key,
+    typename Val,
+    typename KeyHash = Hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Controller = core::ConcurrentHashTableController
+>
+class HashMultiMap
+:   protected core::HashTable<
+        Key,
+        core::AtomicHashMapNode<Key, Val>,
+        KeyHash,
+        core::HashMapNodeKeyEqual<KeyEqual>,
+        Controller,
+        ShardedCounter<>
+    >,
+    public ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual, Controller>>,
+    public Serializable
+{
+
+    template <typename HashMapType> friend struct HashMapTester;
+
+private:
+
+    using base = typename core::HashTable<
+        Key,
+        core::AtomicHashMapNode<Key, Val>,
+        KeyHash,
+        core::HashMapNodeKeyEqual<KeyEqual>,
+        Controller,
+        ShardedCounter<>
+    >;
+
+    using container_base = ForwardIterableContainer<HashMultiMap<Key, Val, KeyHash, KeyEqual, Controller>>;
+
+    friend container_base;
+
+    using storage_node = typename base::storage_node;
+
+    using base::__NPOS;
+    using base::_controller;
+    using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
+    using base::_size;
+    using base::_hash;
+    using base::_findIndex;
+    using base::_read;
+    using base::_readCopy;
+    using base::_findRange;
+    using base::_findNext;
+    using base::_partition;
+    using base::_getFreeIndex;
+
+public:
+
+    using Iterator = typename base::template HashTableIterator<storage_node>;
+    using ConstIterator = typename base::template HashTableIterator<const storage_node>;
+
+    using container_base::foreach;
+
+    /**
+     * @brief Construct a new HashMultiMap object
+     */
+    HashMultiMap()
+    :   base()
+    { }
+
+    /**
+     * @brief Construct a new HashMultiMap object.
+     * 
+     * @param initialSize The initial size of the internal hash table. This
+     * value could be used to efficiently pre-allocate space, if the number of
+     * elements (or an estimate) is known.
+     */
+    HashMultiMap(size_t initialSize)
+    :   base(initialSize)
+    { }
+
+    HashMultiMap(const HashMultiMap &rhs)
+    :   base(rhs)
+    { }
+
+    HashMultiMap(HashMultiMap &&rhs)
+    :   base(std::move(rhs))
+    { }
+
+    /**
+     * @brief Construct a new HashMultiMap object.
+     * 
+     * @param list An initializer list of objects of type MapNode<Key, Val>.
+     */
+    HashMultiMap(const std::initializer_list<storage_node> &list)
+    :   base(list.size())
+    {
+        putAll(list);
+    }
+
+    /**
+     * @brief Construct a new HashMultiMap object.
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_same<HashMultiMap, Sequence>::value, int>::type = 0
+    >
+    HashMultiMap(const Sequence &seq)
+    :   base(seq.size())
+    {
+        putAll(seq);
+    }
+
+    /**
+     * @brief Construct a new HashMultiMap object.
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_same<HashMultiMap, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
+    HashMultiMap(Sequence &&seq)
+    :   base(seq.size())
+    {
+        putAll(std::move(seq));
+    }
+
+    /**
+     * @brief Construct a new HashMultiMap object.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     */
+    template <typename Begin, typename End>
+    HashMultiMap(const Begin &begin, const End &end)
+    :   base()
+    {
+        putAll(begin, end);
+    }
+
+    /**
+     * @brief Construct a new HashMultiMap object.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @param size The number of elements between begin and end.
+     */
+    template <typename Begin, typename End>
+    HashMultiMap(const Begin &begin, const End &end, size_t size)
+    :   base(size)
+    {
+        putAll(begin, end);
+    }
+
+    /**
+     * @brief Construct a new HashMultiMap object.
+     * 
+     * @tparam It A beginning iterator type that defines the typename
+     * `value_type` which will determine the resulting type. Note that
      * value_type must be a MapNode type.
      * @tparam EndIt An end iterator type.
      * @param begin The beginning iterator.
@@ -2582,6 +4128,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -2655,6 +4227,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashMultiMap & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashMultiMap & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether a mapping for some key exists.
      * 
@@ -2664,10 +4271,8 @@ public:
     template <typename K>
     bool contains(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        _controller.exit();
-        return i != __NPOS;
+        typename base::LookupSection section(_controller);
+        return _read(h, k, [] (const storage_node &) { });
     }
 
     /**
@@ -2681,15 +4286,13 @@ public:
     template <typename K>
     Val get(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Val retval = _table[i].storage.n.v;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        throw ElementNotFoundError();
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n.v; },
+            [] () -> Val { throw ElementNotFoundError(); }
+        );
     }
 
     /**
@@ -2704,15 +4307,28 @@ public:
     template <typename K>
     Val getOr(const K &k, const Val &defaultValue) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Val retval = _table[i].storage.n.v;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        return defaultValue;
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n.v; },
+            [&defaultValue] () { return defaultValue; }
+        );
+    }
+
+    /**
+     * @brief Retrieves a value corresponding to some key, without throwing
+     * on a miss.
+     * 
+     * @param[in] k The key to search for.
+     * @param[out] v Receives a copy of the value, if the key is found.
+     * @return True if the key is found, false otherwise.
+     */
+    template <typename K>
+    bool tryGet(const K &k, Val &v) const {
+        size_t h = _hash(k);
+        typename base::LookupSection section(_controller);
+        return _read(h, k, [&v] (const storage_node &n) { v = n.v; });
     }
 
     /**
@@ -2726,15 +4342,13 @@ public:
     template <typename K>
     storage_node getNode(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            storage_node retval = _table[i].storage.n;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        throw ElementNotFoundError();
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n; },
+            [] () -> storage_node { throw ElementNotFoundError(); }
+        );
     }
 
     /**
@@ -2748,7 +4362,7 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { k, v });
+        _set(i, h, { k, v });
         ++_size;
         _controller.exit();
         return *this;
@@ -2765,7 +4379,7 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { k, std::move(v) });
+        _set(i, h, { k, std::move(v) });
         ++_size;
         _controller.exit();
         return *this;
@@ -2782,7 +4396,7 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { std::move(k), v });
+        _set(i, h, { std::move(k), v });
         ++_size;
         _controller.exit();
         return *this;
@@ -2799,7 +4413,7 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, { std::move(k), std::move(v) });
+        _set(i, h, { std::move(k), std::move(v) });
         ++_size;
         _controller.exit();
         return *this;
@@ -2839,7 +4453,10 @@ public:
      * @param seq An iterable container of type MapNode<Key, Val> objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashMultiMap & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -2850,6 +4467,108 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n.v; },
+                    [] () -> Val { throw ElementNotFoundError(); }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the values corresponding to a sequence of keys. Keys are
+     * looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the value
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last value written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Val &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n.v; },
+                    [&defaultValue] () { return defaultValue; }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashMultiMap & putBatch(const Begin &begin, const End &end) {
+        _controller.enter();
+        _batch(
+            begin,
+            end,
+            [] (const storage_node &x) -> const Key & { return x.k; },
+            [this] (size_t h, Begin &it) {
+                size_t i = _getFreeIndex(h);
+                _set(i, h, { (*it).k, (*it).v });
+                ++_size;
+            }
+        );
+        _controller.exit();
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashMultiMap & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Erases a key from this map. If the key does not exist, the
      * function does nothing. If more than one key matches the given key, only
@@ -2865,7 +4584,7 @@ public:
         _controller.enter();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -2891,7 +4610,7 @@ public:
         _controller.lock();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -2917,8 +4636,8 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 retval = true;
                 break;
@@ -2948,8 +4667,8 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 retval = true;
                 break;
@@ -2974,7 +4693,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            _table[i].release();
+            _release(i);
             --_size;
             ++retval;
         }
@@ -2999,7 +4718,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            _table[i].release();
+            _release(i);
             --_size;
             ++retval;
         }
@@ -3023,8 +4742,8 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 ++retval;
             }
@@ -3051,8 +4770,8 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 ++retval;
             }
@@ -3077,8 +4796,8 @@ public:
         _controller.enter();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            Val retval = std::move(_table[i].storage.n.v);
-            _table[i].release();
+            Val retval = std::move(_at(i).storage.n.v);
+            _release(i);
             --_size;
             _controller.exit();
             return retval;
@@ -3105,8 +4824,8 @@ public:
         _controller.lock();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            Val retval = std::move(_table[i].storage.n.v);
-            _table[i].release();
+            Val retval = std::move(_at(i).storage.n.v);
+            _release(i);
             --_size;
             _controller.unlock();
             _controller.exit();
@@ -3134,9 +4853,9 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                Val retval = std::move(_table[i].storage.n.v);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                Val retval = std::move(_at(i).storage.n.v);
+                _release(i);
                 --_size;
                 _controller.exit();
                 return retval;
@@ -3166,9 +4885,9 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                Val retval = std::move(_table[i].storage.n.v);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                Val retval = std::move(_at(i).storage.n.v);
+                _release(i);
                 --_size;
                 _controller.unlock();
                 _controller.exit();
@@ -3195,8 +4914,8 @@ public:
         _controller.enter();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            storage_node retval = std::move(_table[i].storage.n);
-            _table[i].release();
+            storage_node retval = std::move(_at(i).storage.n);
+            _release(i);
             --_size;
             _controller.exit();
             return retval;
@@ -3223,8 +4942,8 @@ public:
         _controller.lock();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            storage_node retval = std::move(_table[i].storage.n);
-            _table[i].release();
+            storage_node retval = std::move(_at(i).storage.n);
+            _release(i);
             --_size;
             _controller.unlock();
             _controller.exit();
@@ -3252,9 +4971,9 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                storage_node retval = std::move(_table[i].storage.n);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                storage_node retval = std::move(_at(i).storage.n);
+                _release(i);
                 --_size;
                 _controller.exit();
                 return retval;
@@ -3284,9 +5003,9 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                storage_node retval = std::move(_table[i].storage.n);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                storage_node retval = std::move(_at(i).storage.n);
+                _release(i);
                 --_size;
                 _controller.unlock();
                 _controller.exit();
@@ -3311,7 +5030,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -3330,7 +5049,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -3352,7 +5071,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
@@ -3375,7 +5094,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
@@ -7,6 +7,7 @@
 
 #include <core/hash_table.h>
 #include <functional>       // std::equal_to
+#include <vector>
 #include <hash.h>
 #include <container.h>
 #include <exception.h>
@@ -22,11 +23,14 @@ namespace spl {
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
+ * @tparam Allocator The allocator policy used for the hash table storage. The
+ * default allocator uses the global heap.
  */
 template <
     typename Key,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    template <typename> class Allocator = core::HeapAllocator
 >
 class HashSet
 :   protected core::HashTable<
@@ -35,9 +39,10 @@ class HashSet
         KeyHash,
         core::HashSetNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashSetNode<Key>>
     >,
-    public ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual, Allocator>>,
     public Serializable
 {
 
@@ -51,20 +56,28 @@ private:
         KeyHash,
         core::HashSetNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashSetNode<Key>>
     >;
 
-    using container_base = ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual, Allocator>>;
+
+    friend container_base;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
     using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
     using base::_size;
     using base::_hash;
     using base::_findIndex;
     using base::_findRange;
     using base::_findNext;
+    using base::_partition;
     using base::_findOrGetFreeIndex;
 
 
@@ -134,7 +147,8 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashSet, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<HashSet, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     HashSet(Sequence &&seq)
     :   base(seq.size())
@@ -180,8 +194,18 @@ public:
      * @return A new HashSet object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static HashSet<typename It::value_type> create(const It &begin, const EndIt &end) {
-        return HashSet<typename It::value_type>(begin, end);
+    static HashSet<
+        typename It::value_type,
+        Hash<typename It::value_type>,
+        std::equal_to<typename It::value_type>,
+        Allocator
+    > create(const It &begin, const EndIt &end) {
+        return HashSet<
+            typename It::value_type,
+            Hash<typename It::value_type>,
+            std::equal_to<typename It::value_type>,
+            Allocator
+        >(begin, end);
     }
 
     /**
@@ -196,8 +220,18 @@ public:
      * @return A new HashSet object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static HashSet<typename It::value_type> create(const It &begin, const EndIt &end, size_t size) {
-        return HashSet<typename It::value_type>(begin, end, size);
+    static HashSet<
+        typename It::value_type,
+        Hash<typename It::value_type>,
+        std::equal_to<typename It::value_type>,
+        Allocator
+    > create(const It &begin, const EndIt &end, size_t size) {
+        return HashSet<
+            typename It::value_type,
+            Hash<typename It::value_type>,
+            std::equal_to<typename It::value_type>,
+            Allocator
+        >(begin, end, size);
     }
 
     ~HashSet() = default;
@@ -220,6 +254,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -293,6 +353,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashSet & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashSet & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether some key exists in this set.
      * 
@@ -319,7 +414,7 @@ public:
     Key get(const K &k) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n;
+        if (i != __NPOS) return _at(i).storage.n;
         throw ElementNotFoundError();
     }
 
@@ -336,7 +431,7 @@ public:
     Key getOr(const K &k, const Key &defaultValue) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n;
+        if (i != __NPOS) return _at(i).storage.n;
         return defaultValue;
     }
 
@@ -349,8 +444,8 @@ public:
     HashSet & put(const Key &k) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, k);
+        if (! _at(i).occupied()) {
+            _set(i, h, k);
             ++_size;
         }
         return *this;
@@ -365,8 +460,8 @@ public:
     HashSet & put(Key &&k) {
         size_t h = _hash(k);
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, std::move(k));
+        if (! _at(i).occupied()) {
+            _set(i, h, std::move(k));
             ++_size;
         }
         return *this;
@@ -406,7 +501,10 @@ public:
      * @param seq An iterable container of type Key objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashSet & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -417,6 +515,106 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    throw ElementNotFoundError();
+                }
+                *out = _at(i).storage.n;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Key &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    *out = defaultValue;
+                    ++out;
+                    return;
+                }
+                *out = _at(i).storage.n;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashSet & putBatch(const Begin &begin, const End &end) {
+        _batch(
+            begin,
+            end,
+            [] (const Key &k) -> const Key & { return k; },
+            [this] (size_t h, Begin &it) {
+                size_t i = _findOrGetFreeIndex(h, *it);
+                if (! _at(i).occupied()) {
+                    _set(i, h, *it);
+                    ++_size;
+                }
+            }
+        );
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashSet & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Erases a key from this set. If the key does not exist, the
      * function does nothing.
@@ -430,7 +628,7 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -450,8 +648,8 @@ public:
         bool retval = false;
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS && predicate(_table[i].storage.n)) {
-            _table[i].release();
+        if (i != __NPOS && predicate(_at(i).storage.n)) {
+            _release(i);
             --_size;
             retval = true;
         }
@@ -471,8 +669,8 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         return retval;
     }
@@ -491,9 +689,9 @@ public:
     Key remove(const K &k, Pred predicate) {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) throw ElementNotFoundError();
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) throw ElementNotFoundError();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         return retval;
     }
@@ -510,7 +708,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
@@ -527,7 +725,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
@@ -543,11 +741,15 @@ namespace parallel {
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
+ * @tparam Controller The concurrency control policy. The default policy is
+ * core::ConcurrentHashTableController. core::StripedHashTableController
+ * allows concurrent insertions of unrelated keys.
  */
 template <
     typename Key,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    typename Controller = core::ConcurrentHashTableController
 >
 class HashSet
 :   protected core::HashTable<
@@ -555,10 +757,10 @@ class HashSet
         core::AtomicHashSetNode<Key>,
         KeyHash,
         core::HashSetNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        Controller,
+        ShardedCounter<>
     >,
-    public ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual, Controller>>,
     public Serializable
 {
 
@@ -571,22 +773,31 @@ private:
         core::AtomicHashSetNode<Key>,
         KeyHash,
         core::HashSetNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        Controller,
+        ShardedCounter<>
     >;
 
-    using container_base = ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<HashSet<Key, KeyHash, KeyEqual, Controller>>;
+
+    friend container_base;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
     using base::_controller;
     using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
     using base::_size;
     using base::_hash;
     using base::_findIndex;
+    using base::_read;
+    using base::_readCopy;
     using base::_findRange;
     using base::_findNext;
+    using base::_partition;
     using base::_findOrGetFreeIndex;
 
 public:
@@ -655,7 +866,8 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashSet, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<HashSet, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     HashSet(Sequence &&seq)
     :   base(seq.size())
@@ -741,6 +953,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -809,6 +1047,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashSet & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashSet & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether some key exists in this set.
      * 
@@ -818,10 +1091,8 @@ public:
     template <typename K>
     bool contains(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        _controller.exit();
-        return i != __NPOS;
+        typename base::LookupSection section(_controller);
+        return _read(h, k, [] (const storage_node &) { });
     }
 
     /**
@@ -836,15 +1107,13 @@ public:
     template <typename K>
     Key get(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Key retval = _table[i].storage.n;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        throw ElementNotFoundError();
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n; },
+            [] () -> Key { throw ElementNotFoundError(); }
+        );
     }
 
     /**
@@ -859,15 +1128,13 @@ public:
     template <typename K>
     Key getOr(const K &k, const Key &defaultValue) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Key retval = _table[i].storage.n;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        return defaultValue;
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n; },
+            [&defaultValue] () { return defaultValue; }
+        );
     }
 
     /**
@@ -880,8 +1147,8 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, k);
+        if (! _at(i).occupied()) {
+            _set(i, h, k);
             ++_size;
         }
         _controller.exit();
@@ -898,8 +1165,8 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findOrGetFreeIndex(h, k);
-        if (! _table[i].occupied()) {
-            _table[i].set(h, std::move(k));
+        if (! _at(i).occupied()) {
+            _set(i, h, std::move(k));
             ++_size;
         }
         _controller.exit();
@@ -940,7 +1207,10 @@ public:
      * @param seq An iterable container of type Key objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashSet & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -951,6 +1221,110 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n; },
+                    [] () -> Key { throw ElementNotFoundError(); }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Key &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n; },
+                    [&defaultValue] () { return defaultValue; }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashSet & putBatch(const Begin &begin, const End &end) {
+        _controller.enter();
+        _batch(
+            begin,
+            end,
+            [] (const Key &k) -> const Key & { return k; },
+            [this] (size_t h, Begin &it) {
+                size_t i = _findOrGetFreeIndex(h, *it);
+                if (! _at(i).occupied()) {
+                    _set(i, h, *it);
+                    ++_size;
+                }
+            }
+        );
+        _controller.exit();
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashSet & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Erases a key from this set. If the key does not exist, the
      * function does nothing.
@@ -965,7 +1339,7 @@ public:
         _controller.enter();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -990,7 +1364,7 @@ public:
         _controller.lock();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1013,8 +1387,8 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findIndex(h, k);
-        if (i != __NPOS && predicate(_table[i].storage.n)) {
-            _table[i].release();
+        if (i != __NPOS && predicate(_at(i).storage.n)) {
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1039,8 +1413,8 @@ public:
         _controller.enter();
         _controller.lock();
         size_t i = _findIndex(h, k);
-        if (i != __NPOS && predicate(_table[i].storage.n)) {
-            _table[i].release();
+        if (i != __NPOS && predicate(_at(i).storage.n)) {
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1066,8 +1440,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.exit();
         return retval;
@@ -1094,8 +1468,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.unlock();
         _controller.exit();
@@ -1117,12 +1491,12 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) {
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) {
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.exit();
         return retval;
@@ -1144,13 +1518,13 @@ public:
         _controller.enter();
         _controller.lock();
         size_t i = _findIndex(h, k);
-        if (i == __NPOS || ! predicate(_table[i].storage.n)) {
+        if (i == __NPOS || ! predicate(_at(i).storage.n)) {
             _controller.unlock();
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.unlock();
         _controller.exit();
@@ -1170,7 +1544,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -1189,7 +1563,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -1211,7 +1585,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
@@ -1234,12 +1608,32 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
         return *this;
     }
+
+    /**
+     * @brief Applies a function to a copy of every key, without blocking
+     * concurrent writers for the length of the scan. Unlike iterators and
+     * foreach(), which must not run concurrently with resizes, and the _l
+     * variants, which lock out every writer, the scan is weakly consistent:
+     * every key present for the whole scan is visited exactly once, and keys
+     * inserted or erased during the scan may or may not be visited. Writers
+     * are held up at most for one migration step when the scan finishes a
+     * resize in progress.
+     * 
+     * @param f The function to apply, called with a const reference to a copy
+     * of each key. It runs outside of any lock and may access this container.
+     * @return A reference to this container for chaining.
+     */
+    template <typename F>
+    const HashSet & scan(F f) const {
+        base::_scan(f);
+        return *this;
+    }
 };
 
 }   // namespace parallel
@@ -1252,12 +1646,15 @@ public:
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
+ * @tparam Allocator The allocator policy used for the hash table storage. The
+ * default allocator uses the global heap.
  */
 
 template <
     typename Key,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    template <typename> class Allocator = core::HeapAllocator
 >
 class HashMultiSet
 :   protected core::HashTable<
@@ -1266,9 +1663,10 @@ class HashMultiSet
         KeyHash,
         core::HashSetNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashSetNode<Key>>
     >,
-    public ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual, Allocator>>,
     public Serializable
 {
 
@@ -1282,20 +1680,28 @@ private:
         KeyHash,
         core::HashSetNodeKeyEqual<KeyEqual>,
         core::HashTableController,
-        size_t
+        size_t,
+        Allocator<core::HashSetNode<Key>>
     >;
 
-    using container_base = ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual, Allocator>>;
+
+    friend container_base;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
     using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
     using base::_size;
     using base::_hash;
     using base::_findIndex;
     using base::_findRange;
     using base::_findNext;
+    using base::_partition;
     using base::_getFreeIndex;
 
 public:
@@ -1364,7 +1770,8 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashMultiSet, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<HashMultiSet, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     HashMultiSet(Sequence &&seq)
     :   base(seq.size())
@@ -1410,8 +1817,18 @@ public:
      * @return A new HashMultiSet object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static HashMultiSet<typename It::value_type> create(const It &begin, const EndIt &end) {
-        return HashMultiSet<typename It::value_type>(begin, end);
+    static HashMultiSet<
+        typename It::value_type,
+        Hash<typename It::value_type>,
+        std::equal_to<typename It::value_type>,
+        Allocator
+    > create(const It &begin, const EndIt &end) {
+        return HashMultiSet<
+            typename It::value_type,
+            Hash<typename It::value_type>,
+            std::equal_to<typename It::value_type>,
+            Allocator
+        >(begin, end);
     }
 
     /**
@@ -1426,8 +1843,18 @@ public:
      * @return A new HashMultiSet object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static HashMultiSet<typename It::value_type> create(const It &begin, const EndIt &end, size_t size) {
-        return HashMultiSet<typename It::value_type>(begin, end, size);
+    static HashMultiSet<
+        typename It::value_type,
+        Hash<typename It::value_type>,
+        std::equal_to<typename It::value_type>,
+        Allocator
+    > create(const It &begin, const EndIt &end, size_t size) {
+        return HashMultiSet<
+            typename It::value_type,
+            Hash<typename It::value_type>,
+            std::equal_to<typename It::value_type>,
+            Allocator
+        >(begin, end, size);
     }
 
     ~HashMultiSet() = default;
@@ -1450,6 +1877,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -1523,6 +1976,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashMultiSet & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashMultiSet & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether some key exists in this set.
      * 
@@ -1549,7 +2037,7 @@ public:
     Key get(const K &k) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n;
+        if (i != __NPOS) return _at(i).storage.n;
         throw ElementNotFoundError();
     }
 
@@ -1566,7 +2054,7 @@ public:
     Key getOr(const K &k, const Key &defaultValue) const {
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
-        if (i != __NPOS) return _table[i].storage.n;
+        if (i != __NPOS) return _at(i).storage.n;
         return defaultValue;
     }
 
@@ -1579,7 +2067,7 @@ public:
     HashMultiSet & put(const Key &k) {
         size_t h = _hash(k);
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, k);
+        _set(i, h, k);
         ++_size;
         return *this;
     }
@@ -1593,7 +2081,7 @@ public:
     HashMultiSet & put(Key &&k) {
         size_t h = _hash(k);
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, std::move(k));
+        _set(i, h, std::move(k));
         ++_size;
         return *this;
     }
@@ -1632,7 +2120,10 @@ public:
      * @param seq An iterable container of type Key objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashMultiSet & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -1643,6 +2134,104 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    throw ElementNotFoundError();
+                }
+                *out = _at(i).storage.n;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Key &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                size_t i = _findIndex(h, *it);
+                if (i == __NPOS) {
+                    *out = defaultValue;
+                    ++out;
+                    return;
+                }
+                *out = _at(i).storage.n;
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashMultiSet & putBatch(const Begin &begin, const End &end) {
+        _batch(
+            begin,
+            end,
+            [] (const Key &k) -> const Key & { return k; },
+            [this] (size_t h, Begin &it) {
+                size_t i = _getFreeIndex(h);
+                _set(i, h, *it);
+                ++_size;
+            }
+        );
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashMultiSet & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Erases a key from this set. If the key does not exist, the
      * function does nothing. If more than one key matches the given key, only
@@ -1657,7 +2246,7 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -1680,8 +2269,8 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 retval = true;
                 break;
@@ -1703,7 +2292,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            _table[i].release();
+            _release(i);
             --_size;
             ++retval;
         }
@@ -1724,8 +2313,8 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 ++retval;
             }
@@ -1746,8 +2335,8 @@ public:
         size_t h = _hash(k);
         size_t i = _findIndex(h, k);
         if (i == __NPOS) throw ElementNotFoundError();
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         return retval;
     }
@@ -1768,9 +2357,9 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                Key retval = std::move(_table[i].storage.n);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                Key retval = std::move(_at(i).storage.n);
+                _release(i);
                 --_size;
                 return retval;
             }
@@ -1790,7 +2379,7 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
@@ -1807,39 +2396,46 @@ public:
         size_t h = _hash(k);
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         return *this;
     }
 };
 
-namespace parallel {
-
 /**
- * @brief A hash multi-set supporting thread-safe, O(1) lookup, insert, and
- * delete.
+ * @brief A hash multi-set that groups equal keys together: every distinct key
+ * occupies a single slot holding the number of times it was inserted.
+ * Compared to HashMultiSet, which stores every occurrence in a slot of its
+ * own, keys inserted many times neither lengthen probe ranges nor force the
+ * table to grow. The key kept for a group is the first one inserted; later
+ * equal keys only increase its count. Iteration visits each distinct key once
+ * as a MapNode<Key, size_t> holding the key and its count.
  * 
  * @tparam Key The key type.
  * @tparam KeyHash A functor to calculate the hash code of the key type. The
  * default functor is Hash<Key>.
  * @tparam KeyEqual A functor to test for key equality. The default functor is
  * std::equal_to<Key>.
-*/
+ * @tparam Allocator The allocator policy used for the hash table storage. The
+ * default allocator uses the global heap.
+ */
 template <
     typename Key,
     typename KeyHash = Hash<Key>,
-    typename KeyEqual = std::equal_to<Key>
+    typename KeyEqual = std::equal_to<Key>,
+    template <typename> class Allocator = core::HeapAllocator
 >
-class HashMultiSet
+class GroupedHashMultiSet
 :   protected core::HashTable<
         Key,
-        core::AtomicHashSetNode<Key>,
+        core::HashMapNode<Key, size_t>,
         KeyHash,
-        core::HashSetNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        core::HashMapNodeKeyEqual<KeyEqual>,
+        core::HashTableController,
+        size_t,
+        Allocator<core::HashMapNode<Key, size_t>>
     >,
-    public ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual>>,
+    public ForwardIterableContainer<GroupedHashMultiSet<Key, KeyHash, KeyEqual, Allocator>>,
     public Serializable
 {
 
@@ -1849,53 +2445,482 @@ private:
 
     using base = typename core::HashTable<
         Key,
-        core::AtomicHashSetNode<Key>,
+        core::HashMapNode<Key, size_t>,
         KeyHash,
-        core::HashSetNodeKeyEqual<KeyEqual>,
-        core::ConcurrentHashTableController,
-        std::atomic_size_t
+        core::HashMapNodeKeyEqual<KeyEqual>,
+        core::HashTableController,
+        size_t,
+        Allocator<core::HashMapNode<Key, size_t>>
     >;
 
-    using container_base = ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual>>;
+    using container_base = ForwardIterableContainer<GroupedHashMultiSet<Key, KeyHash, KeyEqual, Allocator>>;
+
+    friend container_base;
 
     using storage_node = typename base::storage_node;
 
     using base::__NPOS;
-    using base::_controller;
-    using base::_table;
-    using base::_size;
+    using base::_at;
+    using base::_release;
     using base::_hash;
     using base::_findIndex;
-    using base::_findRange;
-    using base::_findNext;
-    using base::_getFreeIndex;
+    using base::_findOrGetFreeIndex;
+    using base::_emplace;
+
+    std::vector<typename base::template HashTableIterator<const storage_node>> _partition(size_t n) const {
+        return base::_partition(n);
+    }
+
+    size_t _count = 0;
+
+    template <typename K>
+    void _put(K &&k, size_t n) {
+        size_t h = _hash(k);
+        size_t i = _findOrGetFreeIndex(h, k);
+        if (_at(i).occupied()) {
+            _at(i).storage.n.v += n;
+        }
+        else {
+            _emplace(i, h, core::EmplaceTag(), std::forward<K>(k), n);
+            ++base::_size;
+        }
+        _count += n;
+    }
+
+    /**
+     * @brief Removes up to n occurrences of a key, releasing its slot once
+     * none are left.
+     *
+     * @return The number of occurrences removed.
+     */
+    template <typename K>
+    size_t _erase(const K &k, size_t n) {
+        size_t i = _findIndex(_hash(k), k);
+        if (i == __NPOS) return 0;
+        size_t &c = _at(i).storage.n.v;
+        size_t erased = n < c ? n : c;
+        c -= erased;
+        _count -= erased;
+        if (c == 0) {
+            _release(i);
+            --base::_size;
+        }
+        return erased;
+    }
 
 public:
 
-    using Iterator = typename base::template HashTableIterator<storage_node>;
+    using Iterator = typename base::template HashTableIterator<const storage_node>;
     using ConstIterator = typename base::template HashTableIterator<const storage_node>;
 
     using container_base::foreach;
 
     /**
-     * @brief Construct a new HashMultiSet object.
+     * @brief Construct a new GroupedHashMultiSet object.
      */
-    HashMultiSet()
+    GroupedHashMultiSet()
     :   base()
     { }
 
     /**
-     * @brief Construct a new HashMultiSet object.
+     * @brief Construct a new GroupedHashMultiSet object.
      * 
      * @param initialSize The initial size of the internal hash table. This
      * value could be used to efficiently pre-allocate space, if the number of
-     * elements (or an estimate) is known.
+     * distinct keys (or an estimate) is known.
      */
-    HashMultiSet(size_t initialSize)
+    GroupedHashMultiSet(size_t initialSize)
     :   base(initialSize)
     { }
 
-    HashMultiSet(const HashMultiSet &rhs)
+    GroupedHashMultiSet(const GroupedHashMultiSet &rhs)
+    :   base(rhs),
+        _count(rhs._count)
+    { }
+
+    GroupedHashMultiSet(GroupedHashMultiSet &&rhs)
+    :   base(std::move(rhs)),
+        _count(rhs._count)
+    {
+        rhs._count = 0;
+    }
+
+    /**
+     * @brief Construct a new GroupedHashMultiSet object.
+     * 
+     * @param list An initializer list of objects of type Key.
+     */
+    GroupedHashMultiSet(const std::initializer_list<Key> &list)
+    :   base()
+    {
+        putAll(list);
+    }
+
+    /**
+     * @brief Construct a new GroupedHashMultiSet object.
+     * 
+     * @param seq An iterable container of type Key objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_same<GroupedHashMultiSet, Sequence>::value, int>::type = 0
+    >
+    GroupedHashMultiSet(const Sequence &seq)
+    :   base()
+    {
+        putAll(seq);
+    }
+
+    /**
+     * @brief Construct a new GroupedHashMultiSet object.
+     * 
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     */
+    template <typename Begin, typename End>
+    GroupedHashMultiSet(const Begin &begin, const End &end)
+    :   base()
+    {
+        putAll(begin, end);
+    }
+
+    ~GroupedHashMultiSet() = default;
+
+    GroupedHashMultiSet & operator=(const GroupedHashMultiSet &rhs) {
+        base::operator=(rhs);
+        _count = rhs._count;
+        return *this;
+    }
+
+    GroupedHashMultiSet & operator=(GroupedHashMultiSet &&rhs) {
+        base::operator=(std::move(rhs));
+        _count = rhs._count;
+        rhs._count = 0;
+        return *this;
+    }
+
+    void writeObject(OutputStreamSerializer &serializer) const override {
+        serializer << _count;
+        base::_serialize(serializer);
+    }
+
+    void readObject(InputStreamSerializer &serializer) override {
+        serializer >> _count;
+        base::_deserialize(serializer);
+    }
+
+    /**
+     * @return The number of keys in this container, counting every
+     * occurrence.
+     */
+    size_t size() const {
+        return _count;
+    }
+
+    /**
+     * @return The number of distinct keys in this container.
+     */
+    size_t keyCount() const {
+        return base::size();
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return _count == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return _count != 0;
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator cbegin() const {
+        return base::cbegin();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator cend() const {
+        return base::cend();
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator begin() const {
+        return base::cbegin();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator end() const {
+        return base::cend();
+    }
+
+    /**
+     * @brief Erases all elements in this container.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiSet & clear() {
+        base::clear();
+        _count = 0;
+        return *this;
+    }
+
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * distinct keys without further resizing.
+     * 
+     * @param n The number of keys to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiSet & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current keys
+     * need, releasing the memory held after erasing many keys.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiSet & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
+    /**
+     * @brief Tests whether some key exists in this set.
+     * 
+     * @param k The key to search for.
+     * @return True if the key exists, false otherwise.
+     */
+    template <typename K>
+    bool contains(const K &k) const {
+        return _findIndex(_hash(k), k) != __NPOS;
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return The number of occurrences of the given key.
+     */
+    template <typename K>
+    size_t count(const K &k) const {
+        size_t i = _findIndex(_hash(k), k);
+        return i != __NPOS ? _at(i).storage.n.v : 0;
+    }
+
+    /**
+     * @brief Retrieves the actual key corresponding to some given key. If the
+     * given key is not found in the set, an ElementNotFoundError will be
+     * thrown.
+     * 
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A copy of the first inserted key equal to the given key.
+     */
+    template <typename K>
+    Key get(const K &k) const {
+        size_t i = _findIndex(_hash(k), k);
+        if (i == __NPOS) throw ElementNotFoundError();
+        return _at(i).storage.n.k;
+    }
+
+    /**
+     * @brief Inserts a key.
+     * 
+     * @param k The key to insert.
+     * @param n The number of occurrences to insert.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiSet & put(const Key &k, size_t n = 1) {
+        if (n > 0) _put(k, n);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a key.
+     * 
+     * @param k The key to insert.
+     * @param n The number of occurrences to insert.
+     * @return A reference to this container for chaining.
+     */
+    GroupedHashMultiSet & put(Key &&k, size_t n = 1) {
+        if (n > 0) _put(std::move(k), n);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a range of keys.
+     * 
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    GroupedHashMultiSet & putAll(const Begin &begin, const End &end) {
+        auto it = begin;
+        while (it != end) {
+            put(*it);
+            ++it;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all keys of an iterable container.
+     * 
+     * @param seq An iterable container of type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    GroupedHashMultiSet & putAll(const Sequence &seq) {
+        return putAll(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Erases one occurrence of a key. If the key does not exist, the
+     * function does nothing.
+     * 
+     * @param k The key to erase.
+     * @return True if a key was erased, false otherwise.
+     */
+    template <typename K>
+    bool erase(const K &k) {
+        return _erase(k, 1) != 0;
+    }
+
+    /**
+     * @brief Erases all occurrences of a key. If the key does not exist, the
+     * function does nothing.
+     * 
+     * @param k The key to erase.
+     * @return Number of occurrences erased.
+     */
+    template <typename K>
+    size_t eraseAll(const K &k) {
+        return _erase(k, __NPOS);
+    }
+};
+
+namespace parallel {
+
+/**
+ * @brief A hash multi-set supporting thread-safe, O(1) lookup, insert, and
+ * delete.
+ * 
+ * @tparam Key The key type.
+ * @tparam KeyHash A functor to calculate the hash code of the key type. The
+ * default functor is Hash<Key>.
+ * @tparam KeyEqual A functor to test for key equality. The default functor is
+ * std::equal_to<Key>.
+ * @tparam Controller The concurrency control policy. The default policy is
+ * core::ConcurrentHashTableController. core::StripedHashTableController
+ * allows concurrent insertions of unrelated keys.
+*/
+template <
+    typename Key,
+    typename KeyHash = Hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Controller = core::ConcurrentHashTableController
+>
+class HashMultiSet
+:   protected core::HashTable<
+        Key,
+        core::AtomicHashSetNode<Key>,
+        KeyHash,
+        core::HashSetNodeKeyEqual<KeyEqual>,
+        Controller,
+        ShardedCounter<>
+    >,
+    public ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual, Controller>>,
+    public Serializable
+{
+
+    template <typename HashSetType> friend struct HashSetTester;
+
+private:
+
+    using base = typename core::HashTable<
+        Key,
+        core::AtomicHashSetNode<Key>,
+        KeyHash,
+        core::HashSetNodeKeyEqual<KeyEqual>,
+        Controller,
+        ShardedCounter<>
+    >;
+
+    using container_base = ForwardIterableContainer<HashMultiSet<Key, KeyHash, KeyEqual, Controller>>;
+
+    friend container_base;
+
+    using storage_node = typename base::storage_node;
+
+    using base::__NPOS;
+    using base::_controller;
+    using base::_table;
+    using base::_at;
+    using base::_set;
+    using base::_release;
+    using base::_batch;
+    using base::_size;
+    using base::_hash;
+    using base::_findIndex;
+    using base::_read;
+    using base::_readCopy;
+    using base::_findRange;
+    using base::_findNext;
+    using base::_partition;
+    using base::_getFreeIndex;
+
+public:
+
+    using Iterator = typename base::template HashTableIterator<storage_node>;
+    using ConstIterator = typename base::template HashTableIterator<const storage_node>;
+
+    using container_base::foreach;
+
+    /**
+     * @brief Construct a new HashMultiSet object.
+     */
+    HashMultiSet()
+    :   base()
+    { }
+
+    /**
+     * @brief Construct a new HashMultiSet object.
+     * 
+     * @param initialSize The initial size of the internal hash table. This
+     * value could be used to efficiently pre-allocate space, if the number of
+     * elements (or an estimate) is known.
+     */
+    HashMultiSet(size_t initialSize)
+    :   base(initialSize)
+    { }
+
+    HashMultiSet(const HashMultiSet &rhs)
     :   base(rhs)
     { }
 
@@ -1936,7 +2961,8 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_same<HashMultiSet, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_same<HashMultiSet, Sequence>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     HashMultiSet(Sequence &&seq)
     :   base(seq.size())
@@ -2022,6 +3048,32 @@ public:
         base::_deserialize(serializer);
     }
 
+    /**
+     * @brief Writes this container in independent chunks, encoded and written
+     * by several threads at once. The serializer must support concurrent
+     * positional writes for this to scale; see
+     * OutputRandomAccessSerializer::writeAt(). The result can only be read
+     * back with parallelReadObject().
+     * 
+     * @param[in] serializer The serializer to write to.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelWriteObject(OutputRandomAccessSerializer &serializer, size_t threads = 0) const {
+        base::_serializeChunked(serializer, threads);
+    }
+
+    /**
+     * @brief Reads this container from chunks written by
+     * parallelWriteObject(), decoded by several threads at once. Any number of
+     * threads can read chunks written by any number of threads.
+     * 
+     * @param[in] serializer The serializer to read from.
+     * @param[in] threads The number of threads, or 0 for as many as available.
+     */
+    void parallelReadObject(InputRandomAccessSerializer &serializer, size_t threads = 0) {
+        base::_deserializeChunked(serializer, threads);
+    }
+
     /**
      * @return The size of this container.
      */
@@ -2095,6 +3147,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Grows the internal hash table to hold at least some number of
+     * elements without further resizing. Useful ahead of loading a data set
+     * of known size.
+     * 
+     * @param n The number of elements to reserve space for.
+     * @return A reference to this container for chaining.
+     */
+    HashMultiSet & reserve(size_t n) {
+        base::reserve(n);
+        return *this;
+    }
+
+    /**
+     * @brief Shrinks the internal hash table to the size the current elements
+     * need, releasing the memory held after erasing many elements.
+     * 
+     * @return A reference to this container for chaining.
+     */
+    HashMultiSet & shrinkToFit() {
+        base::shrinkToFit();
+        return *this;
+    }
+
+    /**
+     * @brief Reports the layout of the internal hash table, such as its load
+     * factor, probe lengths and colliding hash codes, and its resize history
+     * if SPL_HASH_TABLE_STATS is defined. Scans the whole table.
+     * 
+     * @return The statistics.
+     */
+    HashTableStats stats() const {
+        return base::stats();
+    }
+
     /**
      * @brief Tests whether some key exists in this set.
      * 
@@ -2104,10 +3191,8 @@ public:
     template <typename K>
     bool contains(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        _controller.exit();
-        return i != __NPOS;
+        typename base::LookupSection section(_controller);
+        return _read(h, k, [] (const storage_node &) { });
     }
 
     /**
@@ -2122,15 +3207,13 @@ public:
     template <typename K>
     Key get(const K &k) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Key retval = _table[i].storage.n;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        throw ElementNotFoundError();
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n; },
+            [] () -> Key { throw ElementNotFoundError(); }
+        );
     }
 
     /**
@@ -2145,15 +3228,13 @@ public:
     template <typename K>
     Key getOr(const K &k, const Key &defaultValue) const {
         size_t h = _hash(k);
-        _controller.enter();
-        size_t i = _findIndex(h, k);
-        if (i != __NPOS) {
-            Key retval = _table[i].storage.n;
-            _controller.exit();
-            return retval;
-        }
-        _controller.exit();
-        return defaultValue;
+        typename base::LookupSection section(_controller);
+        return _readCopy(
+            h,
+            k,
+            [] (const storage_node &n) { return n; },
+            [&defaultValue] () { return defaultValue; }
+        );
     }
 
     /**
@@ -2166,7 +3247,7 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, k);
+        _set(i, h, k);
         ++_size;
         _controller.exit();
         return *this;
@@ -2182,7 +3263,7 @@ public:
         size_t h = _hash(k);
         _controller.enter();
         size_t i = _getFreeIndex(h);
-        _table[i].set(h, std::move(k));
+        _set(i, h, std::move(k));
         ++_size;
         _controller.exit();
         return *this;
@@ -2222,7 +3303,10 @@ public:
      * @param seq An iterable container of type Key objects.
      * @return A reference to this container for chaining.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     HashMultiSet & putAll(Sequence &&seq) {
         auto it = seq.begin();
         auto end = seq.end();
@@ -2233,6 +3317,108 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches. If a key is not found, an
+     * ElementNotFoundError will be thrown.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, in order.
+     * @throws ElementNotFoundError if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n; },
+                    [] () -> Key { throw ElementNotFoundError(); }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Retrieves the actual keys corresponding to a sequence of keys.
+     * Keys are looked up in prefetched batches.
+     * 
+     * @param keys An iterable container of keys to search for.
+     * @param out An output iterator receiving a copy of the actual key
+     * corresponding to each key, or the default value, in order.
+     * @param defaultValue The default value to write if a key is not found.
+     * @return The output iterator past the last actual key written.
+     */
+    template <typename Sequence, typename Out>
+    Out getBatch(const Sequence &keys, Out out, const Key &defaultValue) const {
+        using It = decltype(keys.begin());
+        using K = typename std::decay<decltype(*keys.begin())>::type;
+        typename base::LookupSection section(_controller);
+        _batch(
+            keys.begin(),
+            keys.end(),
+            [] (const K &k) -> const K & { return k; },
+            [this, &out, &defaultValue] (size_t h, It &it) {
+                *out = _readCopy(
+                    h,
+                    *it,
+                    [] (const storage_node &n) { return n; },
+                    [&defaultValue] () { return defaultValue; }
+                );
+                ++out;
+            }
+        );
+        return out;
+    }
+
+    /**
+     * @brief Inserts a range of elements. Elements are inserted in prefetched
+     * batches.
+     * 
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    HashMultiSet & putBatch(const Begin &begin, const End &end) {
+        _controller.enter();
+        _batch(
+            begin,
+            end,
+            [] (const Key &k) -> const Key & { return k; },
+            [this] (size_t h, Begin &it) {
+                size_t i = _getFreeIndex(h);
+                _set(i, h, *it);
+                ++_size;
+            }
+        );
+        _controller.exit();
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container in batches. See
+     * putBatch(begin, end).
+     * 
+     * @param seq An iterable container of type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    HashMultiSet & putBatch(const Sequence &seq) {
+        return putBatch(seq.begin(), seq.end());
+    }
+
     /**
      * @brief Erases a key from this set. If the key does not exist, the
      * function does nothing. If more than one key matches the given key, only
@@ -2248,7 +3434,7 @@ public:
         _controller.enter();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -2274,7 +3460,7 @@ public:
         _controller.lock();
         size_t i = _findIndex(h, k);
         if (i != __NPOS) {
-            _table[i].release();
+            _release(i);
             --_size;
             retval = true;
         }
@@ -2300,8 +3486,8 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 retval = true;
                 break;
@@ -2331,8 +3517,8 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 retval = true;
                 break;
@@ -2357,7 +3543,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            _table[i].release();
+            _release(i);
             --_size;
             ++retval;
         }
@@ -2382,7 +3568,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            _table[i].release();
+            _release(i);
             --_size;
             ++retval;
         }
@@ -2406,8 +3592,8 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 ++retval;
             }
@@ -2434,8 +3620,8 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                _release(i);
                 --_size;
                 ++retval;
             }
@@ -2463,8 +3649,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.exit();
         return retval;
@@ -2492,8 +3678,8 @@ public:
             _controller.exit();
             throw ElementNotFoundError();
         }
-        Key retval = std::move(_table[i].storage.n);
-        _table[i].release();
+        Key retval = std::move(_at(i).storage.n);
+        _release(i);
         --_size;
         _controller.unlock();
         _controller.exit();
@@ -2517,9 +3703,9 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                Key retval = std::move(_table[i].storage.n);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                Key retval = std::move(_at(i).storage.n);
+                _release(i);
                 --_size;
                 _controller.exit();
                 return retval;
@@ -2547,9 +3733,9 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            if (predicate(_table[i].storage.n)) {
-                Key retval = std::move(_table[i].storage.n);
-                _table[i].release();
+            if (predicate(_at(i).storage.n)) {
+                Key retval = std::move(_at(i).storage.n);
+                _release(i);
                 --_size;
                 _controller.unlock();
                 _controller.exit();
@@ -2574,7 +3760,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -2593,7 +3779,7 @@ public:
         _controller.enter();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.exit();
         return *this;
@@ -2615,7 +3801,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
@@ -2638,7 +3824,7 @@ public:
         _controller.lock();
         auto range = _findRange(h);
         for (size_t i = _findNext(range, h, k); i != __NPOS; i = _findNext(range, h, k)) {
-            f(_table[i].storage.n);
+            f(_at(i).storage.n);
         }
         _controller.unlock();
         _controller.exit();
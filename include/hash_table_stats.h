@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spl {
+
+/**
+ * @brief The geometry of a hash table after it was resized.
+ */
+struct ResizeEvent {
+    uint64_t time;      // steady clock time in nanoseconds
+    size_t size;        // elements when the resize started
+    size_t bucketSize;
+    size_t buckets;
+};
+
+/**
+ * @brief A snapshot of the layout of a hash table, to tell apart poorly
+ * distributed hash codes, which show as duplicate hash codes and loaded
+ * buckets, from a table that outgrew its buckets, which shows as long probes
+ * and a growing bucket size.
+ *
+ * The layout is always reported. The resize counters and history are only
+ * recorded if SPL_HASH_TABLE_STATS is defined, as indicated by recorded.
+ */
+struct HashTableStats {
+    size_t size = 0;
+    size_t tableSize = 0;           // slots
+    size_t bucketSize = 0;          // slots per bucket
+    size_t buckets = 0;
+    double loadFactor = 0;          // size / tableSize
+    bool migrating = false;         // a resize is moving elements to the new table
+
+    std::vector<size_t> probeLengths;   // [d] = elements d slots past the start of their bucket
+    size_t maxProbeLength = 0;
+    double meanProbeLength = 0;
+    size_t overflowed = 0;              // elements placed past the end of their bucket
+
+    std::vector<size_t> bucketLoads;    // [k] = buckets that k elements hash to
+    size_t maxBucketLoad = 0;
+    size_t duplicateHashes = 0;         // elements sharing their hash code with another one
+    size_t maxSameHash = 0;             // the most elements sharing one hash code
+
+    bool recorded = false;
+    uint64_t resizes = 0;
+    uint64_t bucketSizeIncreases = 0;
+    uint64_t bucketCountIncreases = 0;
+    uint64_t rehashNanos = 0;           // spent rehashing and migrating elements
+    std::vector<ResizeEvent> history;   // the most recent resizes, oldest first
+};
+
+namespace core {
+
+/**
+ * @brief Records the resizes of a hash table, when SPL_HASH_TABLE_STATS is
+ * defined. Must only be used with the table's controller locked.
+ */
+class HashTableStatsRecorder {
+
+public:
+
+    static constexpr size_t HISTORY = 64;   // resizes kept in the history
+
+private:
+
+    uint64_t _resizes = 0;
+    uint64_t _bucketSizeIncreases = 0;
+    uint64_t _bucketCountIncreases = 0;
+    uint64_t _rehashNanos = 0;
+    uint64_t _rehashStart = 0;
+    size_t _rehashDepth = 0;
+    std::vector<ResizeEvent> _history;
+
+    static uint64_t _now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+public:
+
+    /**
+     * @brief Times a rehash for the lifetime of the object. Nested timers
+     * only count once.
+     */
+    class RehashTimer {
+
+    private:
+
+        HashTableStatsRecorder &_r;
+
+    public:
+
+        RehashTimer(HashTableStatsRecorder &r)
+        :   _r(r)
+        {
+            if (_r._rehashDepth++ == 0) _r._rehashStart = _now();
+        }
+
+        ~RehashTimer() {
+            if (--_r._rehashDepth == 0) _r._rehashNanos += _now() - _r._rehashStart;
+        }
+    };
+
+    template <typename Geometry>
+    void _recordResize(const Geometry &from, const Geometry &to, size_t size) {
+        ++_resizes;
+        if (to.bucketSize > from.bucketSize) ++_bucketSizeIncreases;
+        if (to.nBuckets > from.nBuckets) ++_bucketCountIncreases;
+
+        if (_history.size() == HISTORY) _history.erase(_history.begin());
+        _history.push_back({ _now(), size, to.bucketSize, to.nBuckets });
+    }
+
+    void _recordedStats(HashTableStats &stats) const {
+        stats.recorded = true;
+        stats.resizes = _resizes;
+        stats.bucketSizeIncreases = _bucketSizeIncreases;
+        stats.bucketCountIncreases = _bucketCountIncreases;
+        stats.rehashNanos = _rehashNanos;
+        stats.history = _history;
+    }
+};
+
+/**
+ * @brief The resize recorder of hash tables built without
+ * SPL_HASH_TABLE_STATS, which records nothing and takes no space as a base
+ * class.
+ */
+class NullHashTableStatsRecorder {
+
+public:
+
+    class RehashTimer {
+
+    public:
+
+        RehashTimer(NullHashTableStatsRecorder &) { }
+    };
+
+    template <typename Geometry>
+    void _recordResize(const Geometry &, const Geometry &, size_t) { }
+
+    void _recordedStats(HashTableStats &) const { }
+};
+
+#if defined(SPL_HASH_TABLE_STATS)
+using HashTableRecorder = HashTableStatsRecorder;
+#else
+using HashTableRecorder = NullHashTableStatsRecorder;
+#endif
+
+} // namespace core
+
+} // namespace spl
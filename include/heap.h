@@ -6,16 +6,85 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <thread>
 #include <type_traits>
+#include <vector>
 #include <container.h>
+#include <core/node_pool.h>
 #include <iterator.h>
 #include <serialization.h>
 #include <exception.h>
 
 namespace spl {
 
+namespace __Heap {
+
+struct NoTracking {
+    void operator()(size_t) const { }
+};
+
+/**
+ * @brief Moves the element at pos towards the root of an Arity-ary heap.
+ * moved(i) is called for every position i that receives a different element.
+ */
+template <size_t Arity, typename T, typename Comp, typename Moved>
+void siftUp(T *data, size_t pos, Comp &comp, Moved moved) {
+    T elem = std::move(data[pos]);
+    while (pos > 0) {
+        size_t parent = (pos - 1) / Arity;
+        if (! comp(data[parent], elem)) break;
+        data[pos] = std::move(data[parent]);
+        moved(pos);
+        pos = parent;
+    }
+    data[pos] = std::move(elem);
+    moved(pos);
+}
+
+/**
+ * @brief Moves the element at pos towards the leaves of an Arity-ary heap.
+ * moved(i) is called for every position i that receives a different element.
+ */
+template <size_t Arity, typename T, typename Comp, typename Moved>
+void siftDown(T *data, size_t size, size_t pos, Comp &comp, Moved moved) {
+    T elem = std::move(data[pos]);
+    while (true) {
+        size_t first = pos * Arity + 1;
+        if (first >= size) break;
+
+        size_t last = size - first > Arity ? first + Arity : size;
+        size_t best = first;
+        for (size_t c = first + 1; c < last; ++c) {
+            if (comp(data[best], data[c])) best = c;
+        }
+
+        if (! comp(elem, data[best])) break;
+        data[pos] = std::move(data[best]);
+        moved(pos);
+        pos = best;
+    }
+    data[pos] = std::move(elem);
+    moved(pos);
+}
+
+/**
+ * @brief Arranges size elements into an Arity-ary heap in O(size).
+ */
+template <size_t Arity, typename T, typename Comp, typename Moved>
+void heapify(T *data, size_t size, Comp &comp, Moved moved) {
+    if (size < 2) return;
+    for (size_t i = (size - 2) / Arity + 1; i-- > 0; ) {
+        siftDown<Arity>(data, size, i, comp, moved);
+    }
+}
+
+}   // namespace __Heap
+
 /**
  * @brief A sorted heap supporting O(log n) push and pop operations.
  * 
@@ -23,21 +92,42 @@ namespace spl {
  * @tparam comp The comparator functor used to sort the heap. The default
  * functor is std::less<T>, which will guarantee that pop() will always return
  * an element that doesn't compare less than any other element; i.e. a max heap.
+ * @tparam Arity The number of children of each heap node. Wider heaps are
+ * shallower, so pop() touches fewer cache lines on large heaps. Storage is
+ * laid out such that all children of a node share one cache line whenever
+ * Arity * sizeof(T) divides 64. (default = 2)
+ * @tparam Allocator The allocator policy used for the heap storage. The
+ * default allocator uses the global heap.
  */
-template <typename T, typename comp = std::less<T>>
+template <
+    typename T,
+    typename comp = std::less<T>,
+    size_t Arity = 2,
+    template <typename> class Allocator = core::HeapAllocator
+>
 class Heap
-:   public ForwardIterableContainer<Heap<T, comp>>,
+:   public ForwardIterableContainer<Heap<T, comp, Arity, Allocator>>,
     public Serializable
 {
+    static_assert(Arity >= 2, "Heap arity must be at least 2");
+
+    friend class ForwardIterableContainer<Heap>;
+
 private:
 
     static constexpr size_t INITIAL_SIZE = 64;
     static constexpr size_t LINEAR_INCREMENT_THRESHOLD = 64 * 1024 * 1024;
+    static constexpr size_t __CACHE_LINE = 64;
+
+    // the root is shifted so that the first child of every node starts a
+    // group of Arity elements aligned to the cache line
+    static constexpr size_t __OFFSET = __CACHE_LINE % (Arity * sizeof(T)) == 0 ? Arity - 1 : 0;
 
     comp _comp;
 
     size_t _maxSize = 0;
     size_t _size = 0;
+    T *_base = nullptr;
     T *_data = nullptr;
 
     template <typename X>
@@ -98,19 +188,68 @@ private:
         }
     };
 
+    static T * _allocateStorage(size_t maxSize) {
+        return static_cast<T *>(Allocator<T>::allocate(maxSize + __OFFSET, __CACHE_LINE));
+    }
+
+    static void _releaseStorage(T *base, size_t maxSize) {
+        Allocator<T>::release(base, maxSize + __OFFSET);
+    }
+
+    void _resize(size_t maxSize) {
+        T *base = _allocateStorage(maxSize);
+        if (_base != nullptr) {
+            memcpy((void *) (base + __OFFSET), (void *) _data, _size * sizeof(T));
+            _releaseStorage(_base, _maxSize);
+        }
+        _maxSize = maxSize;
+        _base = base;
+        _data = base + __OFFSET;
+    }
+
     void _expand() {
         if (_size == _maxSize) {
-            _maxSize = _maxSize >= LINEAR_INCREMENT_THRESHOLD
-                ? _maxSize + LINEAR_INCREMENT_THRESHOLD
-                : _maxSize * 2;
-            _data = (T *) realloc((void *) _data, _maxSize * sizeof(T));
+            _resize(
+                _maxSize >= LINEAR_INCREMENT_THRESHOLD
+                    ? _maxSize + LINEAR_INCREMENT_THRESHOLD
+                    : _maxSize * 2
+            );
         }
     }
 
     void _shrink() {
         if (_size <= _maxSize / 2 && _maxSize > INITIAL_SIZE) {
-            _maxSize = _maxSize / 2;
-            _data = (T *) realloc((void *) _data, _maxSize * sizeof(T));
+            _resize(_maxSize / 2);
+        }
+    }
+
+    void _shrinkToFit() {
+        size_t maxSize = _maxSize;
+        while (_size <= maxSize / 2 && maxSize > INITIAL_SIZE) maxSize /= 2;
+        if (maxSize != _maxSize) _resize(maxSize);
+    }
+
+    // removes the top element, which must have been moved out already
+    void _removeTop() {
+        --_size;
+        if (_size > 0) {
+            _data[0] = std::move(_data[_size]);
+            __Heap::siftDown<Arity>(_data, _size, 0, _comp, __Heap::NoTracking());
+        }
+        _data[_size].~T();
+    }
+
+    void _restore(size_t first) {
+        // rebuilding is linear in the heap size, while sifting up each new
+        // element costs up to log(size) for each of them
+        size_t added = _size - first;
+        if (added > first / 8) {
+            __Heap::heapify<Arity>(_data, _size, _comp, __Heap::NoTracking());
+        }
+        else {
+            for (size_t i = first; i < _size; ++i) {
+                __Heap::siftUp<Arity>(_data, i, _comp, __Heap::NoTracking());
+            }
         }
     }
 
@@ -122,28 +261,31 @@ private:
                 : _maxSize * 2;
         }
         _size = 0;
-        _data = (T *) malloc(_maxSize * sizeof(T));
+        _base = _allocateStorage(_maxSize);
+        _data = _base + __OFFSET;
     }
 
     void _invalidate() {
         _maxSize = 0;
         _size = 0;
+        _base = nullptr;
         _data = nullptr;
     }
 
     void _free() {
-        if (_data != nullptr) {
+        if (_base != nullptr) {
             for (size_t i = 0; i < _size; ++i) {
                 _data[i].~T();
             }
-            free(_data);
+            _releaseStorage(_base, _maxSize);
         }
     }
 
     void _copy(const Heap &rhs) {
         _maxSize = rhs._maxSize;
         _size = rhs._size;
-        _data = (T *) malloc(_maxSize * sizeof(T));
+        _base = _allocateStorage(_maxSize);
+        _data = _base + __OFFSET;
         for (size_t i = 0; i < _size; ++i) {
             new (_data + i) T(rhs._data[i]);
         }
@@ -152,6 +294,7 @@ private:
     void _move(Heap &rhs) {
         _maxSize = rhs._maxSize;
         _size = rhs._size;
+        _base = rhs._base;
         _data = rhs._data;
     }
 
@@ -162,7 +305,7 @@ private:
             new (_data + _size) T(*it);
             ++_size;
         }
-        std::make_heap(_data, _data + _size, _comp);
+        __Heap::heapify<Arity>(_data, _size, _comp, __Heap::NoTracking());
     }
 
     template <typename Begin, typename End>
@@ -172,7 +315,7 @@ private:
             new (_data + _size) T(std::move(*it));
             ++_size;
         }
-        std::make_heap(_data, _data + _size, _comp);
+        __Heap::heapify<Arity>(_data, _size, _comp, __Heap::NoTracking());
     }
 
     template <
@@ -252,6 +395,28 @@ private:
         );
     }
 
+    /**
+     * @brief Splits the element array into n ranges of nearly equal length,
+     * for traversing the heap in parallel.
+     *
+     * @return n + 1 iterators, where partition p spans [bounds[p], bounds[p + 1]).
+     */
+    template <typename X>
+    std::vector<HeapIterator<X>> _partition(X *data, size_t n) const {
+        std::vector<HeapIterator<X>> bounds;
+        bounds.reserve(n + 1);
+        for (size_t p = 0; p <= n; ++p) bounds.emplace_back(data + _size / n * p + std::min(p, _size % n));
+        return bounds;
+    }
+
+    std::vector<HeapIterator<const T>> _partition(size_t n) const {
+        return _partition<const T>(_data, n);
+    }
+
+    std::vector<HeapIterator<T>> _partition(size_t n) {
+        return _partition<T>(_data, n);
+    }
+
 public:
 
     using Iterator = HeapIterator<T>;
@@ -294,7 +459,7 @@ public:
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_base_of<Heap<T, comp>, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_base_of<Heap, typename std::decay<Sequence>::type>::value, int>::type = 0
     >
     Heap(const Sequence &seq) {
         _allocate(seq.size());
@@ -302,13 +467,15 @@ public:
     }
 
     /**
-     * @brief Construct a new Heap object.
+     * @brief Construct a new Heap object. The elements are moved out of the
+     * container and arranged into a heap in linear time.
      * 
      * @param seq An iterable container of type T objects.
      */
     template <
         typename Sequence,
-        typename std::enable_if<! std::is_base_of<Heap<T, comp>, Sequence>::value, int>::type = 0
+        typename std::enable_if<! std::is_base_of<Heap, typename std::decay<Sequence>::type>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
     >
     Heap(Sequence &&seq) {
         _allocate(seq.size());
@@ -351,8 +518,8 @@ public:
      * @return A new Heap object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static Heap<typename It::value_type> create(const It &begin, const EndIt &end) {
-        return Heap<typename It::value_type>(begin, end);
+    static Heap<typename It::value_type, comp, Arity, Allocator> create(const It &begin, const EndIt &end) {
+        return Heap<typename It::value_type, comp, Arity, Allocator>(begin, end);
     }
 
     /**
@@ -367,8 +534,8 @@ public:
      * @return A new Heap object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static Heap<typename It::value_type> create(const It &begin, const EndIt &end, size_t size) {
-        return Heap<typename It::value_type>(begin, end, size);
+    static Heap<typename It::value_type, comp, Arity, Allocator> create(const It &begin, const EndIt &end, size_t size) {
+        return Heap<typename It::value_type, comp, Arity, Allocator>(begin, end, size);
     }
 
     ~Heap() {
@@ -487,7 +654,7 @@ public:
         _expand();
         new (_data + _size) T(elem);
         ++_size;
-        std::push_heap(_data, _data + _size, _comp);
+        __Heap::siftUp<Arity>(_data, _size - 1, _comp, __Heap::NoTracking());
         return *this;
     }
 
@@ -501,7 +668,7 @@ public:
         _expand();
         new (_data + _size) T(std::move(elem));
         ++_size;
-        std::push_heap(_data, _data + _size, _comp);
+        __Heap::siftUp<Arity>(_data, _size - 1, _comp, __Heap::NoTracking());
         return *this;
     }
 
@@ -525,16 +692,53 @@ public:
         return push(std::move(elem));
     }
 
+    /**
+     * @brief Pushes all elements in a range onto the heap. Large batches are
+     * appended and the heap is rebuilt in linear time.
+     * 
+     * @param[in] begin A beginning iterator over type T objects.
+     * @param[in] end An end iterator over type T objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    Heap & pushAll(const Begin &begin, const End &end) {
+        size_t first = _size;
+        for (auto it = begin; it != end; ++it) {
+            _expand();
+            new (_data + _size) T(*it);
+            ++_size;
+        }
+        _restore(first);
+        return *this;
+    }
+
+    /**
+     * @brief Pops up to k top elements from the heap, in heap order.
+     * 
+     * @param[in] k The maximum number of elements to pop.
+     * @param[out] out An output iterator receiving the popped elements.
+     * @return The number of elements popped.
+     */
+    template <typename OutputIt>
+    size_t popN(size_t k, OutputIt out) {
+        if (k > _size) k = _size;
+        for (size_t i = 0; i < k; ++i) {
+            *out = std::move(_data[0]);
+            ++out;
+            _removeTop();
+        }
+        _shrinkToFit();
+        return k;
+    }
+
     /**
      * @brief Pops the top element from the heap and returns it.
      * 
      * @return The removed top element from the heap.
      */
     T pop() {
-        std::pop_heap(_data, _data + _size, _comp);
-        --_size;
-        T elem = std::move(_data[_size]);
-        _data[_size].~T();
+        T elem = std::move(_data[0]);
+        _removeTop();
         _shrink();
         return elem;
     }
@@ -562,4 +766,548 @@ public:
     }
 };
 
+/**
+ * @brief A heap whose elements can be changed or removed after insertion
+ * through the handles returned by push(). This avoids pushing duplicate
+ * entries and filtering stale ones at pop() for workloads that update
+ * priorities, e.g. Dijkstra-style searches.
+ *
+ * @tparam T The type of heap elements.
+ * @tparam comp The comparator functor used to sort the heap. The default
+ * functor is std::less<T>, i.e. a max heap.
+ * @tparam Arity The number of children of each heap node. (default = 4)
+ */
+template <typename T, typename comp = std::less<T>, size_t Arity = 4>
+class AddressableHeap {
+
+    static_assert(Arity >= 2, "Heap arity must be at least 2");
+
+public:
+
+    /**
+     * @brief An opaque reference to an element in the heap. A handle becomes
+     * invalid once its element is popped or erased, and may then be reused
+     * for a newly pushed element.
+     */
+    using Handle = size_t;
+
+private:
+
+    static constexpr size_t __NONE = (size_t) -1;
+
+    struct Entry {
+        T value;
+        Handle handle;
+    };
+
+    struct EntryComp {
+        comp c;
+
+        bool operator()(const Entry &a, const Entry &b) {
+            return c(a.value, b.value);
+        }
+    };
+
+    struct Tracker {
+        AddressableHeap *heap;
+
+        void operator()(size_t pos) const {
+            heap->_pos[heap->_entries[pos].handle] = pos;
+        }
+    };
+
+    EntryComp _comp;
+    std::vector<Entry> _entries;
+    std::vector<size_t> _pos;           // indexed by handle
+    std::vector<Handle> _freeHandles;
+
+    template <typename U>
+    Handle _push(U &&elem) {
+        Handle h;
+        if (_freeHandles.empty()) {
+            h = _pos.size();
+            _pos.push_back((size_t) __NONE);
+        }
+        else {
+            h = _freeHandles.back();
+            _freeHandles.pop_back();
+        }
+
+        _entries.push_back(Entry { std::forward<U>(elem), h });
+        __Heap::siftUp<Arity>(_entries.data(), _entries.size() - 1, _comp, Tracker { this });
+        return h;
+    }
+
+    void _fix(size_t pos) {
+        if (pos > 0 && _comp(_entries[(pos - 1) / Arity], _entries[pos])) {
+            __Heap::siftUp<Arity>(_entries.data(), pos, _comp, Tracker { this });
+        }
+        else {
+            __Heap::siftDown<Arity>(_entries.data(), _entries.size(), pos, _comp, Tracker { this });
+        }
+    }
+
+    T _removeAt(size_t pos) {
+        Handle h = _entries[pos].handle;
+        T elem = std::move(_entries[pos].value);
+
+        size_t last = _entries.size() - 1;
+        if (pos != last) {
+            _entries[pos] = std::move(_entries[last]);
+            _pos[_entries[pos].handle] = pos;
+        }
+        _entries.pop_back();
+        if (pos != last) _fix(pos);
+
+        _pos[h] = __NONE;
+        _freeHandles.push_back(h);
+        return elem;
+    }
+
+    size_t _position(Handle h) const {
+        if (! contains(h)) throw OutOfRangeError("Invalid heap handle");
+        return _pos[h];
+    }
+
+public:
+
+    /**
+     * @brief Construct a new AddressableHeap object.
+     *
+     * @param initialSize The number of elements to reserve space for.
+     * (default = 64)
+     */
+    AddressableHeap(size_t initialSize = 64) {
+        _entries.reserve(initialSize);
+        _pos.reserve(initialSize);
+    }
+
+    /**
+     * @return The size of this container.
+     */
+    size_t size() const {
+        return _entries.size();
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return _entries.empty();
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return ! _entries.empty();
+    }
+
+    /**
+     * @param h A handle.
+     * @return A boolean indicating whether h refers to an element in the heap.
+     */
+    bool contains(Handle h) const {
+        return h < _pos.size() && _pos[h] != __NONE;
+    }
+
+    /**
+     * @return A constant reference to the top element of this heap.
+     */
+    const T & top() const {
+        return _entries.front().value;
+    }
+
+    /**
+     * @return The handle of the top element of this heap.
+     */
+    Handle topHandle() const {
+        return _entries.front().handle;
+    }
+
+    /**
+     * @param h A handle.
+     * @throws OutOfRangeError if the handle is invalid.
+     * @return A constant reference to the element referred to by h.
+     */
+    const T & get(Handle h) const {
+        return _entries[_position(h)].value;
+    }
+
+    /**
+     * @brief Pushes an element onto the heap.
+     *
+     * @param[in] elem The element to push.
+     * @return A handle to the pushed element.
+     */
+    Handle push(const T &elem) {
+        return _push(elem);
+    }
+
+    /**
+     * @brief Pushes an element onto the heap.
+     *
+     * @param[in] elem The element to push.
+     * @return A handle to the pushed element.
+     */
+    Handle push(T &&elem) {
+        return _push(std::move(elem));
+    }
+
+    /**
+     * @brief Pops the top element from the heap and returns it.
+     *
+     * @return The removed top element from the heap.
+     */
+    T pop() {
+        return _removeAt(0);
+    }
+
+    /**
+     * @brief Replaces the value of an element and restores the heap order.
+     *
+     * @param h A handle to the element.
+     * @param[in] elem The new value.
+     * @throws OutOfRangeError if the handle is invalid.
+     * @return A reference to this container for chaining.
+     */
+    AddressableHeap & update(Handle h, const T &elem) {
+        size_t pos = _position(h);
+        _entries[pos].value = elem;
+        _fix(pos);
+        return *this;
+    }
+
+    /**
+     * @brief Replaces the value of an element and restores the heap order.
+     *
+     * @param h A handle to the element.
+     * @param[in] elem The new value.
+     * @throws OutOfRangeError if the handle is invalid.
+     * @return A reference to this container for chaining.
+     */
+    AddressableHeap & update(Handle h, T &&elem) {
+        size_t pos = _position(h);
+        _entries[pos].value = std::move(elem);
+        _fix(pos);
+        return *this;
+    }
+
+    /**
+     * @brief Replaces the value of an element with one that does not compare
+     * lower than it, i.e. one that moves the element towards the top. This is
+     * the classic decrease-key operation of a min heap (comp = std::greater),
+     * and is cheaper than update().
+     *
+     * @param h A handle to the element.
+     * @param[in] elem The new value.
+     * @throws OutOfRangeError if the handle is invalid.
+     * @return A reference to this container for chaining.
+     */
+    AddressableHeap & decreaseKey(Handle h, const T &elem) {
+        size_t pos = _position(h);
+        _entries[pos].value = elem;
+        __Heap::siftUp<Arity>(_entries.data(), pos, _comp, Tracker { this });
+        return *this;
+    }
+
+    /**
+     * @brief Removes an element from the heap and returns it.
+     *
+     * @param h A handle to the element.
+     * @throws OutOfRangeError if the handle is invalid.
+     * @return The removed element.
+     */
+    T remove(Handle h) {
+        return _removeAt(_position(h));
+    }
+
+    /**
+     * @brief Removes an element from the heap.
+     *
+     * @param h A handle to the element.
+     * @throws OutOfRangeError if the handle is invalid.
+     * @return A reference to this container for chaining.
+     */
+    AddressableHeap & erase(Handle h) {
+        _removeAt(_position(h));
+        return *this;
+    }
+
+    /**
+     * @brief Erases all elements in this container. All handles become
+     * invalid.
+     *
+     * @return A reference to this container for chaining.
+     */
+    AddressableHeap & clear() {
+        _entries.clear();
+        _pos.clear();
+        _freeHandles.clear();
+        return *this;
+    }
+};
+
+namespace parallel {
+
+/**
+ * @brief A relaxed concurrent priority queue (a MultiQueue). Elements are
+ * spread over several independently locked heaps; push() goes to a random
+ * heap and pop() removes the better top of two randomly chosen heaps, so
+ * threads rarely contend on the same lock. In exchange, pop() is not strictly
+ * ordered: it returns an element close to the top, and with a single thread
+ * and a single heap it returns exactly the top.
+ *
+ * @tparam T The type of heap elements.
+ * @tparam comp The comparator functor used to sort the heap. The default
+ * functor is std::less<T>, i.e. a max heap.
+ */
+template <typename T, typename comp = std::less<T>>
+class RelaxedHeap {
+
+private:
+
+    struct Lane {
+        std::mutex mtx;
+        spl::Heap<T, comp> heap;
+        char pad[64];
+    };
+
+    comp _comp;
+
+    Lane *_lanes;
+    size_t _numLanes;
+    std::atomic_size_t _size;
+
+    static size_t _random() {
+        static thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (size_t) state;
+    }
+
+    // locks a random lane, skipping lanes that are currently held
+    Lane & _lockAny() {
+        while (true) {
+            Lane &l = _lanes[_random() % _numLanes];
+            if (l.mtx.try_lock()) return l;
+        }
+    }
+
+    bool _popFrom(Lane &l, T &elem) {
+        if (l.heap.empty()) return false;
+        elem = l.heap.pop();
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool _tryPop(T &elem) {
+        if (_numLanes > 1) {
+            for (size_t attempt = 0; attempt < _numLanes; ++attempt) {
+                if (_size.load(std::memory_order_relaxed) == 0) return false;
+
+                size_t r = _random();
+                size_t i = r % _numLanes;
+                size_t j = (i + 1 + (r / _numLanes) % (_numLanes - 1)) % _numLanes;
+                Lane &a = _lanes[i];
+                Lane &b = _lanes[j];
+                if (! a.mtx.try_lock()) continue;
+                if (! b.mtx.try_lock()) {
+                    a.mtx.unlock();
+                    continue;
+                }
+
+                Lane *best;
+                if (a.heap.empty()) best = &b;
+                else if (b.heap.empty()) best = &a;
+                else best = _comp(a.heap.top(), b.heap.top()) ? &b : &a;
+
+                bool ok = _popFrom(*best, elem);
+                a.mtx.unlock();
+                b.mtx.unlock();
+                if (ok) return true;
+            }
+        }
+
+        // few elements are left, or the lanes are busy; sweep all of them
+        for (size_t i = 0; i < _numLanes; ++i) {
+            std::lock_guard<std::mutex> lk(_lanes[i].mtx);
+            if (_popFrom(_lanes[i], elem)) return true;
+        }
+        return false;
+    }
+
+public:
+
+    /**
+     * @brief Construct a new RelaxedHeap object.
+     *
+     * @param numLanes The number of internal heaps. More heaps reduce
+     * contention but loosen the ordering of pop(). (default = twice the number
+     * of hardware threads)
+     */
+    RelaxedHeap(size_t numLanes = 0)
+    :   _size(0)
+    {
+        if (numLanes == 0) numLanes = 2 * std::max(1u, std::thread::hardware_concurrency());
+        _numLanes = numLanes;
+        _lanes = new Lane[_numLanes];
+    }
+
+    RelaxedHeap(const RelaxedHeap &) = delete;
+
+    RelaxedHeap(RelaxedHeap &&) = delete;
+
+    ~RelaxedHeap() {
+        delete[] _lanes;
+    }
+
+    RelaxedHeap & operator=(const RelaxedHeap &) = delete;
+
+    RelaxedHeap & operator=(RelaxedHeap &&) = delete;
+
+    /**
+     * @return The size of this container. The value is only a snapshot when
+     * other threads are operating on the heap.
+     */
+    size_t size() const {
+        return _size.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return size() != 0;
+    }
+
+    /**
+     * @brief Pushes an element onto the heap.
+     *
+     * @param[in] elem The element to push.
+     * @return A reference to this container for chaining.
+     */
+    RelaxedHeap & push(const T &elem) {
+        Lane &l = _lockAny();
+        l.heap.push(elem);
+        _size.fetch_add(1, std::memory_order_relaxed);
+        l.mtx.unlock();
+        return *this;
+    }
+
+    /**
+     * @brief Pushes an element onto the heap.
+     *
+     * @param[in] elem The element to push.
+     * @return A reference to this container for chaining.
+     */
+    RelaxedHeap & push(T &&elem) {
+        Lane &l = _lockAny();
+        l.heap.push(std::move(elem));
+        _size.fetch_add(1, std::memory_order_relaxed);
+        l.mtx.unlock();
+        return *this;
+    }
+
+    /**
+     * @brief Pushes an element onto the heap.
+     *
+     * @param[in] elem The element to push.
+     * @return A reference to this container for chaining.
+     */
+    RelaxedHeap & operator<<(const T &elem) {
+        return push(elem);
+    }
+
+    /**
+     * @brief Pushes an element onto the heap.
+     *
+     * @param[in] elem The element to push.
+     * @return A reference to this container for chaining.
+     */
+    RelaxedHeap & operator<<(T &&elem) {
+        return push(std::move(elem));
+    }
+
+    /**
+     * @brief Returns a copy of the top element over all internal heaps. This
+     * locks every heap in turn, so it is exact only if no other thread is
+     * modifying the heap.
+     *
+     * @throws OutOfRangeError if the heap is empty.
+     * @return A copy of the top element.
+     */
+    T top() {
+        bool found = false;
+        T best;
+        for (size_t i = 0; i < _numLanes; ++i) {
+            std::lock_guard<std::mutex> lk(_lanes[i].mtx);
+            if (_lanes[i].heap.empty()) continue;
+            if (! found || _comp(best, _lanes[i].heap.top())) {
+                best = _lanes[i].heap.top();
+                found = true;
+            }
+        }
+        if (! found) throw OutOfRangeError("Attempt to access the top of an empty heap");
+        return best;
+    }
+
+    /**
+     * @brief Pops an element close to the top of the heap and returns it.
+     *
+     * @throws OutOfRangeError if the heap is empty.
+     * @return The removed element.
+     */
+    T pop() {
+        T elem;
+        if (! _tryPop(elem)) throw OutOfRangeError("Attempt to pop from an empty heap");
+        return elem;
+    }
+
+    /**
+     * @brief Pops an element close to the top of the heap and returns it.
+     *
+     * @param[out] elem A reference to an element.
+     * @throws OutOfRangeError if the heap is empty.
+     * @return A reference to this container for chaining.
+     */
+    RelaxedHeap & pop(T &elem) {
+        if (! _tryPop(elem)) throw OutOfRangeError("Attempt to pop from an empty heap");
+        return *this;
+    }
+
+    /**
+     * @brief Pops an element close to the top of the heap and returns it.
+     *
+     * @param[out] elem A reference to an element.
+     * @throws OutOfRangeError if the heap is empty.
+     * @return A reference to this container for chaining.
+     */
+    RelaxedHeap & operator>>(T &elem) {
+        return pop(elem);
+    }
+
+    /**
+     * @brief Attempts to pop an element close to the top of the heap or
+     * returns immediately if the heap is empty.
+     *
+     * @param[out] elem A reference to an element. It is left untouched if the
+     * heap is empty.
+     * @return True if an element was popped, false if the heap is empty.
+     */
+    bool tryPop(T &elem) {
+        return _tryPop(elem);
+    }
+};
+
+}   // namespace parallel
+
 }
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <ostream>
+#include <traits.h>
+
+namespace spl {
+
+namespace core {
+
+struct InternedEntry {
+    size_t hash;
+    size_t length;
+    char str[1];    // null-terminated, length + 1 bytes
+};
+
+} // namespace core
+
+/**
+ * @brief An immutable string that is stored once per distinct contents in a
+ * process-wide intern table. Interning hashes the contents a single time;
+ * afterwards hash() returns the stored hash code and equality compares
+ * pointers, so repeated lookups with an interned key in a HashMap or HashSet
+ * do neither hashing nor string comparison.
+ *
+ * The hash code equals Hash<std::string> of the same contents. Interned
+ * strings are never freed, so intern names and keys, not arbitrary data.
+ * Interning is thread-safe, and costs a hash and a table lookup; keys used
+ * repeatedly are best interned once, e.g. as static constants.
+ */
+class InternedString : public Hashable {
+
+private:
+
+    const core::InternedEntry *_entry;
+
+    static const core::InternedEntry * _intern(const char *str, size_t len);
+
+public:
+
+    /**
+     * @brief Construct a new InternedString object holding the empty string.
+     */
+    InternedString()
+    :   InternedString("", 0)
+    { }
+
+    /**
+     * @brief Construct a new InternedString object.
+     *
+     * @param str Pointer to a null-terminated string.
+     */
+    InternedString(const char *str)
+    :   InternedString(str, strlen(str))
+    { }
+
+    /**
+     * @brief Construct a new InternedString object.
+     *
+     * @param str Pointer to the characters of the string.
+     * @param len The number of characters.
+     */
+    InternedString(const char *str, size_t len)
+    :   _entry(_intern(str, len))
+    { }
+
+    /**
+     * @brief Construct a new InternedString object.
+     *
+     * @param str The string to intern.
+     */
+    InternedString(const std::string &str)
+    :   InternedString(str.data(), str.size())
+    { }
+
+    /**
+     * @brief Returns the precomputed hash code of the string.
+     */
+    size_t hash() const {
+        return _entry->hash;
+    }
+
+    /**
+     * @brief Returns a pointer to the null-terminated contents, valid for the
+     * lifetime of the process.
+     */
+    const char * c_str() const {
+        return _entry->str;
+    }
+
+    /**
+     * @brief Returns the number of characters in the string.
+     */
+    size_t size() const {
+        return _entry->length;
+    }
+
+    /**
+     * @brief Checks whether the string is empty.
+     */
+    bool empty() const {
+        return _entry->length == 0;
+    }
+
+    /**
+     * @brief Returns a copy of the contents as a std::string.
+     */
+    std::string str() const {
+        return std::string(_entry->str, _entry->length);
+    }
+
+    bool operator==(const InternedString &rhs) const {
+        return _entry == rhs._entry;
+    }
+
+    bool operator!=(const InternedString &rhs) const {
+        return _entry != rhs._entry;
+    }
+
+    /**
+     * @brief Returns the number of distinct strings interned so far,
+     * including the empty string.
+     */
+    static size_t count();
+};
+
+inline std::ostream & operator<<(std::ostream &os, const InternedString &s) {
+    return os.write(s.c_str(), s.size());
+}
+
+} // namespace spl
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstdlib>
+#include <stdint.h>
+#include <sys/types.h>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace spl {
+
+/**
+ * @brief The outcome of an asynchronous I/O operation.
+ */
+struct IOCompletion {
+
+    /**
+     * @brief The tag given when the operation was submitted.
+     */
+    uint64_t tag;
+
+    /**
+     * @brief The number of bytes transferred for reads and writes, 0 for
+     * other successful operations, or a negated errno value on failure.
+     */
+    ssize_t result;
+};
+
+/**
+ * @brief A queue of asynchronous file operations backed by an io_uring
+ * instance. Operations are prepared in a submission queue, sent to the kernel
+ * in batches by submit(), and their completions are collected with poll() or
+ * wait(). Each operation carries a caller-defined tag that is returned with
+ * its completion; completions may arrive in any order.
+ *
+ * If io_uring is not available, or synchronous mode is requested, operations
+ * are executed in order by submit() and their completions are returned in the
+ * same way.
+ *
+ * An IORing is not thread-safe; local() provides an instance per thread.
+ */
+class IORing {
+
+private:
+
+    static constexpr unsigned __DEFAULT_ENTRIES = 256;
+
+    struct Operation {
+        uint8_t opcode;
+        int fd;
+        off_t offset;
+        void *buf;
+        size_t len;
+        int flags;
+        uint64_t tag;
+    };
+
+    int _fd = -1;
+    unsigned _entries = 0;
+    unsigned _cqEntries = 0;
+
+    void *_sqRing = nullptr;
+    size_t _sqRingSize = 0;
+    void *_cqRing = nullptr;
+    size_t _cqRingSize = 0;
+    io_uring_sqe *_sqes = nullptr;
+    size_t _sqesSize = 0;
+
+    unsigned *_sqHead = nullptr;
+    unsigned *_sqTail = nullptr;
+    unsigned _sqMask = 0;
+    unsigned *_sqArray = nullptr;
+    unsigned *_cqHead = nullptr;
+    unsigned *_cqTail = nullptr;
+    unsigned _cqMask = 0;
+    io_uring_cqe *_cqes = nullptr;
+
+    unsigned _queued = 0;       // prepared but not yet submitted
+    size_t _inFlight = 0;       // submitted but not yet reaped
+    std::vector<IOCompletion> _completed;   // reaped but not yet returned
+    std::vector<Operation> _deferred;       // synchronous mode only
+
+    void _setup(unsigned entries);
+
+    void _release();
+
+    void _enqueue(const Operation &op);
+
+    unsigned _enter(unsigned submit, unsigned minComplete);
+
+    void _reap();
+
+    size_t _take(IOCompletion *out, size_t maxCount);
+
+public:
+
+    /**
+     * @brief Construct a new IORing object.
+     *
+     * @param entries The size of the submission queue (default = 256).
+     * @param synchronous If true, operations are executed synchronously by
+     * submit() even if io_uring is available (default = false).
+     */
+    IORing(unsigned entries = __DEFAULT_ENTRIES, bool synchronous = false);
+
+    IORing(const IORing &) = delete;
+
+    IORing(IORing &&) = delete;
+
+    ~IORing();
+
+    IORing & operator=(const IORing &) = delete;
+
+    IORing & operator=(IORing &&) = delete;
+
+    /**
+     * @return True if operations are executed asynchronously by io_uring,
+     * false if they are executed synchronously by submit().
+     */
+    bool asynchronous() const {
+        return _fd != -1;
+    }
+
+    /**
+     * @brief Queues a read of len bytes at the given offset.
+     *
+     * @param fd The file descriptor.
+     * @param offset The offset in the file.
+     * @param buf The destination buffer, which must remain valid until the
+     * operation completes.
+     * @param len The number of bytes to read.
+     * @param tag A value returned with the completion.
+     * @return A reference to this object for chaining.
+     */
+    IORing & read(int fd, off_t offset, void *buf, size_t len, uint64_t tag);
+
+    /**
+     * @brief Queues a write of len bytes at the given offset.
+     *
+     * @param fd The file descriptor.
+     * @param offset The offset in the file.
+     * @param buf The source buffer, which must remain valid and unmodified
+     * until the operation completes.
+     * @param len The number of bytes to write.
+     * @param tag A value returned with the completion.
+     * @return A reference to this object for chaining.
+     */
+    IORing & write(int fd, off_t offset, const void *buf, size_t len, uint64_t tag);
+
+    /**
+     * @brief Queues a synchronization of the file with its storage device.
+     * Note that operations are not ordered; a sync only covers writes that
+     * completed before it was submitted.
+     *
+     * @param fd The file descriptor.
+     * @param dataOnly If true, only data and the metadata required to
+     * retrieve it are synchronized (fdatasync).
+     * @param tag A value returned with the completion.
+     * @return A reference to this object for chaining.
+     */
+    IORing & sync(int fd, bool dataOnly, uint64_t tag);
+
+    /**
+     * @brief Queues a space allocation or deallocation (see fallocate(2)).
+     *
+     * @param fd The file descriptor.
+     * @param mode The fallocate mode flags.
+     * @param offset Offset of the region.
+     * @param len Length of the region.
+     * @param tag A value returned with the completion.
+     * @return A reference to this object for chaining.
+     */
+    IORing & allocate(int fd, int mode, off_t offset, off_t len, uint64_t tag);
+
+    /**
+     * @brief Submits all queued operations with a single system call.
+     *
+     * @return The number of operations submitted.
+     */
+    size_t submit();
+
+    /**
+     * @brief Retrieves available completions without blocking.
+     *
+     * @param out An array receiving the completions.
+     * @param maxCount The capacity of the array.
+     * @return The number of completions retrieved.
+     */
+    size_t poll(IOCompletion *out, size_t maxCount);
+
+    /**
+     * @brief Submits all queued operations and blocks until at least minCount
+     * completions are available, or no more operations are outstanding.
+     *
+     * @param out An array receiving the completions.
+     * @param maxCount The capacity of the array.
+     * @param minCount The number of completions to wait for (default = 1).
+     * @return The number of completions retrieved.
+     */
+    size_t wait(IOCompletion *out, size_t maxCount, size_t minCount = 1);
+
+    /**
+     * @return The number of operations whose completions have not yet been
+     * retrieved.
+     */
+    size_t pending() const {
+        return _queued + _inFlight + _completed.size() + _deferred.size();
+    }
+
+    /**
+     * @return The IORing of the calling thread, created on first use. Threads
+     * of a ThreadPool each get their own instance.
+     */
+    static IORing & local();
+};
+
+}
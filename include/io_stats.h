@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <latency_histogram.h>
+
+namespace spl {
+
+/**
+ * @brief The I/O paths accounted by IOStats.
+ */
+enum class IOPath : int {
+    FILE_READ,          // File::read
+    FILE_WRITE,         // File::write
+    TCP_SEND,           // TCPSocket sends
+    TCP_RECV,           // TCPSocket receives
+    SERIALIZER_FLUSH,   // output serializers writing out their buffer
+    SERIALIZER_FILL,    // input serializers refilling their buffer
+};
+
+/**
+ * @brief The accounting of one I/O path, summed over all threads.
+ */
+struct IOPathStats {
+    uint64_t operations = 0;    // calls to the path, e.g. one File::write
+    uint64_t bytes = 0;
+    uint64_t syscalls = 0;
+    uint64_t partial = 0;       // syscalls that moved fewer bytes than asked for
+    uint64_t retries = 0;       // syscalls repeated after EINTR, EAGAIN or ENOBUFS
+    uint64_t waits = 0;         // times the caller blocked waiting for readiness
+    uint64_t blockedNanos = 0;  // spent in those waits
+    uint64_t backoffs = 0;      // send chunk size reductions after EMSGSIZE
+    LatencyHistogram latency;   // of whole operations
+
+    /**
+     * @brief Adds the accounting of another path or thread to this one.
+     */
+    void merge(const IOPathStats &rhs) {
+        operations += rhs.operations;
+        bytes += rhs.bytes;
+        syscalls += rhs.syscalls;
+        partial += rhs.partial;
+        retries += rhs.retries;
+        waits += rhs.waits;
+        blockedNanos += rhs.blockedNanos;
+        backoffs += rhs.backoffs;
+        latency.merge(rhs.latency);
+    }
+};
+
+namespace core {
+
+/**
+ * @brief The counters of one I/O path of one thread. Only the owning thread
+ * writes them, so recording takes no atomic read-modify-write instructions.
+ */
+struct IOPathCounters {
+    std::atomic<uint64_t> operations { 0 };
+    std::atomic<uint64_t> bytes { 0 };
+    std::atomic<uint64_t> syscalls { 0 };
+    std::atomic<uint64_t> partial { 0 };
+    std::atomic<uint64_t> retries { 0 };
+    std::atomic<uint64_t> waits { 0 };
+    std::atomic<uint64_t> blockedNanos { 0 };
+    std::atomic<uint64_t> backoffs { 0 };
+    AtomicLatencyHistogram latency;
+
+    static void add(std::atomic<uint64_t> &a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void snapshot(IOPathStats &s) const;
+};
+
+} // namespace core
+
+/**
+ * @brief Process-wide accounting of file, socket and serializer I/O: bytes,
+ * syscalls, partial transfers, retries, time blocked waiting for readiness,
+ * and the latency of whole operations, per IOPath.
+ *
+ * Accounting is off until enabled with setEnabled(true); while off, an
+ * instrumented operation costs a single relaxed load. While on, each thread
+ * records into its own cache-line aligned counters, which are read by
+ * snapshot() and dump() and folded into process totals when the thread
+ * exits.
+ */
+class IOStats {
+
+private:
+
+    static std::atomic_bool _enabled;
+
+    static core::IOPathCounters * _local(IOPath path);
+
+public:
+
+    static constexpr size_t PATHS = 6;
+
+    /**
+     * @brief The accounting of all paths at some point in time.
+     */
+    struct Snapshot {
+        IOPathStats paths[PATHS];
+
+        const IOPathStats & operator[](IOPath path) const {
+            return paths[(int) path];
+        }
+    };
+
+    /**
+     * @brief Accounts a single operation on an I/O path, from construction to
+     * destruction. Does nothing if accounting was disabled at construction.
+     */
+    class Op {
+
+    private:
+
+        core::IOPathCounters *_c = nullptr;
+        uint64_t _start = 0;
+
+    public:
+
+        Op(IOPath path) {
+            if (IOStats::enabled()) {
+                _c = _local(path);
+                _start = IOStats::now();
+            }
+        }
+
+        Op(const Op &) = delete;
+
+        ~Op() {
+            if (_c == nullptr) return;
+            core::IOPathCounters::add(_c->operations, 1);
+            _c->latency.record(IOStats::now() - _start);
+        }
+
+        Op & operator=(const Op &) = delete;
+
+        /**
+         * @return A boolean indicating whether this operation is accounted,
+         * to skip computing what is only needed for accounting.
+         */
+        bool active() const {
+            return _c != nullptr;
+        }
+
+        /**
+         * @brief Records a syscall asked to move some bytes.
+         *
+         * @param requested The number of bytes asked for.
+         * @param moved The number of bytes moved, or -1 on failure.
+         */
+        void syscall(size_t requested, ssize_t moved) {
+            if (_c == nullptr) return;
+            core::IOPathCounters::add(_c->syscalls, 1);
+            if (moved > 0) core::IOPathCounters::add(_c->bytes, moved);
+            if (moved >= 0 && (size_t) moved < requested) core::IOPathCounters::add(_c->partial, 1);
+        }
+
+        /**
+         * @brief Records bytes moved without a syscall of this path, e.g. by
+         * a serializer through its stream.
+         */
+        void bytes(size_t n) {
+            if (_c == nullptr) return;
+            core::IOPathCounters::add(_c->bytes, n);
+        }
+
+        /**
+         * @brief Records a syscall about to be repeated.
+         */
+        void retry() {
+            if (_c == nullptr) return;
+            core::IOPathCounters::add(_c->retries, 1);
+        }
+
+        /**
+         * @brief Records a send chunk size reduction.
+         */
+        void backoff() {
+            if (_c == nullptr) return;
+            core::IOPathCounters::add(_c->backoffs, 1);
+        }
+
+        /**
+         * @return The time a wait for readiness begins, to pass to blocked().
+         */
+        uint64_t waitBegin() const {
+            return _c == nullptr ? 0 : IOStats::now();
+        }
+
+        /**
+         * @brief Records a wait for readiness that began at some time.
+         */
+        void blocked(uint64_t since) {
+            if (_c == nullptr) return;
+            core::IOPathCounters::add(_c->waits, 1);
+            core::IOPathCounters::add(_c->blockedNanos, IOStats::now() - since);
+        }
+    };
+
+    /**
+     * @return A boolean indicating whether I/O is being accounted.
+     */
+    static bool enabled() {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Enables or disables accounting I/O. Counts recorded so far are
+     * kept. (default = disabled)
+     */
+    static void setEnabled(bool enabled) {
+        _enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    /**
+     * @return The name of an I/O path, e.g. "tcp-send".
+     */
+    static const char * name(IOPath path);
+
+    /**
+     * @return The accounting of all threads, live and exited.
+     */
+    static Snapshot snapshot();
+
+    /**
+     * @brief Dumps the accounting of all threads as a JSON object keyed by
+     * path name, with the latency percentiles of each path, for monitoring
+     * agents.
+     */
+    static std::string dump();
+};
+
+} // namespace spl
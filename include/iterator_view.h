@@ -7,6 +7,8 @@
 
 #include <iterator>
 #include <type_traits>
+#include <utility>
+#include <cstddef>
 
 namespace spl {
 
@@ -211,4 +213,469 @@ public:
     }
 };
 
+/**
+ * @brief An iterator adapter that skips the elements of an underlying
+ * iterator for which a predicate does not hold.
+ *
+ * @tparam IteratorType The underlying iterator type.
+ * @tparam Predicate The predicate functor type.
+ */
+template <typename IteratorType, typename Predicate>
+class FilterIterator
+:   public std::iterator<
+        std::forward_iterator_tag,
+        typename std::iterator_traits<IteratorType>::value_type,
+        typename std::iterator_traits<IteratorType>::difference_type,
+        typename std::iterator_traits<IteratorType>::pointer,
+        typename std::iterator_traits<IteratorType>::reference
+    >
+{
+private:
+    IteratorType _it;
+    IteratorType _end;
+    Predicate _f;
+
+    void _skip() {
+        while (_it != _end && ! _f(*_it)) ++_it;
+    }
+
+public:
+
+    using reference = typename std::iterator_traits<IteratorType>::reference;
+
+    /**
+     * @brief Construct a new FilterIterator object positioned at the first
+     * element at or after `it` that satisfies the predicate.
+     *
+     * @param[in] it The underlying iterator.
+     * @param[in] end The underlying past-the-end iterator.
+     * @param[in] f The predicate.
+     */
+    FilterIterator(const IteratorType &it, const IteratorType &end, const Predicate &f)
+    :   _it(it),
+        _end(end),
+        _f(f)
+    {
+        _skip();
+    }
+
+    bool operator==(const FilterIterator &rhs) const { return _it == rhs._it; }
+    bool operator!=(const FilterIterator &rhs) const { return _it != rhs._it; }
+
+    reference operator*() {
+        return *_it;
+    }
+
+    FilterIterator & operator++() {
+        ++_it;
+        _skip();
+        return *this;
+    }
+
+    FilterIterator operator++(int) {
+        FilterIterator current = *this;
+        operator++();
+        return current;
+    }
+};
+
+/**
+ * @brief An iterator adapter that ends after a fixed number of elements of an
+ * underlying iterator, or at its end, whichever comes first.
+ *
+ * @tparam IteratorType The underlying iterator type.
+ */
+template <typename IteratorType>
+class TakeIterator
+:   public std::iterator<
+        std::forward_iterator_tag,
+        typename std::iterator_traits<IteratorType>::value_type,
+        typename std::iterator_traits<IteratorType>::difference_type,
+        typename std::iterator_traits<IteratorType>::pointer,
+        typename std::iterator_traits<IteratorType>::reference
+    >
+{
+private:
+    IteratorType _it;
+    IteratorType _end;
+    size_t _n;
+
+    bool _exhausted() const {
+        return _n == 0 || _it == _end;
+    }
+
+public:
+
+    using reference = typename std::iterator_traits<IteratorType>::reference;
+
+    /**
+     * @brief Construct a new TakeIterator object.
+     *
+     * @param[in] it The underlying iterator.
+     * @param[in] end The underlying past-the-end iterator.
+     * @param[in] n The number of elements left to take.
+     */
+    TakeIterator(const IteratorType &it, const IteratorType &end, size_t n)
+    :   _it(it),
+        _end(end),
+        _n(n)
+    { }
+
+    bool operator==(const TakeIterator &rhs) const {
+        bool e = _exhausted();
+        return e == rhs._exhausted() && (e || _n == rhs._n);
+    }
+    bool operator!=(const TakeIterator &rhs) const {
+        return ! operator==(rhs);
+    }
+
+    reference operator*() {
+        return *_it;
+    }
+
+    TakeIterator & operator++() {
+        ++_it;
+        --_n;
+        return *this;
+    }
+
+    TakeIterator operator++(int) {
+        TakeIterator current = *this;
+        operator++();
+        return current;
+    }
+};
+
+/**
+ * @brief An iterator adapter that walks two underlying iterators in lockstep,
+ * yielding pairs of their elements, and ends as soon as either one ends.
+ *
+ * @tparam First The first underlying iterator type.
+ * @tparam Second The second underlying iterator type.
+ */
+template <typename First, typename Second>
+class ZipIterator
+:   public std::iterator<
+        std::forward_iterator_tag,
+        std::pair<
+            typename std::iterator_traits<First>::reference,
+            typename std::iterator_traits<Second>::reference
+        >,
+        ptrdiff_t,
+        void,
+        std::pair<
+            typename std::iterator_traits<First>::reference,
+            typename std::iterator_traits<Second>::reference
+        >
+    >
+{
+private:
+    First _first;
+    Second _second;
+
+public:
+
+    using value_type = std::pair<
+        typename std::iterator_traits<First>::reference,
+        typename std::iterator_traits<Second>::reference
+    >;
+    using reference = value_type;
+
+    /**
+     * @brief Construct a new ZipIterator object.
+     *
+     * @param[in] first The first underlying iterator.
+     * @param[in] second The second underlying iterator.
+     */
+    ZipIterator(const First &first, const Second &second)
+    :   _first(first),
+        _second(second)
+    { }
+
+    // either side reaching its end ends the zip
+    bool operator==(const ZipIterator &rhs) const {
+        return _first == rhs._first || _second == rhs._second;
+    }
+    bool operator!=(const ZipIterator &rhs) const {
+        return ! operator==(rhs);
+    }
+
+    reference operator*() {
+        return reference(*_first, *_second);
+    }
+
+    ZipIterator & operator++() {
+        ++_first;
+        ++_second;
+        return *this;
+    }
+
+    ZipIterator operator++(int) {
+        ZipIterator current = *this;
+        operator++();
+        return current;
+    }
+};
+
+template <typename Begin, typename End>
+class IterableView;
+
+/**
+ * @brief An iterator adapter that groups the elements of an underlying
+ * iterator into consecutive views of a fixed length. The last view may be
+ * shorter.
+ *
+ * @tparam IteratorType The underlying iterator type.
+ */
+template <typename IteratorType>
+class ChunkIterator
+:   public std::iterator<
+        std::forward_iterator_tag,
+        IterableView<IteratorType, IteratorType>,
+        ptrdiff_t,
+        void,
+        IterableView<IteratorType, IteratorType>
+    >
+{
+private:
+    IteratorType _it;
+    IteratorType _next;
+    IteratorType _end;
+    size_t _n;
+
+    void _advance() {
+        _next = _it;
+        for (size_t i = 0; i < _n && _next != _end; ++i) ++_next;
+    }
+
+public:
+
+    using value_type = IterableView<IteratorType, IteratorType>;
+    using reference = value_type;
+
+    /**
+     * @brief Construct a new ChunkIterator object.
+     *
+     * @param[in] it The underlying iterator.
+     * @param[in] end The underlying past-the-end iterator.
+     * @param[in] n The number of elements per chunk.
+     */
+    ChunkIterator(const IteratorType &it, const IteratorType &end, size_t n)
+    :   _it(it),
+        _next(it),
+        _end(end),
+        _n(n)
+    {
+        _advance();
+    }
+
+    bool operator==(const ChunkIterator &rhs) const { return _it == rhs._it; }
+    bool operator!=(const ChunkIterator &rhs) const { return _it != rhs._it; }
+
+    reference operator*() {
+        return reference(_it, _next);
+    }
+
+    ChunkIterator & operator++() {
+        _it = _next;
+        _advance();
+        return *this;
+    }
+
+    ChunkIterator operator++(int) {
+        ChunkIterator current = *this;
+        operator++();
+        return current;
+    }
+};
+
+/**
+ * @brief A lazy view over a pair of iterators. Adapters such as filter(),
+ * transform() and take() return new views that wrap the iterators of this
+ * one; nothing is evaluated or allocated until the view is traversed, and
+ * a chain of adapters is traversed in a single pass.
+ *
+ * @tparam Begin The beginning iterator type.
+ * @tparam End The past-the-end iterator type.
+ */
+template <typename Begin, typename End = Begin>
+class IterableView {
+private:
+    Begin _begin;
+    End _end;
+
+public:
+
+    using iterator = Begin;
+    using value_type = typename std::iterator_traits<Begin>::value_type;
+    using reference = typename std::iterator_traits<Begin>::reference;
+
+    /**
+     * @brief Construct a new IterableView object.
+     *
+     * @param[in] begin The beginning iterator.
+     * @param[in] end The past-the-end iterator.
+     */
+    IterableView(const Begin &begin, const End &end)
+    :   _begin(begin),
+        _end(end)
+    { }
+
+    Begin begin() const {
+        return _begin;
+    }
+
+    End end() const {
+        return _end;
+    }
+
+    /**
+     * @param[in] f A predicate functor.
+     * @return A view of the elements for which the predicate holds.
+     */
+    template <typename F>
+    IterableView<FilterIterator<Begin, F>> filter(F f) const {
+        return IterableView<FilterIterator<Begin, F>>(
+            FilterIterator<Begin, F>(_begin, _end, f),
+            FilterIterator<Begin, F>(_end, _end, f)
+        );
+    }
+
+    /**
+     * @param[in] f A mapping functor.
+     * @return A view of the elements mapped by the given functor.
+     */
+    template <typename F>
+    IterableView<ForwardIteratorView<Begin, F>> transform(F f) const {
+        return IterableView<ForwardIteratorView<Begin, F>>(
+            ForwardIteratorView<Begin, F>(_begin, f),
+            ForwardIteratorView<Begin, F>(_end, f)
+        );
+    }
+
+    /**
+     * @param[in] n The maximum number of elements to take.
+     * @return A view of the first n elements.
+     */
+    IterableView<TakeIterator<Begin>> take(size_t n) const {
+        return IterableView<TakeIterator<Begin>>(
+            TakeIterator<Begin>(_begin, _end, n),
+            TakeIterator<Begin>(_end, _end, 0)
+        );
+    }
+
+    /**
+     * @param[in] other An iterable object to walk alongside this view.
+     * @return A view of pairs of elements of this view and the other object,
+     * as long as the shorter of the two.
+     */
+    template <typename Iterable>
+    auto zip(const Iterable &other) const
+        -> IterableView<ZipIterator<Begin, decltype(other.begin())>>
+    {
+        using Other = decltype(other.begin());
+        return IterableView<ZipIterator<Begin, Other>>(
+            ZipIterator<Begin, Other>(_begin, other.begin()),
+            ZipIterator<Begin, Other>(_end, other.end())
+        );
+    }
+
+    /**
+     * @param[in] n The number of elements per chunk.
+     * @return A view of consecutive views of n elements each. The last one
+     * may be shorter.
+     */
+    IterableView<ChunkIterator<Begin>> chunk(size_t n) const {
+        return IterableView<ChunkIterator<Begin>>(
+            ChunkIterator<Begin>(_begin, _end, n),
+            ChunkIterator<Begin>(_end, _end, n)
+        );
+    }
+
+    /**
+     * @brief Applies the given function to every element of this view.
+     *
+     * @param[in] f The functor to call for every element.
+     */
+    template <typename F>
+    void foreach(F f) const {
+        for (auto it = _begin; it != _end; ++it) f(*it);
+    }
+
+    /**
+     * @return The number of elements in this view.
+     */
+    size_t count() const {
+        size_t n = 0;
+        for (auto it = _begin; it != _end; ++it) ++n;
+        return n;
+    }
+
+    /**
+     * @brief Reduces the elements of this view to a single value.
+     *
+     * @param[in] reducer A reducing functor that combines an accumulator with
+     * a new element.
+     * @return A single value after applying the reducing function to all
+     * elements, or a value-initialized T if the view is empty.
+     */
+    template <typename T, typename F>
+    T reduce(F reducer) const {
+        auto it = _begin;
+        T res = T();
+        if (it != _end) {
+            res = *it;
+            while (++it != _end) {
+                res = reducer(res, *it);
+            }
+        }
+        return res;
+    }
+
+    /**
+     * @brief Reduces the elements of this view to a single value.
+     *
+     * @param[in] initialMapper An initial mapping functor that is invoked for
+     * the first element.
+     * @param[in] reducer A reducing functor that combines an accumulator with
+     * a new element.
+     * @return A single value after applying the reducing function to all
+     * elements, or a value-initialized T if the view is empty.
+     */
+    template <typename T, typename Init, typename F>
+    T reduce(Init initialMapper, F reducer) const {
+        auto it = _begin;
+        T res = T();
+        if (it != _end) {
+            res = initialMapper(*it);
+            while (++it != _end) {
+                res = reducer(res, *it);
+            }
+        }
+        return res;
+    }
+
+    /**
+     * @brief Creates a new container of the indicated type holding the
+     * elements of this view.
+     *
+     * @tparam T Type of the new container.
+     * @return A new container with the elements of this view.
+     */
+    template <typename T>
+    T to() const {
+        return T(_begin, _end);
+    }
+};
+
+/**
+ * @param[in] begin The beginning iterator.
+ * @param[in] end The past-the-end iterator.
+ * @return A lazy view over the given iterators.
+ */
+template <typename Begin, typename End>
+IterableView<Begin, End> view(const Begin &begin, const End &end) {
+    return IterableView<Begin, End>(begin, end);
+}
+
 }   // namespace spl
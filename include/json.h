@@ -13,6 +13,7 @@
 #include <hash_map.h>
 #include <exception.h>
 #include <numeric_types.h>
+#include <serialization.h>
 
 namespace spl {
 
@@ -31,6 +32,281 @@ struct JSONDecodeError
     { }
 };
 
+/**
+ * @brief Encodes JSON by appending to a single output buffer, which may be
+ * owned by the caller or drained into an OutputStreamSerializer as it fills.
+ * Values may be written whole (strings, booleans, numbers, lists and
+ * dictionaries), or structurally with beginObject()/key()/endObject() and
+ * beginArray()/endArray(). Output is indented as by JSON::encode().
+ */
+class JSONWriter {
+
+private:
+
+    static constexpr size_t _DEFAULT_FLUSH_THRESHOLD = 4096;
+
+    std::string _own;
+    std::string *_buf;
+    OutputStreamSerializer *_serializer = nullptr;
+    size_t _flushThreshold = 0;
+
+    size_t _depth = 0;
+    bool _first = false;
+    bool _afterKey = false;
+
+    void _beforeValue();
+
+    void _begin(char token);
+
+    void _end(char token);
+
+    void _string(const char *str, size_t len);
+
+    void _raw(const char *str) {
+        _buf->append(str);
+    }
+
+    template <typename T>
+    void _number(const T &val) {
+        char str[StringConversions::MAX_CHARS];
+        _buf->append(str, StringConversions::toChars(str, val));
+    }
+
+    void _number(const float128 &val) {
+        _raw(StringConversions::toStr(val));
+    }
+
+public:
+
+    /**
+     * @brief Construct a new JSONWriter object appending to a string.
+     *
+     * @param out The string to append to.
+     */
+    JSONWriter(std::string &out)
+    :   _buf(&out)
+    { }
+
+    /**
+     * @brief Construct a new JSONWriter object writing to a serializer.
+     * Output is buffered and put into the serializer whenever it reaches
+     * flushThreshold bytes, on flush(), and on destruction.
+     *
+     * @param serializer The serializer to write to.
+     * @param flushThreshold Number of bytes to buffer before writing to the
+     * serializer.
+     */
+    JSONWriter(OutputStreamSerializer &serializer, size_t flushThreshold = _DEFAULT_FLUSH_THRESHOLD)
+    :   _buf(&_own),
+        _serializer(&serializer),
+        _flushThreshold(flushThreshold)
+    {
+        _own.reserve(flushThreshold);
+    }
+
+    JSONWriter(const JSONWriter &) = delete;
+
+    JSONWriter & operator=(const JSONWriter &) = delete;
+
+    ~JSONWriter() {
+        if (_serializer != nullptr) flush();
+    }
+
+    /**
+     * @brief Puts any buffered output into the serializer. Has no effect when
+     * writing to a string.
+     *
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & flush() {
+        if (_serializer != nullptr && ! _own.empty()) {
+            _serializer->put(_own.data(), _own.size());
+            _own.clear();
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Begins an object. Members are written as a key() followed by a
+     * value.
+     *
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & beginObject() {
+        _begin('{');
+        return *this;
+    }
+
+    /**
+     * @brief Ends the current object.
+     *
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & endObject() {
+        _end('}');
+        return *this;
+    }
+
+    /**
+     * @brief Begins an array.
+     *
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & beginArray() {
+        _begin('[');
+        return *this;
+    }
+
+    /**
+     * @brief Ends the current array.
+     *
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & endArray() {
+        _end(']');
+        return *this;
+    }
+
+    /**
+     * @brief Writes the key of the next object member.
+     *
+     * @param key A null-terminated string.
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & key(const char *key) {
+        return this->key(key, strlen(key));
+    }
+
+    /**
+     * @brief Writes the key of the next object member.
+     *
+     * @param key A string.
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & key(const std::string &key) {
+        return this->key(key.data(), key.size());
+    }
+
+    /**
+     * @brief Writes the key of the next object member.
+     *
+     * @param key Pointer to the key.
+     * @param len Length of the key.
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & key(const char *key, size_t len) {
+        _beforeValue();
+        _string(key, len);
+        _buf->append(": ", 2);
+        _afterKey = true;
+        return *this;
+    }
+
+    /**
+     * @brief Writes a null value.
+     *
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & null() {
+        _beforeValue();
+        _raw("null");
+        return *this;
+    }
+
+    /**
+     * @brief Writes a string.
+     *
+     * @param val Pointer to a null-terminated string.
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & value(const char *val) {
+        _beforeValue();
+        _string(val, strlen(val));
+        return *this;
+    }
+
+    /**
+     * @brief Writes a string.
+     *
+     * @param val A string.
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & value(const std::string &val) {
+        _beforeValue();
+        _string(val.data(), val.size());
+        return *this;
+    }
+
+    /**
+     * @brief Writes a boolean.
+     *
+     * @param val A boolean value.
+     * @return A reference to this object for chaining.
+     */
+    JSONWriter & value(const bool &val) {
+        _beforeValue();
+        _raw(val ? "true" : "false");
+        return *this;
+    }
+
+    /**
+     * @brief Writes a number.
+     *
+     * @param val A number.
+     * @return A reference to this object for chaining.
+     */
+    template <
+        typename T,
+        typename std::enable_if<
+            std::is_same<T, uint8>::value
+            || std::is_same<T, uint16>::value
+            || std::is_same<T, uint32>::value
+            || std::is_same<T, uint64>::value
+            || std::is_same<T, int8>::value
+            || std::is_same<T, int16>::value
+            || std::is_same<T, int32>::value
+            || std::is_same<T, int64>::value
+            || std::is_same<T, float32>::value
+            || std::is_same<T, float64>::value
+            || std::is_same<T, float128>::value,
+            int
+        >::type = 0
+    >
+    JSONWriter & value(const T &val) {
+        _beforeValue();
+        _number(val);
+        return *this;
+    }
+
+    /**
+     * @brief Writes a list as an array.
+     *
+     * @tparam T Type of the list items.
+     * @param list The list to write.
+     * @return A reference to this object for chaining.
+     */
+    template <typename T>
+    JSONWriter & value(const List<T> &list) {
+        beginArray();
+        for (const auto &x : list) value(x);
+        return endArray();
+    }
+
+    /**
+     * @brief Writes a dictionary as an object.
+     *
+     * @tparam T Type of the dictionary items.
+     * @param map The dictionary to write.
+     * @return A reference to this object for chaining.
+     */
+    template <typename T>
+    JSONWriter & value(const HashMap<std::string, T> &map) {
+        beginObject();
+        for (const auto &x : map) key(x.k).value(x.v);
+        return endObject();
+    }
+};
+
 /**
  * @brief Manages JSON encoding and decoding.
  */
@@ -38,13 +314,18 @@ class JSON {
 
 private:
 
-    static const char *_WHITE_SPACE;
     static const char *_NUM_STOP;
 
-    static std::string _indent(const std::string &str, int spaces = 2);
+    static bool _isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    static const char * _findNonWhitespace(const char *str);
 
     static void _skipWhitespaces(char const * &str) {
-        str += strspn(str, _WHITE_SPACE);
+        // most tokens are preceded by at most one whitespace, so only scan in
+        // bulk past longer runs (e.g. indentation)
+        if (_isWhitespace(*str)) str = _findNonWhitespace(str + 1);
     }
 
     static bool _consumeToken(char const * &str, char token) {
@@ -54,19 +335,13 @@ private:
         return true;
     }
 
-    static std::string _extractString(char const * &str);
-
-    static std::string _extractToken(char const * &str, const char *stop) {
-        size_t count = strcspn(str, stop);
-        auto start = str;
-        str += count;
-        return std::string(start, count);
+    template <typename T>
+    static std::string _encode(const T &val) {
+        std::string s;
+        JSONWriter(s).value(val);
+        return s;
     }
 
-    static void _escape(std::stringstream &s, const char *str);
-
-    static bool _unescape(std::stringstream &s, const char *str);
-
 public:
 
     /**
@@ -76,11 +351,7 @@ public:
      * @return JSON encoding of val.
      */
     static std::string encode(const char *val) {
-        std::stringstream s;
-        s << '"';
-        _escape(s, val);
-        s << '"';
-        return s.str();
+        return _encode(val);
     }
 
     /**
@@ -90,7 +361,7 @@ public:
      * @return JSON encoding of val.
      */
     static std::string encode(const std::string &val) {
-        return encode(val.c_str());
+        return _encode(val);
     }
 
     /**
@@ -127,7 +398,7 @@ public:
         >::type = 0
     >
     static std::string encode(const T &val) {
-        return StringConversions::toStr(val);
+        return _encode(val);
     }
 
     /**
@@ -139,22 +410,7 @@ public:
      */
     template <typename T>
     static std::string encode(const List<T> &list) {
-        if (list.empty()) {
-            return "[ ]";
-        }
-        else {
-            std::stringstream s;
-            s << '[';
-            for (auto it = list.begin(), end = list.end(); it != end; ) {
-                s << "\n  ";
-                s << _indent(encode(*it));
-
-                ++it;
-                if (it != end) s << ',';
-            }
-            s << "\n]";
-            return s.str();
-        }
+        return _encode(list);
     }
 
     /**
@@ -166,37 +422,41 @@ public:
      */
     template <typename T>
     static std::string encode(const HashMap<std::string, T> &map) {
-        if (map.empty()) {
-            return "{ }";
-        }
-        else {
-            std::stringstream s;
-            s << '{';
-            for (auto it = map.begin(), end = map.end(); it != end; ) {
-                s << "\n  ";
-                s << encode(it->k);
-                s << ": ";
-                s << _indent(encode(it->v));
-
-                ++it;
-                if (it != end) s << ',';
-            }
-            s << "\n}";
-            return s.str();
-        }
+        return _encode(map);
     }
 
-private:
+    /**
+     * @brief Appends the JSON representation of a value to a string.
+     *
+     * @tparam T Type of the value.
+     * @param val The value to encode.
+     * @param out The string to append to.
+     * @return A reference to out.
+     */
+    template <typename T>
+    static std::string & encode(const T &val, std::string &out) {
+        JSONWriter(out).value(val);
+        return out;
+    }
 
-    static bool _decode(char const * &str, std::string &val) {
-        if (! _consumeToken(str, '"')) return false;
-        std::stringstream s;
-        if (! _unescape(s, _extractString(str).c_str())) return false;
-        if (! _consumeToken(str, '"')) return false;
-        val = s.str();
-        return true;
+    /**
+     * @brief Writes the JSON representation of a value to a serializer.
+     *
+     * @tparam T Type of the value.
+     * @param val The value to encode.
+     * @param serializer The serializer to write to.
+     * @return A reference to serializer.
+     */
+    template <typename T>
+    static OutputStreamSerializer & encode(const T &val, OutputStreamSerializer &serializer) {
+        JSONWriter(serializer).value(val);
+        return serializer;
     }
 
+private:
+
+    static bool _decode(char const * &str, std::string &val);
+
     static bool _decode(char const * &str, bool &val) {
         if (strncasecmp(str, "true", 4) == 0) {
             str += 4;
@@ -232,9 +492,10 @@ private:
     >
     static bool _decode(char const * &str, T &val) {
         try {
-            std::string t = _extractToken(str, _NUM_STOP);
-            if (t.empty()) return false;
-            val = StringConversions::parse<T>(t);
+            size_t count = strcspn(str, _NUM_STOP);
+            if (count == 0) return false;
+            val = StringConversions::parse<T>(str, count);
+            str += count;
             return true;
         }
         catch (const StringParseError &e) {
@@ -323,4 +584,209 @@ public:
     }
 };
 
+/**
+ * @brief A streaming (pull) JSON parser. Each call to next() returns the next
+ * parse event. Strings, keys and numbers are returned as slices into the
+ * input, so no memory is allocated per token; only strings containing escape
+ * sequences are unescaped into an internal buffer that is reused.
+ *
+ * Input may be given all at once, or incrementally in chunks (e.g. as they
+ * are read from a File or TCPSocket) using feed(). When a chunk ends in the
+ * middle of a token, next() returns NEED_MORE and the token is completed from
+ * the next chunk. end() marks the end of the input.
+ *
+ * Slices returned by value() remain valid until the next call to next() or
+ * feed(). A chunk must remain valid until the next call to feed().
+ */
+class JSONReader {
+
+public:
+
+    /**
+     * @brief Parse events.
+     */
+    enum Event {
+        BEGIN_OBJECT,
+        END_OBJECT,
+        BEGIN_ARRAY,
+        END_ARRAY,
+        KEY,
+        STRING,
+        NUMBER,
+        BOOLEAN,
+        NULL_VALUE,
+        NEED_MORE,
+        END,
+    };
+
+    /**
+     * @brief A non-owning view of a sequence of characters.
+     */
+    struct Slice {
+        const char *data = nullptr;
+        size_t len = 0;
+
+        /**
+         * @return A copy of the slice as a string.
+         */
+        std::string str() const {
+            return std::string(data, len);
+        }
+
+        bool operator==(const char *rhs) const {
+            return strncmp(data, rhs, len) == 0 && rhs[len] == '\0';
+        }
+
+        bool operator!=(const char *rhs) const {
+            return ! operator==(rhs);
+        }
+    };
+
+private:
+
+    enum _State : uint8_t {
+        _VALUE,
+        _FIRST_VALUE_OR_END,
+        _KEY,
+        _FIRST_KEY_OR_END,
+        _COLON,
+        _COMMA_OR_END,
+        _DONE,
+    };
+
+    const char *_pos = nullptr;
+    const char *_end = nullptr;
+
+    // a token split across chunks is completed in _carry, which holds the
+    // leftover of the previous chunk followed by the current chunk
+    std::string _carry;
+    bool _inCarry = false;
+    size_t _carryPrefix = 0;
+    const char *_chunk = nullptr;
+    size_t _chunkLen = 0;
+
+    bool _last = false;
+    std::string _stack;
+    _State _state = _VALUE;
+
+    Slice _value;
+    std::string _scratch;
+    bool _boolean = false;
+
+    void _leaveCarry();
+
+    void _skipWhitespaces();
+
+    Event _afterValue(Event e);
+
+    Event _close(char token);
+
+    Event _string(Event e);
+
+    Event _number();
+
+    Event _literal(const char *token, size_t len, Event e);
+
+    Event _incomplete();
+
+public:
+
+    /**
+     * @brief Construct a new JSONReader object that expects its input to be
+     * fed incrementally using feed().
+     */
+    JSONReader() = default;
+
+    /**
+     * @brief Construct a new JSONReader object over a complete input.
+     *
+     * @param data Pointer to the input.
+     * @param len Length of the input.
+     */
+    JSONReader(const char *data, size_t len) {
+        feed(data, len).end();
+    }
+
+    /**
+     * @brief Construct a new JSONReader object over a complete input.
+     *
+     * @param str A null-terminated JSON string.
+     */
+    JSONReader(const char *str)
+    :   JSONReader(str, strlen(str))
+    { }
+
+    JSONReader(const JSONReader &) = delete;
+
+    JSONReader & operator=(const JSONReader &) = delete;
+
+    /**
+     * @brief Adds a chunk of input. Any unconsumed input from the previous
+     * chunk is kept and continued by this chunk.
+     *
+     * @param data Pointer to the chunk.
+     * @param len Length of the chunk.
+     * @return A reference to this object for chaining.
+     */
+    JSONReader & feed(const char *data, size_t len);
+
+    /**
+     * @brief Marks the end of the input.
+     *
+     * @return A reference to this object for chaining.
+     */
+    JSONReader & end() {
+        _last = true;
+        return *this;
+    }
+
+    /**
+     * @brief Parses the next event.
+     *
+     * @throws JSONDecodeError if the input is not valid JSON.
+     * @return The next event. NEED_MORE if the input fed so far is exhausted,
+     * or END after the top-level value and the end of the input.
+     */
+    Event next();
+
+    /**
+     * @return The text of the last KEY, STRING or NUMBER event. Strings are
+     * unescaped.
+     */
+    const Slice & value() const {
+        return _value;
+    }
+
+    /**
+     * @return The value of the last BOOLEAN event.
+     */
+    bool boolean() const {
+        return _boolean;
+    }
+
+    /**
+     * @brief Parses the value of the last NUMBER event.
+     *
+     * @tparam T The desired numeric type.
+     * @throws JSONDecodeError if the number is not representable as a T.
+     * @return The parsed number.
+     */
+    template <typename T>
+    T number() const {
+        try {
+            return StringConversions::parse<T>(_value.data, _value.len);
+        }
+        catch (const StringParseError &) {
+            throw JSONDecodeError("Invalid JSON number");
+        }
+    }
+
+    /**
+     * @return The current nesting depth of objects and arrays.
+     */
+    size_t depth() const {
+        return _stack.size();
+    }
+};
+
 }   // namespace spl
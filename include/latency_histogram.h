@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace spl {
+
+namespace core {
+
+class AtomicLatencyHistogram;
+
+} // namespace core
+
+/**
+ * @brief A histogram of durations in nanoseconds, with power-of-two buckets.
+ * Bucket 0 counts zero durations and bucket b counts durations in
+ * [2^(b-1), 2^b), so percentiles are accurate to within a factor of two.
+ */
+class LatencyHistogram {
+
+    friend class core::AtomicLatencyHistogram;
+
+public:
+
+    static constexpr size_t BUCKETS = 64;
+
+private:
+
+    uint64_t _buckets[BUCKETS] = { };
+    uint64_t _count = 0;
+    uint64_t _sum = 0;
+    uint64_t _max = 0;
+
+public:
+
+    /**
+     * @return The bucket counting a duration.
+     */
+    static size_t bucket(uint64_t nanos) {
+        if (nanos == 0) return 0;
+        size_t b = 64 - __builtin_clzll(nanos);
+        return b < BUCKETS ? b : BUCKETS - 1;
+    }
+
+    /**
+     * @brief Records a duration.
+     */
+    void record(uint64_t nanos) {
+        ++_buckets[bucket(nanos)];
+        ++_count;
+        _sum += nanos;
+        if (nanos > _max) _max = nanos;
+    }
+
+    /**
+     * @brief Adds the durations recorded by another histogram to this one.
+     */
+    void merge(const LatencyHistogram &rhs) {
+        for (size_t b = 0; b < BUCKETS; ++b) _buckets[b] += rhs._buckets[b];
+        _count += rhs._count;
+        _sum += rhs._sum;
+        if (rhs._max > _max) _max = rhs._max;
+    }
+
+    /**
+     * @return The number of durations counted by a bucket.
+     */
+    uint64_t bucketCount(size_t b) const {
+        return _buckets[b];
+    }
+
+    /**
+     * @return The number of recorded durations.
+     */
+    uint64_t count() const {
+        return _count;
+    }
+
+    /**
+     * @return The sum of the recorded durations.
+     */
+    uint64_t sum() const {
+        return _sum;
+    }
+
+    /**
+     * @return The longest recorded duration.
+     */
+    uint64_t max() const {
+        return _max;
+    }
+
+    /**
+     * @return The mean of the recorded durations, or 0 if there are none.
+     */
+    double mean() const {
+        return _count == 0 ? 0 : (double) _sum / _count;
+    }
+
+    /**
+     * @brief Estimates a percentile of the recorded durations as the upper
+     * bound of the bucket it falls in, capped at max().
+     *
+     * @param p The percentile, between 0 and 100.
+     * @return The estimate, or 0 if there are no durations.
+     */
+    uint64_t percentile(double p) const {
+        if (_count == 0) return 0;
+        uint64_t rank = (uint64_t) (p / 100 * _count);
+        if (rank >= _count) rank = _count - 1;
+
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            seen += _buckets[b];
+            if (seen > rank) {
+                uint64_t upper = b == 0 ? 0 : (b >= 64 ? UINT64_MAX : (1ULL << b) - 1);
+                return upper < _max ? upper : _max;
+            }
+        }
+        return _max;
+    }
+};
+
+namespace core {
+
+/**
+ * @brief A LatencyHistogram written by a single thread and read by any, for
+ * recording without atomic read-modify-write instructions.
+ */
+class AtomicLatencyHistogram {
+
+private:
+
+    std::atomic<uint64_t> _buckets[LatencyHistogram::BUCKETS];
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _max;
+
+    static void _add(std::atomic<uint64_t> &a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+
+    AtomicLatencyHistogram()
+    :   _sum(0),
+        _max(0)
+    {
+        for (auto &b : _buckets) b.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Records a duration. Must only be called by the owning thread.
+     */
+    void record(uint64_t nanos) {
+        _add(_buckets[LatencyHistogram::bucket(nanos)], 1);
+        _add(_sum, nanos);
+        if (nanos > _max.load(std::memory_order_relaxed)) _max.store(nanos, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copies the recorded durations into a histogram. The copy is only
+     * approximately consistent while the owning thread keeps recording.
+     */
+    void snapshot(LatencyHistogram &h) const {
+        h = LatencyHistogram();
+        for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+            h._buckets[b] = _buckets[b].load(std::memory_order_relaxed);
+            h._count += h._buckets[b];
+        }
+        h._sum = _sum.load(std::memory_order_relaxed);
+        h._max = _max.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace core
+
+} // namespace spl
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <functional>       // std::less
 #include <initializer_list>
 
 #include <core/linked_list.h>
@@ -17,18 +18,20 @@ namespace spl {
  * @brief A singly-linked list.
  * 
  * @tparam T The type of list elements.
+ * @tparam Allocator The allocator policy used for list nodes. The default
+ * allocator serves nodes from a thread-caching node pool.
  */
-template <typename T>
+template <typename T, template <typename> class Allocator = core::PooledAllocator>
 class List
-:   protected __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t>,
-    public ForwardIterableContainer<List<T>>,
+:   protected __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t, Allocator<__LinkedList::SinglyLinkedNode<T>>>,
+    public ForwardIterableContainer<List<T, Allocator>>,
     public Serializable
 {
 
     template <typename ListType> friend struct ListTester;
 
 protected:
-    using base = typename __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t>;
+    using base = typename __LinkedList::ListBase<T, __LinkedList::SinglyLinkedNode<T>, size_t, Allocator<__LinkedList::SinglyLinkedNode<T>>>;
     using node = typename base::node;
     using base::_head;
     using base::_tail;
@@ -78,7 +81,10 @@ public:
      * 
      * @param seq An iterable container of type T objects.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     List(Sequence &&seq)
     :   base(std::move(seq))
     { }
@@ -117,8 +123,8 @@ public:
      * @return A new List object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static List<typename It::value_type> create(const It &begin, const EndIt &end) {
-        return List<typename It::value_type>(begin, end);
+    static List<typename It::value_type, Allocator> create(const It &begin, const EndIt &end) {
+        return List<typename It::value_type, Allocator>(begin, end);
     }
 
     /**
@@ -133,8 +139,8 @@ public:
      * @return A new List object of type It::value_type objects.
      */
     template <typename It, typename EndIt>
-    static List<typename It::value_type> create(const It &begin, const EndIt &end, size_t size) {
-        return List<typename It::value_type>(begin, end, size);
+    static List<typename It::value_type, Allocator> create(const It &begin, const EndIt &end, size_t size) {
+        return List<typename It::value_type, Allocator>(begin, end, size);
     }
 
     ~List() = default;
@@ -465,6 +471,21 @@ public:
     T remove(Iterator &&pos) {
         return base::remove(pos);
     }
+
+    /**
+     * @brief Sorts this list with a stable merge sort in O(n log n) time. Nodes
+     * are relinked in place, so elements are never copied or moved, and
+     * iterators keep pointing to the same elements.
+     *
+     * @param comp A functor defining a strict weak order on elements. The
+     * default functor is std::less<T>.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Compare = std::less<T>>
+    List & sort(Compare comp = Compare()) {
+        base::sort(comp);
+        return *this;
+    }
 };
 
 namespace parallel
@@ -535,7 +556,10 @@ public:
      * 
      * @param seq An iterable container of type T objects.
      */
-    template <typename Sequence>
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
     List(Sequence &&seq)
     :   base(std::move(seq))
     { }
@@ -925,7 +949,23 @@ public:
      */
     T remove(Iterator &&pos) {
         return base::remove(pos);
-    }};
+    }
+
+    /**
+     * @brief Sorts this list with a stable merge sort in O(n log n) time. Nodes
+     * are relinked in place, so elements are never copied or moved.
+     * Note: this function is not thread-safe.
+     *
+     * @param comp A functor defining a strict weak order on elements. The
+     * default functor is std::less<T>.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Compare = std::less<T>>
+    List & sort(Compare comp = Compare()) {
+        base::sort(comp);
+        return *this;
+    }
+};
 
 }   // namespace parallel
 
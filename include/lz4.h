@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstdlib>
+
+namespace spl {
+
+/**
+ * @brief Fast LZ77-style compression of data blocks using the LZ4 block
+ * format. Blocks are self-contained; framing is left to the caller.
+*/
+class LZ4 {
+public:
+
+    /**
+     * @param[in] inputLength Length of an uncompressed data block.
+     * @return The maximum compressed size of a data block of the given length.
+     */
+    static size_t compressBound(size_t inputLength) {
+        return inputLength + inputLength / 255 + 16;
+    }
+
+    /**
+     * @brief Compresses a data block.
+     * 
+     * @param[in] data Const pointer to the data block.
+     * @param[in] inputLength Length of the data block.
+     * @param[out] output Pointer to a buffer for the compressed data.
+     * @param[in] outputCapacity Size of the output buffer.
+     * @return The compressed size, or 0 if the compressed data does not fit in
+     * outputCapacity bytes. An output buffer of compressBound(inputLength)
+     * bytes is always sufficient.
+     */
+    static size_t compress(const void *data, size_t inputLength, void *output, size_t outputCapacity);
+
+    /**
+     * @brief Decompresses a data block.
+     * 
+     * @param[in] data Const pointer to the compressed data block.
+     * @param[in] inputLength Length of the compressed data block.
+     * @param[out] output Pointer to a buffer for the decompressed data.
+     * @param[in] outputCapacity Size of the output buffer.
+     * @return The decompressed size.
+     * @throws InvalidArgument if the block is malformed or does not fit in the
+     * output buffer.
+     */
+    static size_t decompress(const void *data, size_t inputLength, void *output, size_t outputCapacity);
+};
+
+}
@@ -0,0 +1,517 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <core/hash_table.h>
+#include <functional>       // std::equal_to
+#include <hash.h>
+#include <file.h>
+#include <exception.h>
+#include <serialization.h>
+#include <sys/stat.h>
+
+namespace spl {
+
+/**
+ * @brief A hash map whose table lives in a file, mapped into memory. Opening
+ * an existing map costs a single mmap(2) regardless of its size; pages of the
+ * table are read from the file on first access and cached by the kernel, so
+ * read-only instances in several processes share one copy of the table.
+ *
+ * The file holds a header page, followed by the control bytes and nodes of the
+ * table. Growing the table appends a larger one to the file with
+ * File::allocate() and moves the elements over, after which the space of the
+ * old table is released with File::deallocate(). The file therefore keeps a
+ * hole where its earlier tables were, about as large as the table itself.
+ *
+ * Modifying the map is not thread-safe, and a file may not be opened while it
+ * is being modified elsewhere. Lookups may run concurrently with each other.
+ *
+ * @tparam Key The key type. Must support trivial serialization.
+ * @tparam Val The value type. Must support trivial serialization.
+ * @tparam KeyHash A functor to calculate the hash code of the key type. The
+ * default functor is Hash<Key>. Must hash keys the same way in every process
+ * opening the file.
+ * @tparam KeyEqual A functor to test for key equality. The default functor is
+ * std::equal_to<Key>.
+*/
+template <
+    typename Key,
+    typename Val,
+    typename KeyHash = Hash<Key>,
+    typename KeyEqual = std::equal_to<Key>
+>
+class MappedHashMap {
+
+    static_assert(
+        SupportsTrivialSerialization<Key>::value && ! SupportsCustomSerialization<Key>::value,
+        "Key must support trivial serialization"
+    );
+
+    static_assert(
+        SupportsTrivialSerialization<Val>::value && ! SupportsCustomSerialization<Val>::value,
+        "Val must support trivial serialization"
+    );
+
+public:
+
+    using storage_node = MapNode<Key, Val>;
+
+private:
+
+    using node = core::HashMapNode<Key, Val>;
+    using probe = core::TableProbe<node>;
+
+    static constexpr uint64_t __MAGIC = 0x50414d48534d4c50lu;    // "PLMSHMAP"
+    static constexpr uint32_t __VERSION = 1;
+    static constexpr size_t __INITIAL_TABLE_SIZE = 128;
+    static constexpr size_t __MINIMUM_TABLE_SIZE = 8;
+    static constexpr size_t __NPOS = probe::NPOS;
+
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t nodeSize;
+        uint32_t keySize;
+        uint32_t valSize;
+        core::HashTableController geometry;
+        uint64_t size;
+        uint64_t region;            // offset of the control bytes, followed by the nodes
+        uint64_t regionLength;
+    };
+
+    File _f;
+    MemoryMapping _m;
+    KeyHash _hash;
+    core::HashMapNodeKeyEqual<KeyEqual> _eq;
+    uint8_t *_ctrl = nullptr;
+    node *_table = nullptr;
+
+    static size_t _roundUp(size_t x, size_t align) {
+        return (x + align - 1) / align * align;
+    }
+
+    static size_t _page() {
+        return sysconf(_SC_PAGESIZE);
+    }
+
+    static size_t _ctrlLength(size_t tableSize) {
+        // padded by one group, see ControlGroup::allocate()
+        return _roundUp(tableSize + core::ControlGroup::WIDTH, alignof(node));
+    }
+
+    static size_t _regionLength(size_t tableSize) {
+        return _roundUp(_ctrlLength(tableSize) + tableSize * sizeof(node), _page());
+    }
+
+    Header & _header() const {
+        return *static_cast<Header *>(const_cast<void *>(_m.ptr()));
+    }
+
+    uint8_t * _at(size_t offset) const {
+        return static_cast<uint8_t *>(const_cast<void *>(_m.ptr())) + offset;
+    }
+
+    /**
+     * @brief Points _ctrl and _table at the table named by the header.
+     */
+    void _locate() {
+        Header &hd = _header();
+        _ctrl = _at(hd.region);
+        _table = reinterpret_cast<node *>(_ctrl + _ctrlLength(hd.geometry.tableSize));
+    }
+
+    size_t _fileLength() const {
+        struct stat st;
+        if (fstat(_f.fd(), &st) != 0) throw ErrnoRuntimeError();
+        return st.st_size;
+    }
+
+    void _create(size_t initialSize) {
+        size_t region = _page();
+
+        core::HashTableController geometry;
+        geometry.init(initialSize < __MINIMUM_TABLE_SIZE ? __MINIMUM_TABLE_SIZE : initialSize);
+        size_t regionLength = _regionLength(geometry.tableSize);
+
+        // the extended file reads as zeros, which is an empty table
+        _f.allocate(0, region + regionLength);
+        _m = _f.map(0, region + regionLength, true);
+
+        Header &hd = _header();
+        hd.magic = __MAGIC;
+        hd.version = __VERSION;
+        hd.nodeSize = sizeof(node);
+        hd.keySize = sizeof(Key);
+        hd.valSize = sizeof(Val);
+        hd.geometry = geometry;
+        hd.size = 0;
+        hd.region = region;
+        hd.regionLength = regionLength;
+
+        _locate();
+    }
+
+    void _open(size_t length, bool writeable) {
+        if (length < sizeof(Header)) throw InvalidArgument("Not a mapped hash map file");
+
+        _m = _f.map(0, length, writeable);
+
+        const Header &hd = _header();
+        if (hd.magic != __MAGIC || hd.version != __VERSION) {
+            throw InvalidArgument("Not a mapped hash map file");
+        }
+        if (hd.nodeSize != sizeof(node) || hd.keySize != sizeof(Key) || hd.valSize != sizeof(Val)) {
+            throw InvalidArgument("The mapped hash map file holds elements of another type");
+        }
+        if (hd.region + hd.regionLength > length) {
+            throw InvalidArgument("The mapped hash map file is truncated");
+        }
+
+        _locate();
+        _m.advise(MemoryMapping::RANDOM);
+    }
+
+    void _init(bool writeable, size_t initialSize) {
+        _f.open(writeable ? O_RDWR : O_RDONLY);
+
+        size_t length = _fileLength();
+        if (length == 0) {
+            if (! writeable) throw InvalidArgument("Not a mapped hash map file");
+            _create(initialSize);
+        }
+        else {
+            _open(length, writeable);
+        }
+    }
+
+    void _checkWriteable() const {
+        if (! _m.writeable()) throw UnsupportedError("The mapped hash map is read-only");
+    }
+
+    void _set(size_t i, size_t h, const storage_node &n) {
+        _table[i].set(h, n);
+        _ctrl[i] = core::ControlGroup::tag(h);
+    }
+
+    void _release(size_t i) {
+        _ctrl[i] = core::ControlGroup::EMPTY;
+        _table[i].release();
+    }
+
+    template <typename K>
+    size_t _findIndex(size_t h, const K &k) const {
+        core::HashRange range = _header().geometry.hashRange(h);
+        return probe::find(_table, _ctrl, range, h, k, _eq);
+    }
+
+    size_t _getFreeIndex(size_t h) {
+        while (true) {
+            core::HashTableController &geometry = _header().geometry;
+            core::HashRange range = geometry.hashRange(h);
+
+            size_t i = probe::freeIndex(_table, _ctrl, range);
+            if (i != __NPOS) return i;
+
+            // same policy as HashTable::_resize()
+            size_t collisions = 1 + probe::collisions(_table, _ctrl, range, h);
+            if (! geometry.needToExpandBucket(collisions)) {
+                i = probe::displace(_table, _ctrl, geometry, range);
+                if (i != __NPOS) return i;
+            }
+
+            core::HashTableController g = geometry;
+            if (g.needToExpandBucket(collisions) || g.tableSize >= 2 * _header().size) {
+                g.increaseBucketSize(g.bucketSize, collisions);
+                if (g.tableSize == _header().size) g.increaseNumberOfBuckets(g.nBuckets);
+            }
+            else {
+                g.increaseNumberOfBuckets(g.nBuckets);
+            }
+            _rehash(g);
+        }
+    }
+
+    /**
+     * @brief Moves every element into a new table of some geometry, appended
+     * to the file, growing the geometry first if the elements would not fit.
+     * The header is switched to the new table only once it is complete.
+     */
+    void _rehash(core::HashTableController geometry) {
+        bool spread = false;
+
+        while (true) {
+            size_t region = _roundUp(_m.size(), _page());
+            size_t regionLength = _regionLength(geometry.tableSize);
+
+            _f.allocate(region, regionLength);
+            _m.resize(region + regionLength);
+            _locate();
+
+            uint8_t *ctrl = _at(region);
+            node *table = reinterpret_cast<node *>(ctrl + _ctrlLength(geometry.tableSize));
+
+            size_t collisions = 0;
+            size_t tableSize = _header().geometry.tableSize;
+            for (size_t i = core::ControlGroup::next(_ctrl, 0, tableSize); i < tableSize; i = core::ControlGroup::next(_ctrl, i + 1, tableSize)) {
+                size_t h = _table[i].h;
+                core::HashRange range = geometry.hashRange(h);
+                size_t j = probe::freeIndex(table, ctrl, range);
+                if (j == __NPOS) {
+                    collisions = 1 + probe::collisions(table, ctrl, range, h);
+                    break;
+                }
+                table[j].set(h, _table[i].storage.n);
+                ctrl[j] = core::ControlGroup::tag(h);
+            }
+
+            if (collisions == 0) {
+                Header &hd = _header();
+                size_t oldRegion = hd.region;
+                size_t oldRegionLength = hd.regionLength;
+                hd.geometry = geometry;
+                hd.region = region;
+                hd.regionLength = regionLength;
+                _locate();
+                _f.deallocate(oldRegion, oldRegionLength);
+                return;
+            }
+
+            // drop the partial table and retry with a larger geometry, see
+            // HashTable::_reshape()
+            _m.resize(region);
+            _f.truncate(region);
+            _locate();
+
+            if (spread || geometry.needToExpandBucket(collisions)) {
+                geometry.increaseBucketSize(geometry.bucketSize, collisions);
+                spread = false;
+            }
+            else {
+                geometry.increaseNumberOfBuckets(geometry.nBuckets);
+                spread = true;
+            }
+        }
+    }
+
+public:
+
+    /**
+     * @brief Opens a mapped hash map. An empty file is set up as an empty map.
+     *
+     * @param f The backing file.
+     * @param writeable Whether the map may be modified (default = true).
+     * Read-only maps are mapped privately and never write to the file.
+     * @param initialSize The initial size of the table of a new map (default =
+     * 128).
+     * @throws InvalidArgument if the file does not hold a map of this type.
+     */
+    MappedHashMap(const File &f, bool writeable = true, size_t initialSize = __INITIAL_TABLE_SIZE)
+    :   _f(f)
+    {
+        _init(writeable, initialSize);
+    }
+
+    /**
+     * @brief Opens a mapped hash map. An empty file is set up as an empty map.
+     *
+     * @param f The backing file.
+     * @param writeable Whether the map may be modified (default = true).
+     * Read-only maps are mapped privately and never write to the file.
+     * @param initialSize The initial size of the table of a new map (default =
+     * 128).
+     * @throws InvalidArgument if the file does not hold a map of this type.
+     */
+    MappedHashMap(File &&f, bool writeable = true, size_t initialSize = __INITIAL_TABLE_SIZE)
+    :   _f(std::move(f))
+    {
+        _init(writeable, initialSize);
+    }
+
+    MappedHashMap(const MappedHashMap &) = delete;
+
+    MappedHashMap(MappedHashMap &&) = default;
+
+    ~MappedHashMap() = default;
+
+    MappedHashMap & operator=(const MappedHashMap &) = delete;
+
+    MappedHashMap & operator=(MappedHashMap &&) = default;
+
+    /**
+     * @return The size of this container.
+     */
+    size_t size() const {
+        return _header().size;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is not empty.
+     */
+    bool nonEmpty() const {
+        return size() != 0;
+    }
+
+    /**
+     * @return True if this map can be modified, false if it was opened
+     * read-only.
+     */
+    bool writeable() const {
+        return _m.writeable();
+    }
+
+    /**
+     * @brief Tests whether a mapping for some key exists.
+     *
+     * @param k The key to search for.
+     * @return True if the key exists, false otherwise.
+     */
+    template <typename K>
+    bool contains(const K &k) const {
+        return _findIndex(_hash(k), k) != __NPOS;
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key. If the key is not
+     * found, an ElementNotFoundError will be thrown.
+     *
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A copy of the corresponding value.
+     */
+    template <typename K>
+    Val get(const K &k) const {
+        size_t i = _findIndex(_hash(k), k);
+        if (i != __NPOS) return _table[i].storage.n.v;
+        throw ElementNotFoundError();
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key. If the given key is
+     * not found in the map, the default value will be returned.
+     *
+     * @param k The key to search for.
+     * @param defaultValue The default value to return if the key is not found.
+     * @return A copy of the actual value corresponding to the given key, or the
+     * default value.
+     */
+    template <typename K>
+    Val getOr(const K &k, const Val &defaultValue) const {
+        size_t i = _findIndex(_hash(k), k);
+        if (i != __NPOS) return _table[i].storage.n.v;
+        return defaultValue;
+    }
+
+    /**
+     * @brief Looks up the value corresponding to some key, without throwing
+     * on a miss.
+     *
+     * @param k The key to search for.
+     * @return A const pointer to the value, or nullptr if the key is not
+     * found. The pointer is invalidated by any modification of the map.
+     */
+    template <typename K>
+    const Val * find(const K &k) const {
+        size_t i = _findIndex(_hash(k), k);
+        return i != __NPOS ? &_table[i].storage.n.v : nullptr;
+    }
+
+    /**
+     * @brief Inserts a new mapping, or replaces the value of an existing one.
+     *
+     * @param k Key.
+     * @param v Value.
+     * @throws UnsupportedError if the map is read-only.
+     * @return A reference to this container for chaining.
+     */
+    MappedHashMap & put(const Key &k, const Val &v) {
+        _checkWriteable();
+
+        size_t h = _hash(k);
+        size_t i = _findIndex(h, k);
+        if (i != __NPOS) {
+            _table[i].storage.n.v = v;
+        }
+        else {
+            _set(_getFreeIndex(h), h, { k, v });
+            ++_header().size;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Erases a key from this map. If the key does not exist, the
+     * function does nothing.
+     *
+     * @param k The key to erase.
+     * @throws UnsupportedError if the map is read-only.
+     * @return True if a key was erased, false otherwise.
+     */
+    template <typename K>
+    bool erase(const K &k) {
+        _checkWriteable();
+
+        size_t i = _findIndex(_hash(k), k);
+        if (i == __NPOS) return false;
+        _release(i);
+        --_header().size;
+        return true;
+    }
+
+    /**
+     * @brief Grows the table to hold at least some number of elements without
+     * resizing.
+     *
+     * @param n The number of elements.
+     * @throws UnsupportedError if the map is read-only.
+     * @return A reference to this container for chaining.
+     */
+    MappedHashMap & reserve(size_t n) {
+        _checkWriteable();
+
+        core::HashTableController geometry = _header().geometry;
+        geometry.reserve(n, __MINIMUM_TABLE_SIZE);
+        if (geometry.tableSize > _header().geometry.tableSize) _rehash(geometry);
+        return *this;
+    }
+
+    /**
+     * @brief Applies a function to all elements of this container.
+     *
+     * @param f The function to call with a const reference to every
+     * MapNode<Key, Val>.
+     * @return A reference to this container for chaining.
+     */
+    template <typename F>
+    const MappedHashMap & foreach(F f) const {
+        size_t tableSize = _header().geometry.tableSize;
+        for (size_t i = core::ControlGroup::next(_ctrl, 0, tableSize); i < tableSize; i = core::ControlGroup::next(_ctrl, i + 1, tableSize)) {
+            f(static_cast<const storage_node &>(_table[i].storage.n));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Writes the modified pages of the map back to the file.
+     *
+     * @param block Whether to wait until the pages are written (default =
+     * false).
+     * @return A reference to this container for chaining.
+     */
+    MappedHashMap & sync(bool block = false) {
+        if (_m.writeable()) _m.sync(block);
+        return *this;
+    }
+};
+
+}   // namespace spl
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <serialization.h>
 #include <hash_map.h>
 #include <string>
@@ -45,8 +46,108 @@ private:
 
     HashMap<std::string, Param> _param;
 
+    // bumped by every change of any value, to invalidate bound parameters
+    size_t _generation = 0;
+
+    const Param & _find(const std::string &key) const {
+        const Param *p = _param.find(key);
+        if (p == nullptr) throw ElementNotFoundError();
+        return *p;
+    }
+
+    Param & _find(const std::string &key) {
+        Param *p = _param.find(key);
+        if (p == nullptr) throw ElementNotFoundError();
+        return *p;
+    }
+
+    template <typename T>
+    static T _decode(const std::string &key, const Param &p) {
+        try {
+            return JSON::decode<T>(p.value.empty() ? p.defaultValue : p.value);
+        }
+        catch (const JSONDecodeError &e) {
+            throw InvalidArgument(
+                "Error extracting conf key '", key, "' as '", typeid(T).name(), '\''
+            );
+        }
+    }
+
 public:
 
+    /**
+     * @brief A named parameter bound to a type, holding its decoded value.
+     * The value is decoded when bound and again only after the parameters
+     * change, so that reading it is a comparison and a load.
+     *
+     * A bound parameter refers to the NamedParameters object it was bound
+     * from, which must outlive it and stay at the same address. It is not
+     * safe to read a bound parameter while the parameters are being changed.
+     *
+     * @tparam T Type of the parameter.
+     */
+    template <typename T>
+    class Bound {
+
+        friend class NamedParameters;
+
+    private:
+
+        const NamedParameters *_params;
+        std::string _key;
+        mutable size_t _generation;
+        mutable T _value;
+
+        Bound(const NamedParameters *params, const std::string &key)
+        :   _params(params),
+            _key(key),
+            _generation(params->_generation),
+            _value(_decode<T>(key, params->_find(key)))
+        { }
+
+        void _refresh() const {
+            _value = _decode<T>(_key, _params->_find(_key));
+            _generation = _params->_generation;
+        }
+
+    public:
+
+        Bound(const Bound &) = default;
+
+        Bound(Bound &&) = default;
+
+        ~Bound() = default;
+
+        Bound & operator=(const Bound &) = default;
+
+        Bound & operator=(Bound &&) = default;
+
+        /**
+         * @return The parameter name.
+         */
+        const std::string & key() const {
+            return _key;
+        }
+
+        /**
+         * @brief Gets the value of the parameter, decoding it again if the
+         * parameters changed since it was last read.
+         *
+         * @throws ElementNotFoundError if the named parameter no longer exists.
+         * @throws InvalidArgument if the parameter is not compatible with type T.
+         * @return A const reference to the parameter value, valid until the
+         * next read after the parameters change.
+         */
+        const T & get() const {
+            if (_generation != _params->_generation) _refresh();
+            return _value;
+        }
+
+        operator const T &() const {
+            return get();
+        }
+    };
+
     NamedParameters() = default;
 
     NamedParameters(const NamedParameters &) = default;
@@ -55,9 +156,18 @@ public:
 
     ~NamedParameters() = default;
 
-    NamedParameters & operator=(const NamedParameters &) = default;
+    NamedParameters & operator=(const NamedParameters &rhs) {
+        _param = rhs._param;
+        _generation = std::max(_generation, rhs._generation) + 1;
+        return *this;
+    }
 
-    NamedParameters & operator=(NamedParameters &&) = default;
+    NamedParameters & operator=(NamedParameters &&rhs) {
+        _param = std::move(rhs._param);
+        _generation = std::max(_generation, rhs._generation) + 1;
+        ++rhs._generation;
+        return *this;
+    }
 
     void writeObject(OutputStreamSerializer &serializer) const override {
         serializer << _param;
@@ -65,6 +175,7 @@ public:
 
     void readObject(InputStreamSerializer &serializer) override {
         serializer >> _param;
+        ++_generation;
     }
 
     /**
@@ -91,6 +202,7 @@ public:
     template <typename T>
     NamedParameters & addParameter(const std::string &key, const T &defaultValue) {
         _param.put(key, JSON::encode(defaultValue));
+        ++_generation;
         return *this;
     }
 
@@ -108,6 +220,7 @@ public:
     template <typename T>
     NamedParameters & addParameter(std::string &&key, const T &defaultValue) {
         _param.put(std::move(key), JSON::encode(defaultValue));
+        ++_generation;
         return *this;
     }
 
@@ -126,9 +239,8 @@ public:
      */
     template <typename T>
     NamedParameters & set(const std::string &key, const T &value) {
-        if (! _param.contains(key)) throw ElementNotFoundError();
-
-        _param[key].value = JSON::encode(value);
+        _find(key).value = JSON::encode(value);
+        ++_generation;
 
         return *this;
     }
@@ -142,9 +254,8 @@ public:
      * @return A reference to this object for chaining.
      */
     NamedParameters & reset(const std::string &key) {
-        if (! _param.contains(key)) throw ElementNotFoundError();
-
-        _param[key].value.clear();
+        _find(key).value.clear();
+        ++_generation;
 
         return *this;
     }
@@ -166,18 +277,22 @@ public:
      */
     template <typename T>
     T get(const std::string &key) const {
-        if (! _param.contains(key)) throw ElementNotFoundError();
-
-        auto &p = _param[key];
+        return _decode<T>(key, _find(key));
+    }
 
-        try {
-            return JSON::decode<T>(p.value.empty() ? p.defaultValue : p.value);
-        }
-        catch (const JSONDecodeError &e) {
-            throw InvalidArgument(
-                "Error extracting conf key '", key, "' as '", typeid(T).name(), '\''
-            );
-        }
+    /**
+     * @brief Binds a named parameter to type T, for repeated reads of its
+     * value without looking it up or decoding it each time. See Bound.
+     *
+     * @tparam T Type of the parameter, as for get().
+     * @param key Parameter name.
+     * @throws ElementNotFoundError if the named parameter does not exist.
+     * @throws InvalidArgument if the parameter is not compatible with type T.
+     * @return The bound parameter.
+     */
+    template <typename T>
+    Bound<T> bind(const std::string &key) const {
+        return Bound<T>(this, key);
     }
 
     /**
@@ -192,9 +307,7 @@ public:
      * @return The parameter value.
      */
     std::string get_direct(const std::string &key) const {
-        if (! _param.contains(key)) throw ElementNotFoundError();
-
-        auto &p = _param[key];
+        auto &p = _find(key);
 
         return p.value.empty() ? p.defaultValue : p.value;
     }
@@ -206,8 +319,7 @@ public:
      * false otherwise.
      */
     bool isSet(const std::string &key) const {
-        if (! _param.contains(key)) throw ElementNotFoundError();
-        return ! _param[key].value.empty();
+        return ! _find(key).value.empty();
     }
 };
 
@@ -5,7 +5,8 @@
 
 #pragma once
 
-#include <map>
+#include <vector>
+#include <algorithm>
 #include <iterator.h>
 #include <serialization.h>
 #include <std_serialization.h>
@@ -45,23 +46,10 @@ private:
 
     private:
 
-        const std::map<T, Interval<T>> &_intervals;
-        typename std::map<T, Interval<T>>::const_iterator _it;
+        typename std::vector<Interval<T>>::const_iterator _it;
 
-        RangeForwardIterator(
-            const std::map<T, Interval<T>> &intervals,
-            const typename std::map<T, Interval<T>>::const_iterator &it
-        )
-        :   _intervals(intervals),
-            _it(it)
-        { }
-
-        RangeForwardIterator(
-            const std::map<T, Interval<T>> &intervals,
-            typename std::map<T, Interval<T>>::const_iterator &&it
-        )
-        :   _intervals(intervals),
-            _it(std::move(it))
+        RangeForwardIterator(const typename std::vector<Interval<T>>::const_iterator &it)
+        :   _it(it)
         { }
 
     public:
@@ -88,11 +76,11 @@ private:
         }
 
         reference operator*() const {
-            return _it->second;
+            return *_it;
         }
 
         pointer operator->() const {
-            return &_it->second;
+            return &*_it;
         }
 
         RangeForwardIterator & operator++() {
@@ -107,7 +95,64 @@ private:
         }
     };
 
-    std::map<T, Interval<T>> _intervals;
+    // disjoint, non-adjacent intervals sorted by start (and thus by end)
+    std::vector<Interval<T>> _intervals;
+
+    /**
+     * @return The index of the first interval ending at or after x, which is
+     * the first one that overlaps or touches an interval starting at x.
+     */
+    size_t _firstEndingAtOrAfter(const T &x) const {
+        return std::lower_bound(
+            _intervals.begin(), _intervals.end(), x,
+            [] (const Interval<T> &i, const T &x) { return i.end < x; }
+        ) - _intervals.begin();
+    }
+
+    /**
+     * @return The index of the first interval starting after x.
+     */
+    size_t _firstStartingAfter(const T &x) const {
+        return std::upper_bound(
+            _intervals.begin(), _intervals.end(), x,
+            [] (const T &x, const Interval<T> &i) { return x < i.start; }
+        ) - _intervals.begin();
+    }
+
+    /**
+     * @brief Appends an interval to a sorted vector of intervals, joining it
+     * with the last one if they overlap or touch. The interval must not start
+     * before the last one.
+     */
+    static void _append(std::vector<Interval<T>> &intervals, const Interval<T> &i) {
+        if (! intervals.empty() && ! (intervals.back().end < i.start)) {
+            if (intervals.back().end < i.end) intervals.back().end = i.end;
+        }
+        else {
+            intervals.push_back(i);
+        }
+    }
+
+    /**
+     * @brief Merges two sorted vectors of intervals into their union.
+     */
+    static std::vector<Interval<T>> _merge(
+        const std::vector<Interval<T>> &a,
+        const std::vector<Interval<T>> &b
+    ) {
+        std::vector<Interval<T>> r;
+        r.reserve(a.size() + b.size());
+
+        auto i = a.begin(), j = b.begin();
+        while (i != a.end() && j != b.end()) {
+            if (j->start < i->start) _append(r, *j++);
+            else _append(r, *i++);
+        }
+        for (; i != a.end(); ++i) _append(r, *i);
+        for (; j != b.end(); ++j) _append(r, *j);
+
+        return r;
+    }
 
 public:
 
@@ -124,39 +169,59 @@ public:
     Range & operator=(Range &&) = default;
 
     void writeObject(OutputStreamSerializer &serializer) const override {
-        serializer << _intervals;
+        // same layout as a std::map keyed by interval start
+        serializer << _intervals.size();
+        for (const auto &i : _intervals) {
+            serializer << i.start << i;
+        }
     }
 
     void readObject(InputStreamSerializer &serializer) override {
-        serializer >> _intervals;
+        size_t size;
+        serializer >> size;
+        _intervals.clear();
+        _intervals.reserve(size);
+        T start;
+        Interval<T> i;
+        for (size_t n = 0; n < size; ++n) {
+            serializer >> start >> i;
+            _intervals.push_back(i);
+        }
     }
 
     /**
      * @return A const iterator to the first interval of this range.
      */
     RangeForwardIterator begin() const {
-        return RangeForwardIterator(_intervals, _intervals.begin());
+        return RangeForwardIterator(_intervals.begin());
     }
 
     /**
      * @return A past-the-end iterator of the intervals of this range.
      */
     RangeForwardIterator end() const {
-        return RangeForwardIterator(_intervals, _intervals.end());
+        return RangeForwardIterator(_intervals.end());
     }
 
     /**
      * @return A const iterator to the first interval of this range.
      */
     RangeForwardIterator cbegin() const {
-        return RangeForwardIterator(_intervals, _intervals.begin());
+        return RangeForwardIterator(_intervals.begin());
     }
 
     /**
      * @return A past-the-end iterator of the intervals of this range.
      */
     RangeForwardIterator cend() const {
-        return RangeForwardIterator(_intervals, _intervals.end());
+        return RangeForwardIterator(_intervals.end());
+    }
+
+    /**
+     * @return The number of disjoint intervals making up this range.
+     */
+    size_t size() const {
+        return _intervals.size();
     }
 
     /**
@@ -166,33 +231,46 @@ public:
      * @return A reference to this object for chaining.
      */
     Range & insert(Interval<T> i) {
-        auto it = _intervals.lower_bound(i.start);
-        if (
-            (it == _intervals.end() && it != _intervals.begin())
-            || (it != _intervals.end() && i.start < it->second.start)
-        ) --it;
-        if (
-            it != _intervals.end()
-            && (it->second.start < i.start || it->second.start == i.start)
-        ) {
-            while (i.start < it->second.end || i.start == it->second.end) {
-                i.start = it->second.start;
-                if (i.end < it->second.end) i.end = it->second.end;
-                it = _intervals.erase(it);
-                if (it == _intervals.begin()) break;
-                --it;
-            }
+        // intervals [lo, hi) overlap or touch i, and are joined with it
+        size_t lo = _firstEndingAtOrAfter(i.start);
+        size_t hi = _firstStartingAfter(i.end);
+
+        if (lo == hi) {
+            _intervals.insert(_intervals.begin() + lo, i);
         }
+        else {
+            if (_intervals[lo].start < i.start) i.start = _intervals[lo].start;
+            if (i.end < _intervals[hi - 1].end) i.end = _intervals[hi - 1].end;
+            _intervals[lo] = i;
+            _intervals.erase(_intervals.begin() + lo + 1, _intervals.begin() + hi);
+        }
+
+        return *this;
+    }
 
-        it = _intervals.insert({ i.start, i }).first;
-        auto next = it;
-        ++next;
-        while (
-            next != _intervals.end()
-            && (next->second.start < it->second.end || next->second.start == it->second.end)
-        ) {
-            if (it->second.end < next->second.end) it->second.end = next->second.end;
-            next = _intervals.erase(next);
+    /**
+     * @brief Inserts a batch of intervals into this range. The batch is
+     * sorted and merged with the existing intervals in a single pass, which
+     * is considerably cheaper than inserting the intervals one at a time.
+     * 
+     * @param begin An iterator to the first interval to insert.
+     * @param end A past-the-end iterator of the intervals to insert.
+     * @return A reference to this object for chaining.
+     */
+    template <typename InputIterator>
+    Range & insertAll(InputIterator begin, InputIterator end) {
+        std::vector<Interval<T>> batch(begin, end);
+        std::sort(
+            batch.begin(), batch.end(),
+            [] (const Interval<T> &a, const Interval<T> &b) { return a.start < b.start; }
+        );
+
+        if (_intervals.empty()) {
+            _intervals.reserve(batch.size());
+            for (const auto &i : batch) _append(_intervals, i);
+        }
+        else {
+            _intervals = _merge(_intervals, batch);
         }
 
         return *this;
@@ -205,14 +283,11 @@ public:
      * @return True if the value is considered to be within the range, false
      * otherwise.
      */
-    bool contains(const T &x) {
-        auto it = _intervals.lower_bound(x);
-        if (it != _intervals.end() && it->second.start == x) return true;
-        if (it != _intervals.begin()) {
-            --it;
-            if (it->second.start < x && x < it->second.end) return true;
-        }
-        return false;
+    bool contains(const T &x) const {
+        size_t i = _firstStartingAfter(x);
+        if (i == 0) return false;
+        const Interval<T> &it = _intervals[i - 1];
+        return it.start == x || x < it.end;
     }
 
     /**
@@ -222,22 +297,12 @@ public:
      * @return True if the interval is considered to be within the range, false
      * otherwise.
      */
-    bool contains(const Interval<T> &x) {
-        auto it = _intervals.lower_bound(x.start);
-        if (
-            it != _intervals.end()
-            && it->second.start == x.start
-            && (x.end < it->second.end || x.end == it->second.end)
-        ) return true;
-        if (it != _intervals.begin()) {
-            --it;
-            if (
-                it->second.start < x.start
-                && x.start < it->second.end
-                && (x.end < it->second.end || x.end == it->second.end)
-            ) return true;
-        }
-        return false;
+    bool contains(const Interval<T> &x) const {
+        size_t i = _firstStartingAfter(x.start);
+        if (i == 0) return false;
+        const Interval<T> &it = _intervals[i - 1];
+        return (it.start == x.start || x.start < it.end)
+            && (x.end < it.end || x.end == it.end);
     }
 
     /**
@@ -247,10 +312,8 @@ public:
      * @return A new Range object containing the result.
      */
     Range operator|(const Range &other) const {
-        Range r = *this;
-        for (const auto & i : other) {
-            r.insert(i);
-        }
+        Range r;
+        r._intervals = _merge(_intervals, other._intervals);
         return r;
     }
 
@@ -261,87 +324,26 @@ public:
      * @return A new Range object containing the result.
      */
     Range operator-(const Range &other) const {
-        Range r = *this;
+        Range r;
+        r._intervals.reserve(_intervals.size());
 
-        auto it = r._intervals.begin();
-        auto end = r._intervals.end();
-
-        auto it2 = other._intervals.begin();
+        auto j = other._intervals.begin();
         auto end2 = other._intervals.end();
 
-        while (it != end && it2 != end2) {
-            // skip until there's an overlap, or end is reached
-            if (it->second.end < it2->second.start || it->second.end == it2->second.start) {
-                ++it;
-                continue;
-            }
-            if (it2->second.end < it->second.start || it2->second.end == it->second.start) {
-                ++it2;
-                continue;
+        for (Interval<T> i : _intervals) {
+            // skip the subtracted intervals ending before this one
+            while (j != end2 && (j->end < i.start || j->end == i.start)) ++j;
+
+            // cut every subtracted interval overlapping this one out of it
+            for (auto k = j; k != end2 && k->start < i.end; ++k) {
+                if (i.start < k->start) {
+                    r._intervals.push_back({ i.start, k->start });
+                }
+                if (i.start < k->end) i.start = k->end;
+                if (! (i.start < i.end)) break;
             }
 
-            std::pair<T, Interval<T>> i = *it2;
-
-            // starting before and ending before
-            //        |____________|
-            // - |__________|
-            if (i.second.start < it->second.start && i.second.end < it->second.end) {
-                i.second.start = i.second.end;
-                i.second.end = it->second.end;
-                i.first = i.second.start;
-
-                r._intervals.erase(it);
-                it = r._intervals.insert(i).first;
-            }
-            // starting after and ending after
-            //   |_____________|
-            // -        |____________|
-            else if (it->second.start < i.second.start && it->second.end < i.second.end) {
-                // alter the end and don't advance (might overlap with more interval(s))
-                it->second.end = i.second.start;
-            }
-            // starting after and ending before
-            //   |_________________|
-            // -     |_________|
-            else if (it->second.start < i.second.start && i.second.end < it->second.end) {
-                auto tmp = it->second.end;
-                it->second.end = i.second.start;
-
-                i.second.start = i.second.end;
-                i.second.end = tmp;
-                i.first = i.second.start;
-
-                it = r._intervals.insert(i).first;
-            }
-            // starting together and ending before
-            //   |_________________|
-            // - |____________|
-            else if (i.second.start == it->second.start && i.second.end < it->second.end) {
-                i.second.start = i.second.end;
-                i.second.end = it->second.end;
-                i.first = i.second.start;
-
-                r._intervals.erase(it);
-                it = r._intervals.insert(i).first;
-            }
-            // starting after and ending together
-            //   |______________|
-            // -        |_______|
-            else if (it->second.start < i.second.start && i.second.end == it->second.end) {
-                it->second.end = i.second.start;
-            }
-            // starting before or together, and ending after or together (completely covering)
-            //       |_____|
-            // - |_____________|
-            else if (
-                (i.second.start < it->second.start || i.second.start == it->second.start)
-                && (it->second.end < i.second.end || it->second.end == i.second.end)
-            ) {
-                it = r._intervals.erase(it);
-            }
-            else {
-                break;
-            }
+            if (i.start < i.end) r._intervals.push_back(i);
         }
 
         return r;
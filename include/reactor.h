@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <cstdlib>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+namespace spl {
+
+/**
+ * @brief An I/O readiness notifier backed by epoll. File descriptors are
+ * registered once with the events of interest and a caller-defined tag, and
+ * wait() returns only the descriptors that became ready, so the cost of a
+ * wakeup does not depend on the number of registered descriptors.
+ *
+ * A Reactor is thread-safe: several threads may wait() on the same instance,
+ * e.g. the workers of a ThreadPool. Combined with ONESHOT, each readiness
+ * notification is then delivered to a single thread, and the descriptor is
+ * not reported again until it is re-armed with arm().
+ */
+class Reactor {
+
+private:
+
+    int _fd = -1;
+
+    void _control(int op, int fd, uint32_t events, uint64_t tag);
+
+public:
+
+    /**
+     * @brief Readiness for reading.
+     */
+    static constexpr uint32_t READ = EPOLLIN;
+
+    /**
+     * @brief Readiness for writing.
+     */
+    static constexpr uint32_t WRITE = EPOLLOUT;
+
+    /**
+     * @brief The peer closed its end of the connection. Always reported.
+     */
+    static constexpr uint32_t HANGUP = EPOLLHUP | EPOLLRDHUP;
+
+    /**
+     * @brief An error condition on the descriptor. Always reported.
+     */
+    static constexpr uint32_t ERROR = EPOLLERR;
+
+    /**
+     * @brief Report readiness only when it changes (edge-triggered) rather
+     * than for as long as it lasts (level-triggered).
+     */
+    static constexpr uint32_t EDGE = EPOLLET;
+
+    /**
+     * @brief Disarm the descriptor after reporting it once.
+     */
+    static constexpr uint32_t ONESHOT = EPOLLONESHOT;
+
+    /**
+     * @brief A readiness notification.
+     */
+    struct Event {
+
+        /**
+         * @brief The tag given when the descriptor was registered.
+         */
+        uint64_t tag;
+
+        /**
+         * @brief The events that occurred.
+         */
+        uint32_t events;
+    };
+
+    /**
+     * @brief Construct a new Reactor object.
+     */
+    Reactor();
+
+    Reactor(const Reactor &) = delete;
+
+    Reactor(Reactor &&rhs)
+    :   _fd(rhs._fd)
+    {
+        rhs._fd = -1;
+    }
+
+    ~Reactor();
+
+    Reactor & operator=(const Reactor &) = delete;
+
+    Reactor & operator=(Reactor &&rhs);
+
+    /**
+     * @brief Registers a file descriptor.
+     *
+     * @param fd The file descriptor.
+     * @param events The events of interest and flags; e.g. READ | EDGE.
+     * @param tag A value returned with the notifications of the descriptor.
+     * @return A reference to this object for chaining.
+     */
+    Reactor & add(int fd, uint32_t events, uint64_t tag) {
+        _control(EPOLL_CTL_ADD, fd, events, tag);
+        return *this;
+    }
+
+    /**
+     * @brief Changes the events of interest and tag of a registered file
+     * descriptor. If the descriptor is already ready, it is reported by the
+     * next wait().
+     *
+     * @param fd The file descriptor.
+     * @param events The events of interest and flags.
+     * @param tag A value returned with the notifications of the descriptor.
+     * @return A reference to this object for chaining.
+     */
+    Reactor & modify(int fd, uint32_t events, uint64_t tag) {
+        _control(EPOLL_CTL_MOD, fd, events, tag);
+        return *this;
+    }
+
+    /**
+     * @brief Re-arms a file descriptor, registering it if needed. This is
+     * typically used after a ONESHOT notification has been handled.
+     *
+     * @param fd The file descriptor.
+     * @param events The events of interest and flags.
+     * @param tag A value returned with the notifications of the descriptor.
+     * @return A reference to this object for chaining.
+     */
+    Reactor & arm(int fd, uint32_t events, uint64_t tag);
+
+    /**
+     * @brief Unregisters a file descriptor. Does nothing if the descriptor is
+     * not registered. Closing a descriptor unregisters it implicitly.
+     *
+     * @param fd The file descriptor.
+     * @return A reference to this object for chaining.
+     */
+    Reactor & remove(int fd);
+
+    /**
+     * @brief Waits for registered descriptors to become ready.
+     *
+     * @param events An array receiving the notifications.
+     * @param maxCount The capacity of the array.
+     * @param timeoutMillis Timeout in milliseconds, or -1 to wait
+     * indefinitely.
+     * @return The number of notifications received, or 0 if the timeout
+     * expired or the wait was interrupted by a signal.
+     */
+    size_t wait(Event *events, size_t maxCount, int timeoutMillis = -1);
+
+    /**
+     * @return The underlying epoll file descriptor, which is itself readable
+     * when some registered descriptor is ready.
+     */
+    int fd() const {
+        return _fd;
+    }
+};
+
+}
@@ -7,8 +7,12 @@
 
 #include <cstdlib>
 #include <stdint.h>
+#include <vector>
+#include <mutex>
+#include <sys/uio.h>
 #include <factory.h>
 #include <exception.h>
+#include <io_stats.h>
 
 namespace spl {
 
@@ -52,6 +56,82 @@ enum class SerializationLevel : uint8_t {
     COMPRESSED_2,
 };
 
+/**
+ * @brief An enumeration of the wire encodings of integers. This is independent
+ * of the serialization level, and both ends of a stream must agree on it.
+*/
+enum class IntegerEncoding : uint8_t {
+    /**
+     * @brief Integers are written as their native bits, at full width.
+     */
+    FIXED,
+
+    /**
+     * @brief Integers wider than a byte, including container and string
+     * length prefixes, are written as LEB128 varints, signed integers being
+     * zigzag-encoded first. Small values take one or two bytes instead of
+     * four or eight, at the cost of a short encoding loop. Object codes of
+     * Serializable objects are hashes and are always written at full width.
+     */
+    VARINT,
+};
+
+namespace core {
+
+/**
+ * @brief A type trait to check if T is written as a varint under
+ * IntegerEncoding::VARINT.
+ */
+template <typename T>
+struct VarintEncodable
+:   std::integral_constant<bool, std::is_integral<T>::value && (sizeof(T) > 1)>
+{ };
+
+/**
+ * @brief LEB128 and zigzag encoding of integers of up to 64 bits.
+ */
+struct Varint {
+
+    static constexpr size_t MAX_LENGTH = 10;
+
+    template <typename T>
+    static uint64_t zigzag(T x, std::true_type /* signed */) {
+        return ((uint64_t) (int64_t) x << 1) ^ (uint64_t) ((int64_t) x >> 63);
+    }
+
+    template <typename T>
+    static uint64_t zigzag(T x, std::false_type) {
+        return (uint64_t) x;
+    }
+
+    template <typename T>
+    static T unzigzag(uint64_t v, std::true_type /* signed */) {
+        return (T) ((int64_t) (v >> 1) ^ -(int64_t) (v & 1));
+    }
+
+    template <typename T>
+    static T unzigzag(uint64_t v, std::false_type) {
+        return (T) v;
+    }
+
+    /**
+     * @brief Encodes v into out, which must have room for MAX_LENGTH bytes.
+     * 
+     * @return The number of bytes written.
+     */
+    static size_t encode(uint64_t v, uint8_t *out) {
+        size_t n = 0;
+        while (v >= 0x80) {
+            out[n++] = (uint8_t) v | 0x80;
+            v >>= 7;
+        }
+        out[n++] = (uint8_t) v;
+        return n;
+    }
+};
+
+}   // namespace core
+
 /**
  * @brief Base class for all serializable objects.
 */
@@ -169,6 +249,23 @@ protected:
      */
     virtual void _write(const void *data, size_t len) = 0;
 
+    /**
+     * @brief Writes a sequence of data blocks to the underlying stream, in
+     * order. Implementations may override this function to issue a single
+     * vectored write; the default implementation calls _write() for each
+     * block.
+     * 
+     * @param[in] iov Array of data blocks.
+     * @param[in] count Number of data blocks.
+     */
+    virtual void _writev(const iovec *iov, int count) {
+        for (int i = 0; i < count; ++i) {
+            _write(iov[i].iov_base, iov[i].iov_len);
+        }
+    }
+
+    static constexpr size_t _MAX_GATHER_SEGMENTS = 1024;
+
     bool _allocated = false;
     uint8_t *_buf = nullptr;
     size_t _bufSize = 0;
@@ -176,11 +273,27 @@ protected:
     uint8_t *_lockedCursor = nullptr;
     size_t _remaining = 0;
     SerializationLevel _level = SerializationLevel::PLAIN;
+    IntegerEncoding _integerEncoding = IntegerEncoding::FIXED;
     size_t _totalByteCount = 0;
     size_t _alignment = 1;
+    size_t _gatherThreshold = 0;
+    std::vector<iovec> _gathered;
+    uint8_t *_gatherCursor = nullptr;   // start of buffered bytes not yet in _gathered
+    size_t _gatheredBytes = 0;          // referenced bytes in _gathered
 
 private:
 
+    void _gather(const void *data, size_t len) {
+        if (_cursor > _gatherCursor) {
+            _gathered.push_back({ _gatherCursor, (size_t) (_cursor - _gatherCursor) });
+            _gatherCursor = _cursor;
+        }
+        _gathered.push_back({ const_cast<void *>(data), len });
+        _gatheredBytes += len;
+
+        if (_gathered.size() >= _MAX_GATHER_SEGMENTS - 1) flush();
+    }
+
     bool _fit(size_t sz) {
         if (sz <= _remaining) {
             return true;
@@ -191,13 +304,38 @@ private:
         return sz <= _remaining;
     }
 
+    template <typename T>
+    OutputStreamSerializer & _putVarint(const T &x, std::true_type) {
+        uint64_t v = core::Varint::zigzag(x, std::is_signed<T>());
+        size_t n;
+        if (_fit(core::Varint::MAX_LENGTH)) {
+            n = core::Varint::encode(v, _cursor);
+            _cursor += n;
+            _remaining -= n;
+        }
+        else {
+            uint8_t buf[core::Varint::MAX_LENGTH];
+            n = core::Varint::encode(v, buf);
+            _put(buf, n);
+        }
+        _totalByteCount += n;
+        return *this;
+    }
+
+    template <typename T>
+    OutputStreamSerializer & _putVarint(const T &, std::false_type) {
+        return *this;
+    }
+
     void _put(const void *data, size_t len) {
         size_t l;
         while (len > 0) {
             l = _cursor - _buf;
             if (l % _alignment == 0 && ((size_t) data) % _alignment == 0 && len % _alignment == 0) {
                 if (l > 0) flush();
+                IOStats::Op op(IOPath::SERIALIZER_FLUSH);
                 _write(data, len);
+                op.bytes(len);
                 return;
             }
             else {
@@ -223,7 +361,8 @@ public:
         _bufSize(bufferSize),
         _cursor((uint8_t *) buffer),
         _remaining(bufferSize),
-        _level(SerializationLevel::PLAIN)
+        _level(SerializationLevel::PLAIN),
+        _gatherCursor((uint8_t *) buffer)
     { }
 
     /**
@@ -256,17 +395,59 @@ public:
         size_t locked = _lockedCursor == nullptr ? 0 : (_cursor - _lockedCursor);
         size_t len = _cursor - _buf - locked;
 
-        if (len > 0) {
+        if (! _gathered.empty()) {
+            IOStats::Op op(IOPath::SERIALIZER_FLUSH);
+            uint8_t *end = _buf + len;
+            if (end > _gatherCursor) {
+                _gathered.push_back({ _gatherCursor, (size_t) (end - _gatherCursor) });
+            }
+            _writev(_gathered.data(), (int) _gathered.size());
+            op.bytes(_gatheredBytes + len);
+            _gathered.clear();
+            _gatheredBytes = 0;
+        }
+        else if (len > 0) {
+            IOStats::Op op(IOPath::SERIALIZER_FLUSH);
             _write(_buf, len);
+            op.bytes(len);
+        }
 
+        if (len > 0) {
             if (locked > 0) memmove(_buf, _lockedCursor, locked);
             _cursor = _buf + locked;
             if (_lockedCursor != nullptr) _lockedCursor = _buf;
             _remaining = _bufSize - locked;
         }
+        _gatherCursor = _buf;
+        return *this;
+    }
+
+    /**
+     * @brief Enables or disables gather mode. In gather mode, put() payloads of
+     * at least the given size are not copied into the internal buffer; they
+     * are referenced and written, together with the surrounding buffered
+     * data, by a single vectored write on the next flush. A referenced
+     * payload must therefore remain valid and unmodified until then.
+     * Payloads are always copied while the stream is locked.
+     * 
+     * @param[in] threshold The minimum size of a referenced payload, or 0 to
+     * disable gather mode (default).
+     * @return A reference to this object for chaining.
+     */
+    OutputStreamSerializer & setGatherThreshold(size_t threshold) {
+        if (threshold == 0 && _gatherThreshold != 0) flush();
+        _gatherThreshold = threshold;
         return *this;
     }
 
+    /**
+     * @return The minimum size of a payload referenced in gather mode, or 0 if
+     * gather mode is disabled.
+     */
+    size_t gatherThreshold() const {
+        return _gatherThreshold;
+    }
+
     /**
      * @brief Locks the stream cursor in place, preventing any subsequent data
      * from being flushed to the underlying stream before a call to commit() is
@@ -322,6 +503,25 @@ public:
         return _level;
     }
 
+    /**
+     * @brief Sets the encoding of integers. Must match the encoding of the
+     * reading end.
+     * 
+     * @param[in] encoding The integer encoding.
+     * @return A reference to this object for chaining.
+     */
+    OutputStreamSerializer & setIntegerEncoding(IntegerEncoding encoding) {
+        _integerEncoding = encoding;
+        return *this;
+    }
+
+    /**
+     * @return The integer encoding of this serializer.
+     */
+    IntegerEncoding integerEncoding() const {
+        return _integerEncoding;
+    }
+
     /**
      * @brief Writes a block of data.
      * 
@@ -330,7 +530,10 @@ public:
      * @return A reference to this object for chaining.
      */
     OutputStreamSerializer & put(const void *data, size_t len) {
-        if (_fit(len)) {
+        if (_gatherThreshold != 0 && len >= _gatherThreshold && _lockedCursor == nullptr) {
+            _gather(data, len);
+        }
+        else if (_fit(len)) {
             memcpy(_cursor, data, len);
             _cursor += len;
             _remaining -= len;
@@ -343,6 +546,55 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Writes the bits of count consecutive objects of type T obtained
+     * from an iterator. The objects are copied directly into the internal
+     * buffer one run at a time, which is considerably cheaper than writing
+     * them individually. The result is identical to writing each object with
+     * operator<<.
+     * 
+     * @param[in] first An iterator to the first object.
+     * @param[in] count The number of objects to write.
+     * @return A reference to this object for chaining.
+     */
+    template <
+        typename T,
+        typename InputIterator,
+        typename std::enable_if<
+            SupportsTrivialSerialization<T>::value && ! SupportsCustomSerialization<T>::value,
+            int
+        >::type = 0
+    >
+    OutputStreamSerializer & putRange(InputIterator first, size_t count) {
+        if (core::VarintEncodable<T>::value && _integerEncoding == IntegerEncoding::VARINT) {
+            for (; count > 0; --count, ++first) *this << static_cast<const T &>(*first);
+            return *this;
+        }
+        while (count > 0) {
+            size_t n = _remaining / sizeof(T);
+            if (n == 0) {
+                if (! _fit(sizeof(T))) {
+                    // no room for a whole object, fall back to the slow path
+                    *this << static_cast<const T &>(*first);
+                    ++first;
+                    --count;
+                    continue;
+                }
+                n = _remaining / sizeof(T);
+            }
+            if (n > count) n = count;
+
+            for (size_t i = 0; i < n; ++i, ++first) {
+                *((T *) _cursor) = *first;
+                _cursor += sizeof(T);
+            }
+            _remaining -= n * sizeof(T);
+            _totalByteCount += n * sizeof(T);
+            count -= n;
+        }
+        return *this;
+    }
+
     /**
      * @brief Writes the bits of the given object.
      * 
@@ -357,6 +609,21 @@ public:
         >::type = 0
     >
     OutputStreamSerializer & operator<<(const T &x) {
+        if (core::VarintEncodable<T>::value && _integerEncoding == IntegerEncoding::VARINT) {
+            return _putVarint(x, core::VarintEncodable<T>());
+        }
+        return putFixed(x);
+    }
+
+    /**
+     * @brief Writes the bits of the given object at full width, regardless of
+     * the integer encoding.
+     * 
+     * @param[in] x Const reference to an object.
+     * @return A reference to this object for chaining.
+     */
+    template <typename T>
+    OutputStreamSerializer & putFixed(const T &x) {
         if (_fit(sizeof(T))) {
             *((T *) _cursor) = x;
             _cursor += sizeof(T);
@@ -376,7 +643,7 @@ public:
      * @return A reference to this object for chaining.
      */
     OutputStreamSerializer & operator<<(const Serializable &object) {
-        *this << object.objectCode();
+        putFixed(object.objectCode());
         object.writeObject(*this);
         return *this;
     }
@@ -389,10 +656,10 @@ public:
      */
     OutputStreamSerializer & operator<<(const Serializable *object) {
         if (object == nullptr) {
-            *this << (size_t) 0;
+            putFixed((size_t) 0);
         }
         else {
-            *this << object->objectCode();
+            putFixed(object->objectCode());
             object->writeObject(*this);
         }
         return *this;
@@ -409,6 +676,7 @@ private:
 
     size_t _position = 0;
     size_t _length = -1UL;
+    std::mutex _sharedMtx;
 
 protected:
 
@@ -423,6 +691,22 @@ protected:
      */
     virtual void _writeAt(size_t position, const void *data, size_t len) = 0;
 
+    /**
+     * @brief Writes a block of data to the underlying byte range, possibly
+     * concurrently with other calls of this function on disjoint blocks. The
+     * default implementation serializes calls to _writeAt(); implementations
+     * that support concurrent positional writes override it.
+     * 
+     * @param[in] position Byte offset (from the beginning) to where the block
+     * of data should be written.
+     * @param[in] data Const pointer to the data block.
+     * @param[in] len Length of the data block to write.
+     */
+    virtual void _writeAtShared(size_t position, const void *data, size_t len) {
+        std::lock_guard<std::mutex> lk(_sharedMtx);
+        _writeAt(position, data, len);
+    }
+
     /**
      * @return The length of the underlying byte range.
      */
@@ -438,6 +722,37 @@ protected:
         _position += len;
     }
 
+    /**
+     * @brief Writes a sequence of data blocks to the underlying byte range,
+     * contiguously and in order. Implementations may override this function
+     * to issue a single vectored write; the default implementation calls
+     * _writeAt() for each block.
+     * 
+     * @param[in] position Byte offset (from the beginning) to where the first
+     * block of data should be written.
+     * @param[in] iov Array of data blocks.
+     * @param[in] count Number of data blocks.
+     */
+    virtual void _writevAt(size_t position, const iovec *iov, int count) {
+        for (int i = 0; i < count; ++i) {
+            _writeAt(position, iov[i].iov_base, iov[i].iov_len);
+            position += iov[i].iov_len;
+        }
+    }
+
+    void _writev(const iovec *iov, int count) override final {
+        size_t len = 0;
+        for (int i = 0; i < count; ++i) len += iov[i].iov_len;
+
+        if (_position + len > length()) {
+            throw OutOfRangeError(
+                "Attempt to write beyond the available serialization region"
+            );
+        }
+        _writevAt(_position, iov, count);
+        _position += len;
+    }
+
 public:
 
     /**
@@ -503,11 +818,39 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Sets the encoding of integers. Must match the encoding of the
+     * reading end.
+     * 
+     * @param[in] encoding The integer encoding.
+     * @return A reference to this object for chaining.
+     */
+    OutputRandomAccessSerializer & setIntegerEncoding(IntegerEncoding encoding) {
+        OutputStreamSerializer::setIntegerEncoding(encoding);
+        return *this;
+    }
+
+    /**
+     * @brief Enables or disables gather mode. In gather mode, put() payloads of
+     * at least the given size are not copied into the internal buffer; they
+     * are referenced and written, together with the surrounding buffered
+     * data, by a single vectored write on the next flush. A referenced
+     * payload must therefore remain valid and unmodified until then.
+     * 
+     * @param[in] threshold The minimum size of a referenced payload, or 0 to
+     * disable gather mode (default).
+     * @return A reference to this object for chaining.
+     */
+    OutputRandomAccessSerializer & setGatherThreshold(size_t threshold) {
+        OutputStreamSerializer::setGatherThreshold(threshold);
+        return *this;
+    }
+
     /**
      * @return The current position.
      */
     size_t tell() const {
-        return _position + (_cursor - _buf);
+        return _position + _gatheredBytes + (_cursor - _buf);
     }
 
     /**
@@ -528,6 +871,28 @@ public:
         return length() - tell();
     }
 
+    /**
+     * @brief Writes a block of data at some position, bypassing the internal
+     * buffer and leaving the current position unchanged. Several threads may
+     * call this function at once on disjoint blocks, but not concurrently with
+     * any other function of this serializer.
+     * 
+     * @param[in] position Byte offset (from the beginning) to where the block
+     * of data should be written.
+     * @param[in] data Const pointer to the data block.
+     * @param[in] len Length of the data block to write.
+     * @return A reference to this object for chaining.
+     */
+    OutputRandomAccessSerializer & writeAt(size_t position, const void *data, size_t len) {
+        if (position + len > length()) {
+            throw OutOfRangeError(
+                "Attempt to write beyond the available serialization region"
+            );
+        }
+        _writeAtShared(position, data, len);
+        return *this;
+    }
+
     /**
      * @brief Changes the current position.
      * 
@@ -625,7 +990,7 @@ public:
      * @return A reference to this object for chaining.
      */
     OutputRandomAccessSerializer & operator<<(const Serializable &object) {
-        *this << object.objectCode();
+        putFixed(object.objectCode());
         object.writeObject(*this);
         return *this;
     }
@@ -638,10 +1003,10 @@ public:
      */
     OutputRandomAccessSerializer & operator<<(const Serializable *object) {
         if (object == nullptr) {
-            *this << (size_t) 0;
+            putFixed((size_t) 0);
         }
         else {
-            *this << object->objectCode();
+            putFixed(object->objectCode());
             object->writeObject(*this);
         }
         return *this;
@@ -675,8 +1040,10 @@ protected:
     uint8_t *_cursor = nullptr;
     size_t _available = 0;
     SerializationLevel _level = SerializationLevel::PLAIN;
+    IntegerEncoding _integerEncoding = IntegerEncoding::FIXED;
     size_t _totalByteCount = 0;
     size_t _alignment = 1;
+    core::FactoryCache _factories;      // recently read object types
 
 protected:
 
@@ -688,16 +1055,47 @@ protected:
 private:
 
     void _fillBuffer(size_t minLen = 0) {
+        IOStats::Op op(IOPath::SERIALIZER_FILL);
         _available = _read(_buf, minLen, _bufSize);
+        op.bytes(_available);
         _totalByteCount += _available;
         _cursor = _buf;
     }
 
+    template <typename T>
+    InputStreamSerializer & _getVarint(T &x, std::true_type) {
+        uint64_t v = 0;
+        unsigned shift = 0;
+        uint8_t b;
+        do {
+            if (shift >= 7 * core::Varint::MAX_LENGTH) throw InvalidArgument("Malformed varint");
+            if (_available > 0) {
+                b = *_cursor++;
+                --_available;
+            }
+            else {
+                _get(&b, 1);
+            }
+            v |= (uint64_t) (b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+
+        x = core::Varint::unzigzag<T>(v, std::is_signed<T>());
+        return *this;
+    }
+
+    template <typename T>
+    InputStreamSerializer & _getVarint(T &, std::false_type) {
+        return *this;
+    }
+
     void _get(void *data, size_t len) {
         size_t l;
         while (len > 0) {
             if (len >= _bufSize && _available == 0 && ((size_t) data) % _alignment == 0 && len % _alignment == 0) {
+                IOStats::Op op(IOPath::SERIALIZER_FILL);
                 _read(data, len, len);
+                op.bytes(len);
                 _totalByteCount += len;
                 return;
             }
@@ -779,6 +1177,25 @@ public:
         return _level;
     }
 
+    /**
+     * @brief Sets the encoding of integers. Must match the encoding of the
+     * writing end.
+     * 
+     * @param[in] encoding The integer encoding.
+     * @return A reference to this object for chaining.
+     */
+    InputStreamSerializer & setIntegerEncoding(IntegerEncoding encoding) {
+        _integerEncoding = encoding;
+        return *this;
+    }
+
+    /**
+     * @return The integer encoding of this serializer.
+     */
+    IntegerEncoding integerEncoding() const {
+        return _integerEncoding;
+    }
+
     /**
      * @brief Reads a block of data.
      * 
@@ -817,6 +1234,55 @@ public:
         }
     }
 
+    /**
+     * @brief Reads the bits of count consecutive objects of type T and passes
+     * each of them to a consumer function. The objects are consumed directly
+     * from the internal buffer one run at a time, which is considerably
+     * cheaper than reading them individually.
+     * 
+     * @param[in] count The number of objects to read.
+     * @param[in] f A function accepting a const T reference. The reference is
+     * only valid for the duration of the call.
+     * @return A reference to this object for chaining.
+     */
+    template <
+        typename T,
+        typename Consumer,
+        typename std::enable_if<
+            SupportsTrivialSerialization<T>::value && ! SupportsCustomSerialization<T>::value,
+            int
+        >::type = 0
+    >
+    InputStreamSerializer & getRange(size_t count, Consumer f) {
+        if (core::VarintEncodable<T>::value && _integerEncoding == IntegerEncoding::VARINT) {
+            for (; count > 0; --count) {
+                T x;
+                *this >> x;
+                f(static_cast<const T &>(x));
+            }
+            return *this;
+        }
+        while (count > 0) {
+            size_t n = std::min(count, _available / sizeof(T));
+            if (n == 0) {
+                // the next object straddles the buffer boundary
+                typename std::aligned_storage<sizeof(T), alignof(T)>::type x;
+                _get(&x, sizeof(T));
+                f(*reinterpret_cast<const T *>(&x));
+                --count;
+                continue;
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                f(*((const T *) _cursor));
+                _cursor += sizeof(T);
+            }
+            _available -= n * sizeof(T);
+            count -= n;
+        }
+        return *this;
+    }
+
     /**
      * @brief Reads the bits of some object.
      * 
@@ -831,6 +1297,21 @@ public:
         >::type = 0
     >
     InputStreamSerializer & operator>>(T &x) {
+        if (core::VarintEncodable<T>::value && _integerEncoding == IntegerEncoding::VARINT) {
+            return _getVarint(x, core::VarintEncodable<T>());
+        }
+        return getFixed(x);
+    }
+
+    /**
+     * @brief Reads the bits of some object at full width, regardless of the
+     * integer encoding.
+     * 
+     * @param[out] x Reference to an object.
+     * @return A reference to this object for chaining.
+     */
+    template <typename T>
+    InputStreamSerializer & getFixed(T &x) {
         if (sizeof(T) <= _available) {
             x = *((T *) _cursor);
             _cursor += sizeof(T);
@@ -850,7 +1331,7 @@ public:
      */
     InputStreamSerializer & operator>>(Serializable &object) {
         size_t code;
-        *this >> code;
+        getFixed(code);
         object.readObject(*this);
         return *this;
     }
@@ -874,7 +1355,7 @@ public:
     >
     InputStreamSerializer & operator>>(T *&object) {
         size_t code;
-        *this >> code;
+        getFixed(code);
         if (code == 0) {
             if (object != nullptr) {
                 delete object;
@@ -883,7 +1364,7 @@ public:
         }
         else {
             if (object == nullptr) {
-                object = Factory::createObject<T>(code);
+                object = _factories.createObject<T>(code);
             }
             object->readObject(*this);
         }
@@ -901,6 +1382,7 @@ private:
 
     size_t _position = 0;
     size_t _length = -1UL;
+    std::mutex _sharedMtx;
 
 protected:
 
@@ -915,6 +1397,22 @@ protected:
      */
     virtual void _readAt(size_t position, void *data, size_t len) = 0;
 
+    /**
+     * @brief Reads a block of data from the underlying byte range, possibly
+     * concurrently with other calls of this function. The default
+     * implementation serializes calls to _readAt(); implementations that
+     * support concurrent positional reads override it.
+     * 
+     * @param[in] position Byte offset (from the beginning) from where the block
+     * of data should be read.
+     * @param[in] data Pointer to a region of memory used to write data.
+     * @param[in] len The length of data to read.
+     */
+    virtual void _readAtShared(size_t position, void *data, size_t len) {
+        std::lock_guard<std::mutex> lk(_sharedMtx);
+        _readAt(position, data, len);
+    }
+
     /**
      * @return The length of the underlying byte range.
      */
@@ -969,6 +1467,18 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Sets the encoding of integers. Must match the encoding of the
+     * writing end.
+     * 
+     * @param[in] encoding The integer encoding.
+     * @return A reference to this object for chaining.
+     */
+    InputRandomAccessSerializer & setIntegerEncoding(IntegerEncoding encoding) {
+        InputStreamSerializer::setIntegerEncoding(encoding);
+        return *this;
+    }
+
     /**
      * @return The current position.
      */
@@ -994,6 +1504,28 @@ public:
         return length() - tell();
     }
 
+    /**
+     * @brief Reads a block of data from some position, bypassing the internal
+     * buffer and leaving the current position unchanged. Several threads may
+     * call this function at once, but not concurrently with any other
+     * function of this serializer.
+     * 
+     * @param[in] position Byte offset (from the beginning) from where the block
+     * of data should be read.
+     * @param[out] data Pointer to a region of memory used to write data.
+     * @param[in] len The length of data to read.
+     * @return A reference to this object for chaining.
+     */
+    InputRandomAccessSerializer & readAt(size_t position, void *data, size_t len) {
+        if (position + len > length()) {
+            throw OutOfRangeError(
+                "Attempt to read beyond the available serialization region"
+            );
+        }
+        _readAtShared(position, data, len);
+        return *this;
+    }
+
     /**
      * @brief Changes the current position.
      * 
@@ -1091,7 +1623,7 @@ public:
      */
     InputRandomAccessSerializer & operator>>(Serializable &object) {
         size_t code;
-        *this >> code;
+        getFixed(code);
         object.readObject(*this);
         return *this;
     }
@@ -1115,7 +1647,7 @@ public:
     >
     InputRandomAccessSerializer & operator>>(T *&object) {
         size_t code;
-        *this >> code;
+        getFixed(code);
         if (code == 0) {
             if (object != nullptr) {
                 delete object;
@@ -1124,7 +1656,7 @@ public:
         }
         else {
             if (object == nullptr) {
-                object = Factory::createObject<T>(code);
+                object = _factories.createObject<T>(code);
             }
             object->readObject(*this);
         }
@@ -1132,4 +1664,91 @@ public:
     }
 };
 
+namespace core {
+
+/**
+ * @brief An output serializer that collects its data in memory, for writing
+ * it elsewhere as a single block. Used to encode the chunks of a parallel
+ * serialization.
+ */
+class OutputChunkSerializer
+:   public OutputStreamSerializer
+{
+private:
+
+    std::vector<uint8_t> _data;
+
+protected:
+
+    void _write(const void *data, size_t len) override {
+        _data.insert(_data.end(), (const uint8_t *) data, (const uint8_t *) data + len);
+    }
+
+public:
+
+    /**
+     * @param[in] format A serializer whose level and integer encoding to use.
+     */
+    OutputChunkSerializer(const OutputStreamSerializer &format)
+    :   OutputStreamSerializer(64 * 1024)
+    {
+        setLevel(format.level());
+        setIntegerEncoding(format.integerEncoding());
+    }
+
+    /**
+     * @return The data serialized so far, flushing the internal buffer first.
+     */
+    const std::vector<uint8_t> & data() {
+        flush();
+        return _data;
+    }
+};
+
+/**
+ * @brief An input serializer that reads from a block of memory. Used to decode
+ * the chunks of a parallel serialization.
+ */
+class InputChunkSerializer
+:   public InputStreamSerializer
+{
+private:
+
+    const uint8_t *_data;
+    size_t _len;
+    size_t _pos = 0;
+
+protected:
+
+    size_t _read(void *data, size_t minLen, size_t maxLen) override {
+        size_t l = std::min(maxLen, _len - _pos);
+        if (l < minLen) {
+            throw OutOfRangeError(
+                "Attempt to read beyond the available serialization region"
+            );
+        }
+        memcpy(data, _data + _pos, l);
+        _pos += l;
+        return l;
+    }
+
+public:
+
+    /**
+     * @param[in] format A serializer whose level and integer encoding to use.
+     * @param[in] data Const pointer to the block of memory.
+     * @param[in] len Length of the block of memory.
+     */
+    InputChunkSerializer(const InputStreamSerializer &format, const void *data, size_t len)
+    :   InputStreamSerializer(64 * 1024),
+        _data((const uint8_t *) data),
+        _len(len)
+    {
+        setLevel(format.level());
+        setIntegerEncoding(format.integerEncoding());
+    }
+};
+
+}   // namespace core
+
 }   // namespace spl
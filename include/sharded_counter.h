@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+namespace spl {
+
+namespace core {
+
+/**
+ * @brief Assigns every thread a small, stable index used to pick its slot in
+ * sharded counters. Indices are handed out round-robin on first use, so
+ * threads spread evenly over the slots.
+ */
+struct ThreadSlot {
+
+    static size_t index() {
+        static std::atomic<size_t> next(0);
+        static thread_local size_t i = next.fetch_add(1, std::memory_order_relaxed);
+        return i;
+    }
+};
+
+}   // namespace core
+
+/**
+ * @brief A counter split over cache-line padded slots. Each thread updates its
+ * own slot, so concurrent updates from different threads do not contend on a
+ * single cache line; reads add up all slots. Slots may individually go
+ * negative (e.g. when an increment and the matching decrement happen on
+ * different threads), but their sum is always exact once all updates are
+ * done.
+ *
+ * @tparam Slots The number of slots, a power of 2. Threads beyond this many
+ * share slots.
+ */
+template <size_t Slots = 16>
+class ShardedCounter {
+
+    static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Slots must be a power of 2");
+
+private:
+
+    // padded rather than aligned, so that containing objects do not need
+    // over-aligned allocation; each value still sits alone on its cache line
+    struct Slot {
+        std::atomic<int64_t> value;
+        char pad[64 - sizeof(std::atomic<int64_t>)];
+    };
+
+    Slot _slots[Slots];
+
+    std::atomic<int64_t> & _local() {
+        return _slots[core::ThreadSlot::index() & (Slots - 1)].value;
+    }
+
+public:
+
+    /**
+     * @brief Construct a new ShardedCounter object.
+     *
+     * @param value The initial value (default = 0).
+     */
+    ShardedCounter(int64_t value = 0) {
+        store(value);
+    }
+
+    ShardedCounter(const ShardedCounter &rhs)
+    :   ShardedCounter(rhs.load())
+    { }
+
+    ~ShardedCounter() = default;
+
+    ShardedCounter & operator=(const ShardedCounter &rhs) {
+        store(rhs.load());
+        return *this;
+    }
+
+    /**
+     * @brief Adds x to the calling thread's slot.
+     */
+    void add(int64_t x) {
+        _local().fetch_add(x);
+    }
+
+    /**
+     * @return The sum of all slots. Concurrent updates may or may not be
+     * reflected.
+     */
+    int64_t load() const {
+        int64_t sum = 0;
+        for (size_t i = 0; i < Slots; ++i) {
+            sum += _slots[i].value.load();
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Sets the counter to the given value. This function is not safe to
+     * call concurrently with updates.
+     */
+    void store(int64_t value) {
+        _slots[0].value.store(value, std::memory_order_relaxed);
+        for (size_t i = 1; i < Slots; ++i) {
+            _slots[i].value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ShardedCounter & operator=(int64_t value) {
+        store(value);
+        return *this;
+    }
+
+    ShardedCounter & operator++() {
+        add(1);
+        return *this;
+    }
+
+    ShardedCounter & operator--() {
+        add(-1);
+        return *this;
+    }
+
+    void operator++(int) {
+        add(1);
+    }
+
+    void operator--(int) {
+        add(-1);
+    }
+
+    ShardedCounter & operator+=(int64_t x) {
+        add(x);
+        return *this;
+    }
+
+    ShardedCounter & operator-=(int64_t x) {
+        add(-x);
+        return *this;
+    }
+
+    /**
+     * @return The value of the counter, or 0 if concurrent updates make the
+     * sum momentarily negative.
+     */
+    operator size_t() const {
+        int64_t v = load();
+        return v < 0 ? 0 : static_cast<size_t>(v);
+    }
+};
+
+/**
+ * @brief Accumulates values of type T from many threads into cache-line padded
+ * slots, each thread updating its own slot, and combines the slots on read.
+ * Suited to hot-path statistics such as sums, minima, and maxima.
+ *
+ * @tparam T The accumulated type. Must be trivially copyable.
+ * @tparam Op An associative and commutative binary functor combining two
+ * values.
+ * @tparam Slots The number of slots, a power of 2.
+ */
+template <typename T, typename Op = std::plus<T>, size_t Slots = 16>
+class ThreadLocalAccumulator {
+
+    static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Slots must be a power of 2");
+
+private:
+
+    static_assert(sizeof(std::atomic<T>) < 64, "T must fit in a cache line");
+
+    struct Slot {
+        std::atomic<T> value;
+        char pad[64 - sizeof(std::atomic<T>)];
+    };
+
+    Slot _slots[Slots];
+    T _identity;
+    Op _op;
+
+public:
+
+    /**
+     * @brief Construct a new ThreadLocalAccumulator object.
+     *
+     * @param identity The identity value of Op, e.g. 0 for sums.
+     * @param op The combining functor.
+     */
+    ThreadLocalAccumulator(const T &identity = T(), const Op &op = Op())
+    :   _identity(identity),
+        _op(op)
+    {
+        reset();
+    }
+
+    ThreadLocalAccumulator(const ThreadLocalAccumulator &) = delete;
+
+    ThreadLocalAccumulator & operator=(const ThreadLocalAccumulator &) = delete;
+
+    ~ThreadLocalAccumulator() = default;
+
+    /**
+     * @brief Combines x into the calling thread's slot.
+     */
+    void add(const T &x) {
+        std::atomic<T> &slot = _slots[core::ThreadSlot::index() & (Slots - 1)].value;
+        T v = slot.load(std::memory_order_relaxed);
+        while (! slot.compare_exchange_weak(v, _op(v, x), std::memory_order_relaxed));
+    }
+
+    /**
+     * @return All slots combined. Concurrent updates may or may not be
+     * reflected.
+     */
+    T get() const {
+        T res = _identity;
+        for (size_t i = 0; i < Slots; ++i) {
+            res = _op(res, _slots[i].value.load(std::memory_order_relaxed));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Resets all slots to the identity value. This function is not safe
+     * to call concurrently with updates.
+     */
+    void reset() {
+        for (size_t i = 0; i < Slots; ++i) {
+            _slots[i].value.store(_identity, std::memory_order_relaxed);
+        }
+    }
+};
+
+}   // namespace spl
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <file.h>
+#include <serialization.h>
+#include <exception.h>
+#include <string>
+
+namespace spl {
+
+/**
+ * @brief An error to indicate that the other end of a channel has closed it.
+ */
+class ChannelClosedError
+:   public Error
+{
+
+public:
+
+    ChannelClosedError()
+    :   Error("Channel closed")
+    { }
+};
+
+/**
+ * @brief A single-producer, single-consumer byte stream between processes on
+ * the same host, backed by a ring buffer in shared memory (a memfd mapped with
+ * File::map). Data moves with plain memory copies; the kernel is only entered
+ * to sleep and wake a peer (futex) when the ring is empty or full.
+ *
+ * One process creates the channel and passes path() (or fd()) to its peer,
+ * which attaches to the same ring. For several producers, use one channel per
+ * producer.
+ */
+class SharedMemoryChannel {
+
+private:
+
+    struct Header;
+
+    static constexpr int __SPIN_COUNT = 128;
+
+    int _fd = -1;
+    MemoryMapping _mapping;
+    Header *_header = nullptr;
+    uint8_t *_data = nullptr;
+    size_t _capacity = 0;
+
+    void _attach();
+
+    void _waitData(size_t minLen);
+
+    void _waitSpace();
+
+public:
+
+    /**
+     * @brief Construct a new SharedMemoryChannel object with a new ring.
+     *
+     * @param capacity The capacity of the ring in bytes, rounded up to a
+     * power of two and a whole number of pages.
+     */
+    SharedMemoryChannel(size_t capacity);
+
+    /**
+     * @brief Construct a new SharedMemoryChannel object attached to the ring
+     * of another channel.
+     *
+     * @param path The path() of the other channel.
+     */
+    SharedMemoryChannel(const char *path);
+
+    /**
+     * @brief Construct a new SharedMemoryChannel object attached to the ring
+     * of another channel.
+     *
+     * @param path The path() of the other channel.
+     */
+    SharedMemoryChannel(const std::string &path)
+    :   SharedMemoryChannel(path.c_str())
+    { }
+
+    SharedMemoryChannel(const SharedMemoryChannel &) = delete;
+
+    SharedMemoryChannel(SharedMemoryChannel &&rhs)
+    :   _fd(rhs._fd),
+        _mapping(std::move(rhs._mapping)),
+        _header(rhs._header),
+        _data(rhs._data),
+        _capacity(rhs._capacity)
+    {
+        rhs._fd = -1;
+        rhs._header = nullptr;
+        rhs._data = nullptr;
+    }
+
+    ~SharedMemoryChannel();
+
+    SharedMemoryChannel & operator=(const SharedMemoryChannel &) = delete;
+
+    SharedMemoryChannel & operator=(SharedMemoryChannel &&) = delete;
+
+    /**
+     * @return The file descriptor of the shared memory. It may be inherited or
+     * sent to another process to attach to the ring.
+     */
+    int fd() const {
+        return _fd;
+    }
+
+    /**
+     * @return A path through which other processes can attach to the ring.
+     */
+    std::string path() const;
+
+    /**
+     * @return The capacity of the ring in bytes.
+     */
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    /**
+     * @return The number of bytes written but not yet read.
+     */
+    size_t available() const;
+
+    /**
+     * @brief Writes a block of data, waiting for space in the ring as needed.
+     * Must only be called by the producer.
+     *
+     * @param data Pointer to the data.
+     * @param len Length of the data.
+     * @throws ChannelClosedError if the channel has been closed.
+     */
+    void write(const void *data, size_t len);
+
+    /**
+     * @brief Reads some data, waiting until at least minLen bytes are
+     * available. Must only be called by the consumer.
+     *
+     * @param data Pointer to a buffer for the data.
+     * @param minLen The minimum number of bytes to read.
+     * @param maxLen The maximum number of bytes to read.
+     * @throws ChannelClosedError if the channel has been closed before
+     * minLen bytes became available.
+     * @return The number of bytes read.
+     */
+    size_t read(void *data, size_t minLen, size_t maxLen);
+
+    /**
+     * @brief Closes the channel for both ends, waking up any waiting peer.
+     * Data written before closing can still be read.
+     *
+     * @return A reference to this object for chaining.
+     */
+    SharedMemoryChannel & close();
+
+    /**
+     * @return True if either end has closed the channel, false otherwise.
+     */
+    bool closed() const;
+};
+
+/**
+ * @brief An output stream serializer class writing to a SharedMemoryChannel.
+ */
+class OutputSharedMemorySerializer
+:   public OutputStreamSerializer
+{
+
+private:
+
+    SharedMemoryChannel *_channel;
+
+protected:
+
+    void _write(const void *data, size_t len) override {
+        _channel->write(data, len);
+    }
+
+public:
+
+    /**
+     * @brief Construct a new OutputSharedMemorySerializer object.
+     *
+     * @param channel Pointer to the channel. The channel is not destroyed with
+     * the serializer.
+     */
+    OutputSharedMemorySerializer(SharedMemoryChannel *channel)
+    :   _channel(channel)
+    { }
+
+    /**
+     * @brief Construct a new OutputSharedMemorySerializer object.
+     *
+     * @param channel Pointer to the channel. The channel is not destroyed with
+     * the serializer.
+     * @param bufferSize Size of the internal serializer buffer.
+     */
+    OutputSharedMemorySerializer(SharedMemoryChannel *channel, size_t bufferSize)
+    :   OutputStreamSerializer(bufferSize),
+        _channel(channel)
+    { }
+};
+
+/**
+ * @brief An input stream serializer class reading from a SharedMemoryChannel.
+ */
+class InputSharedMemorySerializer
+:   public InputStreamSerializer
+{
+
+private:
+
+    SharedMemoryChannel *_channel;
+
+protected:
+
+    size_t _read(void *data, size_t minLen, size_t maxLen) override {
+        return _channel->read(data, minLen, maxLen);
+    }
+
+public:
+
+    /**
+     * @brief Construct a new InputSharedMemorySerializer object.
+     *
+     * @param channel Pointer to the channel. The channel is not destroyed with
+     * the serializer.
+     */
+    InputSharedMemorySerializer(SharedMemoryChannel *channel)
+    :   _channel(channel)
+    { }
+
+    /**
+     * @brief Construct a new InputSharedMemorySerializer object.
+     *
+     * @param channel Pointer to the channel. The channel is not destroyed with
+     * the serializer.
+     * @param bufferSize Size of the internal serializer buffer.
+     */
+    InputSharedMemorySerializer(SharedMemoryChannel *channel, size_t bufferSize)
+    :   InputStreamSerializer(bufferSize),
+        _channel(channel)
+    { }
+};
+
+}
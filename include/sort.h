@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>       // std::less
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <core/parallel.h>
+
+namespace spl {
+
+namespace core {
+
+static constexpr size_t __SORT_SEQUENTIAL_SIZE = 64 * 1024;  // ranges sorted on a single thread
+static constexpr size_t __MERGE_PIECE_SIZE = 16 * 1024;      // minimum output elements per merge task
+static constexpr size_t __RADIX_BITS = 8;
+static constexpr size_t __RADIX_BUCKETS = 1 << __RADIX_BITS;
+
+/**
+ * @return The number of elements of [first1, first1 + n1) among the first `d`
+ * elements of the stable merge of two sorted ranges, found by binary search
+ * along the merge path.
+ */
+template <typename It1, typename It2, typename Compare>
+size_t mergePathSplit(It1 first1, size_t n1, It2 first2, size_t n2, size_t d, Compare &comp) {
+    size_t lo = d > n2 ? d - n2 : 0;
+    size_t hi = d < n1 ? d : n1;
+    while (lo < hi) {
+        size_t i = (lo + hi) / 2;
+        if (comp(first2[d - i - 1], first1[i])) hi = i;
+        else lo = i + 1;
+    }
+    return lo;
+}
+
+/**
+ * @brief Maps an integral key to an unsigned key of the same width that sorts
+ * in the same order.
+ */
+template <typename K>
+typename std::make_unsigned<K>::type radixKey(K k) {
+    using U = typename std::make_unsigned<K>::type;
+    return std::is_signed<K>::value
+        ? static_cast<U>(static_cast<U>(k) ^ (U(1) << (std::numeric_limits<U>::digits - 1)))
+        : static_cast<U>(k);
+}
+
+/**
+ * @brief Identity key extractor of radixSort().
+ */
+struct RadixIdentity {
+    template <typename T>
+    const T & operator()(const T &x) const {
+        return x;
+    }
+};
+
+template <typename T, typename Compare>
+struct IsRadixSortable
+:   std::integral_constant<
+        bool,
+        std::is_integral<T>::value
+        && ! std::is_same<T, bool>::value
+        && std::is_same<Compare, std::less<T>>::value
+    >
+{ };
+
+}   // namespace core
+
+/**
+ * @brief Merges two sorted ranges into an output range, splitting the output
+ * into pieces merged concurrently. Pieces are cut along the merge path, so
+ * each one merges independent subranges of the inputs. The merge is stable:
+ * of equivalent elements, those of the first range come first.
+ *
+ * @param first1 The beginning of the first sorted range.
+ * @param last1 The end of the first sorted range.
+ * @param first2 The beginning of the second sorted range.
+ * @param last2 The end of the second sorted range.
+ * @param out The beginning of the output range, which must not overlap the
+ * input ranges.
+ * @param comp A functor defining a strict weak order on elements.
+ * @param threads The number of threads, or 0 for as many as available.
+ * @return An iterator past the last element written.
+ */
+template <typename It1, typename It2, typename Out, typename Compare>
+Out parallelMerge(It1 first1, It1 last1, It2 first2, It2 last2, Out out, Compare comp, size_t threads = 0) {
+    size_t n1 = last1 - first1;
+    size_t n2 = last2 - first2;
+    size_t n = n1 + n2;
+
+    threads = core::parallelThreads(threads);
+    size_t pieces = std::min(threads, (n + core::__MERGE_PIECE_SIZE - 1) / core::__MERGE_PIECE_SIZE);
+    if (pieces <= 1) return std::merge(first1, last1, first2, last2, out, comp);
+
+    core::parallelFor(pieces, threads, [&] (size_t p) {
+        size_t d0 = n * p / pieces;
+        size_t d1 = n * (p + 1) / pieces;
+        size_t i0 = core::mergePathSplit(first1, n1, first2, n2, d0, comp);
+        size_t i1 = core::mergePathSplit(first1, n1, first2, n2, d1, comp);
+        std::merge(
+            first1 + i0, first1 + i1,
+            first2 + (d0 - i0), first2 + (d1 - i1),
+            out + d0,
+            comp
+        );
+    });
+    return out + n;
+}
+
+/**
+ * @brief Merges two sorted ranges into an output range concurrently. See
+ * parallelMerge(first1, last1, first2, last2, out, comp, threads).
+ */
+template <typename It1, typename It2, typename Out>
+Out parallelMerge(It1 first1, It1 last1, It2 first2, It2 last2, Out out, size_t threads = 0) {
+    return parallelMerge(
+        first1, last1, first2, last2, out,
+        std::less<typename std::iterator_traits<It1>::value_type>(),
+        threads
+    );
+}
+
+/**
+ * @brief Sorts a range of integers, or of elements by an integral key, with a
+ * least-significant-digit radix sort. Each pass counts digits over chunks
+ * of the range concurrently and then scatters the chunks concurrently, and
+ * passes over digits that all elements share are skipped. The sort is stable
+ * and takes O(n) time per byte of the key.
+ *
+ * @param begin A random access iterator to the beginning of the range.
+ * @param end A random access iterator to the end of the range.
+ * @param key A functor returning the integral key of an element.
+ * @param threads The number of threads, or 0 for as many as available.
+ */
+template <
+    typename It,
+    typename KeyOf,
+    typename std::enable_if<! std::is_integral<KeyOf>::value, int>::type = 0
+>
+void radixSort(It begin, It end, KeyOf key, size_t threads = 0) {
+    using T = typename std::iterator_traits<It>::value_type;
+    using K = typename std::decay<decltype(key(*begin))>::type;
+    using U = typename std::make_unsigned<K>::type;
+
+    static_assert(std::is_integral<K>::value, "radixSort() requires an integral key");
+
+    size_t n = end - begin;
+    if (n < 2) return;
+
+    threads = core::parallelThreads(threads);
+    size_t chunks = std::max<size_t>(1, std::min(threads, n / core::__MERGE_PIECE_SIZE));
+    std::vector<size_t> counts(chunks * core::__RADIX_BUCKETS);
+
+    std::vector<T> buffer(n);
+    bool inBuffer = false;
+
+    for (size_t shift = 0; shift < std::numeric_limits<U>::digits; shift += core::__RADIX_BITS) {
+        auto digit = [&key, shift] (const T &x) -> size_t {
+            return (core::radixKey(key(x)) >> shift) & (core::__RADIX_BUCKETS - 1);
+        };
+
+        std::fill(counts.begin(), counts.end(), 0);
+        auto count = [&] (const T *from, size_t c) {
+            size_t *h = &counts[c * core::__RADIX_BUCKETS];
+            for (size_t i = n * c / chunks, e = n * (c + 1) / chunks; i < e; ++i) ++h[digit(from[i])];
+        };
+        T *from = inBuffer ? buffer.data() : &*begin;
+        T *to = inBuffer ? &*begin : buffer.data();
+        core::parallelFor(chunks, threads, [&] (size_t c) { count(from, c); });
+
+        // a digit all elements share leaves the order as is
+        size_t total = 0;
+        for (size_t c = 0; c < chunks; ++c) total += counts[c * core::__RADIX_BUCKETS + digit(from[0])];
+        if (total == n) continue;
+
+        // chunk c writes its elements of digit b after those of smaller digits
+        // and after those of digit b in chunks before c
+        size_t offset = 0;
+        for (size_t b = 0; b < core::__RADIX_BUCKETS; ++b) {
+            for (size_t c = 0; c < chunks; ++c) {
+                size_t x = counts[c * core::__RADIX_BUCKETS + b];
+                counts[c * core::__RADIX_BUCKETS + b] = offset;
+                offset += x;
+            }
+        }
+
+        core::parallelFor(chunks, threads, [&] (size_t c) {
+            size_t *pos = &counts[c * core::__RADIX_BUCKETS];
+            for (size_t i = n * c / chunks, e = n * (c + 1) / chunks; i < e; ++i) {
+                to[pos[digit(from[i])]++] = std::move(from[i]);
+            }
+        });
+        inBuffer = ! inBuffer;
+    }
+
+    if (inBuffer) {
+        T *from = buffer.data();
+        T *to = &*begin;
+        size_t pieces = std::max<size_t>(1, std::min(threads, n / core::__MERGE_PIECE_SIZE));
+        core::parallelFor(pieces, threads, [&] (size_t p) {
+            std::move(from + n * p / pieces, from + n * (p + 1) / pieces, to + n * p / pieces);
+        });
+    }
+}
+
+/**
+ * @brief Sorts a range of integers with a parallel radix sort. See
+ * radixSort(begin, end, key, threads).
+ */
+template <typename It>
+void radixSort(It begin, It end, size_t threads = 0) {
+    radixSort(begin, end, core::RadixIdentity(), threads);
+}
+
+/**
+ * @brief Sorts a range concurrently. The range is split into one run per
+ * thread, the runs are sorted concurrently, and pairs of sorted runs are then
+ * merged with parallelMerge(), alternating between the range and a buffer
+ * of the same size. Integers sorted in ascending order take the radixSort()
+ * fast path instead. Small ranges are sorted on the calling thread. The sort
+ * is not stable.
+ *
+ * @param begin A random access iterator to the beginning of the range, over
+ * contiguous storage.
+ * @param end A random access iterator to the end of the range.
+ * @param comp A functor defining a strict weak order on elements. The default
+ * functor is std::less.
+ * @param threads The number of threads, or 0 for as many as available.
+ */
+template <
+    typename It,
+    typename Compare = std::less<typename std::iterator_traits<It>::value_type>,
+    typename std::enable_if<
+        ! core::IsRadixSortable<typename std::iterator_traits<It>::value_type, Compare>::value
+    , int>::type = 0
+>
+void parallelSort(It begin, It end, Compare comp = Compare(), size_t threads = 0) {
+    using T = typename std::iterator_traits<It>::value_type;
+
+    size_t n = end - begin;
+    threads = core::parallelThreads(threads);
+    if (threads == 1 || n <= core::__SORT_SEQUENTIAL_SIZE) {
+        std::sort(begin, end, comp);
+        return;
+    }
+
+    size_t runs = std::min(threads, n / core::__SORT_SEQUENTIAL_SIZE);
+    std::vector<size_t> bounds;
+    for (size_t r = 0; r <= runs; ++r) bounds.push_back(n * r / runs);
+
+    core::parallelFor(runs, threads, [&] (size_t r) {
+        std::sort(begin + bounds[r], begin + bounds[r + 1], comp);
+    });
+
+    std::vector<T> buffer(n);
+    T *from = &*begin;
+    T *to = buffer.data();
+
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        for (size_t r = 0; r + 1 < bounds.size(); r += 2) {
+            merged.push_back(bounds[r]);
+            if (r + 2 < bounds.size()) {
+                parallelMerge(
+                    std::make_move_iterator(from + bounds[r]),
+                    std::make_move_iterator(from + bounds[r + 1]),
+                    std::make_move_iterator(from + bounds[r + 1]),
+                    std::make_move_iterator(from + bounds[r + 2]),
+                    to + bounds[r],
+                    comp,
+                    threads
+                );
+            }
+            else {
+                std::move(from + bounds[r], from + bounds[r + 1], to + bounds[r]);
+            }
+        }
+        merged.push_back(n);
+        bounds.swap(merged);
+        std::swap(from, to);
+    }
+
+    if (from != &*begin) {
+        core::parallelFor(runs, threads, [&] (size_t r) {
+            std::move(from + n * r / runs, from + n * (r + 1) / runs, &*begin + n * r / runs);
+        });
+    }
+}
+
+/**
+ * @brief Sorts a range of integers in ascending order concurrently, with
+ * radixSort().
+ *
+ * @param begin A random access iterator to the beginning of the range, over
+ * contiguous storage.
+ * @param end A random access iterator to the end of the range.
+ * @param comp std::less.
+ * @param threads The number of threads, or 0 for as many as available.
+ */
+template <
+    typename It,
+    typename Compare = std::less<typename std::iterator_traits<It>::value_type>,
+    typename std::enable_if<
+        core::IsRadixSortable<typename std::iterator_traits<It>::value_type, Compare>::value
+    , int>::type = 0
+>
+void parallelSort(It begin, It end, Compare comp = Compare(), size_t threads = 0) {
+    radixSort(begin, end, threads);
+}
+
+/**
+ * @brief Sorts an iterable container with contiguous storage concurrently.
+ * See parallelSort(begin, end, comp, threads).
+ */
+template <
+    typename Sequence,
+    typename Compare = std::less<typename std::decay<decltype(*std::declval<Sequence &>().begin())>::type>
+>
+auto parallelSort(Sequence &seq, Compare comp = Compare(), size_t threads = 0)
+-> decltype(seq.begin(), void()) {
+    parallelSort(seq.begin(), seq.end(), comp, threads);
+}
+
+}   // namespace spl
@@ -6,9 +6,17 @@
 #pragma once
 
 #include <serialization.h>
+#include <vector>
+#include <string>
+#include <utility>
+#include <map>
+
+// the operators are declared in namespace spl, so that they are found through
+// argument-dependent lookup from the templates of the library that serialize
+// nested elements, regardless of the order of inclusion
+namespace spl {
 
 // std::vector /////////////////////////////////////////////////////////////////
-#include <vector>
 
 template <typename T>
 spl::OutputStreamSerializer & operator<<(
@@ -57,7 +65,6 @@ spl::InputRandomAccessSerializer & operator>>(
 }
 
 // std::string /////////////////////////////////////////////////////////////////
-#include <string>
 
 inline spl::OutputStreamSerializer & operator<<(
     spl::OutputStreamSerializer &serializer,
@@ -103,7 +110,6 @@ inline spl::InputRandomAccessSerializer & operator>>(
 }
 
 // std::pair ////////////////////////////////////////////////////////////////////
-#include <utility>
 
 template <typename T, typename U>
 spl::OutputStreamSerializer & operator<<(
@@ -148,7 +154,6 @@ spl::InputRandomAccessSerializer & operator>>(
 }
 
 // std::map ////////////////////////////////////////////////////////////////////
-#include <map>
 
 template <typename T, typename U, typename ...V>
 spl::OutputStreamSerializer & operator<<(
@@ -201,3 +206,5 @@ spl::InputRandomAccessSerializer & operator>>(
     );
     return serializer;
 }
+
+} // namespace spl
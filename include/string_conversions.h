@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstring>
 #include <string>
 #include <numeric_types.h>
 #include <exception.h>
@@ -43,12 +44,153 @@ private:
 
     static const uint8 _digitToVal[];
     static const char _valToDigit[];
+    static const char _digitPairs[];
 
     static thread_local char _numBuf[__NUMBER_BUFFER_SIZE];
     static thread_local char _expBuf[__NUMBER_BUFFER_SIZE];
 
+    /**
+     * @brief Writes the decimal digits of val backwards, two digits per step,
+     * ending right before end.
+     *
+     * @return Pointer to the first digit.
+     */
+    template <typename T>
+    static char * _decimalBackward(char *end, T val) {
+        while (val >= 100) {
+            end -= 2;
+            memcpy(end, _digitPairs + 2 * (size_t) (val % 100), 2);
+            val /= 100;
+        }
+        if (val >= 10) {
+            end -= 2;
+            memcpy(end, _digitPairs + 2 * (size_t) val, 2);
+        }
+        else {
+            *--end = (char) val + '0';
+        }
+        return end;
+    }
+
+    /**
+     * @brief The significant digits and decimal exponent of a number,
+     * w * 10^q. At most 19 significant digits are kept in w.
+     */
+    struct _Decimal {
+        uint64 w = 0;
+        int64 q = 0;
+        bool neg = false;
+        bool truncated = false;
+    };
+
+    /**
+     * @return Eight bytes of input as a little-endian word.
+     */
+    static uint64 _loadEight(const char *str) {
+        uint64 v;
+        memcpy(&v, str, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+#endif
+        return v;
+    }
+
+    /**
+     * @return True if all eight bytes of v are decimal digits.
+     */
+    static bool _isEightDigits(uint64 v) {
+        return ((v & 0xf0f0f0f0f0f0f0f0) | (((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) == 0x3333333333333333;
+    }
+
+    /**
+     * @return The value of eight decimal digits, combined pairwise within
+     * the word (SWAR) in three multiplications.
+     */
+    static uint32 _parseEightDigits(uint64 v) {
+        v -= 0x3030303030303030;
+        v = (v * 10) + (v >> 8);
+        v = (((v & 0x000000ff000000ff) * (100 + (1000000ul << 32)))
+            + (((v >> 16) & 0x000000ff000000ff) * (1 + (10000ul << 32)))) >> 32;
+        return (uint32) v;
+    }
+
+    /**
+     * @brief Accumulates the leading decimal digits of [str, end) into x,
+     * eight at a time where possible.
+     *
+     * @return Pointer to the first character that is not a digit, or end.
+     */
+    static const char * _accumulateDecimal(const char *str, const char *end, uint64 &x) {
+        while (end - str >= 8) {
+            uint64 v = _loadEight(str);
+            if (! _isEightDigits(v)) break;
+            x = x * 100000000 + _parseEightDigits(v);
+            str += 8;
+        }
+        while (str < end && (uint8) (*str - '0') < 10) {
+            x = x * 10 + (uint64) (*str - '0');
+            ++str;
+        }
+        return str;
+    }
+
+    /**
+     * @brief Accumulates the leading decimal digits of a null-terminated
+     * string into x, eight at a time where possible.
+     *
+     * @return Pointer to the first character that is not a digit.
+     */
+    static const char * _accumulateDecimal(const char *str, uint64 &x) {
+        // the eight byte loads must not read past the terminator
+        return _accumulateDecimal(str, str + strlen(str), x);
+    }
+
+    static const char * _scanDecimal(const char *str, const char *end, _Decimal &d);
+
+    static void _decimalToFloat(const _Decimal &d, const char *str, size_t len, float32 &x);
+
+    static void _decimalToFloat(const _Decimal &d, const char *str, size_t len, float64 &x);
+
+    static void _decimalToFloat(const _Decimal &d, const char *str, size_t len, float128 &x);
+
+    /**
+     * @brief Parses a base-10 floating point number, correctly rounded.
+     */
+    template <typename T>
+    static T _parseDecimalFloat(const char *str, size_t len, bool check) {
+        _Decimal d;
+        if (_scanDecimal(str, str + len, d) != str + len && check) {
+            throw StringParseError("Unexpected characters encountered");
+        }
+        T x;
+        _decimalToFloat(d, str, len, x);
+        return x;
+    }
+
+    /**
+     * @return The number of decimal digits of val.
+     */
+    template <typename T>
+    static size_t _decimalDigits(T val) {
+        size_t n = 1;
+        while (val >= 10000) {
+            val /= 10000;
+            n += 4;
+        }
+        if (val >= 1000) return n + 3;
+        if (val >= 100) return n + 2;
+        if (val >= 10) return n + 1;
+        return n;
+    }
+
 public:
 
+    /**
+     * @brief The size of a buffer large enough for any of the *_to_chars()
+     * conversions.
+     */
+    static constexpr size_t MAX_CHARS = 32;
+
     /**
      * @brief Parses a numeric string into an unsigned int of type T.
      * Note: this function is unprotected and does not perform any checks on the
@@ -89,6 +231,11 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_unsigned_int_unprotected(const char *str) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            uint64 x = 0;
+            _accumulateDecimal(str, x);
+            return (T) x;
+        }
         T x = 0;
         while (*str != '\0') {
             x = (x * (T) base) + (T) (*str - '0');
@@ -140,6 +287,11 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_unsigned_int_unprotected(const char *str, size_t len) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            uint64 x = 0;
+            _accumulateDecimal(str, str + len, x);
+            return (T) x;
+        }
         auto end = str + len;
         T x = 0;
         while (str < end) {
@@ -190,6 +342,11 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_unsigned_int(const char *str) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            uint64 x = 0;
+            if (*_accumulateDecimal(str, x) != '\0') throw StringNotNumeric();
+            return (T) x;
+        }
         T x = 0;
         while (*str != '\0') {
             if (*str < '0' || *str > '0' + base - 1) throw StringNotNumeric();
@@ -243,6 +400,11 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_unsigned_int(const char *str, size_t len) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            uint64 x = 0;
+            if (_accumulateDecimal(str, str + len, x) != str + len) throw StringNotNumeric();
+            return (T) x;
+        }
         auto end = str + len;
         T x = 0;
         while (str < end) {
@@ -295,6 +457,7 @@ public:
     static const char * unsigned_int_to_str(T val) {
         char *str = _numBuf + __INTEGER_START;
         *str = '\0';
+        if (base == 10) return _decimalBackward(str, val);
         do {
             --str;
             *str = (char) (val % base) + '0';
@@ -303,6 +466,22 @@ public:
         return str;
     }
 
+    /**
+     * @brief Writes the decimal representation of a given unsigned int into a
+     * caller-supplied buffer. The result is not null-terminated.
+     *
+     * @tparam T An unsigned int type.
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param val The unsigned int value to represent.
+     * @return Pointer past the last character written.
+     */
+    template <typename T>
+    static char * unsigned_int_to_chars(char *buf, T val) {
+        char *end = buf + _decimalDigits(val);
+        _decimalBackward(end, val);
+        return end;
+    }
+
     /**
      * @brief Parses a numeric string into a signed int of type T.
      * Note: this function is unprotected and does not perform any checks on the
@@ -349,6 +528,12 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_int_unprotected(const char *str) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            bool neg = *str == '-';
+            uint64 x = 0;
+            _accumulateDecimal(str + neg, x);
+            return (T) (neg ? 0 - x : x);
+        }
         T x = 0;
         bool neg = false;
         if (*str == '-') {
@@ -412,6 +597,12 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_int_unprotected(const char *str, size_t len) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            bool neg = len > 0 && *str == '-';
+            uint64 x = 0;
+            _accumulateDecimal(str + neg, str + len, x);
+            return (T) (neg ? 0 - x : x);
+        }
         auto end = str + len;
         T x = 0;
         bool neg = false;
@@ -474,6 +665,12 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_int(const char *str) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            bool neg = *str == '-';
+            uint64 x = 0;
+            if (*_accumulateDecimal(str + neg, x) != '\0') throw StringNotNumeric();
+            return (T) (neg ? 0 - x : x);
+        }
         T x = 0;
         bool neg = false;
         if (*str == '-') {
@@ -538,6 +735,12 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_int(const char *str, size_t len) {
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            bool neg = len > 0 && *str == '-';
+            uint64 x = 0;
+            if (_accumulateDecimal(str + neg, str + len, x) != str + len) throw StringNotNumeric();
+            return (T) (neg ? 0 - x : x);
+        }
         auto end = str + len;
         T x = 0;
         bool neg = false;
@@ -599,6 +802,14 @@ public:
         bool neg = false;
         char *str = _numBuf +__INTEGER_START;
 
+        if (base == 10 && sizeof(T) <= sizeof(uint64)) {
+            typedef typename std::make_unsigned<T>::type U;
+            *str = '\0';
+            str = _decimalBackward(str, val < 0 ? (U) ((U) 0 - (U) val) : (U) val);
+            if (val < 0) *--str = '-';
+            return str;
+        }
+
         if (val >= 0) val = -val;
         else neg = true;
 
@@ -617,6 +828,25 @@ public:
         return str;
     }
 
+    /**
+     * @brief Writes the decimal representation of a given signed int into a
+     * caller-supplied buffer. The result is not null-terminated.
+     *
+     * @tparam T A signed int type.
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param val The signed int value to represent.
+     * @return Pointer past the last character written.
+     */
+    template <typename T>
+    static char * int_to_chars(char *buf, T val) {
+        typedef typename std::make_unsigned<T>::type U;
+        if (val < 0) {
+            *buf++ = '-';
+            return unsigned_int_to_chars(buf, (U) ((U) 0 - (U) val));
+        }
+        return unsigned_int_to_chars(buf, (U) val);
+    }
+
     /**
      * @brief Parses a numeric string into a floating point of type T.
      * Note: this function is unprotected and does not perform any checks on the
@@ -676,6 +906,7 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_float_unprotected(const char *str) {
+        if (base == 10) return _parseDecimalFloat<T>(str, strlen(str), false);
         T x = 0;
         bool neg = false;
         if (*str == '-') {
@@ -740,7 +971,7 @@ public:
                 f *= (T) 1 / (T) base;
             }
         }
-        if (str < end && *str == 'e' || *str == 'E') {
+        if (str < end && (*str == 'e' || *str == 'E')) {
             ++str;
             x *= pow((T) base, str_to_int_unprotected<int, base>(str, end - str));
         }
@@ -765,6 +996,7 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_float_unprotected(const char *str, size_t len) {
+        if (base == 10) return _parseDecimalFloat<T>(str, len, false);
         auto end = str + len;
         T x = 0;
         bool neg = false;
@@ -785,7 +1017,7 @@ public:
                 f *= (T) 1 / (T) base;
             }
         }
-        if (str < end && *str == 'e' || *str == 'E') {
+        if (str < end && (*str == 'e' || *str == 'E')) {
             ++str;
             x *= pow((T) base, str_to_int_unprotected<int, base>(str, end - str));
         }
@@ -855,6 +1087,7 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_float(const char *str) {
+        if (base == 10) return _parseDecimalFloat<T>(str, strlen(str), true);
         T x = 0;
         bool neg = false;
         if (*str == '-') {
@@ -922,7 +1155,7 @@ public:
                 f *= (T) 1 / (T) base;
             }
         }
-        if (str < end && *str == 'e' || *str == 'E') {
+        if (str < end && (*str == 'e' || *str == 'E')) {
             ++str;
             x *= pow((T) base, str_to_int<int, base>(str, end - str));
         }
@@ -950,6 +1183,7 @@ public:
         typename std::enable_if<(base <= 10), int>::type = 0
     >
     static T str_to_float(const char *str, size_t len) {
+        if (base == 10) return _parseDecimalFloat<T>(str, len, true);
         auto end = str + len;
         T x = 0;
         bool neg = false;
@@ -970,7 +1204,7 @@ public:
                 f *= (T) 1 / (T) base;
             }
         }
-        if (str < end && *str == 'e' || *str == 'E') {
+        if (str < end && (*str == 'e' || *str == 'E')) {
             ++str;
             x *= pow((T) base, str_to_int<int, base>(str, end - str));
         }
@@ -1054,6 +1288,44 @@ public:
         return str;
     }
 
+    /**
+     * @brief Writes the shortest decimal representation of a given floating
+     * point number that parses back to the same value (Ryu algorithm) into a
+     * caller-supplied buffer. Numbers with a decimal exponent in [-6, 21) are
+     * written in fixed notation (e.g. 0.001, 123.45), others in scientific
+     * notation (e.g. 1.5e-7, 1e21). The result is not null-terminated.
+     *
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param val The floating point value to represent.
+     * @return Pointer past the last character written.
+     */
+    static char * float_to_shortest_chars(char *buf, float64 val);
+
+    /**
+     * @brief Writes the shortest decimal representation of a given floating
+     * point number that parses back to the same value (Ryu algorithm) into a
+     * caller-supplied buffer. The result is not null-terminated.
+     *
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param val The floating point value to represent.
+     * @return Pointer past the last character written.
+     */
+    static char * float_to_shortest_chars(char *buf, float32 val);
+
+    /**
+     * @brief Produces the shortest round-trip string representation for a
+     * given floating point number (see float_to_shortest_chars()).
+     *
+     * @param val The floating point value to represent.
+     * @return Pointer to a null terminated string containing the string
+     * representation for val.
+     */
+    template <typename T>
+    static const char * float_to_shortest_str(T val) {
+        *float_to_shortest_chars(_numBuf, val) = '\0';
+        return _numBuf;
+    }
+
     /**
      * @brief Parses a string into a numeric type T.
      * 
@@ -1608,6 +1880,126 @@ public:
     static const char * toStr(float128 num) {
         return float_to_str<float128, precision, fractionPrecision, base>(num);
     }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, uint8 num) {
+        return unsigned_int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, uint16 num) {
+        return unsigned_int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, uint32 num) {
+        return unsigned_int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, uint64 num) {
+        return unsigned_int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, int8 num) {
+        return int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, int16 num) {
+        return int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, int32 num) {
+        return int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the decimal representation for the given number into a
+     * caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, int64 num) {
+        return int_to_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the shortest round-trip representation for the given
+     * number into a caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, float32 num) {
+        return float_to_shortest_chars(buf, num);
+    }
+
+    /**
+     * @brief Writes the shortest round-trip representation for the given
+     * number into a caller-supplied buffer. The result is not null-terminated.
+     * 
+     * @param buf Pointer to a buffer of at least MAX_CHARS bytes.
+     * @param num A number.
+     * @return Pointer past the last character written.
+     */
+    static char * toChars(char *buf, float64 num) {
+        return float_to_shortest_chars(buf, num);
+    }
 };
 
 }   // namespace spl
@@ -5,34 +5,44 @@
 
 #pragma once
 
-#include <condition_variable>
-#include <mutex>
+#include <atomic>
 #include <exception.h>
+#include <core/futex.h>
 
 namespace spl { 
 
 /**
- * @brief Helper class for synchronizing concurrent events.
+ * @brief Helper class for synchronizing concurrent events. The counter is
+ * updated atomically; waiters spin briefly and then sleep on a futex that is
+ * only signaled when some thread is actually asleep.
  */
 class SynchronizationCondition {
 
 private:
 
-    size_t _count;
+    std::atomic<size_t> _count;
     size_t _wakeup;
-    std::mutex _mtx;
-    std::condition_variable _cv;
+    std::atomic<uint32_t> _seq;         // futex word, bumped on every wakeup
+    std::atomic<uint32_t> _waiters;
+
+    bool _reached() const {
+        return _count.load() <= _wakeup;
+    }
 
 public:
 
     SynchronizationCondition()
     :   _count(0),
-        _wakeup(0)
+        _wakeup(0),
+        _seq(0),
+        _waiters(0)
     { }
 
     SynchronizationCondition(size_t wakeupThreshold)
     :   _count(0),
-        _wakeup(wakeupThreshold)
+        _wakeup(wakeupThreshold),
+        _seq(0),
+        _waiters(0)
     { }
 
     SynchronizationCondition(const SynchronizationCondition &) = delete;
@@ -51,8 +61,7 @@ public:
      * @param x The amount to increase.
      */
     void increase(size_t x = 1) {
-        std::unique_lock<std::mutex> lk(_mtx);
-        _count += x;
+        _count.fetch_add(x, std::memory_order_relaxed);
     }
 
     /**
@@ -63,12 +72,14 @@ public:
      * @param x The amount to increase.
      */
     void decrease(size_t x = 1) {
-        std::unique_lock<std::mutex> lk(_mtx);
-        if (x > _count) throw RuntimeError("Attempt to decrease counter beyond 0");
-        _count -= x;
-        if (_count <= _wakeup) {
-            lk.unlock();
-            _cv.notify_all();
+        size_t c = _count.load(std::memory_order_relaxed);
+        do {
+            if (x > c) throw RuntimeError("Attempt to decrease counter beyond 0");
+        } while (! _count.compare_exchange_weak(c, c - x));
+
+        if (c - x <= _wakeup && _waiters.load() > 0) {
+            _seq.fetch_add(1);
+            core::Futex::wake(_seq);
         }
     }
 
@@ -95,8 +106,18 @@ public:
      * wakeup threshold.
      */
     void wait() {
-        std::unique_lock<std::mutex> lk(_mtx);
-        _cv.wait(lk, [this] { return _count <= _wakeup; });
+        for (int i = 0; i < core::Futex::SPIN; ++i) {
+            if (_reached()) return;
+            core::Futex::pause();
+        }
+
+        _waiters.fetch_add(1);
+        for (;;) {
+            uint32_t seq = _seq.load();
+            if (_reached()) break;
+            core::Futex::wait(_seq, seq);
+        }
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
     }
 };
 
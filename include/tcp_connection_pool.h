@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <tcp_socket.h>
+#include <hash_map.h>
+#include <deque.h>
+#include <chrono>
+#include <mutex>
+#include <functional>
+
+namespace spl {
+
+/**
+ * @brief A pool of client TCP connections keyed by remote address. Connections
+ * are handed out as leases and returned to the pool when the lease is
+ * destroyed, so consecutive conversations with the same remote skip the
+ * connection handshake. Idle connections are closed after a timeout, and are
+ * health-checked before being reused.
+ *
+ * Each connection carries a pair of stream serializers, so several requests
+ * may be written before their responses are read (pipelining), saving one
+ * round trip per request.
+ */
+class TCPConnectionPool {
+
+public:
+
+    /**
+     * @brief A function deciding whether an idle connection may be reused. It
+     * is called, after the built-in check that the peer has not closed the
+     * connection, before an idle connection is handed out.
+     */
+    using HealthCheck = std::function<bool(TCPSocket &)>;
+
+private:
+
+    struct Entry {
+        TCPSocket socket;
+        OutputTCPSocketSerializer out;
+        InputTCPSocketSerializer in;
+        std::chrono::steady_clock::time_point lastUsed;
+
+        Entry(const SocketAddress &addr, size_t bufferSize)
+        :   socket(addr),
+            out(&socket, bufferSize),
+            in(&socket, bufferSize)
+        { }
+    };
+
+    struct AddressHash {
+        size_t operator()(const SocketAddress &addr) const;
+    };
+
+    struct AddressEqual {
+        bool operator()(const SocketAddress &lhs, const SocketAddress &rhs) const;
+    };
+
+    mutable std::mutex _mtx;
+    HashMap<SocketAddress, Deque<Entry *>, AddressHash, AddressEqual> _idle;
+    size_t _numIdle = 0;
+    size_t _numConnects = 0;
+
+    size_t _maxIdlePerAddress;
+    std::chrono::steady_clock::duration _idleTimeout;
+    size_t _bufferSize;
+    HealthCheck _healthCheck;
+
+    bool _usable(Entry *e, std::chrono::steady_clock::time_point now);
+
+    void _release(const SocketAddress &addr, Entry *e);
+
+public:
+
+    /**
+     * @brief A lease on a pooled connection. Destroying or releasing the lease
+     * returns the connection to the pool, unless responses to some of its
+     * requests have not been read, in which case the connection is closed.
+     */
+    class Connection {
+        friend class TCPConnectionPool;
+
+    private:
+
+        TCPConnectionPool *_pool = nullptr;
+        Entry *_entry = nullptr;
+        SocketAddress _addr;
+        size_t _pending = 0;
+
+        Connection(TCPConnectionPool *pool, Entry *entry, const SocketAddress &addr)
+        :   _pool(pool),
+            _entry(entry),
+            _addr(addr)
+        { }
+
+    public:
+
+        /**
+         * @brief Construct a new (empty) Connection object.
+         */
+        Connection() = default;
+
+        Connection(const Connection &) = delete;
+
+        Connection(Connection &&rhs)
+        :   _pool(rhs._pool),
+            _entry(rhs._entry),
+            _addr(rhs._addr),
+            _pending(rhs._pending)
+        {
+            rhs._entry = nullptr;
+            rhs._pending = 0;
+        }
+
+        ~Connection() {
+            release();
+        }
+
+        Connection & operator=(const Connection &) = delete;
+
+        Connection & operator=(Connection &&rhs) {
+            if (this != &rhs) {
+                release();
+                _pool = rhs._pool;
+                _entry = rhs._entry; rhs._entry = nullptr;
+                _addr = rhs._addr;
+                _pending = rhs._pending; rhs._pending = 0;
+            }
+            return *this;
+        }
+
+        /**
+         * @return True if this lease holds a connection, false otherwise.
+         */
+        bool valid() const {
+            return _entry != nullptr;
+        }
+
+        /**
+         * @return The remote address of the connection.
+         */
+        const SocketAddress & address() const {
+            return _addr;
+        }
+
+        /**
+         * @return A reference to the underlying socket.
+         */
+        TCPSocket & socket() {
+            return _entry->socket;
+        }
+
+        TCPSocket * operator->() {
+            return &_entry->socket;
+        }
+
+        /**
+         * @return The output serializer of the connection.
+         */
+        OutputTCPSocketSerializer & output() {
+            return _entry->out;
+        }
+
+        /**
+         * @return The input serializer of the connection.
+         */
+        InputTCPSocketSerializer & input() {
+            return _entry->in;
+        }
+
+        /**
+         * @brief Writes a request without waiting for its response. Requests
+         * are buffered until a response is read, or until the output
+         * serializer is flushed.
+         *
+         * @param req The request.
+         * @return A reference to this object for chaining.
+         */
+        template <typename Request>
+        Connection & request(const Request &req) {
+            _entry->out << req;
+            ++_pending;
+            return *this;
+        }
+
+        /**
+         * @brief Reads the response to the oldest outstanding request,
+         * flushing any buffered requests first.
+         *
+         * @param resp The response object to read into.
+         * @throws Error if there are no outstanding requests.
+         * @return A reference to this object for chaining.
+         */
+        template <typename Response>
+        Connection & response(Response &resp) {
+            if (_pending == 0) throw Error("No outstanding requests");
+            _entry->out.flush();
+            _entry->in >> resp;
+            --_pending;
+            return *this;
+        }
+
+        /**
+         * @return The number of requests whose responses have not been read.
+         */
+        size_t pending() const {
+            return _pending;
+        }
+
+        /**
+         * @brief Returns the connection to the pool, or closes it if some
+         * requests are still outstanding. The lease is empty afterwards.
+         */
+        void release();
+
+        /**
+         * @brief Closes the connection instead of returning it to the pool,
+         * e.g. after an error left it in an unknown state. The lease is empty
+         * afterwards.
+         */
+        void discard();
+    };
+
+    /**
+     * @brief Construct a new TCPConnectionPool object.
+     *
+     * @param maxIdlePerAddress The maximum number of idle connections kept per
+     * remote address. Connections returned beyond this limit are closed.
+     * @param idleTimeout The duration after which idle connections are closed.
+     * @param bufferSize Size of the serializer buffers of each connection.
+     */
+    TCPConnectionPool(
+        size_t maxIdlePerAddress = 8,
+        const std::chrono::steady_clock::duration &idleTimeout = std::chrono::seconds(60),
+        size_t bufferSize = 4096
+    )
+    :   _maxIdlePerAddress(maxIdlePerAddress),
+        _idleTimeout(idleTimeout),
+        _bufferSize(bufferSize)
+    { }
+
+    TCPConnectionPool(const TCPConnectionPool &) = delete;
+
+    TCPConnectionPool(TCPConnectionPool &&) = delete;
+
+    /**
+     * @brief Closes all idle connections. The pool must outlive all of its
+     * leases.
+     */
+    ~TCPConnectionPool() {
+        clear();
+    }
+
+    TCPConnectionPool & operator=(const TCPConnectionPool &) = delete;
+
+    TCPConnectionPool & operator=(TCPConnectionPool &&) = delete;
+
+    /**
+     * @brief Sets an additional health check for idle connections.
+     *
+     * @param healthCheck The health check, or an empty function to only use
+     * the built-in check.
+     * @return A reference to this object for chaining.
+     */
+    TCPConnectionPool & setHealthCheck(const HealthCheck &healthCheck) {
+        std::lock_guard<std::mutex> lk(_mtx);
+        _healthCheck = healthCheck;
+        return *this;
+    }
+
+    /**
+     * @brief Leases a connection to the given address, reusing the most
+     * recently used healthy idle connection, if any, and connecting otherwise.
+     *
+     * @param addr The remote address.
+     * @throws ConnectionTimedOutError, ConnectionRefusedError,
+     * NetworkUnreachableError or Error if a new connection could not be made.
+     * @return A lease on the connection.
+     */
+    Connection acquire(const SocketAddress &addr);
+
+    /**
+     * @brief Closes all idle connections whose idle timeout has passed.
+     *
+     * @return A reference to this object for chaining.
+     */
+    TCPConnectionPool & evictIdle();
+
+    /**
+     * @brief Closes all idle connections.
+     *
+     * @return A reference to this object for chaining.
+     */
+    TCPConnectionPool & clear();
+
+    /**
+     * @return The number of idle connections in the pool.
+     */
+    size_t idle() const {
+        std::lock_guard<std::mutex> lk(_mtx);
+        return _numIdle;
+    }
+
+    /**
+     * @return The number of connections the pool has opened so far.
+     */
+    size_t connects() const {
+        std::lock_guard<std::mutex> lk(_mtx);
+        return _numConnects;
+    }
+};
+
+}
@@ -10,8 +10,13 @@
 #include <hash_set.h>
 #include <deque.h>
 #include <serialization.h>
-#include <poll.h>
+#include <reactor.h>
+#include <thread.h>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <exception>
 
 namespace spl {
 
@@ -21,21 +26,54 @@ namespace spl {
 class TCPSocket {
     friend class TCPServerSocket;
 
-protected:
+public:
 
-    static const size_t _INITIAL_SYSCALL_SIZE = 64 * 1024;
-    static const size_t _MAX_MTU = 8192;
+    /**
+     * @brief A function called in place of blocking whenever a send or
+     * receive on a non-blocking socket cannot make progress. It receives the
+     * file descriptor and the events to wait for (Reactor::READ or
+     * Reactor::WRITE), and should return once the descriptor may be ready,
+     * e.g. after registering it with a Reactor and suspending the calling
+     * ThreadPool task until the readiness notification resumes it.
+     */
+    using Waiter = std::function<void(int, uint32_t)>;
 
-    static size_t _MTU;
+protected:
 
-    static void _resizeMTU(size_t oldMTU);
+    static const size_t _INITIAL_SYSCALL_SIZE = 64 * 1024;
+    static const size_t _MIN_CHUNK_SIZE = 512;
+    static const size_t _MAX_CHUNK_SIZE = 1024 * 1024;
 
     int _fd;
     SocketAddress _addr;
+    Waiter _waiter;
+
+    size_t _chunkSize = 0;
+    size_t _zeroCopyThreshold = 0;
+    uint32_t _zeroCopySent = 0;
+    uint32_t _zeroCopyDone = 0;
+
+    size_t _sendChunkSize();
+
+    void _shrinkChunkSize();
+
+    void _send(const void *data, size_t len, int flags, const Waiter *waiter = nullptr);
+
+    void _send(const iovec *iov, int count, int flags, const Waiter *waiter = nullptr);
 
-    void _send(const void *data, size_t len, int flags);
+    ssize_t _recv(void *data, size_t len, bool returnOnBlock, int flags, const Waiter *waiter = nullptr);
 
-    ssize_t _recv(void *data, size_t len, bool returnOnBlock, int flags);
+    void _wait(uint32_t events, const Waiter *waiter) {
+        if (waiter != nullptr) (*waiter)(_fd, events);
+        else waitReady(events);
+    }
+
+    static int _connect(const SocketAddress &addr, const Waiter *waiter);
+
+    template <typename Pool>
+    static Waiter _poolWaiter(Pool &pool) {
+        return [&pool] (int fd, uint32_t events) { pool.awaitReady(fd, events); };
+    }
 
     TCPSocket(int fd, const SocketAddress &addr)
     :   _fd(fd),
@@ -142,9 +180,17 @@ public:
 
     TCPSocket(TCPSocket &&rhs)
     :   _fd(rhs._fd),
-        _addr(std::move(rhs._addr))
+        _addr(std::move(rhs._addr)),
+        _waiter(std::move(rhs._waiter)),
+        _chunkSize(rhs._chunkSize),
+        _zeroCopyThreshold(rhs._zeroCopyThreshold),
+        _zeroCopySent(rhs._zeroCopySent),
+        _zeroCopyDone(rhs._zeroCopyDone)
     {
         rhs._fd = -1;
+        rhs._chunkSize = 0;
+        rhs._zeroCopyThreshold = 0;
+        rhs._zeroCopySent = rhs._zeroCopyDone = 0;
     }
 
     /**
@@ -162,6 +208,11 @@ public:
 
             _fd = rhs._fd; rhs._fd = -1;
             _addr = rhs._addr;
+            _waiter = std::move(rhs._waiter);
+            _chunkSize = rhs._chunkSize; rhs._chunkSize = 0;
+            _zeroCopyThreshold = rhs._zeroCopyThreshold; rhs._zeroCopyThreshold = 0;
+            _zeroCopySent = rhs._zeroCopySent; rhs._zeroCopySent = 0;
+            _zeroCopyDone = rhs._zeroCopyDone; rhs._zeroCopyDone = 0;
         }
         return *this;
     }
@@ -175,7 +226,10 @@ public:
 
     /**
      * @brief Sends a block of data. Throws a ConnectionTerminatedError if the
-     * other end terminated the connection.
+     * other end terminated the connection. If zero-copy sending is enabled and
+     * the block is at least as large as the zero-copy threshold, the block is
+     * sent without copying it into the kernel, and this function returns once
+     * the kernel has released it.
      * 
      * @param data Pointer to data to be sent.
      * @param len Length of the data to be sent.
@@ -186,7 +240,87 @@ public:
      * could not be completed.
      */
     void send(const void *data, size_t len) {
-        _send(data, len, MSG_NOSIGNAL);
+        if (_zeroCopyThreshold > 0 && len >= _zeroCopyThreshold) {
+            sendZeroCopy(data, len);
+            awaitZeroCopy();
+        }
+        else {
+            _send(data, len, MSG_NOSIGNAL);
+        }
+    }
+
+    /**
+     * @brief Sends a block of data without copying it into the kernel, and
+     * returns without waiting for the kernel to release it. The data must not
+     * be modified or freed until zeroCopyPending() drops to 0, e.g. after
+     * awaitZeroCopy(). If zero-copy sending is not enabled, this is
+     * equivalent to send().
+     * 
+     * @param data Pointer to data to be sent.
+     * @param len Length of the data to be sent.
+     * @throws ConnectionTerminatedError if the other end terminated the
+     * connection.
+     * @throws Error if an unexpected error prevents sending.
+     */
+    void sendZeroCopy(const void *data, size_t len) {
+        _send(data, len, _zeroCopyThreshold > 0 ? (MSG_NOSIGNAL | MSG_ZEROCOPY) : MSG_NOSIGNAL);
+    }
+
+    /**
+     * @brief Enables or disables zero-copy sending (SO_ZEROCOPY). Zero-copy
+     * sending pins the pages of the sent data instead of copying them, which
+     * only pays off for large blocks.
+     * 
+     * @param enable Whether to enable zero-copy sending.
+     * @param threshold The minimum size of a block sent by send() for it to
+     * be sent without copying.
+     * @throws Error if the socket does not support zero-copy sending.
+     * @return A reference to this object for chaining.
+     */
+    TCPSocket & setZeroCopy(bool enable = true, size_t threshold = _INITIAL_SYSCALL_SIZE);
+
+    /**
+     * @return True if zero-copy sending is enabled, false otherwise.
+     */
+    bool zeroCopy() const {
+        return _zeroCopyThreshold > 0;
+    }
+
+    /**
+     * @brief Collects the zero-copy completion notifications available
+     * without blocking.
+     * 
+     * @return The number of zero-copy sends still awaiting completion.
+     */
+    size_t zeroCopyPending();
+
+    /**
+     * @brief Blocks until all zero-copy sends have completed, after which the
+     * sent data may be reused.
+     * 
+     * @return A reference to this object for chaining.
+     */
+    TCPSocket & awaitZeroCopy();
+
+    /**
+     * @return The size of the chunks in which large blocks are sent. This is
+     * tuned per socket from its send buffer size and maximum segment size.
+     */
+    size_t sendChunkSize() {
+        return _sendChunkSize();
+    }
+
+    /**
+     * @brief Sends a sequence of data blocks, in order, using vectored sends.
+     * 
+     * @param iov Array of data blocks.
+     * @param count Number of data blocks.
+     * @throws ConnectionTerminatedError if the other end terminated the
+     * connection.
+     * @throws Error if an unexpected error prevents sending.
+     */
+    void send(const iovec *iov, int count) {
+        _send(iov, count, MSG_NOSIGNAL);
     }
 
     /**
@@ -236,6 +370,116 @@ public:
         );
     }
 
+    /**
+     * @brief Sets the function used to wait for readiness when a send or
+     * receive cannot make progress. By default, the calling thread blocks in
+     * poll().
+     * 
+     * @param waiter The wait function, or an empty function to restore the
+     * default.
+     * @return A reference to this object for chaining.
+     */
+    TCPSocket & setWaiter(const Waiter &waiter) {
+        _waiter = waiter;
+        return *this;
+    }
+
+    /**
+     * @brief Waits until the socket is ready for the given events, or has
+     * hung up or failed. Without a timeout, the waiter set by setWaiter() is
+     * used, if any.
+     * 
+     * @param events Reactor::READ, Reactor::WRITE, or both.
+     * @param timeoutMillis Timeout in milliseconds, or -1 to wait
+     * indefinitely.
+     * @return True if the socket may be ready, false if the timeout expired.
+     */
+    bool waitReady(uint32_t events, int timeoutMillis = -1);
+
+    /**
+     * @brief Connects to the indicated address from within a ThreadPool task.
+     * While the connection is being established, the task is suspended with
+     * ThreadPool::awaitReady() rather than blocking its worker. The returned
+     * socket is non-blocking, which the blocking operations also support.
+     * Throws the same errors as TCPSocket(const SocketAddress &).
+     * 
+     * @param pool The pool running the calling task.
+     * @param addr A socket address.
+     * @throws ConnectionTimedOutError if the attempt to connect has timed out.
+     * @throws ConnectionRefusedError if no one is listening on the specified
+     * remote.
+     * @throws NetworkUnreachableError if the remote address is unreachable.
+     * @throws Error if any other error prevents connection.
+     * @return The connected socket.
+     */
+    template <typename Pool>
+    static TCPSocket asyncConnect(Pool &pool, const SocketAddress &addr) {
+        Waiter waiter = _poolWaiter(pool);
+        return TCPSocket(_connect(addr, &waiter), addr);
+    }
+
+    /**
+     * @brief Sends data from within a ThreadPool task, suspending the task
+     * with ThreadPool::awaitReady() whenever the send buffer is full rather
+     * than blocking its worker. Zero-copy sending is not used.
+     * 
+     * @param pool The pool running the calling task.
+     * @param data Pointer to the data to send.
+     * @param len Length of the data.
+     * @throws ConnectionTerminatedError if the other end terminated the
+     * connection.
+     * @throws Error if an unexpected error prevents sending.
+     */
+    template <typename Pool>
+    void asyncSend(Pool &pool, const void *data, size_t len) {
+        Waiter waiter = _poolWaiter(pool);
+        _send(data, len, MSG_NOSIGNAL | MSG_DONTWAIT, &waiter);
+    }
+
+    /**
+     * @brief Sends a sequence of data blocks, in order, from within a
+     * ThreadPool task. See asyncSend(Pool &, const void *, size_t).
+     * 
+     * @param pool The pool running the calling task.
+     * @param iov Array of data blocks.
+     * @param count Number of data blocks.
+     * @throws ConnectionTerminatedError if the other end terminated the
+     * connection.
+     * @throws Error if an unexpected error prevents sending.
+     */
+    template <typename Pool>
+    void asyncSend(Pool &pool, const iovec *iov, int count) {
+        Waiter waiter = _poolWaiter(pool);
+        _send(iov, count, MSG_NOSIGNAL | MSG_DONTWAIT, &waiter);
+    }
+
+    /**
+     * @brief Receives data from within a ThreadPool task, suspending the task
+     * with ThreadPool::awaitReady() whenever no data is available rather than
+     * blocking its worker.
+     * 
+     * @param pool The pool running the calling task.
+     * @param data Pointer to a buffer for writing the data.
+     * @param len Maximum length of data to receive.
+     * @param all If true, the function returns once len bytes of data are
+     * received; otherwise, once any data is received. (default = true)
+     * @throws ConnectionTerminatedError if the other end terminated the
+     * connection.
+     * @throws Error if an unexpected error prevents receiving.
+     * @return Size of the data actually received.
+     */
+    template <typename Pool>
+    ssize_t asyncRecv(Pool &pool, void *data, size_t len, bool all = true) {
+        Waiter waiter = _poolWaiter(pool);
+        if (all) return _recv(data, len, false, MSG_DONTWAIT, &waiter);
+
+        while (true) {
+            ssize_t n = _recv(data, len, true, MSG_DONTWAIT);
+            if (n > 0 || len == 0) return n;
+            waiter(_fd, Reactor::READ);
+        }
+    }
+
     /**
      * @brief Closes the underlying file descriptor.
      */
@@ -243,32 +487,33 @@ public:
 };
 
 /**
- * @brief Helper class for managing server-side TCP connections.
+ * @brief Helper class for managing server-side TCP connections. Cached client
+ * connections are watched by an edge-triggered, one-shot Reactor, so polling
+ * only visits the connections that are ready, and each ready connection is
+ * handed to a single caller until it is returned.
  */
 class TCPServerSocket
 :   public TCPSocket {
 
 private:
 
-    struct PollEntry : pollfd, Hashable {
-
-        PollEntry(int fd)
-        :   pollfd({ fd, POLLIN, 0 })
-        { }
-
-        size_t hash() const {
-            return fd;
-        }
-
-        bool operator==(const PollEntry &rhs) const {
-            return fd == rhs.fd;
-        }
-    };
+    static constexpr size_t __MAX_EVENTS = 64;
+    static constexpr uint32_t __CONNECTION_EVENTS = Reactor::READ | Reactor::HANGUP | Reactor::EDGE | Reactor::ONESHOT;
+    static constexpr uint32_t __LISTEN_EVENTS = Reactor::READ | Reactor::ONESHOT;
 
     parallel::HashMap<int, TCPSocket *> _connections;
-    parallel::HashSet<PollEntry> _pollfds;
+    Reactor _reactor;
+    std::atomic<bool> _accepting;
     Deque<TCPSocket *> _ready;
 
+    TCPSocket _accept(const Waiter *waiter);
+
+    void _setAccepting(bool accepting) {
+        if (_accepting.exchange(accepting) == accepting) return;
+        if (accepting) _reactor.arm(_fd, __LISTEN_EVENTS, _fd);
+        else _reactor.remove(_fd);
+    }
+
     template <typename F>
     void _pollOrAccept(F f, int timeoutMillis) {
 
@@ -279,43 +524,37 @@ private:
             return;
         }
 
-        std::vector<PollEntry> fds(_pollfds.begin(), _pollfds.end());
-        if (fds.empty()) {
+        if (! _accepting && _connections.empty()) {
             throw RuntimeError("No connections to poll");
         }
-        int count = ::poll((pollfd *) fds.data(), fds.size(), timeoutMillis);
 
-        for (auto &p : fds) {
-            if (count == 0) break;
-            if (p.revents == 0) continue;
-            --count;
+        Reactor::Event events[__MAX_EVENTS];
+        size_t count = _reactor.wait(events, __MAX_EVENTS, timeoutMillis);
+
+        for (size_t i = 0; i < count; ++i) {
+            int fd = (int) events[i].tag;
+            uint32_t e = events[i].events;
 
-            if (p.fd == _fd) {
+            if (fd == _fd) {
                 SocketAddress addr;
                 socklen_t len = sizeof(addr);
-                int newFd;
+                int newFd = accept4(_fd, (sockaddr *) &addr, &len, SOCK_NONBLOCK);
 
-                if (
-                    (p.revents & POLLIN) &&
-                    (newFd = accept4(_fd, (sockaddr *) &addr, &len, SOCK_NONBLOCK)) != -1
-                ) {
+                // the listening socket is one-shot so that a single thread
+                // accepts each pending connection
+                if (_accepting) _reactor.arm(_fd, __LISTEN_EVENTS, _fd);
+
+                if (newFd != -1) {
                     auto conn = new TCPSocket(newFd, addr);
                     _connections.put(newFd, conn);
                     f(conn);
                 }
             }
-            else if ((p.revents & POLLIN)) {
-                _pollfds.erase(p.fd);
-                f(_connections.get(p.fd));
+            else if (e & Reactor::READ) {
+                f(_connections.get(fd));
             }
-            else if (
-                (p.revents & POLLHUP)
-                || (p.revents & POLLRDHUP)
-                || (p.revents & POLLERR)
-                || (p.revents & POLLNVAL)
-            ) {
-                _pollfds.erase(p.fd);
-                delete _connections.remove(p.fd);
+            else if (e & (Reactor::HANGUP | Reactor::ERROR)) {
+                delete _connections.remove(fd);
             }
         }
     }
@@ -335,8 +574,11 @@ public:
     TCPServerSocket(TCPServerSocket &&rhs)
     :   TCPSocket(std::move(rhs)),
         _connections(std::move(rhs._connections)),
-        _pollfds(std::move(rhs._pollfds))
-    { }
+        _reactor(std::move(rhs._reactor)),
+        _accepting(rhs._accepting.load())
+    {
+        rhs._accepting = false;
+    }
 
     /**
      * @brief Closes all cached connections and the underlying file descriptor
@@ -350,7 +592,9 @@ public:
         if (this != &rhs) {
             TCPSocket::operator=(std::move(rhs));
             _connections = std::move(rhs._connections);
-            _pollfds = std::move(rhs._pollfds);
+            _reactor = std::move(rhs._reactor);
+            _accepting = rhs._accepting.load();
+            rhs._accepting = false;
         }
         return *this;
     }
@@ -367,7 +611,24 @@ public:
      * 
      * @return A TCPSocket object for the new client connection.
      */
-    TCPSocket accept();
+    TCPSocket accept() {
+        return _accept(nullptr);
+    }
+
+    /**
+     * @brief Accepts a new client connection from within a ThreadPool task.
+     * If no waiting connections are found, the task is suspended with
+     * ThreadPool::awaitReady() until a connection is available, rather than
+     * blocking its worker.
+     * 
+     * @param pool The pool running the calling task.
+     * @return A TCPSocket object for the new, non-blocking client connection.
+     */
+    template <typename Pool>
+    TCPSocket asyncAccept(Pool &pool) {
+        Waiter waiter = _poolWaiter(pool);
+        return _accept(&waiter);
+    }
 
     /**
      * @return The number of currently cached client connections.
@@ -384,7 +645,7 @@ public:
      * @param conn A client connection.
      */
     void returnConnection(TCPSocket *conn) {
-        _pollfds.put(conn->_fd);
+        _reactor.arm(conn->_fd, __CONNECTION_EVENTS, conn->_fd);
     }
 
     /**
@@ -395,7 +656,7 @@ public:
      * @param conn A client connection.
      */
     void closeConnection(TCPSocket *conn) {
-        _pollfds.erase(conn->_fd);
+        // closing the socket also unregisters it
         delete _connections.remove(conn->_fd);
     }
 
@@ -407,7 +668,7 @@ public:
      * @param conn A client connection.
      */
     void detachConnection(TCPSocket *conn) {
-        _pollfds.erase(conn->_fd);
+        _reactor.remove(conn->_fd);
         _connections.erase(conn->_fd);
     }
 
@@ -421,7 +682,7 @@ public:
      */
     template <typename F>
     void poll(F f, int timeoutMillis = 10) {
-        _pollfds.erase(_fd);
+        _setAccepting(false);
         _pollOrAccept(f, timeoutMillis);
     }
 
@@ -446,7 +707,7 @@ public:
      */
     template <typename F>
     void pollOrAccept(F f, int timeoutMillis = 10) {
-        _pollfds.put(_fd);
+        _setAccepting(true);
         _pollOrAccept(f, timeoutMillis);
     }
 
@@ -463,10 +724,128 @@ public:
     // deleted functions
 
     void send(const void *data, size_t len) = delete;
+    void send(const iovec *iov, int count) = delete;
     ssize_t recv(void *data, size_t len, bool block) = delete;
     ssize_t peek(void *data, size_t len, bool block) = delete;
 };
 
+/**
+ * @brief A group of TCPServerSocket objects listening on the same port with
+ * SO_REUSEPORT, each served by its own thread. The kernel distributes incoming
+ * connections among the listeners, and every connection stays with the thread
+ * that accepted it for its whole lifetime, so both accepting and processing
+ * scale across cores without handing connections off between threads.
+ */
+class TCPServerGroup {
+
+public:
+
+    /**
+     * @brief A function called on the thread of a listener when one of its
+     * connections is ready or has just been accepted. The connection should
+     * eventually be returned via returnConnection(), or closed via
+     * closeConnection(), on the given server.
+     */
+    using Handler = std::function<void(TCPServerSocket &, TCPSocket *)>;
+
+private:
+
+    static constexpr int __POLL_TIMEOUT_MILLIS = 10;
+
+    std::vector<TCPServerSocket *> _servers;
+    std::vector<Thread> _threads;
+    std::atomic<bool> _running;
+    std::mutex _errorMtx;
+    std::exception_ptr _error;
+
+    void _serve(TCPServerSocket &server, const Handler &handler);
+
+public:
+
+    /**
+     * @brief Construct a new TCPServerGroup object.
+     * 
+     * @param port Port number to listen on. If 0, an available port is chosen
+     * and shared by all listeners.
+     * @param size The number of listeners and threads.
+     * @param maxWaitingQueueLength The maximum number of allowed waiting
+     * connections per listener.
+     * @param family Socket family to use for the listeners.
+     */
+    TCPServerGroup(in_port_t port, size_t size, int maxWaitingQueueLength, SocketFamily family = SocketFamily::IPV4);
+
+    TCPServerGroup(const TCPServerGroup &) = delete;
+
+    TCPServerGroup(TCPServerGroup &&) = delete;
+
+    /**
+     * @brief Stops the group, then closes all listeners and their connections.
+     */
+    ~TCPServerGroup();
+
+    TCPServerGroup & operator=(const TCPServerGroup &) = delete;
+
+    TCPServerGroup & operator=(TCPServerGroup &&) = delete;
+
+    /**
+     * @brief Starts one thread per listener, each accepting and polling the
+     * connections of its own listener.
+     * 
+     * @param handler The function to call for every ready connection.
+     * @param affinity Optional CPU affinity sets; the thread of listener i is
+     * pinned to affinity[i % affinity.size()].
+     * @return A reference to this object for chaining.
+     */
+    TCPServerGroup & start(const Handler &handler, const std::vector<ThreadAffinitySet> &affinity = {});
+
+    /**
+     * @brief Stops and joins the threads of the group. Connections remain
+     * cached by their listeners. If a thread has terminated with an exception,
+     * the first such exception is rethrown.
+     * 
+     * @return A reference to this object for chaining.
+     */
+    TCPServerGroup & stop();
+
+    /**
+     * @return True if the threads of the group are running, false otherwise.
+     */
+    bool running() const {
+        return _running;
+    }
+
+    /**
+     * @return The number of listeners in the group.
+     */
+    size_t size() const {
+        return _servers.size();
+    }
+
+    /**
+     * @param i The index of a listener.
+     * @return A reference to the listener.
+     */
+    TCPServerSocket & operator[](size_t i) {
+        return *_servers[i];
+    }
+
+    /**
+     * @return The address the group is listening on.
+     */
+    const SocketAddress & address() const {
+        return _servers[0]->address();
+    }
+
+    /**
+     * @return The total number of connections cached by the listeners.
+     */
+    size_t numConnections() const {
+        size_t n = 0;
+        for (auto s : _servers) n += s->numConnections();
+        return n;
+    }
+};
+
 /**
  * @brief An output stream serializer class using TCPSocket objects.
  */
@@ -485,6 +864,10 @@ protected:
         _socket->send(data, len);
     }
 
+    void _writev(const iovec *iov, int count) override {
+        _socket->send(iov, count);
+    }
+
 public:
 
     /**
@@ -559,12 +942,11 @@ protected:
     size_t _read(void *data, size_t minLen, size_t maxLen) override {
         size_t l = 0;
 
-        do {
-            l += _socket->recv(data, maxLen, false);
-            if (l < minLen) sched_yield();
-        } while (l < minLen);
-
-        return l;
+        while (true) {
+            l += _socket->recv((uint8_t *) data + l, maxLen - l, false);
+            if (l >= minLen) return l;
+            _socket->waitReady(Reactor::READ);
+        }
     }
 
 public:
@@ -7,8 +7,9 @@
 
 #include <functional>
 #include <pthread.h>
-#include <semaphore.h>
 #include <exception.h>
+#include <core/futex.h>
+#include <core/numa.h>
 #include <sys/sysinfo.h>
 #include <atomic>
 
@@ -58,6 +59,30 @@ public:
     bool contains(int cpu) const {
         return CPU_ISSET(cpu, &_cpus);
     }
+
+    /**
+     * @return The number of CPUs in this set.
+     */
+    size_t count() const {
+        return CPU_COUNT(&_cpus);
+    }
+
+    /**
+     * @return The number of NUMA nodes in the system, at least 1.
+     */
+    static size_t numaNodes() {
+        return core::Numa::nodes();
+    }
+
+    /**
+     * @param node A NUMA node, less than numaNodes().
+     * @return The set of CPUs of the given NUMA node.
+     */
+    static ThreadAffinitySet ofNode(size_t node) {
+        ThreadAffinitySet set;
+        for (int cpu : core::Numa::cpus(node)) set.add(cpu);
+        return set;
+    }
 };
 
 /**
@@ -373,12 +398,34 @@ public:
 };
 
 /**
- * @brief Class for counting sempahores.
+ * @brief Class for counting sempahores. The value is an atomic word that is
+ * also used as a futex: uncontended wait() and notify() calls never enter the
+ * kernel, and waiters spin briefly before sleeping.
  */
 class Semaphore {
 private:
 
-    sem_t _sem;
+    std::atomic<uint32_t> _value;
+    std::atomic<uint32_t> _waiters;
+
+    /**
+     * @brief Decreases the value by 1 if it is greater than 0.
+     */
+    bool _tryAcquire() {
+        uint32_t v = _value.load(std::memory_order_relaxed);
+        while (v > 0) {
+            if (_value.compare_exchange_weak(v, v - 1, std::memory_order_acquire)) return true;
+        }
+        return false;
+    }
+
+    bool _spin() {
+        for (int i = 0; i < core::Futex::SPIN; ++i) {
+            if (_tryAcquire()) return true;
+            core::Futex::pause();
+        }
+        return false;
+    }
 
 public:
 
@@ -387,38 +434,30 @@ public:
      * 
      * @param value The initial semaphore value (default = 0).
      */
-    Semaphore(int32_t value = 0) {
-        if (sem_init(&_sem, 0, value) != 0) {
-            throw ErrnoRuntimeError();
-        }
-    }
+    Semaphore(int32_t value = 0)
+    :   _value(value),
+        _waiters(0)
+    { }
 
     Semaphore(const Semaphore &) = delete;
 
     Semaphore(Semaphore &&) = delete;
 
-    ~Semaphore() {
-        sem_destroy(&_sem);
-    }
+    ~Semaphore() = default;
 
     Semaphore & operator=(const Semaphore &) = delete;
 
     Semaphore & operator=(Semaphore &&) = delete;
 
     /**
-     * @brief Sets the semaphore value by destroying it and reinitializing.
+     * @brief Sets the semaphore value.
      * Note: this function is not thread safe.
      * 
      * @param value The desired value.
      * @return A refernce to this object for chaining.
      */
     Semaphore & operator=(int32_t value) {
-        if (sem_destroy(&_sem) != 0) {
-            throw ErrnoRuntimeError();
-        }
-        if (sem_init(&_sem, 0, value) != 0) {
-            throw ErrnoRuntimeError();
-        }
+        _value.store(value, std::memory_order_release);
         return *this;
     }
 
@@ -429,7 +468,13 @@ public:
      * 
      */
     void wait() {
-        sem_wait(&_sem);
+        if (_spin()) return;
+
+        _waiters.fetch_add(1);
+        while (! _tryAcquire()) {
+            core::Futex::wait(_value, 0);
+        }
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
     }
 
     /**
@@ -442,10 +487,23 @@ public:
      * occurred.
      */
     bool wait(uint64_t timeoutNanos) {
-        struct timespec t;
-        t.tv_sec = timeoutNanos / 1000000000lu;
-        t.tv_nsec = timeoutNanos % 1000000000lu;
-        return sem_timedwait(&_sem, &t) == 0;
+        if (_spin()) return true;
+
+        uint64_t deadline = core::Futex::now() + timeoutNanos;
+        bool acquired;
+
+        _waiters.fetch_add(1);
+        while (! (acquired = _tryAcquire())) {
+            uint64_t now = core::Futex::now();
+            if (now >= deadline) break;
+            struct timespec t;
+            t.tv_sec = (deadline - now) / 1000000000lu;
+            t.tv_nsec = (deadline - now) % 1000000000lu;
+            core::Futex::wait(_value, 0, &t);
+        }
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
+
+        return acquired;
     }
 
     /**
@@ -455,14 +513,41 @@ public:
      * @return True if the semaphore value was decreased, false otherwise.
      */
     bool tryWait() {
-        return sem_trywait(&_sem) == 0;
+        return _tryAcquire();
+    }
+
+    /**
+     * @brief Decreases the semaphore value by up to count without blocking.
+     * 
+     * @param count The maximum amount to decrease the semaphore value by.
+     * @return The amount the semaphore value was decreased by.
+     */
+    uint32_t tryWait(uint32_t count) {
+        uint32_t v = _value.load(std::memory_order_relaxed);
+        while (v > 0) {
+            uint32_t n = v < count ? v : count;
+            if (_value.compare_exchange_weak(v, v - n, std::memory_order_acquire)) return n;
+        }
+        return 0;
     }
 
     /**
      * @brief Increases the semaphore value by 1.
      */
     void notify() {
-        sem_post(&_sem);
+        _value.fetch_add(1);
+        if (_waiters.load() > 0) core::Futex::wake(_value, 1);
+    }
+
+    /**
+     * @brief Increases the semaphore value by count.
+     * 
+     * @param count The amount to increase the semaphore value by.
+     */
+    void notify(uint32_t count) {
+        if (count == 0) return;
+        _value.fetch_add(count);
+        if (_waiters.load() > 0) core::Futex::wake(_value, count > INT_MAX ? INT_MAX : count);
     }
 };
 
@@ -7,15 +7,31 @@
 
 #include <thread.h>
 #include <deque.h>
+#include <bounded_queue.h>
 #include <list.h>
 #include <exception.h>
 #include <chrono>
 #include <functional>
+#include <initializer_list>
 #include <setjmp.h>
 #include <unistd.h>
-#include <heap.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <hash_set.h>
-#include <ucontext.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <core/work_stealing_deque.h>
+#include <core/timer_wheel.h>
+#include <core/stack_pool.h>
+#include <core/context.h>
+#include <core/numa.h>
+#include <future.h>
+#include <reactor.h>
+#include <thread_pool_metrics.h>
+#include <new>
+#include <vector>
+#include <algorithm>
 
 namespace spl {
 
@@ -41,10 +57,14 @@ private:
 
     // per-context object
     size_t _stackSize;
-    ucontext_t _ctx;
+    core::MachineContext _ctx;
+
+    // per-context, set by the owning pool
+    void *_pool = nullptr;
+    void (*_notify)(void *, void *) = nullptr;
 
     // per-task
-    ucontext_t *_uctx;
+    core::MachineContext *_uctx;
     volatile Status _status;
     std::chrono::high_resolution_clock::time_point _deferTime;
 
@@ -54,13 +74,17 @@ private:
 
     template <typename Task>
     static void _ret() {
-        (*static_cast<Task *>(_task))(*_this);
-        _this->_status = Status::COMPLETE;
+        // the task may have been resumed on another thread, so avoid reading
+        // the per-thread members after it returns
+        ExecutionContext *self = _this;
+        (*static_cast<Task *>(_task))(*self);
+        self->_status = Status::COMPLETE;
         // return to parent context
+        core::MachineContext::jump(self->_ctx);
     }
 
     template <typename Task>
-    void _run(Task *t, ucontext_t *uctx, void *stack = nullptr) {
+    void _run(Task *t, core::MachineContext *uctx, void *stack = nullptr) {
         // set per-task and per-thread members
         _uctx = uctx;
         _task = t;
@@ -68,20 +92,12 @@ private:
 
         // initialize context stack, if a stack is given
         if (stack != nullptr) {
-            // current context
-            getcontext(_uctx);
-
-            // new stack
-            _uctx->uc_stack.ss_sp = stack;
-            _uctx->uc_stack.ss_size = _stackSize;
-            _uctx->uc_link = &_ctx;
-
             // jump into _ret on first swap
-            makecontext(_uctx, _ret<Task>, 0);
+            _uctx->prepare(stack, _stackSize, _ret<Task>);
         }
 
         // swap into task
-        swapcontext(&_ctx, _uctx);
+        core::MachineContext::swap(_ctx, *_uctx);
     }
 
 protected:
@@ -106,7 +122,7 @@ public:
     void resched(bool insert = true) {
         _status = insert ? Status::RESCHED : Status::RESCHED_LATER;
         // jump into _run, never to return
-        setcontext(&_ctx);
+        core::MachineContext::jump(_ctx);
     }
 
     /**
@@ -120,7 +136,7 @@ public:
         _deferTime = std::chrono::high_resolution_clock::now() + duration;
         _status = Status::DEFERRED;
         // jump into _run, never to return
-        setcontext(&_ctx);
+        core::MachineContext::jump(_ctx);
     }
 
     /**
@@ -178,7 +194,7 @@ public:
         _deferTime = std::chrono::high_resolution_clock::now() + duration;
         _status = Status::DEFERRED_SAVED;
         // swap into _run
-        swapcontext(_uctx, &_ctx);
+        core::MachineContext::swap(*_uctx, _ctx);
         // wait is over, go back to task
     }
 
@@ -228,14 +244,24 @@ public:
 
     /**
      * @brief Suspends this task indefinitely until execution is resumed using
-     * ThreadPool::resume(Task *).
+     * ThreadPool::resume(Task *), ThreadPool::notify(Task *), or a
+     * ResumeHandle.
      */
     void suspend() {
         _status = Status::SUSPENDED;
         // swap into _run
-        swapcontext(_uctx, &_ctx);
+        core::MachineContext::swap(*_uctx, _ctx);
         // suspension is over, go back to task
     }
+
+    /**
+     * @return A handle that resumes this task through
+     * ThreadPool::notify(Task *). The handle may be passed to another thread
+     * before calling suspend(), without racing against it.
+     */
+    ResumeHandle resumeHandle() const {
+        return ResumeHandle(_pool, _task, _notify);
+    }
 };
 
 /**
@@ -252,6 +278,29 @@ public:
     { }
 };
 
+/**
+ * @brief Strategies for distributing tasks among the workers of a ThreadPool.
+ */
+enum class TaskScheduling : int {
+    SHARED_QUEUE,       // all workers take tasks from a single ready queue
+    WORK_STEALING,      // each worker owns a deque of tasks, idle workers steal
+    NUMA_WORK_STEALING, // work stealing with one group of workers pinned to each
+                        // NUMA node; tasks and stacks stay on their node, and
+                        // stealing stays within a node before reaching across
+};
+
+/**
+ * @brief Priority classes of tasks run by a ThreadPool. Workers take
+ * interactive tasks before normal ones, and background tasks only when no
+ * other task is queued, except that a background task is taken at regular
+ * intervals while other tasks keep the workers busy, so that it cannot starve.
+ */
+enum class TaskPriority : int {
+    INTERACTIVE,        // latency-critical tasks, ahead of all others
+    NORMAL,             // the default
+    BACKGROUND,         // bulk work, run when the pool is otherwise idle
+};
+
 /**
  * @brief Class for thread pooling and task scheduling.
  * 
@@ -276,46 +325,54 @@ public:
 
 private:
 
+    /**
+     * @brief The execution state of a task that may be switched out before
+     * completing. Frames live at the top of their stack, which comes from the
+     * pool's StackPool, so that saving and restoring a task never allocates.
+     */
+    struct Frame {
+        core::MachineContext uctx;
+        Context *ctx;
+        void *stack;
+        core::StackPool *stacks;    // the pool the stack came from
+    };
+
     struct QueuedTask {
         Task *task = nullptr;
-        ucontext_t *uctx = nullptr;
-        void *stack = nullptr;
+        Frame *frame = nullptr;
+        TaskPriority priority = TaskPriority::NORMAL;
+#if defined(SPL_THREAD_POOL_METRICS)
+        uint64_t readyTime = 0;     // when the task was last queued as ready
+#endif
 
         QueuedTask() = default;
 
         QueuedTask(Task *task)
         :   task(task),
-            uctx(nullptr),
-            stack(nullptr)
+            frame(nullptr)
         { }
 
-        QueuedTask(Task *task, ucontext_t *uctx, void *stack)
+        QueuedTask(Task *task, TaskPriority priority)
         :   task(task),
-            uctx(uctx),
-            stack(stack)
+            frame(nullptr),
+            priority(priority)
         { }
 
-        bool saveContext(ucontext_t *u, void *s) {
-            if (uctx == nullptr) {
-                uctx = u;
-                stack = s;
+        QueuedTask(Task *task, Frame *frame)
+        :   task(task),
+            frame(frame)
+        { }
+
+        bool saveContext(Frame *f) {
+            if (frame == nullptr) {
+                frame = f;
                 return true;
             }
             return false;
         }
 
         bool hasContext() {
-            return uctx != nullptr;
-        }
-
-        void freeContext() {
-            if (stack != nullptr) free(stack);
-            if (uctx != nullptr) delete uctx;
-        }
-
-        void freeAll() {
-            delete task;
-            freeContext();
+            return frame != nullptr;
         }
     };
 
@@ -343,132 +400,619 @@ private:
         }
     };
 
+    /**
+     * @brief Per-worker state under TaskScheduling::WORK_STEALING. Tasks run
+     * from within a worker go to its own deque, which other workers steal from
+     * when they run out of tasks.
+     */
+    struct Worker {
+        ThreadPool *pool = nullptr;
+        size_t node = 0;
+        core::WorkStealingDeque<QueuedTask> tasks;
+    };
+
+    /**
+     * @brief Per-node state under TaskScheduling::NUMA_WORK_STEALING. Tasks
+     * submitted from outside the pool go to the injection queue of a node,
+     * and the workers of that node take them first.
+     */
+    struct Node {
+        parallel::BoundedQueue<QueuedTask> ready;
+        core::StackPool stacks;         // slabs placed on this node
+        size_t firstWorker;
+        size_t numWorkers;
+
+        Node(size_t stackSize, size_t node, size_t firstWorker, size_t numWorkers)
+        :   ready(__READY_QUEUE_CAPACITY),
+            stacks(stackSize, 16, node),
+            firstWorker(firstWorker),
+            numWorkers(numWorkers)
+        { }
+    };
+
+    static thread_local Worker *_current;
+
     List<Thread> _threads;
-    size_t _stackSize;
-    parallel::Deque<QueuedTask> _tasks;
+    core::StackPool _stacks;
+    parallel::BoundedQueue<QueuedTask> _ready;  // ready queue; the injection queue when work stealing
+    parallel::Deque<QueuedTask> _tasks;         // ready queue overflow, and expired timers
+    parallel::Deque<QueuedTask> _interactive;   // TaskPriority::INTERACTIVE tasks
+    parallel::Deque<QueuedTask> _background;    // TaskPriority::BACKGROUND tasks
+    Worker *_workers = nullptr;
+    size_t _numWorkers = 0;
+    std::vector<Node *> _nodes;                 // empty unless NUMA_WORK_STEALING
+    std::atomic_size_t _idle;
+    std::mutex _idleMtx;
+    std::condition_variable _idleCv;
+    core::TimerWheel<QueuedTask> _timers;   // deferred tasks of all workers
+    std::mutex _timersMtx;
+    std::atomic_size_t _numTimers;
     parallel::HashMultiSet<QueuedTask, QueuedTaskHash, QueuedTaskEqual> _suspendedTasks;
+    std::mutex _notifyMtx;                      // orders notify() and suspension
+    HashSet<Task *> _notified;                  // notified before suspending
+    Reactor _reactor;                           // descriptors awaited by tasks, tagged with the task
+    int _pollWakeFd = -1;                       // eventfd under tag 0 that interrupts a blocking poll
+    std::atomic_size_t _ioWaits;                // tasks waiting for readiness
+    std::atomic_bool _polling;                  // a worker is blocked polling the reactor
+    std::mutex _pollMtx;
     volatile bool _running = false;
     volatile bool _stopping = false;
     uint64_t _dequeueTimeout = 10000UL;
+    std::chrono::nanoseconds _idleTimeout = std::chrono::milliseconds(1);
+#if defined(SPL_THREAD_POOL_METRICS)
+    using Recorder = core::PoolRecorder;
+#else
+    using Recorder = core::NullPoolRecorder;
+#endif
+    Recorder _recorder;                         // per-worker counters, histograms and trace events
+    std::mutex _traceMtx;                       // orders drainTrace() calls
+
+    static constexpr size_t __READY_QUEUE_CAPACITY = 4096;
+    static constexpr size_t __BACKGROUND_INTERVAL = 32;    // tasks a worker runs before a waiting background task
+    static constexpr size_t __IO_POLL_INTERVAL = 64;       // tasks a worker runs between polls of the reactor
+    static constexpr size_t __MAX_IO_EVENTS = 64;
 
-    template <typename Task>
-    struct DeferredTask : QueuedTask {
-        std::chrono::high_resolution_clock::time_point time;
+    /**
+     * @brief Enqueues a task to the back of the ready queue, or of the queue
+     * of its priority class, and wakes an idle worker, if any. Tasks only take
+     * the slower, unbounded overflow queue when the ready queue is full.
+     */
+    void _enqueue(QueuedTask qt) {
+        _recorder.ready(qt);
+        if (qt.priority != TaskPriority::NORMAL) {
+            _lane(qt.priority).enqueue(qt);
+            _wake();
+            return;
+        }
+        if (! _nodes.empty()) {
+            _enqueue(qt, _localNode());
+            return;
+        }
+        if (! _ready.tryEnqueue(qt)) _tasks.enqueue(qt);
+        _wake();
+    }
 
-        DeferredTask() = default;
+    /**
+     * @brief Enqueues a batch of tasks of the same priority class with a
+     * single lock, at most, and a single wakeup of the idle workers.
+     */
+    void _enqueueAll(std::vector<QueuedTask> &batch, TaskPriority priority) {
+        if (batch.empty()) return;
 
-        DeferredTask(QueuedTask t, std::chrono::high_resolution_clock::time_point time)
-        :   QueuedTask(t),
-            time(time)
-        { }
+        if (priority != TaskPriority::NORMAL) {
+            _lane(priority).enqueueAll(batch.begin(), batch.end());
+        }
+        else if (_current != nullptr && _current->pool == this) {
+            for (const QueuedTask &qt : batch) _current->tasks.push(qt);
+        }
+        else {
+            parallel::BoundedQueue<QueuedTask> &ready = _nodes.empty() ? _ready : _nodes[_localNode()]->ready;
+            auto it = batch.begin();
+            while (it != batch.end() && ready.tryEnqueue(*it)) ++it;
+            if (it != batch.end()) _tasks.enqueueAll(it, batch.end());
+        }
 
-        bool operator<(const DeferredTask &rhs) const {
-            return time > rhs.time;
+        if (batch.size() == 1) _wake();
+        else _wakeMany();
+    }
+
+    parallel::Deque<QueuedTask> & _lane(TaskPriority priority) {
+        return priority == TaskPriority::INTERACTIVE ? _interactive : _background;
+    }
+
+    static Task * _newTask(Task *t) {
+        return t;
+    }
+
+    static Task * _newTask(const Task &t) {
+        return new Task(t);
+    }
+
+    /**
+     * @brief Enqueues a task to the back of the injection queue of a node.
+     */
+    void _enqueue(QueuedTask qt, size_t node) {
+        _recorder.ready(qt);
+        if (! _nodes[node]->ready.tryEnqueue(qt)) _tasks.enqueue(qt);
+        _wake();
+    }
+
+    /**
+     * @return The node of the calling worker, or the node the calling thread
+     * runs on if it is not a worker of this pool.
+     */
+    size_t _localNode() const {
+        if (_current != nullptr && _current->pool == this) return _current->node;
+        return core::Numa::currentNode() % _nodes.size();
+    }
+
+    bool _nodeQueuesNonEmpty() const {
+        for (Node *n : _nodes) {
+            if (n->ready.nonEmpty()) return true;
         }
-    };
+        return false;
+    }
 
-    void _worker() {
-        Heap<DeferredTask<Task>> deferredTasks;
+    void _wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_idle.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lk(_idleMtx);
+            _idleCv.notify_one();
+        }
+        else if (_polling.load(std::memory_order_relaxed)) {
+            _interruptPoll();
+        }
+    }
 
-        Context ctx;
-        ctx._stackSize = _stackSize;
+    void _wakeAll() {
+        std::lock_guard<std::mutex> lk(_idleMtx);
+        _idleCv.notify_all();
+    }
 
-        ucontext_t *uctx = new ucontext_t();
-        void *stack = malloc(_stackSize);
+    /**
+     * @brief Wakes all idle workers, if any, after enqueueing several tasks.
+     */
+    void _wakeMany() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_idle.load(std::memory_order_relaxed) > 0) _wakeAll();
+        if (_polling.load(std::memory_order_relaxed)) _interruptPoll();
+    }
 
-        QueuedTask qt;
+    void _interruptPoll() {
+        uint64_t one = 1;
+        if (::write(_pollWakeFd, &one, sizeof(one)) < 0) {
+            // already readable
+        }
+    }
 
-        while (_running || deferredTasks.nonEmpty()) {
-            // check deferred tasks first
-            if (deferredTasks.nonEmpty()) {
-                auto now = std::chrono::high_resolution_clock::now();
+    /**
+     * @brief Polls the reactor and resumes the tasks whose descriptors became
+     * ready. Any worker may poll the reactor; if another worker is already
+     * doing so, this returns immediately. A blocking poll is interrupted when
+     * new tasks are queued.
+     *
+     * @param timeoutMillis The maximum time to block, or 0 not to block.
+     * @return True if the reactor was polled.
+     */
+    bool _pollIo(int timeoutMillis) {
+        if (_ioWaits.load(std::memory_order_relaxed) == 0) return false;
 
-                // time of the next task
-                auto next = deferredTasks.top().time;
+        std::unique_lock<std::mutex> lk(_pollMtx, std::try_to_lock);
+        if (! lk.owns_lock()) return false;
 
-                // if the time of the next task is up
-                if (now >= next) {
-                    // then run the next defferred task
-                    qt = deferredTasks.pop();
-                }
-                else {
-                    // otherwise wait on the ready queue
-                    // If something shows up on the ready queue between now and
-                    // the time of the next task, it gets priority
-                    try {
-                        qt = _tasks.dequeueOrTimeout((next - now).count());
-                    } catch(TimeoutError &) {
-                        // set null to indicate "no task"
-                        qt.task = nullptr;
-                    }
+        if (timeoutMillis != 0) {
+            _polling.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // tasks queued before the flag was raised do not interrupt the poll
+            if (! _running || _hasQueuedTasks()) timeoutMillis = 0;
+        }
+
+        Reactor::Event events[__MAX_IO_EVENTS];
+        size_t count = _reactor.wait(events, __MAX_IO_EVENTS, timeoutMillis);
+        _polling.store(false, std::memory_order_relaxed);
+
+        size_t ready = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (events[i].tag == 0) {
+                uint64_t n;
+                if (::read(_pollWakeFd, &n, sizeof(n)) < 0) {
+                    // drained by an earlier event
                 }
             }
             else {
-                // no deferred tasks, get something from the ready queue or wait
-                qt = _tasks.dequeue();
+                events[ready++] = events[i];
             }
+        }
+        lk.unlock();
+
+        for (size_t i = 0; i < ready; ++i) {
+            _ioWaits.fetch_sub(1, std::memory_order_relaxed);
+            notify(reinterpret_cast<Task *>(events[i].tag));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Blocks the calling thread until a descriptor is ready, for
+     * callers outside this pool's tasks.
+     */
+    static void _blockUntilReady(int fd, uint32_t events) {
+        pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = ((events & Reactor::READ) ? POLLIN : 0) | ((events & Reactor::WRITE) ? POLLOUT : 0);
+        pfd.revents = 0;
+        while (::poll(&pfd, 1, -1) == -1) {
+            if (errno != EINTR) throw ErrnoRuntimeError();
+        }
+    }
+
+    bool _hasQueuedTasks() const {
+        if (_ready.nonEmpty() || _tasks.nonEmpty() || _nodeQueuesNonEmpty()) return true;
+        if (_interactive.nonEmpty() || _background.nonEmpty()) return true;
+        for (size_t i = 0; i < _numWorkers; ++i) {
+            if (! _workers[i].tasks.empty()) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Blocks an idle worker until a task is queued or a timeout
+     * duration passes.
+     */
+    void _idleWait(const std::chrono::nanoseconds &timeout) {
+        std::unique_lock<std::mutex> lk(_idleMtx);
+        _idle.fetch_add(1, std::memory_order_seq_cst);
+        if ((_running || _numTimers > 0) && ! _hasQueuedTasks()) {
+            _idleCv.wait_for(lk, timeout);
+        }
+        _idle.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Inserts a deferred task into the pool-wide timer wheel.
+     */
+    void _defer(const QueuedTask &qt, const std::chrono::high_resolution_clock::time_point &time) {
+        std::lock_guard<std::mutex> lk(_timersMtx);
+        _timers.insert(qt, time);
+        _numTimers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Moves the deferred tasks whose time is up to the front of the
+     * calling worker's queue. Any worker may drain the timer wheel; if another
+     * worker is already doing so, this returns immediately.
+     *
+     * @param id The calling worker.
+     * @param[in,out] timeout Capped to the time left until the next deferred
+     * task is due.
+     */
+    void _expireTimers(size_t id, std::chrono::nanoseconds &timeout) {
+        if (_numTimers.load(std::memory_order_relaxed) == 0) return;
+
+        std::unique_lock<std::mutex> lk(_timersMtx, std::try_to_lock);
+        if (! lk.owns_lock()) return;
+
+        auto now = std::chrono::high_resolution_clock::now();
+        size_t expired = _timers.advance(now, [this, id] (QueuedTask &qt) {
+            _recorder.ready(qt);
+            if (_workers != nullptr) _workers[id].tasks.push(qt);
+            else _tasks.enqueueFront(qt);
+        });
+        auto next = _timers.nextExpiry();
+        lk.unlock();
+
+        if (expired > 0) {
+            _numTimers.fetch_sub(expired, std::memory_order_relaxed);
+            // the calling worker takes one, others may take the rest
+            if (expired > 1) _wake();
+        }
+
+        if (next - now < timeout) {
+            timeout = next > now
+                ? std::chrono::duration_cast<std::chrono::nanoseconds>(next - now)
+                : std::chrono::nanoseconds(0);
+        }
+    }
 
-            // if we got a task
+    /**
+     * @brief Finds a task for a worker. Interactive tasks are tried first,
+     * then normal tasks, then background tasks. Every __BACKGROUND_INTERVAL
+     * tasks a worker finds while background tasks wait, a background task
+     * goes first instead.
+     *
+     * @param[in,out] streak The number of tasks the worker found since it last
+     * took a background task while background tasks were waiting.
+     */
+    bool _findTask(size_t id, uint64_t &seed, size_t &streak, QueuedTask &qt) {
+        if (_background.nonEmpty() && ++streak >= __BACKGROUND_INTERVAL) {
+            streak = 0;
+            qt = _background.tryDequeue(QueuedTask());
+            if (qt.task != nullptr) return true;
+        }
+
+        if (_interactive.nonEmpty()) {
+            qt = _interactive.tryDequeue(QueuedTask());
+            if (qt.task != nullptr) return true;
+        }
+
+        if (_findNormalTask(id, seed, qt)) return true;
+
+        if (_background.nonEmpty()) {
+            qt = _background.tryDequeue(QueuedTask());
             if (qt.task != nullptr) {
+                streak = 0;
+                return true;
+            }
+        }
 
-                if (qt.hasContext()) {
-                    // use the task's saved context and stack
-                    ctx._run(qt.task, qt.uctx);
-                }
-                else {
-                    // use the current context and stack
-                    ctx._run(qt.task, uctx, stack);
-                }
+        return false;
+    }
 
-                switch (ctx._status) {
-                case Context::Status::COMPLETE:
-                    // release all task resources
-                    qt.freeAll();
-                break;
-
-                case Context::Status::RESCHED:
-                    // no longer needed, execution will start from the beginning
-                    qt.freeContext();
-                    // re-enqueue to the back of the ready queue
-                    _tasks.enqueue(qt.task);
-                break;
-
-                case Context::Status::RESCHED_LATER:
-                    // no longer needed, execution will start from the beginning
-                    qt.freeContext();
-                break;
-
-                case Context::Status::DEFERRED:
-                    deferredTasks.push({ qt, ctx._deferTime });
-                break;
-
-                case Context::Status::DEFERRED_SAVED:
-                    // if the task didn't already have a saved context,
-                    // then steal current context & stack and keep them for the task
-                    if (qt.saveContext(uctx, stack)) {
-                        // allocate new context & stack for the next task
-                        uctx = new ucontext_t();
-                        stack = malloc(_stackSize);
-                    }
-                    deferredTasks.push({ qt, ctx._deferTime });
-                break;
-
-                case Context::Status::SUSPENDED:
-                    // if the task didn't already have a saved context,
-                    // then steal current context & stack and keep them for the task
-                    if (qt.saveContext(uctx, stack)) {
-                        // allocate new context & stack for the next task
-                        uctx = new ucontext_t();
-                        stack = malloc(_stackSize);
-                    }
-                    _suspendedTasks.put(qt);
-                break;
+    /**
+     * @brief Finds a task of TaskPriority::NORMAL for a worker. Under
+     * TaskScheduling::WORK_STEALING, the worker's own deque is tried first,
+     * then the injection queue, then the deques of other workers starting at a
+     * random victim.
+     */
+    bool _findNormalTask(size_t id, uint64_t &seed, QueuedTask &qt) {
+        if (_workers != nullptr && _workers[id].tasks.pop(qt)) return true;
+
+        // expired timers and overflowed tasks
+        if (_tasks.nonEmpty()) {
+            qt = _tasks.tryDequeue(QueuedTask());
+            if (qt.task != nullptr) return true;
+        }
+
+        if (! _nodes.empty()) return _findNodeTask(id, seed, qt);
+
+        if (_ready.nonEmpty()) {
+            qt = _ready.tryDequeue(QueuedTask());
+            if (qt.task != nullptr) return true;
+        }
+
+        if (_workers == nullptr) return false;
+
+        // xorshift
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        for (size_t i = 0; i < _numWorkers; ++i) {
+            size_t victim = (seed + i) % _numWorkers;
+            if (victim != id && _workers[victim].tasks.steal(qt)) return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Finds a task for a worker under TaskScheduling::NUMA_WORK_STEALING.
+     * The injection queue and the workers of the worker's own node are tried
+     * first, then those of the other nodes.
+     */
+    bool _findNodeTask(size_t id, uint64_t &seed, QueuedTask &qt) {
+        size_t home = _workers[id].node;
+
+        for (size_t k = 0; k < _nodes.size(); ++k) {
+            Node &n = *_nodes[(home + k) % _nodes.size()];
+
+            if (n.ready.nonEmpty()) {
+                qt = n.ready.tryDequeue(QueuedTask());
+                if (qt.task != nullptr) return true;
+            }
+
+            // xorshift
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+
+            for (size_t i = 0; i < n.numWorkers; ++i) {
+                size_t victim = n.firstWorker + (seed + i) % n.numWorkers;
+                if (victim != id && _workers[victim].tasks.steal(qt)) return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @return A boolean indicating whether a worker must keep running, either
+     * because the pool is running or because some work is still pending.
+     */
+    bool _keepRunning(size_t id) const {
+        return _running
+            || _numTimers.load(std::memory_order_relaxed) > 0
+            || _ready.nonEmpty()
+            || _tasks.nonEmpty()
+            || _interactive.nonEmpty()
+            || _background.nonEmpty()
+            || _nodeQueuesNonEmpty()
+            || (_workers != nullptr && ! _workers[id].tasks.empty());
+    }
+
+    /**
+     * @return The stack pool of the calling worker's node, or the shared one.
+     */
+    core::StackPool & _localStacks() {
+        if (! _nodes.empty() && _current != nullptr && _current->pool == this) {
+            return _nodes[_current->node]->stacks;
+        }
+        return _stacks;
+    }
+
+    Frame * _acquireFrame() {
+        core::StackPool &stacks = _localStacks();
+        void *mem = stacks.allocate();
+        char *top = static_cast<char *>(mem) + stacks.stackSize();
+
+        // context object and frame go at the top, the stack grows down below
+        // them towards the guard page
+        char *ctxAddr = _alignDown(top - sizeof(Context), alignof(Context));
+        char *frameAddr = _alignDown(ctxAddr - sizeof(Frame), alignof(Frame));
+
+        Frame *f = new (frameAddr) Frame();
+        f->ctx = new (ctxAddr) Context();
+        f->ctx->_pool = this;
+        f->ctx->_notify = _notifyTask;
+        f->ctx->_stackSize = _alignDown(frameAddr, 16) - static_cast<char *>(mem);
+        f->stack = mem;
+        f->stacks = &stacks;
+        return f;
+    }
+
+    void _releaseFrame(Frame *f) {
+        void *mem = f->stack;
+        core::StackPool *stacks = f->stacks;
+        f->ctx->~Context();
+        f->~Frame();
+        stacks->release(mem);
+    }
+
+    /**
+     * @brief Parks a suspended task until it is resumed, unless it was
+     * notified while still running, in which case it is re-enqueued.
+     */
+    void _suspend(const QueuedTask &qt) {
+        {
+            std::lock_guard<std::mutex> lock(_notifyMtx);
+            if (! _notified.erase(qt.task)) {
+                _suspendedTasks.put(qt);
+                return;
+            }
+        }
+        _enqueue(qt);
+    }
+
+    static void _notifyTask(void *pool, void *task) {
+        static_cast<ThreadPool *>(pool)->notify(static_cast<Task *>(task));
+    }
+
+    static char * _alignDown(char *p, size_t alignment) {
+        return reinterpret_cast<char *>(reinterpret_cast<uintptr_t>(p) & ~(alignment - 1));
+    }
+
+    void _freeContext(QueuedTask &qt) {
+        if (qt.frame != nullptr) _releaseFrame(qt.frame);
+        qt.frame = nullptr;
+    }
+
+    void _freeAll(QueuedTask &qt) {
+        delete qt.task;
+        _freeContext(qt);
+    }
+
+    /**
+     * @brief Runs a task on the current worker and handles its resulting
+     * status.
+     */
+    void _execute(size_t id, QueuedTask &qt, Frame *&frame) {
+        Context *c;
+        Task *task = qt.task;
+        uint64_t start = _recorder.begin(id, qt, qt.hasContext());
+
+        if (qt.hasContext()) {
+            // use the task's saved context and stack
+            c = qt.frame->ctx;
+            c->_run(qt.task, &qt.frame->uctx);
+        }
+        else {
+            // use the current context and stack
+            c = frame->ctx;
+            c->_run(qt.task, &frame->uctx, frame->stack);
+        }
+
+        if (Recorder::ENABLED) _recorder.end(id, task, _outcome(c->_status), start);
+
+        switch (c->_status) {
+        case Context::Status::COMPLETE:
+            // release all task resources
+            _freeAll(qt);
+        break;
+
+        case Context::Status::RESCHED:
+            // no longer needed, execution will start from the beginning
+            _freeContext(qt);
+            // re-enqueue to the back of the ready queue of its priority class
+            _enqueue(qt);
+        break;
+
+        case Context::Status::RESCHED_LATER:
+            // no longer needed, execution will start from the beginning
+            _freeContext(qt);
+        break;
+
+        case Context::Status::DEFERRED:
+            _defer(qt, c->_deferTime);
+        break;
+
+        case Context::Status::DEFERRED_SAVED:
+            // if the task didn't already have a saved context,
+            // then steal the current frame and keep it for the task, so that
+            // any worker can resume it
+            if (qt.saveContext(frame)) {
+                // take a new frame for the next task from the pool
+                frame = _acquireFrame();
+            }
+            _defer(qt, c->_deferTime);
+        break;
+
+        case Context::Status::SUSPENDED:
+            // if the task didn't already have a saved context,
+            // then steal the current frame and keep it for the task, so that
+            // any worker can resume it
+            if (qt.saveContext(frame)) {
+                // take a new frame for the next task from the pool
+                frame = _acquireFrame();
+            }
+            _suspend(qt);
+        break;
+        }
+    }
+
+    static TraceEvent::Type _outcome(typename Context::Status status) {
+        switch (status) {
+        case Context::Status::COMPLETE: return TraceEvent::Type::END;
+        case Context::Status::RESCHED:
+        case Context::Status::RESCHED_LATER: return TraceEvent::Type::RESCHED;
+        case Context::Status::DEFERRED:
+        case Context::Status::DEFERRED_SAVED: return TraceEvent::Type::DEFER;
+        default: return TraceEvent::Type::SUSPEND;
+        }
+    }
+
+    void _worker(size_t id) {
+        if (_workers != nullptr) _current = &_workers[id];
+
+        Frame *frame = _acquireFrame();
+
+        QueuedTask qt;
+        uint64_t seed = id + 1;
+        size_t streak = 0;
+        size_t executed = 0;
+
+        while (_keepRunning(id)) {
+            std::chrono::nanoseconds timeout = _idleTimeout;
+
+            // deferred tasks that are due get priority
+            _expireTimers(id, timeout);
+
+            if (_findTask(id, seed, streak, qt)) {
+                _execute(id, qt, frame);
+                // a busy pool still resumes the tasks waiting for I/O
+                if (++executed % __IO_POLL_INTERVAL == 0) _pollIo(0);
+            }
+            else {
+                uint64_t since = _recorder.now();
+                if (! _pollIo((int) ((timeout.count() + 999999) / 1000000))) {
+                    _idleWait(timeout);
                 }
+                _recorder.idle(id, since);
             }
         }
 
-        delete uctx;
-        free(stack);
+        _current = nullptr;
+
+        _releaseFrame(frame);
     }
 
 public:
@@ -477,16 +1021,53 @@ public:
      * @brief Construct a new ThreadPool object.
      * 
      * @param size The number of threads in the thread pool.
-     * @param stackSize The size of the stack used for tasks. (default = 16 KiB)
+     * @param stackSize The minimum size of the stack used for tasks. Stacks are
+     * pooled and reused, and overflowing one faults on a guard page.
+     * (default = 16 KiB)
+     * @param scheduling The strategy for distributing tasks among the threads.
+     * Under TaskScheduling::NUMA_WORK_STEALING, the threads are split evenly
+     * over the NUMA nodes (up to one node per thread) and pinned to their
+     * node's CPUs. (default = TaskScheduling::SHARED_QUEUE)
      */
-    ThreadPool(size_t size, size_t stackSize = DEFAULT_STACK_SIZE)
-    :   _stackSize(stackSize)
+    ThreadPool(
+        size_t size,
+        size_t stackSize = DEFAULT_STACK_SIZE,
+        TaskScheduling scheduling = TaskScheduling::SHARED_QUEUE
+    )
+    :   _stacks(stackSize + sizeof(Frame) + sizeof(Context) + 128),
+        _ready(__READY_QUEUE_CAPACITY),
+        _idle(0),
+        _numTimers(0),
+        _ioWaits(0),
+        _polling(false),
+        _recorder(size)
     {
+        _pollWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_pollWakeFd == -1) throw ErrnoRuntimeError();
+        _reactor.add(_pollWakeFd, Reactor::READ, 0);
+
+        if (scheduling != TaskScheduling::SHARED_QUEUE) {
+            _workers = new Worker[size];
+            _numWorkers = size;
+            for (size_t i = 0; i < size; ++i) _workers[i].pool = this;
+        }
+
+        if (scheduling == TaskScheduling::NUMA_WORK_STEALING) {
+            size_t nodes = std::min(core::Numa::nodes(), std::max(size, (size_t) 1));
+            size_t first = 0;
+            for (size_t n = 0; n < nodes; ++n) {
+                size_t count = size / nodes + (n < size % nodes ? 1 : 0);
+                _nodes.push_back(new Node(_stacks.stackSize(), n, first, count));
+                for (size_t i = first; i < first + count; ++i) _workers[i].node = n;
+                first += count;
+            }
+        }
+
         _running = true;
         for (size_t i = 0; i < size; ++i) {
-            _threads.insert(
-                Thread([this] () { _worker(); })
-            );
+            Thread t([this, i] () { _worker(i); });
+            if (! _nodes.empty()) t.setAffinity(ThreadAffinitySet::ofNode(_workers[i].node));
+            _threads.insert(std::move(t));
         }
     }
 
@@ -494,44 +1075,160 @@ public:
 
     ThreadPool(ThreadPool &&) = delete;
 
-    ~ThreadPool() = default;
+    ~ThreadPool() {
+        if (_workers != nullptr) delete[] _workers;
+        for (Node *n : _nodes) delete n;
+        ::close(_pollWakeFd);
+    }
 
     ThreadPool & operator=(const ThreadPool &) = delete;
 
     ThreadPool & operator=(ThreadPool &&) = delete;
 
     /**
-     * @brief Enqueues a task to the back of the ready queue. Throws a
-     * TaskRejectedError if the thread pool is being terminated.
+     * @brief Enqueues a task to the back of the ready queue of its priority
+     * class. Throws a TaskRejectedError if the thread pool is being
+     * terminated. Under TaskScheduling::WORK_STEALING, a normal task run from
+     * within one of this pool's tasks goes to the current worker's own deque
+     * instead, and is accepted even while terminating since the worker drains
+     * its deque before exiting.
+     * 
+     * @param t The task to enqueue.
+     * @param priority The priority class of the task.
+     * (default = TaskPriority::NORMAL)
+     * @throws TaskRejectedError if the thread pool is being terminated.
+     */
+    void run(Task *t, TaskPriority priority = TaskPriority::NORMAL) {
+        if (priority == TaskPriority::NORMAL && _current != nullptr && _current->pool == this) {
+            QueuedTask qt(t);
+            _recorder.ready(qt);
+            _current->tasks.push(qt);
+            _wake();
+            return;
+        }
+        if (_stopping) throw TaskRejectedError();
+        _enqueue(QueuedTask(t, priority));
+    }
+
+    /**
+     * @brief Enqueues a task to the back of the ready queue of its priority
+     * class. Throws a TaskRejectedError if the thread pool is being
+     * terminated.
+     * 
+     * @param t The task to enqueue.
+     * @param priority The priority class of the task.
+     * (default = TaskPriority::NORMAL)
+     * @throws TaskRejectedError if the thread pool is being terminated.
+     */
+    void run(const Task &t, TaskPriority priority = TaskPriority::NORMAL) {
+        run(new Task(t), priority);
+    }
+
+    /**
+     * @brief Enqueues a task to the back of the ready queue of its priority
+     * class. Throws a TaskRejectedError if the thread pool is being
+     * terminated.
+     * 
+     * @param t The task to enqueue.
+     * @param priority The priority class of the task.
+     * (default = TaskPriority::NORMAL)
+     * @throws TaskRejectedError if the thread pool is being terminated.
+     */
+    void run(Task &&t, TaskPriority priority = TaskPriority::NORMAL) {
+        run(new Task(std::move(t)), priority);
+    }
+
+    /**
+     * @brief Enqueues a batch of tasks of the same priority class, in order.
+     * Unlike calling run() for each task, the batch takes at most one lock and
+     * wakes the idle workers once, which makes fanning out many subtasks much
+     * cheaper. Throws a TaskRejectedError if the thread pool is being
+     * terminated, in which case none of the tasks is enqueued.
+     * 
+     * @param begin A beginning iterator over type Task objects, which are
+     * copied, or over pointers to Task objects, which the pool takes
+     * ownership of.
+     * @param end An end iterator.
+     * @param priority The priority class of the tasks.
+     * (default = TaskPriority::NORMAL)
+     * @throws TaskRejectedError if the thread pool is being terminated.
+     */
+    template <typename Begin, typename End>
+    void runAll(const Begin &begin, const End &end, TaskPriority priority = TaskPriority::NORMAL) {
+        bool local = priority == TaskPriority::NORMAL && _current != nullptr && _current->pool == this;
+        if (! local && _stopping) throw TaskRejectedError();
+
+        std::vector<QueuedTask> batch;
+        for (auto it = begin; it != end; ++it) {
+            batch.emplace_back(_newTask(*it), priority);
+            _recorder.ready(batch.back());
+        }
+        _enqueueAll(batch, priority);
+    }
+
+    /**
+     * @brief Enqueues all tasks of an iterable container as a batch. See
+     * runAll(begin, end, priority).
+     * 
+     * @param seq An iterable container of Task objects or pointers.
+     * @param priority The priority class of the tasks.
+     * (default = TaskPriority::NORMAL)
+     * @throws TaskRejectedError if the thread pool is being terminated.
+     */
+    template <typename Sequence>
+    void runAll(const Sequence &seq, TaskPriority priority = TaskPriority::NORMAL) {
+        runAll(seq.begin(), seq.end(), priority);
+    }
+
+    /**
+     * @brief Enqueues a task with a hint to run it on the workers of the given
+     * NUMA node, e.g. the node holding the data the task works on. Other nodes
+     * only run it if they run out of local work. The hint is ignored unless
+     * the pool uses TaskScheduling::NUMA_WORK_STEALING.
      * 
      * @param t The task to enqueue.
+     * @param node The preferred node, less than numaNodes().
      * @throws TaskRejectedError if the thread pool is being terminated.
      */
-    void run(Task *t) {
+    void runOnNode(Task *t, size_t node) {
+        if (_nodes.empty()) {
+            run(t);
+            return;
+        }
         if (_stopping) throw TaskRejectedError();
-        _tasks.enqueue(t);
+        _enqueue(t, node % _nodes.size());
     }
 
     /**
-     * @brief Enqueues a task to the back of the ready queue. Throws a
-     * TaskRejectedError if the thread pool is being terminated.
+     * @brief Enqueues a task with a hint to run it on the workers of the given
+     * NUMA node. See runOnNode(Task *, size_t).
      * 
      * @param t The task to enqueue.
+     * @param node The preferred node, less than numaNodes().
      * @throws TaskRejectedError if the thread pool is being terminated.
      */
-    void run(const Task &t) {
-        run(new Task(t));
+    void runOnNode(const Task &t, size_t node) {
+        runOnNode(new Task(t), node);
     }
 
     /**
-     * @brief Enqueues a task to the back of the ready queue. Throws a
-     * TaskRejectedError if the thread pool is being terminated.
+     * @brief Enqueues a task with a hint to run it on the workers of the given
+     * NUMA node. See runOnNode(Task *, size_t).
      * 
      * @param t The task to enqueue.
+     * @param node The preferred node, less than numaNodes().
      * @throws TaskRejectedError if the thread pool is being terminated.
      */
-    void run(Task &&t) {
-        run(new Task(std::move(t)));
+    void runOnNode(Task &&t, size_t node) {
+        runOnNode(new Task(std::move(t)), node);
+    }
+
+    /**
+     * @return The number of NUMA nodes this pool's workers are spread over; 1
+     * unless the pool uses TaskScheduling::NUMA_WORK_STEALING.
+     */
+    size_t numaNodes() const {
+        return _nodes.empty() ? 1 : _nodes.size();
     }
 
     /**
@@ -541,7 +1238,149 @@ public:
      * @param t The task to resume.
      */
     void resume(Task *t) {
-        _tasks.enqueue(_suspendedTasks.remove(t));
+        _enqueue(_suspendedTasks.remove(t));
+    }
+
+    /**
+     * @brief Resumes a task. Unlike resume(Task *), the task need not have
+     * suspended yet: if it is still running, its next suspension ends right
+     * away. This allows handing a task's wakeup to another thread before the
+     * task suspends.
+     * 
+     * @param t The task to resume.
+     */
+    void notify(Task *t) {
+        QueuedTask qt;
+        {
+            std::lock_guard<std::mutex> lock(_notifyMtx);
+            if (! _suspendedTasks.contains(t)) {
+                _notified.put(t);
+                return;
+            }
+            qt = _suspendedTasks.remove(t);
+        }
+        _enqueue(qt);
+    }
+
+    /**
+     * @brief Suspends the calling task until a file descriptor is ready for
+     * the given events, or has hung up or failed, so that its worker runs
+     * other tasks in the meantime. The descriptor is registered with a
+     * reactor owned by this pool, which the workers poll between tasks and
+     * while idle, and the task is resumed on readiness. A task waiting when
+     * the pool terminates is never resumed. Only one task may wait on a given
+     * descriptor at a time. Called from outside this pool's tasks, this
+     * blocks the calling thread instead.
+     * 
+     * @param fd The file descriptor.
+     * @param events Reactor::READ, Reactor::WRITE, or both.
+     */
+    void awaitReady(int fd, uint32_t events) {
+        ExecutionContext *ctx = ExecutionContext::_this;
+        if (ctx == nullptr || ctx->_pool != this) {
+            _blockUntilReady(fd, events);
+            return;
+        }
+
+        Task *t = static_cast<Task *>(ExecutionContext::_task);
+        _ioWaits.fetch_add(1, std::memory_order_relaxed);
+        try {
+            _reactor.arm(
+                fd,
+                (events & (Reactor::READ | Reactor::WRITE)) | Reactor::ONESHOT,
+                reinterpret_cast<uint64_t>(t)
+            );
+        }
+        catch (...) {
+            _ioWaits.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        // readiness notified before the task suspends ends the suspension
+        // right away
+        ctx->suspend();
+    }
+
+    /**
+     * @brief Enqueues a function as a task and returns a future for its
+     * result. The function is called as f(ctx), and its return value, or the
+     * exception it throws, becomes the result of the future.
+     * 
+     * @param f The function to run.
+     * @param priority The priority class of the task.
+     * (default = TaskPriority::NORMAL)
+     * @throws TaskRejectedError if the thread pool is being terminated.
+     * @return A future for the result of f.
+     */
+    template <typename F>
+    Future<typename std::result_of<F(Context &)>::type> submit(F f, TaskPriority priority = TaskPriority::NORMAL) {
+        using R = typename std::result_of<F(Context &)>::type;
+
+        Promise<R> p;
+        Future<R> res = p.future();
+
+        run(Task([p, f] (Context &ctx) mutable {
+            try {
+                core::FulfillPromise<R>::run(p, f, ctx);
+            }
+            catch (...) {
+                p.setException(std::current_exception());
+            }
+        }), priority);
+
+        return res;
+    }
+
+    /**
+     * @brief Takes a snapshot of the queue depths of the pool and of the
+     * activity of each of its workers. Queue depths are read without locking
+     * and are only approximate while tasks are being scheduled. Worker
+     * activity is only recorded if SPL_THREAD_POOL_METRICS is defined when
+     * including this header, which costs a few clock reads per task;
+     * otherwise the snapshot has no workers and enabled is false.
+     * 
+     * @return The snapshot.
+     */
+    ThreadPoolMetrics metrics() const {
+        ThreadPoolMetrics m;
+        m.enabled = Recorder::ENABLED;
+        m.ready = _ready.size() + _tasks.size();
+        for (Node *n : _nodes) m.ready += n->ready.size();
+        m.interactive = _interactive.size();
+        m.background = _background.size();
+        for (size_t i = 0; i < _numWorkers; ++i) m.local += _workers[i].tasks.size();
+        m.deferredTasks = _numTimers.load(std::memory_order_relaxed);
+        m.suspendedTasks = _suspendedTasks.size();
+        m.ioWaits = _ioWaits.load(std::memory_order_relaxed);
+        m.idleWorkers = _idle.load(std::memory_order_relaxed);
+        _recorder.snapshot(m.workers);
+        return m;
+    }
+
+    /**
+     * @brief Enables or disables recording trace events. Each worker buffers
+     * up to core::PoolRecorder::TRACE_CAPACITY events without blocking until
+     * they are drained, and drops further events. Has no effect unless
+     * SPL_THREAD_POOL_METRICS is defined. (default = disabled)
+     * 
+     * @param enabled Whether to record trace events.
+     */
+    void setTracing(bool enabled) {
+        _recorder.setTracing(enabled);
+    }
+
+    /**
+     * @brief Removes the buffered trace events of all workers, passing each to
+     * a function as f(const TraceEvent &). Events are in order for each
+     * worker, but workers are drained one after the other, so events of
+     * different workers should be ordered by their time.
+     * 
+     * @param f The function to call for each event.
+     * @return The number of events drained.
+     */
+    template <typename F>
+    size_t drainTrace(F f) {
+        std::lock_guard<std::mutex> lk(_traceMtx);
+        return _recorder.drain(f);
     }
 
     /**
@@ -560,7 +1399,7 @@ public:
 
         _stopping = true;
 
-        while (now <= timeout && _tasks.nonEmpty()) {
+        while (now <= timeout && _hasQueuedTasks()) {
             usleep(50);
             now = std::chrono::high_resolution_clock::now();
         }
@@ -574,9 +1413,7 @@ public:
 
         _running = false;
 
-        for (size_t i = 0; i < _threads.size(); ++i) {
-            _tasks.enqueue(nullptr);
-        }
+        _wakeAll();
 
         _threads.foreach([this, &timeout] (Thread &t) {
             if (t.joinable()) {
@@ -586,7 +1423,7 @@ public:
                         throw TimeoutError();
                     }
 
-                    if (_tasks.empty()) _tasks.enqueue(nullptr);
+                    _wakeAll();
                 } while (! t.tryJoin(_dequeueTimeout));
             }
             else if (t.running()) {
@@ -595,11 +1432,27 @@ public:
             }
         });
 
-        _tasks.foreach([] (QueuedTask &t) { 
-            if (t.task != nullptr) t.freeAll();
-        });
-        _tasks.clear();
+        for (parallel::Deque<QueuedTask> *q : { &_tasks, &_interactive, &_background }) {
+            q->foreach([this] (QueuedTask &t) {
+                if (t.task != nullptr) _freeAll(t);
+            });
+            q->clear();
+        }
+
+        QueuedTask qt;
+        while ((qt = _ready.tryDequeue(QueuedTask())).task != nullptr) _freeAll(qt);
+        for (Node *n : _nodes) {
+            while ((qt = n->ready.tryDequeue(QueuedTask())).task != nullptr) _freeAll(qt);
+        }
+
+        for (size_t i = 0; i < _numWorkers; ++i) {
+            while (_workers[i].tasks.pop(qt)) _freeAll(qt);
+        }
     }
 };
 
+template <typename context_type, typename task_type>
+thread_local typename ThreadPool<context_type, task_type>::Worker *
+ThreadPool<context_type, task_type>::_current = nullptr;
+
 }   // namespace spl
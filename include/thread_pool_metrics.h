@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <latency_histogram.h>
+
+namespace spl {
+
+/**
+ * @brief A scheduling event of a task, recorded by a ThreadPool worker while
+ * tracing is enabled.
+ */
+struct TraceEvent {
+
+    enum class Type : uint32_t {
+        START,      // the task starts from the beginning
+        RESUME,     // the task continues from a saved context
+        END,        // the task completed
+        SUSPEND,    // the task suspended, e.g. on I/O or a ResumeHandle
+        DEFER,      // the task is waiting for a timeout
+        RESCHED,    // the task will restart from the beginning
+    };
+
+    uint64_t time;      // steady clock time in nanoseconds
+    const void *task;   // the task object
+    uint32_t worker;    // the worker that recorded the event
+    Type type;
+};
+
+/**
+ * @brief A snapshot of the activity of a single ThreadPool worker. Counters
+ * and histograms cover the lifetime of the pool, and are only recorded if
+ * SPL_THREAD_POOL_METRICS is defined.
+ */
+struct WorkerMetrics {
+    uint64_t executed = 0;      // times a task was switched into
+    uint64_t resumed = 0;       // of which the task continued from a saved context
+    uint64_t completed = 0;
+    uint64_t suspended = 0;
+    uint64_t deferred = 0;
+    uint64_t rescheduled = 0;
+    uint64_t busyNanos = 0;     // running tasks
+    uint64_t idleNanos = 0;     // waiting for tasks or I/O
+    uint64_t traceDropped = 0;  // trace events lost to a full buffer
+    LatencyHistogram waitTime;  // from being queued as ready to being run
+    LatencyHistogram runTime;   // from being switched into to being switched out
+
+    /**
+     * @brief Adds the activity of another worker to this one.
+     */
+    void merge(const WorkerMetrics &rhs) {
+        executed += rhs.executed;
+        resumed += rhs.resumed;
+        completed += rhs.completed;
+        suspended += rhs.suspended;
+        deferred += rhs.deferred;
+        rescheduled += rhs.rescheduled;
+        busyNanos += rhs.busyNanos;
+        idleNanos += rhs.idleNanos;
+        traceDropped += rhs.traceDropped;
+        waitTime.merge(rhs.waitTime);
+        runTime.merge(rhs.runTime);
+    }
+};
+
+/**
+ * @brief A snapshot of the state and activity of a ThreadPool. Queue depths
+ * are always reported; the per-worker activity is only recorded if
+ * SPL_THREAD_POOL_METRICS is defined, as indicated by enabled.
+ */
+struct ThreadPoolMetrics {
+    bool enabled = false;
+    size_t ready = 0;           // in the ready or injection queues, and their overflow
+    size_t interactive = 0;     // TaskPriority::INTERACTIVE tasks queued
+    size_t background = 0;      // TaskPriority::BACKGROUND tasks queued
+    size_t local = 0;           // in the deques of work stealing workers
+    size_t deferredTasks = 0;   // waiting for a timeout
+    size_t suspendedTasks = 0;  // waiting to be resumed
+    size_t ioWaits = 0;         // waiting for descriptor readiness
+    size_t idleWorkers = 0;     // workers blocked waiting for tasks
+    std::vector<WorkerMetrics> workers;
+
+    /**
+     * @return The activity of all workers combined.
+     */
+    WorkerMetrics total() const {
+        WorkerMetrics t;
+        for (const WorkerMetrics &w : workers) t.merge(w);
+        return t;
+    }
+};
+
+namespace core {
+
+/**
+ * @brief A single-producer, single-consumer ring of trace events. The
+ * producer never blocks: events pushed while the ring is full are counted as
+ * dropped instead.
+ */
+class TraceRing {
+
+private:
+
+    TraceEvent *_events;
+    size_t _mask;
+    std::atomic_size_t _head;       // next event to drain, written by the consumer
+    std::atomic_size_t _tail;       // next free slot, written by the producer
+    std::atomic<uint64_t> _dropped;
+
+public:
+
+    /**
+     * @brief Construct a new TraceRing object.
+     *
+     * @param capacity The number of events, a power of two.
+     */
+    TraceRing(size_t capacity)
+    :   _events(new TraceEvent[capacity]),
+        _mask(capacity - 1),
+        _head(0),
+        _tail(0),
+        _dropped(0)
+    { }
+
+    TraceRing(const TraceRing &) = delete;
+
+    ~TraceRing() {
+        delete[] _events;
+    }
+
+    TraceRing & operator=(const TraceRing &) = delete;
+
+    /**
+     * @brief Appends an event. Must only be called by the producer.
+     */
+    void push(const TraceEvent &e) {
+        size_t t = _tail.load(std::memory_order_relaxed);
+        if (t - _head.load(std::memory_order_acquire) > _mask) {
+            _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        _events[t & _mask] = e;
+        _tail.store(t + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Removes all events pushed so far, in order, passing each to a
+     * function. Must only be called by one consumer at a time.
+     *
+     * @return The number of events drained.
+     */
+    template <typename F>
+    size_t drain(F &f) {
+        size_t h = _head.load(std::memory_order_relaxed);
+        size_t t = _tail.load(std::memory_order_acquire);
+        for (size_t i = h; i != t; ++i) f(_events[i & _mask]);
+        _head.store(t, std::memory_order_release);
+        return t - h;
+    }
+
+    /**
+     * @return The number of events dropped because the ring was full.
+     */
+    uint64_t dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Records the activity of the workers of a ThreadPool. Each worker
+ * owns one record, so recording takes no locks and no atomic
+ * read-modify-write instructions.
+ */
+class PoolRecorder {
+
+private:
+
+    struct Record {
+        std::atomic<uint64_t> executed { 0 };
+        std::atomic<uint64_t> resumed { 0 };
+        std::atomic<uint64_t> completed { 0 };
+        std::atomic<uint64_t> suspended { 0 };
+        std::atomic<uint64_t> deferred { 0 };
+        std::atomic<uint64_t> rescheduled { 0 };
+        std::atomic<uint64_t> busyNanos { 0 };
+        std::atomic<uint64_t> idleNanos { 0 };
+        AtomicLatencyHistogram waitTime;
+        AtomicLatencyHistogram runTime;
+        TraceRing trace;
+        char padding[64];   // keeps neighbouring records off each other's cache lines
+
+        Record()
+        :   trace(TRACE_CAPACITY)
+        { }
+    };
+
+    Record *_records;
+    size_t _numRecords;
+    std::atomic_bool _tracing;
+
+    static void _add(std::atomic<uint64_t> &a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void _trace(size_t id, const void *task, TraceEvent::Type type, uint64_t time) {
+        if (_tracing.load(std::memory_order_relaxed)) {
+            _records[id].trace.push(TraceEvent { time, task, (uint32_t) id, type });
+        }
+    }
+
+public:
+
+    static constexpr bool ENABLED = true;
+    static constexpr size_t TRACE_CAPACITY = 4096;  // trace events buffered per worker
+
+    PoolRecorder(size_t workers)
+    :   _records(new Record[workers]),
+        _numRecords(workers),
+        _tracing(false)
+    { }
+
+    PoolRecorder(const PoolRecorder &) = delete;
+
+    ~PoolRecorder() {
+        delete[] _records;
+    }
+
+    PoolRecorder & operator=(const PoolRecorder &) = delete;
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    /**
+     * @brief Stamps a task with the time it was queued as ready.
+     */
+    template <typename QueuedTask>
+    void ready(QueuedTask &qt) {
+        qt.readyTime = now();
+    }
+
+    /**
+     * @brief Records a worker switching into a task.
+     *
+     * @return The time the task started running.
+     */
+    template <typename QueuedTask>
+    uint64_t begin(size_t id, const QueuedTask &qt, bool resumed) {
+        uint64_t t = now();
+        Record &r = _records[id];
+        _add(r.executed, 1);
+        if (resumed) _add(r.resumed, 1);
+        if (qt.readyTime != 0 && t > qt.readyTime) r.waitTime.record(t - qt.readyTime);
+        _trace(id, qt.task, resumed ? TraceEvent::Type::RESUME : TraceEvent::Type::START, t);
+        return t;
+    }
+
+    /**
+     * @brief Records a task switching back out to its worker.
+     *
+     * @param outcome TraceEvent::Type::END, SUSPEND, DEFER or RESCHED.
+     * @param start The time returned by begin().
+     */
+    void end(size_t id, const void *task, TraceEvent::Type outcome, uint64_t start) {
+        uint64_t t = now();
+        Record &r = _records[id];
+        r.runTime.record(t - start);
+        _add(r.busyNanos, t - start);
+        switch (outcome) {
+        case TraceEvent::Type::END: _add(r.completed, 1); break;
+        case TraceEvent::Type::SUSPEND: _add(r.suspended, 1); break;
+        case TraceEvent::Type::DEFER: _add(r.deferred, 1); break;
+        case TraceEvent::Type::RESCHED: _add(r.rescheduled, 1); break;
+        default: break;
+        }
+        _trace(id, task, outcome, t);
+    }
+
+    /**
+     * @brief Records a worker waiting for tasks or I/O since a given time.
+     */
+    void idle(size_t id, uint64_t since) {
+        _add(_records[id].idleNanos, now() - since);
+    }
+
+    void setTracing(bool enabled) {
+        _tracing.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copies the activity of all workers into a snapshot.
+     */
+    void snapshot(std::vector<WorkerMetrics> &workers) const {
+        workers.resize(_numRecords);
+        for (size_t i = 0; i < _numRecords; ++i) {
+            const Record &r = _records[i];
+            WorkerMetrics &w = workers[i];
+            w.executed = r.executed.load(std::memory_order_relaxed);
+            w.resumed = r.resumed.load(std::memory_order_relaxed);
+            w.completed = r.completed.load(std::memory_order_relaxed);
+            w.suspended = r.suspended.load(std::memory_order_relaxed);
+            w.deferred = r.deferred.load(std::memory_order_relaxed);
+            w.rescheduled = r.rescheduled.load(std::memory_order_relaxed);
+            w.busyNanos = r.busyNanos.load(std::memory_order_relaxed);
+            w.idleNanos = r.idleNanos.load(std::memory_order_relaxed);
+            w.traceDropped = r.trace.dropped();
+            r.waitTime.snapshot(w.waitTime);
+            r.runTime.snapshot(w.runTime);
+        }
+    }
+
+    /**
+     * @brief Drains the trace events of all workers, worker by worker. Must
+     * only be called by one thread at a time.
+     */
+    template <typename F>
+    size_t drain(F &f) {
+        size_t n = 0;
+        for (size_t i = 0; i < _numRecords; ++i) n += _records[i].trace.drain(f);
+        return n;
+    }
+};
+
+/**
+ * @brief The PoolRecorder of a ThreadPool built without
+ * SPL_THREAD_POOL_METRICS, which records nothing.
+ */
+class NullPoolRecorder {
+
+public:
+
+    static constexpr bool ENABLED = false;
+
+    NullPoolRecorder(size_t) { }
+
+    static uint64_t now() {
+        return 0;
+    }
+
+    template <typename QueuedTask>
+    void ready(QueuedTask &) { }
+
+    template <typename QueuedTask>
+    uint64_t begin(size_t, const QueuedTask &, bool) {
+        return 0;
+    }
+
+    void end(size_t, const void *, TraceEvent::Type, uint64_t) { }
+
+    void idle(size_t, uint64_t) { }
+
+    void setTracing(bool) { }
+
+    void snapshot(std::vector<WorkerMetrics> &) const { }
+
+    template <typename F>
+    size_t drain(F &) {
+        return 0;
+    }
+};
+
+} // namespace core
+
+} // namespace spl
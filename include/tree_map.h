@@ -0,0 +1,645 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <core/btree.h>
+#include <functional>       // std::less
+#include <initializer_list>
+#include <vector>
+#include <container.h>
+#include <exception.h>
+#include <serialization.h>
+
+namespace spl {
+
+/**
+ * @brief An ordered map supporting O(log n) lookup, insert, and delete, and
+ * iteration in key order. Mappings are stored in a B+-tree with nodes of a few
+ * cache lines, so that lookups and range scans touch far fewer cache lines
+ * and allocations than a red-black tree such as std::map.
+ *
+ * Inserting or erasing a mapping invalidates iterators and pointers into the
+ * map.
+ *
+ * @tparam Key The key type.
+ * @tparam Val The value type.
+ * @tparam Compare A functor defining a strict weak order on keys. The default
+ * functor is std::less<Key>.
+ */
+template <
+    typename Key,
+    typename Val,
+    typename Compare = std::less<Key>
+>
+class TreeMap
+:   protected core::BTree<Key, MapNode<Key, Val>, Compare>,
+    public ForwardIterableContainer<TreeMap<Key, Val, Compare>>,
+    public Serializable
+{
+
+    template <typename TreeType> friend struct BTreeTester;
+
+private:
+
+    using base = core::BTree<Key, MapNode<Key, Val>, Compare>;
+
+    using container_base = ForwardIterableContainer<TreeMap<Key, Val, Compare>>;
+
+    friend container_base;
+
+    using storage_node = typename base::storage_node;
+
+    using base::_head;
+    using base::_tail;
+    using base::_size;
+    using base::_lt;
+    using base::_find;
+    using base::_insert;
+    using base::_put;
+    using base::_erase;
+    using base::_lowerBound;
+    using base::_upperBound;
+    using base::_load;
+    using base::_loadMove;
+    using base::_clear;
+
+    std::vector<typename base::template TreeIterator<storage_node>> _partition(size_t n) {
+        return base::template _partitionLeaves<storage_node>(n);
+    }
+
+    std::vector<typename base::template TreeIterator<const storage_node>> _partition(size_t n) const {
+        return base::template _partitionLeaves<const storage_node>(n);
+    }
+
+public:
+
+    using Iterator = typename base::template TreeIterator<storage_node>;
+    using ConstIterator = typename base::template TreeIterator<const storage_node>;
+
+    using container_base::foreach;
+
+    /**
+     * @brief Construct a new TreeMap object.
+     */
+    TreeMap() = default;
+
+    TreeMap(const TreeMap &rhs)
+    :   base(rhs)
+    { }
+
+    TreeMap(TreeMap &&rhs)
+    :   base(std::move(rhs))
+    { }
+
+    /**
+     * @brief Construct a new TreeMap object.
+     *
+     * @param list An initializer list of objects of type MapNode<Key, Val>.
+     */
+    TreeMap(const std::initializer_list<storage_node> &list) {
+        _load(list.begin(), list.end());
+    }
+
+    /**
+     * @brief Construct a new TreeMap object. Elements sorted by key are
+     * bulk-loaded into full nodes, much faster than inserting them one by
+     * one.
+     *
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_same<TreeMap, Sequence>::value, int>::type = 0
+    >
+    TreeMap(const Sequence &seq) {
+        _load(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Construct a new TreeMap object. Elements sorted by key are
+     * bulk-loaded into full nodes, much faster than inserting them one by
+     * one.
+     *
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_same<TreeMap, typename std::decay<Sequence>::type>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
+    TreeMap(Sequence &&seq) {
+        _loadMove(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Construct a new TreeMap object. Elements sorted by key are
+     * bulk-loaded into full nodes, much faster than inserting them one by
+     * one.
+     *
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     */
+    template <typename Begin, typename End>
+    TreeMap(const Begin &begin, const End &end) {
+        _load(begin, end);
+    }
+
+    /**
+     * @brief Construct a new TreeMap object. Elements sorted by key are
+     * bulk-loaded into full nodes, much faster than inserting them one by
+     * one.
+     *
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @param size The number of elements between begin and end.
+     */
+    template <typename Begin, typename End>
+    TreeMap(const Begin &begin, const End &end, size_t size) {
+        _load(begin, end);
+    }
+
+    /**
+     * @brief Construct a new TreeMap object.
+     *
+     * @tparam It A beginning iterator type that defines the typename
+     * `value_type` which will determine the resulting type. Note that
+     * value_type must be a MapNode type.
+     * @tparam EndIt An end iterator type.
+     * @param begin The beginning iterator.
+     * @param end The end iterator.
+     * @return A new TreeMap object of type It::value_type objects.
+     */
+    template <typename It, typename EndIt>
+    static TreeMap<
+        typename It::value_type::key_type,
+        typename It::value_type::value_type
+    > create(const It &begin, const EndIt &end) {
+        return TreeMap<
+            typename It::value_type::key_type,
+            typename It::value_type::value_type
+        >(begin, end);
+    }
+
+    /**
+     * @brief Construct a new TreeMap object.
+     *
+     * @tparam It A beginning iterator type that defines the typename
+     * `value_type` which will determine the resulting type. Note that
+     * value_type must be a MapNode type.
+     * @tparam EndIt An end iterator type.
+     * @param begin The beginning iterator.
+     * @param end The end iterator.
+     * @param size The number of elements between begin and end.
+     * @return A new TreeMap object of type It::value_type objects.
+     */
+    template <typename It, typename EndIt>
+    static TreeMap<
+        typename It::value_type::key_type,
+        typename It::value_type::value_type
+    > create(const It &begin, const EndIt &end, size_t size) {
+        return TreeMap<
+            typename It::value_type::key_type,
+            typename It::value_type::value_type
+        >(begin, end, size);
+    }
+
+    ~TreeMap() = default;
+
+    TreeMap & operator=(const TreeMap &rhs) {
+        base::operator=(rhs);
+        return *this;
+    }
+
+    TreeMap & operator=(TreeMap &&rhs) {
+        base::operator=(std::move(rhs));
+        return *this;
+    }
+
+    void writeObject(OutputStreamSerializer &serializer) const override {
+        base::_serialize(serializer);
+    }
+
+    void readObject(InputStreamSerializer &serializer) override {
+        base::_deserialize(serializer);
+    }
+
+    /**
+     * @return The size of this container.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return _size != 0;
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator cbegin() const {
+        return base::begin();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator cend() const {
+        return base::end();
+    }
+
+    /**
+     * @return An iterator pointing to the beginning of this container.
+     */
+    Iterator begin() {
+        return base::begin();
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator begin() const {
+        return base::begin();
+    }
+
+    /**
+     * @return An iterator pointing to a past-the-end position.
+     */
+    Iterator end() {
+        return base::end();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator end() const {
+        return base::end();
+    }
+
+    /**
+     * @brief Erases all elements in this container.
+     *
+     * @return A reference to this container for chaining.
+     */
+    TreeMap & clear() {
+        _clear();
+        return *this;
+    }
+
+    /**
+     * @brief Tests whether a mapping for some key exists.
+     *
+     * @param k The key to search for.
+     * @return True if the key exists, false otherwise.
+     */
+    template <typename K>
+    bool contains(const K &k) const {
+        return _find(k) != nullptr;
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key. If the key is not
+     * found, an ElementNotFoundError will be thrown.
+     *
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A copy of the corresponding value.
+     */
+    template <typename K>
+    Val get(const K &k) const {
+        const storage_node *n = _find(k);
+        if (n != nullptr) return n->v;
+        throw ElementNotFoundError();
+    }
+
+    /**
+     * @brief Retrieves the value corresponding to some key. If the given key is
+     * not found in the map, the default value will be returned.
+     *
+     * @param k The key to search for.
+     * @param defaultValue The default value to return if the key is not found.
+     * @return A copy of the actual value corresponding to the given key, or the
+     * default value.
+     */
+    template <typename K>
+    Val getOr(const K &k, const Val &defaultValue) const {
+        const storage_node *n = _find(k);
+        if (n != nullptr) return n->v;
+        return defaultValue;
+    }
+
+    /**
+     * @brief Looks up the value corresponding to some key, without throwing
+     * on a miss.
+     *
+     * @param k The key to search for.
+     * @return A pointer to the value, or nullptr if the key is not found. The
+     * pointer is invalidated by any modification of the map.
+     */
+    template <typename K>
+    Val * find(const K &k) {
+        storage_node *n = _find(k);
+        return n != nullptr ? &n->v : nullptr;
+    }
+
+    /**
+     * @brief Looks up the value corresponding to some key, without throwing
+     * on a miss.
+     *
+     * @param k The key to search for.
+     * @return A const pointer to the value, or nullptr if the key is not
+     * found. The pointer is invalidated by any modification of the map.
+     */
+    template <typename K>
+    const Val * find(const K &k) const {
+        const storage_node *n = _find(k);
+        return n != nullptr ? &n->v : nullptr;
+    }
+
+    /**
+     * @brief Retrieves the node corresponding to some key. If the key is not
+     * found, an ElementNotFoundError will be thrown.
+     *
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A copy of the corresponding node.
+     */
+    template <typename K>
+    storage_node getNode(const K &k) const {
+        const storage_node *n = _find(k);
+        if (n != nullptr) return *n;
+        throw ElementNotFoundError();
+    }
+
+    /**
+     * @brief Retrieves the mapping with the smallest key. If the map is empty,
+     * an ElementNotFoundError will be thrown.
+     *
+     * @throws ElementNotFoundError if the map is empty.
+     * @return A copy of the first node.
+     */
+    storage_node first() const {
+        if (_head == nullptr) throw ElementNotFoundError();
+        return *_head->at(0);
+    }
+
+    /**
+     * @brief Retrieves the mapping with the largest key. If the map is empty,
+     * an ElementNotFoundError will be thrown.
+     *
+     * @throws ElementNotFoundError if the map is empty.
+     * @return A copy of the last node.
+     */
+    storage_node last() const {
+        if (_tail == nullptr) throw ElementNotFoundError();
+        return *_tail->at(_tail->n - 1);
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return An iterator pointing to the first mapping with a key not less
+     * than the given key, or a past-the-end iterator.
+     */
+    template <typename K>
+    Iterator lowerBound(const K &k) {
+        return base::template _iterator<storage_node>(_lowerBound(k));
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return A constant iterator pointing to the first mapping with a key not
+     * less than the given key, or a past-the-end iterator.
+     */
+    template <typename K>
+    ConstIterator lowerBound(const K &k) const {
+        return base::template _iterator<const storage_node>(_lowerBound(k));
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return An iterator pointing to the first mapping with a key greater
+     * than the given key, or a past-the-end iterator.
+     */
+    template <typename K>
+    Iterator upperBound(const K &k) {
+        return base::template _iterator<storage_node>(_upperBound(k));
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return A constant iterator pointing to the first mapping with a key
+     * greater than the given key, or a past-the-end iterator.
+     */
+    template <typename K>
+    ConstIterator upperBound(const K &k) const {
+        return base::template _iterator<const storage_node>(_upperBound(k));
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     *
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    TreeMap & put(const Key &k, const Val &v) {
+        auto res = _insert(k, k, v);
+        if (! res.second) res.first->v = v;
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     *
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    TreeMap & put(const Key &k, Val &&v) {
+        auto res = _insert(k, k, std::move(v));
+        if (! res.second) res.first->v = std::move(v);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     *
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    TreeMap & put(Key &&k, const Val &v) {
+        auto res = _insert(k, std::move(k), v);
+        if (! res.second) res.first->v = v;
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a new mapping.
+     *
+     * @param k Key.
+     * @param v Value.
+     * @return A reference to this container for chaining.
+     */
+    TreeMap & put(Key &&k, Val &&v) {
+        auto res = _insert(k, std::move(k), std::move(v));
+        if (! res.second) res.first->v = std::move(v);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a range of elements.
+     *
+     * @param begin A beginning iterator over type MapNode<Key, Val> objects.
+     * @param end An end iterator over type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    TreeMap & putAll(const Begin &begin, const End &end) {
+        _load(begin, end);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container.
+     *
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    TreeMap & putAll(const Sequence &seq) {
+        return putAll(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Inserts all elements of an iterable container.
+     *
+     * @param seq An iterable container of type MapNode<Key, Val> objects.
+     * @return A reference to this container for chaining.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
+    TreeMap & putAll(Sequence &&seq) {
+        _loadMove(seq.begin(), seq.end());
+        return *this;
+    }
+
+    /**
+     * @brief Retrieves a reference to the value corresponding to some key. If
+     * the mapping does not exist, a new Val type object will be created using
+     * the parameterless constructor `Val()`.
+     *
+     * @param k The key to search for.
+     * @return A refernce to the corresponding value.
+     */
+    Val & operator[](const Key &k) {
+        return _insert(k, k, Val()).first->v;
+    }
+
+    /**
+     * @brief Retrieves a reference to the value corresponding to some key. If
+     * the mapping does not exist, a new Val type object will be created using
+     * the parameterless constructor `Val()`.
+     *
+     * @param k The key to search for.
+     * @return A refernce to the corresponding value.
+     */
+    Val & operator[](Key &&k) {
+        return _insert(k, std::move(k), Val()).first->v;
+    }
+
+    /**
+     * @brief Retrieves a const reference to the value corresponding to some
+     * key. If the mapping does not exist, an ElementNotFoundError will be
+     * thrown.
+     *
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A const refernce to the corresponding value.
+     */
+    const Val & operator[](const Key &k) const {
+        const storage_node *n = _find(k);
+        if (n == nullptr) throw ElementNotFoundError();
+        return n->v;
+    }
+
+    /**
+     * @brief Erases a key from this map. If the key does not exist, the
+     * function does nothing.
+     *
+     * @param k The key to erase.
+     * @return True if a key was erased, false otherwise.
+     */
+    template <typename K>
+    bool erase(const K &k) {
+        return _erase(k);
+    }
+
+    /**
+     * @brief Erases a key from this map and returns the corresponding value. If
+     * the key does not exist, an ElementNotFoundError will be thrown.
+     *
+     * @param k The key to erase.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return The value corresponding to the erased key.
+     */
+    template <typename K>
+    Val remove(const K &k) {
+        storage_node *n = _find(k);
+        if (n == nullptr) throw ElementNotFoundError();
+        Val retval = std::move(n->v);
+        _erase(k);
+        return retval;
+    }
+
+    /**
+     * @brief Applies a function, in key order, to all mappings with keys in a
+     * half-open range.
+     *
+     * @param from The smallest key of the range.
+     * @param to The key past the end of the range.
+     * @param f The function to apply.
+     * @return A reference to this container for chaining.
+     */
+    template <typename K, typename F>
+    const TreeMap & foreach(const K &from, const K &to, F f) const {
+        for (auto it = lowerBound(from), end = cend(); it != end && _lt(it->k, to); ++it) {
+            f(*it);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Applies a function, in key order, to all mappings with keys in a
+     * half-open range.
+     *
+     * @param from The smallest key of the range.
+     * @param to The key past the end of the range.
+     * @param f The function to apply.
+     * @return A reference to this container for chaining.
+     */
+    template <typename K, typename F>
+    TreeMap & foreach(const K &from, const K &to, F f) {
+        for (auto it = lowerBound(from), end = this->end(); it != end && _lt(it->k, to); ++it) {
+            f(*it);
+        }
+        return *this;
+    }
+};
+
+}   // namespace spl
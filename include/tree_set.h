@@ -0,0 +1,453 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <core/btree.h>
+#include <functional>       // std::less
+#include <initializer_list>
+#include <vector>
+#include <container.h>
+#include <exception.h>
+#include <serialization.h>
+
+namespace spl {
+
+/**
+ * @brief An ordered set supporting O(log n) lookup, insert, and delete, and
+ * iteration in key order, stored in a B+-tree like TreeMap.
+ *
+ * Inserting or erasing a key invalidates iterators into the set.
+ *
+ * @tparam Key The key type.
+ * @tparam Compare A functor defining a strict weak order on keys. The default
+ * functor is std::less<Key>.
+ */
+template <
+    typename Key,
+    typename Compare = std::less<Key>
+>
+class TreeSet
+:   protected core::BTree<Key, Key, Compare>,
+    public ForwardIterableContainer<TreeSet<Key, Compare>>,
+    public Serializable
+{
+
+    template <typename TreeType> friend struct BTreeTester;
+
+private:
+
+    using base = core::BTree<Key, Key, Compare>;
+
+    using container_base = ForwardIterableContainer<TreeSet<Key, Compare>>;
+
+    friend container_base;
+
+    using base::_head;
+    using base::_tail;
+    using base::_size;
+    using base::_lt;
+    using base::_find;
+    using base::_insert;
+    using base::_erase;
+    using base::_lowerBound;
+    using base::_upperBound;
+    using base::_load;
+    using base::_loadMove;
+    using base::_clear;
+
+    std::vector<typename base::template TreeIterator<const Key>> _partition(size_t n) const {
+        return base::template _partitionLeaves<const Key>(n);
+    }
+
+public:
+
+    // keys cannot be modified in place without breaking the order
+    using Iterator = typename base::template TreeIterator<const Key>;
+    using ConstIterator = typename base::template TreeIterator<const Key>;
+
+    using container_base::foreach;
+
+    /**
+     * @brief Construct a new TreeSet object.
+     */
+    TreeSet() = default;
+
+    TreeSet(const TreeSet &rhs)
+    :   base(rhs)
+    { }
+
+    TreeSet(TreeSet &&rhs)
+    :   base(std::move(rhs))
+    { }
+
+    /**
+     * @brief Construct a new TreeSet object.
+     *
+     * @param list An initializer list of objects of type Key.
+     */
+    TreeSet(const std::initializer_list<Key> &list) {
+        _load(list.begin(), list.end());
+    }
+
+    /**
+     * @brief Construct a new TreeSet object. Sorted keys are bulk-loaded into
+     * full nodes, much faster than inserting them one by one.
+     *
+     * @param seq An iterable container of type Key objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_same<TreeSet, Sequence>::value, int>::type = 0
+    >
+    TreeSet(const Sequence &seq) {
+        _load(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Construct a new TreeSet object. Sorted keys are bulk-loaded into
+     * full nodes, much faster than inserting them one by one.
+     *
+     * @param seq An iterable container of type Key objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_same<TreeSet, typename std::decay<Sequence>::type>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
+    TreeSet(Sequence &&seq) {
+        _loadMove(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Construct a new TreeSet object. Sorted keys are bulk-loaded into
+     * full nodes, much faster than inserting them one by one.
+     *
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     */
+    template <typename Begin, typename End>
+    TreeSet(const Begin &begin, const End &end) {
+        _load(begin, end);
+    }
+
+    /**
+     * @brief Construct a new TreeSet object. Sorted keys are bulk-loaded into
+     * full nodes, much faster than inserting them one by one.
+     *
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     * @param size The number of elements between begin and end.
+     */
+    template <typename Begin, typename End>
+    TreeSet(const Begin &begin, const End &end, size_t size) {
+        _load(begin, end);
+    }
+
+    /**
+     * @brief Construct a new TreeSet object.
+     *
+     * @tparam It A beginning iterator type that defines the typename
+     * `value_type` which will determine the resulting type.
+     * @tparam EndIt An end iterator type.
+     * @param begin The beginning iterator.
+     * @param end The end iterator.
+     * @return A new TreeSet object of type It::value_type objects.
+     */
+    template <typename It, typename EndIt>
+    static TreeSet<typename It::value_type> create(const It &begin, const EndIt &end) {
+        return TreeSet<typename It::value_type>(begin, end);
+    }
+
+    /**
+     * @brief Construct a new TreeSet object.
+     *
+     * @tparam It A beginning iterator type that defines the typename
+     * `value_type` which will determine the resulting type.
+     * @tparam EndIt An end iterator type.
+     * @param begin The beginning iterator.
+     * @param end The end iterator.
+     * @param size The number of elements between begin and end.
+     * @return A new TreeSet object of type It::value_type objects.
+     */
+    template <typename It, typename EndIt>
+    static TreeSet<typename It::value_type> create(const It &begin, const EndIt &end, size_t size) {
+        return TreeSet<typename It::value_type>(begin, end, size);
+    }
+
+    ~TreeSet() = default;
+
+    TreeSet & operator=(const TreeSet &rhs) {
+        base::operator=(rhs);
+        return *this;
+    }
+
+    TreeSet & operator=(TreeSet &&rhs) {
+        base::operator=(std::move(rhs));
+        return *this;
+    }
+
+    void writeObject(OutputStreamSerializer &serializer) const override {
+        base::_serialize(serializer);
+    }
+
+    void readObject(InputStreamSerializer &serializer) override {
+        base::_deserialize(serializer);
+    }
+
+    /**
+     * @return The size of this container.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return _size != 0;
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator cbegin() const {
+        return base::begin();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator cend() const {
+        return base::end();
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator begin() const {
+        return base::begin();
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator end() const {
+        return base::end();
+    }
+
+    /**
+     * @brief Erases all elements in this container.
+     *
+     * @return A reference to this container for chaining.
+     */
+    TreeSet & clear() {
+        _clear();
+        return *this;
+    }
+
+    /**
+     * @brief Tests whether some key exists in this set.
+     *
+     * @param k The key to search for.
+     * @return True if the key exists, false otherwise.
+     */
+    template <typename K>
+    bool contains(const K &k) const {
+        return _find(k) != nullptr;
+    }
+
+    /**
+     * @brief Retrieves the actual key corresponding to some given key. If the
+     * given key is not found in the set, an ElementNotFoundError will be
+     * thrown.
+     *
+     * @param k The key to search for.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return A copy of the actual key corresponding to the given key.
+     */
+    template <typename K>
+    Key get(const K &k) const {
+        const Key *x = _find(k);
+        if (x != nullptr) return *x;
+        throw ElementNotFoundError();
+    }
+
+    /**
+     * @brief Retrieves the actual key corresponding to some given key. If the
+     * given key is not found in the set, the default value will be returned.
+     *
+     * @param k The key to search for.
+     * @param defaultValue The default key to return if the key is not found.
+     * @return A copy of the actual key corresponding to the given key, or the
+     * default value.
+     */
+    template <typename K>
+    Key getOr(const K &k, const Key &defaultValue) const {
+        const Key *x = _find(k);
+        if (x != nullptr) return *x;
+        return defaultValue;
+    }
+
+    /**
+     * @brief Retrieves the smallest key. If the set is empty, an
+     * ElementNotFoundError will be thrown.
+     *
+     * @throws ElementNotFoundError if the set is empty.
+     * @return A copy of the first key.
+     */
+    Key first() const {
+        if (_head == nullptr) throw ElementNotFoundError();
+        return *_head->at(0);
+    }
+
+    /**
+     * @brief Retrieves the largest key. If the set is empty, an
+     * ElementNotFoundError will be thrown.
+     *
+     * @throws ElementNotFoundError if the set is empty.
+     * @return A copy of the last key.
+     */
+    Key last() const {
+        if (_tail == nullptr) throw ElementNotFoundError();
+        return *_tail->at(_tail->n - 1);
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return A constant iterator pointing to the first key not less than the
+     * given key, or a past-the-end iterator.
+     */
+    template <typename K>
+    ConstIterator lowerBound(const K &k) const {
+        return base::template _iterator<const Key>(_lowerBound(k));
+    }
+
+    /**
+     * @param k The key to search for.
+     * @return A constant iterator pointing to the first key greater than the
+     * given key, or a past-the-end iterator.
+     */
+    template <typename K>
+    ConstIterator upperBound(const K &k) const {
+        return base::template _iterator<const Key>(_upperBound(k));
+    }
+
+    /**
+     * @brief Inserts a key.
+     *
+     * @param k The key to insert.
+     * @return A reference to this container for chaining.
+     */
+    TreeSet & put(const Key &k) {
+        _insert(k, k);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a key.
+     *
+     * @param k The key to insert.
+     * @return A reference to this container for chaining.
+     */
+    TreeSet & put(Key &&k) {
+        _insert(k, std::move(k));
+        return *this;
+    }
+
+    /**
+     * @brief Inserts a range of keys.
+     *
+     * @param begin A beginning iterator over type Key objects.
+     * @param end An end iterator over type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Begin, typename End>
+    TreeSet & putAll(const Begin &begin, const End &end) {
+        _load(begin, end);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts all keys of an iterable container.
+     *
+     * @param seq An iterable container of type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <typename Sequence>
+    TreeSet & putAll(const Sequence &seq) {
+        return putAll(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Inserts all keys of an iterable container.
+     *
+     * @param seq An iterable container of type Key objects.
+     * @return A reference to this container for chaining.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
+    TreeSet & putAll(Sequence &&seq) {
+        _loadMove(seq.begin(), seq.end());
+        return *this;
+    }
+
+    /**
+     * @brief Erases a key from this set. If the key does not exist, the
+     * function does nothing.
+     *
+     * @param k The key to erase.
+     * @return True if a key was erased, false otherwise.
+     */
+    template <typename K>
+    bool erase(const K &k) {
+        return _erase(k);
+    }
+
+    /**
+     * @brief Erases a key from this set and returns the actual key. If the key
+     * does not exist, an ElementNotFoundError will be thrown.
+     *
+     * @param k The key to erase.
+     * @throws ElementNotFoundError if the key is not found.
+     * @return The erased key.
+     */
+    template <typename K>
+    Key remove(const K &k) {
+        const Key *x = _find(k);
+        if (x == nullptr) throw ElementNotFoundError();
+        Key retval = *x;
+        _erase(k);
+        return retval;
+    }
+
+    /**
+     * @brief Applies a function, in order, to all keys in a half-open range.
+     *
+     * @param from The smallest key of the range.
+     * @param to The key past the end of the range.
+     * @param f The function to apply.
+     * @return A reference to this container for chaining.
+     */
+    template <typename K, typename F>
+    const TreeSet & foreach(const K &from, const K &to, F f) const {
+        for (auto it = lowerBound(from), end = cend(); it != end && _lt(*it, to); ++it) {
+            f(*it);
+        }
+        return *this;
+    }
+};
+
+}   // namespace spl
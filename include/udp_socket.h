@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <socket.h>
+#include <reactor.h>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace spl {
+
+/**
+ * @brief A datagram buffer used for batched sends and receives.
+ */
+struct Datagram {
+
+    /**
+     * @brief Pointer to the datagram payload.
+     */
+    void *data;
+
+    /**
+     * @brief Length of the payload. For receives, this is the capacity of the
+     * buffer on input, and the length of the received datagram on output.
+     */
+    size_t len;
+
+    /**
+     * @brief The destination address for sends, or the source address for
+     * receives.
+     */
+    SocketAddress addr;
+
+    /**
+     * @brief For receives with coalescing enabled, the size of the datagrams
+     * that were coalesced into this buffer, or 0 if the buffer holds a single
+     * datagram. Ignored for sends.
+     */
+    uint16_t segmentSize;
+};
+
+/**
+ * @brief Helper class for sending and receiving UDP datagrams. Batched
+ * operations move up to BATCH_SIZE datagrams per system call using
+ * sendmmsg/recvmmsg, and generic segmentation and receive offloads (GSO/GRO)
+ * can be enabled to let the kernel split and merge runs of equally sized
+ * datagrams.
+ */
+class UDPSocket {
+
+private:
+
+    int _fd;
+    SocketAddress _addr;
+
+public:
+
+    /**
+     * @brief The maximum number of datagrams moved by a single batched system
+     * call.
+     */
+    static constexpr size_t BATCH_SIZE = 64;
+
+    /**
+     * @brief Construct a new UDPSocket object bound to an ephemeral port.
+     *
+     * @param family Socket family to use.
+     */
+    UDPSocket(SocketFamily family = SocketFamily::IPV4)
+    :   UDPSocket(0, family)
+    { }
+
+    /**
+     * @brief Construct a new UDPSocket object bound to the given port on all
+     * interfaces.
+     *
+     * @param port Port number to bind to. If 0, an available port is chosen.
+     * @param family Socket family to use.
+     * @param reusePort If true, SO_REUSEPORT is set so that several sockets
+     * can bind the same port and share the incoming datagrams.
+     */
+    UDPSocket(in_port_t port, SocketFamily family = SocketFamily::IPV4, bool reusePort = false);
+
+    UDPSocket(const UDPSocket &) = delete;
+
+    UDPSocket(UDPSocket &&rhs)
+    :   _fd(rhs._fd),
+        _addr(rhs._addr)
+    {
+        rhs._fd = -1;
+    }
+
+    /**
+     * @brief Close and destroy the UDPSocket object.
+     */
+    ~UDPSocket() {
+        close();
+    }
+
+    UDPSocket & operator=(const UDPSocket &) = delete;
+
+    UDPSocket & operator=(UDPSocket &&rhs) {
+        if (this != &rhs) {
+            close();
+
+            _fd = rhs._fd; rhs._fd = -1;
+            _addr = rhs._addr;
+        }
+        return *this;
+    }
+
+    /**
+     * @return The local address of this socket.
+     */
+    const SocketAddress & address() const {
+        return _addr;
+    }
+
+    /**
+     * @return The underlying file descriptor.
+     */
+    int fd() const {
+        return _fd;
+    }
+
+    /**
+     * @brief Sets the default destination of this socket, and only accepts
+     * datagrams from that address.
+     *
+     * @param addr The peer address.
+     * @return A reference to this object for chaining.
+     */
+    UDPSocket & connect(const SocketAddress &addr);
+
+    /**
+     * @brief Sends a single datagram.
+     *
+     * @param data Pointer to the payload.
+     * @param len Length of the payload.
+     * @param addr The destination address.
+     * @throws Error if the datagram could not be sent.
+     */
+    void sendTo(const void *data, size_t len, const SocketAddress &addr);
+
+    /**
+     * @brief Sends a single datagram to the address given to connect().
+     *
+     * @param data Pointer to the payload.
+     * @param len Length of the payload.
+     * @throws Error if the datagram could not be sent.
+     */
+    void send(const void *data, size_t len);
+
+    /**
+     * @brief Receives a single datagram.
+     *
+     * @param data Pointer to a buffer for the payload.
+     * @param len Capacity of the buffer. Longer datagrams are truncated.
+     * @param from Optional pointer receiving the source address.
+     * @param block If true, waits for a datagram to arrive.
+     * @throws Error if an unexpected error prevents receiving.
+     * @return The length of the datagram, or -1 if no datagram is available
+     * and block is false.
+     */
+    ssize_t recvFrom(void *data, size_t len, SocketAddress *from = nullptr, bool block = true);
+
+    /**
+     * @brief Sends a batch of datagrams with as few system calls as possible.
+     *
+     * @param datagrams Array of datagrams, each with its destination address.
+     * @param count Number of datagrams.
+     * @throws Error if a datagram could not be sent.
+     */
+    void sendBatch(const Datagram *datagrams, size_t count);
+
+    /**
+     * @brief Receives up to BATCH_SIZE datagrams in a single system call.
+     *
+     * @param datagrams Array of datagram buffers. On return, the length,
+     * source address and segment size of each received datagram are set.
+     * @param count Number of buffers.
+     * @param block If true, waits for at least one datagram to arrive.
+     * @throws Error if an unexpected error prevents receiving.
+     * @return The number of datagrams received, possibly 0 if block is false.
+     */
+    size_t recvBatch(Datagram *datagrams, size_t count, bool block = true);
+
+    /**
+     * @brief Enables generic segmentation offload (UDP_SEGMENT): each sent
+     * payload larger than the segment size is split by the kernel, or the
+     * NIC, into datagrams of that size, so a single send emits many.
+     *
+     * @param size The segment size, or 0 to disable segmentation.
+     * @throws Error if segmentation offload is not supported.
+     * @return A reference to this object for chaining.
+     */
+    UDPSocket & setSendSegmentSize(uint16_t size);
+
+    /**
+     * @brief Enables generic receive offload (UDP_GRO): runs of equally sized
+     * datagrams from the same flow may be delivered coalesced into a single
+     * buffer, with Datagram::segmentSize set to the size of each datagram.
+     *
+     * @param enable Whether to enable receive coalescing.
+     * @throws Error if receive offload is not supported.
+     * @return A reference to this object for chaining.
+     */
+    UDPSocket & setReceiveCoalescing(bool enable = true);
+
+    /**
+     * @brief Waits until the socket is ready for the given events.
+     *
+     * @param events Reactor::READ, Reactor::WRITE, or both.
+     * @param timeoutMillis Timeout in milliseconds, or -1 to wait
+     * indefinitely.
+     * @return True if the socket may be ready, false if the timeout expired.
+     */
+    bool waitReady(uint32_t events, int timeoutMillis = -1);
+
+    /**
+     * @brief Closes the underlying file descriptor.
+     */
+    void close();
+};
+
+}
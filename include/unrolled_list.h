@@ -0,0 +1,755 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#pragma once
+
+#include <initializer_list>
+#include <type_traits>
+
+#include <container.h>
+#include <exception.h>
+#include <iterator.h>
+#include <serialization.h>
+
+namespace spl {
+
+/**
+ * @brief An unrolled singly-linked list. Elements are stored contiguously in
+ * chunks of up to ChunkCapacity elements, so that iterating over the list
+ * mostly walks arrays and the per-element memory overhead is a small fraction
+ * of that of List.
+ *
+ * @tparam T The type of list elements.
+ * @tparam ChunkCapacity The maximum number of elements per chunk.
+ * (default = 64)
+ */
+template <typename T, size_t ChunkCapacity = 64>
+class UnrolledList
+:   public ForwardIterableContainer<UnrolledList<T, ChunkCapacity>>,
+    public Serializable
+{
+
+    static_assert(ChunkCapacity > 0, "ChunkCapacity must be positive");
+
+    template <typename ListType> friend struct UnrolledListTester;
+
+private:
+
+    struct Chunk {
+        Chunk *next = nullptr;
+        size_t begin;       // elements occupy [begin, end)
+        size_t end;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type data[ChunkCapacity];
+
+        Chunk(size_t pos)
+        :   begin(pos),
+            end(pos)
+        { }
+
+        T * at(size_t i) {
+            return reinterpret_cast<T *>(&data[i]);
+        }
+
+        size_t size() const {
+            return end - begin;
+        }
+
+        ~Chunk() {
+            for (size_t i = begin; i < end; ++i) at(i)->~T();
+        }
+    };
+
+    Chunk *_head = nullptr;
+    Chunk *_tail = nullptr;
+    size_t _size = 0;
+
+    template <typename X>
+    class UnrolledListIterator
+    :   public ForwardIterator<UnrolledListIterator<X>, X> {
+
+        friend class UnrolledList;
+
+    private:
+
+        Chunk *_prev;
+        Chunk *_chunk;
+        size_t _pos;
+
+        UnrolledListIterator(Chunk *chunk, Chunk *prev = nullptr)
+        :   _prev(prev),
+            _chunk(chunk),
+            _pos(chunk == nullptr ? 0 : chunk->begin)
+        { }
+
+        void _nextChunk() {
+            _prev = _chunk;
+            _chunk = _chunk->next;
+            _pos = _chunk == nullptr ? 0 : _chunk->begin;
+        }
+
+    public:
+
+        using reference = typename ForwardIterator<UnrolledListIterator<X>, X>::reference;
+        using pointer = typename ForwardIterator<UnrolledListIterator<X>, X>::pointer;
+
+        UnrolledListIterator(const UnrolledListIterator &) = default;
+
+        UnrolledListIterator(UnrolledListIterator &&) = default;
+
+        ~UnrolledListIterator() = default;
+
+        UnrolledListIterator & operator=(const UnrolledListIterator &) = default;
+
+        UnrolledListIterator & operator=(UnrolledListIterator &&) = default;
+
+        bool operator==(const UnrolledListIterator &rhs) const {
+            return _chunk == rhs._chunk && _pos == rhs._pos;
+        }
+
+        bool operator!=(const UnrolledListIterator &rhs) const {
+            return ! operator==(rhs);
+        }
+
+        reference operator*() const {
+            return *_chunk->at(_pos);
+        }
+
+        pointer operator->() const {
+            return _chunk->at(_pos);
+        }
+
+        UnrolledListIterator & operator++() {
+            if (++_pos == _chunk->end) _nextChunk();
+            return *this;
+        }
+
+        UnrolledListIterator operator++(int) {
+            UnrolledListIterator current = *this;
+            operator++();
+            return current;
+        }
+    };
+
+    template <typename U>
+    void _append(U &&elem) {
+        if (_tail == nullptr || _tail->end == ChunkCapacity) {
+            Chunk *c = new Chunk(0);
+            if (_tail == nullptr) _head = c;
+            else _tail->next = c;
+            _tail = c;
+        }
+        new (_tail->at(_tail->end)) T(std::forward<U>(elem));
+        ++_tail->end;
+        ++_size;
+    }
+
+    template <typename U>
+    void _prepend(U &&elem) {
+        if (_head == nullptr || _head->begin == 0) {
+            Chunk *c = new Chunk(ChunkCapacity);
+            c->next = _head;
+            _head = c;
+            if (_tail == nullptr) _tail = c;
+        }
+        new (_head->at(_head->begin - 1)) T(std::forward<U>(elem));
+        --_head->begin;
+        ++_size;
+    }
+
+    void _unlink(Chunk *c, Chunk *prev) {
+        if (prev == nullptr) _head = c->next;
+        else prev->next = c->next;
+        if (_tail == c) _tail = prev;
+        delete c;
+    }
+
+    template <typename Begin, typename End>
+    void _copy(const Begin &begin, const End &end) {
+        for (auto it = begin; it != end; ++it) _append(*it);
+    }
+
+    template <typename Begin, typename End>
+    void _move(const Begin &begin, const End &end) {
+        for (auto it = begin; it != end; ++it) _append(std::move(*it));
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<
+            SupportsTrivialSerialization<X>::value && ! SupportsCustomSerialization<X>::value
+        , int>::type = 0
+    >
+    void _serialize(OutputStreamSerializer &serializer) const {
+        serializer << _size;
+        for (Chunk *c = _head; c != nullptr; c = c->next) {
+            serializer.put(c->at(c->begin), c->size() * sizeof(T));
+        }
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<SupportsCustomSerialization<X>::value, int>::type = 0
+    >
+    void _serialize(OutputStreamSerializer &serializer) const {
+        serializer << _size;
+        for (const auto &elem : *this) {
+            serializer << elem;
+        }
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<! SupportsSerialization<X>::value, int>::type = 0
+    >
+    void _serialize(OutputStreamSerializer &serializer) const {
+        throw DynamicMessageError(
+            "Type '", typeid(T).name(), "' cannot be serialized."
+        );
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<
+            SupportsTrivialSerialization<X>::value && ! SupportsCustomSerialization<X>::value
+            && std::is_trivially_copyable<X>::value && std::is_constructible<X>::value
+        , int>::type = 0
+    >
+    void _deserialize(InputStreamSerializer &serializer) {
+        size_t sz;
+        serializer >> sz;
+        while (sz > 0) {
+            if (_tail == nullptr || _tail->end == ChunkCapacity) {
+                Chunk *c = new Chunk(0);
+                if (_tail == nullptr) _head = c;
+                else _tail->next = c;
+                _tail = c;
+            }
+            // read straight into the chunk storage
+            size_t n = std::min(sz, ChunkCapacity - _tail->end);
+            serializer.get(_tail->at(_tail->end), n * sizeof(T));
+            _tail->end += n;
+            _size += n;
+            sz -= n;
+        }
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<
+            SupportsTrivialSerialization<X>::value && ! SupportsCustomSerialization<X>::value
+            && ! std::is_trivially_copyable<X>::value && std::is_constructible<X>::value
+        , int>::type = 0
+    >
+    void _deserialize(InputStreamSerializer &serializer) {
+        size_t sz;
+        serializer >> sz;
+        serializer.getRange<T>(sz, [this] (const T &elem) {
+            _append(elem);
+        });
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<SupportsCustomSerialization<X>::value && std::is_constructible<X>::value, int>::type = 0
+    >
+    void _deserialize(InputStreamSerializer &serializer) {
+        size_t sz;
+        serializer >> sz;
+        for (size_t i = 0; i < sz; ++i) {
+            T elem;
+            serializer >> elem;
+            _append(std::move(elem));
+        }
+    }
+
+    template <
+        typename X = T,
+        typename std::enable_if<! SupportsSerialization<X>::value || ! std::is_constructible<X>::value, int>::type = 0
+    >
+    void _deserialize(InputStreamSerializer &serializer) {
+        throw DynamicMessageError(
+            "Type '", typeid(T).name(), "' cannot be deserialized."
+        );
+    }
+
+public:
+
+    using Iterator = UnrolledListIterator<T>;
+    using ConstIterator = UnrolledListIterator<const T>;
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     */
+    UnrolledList() = default;
+
+    UnrolledList(const UnrolledList &rhs) {
+        _copy(rhs.begin(), rhs.end());
+    }
+
+    UnrolledList(UnrolledList &&rhs)
+    :   _head(rhs._head),
+        _tail(rhs._tail),
+        _size(rhs._size)
+    {
+        rhs._head = nullptr;
+        rhs._tail = nullptr;
+        rhs._size = 0;
+    }
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     *
+     * @param list An initializer list of objects of type T.
+     */
+    UnrolledList(const std::initializer_list<T> &list) {
+        _copy(list.begin(), list.end());
+    }
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     *
+     * @param seq An iterable container of type T objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_base_of<UnrolledList, Sequence>::value, int>::type = 0
+    >
+    UnrolledList(const Sequence &seq) {
+        _copy(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     *
+     * @param seq An iterable container of type T objects.
+     */
+    template <
+        typename Sequence,
+        typename std::enable_if<! std::is_base_of<UnrolledList, typename std::decay<Sequence>::type>::value, int>::type = 0,
+        typename std::enable_if<! std::is_lvalue_reference<Sequence>::value, int>::type = 0
+    >
+    UnrolledList(Sequence &&seq) {
+        _move(seq.begin(), seq.end());
+    }
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     *
+     * @param begin A beginning iterator over type T objects.
+     * @param end An end iterator over type T objects.
+     */
+    template <typename Begin, typename End>
+    UnrolledList(const Begin &begin, const End &end) {
+        _copy(begin, end);
+    }
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     *
+     * @param begin A beginning iterator over type T objects.
+     * @param end An end iterator over type T objects.
+     * @param size The number of elements between begin and end.
+     */
+    template <typename Begin, typename End>
+    UnrolledList(const Begin &begin, const End &end, size_t size) {
+        _copy(begin, end);
+    }
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     *
+     * @tparam It A beginning iterator type that defines the typename
+     * `value_type` which will determine the resulting type.
+     * @tparam EndIt An end iterator type.
+     * @param begin The beginning iterator.
+     * @param end The end iterator.
+     * @return A new UnrolledList object of type It::value_type objects.
+     */
+    template <typename It, typename EndIt>
+    static UnrolledList<typename It::value_type, ChunkCapacity> create(const It &begin, const EndIt &end) {
+        return UnrolledList<typename It::value_type, ChunkCapacity>(begin, end);
+    }
+
+    /**
+     * @brief Construct a new UnrolledList object.
+     *
+     * @tparam It A beginning iterator type that defines the typename
+     * `value_type` which will determine the resulting type.
+     * @tparam EndIt An end iterator type.
+     * @param begin The beginning iterator.
+     * @param end The end iterator.
+     * @param size The number of elements between begin and end.
+     * @return A new UnrolledList object of type It::value_type objects.
+     */
+    template <typename It, typename EndIt>
+    static UnrolledList<typename It::value_type, ChunkCapacity> create(const It &begin, const EndIt &end, size_t size) {
+        return UnrolledList<typename It::value_type, ChunkCapacity>(begin, end, size);
+    }
+
+    ~UnrolledList() {
+        clear();
+    }
+
+    UnrolledList & operator=(const UnrolledList &rhs) {
+        if (this != &rhs) {
+            clear();
+            _copy(rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+
+    UnrolledList & operator=(UnrolledList &&rhs) {
+        if (this != &rhs) {
+            clear();
+            _head = rhs._head;
+            _tail = rhs._tail;
+            _size = rhs._size;
+            rhs._head = nullptr;
+            rhs._tail = nullptr;
+            rhs._size = 0;
+        }
+        return *this;
+    }
+
+    void writeObject(OutputStreamSerializer &serializer) const override {
+        _serialize(serializer);
+    }
+
+    void readObject(InputStreamSerializer &serializer) override {
+        _deserialize(serializer);
+    }
+
+    /**
+     * @return The size of this container.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is empty.
+     */
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @return A boolean indicating whether this container is non-empty.
+     */
+    bool nonEmpty() const {
+        return _size != 0;
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator cbegin() const {
+        return ConstIterator(_head);
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator cend() const {
+        return ConstIterator(nullptr, _tail);
+    }
+
+    /**
+     * @return An iterator pointing to the beginning of this container.
+     */
+    Iterator begin() {
+        return Iterator(_head);
+    }
+
+    /**
+     * @return A constant iterator pointing to the beginning of this container.
+     */
+    ConstIterator begin() const {
+        return cbegin();
+    }
+
+    /**
+     * @return An iterator pointing to a past-the-end position.
+     */
+    Iterator end() {
+        return Iterator(nullptr, _tail);
+    }
+
+    /**
+     * @return A constant iterator pointing to a past-the-end position.
+     */
+    ConstIterator end() const {
+        return cend();
+    }
+
+    /**
+     * @return A reference to the first element of this container.
+     */
+    T & front() {
+        return *_head->at(_head->begin);
+    }
+
+    /**
+     * @return A constant reference to the first element of this container.
+     */
+    const T & front() const {
+        return *_head->at(_head->begin);
+    }
+
+    /**
+     * @return A reference to the last element of this container.
+     */
+    T & back() {
+        return *_tail->at(_tail->end - 1);
+    }
+
+    /**
+     * @return A constant reference to the last element of this container.
+     */
+    const T & back() const {
+        return *_tail->at(_tail->end - 1);
+    }
+
+    /**
+     * @brief Iterates over the elements of this container applying the given
+     * function. This walks each chunk as an array.
+     *
+     * @param[in] f The functor to call for every element.
+     */
+    template <typename F>
+    const UnrolledList & foreach(F f) const {
+        for (Chunk *c = _head; c != nullptr; c = c->next) {
+            for (size_t i = c->begin, end = c->end; i < end; ++i) f(*static_cast<const T *>(c->at(i)));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Iterates over the elements of this container applying the given
+     * function. This walks each chunk as an array.
+     *
+     * @param[in] f The functor to call for every element.
+     */
+    template <typename F>
+    UnrolledList & foreach(F f) {
+        for (Chunk *c = _head; c != nullptr; c = c->next) {
+            for (size_t i = c->begin, end = c->end; i < end; ++i) f(*c->at(i));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Erases all elements in this container.
+     *
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & clear() {
+        while (_head != nullptr) {
+            Chunk *c = _head;
+            _head = c->next;
+            delete c;
+        }
+        _tail = nullptr;
+        _size = 0;
+        return *this;
+    }
+
+    /**
+     * @brief Inserts an element to the front of this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & prepend(const T &elem) {
+        _prepend(elem);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts an element to the front of this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & prepend(T &&elem) {
+        _prepend(std::move(elem));
+        return *this;
+    }
+
+    /**
+     * @brief Inserts an element to the front of a list.
+     *
+     * @param[in] elem The element to insert.
+     * @param[in] list The target list.
+     * @return A reference to the list for chaining.
+     */
+    friend UnrolledList & operator>>(const T &elem, UnrolledList &list) {
+        return list.prepend(elem);
+    }
+
+    /**
+     * @brief Inserts an element to the front of a list.
+     *
+     * @param[in] elem The element to insert.
+     * @param[in] list The target list.
+     * @return A reference to the list for chaining.
+     */
+    friend UnrolledList & operator>>(T &&elem, UnrolledList &list) {
+        return list.prepend(std::move(elem));
+    }
+
+    /**
+     * @brief Inserts an element to the back of this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & append(const T &elem) {
+        _append(elem);
+        return *this;
+    }
+
+    /**
+     * @brief Inserts an element to the back of this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & append(T &&elem) {
+        _append(std::move(elem));
+        return *this;
+    }
+
+    /**
+     * @brief Inserts an element to the back of this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & operator<<(const T &elem) {
+        return append(elem);
+    }
+
+    /**
+     * @brief Inserts an element to the back of this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & operator<<(T &&elem) {
+        return append(std::move(elem));
+    }
+
+    /**
+     * @brief Inserts an element into this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & insert(const T &elem) {
+        return append(elem);
+    }
+
+    /**
+     * @brief Inserts an element into this list.
+     *
+     * @param[in] elem The element to insert.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & insert(T &&elem) {
+        return append(std::move(elem));
+    }
+
+    /**
+     * @brief Removes the first element of this list and returns it.
+     *
+     * @return The removed element.
+     */
+    T takeFront() {
+        if (_head == nullptr) throw OutOfRangeError("Attempt to remove an element from an empty list");
+
+        T *elem = _head->at(_head->begin);
+        T data = std::move(*elem);
+        elem->~T();
+        ++_head->begin;
+        --_size;
+        if (_head->size() == 0) _unlink(_head, nullptr);
+        return data;
+    }
+
+    /**
+     * @brief Erases an element at the indicated position. Later elements in
+     * the same chunk are shifted down.
+     *
+     * @param pos An iterator pointing to the element to be erased. The
+     * iterator will be moved to the next element before the element is erased.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & erase(Iterator &pos) {
+        if (pos._chunk == nullptr) {
+            throw OutOfRangeError("Attempt to remove an element at a past-the-end iterator");
+        }
+
+        Chunk *c = pos._chunk;
+        for (size_t i = pos._pos + 1; i < c->end; ++i) {
+            *c->at(i - 1) = std::move(*c->at(i));
+        }
+        c->at(--c->end)->~T();
+        --_size;
+
+        if (c->size() == 0) {
+            // the iterator moves to the following chunk, keeping its prev
+            pos._chunk = c->next;
+            pos._pos = pos._chunk == nullptr ? 0 : pos._chunk->begin;
+            _unlink(c, pos._prev);
+        }
+        else if (pos._pos == c->end) {
+            pos._nextChunk();
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Erases an element at the indicated position. Later elements in
+     * the same chunk are shifted down.
+     *
+     * @param pos An iterator pointing to the element to be erased. The
+     * iterator will be moved to the next element before the element is erased.
+     * @return A reference to this container for chaining.
+     */
+    UnrolledList & erase(Iterator &&pos) {
+        return erase(pos);
+    }
+
+    /**
+     * @brief Removes an element from the indicated position and returns it.
+     *
+     * @param pos An iterator pointing to the element to be removed. The
+     * iterator will be moved to the next element before the element is removed.
+     * @return The removed element.
+     */
+    T remove(Iterator &pos) {
+        if (pos._chunk == nullptr) {
+            throw OutOfRangeError("Attempt to remove an element at a past-the-end iterator");
+        }
+        T data = std::move(*pos);
+        erase(pos);
+        return data;
+    }
+
+    /**
+     * @brief Removes an element from the indicated position and returns it.
+     *
+     * @param pos An iterator pointing to the element to be removed. The
+     * iterator will be moved to the next element before the element is removed.
+     * @return The removed element.
+     */
+    T remove(Iterator &&pos) {
+        return remove(pos);
+    }
+};
+
+}   // namespace spl
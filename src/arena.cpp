@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <arena.h>
+#include <cstdlib>
+#include <new>
+
+using namespace spl;
+
+static thread_local Arena *__currentArena = nullptr;
+
+Arena::Scope::Scope(Arena &arena)
+:   _prev(__currentArena)
+{
+    __currentArena = &arena;
+}
+
+Arena::Scope::~Scope() {
+    __currentArena = _prev;
+}
+
+Arena * Arena::current() {
+    return __currentArena;
+}
+
+Arena::Chunk * Arena::_newChunk(size_t size) {
+    void *mem = malloc(sizeof(Chunk) + size);
+    if (mem == nullptr) throw std::bad_alloc();
+    Chunk *c = static_cast<Chunk *>(mem);
+    c->size = size;
+    return c;
+}
+
+void * Arena::_allocateSlow(size_t size, size_t align) {
+    Chunk *c;
+    size_t needed = size + align;
+
+    if (needed > _chunkSize) {
+        // dedicated chunk, placed behind the current one so that the rest of
+        // the current chunk remains usable
+        c = _newChunk(needed);
+        if (_chunks == nullptr) {
+            c->next = nullptr;
+            _chunks = c;
+        }
+        else {
+            c->next = _chunks->next;
+            _chunks->next = c;
+        }
+
+        uintptr_t start = reinterpret_cast<uintptr_t>(c + 1);
+        uintptr_t p = (start + align - 1) & ~(uintptr_t) (align - 1);
+        _allocated += size;
+        return reinterpret_cast<void *>(p);
+    }
+
+    if (_spare != nullptr) {
+        c = _spare;
+        _spare = c->next;
+    }
+    else {
+        c = _newChunk(_chunkSize);
+    }
+    c->next = _chunks;
+    _chunks = c;
+
+    _ptr = reinterpret_cast<uintptr_t>(c + 1);
+    _end = _ptr + c->size;
+
+    uintptr_t p = (_ptr + align - 1) & ~(uintptr_t) (align - 1);
+    _ptr = p + size;
+    _allocated += size;
+    return reinterpret_cast<void *>(p);
+}
+
+Arena & Arena::reset() {
+    while (_chunks != nullptr) {
+        Chunk *c = _chunks;
+        _chunks = c->next;
+        if (c->size == _chunkSize) {
+            c->next = _spare;
+            _spare = c;
+        }
+        else {
+            free(c);
+        }
+    }
+    _ptr = 0;
+    _end = 0;
+    _allocated = 0;
+    return *this;
+}
+
+Arena & Arena::release() {
+    reset();
+    while (_spare != nullptr) {
+        Chunk *c = _spare;
+        _spare = c->next;
+        free(c);
+    }
+    return *this;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (Chunk *c = _chunks; c != nullptr; c = c->next) total += c->size;
+    for (Chunk *c = _spare; c != nullptr; c = c->next) total += c->size;
+    return total;
+}
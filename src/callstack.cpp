@@ -8,18 +8,55 @@
 #include <dlfcn.h>
 #include <cxxabi.h>    // for __cxa_demangle
 #include <sstream>
+#include <atomic>
 
 using namespace spl;
 
+#ifdef NDEBUG
+static std::atomic<int> __capture((int) CallStack::Capture::NONE);
+#else
+static std::atomic<int> __capture((int) CallStack::Capture::FULL);
+#endif
+static std::atomic<unsigned> __sampleInterval(64);
+
+bool CallStack::_shouldCapture() {
+    switch ((Capture) __capture.load(std::memory_order_relaxed)) {
+    case Capture::NONE:
+        return false;
+
+    case Capture::SAMPLED: {
+        static thread_local unsigned count = 0;
+        return count++ % __sampleInterval.load(std::memory_order_relaxed) == 0;
+    }
+
+    default:
+        return true;
+    }
+}
+
 CallStack CallStack::trace(int skip) {
+    CallStack cs;
+    if (! _shouldCapture()) return cs;
+
     ++skip;
-    void **stack = (void **) malloc((_MAX_STACK_FRAMES + skip) * sizeof(void *));
-    int nFrames = backtrace(stack, _MAX_STACK_FRAMES + skip);
+    if (skip > _MAX_SKIP) skip = _MAX_SKIP;
+    cs._len = backtrace(cs._stack, _MAX_STACK_FRAMES + skip);
+    cs._skip = skip < cs._len ? skip : cs._len;
+    return cs;
+}
 
-    return { nFrames, stack, skip };
+void CallStack::setCapture(Capture capture, unsigned sampleInterval) {
+    __sampleInterval.store(sampleInterval > 0 ? sampleInterval : 1, std::memory_order_relaxed);
+    __capture.store((int) capture, std::memory_order_relaxed);
+}
+
+CallStack::Capture CallStack::capture() {
+    return (Capture) __capture.load(std::memory_order_relaxed);
 }
 
 std::string CallStack::toString() const noexcept {
+    if (empty()) return "[not captured]";
+
     std::stringstream s;
     char buf[1024];
 
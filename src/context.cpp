@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <core/context.h>
+
+#if defined(__x86_64__)
+
+// void __spl_switch_context(void **from, void *to)
+//   rdi = from, rsi = to
+asm(R"(
+    .text
+    .globl __spl_switch_context
+    .type __spl_switch_context, @function
+    .align 16
+__spl_switch_context:
+    .cfi_startproc
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .cfi_endproc
+    .size __spl_switch_context, .-__spl_switch_context
+
+    .globl __spl_start_context
+    .type __spl_start_context, @function
+    .align 16
+__spl_start_context:
+    .cfi_startproc
+    .cfi_undefined rip
+    callq *%r13
+    ud2
+    .cfi_endproc
+    .size __spl_start_context, .-__spl_start_context
+)");
+
+#elif defined(__aarch64__)
+
+// void __spl_switch_context(void **from, void *to)
+//   x0 = from, x1 = to
+asm(R"(
+    .text
+    .globl __spl_switch_context
+    .type __spl_switch_context, %function
+    .align 4
+__spl_switch_context:
+    .cfi_startproc
+    sub sp, sp, #160
+    stp d8, d9, [sp, #0]
+    stp d10, d11, [sp, #16]
+    stp d12, d13, [sp, #32]
+    stp d14, d15, [sp, #48]
+    stp x19, x20, [sp, #64]
+    stp x21, x22, [sp, #80]
+    stp x23, x24, [sp, #96]
+    stp x25, x26, [sp, #112]
+    stp x27, x28, [sp, #128]
+    stp x29, x30, [sp, #144]
+
+    mov x2, sp
+    str x2, [x0]
+    mov sp, x1
+
+    ldp d8, d9, [sp, #0]
+    ldp d10, d11, [sp, #16]
+    ldp d12, d13, [sp, #32]
+    ldp d14, d15, [sp, #48]
+    ldp x19, x20, [sp, #64]
+    ldp x21, x22, [sp, #80]
+    ldp x23, x24, [sp, #96]
+    ldp x25, x26, [sp, #112]
+    ldp x27, x28, [sp, #128]
+    ldp x29, x30, [sp, #144]
+    add sp, sp, #160
+    ret
+    .cfi_endproc
+    .size __spl_switch_context, .-__spl_switch_context
+
+    .globl __spl_start_context
+    .type __spl_start_context, %function
+    .align 4
+__spl_start_context:
+    .cfi_startproc
+    .cfi_undefined x30
+    blr x19
+    brk #0
+    .cfi_endproc
+    .size __spl_start_context, .-__spl_start_context
+)");
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <directory_walker.h>
+#include <thread_pool.h>
+#include <dirent.h>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <exception>
+
+using namespace spl;
+
+#define LISTING_BUFFER_SIZE (32 * 1024)
+#define TASK_STACK_SIZE (64 * 1024)
+
+struct DirectoryWalker::State {
+
+    struct Node {
+        Node *parent;
+        Path path;
+        std::atomic<size_t> pending;    // own listing and unfinished subdirectories
+
+        Node(Node *parent, Path &&path)
+        :   parent(parent),
+            path(std::move(path)),
+            pending(1)
+        { }
+    };
+
+    size_t threads;
+    ThreadPool<> *pool = nullptr;
+    std::deque<std::function<void()>> queue;    // sequential mode only
+
+    const Visitor *visit = nullptr;
+    bool removing = false;
+
+    std::atomic<size_t> outstanding;
+    Semaphore done;
+    std::atomic<bool> failed;
+    std::mutex errorMtx;
+    std::exception_ptr error;
+
+    State(size_t threads)
+    :   threads(threads),
+        outstanding(0),
+        failed(false)
+    {
+        if (threads > 0) pool = new ThreadPool<>(threads, TASK_STACK_SIZE);
+    }
+
+    ~State() {
+        if (pool != nullptr) {
+            pool->terminate();
+            delete pool;
+        }
+    }
+
+    static mode_t typeOf(unsigned char type) {
+        switch (type) {
+        case DT_REG:    return S_IFREG;
+        case DT_DIR:    return S_IFDIR;
+        case DT_LNK:    return S_IFLNK;
+        case DT_CHR:    return S_IFCHR;
+        case DT_BLK:    return S_IFBLK;
+        case DT_FIFO:   return S_IFIFO;
+        case DT_SOCK:   return S_IFSOCK;
+        default:        return 0;
+        }
+    }
+
+    void fail() {
+        std::lock_guard<std::mutex> lk(errorMtx);
+        if (! error) error = std::current_exception();
+        failed = true;
+    }
+
+    void spawn(Node *node) {
+        ++outstanding;
+        std::function<void()> task = [this, node] {
+            try {
+                if (! failed) list(node);
+            }
+            catch (...) {
+                fail();
+            }
+            release(node);
+            if (--outstanding == 0) done.notify();
+        };
+
+        if (pool != nullptr) {
+            pool->run([task] (ExecutionContext &) { task(); });
+        }
+        else {
+            queue.push_back(std::move(task));
+        }
+    }
+
+    void run(Node *root) {
+        failed = false;
+        error = nullptr;
+
+        spawn(root);
+        if (pool != nullptr) {
+            done.wait();
+        }
+        else {
+            while (! queue.empty()) {
+                std::function<void()> task = std::move(queue.front());
+                queue.pop_front();
+                task();
+            }
+            done.wait();
+        }
+
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    void release(Node *node) {
+        while (node != nullptr && --node->pending == 0) {
+            if (removing && ! failed) {
+                try {
+                    if (::rmdir(node->path.get()) != 0) throw ErrnoRuntimeError();
+                }
+                catch (...) {
+                    fail();
+                }
+            }
+            Node *parent = node->parent;
+            delete node;
+            node = parent;
+        }
+    }
+
+    void list(Node *node) {
+        int fd = ::open(node->path.get(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1) throw ErrnoRuntimeError();
+
+        char *buf = new char[LISTING_BUFFER_SIZE];
+        try {
+            ssize_t n;
+            while ((n = getdents64(fd, buf, LISTING_BUFFER_SIZE)) > 0) {
+                for (ssize_t i = 0; i < n; ) {
+                    dirent64 *d = (dirent64 *) (buf + i);
+                    i += d->d_reclen;
+                    entry(node, fd, d->d_name, d->d_type);
+                    if (failed) break;
+                }
+                if (failed) break;
+            }
+            if (n == -1) throw ErrnoRuntimeError();
+        }
+        catch (...) {
+            delete[] buf;
+            ::close(fd);
+            throw;
+        }
+
+        delete[] buf;
+        ::close(fd);
+    }
+
+    void entry(Node *node, int fd, const char *name, unsigned char dtype) {
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            return;
+        }
+
+        mode_t type = typeOf(dtype);
+        struct stat st;
+        bool haveStat = false;
+        if (type == 0) {
+            // the filesystem does not report types in listings
+            if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) throw ErrnoRuntimeError();
+            type = st.st_mode & S_IFMT;
+            haveStat = true;
+        }
+
+        bool dir = S_ISDIR(type);
+
+        if (removing) {
+            if (dir) {
+                ++node->pending;
+                spawn(new Node(node, node->path.append(name)));
+            }
+            else if (unlinkat(fd, name, 0) != 0) {
+                throw ErrnoRuntimeError();
+            }
+            return;
+        }
+
+        Path path = node->path.append(name);
+        PathInfo info = S_ISLNK(type)
+            // PathInfo follows links, so the type of the link itself is not kept
+            ? PathInfo(std::move(path))
+            : haveStat ? PathInfo(std::move(path), st) : PathInfo(std::move(path), type);
+
+        if ((*visit)(info) && dir) {
+            spawn(new Node(nullptr, Path(info.path())));
+        }
+    }
+};
+
+DirectoryWalker::DirectoryWalker(size_t threads)
+:   _state(new State(threads))
+{ }
+
+DirectoryWalker::~DirectoryWalker() {
+    delete _state;
+}
+
+DirectoryWalker & DirectoryWalker::walk(const Path &root, const Visitor &visit) {
+    _state->visit = &visit;
+    _state->removing = false;
+    _state->run(new State::Node(nullptr, Path(root)));
+    return *this;
+}
+
+DirectoryWalker & DirectoryWalker::remove(const Path &root) {
+    struct stat st;
+    if (lstat(root.get(), &st) != 0) throw ErrnoRuntimeError();
+
+    if (! S_ISDIR(st.st_mode)) {
+        File::remove(root);
+        return *this;
+    }
+
+    _state->visit = nullptr;
+    _state->removing = true;
+    _state->run(new State::Node(nullptr, Path(root)));
+    return *this;
+}
+
+size_t DirectoryWalker::threads() const {
+    return _state->threads;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <core/epoch.h>
+#include <cstdlib>
+#include <new>
+
+using namespace spl::core;
+
+std::atomic<uint64_t> Epoch::_global(1);
+std::atomic<Epoch::Record *> Epoch::_records(nullptr);
+thread_local Epoch::LocalRecord Epoch::_local;
+
+Epoch::Record * Epoch::_acquire() {
+    // reuse a record released by an exited thread
+    for (Record *r = _records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        bool unused = false;
+        if (
+            ! r->used.load(std::memory_order_relaxed)
+            && r->used.compare_exchange_strong(unused, true, std::memory_order_acquire)
+        ) {
+            r->depth = 0;
+            return r;
+        }
+    }
+
+    void *mem;
+    if (posix_memalign(&mem, alignof(Record), sizeof(Record)) != 0) throw std::bad_alloc();
+
+    Record *r = new (mem) Record();
+    r->epoch.store(0, std::memory_order_relaxed);
+    r->used.store(true, std::memory_order_relaxed);
+    r->depth = 0;
+
+    // records are never freed, so a plain lock-free push suffices
+    r->next = _records.load(std::memory_order_relaxed);
+    while (! _records.compare_exchange_weak(r->next, r, std::memory_order_release)) { }
+
+    return r;
+}
+
+bool Epoch::quiescent(uint64_t epoch) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (Record *r = _records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        uint64_t e = r->epoch.load(std::memory_order_acquire);
+        if (e != 0 && e < epoch) return false;
+    }
+    return true;
+}
@@ -4,29 +4,71 @@
 */
 
 #include <factory.h>
-#include <hash_map.h>
 #include <exception.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 using namespace spl;
 
-static HashMap<size_t, void *> & _repo() {
-    static HashMap<size_t, void *> __repo;
+namespace {
 
-    return __repo;
+/**
+ * @brief An immutable snapshot of the repository. Snapshots are never freed,
+ * so that entries handed out to callers stay valid.
+ */
+struct Table {
+    size_t mask;
+    std::vector<core::FactoryEntry> slots;
+
+    Table(const std::vector<core::FactoryEntry> &entries) {
+        size_t size = 16;
+        while (size < 2 * entries.size()) size <<= 1;
+        mask = size - 1;
+        slots.resize(size, core::FactoryEntry { 0, nullptr, nullptr });
+
+        for (const auto &e : entries) {
+            size_t i = e.code & mask;
+            while (! slots[i].empty()) i = (i + 1) & mask;
+            slots[i] = e;
+        }
+    }
+};
+
+std::atomic<const Table *> __table(nullptr);
+std::mutex __mtx;
+
+std::vector<core::FactoryEntry> & _entries() {
+    static std::vector<core::FactoryEntry> __entries;
+
+    return __entries;
 }
 
-void Factory::_put(size_t hashCode, void *factory) {
-    if (_repo().contains(hashCode)) {
+}
+
+void Factory::_put(size_t hashCode, void (*fn)(), void *function) {
+    std::lock_guard<std::mutex> lock(__mtx);
+
+    if (_find(hashCode) != nullptr) {
         throw RuntimeError("Duplicate object hash codes detected");
     }
-    _repo().put(hashCode, factory);
+    _entries().push_back(core::FactoryEntry { hashCode, fn, function });
+    __table.store(new Table(_entries()), std::memory_order_release);
 }
 
-void * Factory::_get(size_t hashCode) {
-    try {
-        return _repo().get(hashCode);
-    }
-    catch (const ElementNotFoundError &) {
-        throw InvalidArgument("No registered factory for this object type");
+const core::FactoryEntry * Factory::_find(size_t hashCode) {
+    const Table *t = __table.load(std::memory_order_acquire);
+    if (t == nullptr) return nullptr;
+
+    for (size_t i = hashCode & t->mask; ; i = (i + 1) & t->mask) {
+        const core::FactoryEntry &e = t->slots[i];
+        if (e.empty()) return nullptr;
+        if (e.code == hashCode) return &e;
     }
 }
+
+const core::FactoryEntry & Factory::_get(size_t hashCode) {
+    const core::FactoryEntry *e = _find(hashCode);
+    if (e == nullptr) throw InvalidArgument("No registered factory for this object type");
+    return *e;
+}
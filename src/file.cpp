@@ -10,6 +10,10 @@ using namespace spl;
 #include <glob.h>
 #include <cstring>
 #include <base64.h>
+#include <vector>
+#include <thread.h>
+#include <directory_walker.h>
+#include <io_stats.h>
 
 Path File::uniquePath(const char *dir, const char *prefix) {
     using namespace std::chrono;
@@ -20,12 +24,11 @@ Path File::uniquePath(const char *dir, const char *prefix) {
 
     do {
         uint64_t now = duration_cast<nanoseconds>(high_resolution_clock::now().time_since_epoch()).count();
-        size_t len;
-        char *tmp = Base64::encode(&now, sizeof(now), len);
+        char tmp[Base64::encodedLength(sizeof(now)) + 1];
+        tmp[Base64::encode(&now, sizeof(now), tmp)] = '\0';
         char *unsafe = nullptr;
         while ((unsafe = strchr(tmp, '/')) != nullptr) *unsafe = '-';
         unique = p.append((pre + tmp).c_str());
-        free(tmp);
     } while (exists(unique));
 
     return unique;
@@ -60,15 +63,7 @@ void File::mkdirs(const char *path) {
 }
 
 void File::rmdirs(const Path &path) {
-    PathInfo pi(path);
-
-    if (pi.isDir()) {
-        list(path.append("*")).foreach([] (const Path &path) {
-            rmdirs(path);
-        });
-    }
-
-    remove(path);
+    DirectoryWalker(0).remove(path);
 }
 
 List<Path> File::list(const char *pattern) {
@@ -87,9 +82,11 @@ List<Path> File::list(const char *pattern) {
 
 size_t File::read(void *buf, size_t len) {
     if (_fd == -1) open();
+    IOStats::Op op(IOPath::FILE_READ);
     size_t readBytes = 0;
     while (len > 0) {
         ssize_t x = ::read(_fd, (uint8_t *) buf + readBytes, len);
+        op.syscall(len, x);
         if (x == -1) throw ErrnoRuntimeError();
         if (x == 0) break;
         readBytes += x;
@@ -100,9 +97,11 @@ size_t File::read(void *buf, size_t len) {
 
 size_t File::read(off_t offset, void *buf, size_t len) {
     if (_fd == -1) open();
+    IOStats::Op op(IOPath::FILE_READ);
     size_t readBytes = 0;
     while (len > 0) {
         ssize_t x = ::pread(_fd, (uint8_t *) buf + readBytes, len, offset + (off_t) readBytes);
+        op.syscall(len, x);
         if (x == -1) throw ErrnoRuntimeError();
         if (x == 0) break;
         readBytes += x;
@@ -111,11 +110,37 @@ size_t File::read(off_t offset, void *buf, size_t len) {
     return readBytes;
 }
 
+/**
+ * @brief Sums the lengths of n iovec entries.
+ */
+static size_t _length(const iovec *v, int n) {
+    size_t len = 0;
+    for (int i = 0; i < n; ++i) len += v[i].iov_len;
+    return len;
+}
+
+/**
+ * @brief Consumes n bytes from the front of an iovec sequence, starting at
+ * index i.
+ */
+static void _consume(std::vector<iovec> &v, size_t &i, size_t n) {
+    while (i < v.size() && n >= v[i].iov_len) {
+        n -= v[i].iov_len;
+        ++i;
+    }
+    if (n > 0) {
+        v[i].iov_base = (uint8_t *) v[i].iov_base + n;
+        v[i].iov_len -= n;
+    }
+}
+
 void File::write(const void *buf, size_t len) {
     if (_fd == -1) open();
+    IOStats::Op op(IOPath::FILE_WRITE);
     size_t writtenBytes = 0;
     while (len > 0) {
         ssize_t x = ::write(_fd, (uint8_t *) buf + writtenBytes, len);
+        op.syscall(len, x);
         if (x == -1) throw ErrnoRuntimeError();
         writtenBytes += x;
         len -= x;
@@ -125,9 +150,11 @@ void File::write(const void *buf, size_t len) {
 
 void File::write(off_t offset, const void *buf, size_t len) {
     if (_fd == -1) open();
+    IOStats::Op op(IOPath::FILE_WRITE);
     size_t writtenBytes = 0;
     while (len > 0) {
         ssize_t x = ::pwrite(_fd, (uint8_t *) buf + writtenBytes, len, offset + (off_t) writtenBytes);
+        op.syscall(len, x);
         if (x == -1) throw ErrnoRuntimeError();
         writtenBytes += x;
         len -= x;
@@ -135,6 +162,37 @@ void File::write(off_t offset, const void *buf, size_t len) {
     _info.clear();
 }
 
+void File::write(const iovec *iov, int count) {
+    if (_fd == -1) open();
+    IOStats::Op op(IOPath::FILE_WRITE);
+    std::vector<iovec> v(iov, iov + count);
+    size_t i = 0;
+    while (i < v.size()) {
+        int n = (int) std::min(v.size() - i, (size_t) IOV_MAX);
+        ssize_t x = ::writev(_fd, &v[i], n);
+        op.syscall(op.active() ? _length(&v[i], n) : 0, x);
+        if (x == -1) throw ErrnoRuntimeError();
+        _consume(v, i, x);
+    }
+    _info.clear();
+}
+
+void File::write(off_t offset, const iovec *iov, int count) {
+    if (_fd == -1) open();
+    IOStats::Op op(IOPath::FILE_WRITE);
+    std::vector<iovec> v(iov, iov + count);
+    size_t i = 0;
+    while (i < v.size()) {
+        int n = (int) std::min(v.size() - i, (size_t) IOV_MAX);
+        ssize_t x = ::pwritev(_fd, &v[i], n, offset);
+        op.syscall(op.active() ? _length(&v[i], n) : 0, x);
+        if (x == -1) throw ErrnoRuntimeError();
+        offset += x;
+        _consume(v, i, x);
+    }
+    _info.clear();
+}
+
 File & File::allocate(off_t offset, off_t len) {
     if (_fd == -1) open();
     if (fallocate(_fd, 0, offset, len) != 0) {
@@ -144,6 +202,15 @@ File & File::allocate(off_t offset, off_t len) {
     return *this;
 }
 
+File & File::truncate(off_t len) {
+    if (_fd == -1) open();
+    if (ftruncate(_fd, len) != 0) {
+        throw ErrnoRuntimeError();
+    }
+    _info.clear();
+    return *this;
+}
+
 File & File::deallocate(off_t offset, off_t len) {
     if (_fd == -1) open();
     if (fallocate(_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, len) != 0) {
@@ -171,11 +238,58 @@ File & File::collapse(off_t offset, off_t len) {
     return *this;
 }
 
-MemoryMapping File::map(off_t offset, size_t len, bool writeable) {
+bool File::direct() const {
+    if (_fd == -1) return false;
+    int flags = fcntl(_fd, F_GETFL);
+    if (flags == -1) throw ErrnoRuntimeError();
+    return flags & O_DIRECT;
+}
+
+File & File::setDirect(bool enable) {
+    if (_fd == -1) open();
+    int flags = fcntl(_fd, F_GETFL);
+    if (flags == -1) throw ErrnoRuntimeError();
+    flags = enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+    if (fcntl(_fd, F_SETFL, flags) == -1) throw ErrnoRuntimeError();
+    return *this;
+}
+
+File & File::advise(int advice, off_t offset, off_t len) {
+    if (_fd == -1) open();
+    int err = posix_fadvise(_fd, offset, len, advice);
+    if (err != 0) throw ErrnoRuntimeError(err);
+    return *this;
+}
+
+MemoryMapping & MemoryMapping::prefault(size_t offset, size_t len) {
+    uint8_t *p = (uint8_t *) _region(offset, len);
+
+#if defined(MADV_POPULATE_READ) && defined(MADV_POPULATE_WRITE)
+    if (madvise(p, len, _writeable ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) == 0) {
+        return *this;
+    }
+    if (errno != EINVAL) throw ErrnoRuntimeError();
+#endif
+
+    // not supported by the kernel, touch every page instead
+    size_t page = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < len; i += page) {
+        if (_writeable) {
+            __atomic_fetch_add(p + i, 0, __ATOMIC_RELAXED);
+        }
+        else {
+            (void) *(volatile uint8_t *) (p + i);
+        }
+    }
+    return *this;
+}
+
+MemoryMapping File::map(off_t offset, size_t len, bool writeable, bool populate) {
     if (_fd == -1) open();
 
-    int flags = MAP_NONBLOCK | MAP_NORESERVE;
-    if (writeable) flags |= MAP_SHARED;
+    int flags = MAP_NORESERVE;
+    flags |= writeable ? MAP_SHARED : MAP_PRIVATE;
+    flags |= populate ? MAP_POPULATE : MAP_NONBLOCK;
 
     int prot = PROT_READ;
     if (writeable) prot |= PROT_WRITE;
@@ -193,7 +307,7 @@ MemoryMapping File::map(off_t offset, size_t len, bool writeable) {
         throw ErrnoRuntimeError();
     }
 
-    return MemoryMapping(ptr, len);
+    return MemoryMapping(ptr, len, writeable);
 }
 
 flock _make_flock(short mode, off_t offset, off_t len) {
@@ -254,3 +368,255 @@ bool File::lock_test(short mode, off_t offset, off_t len) {
     if (fcntl(_fd, F_OFD_GETLK, &l) == -1) throw ErrnoRuntimeError();
     return l.l_type == F_UNLCK;
 }
+
+// Direct I/O //////////////////////////////////////////////////////////////////
+
+static uint8_t * _alignedAlloc(size_t size, size_t align) {
+    void *p;
+    int err = posix_memalign(&p, align, size);
+    if (err != 0) throw ErrnoRuntimeError(err);
+    return (uint8_t *) p;
+}
+
+static size_t _roundUp(size_t x, size_t multiple) {
+    return (x + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief Reads whole blocks from a file opened for direct I/O. A partial block
+ * is only returned at the end of the file, where reading stops.
+ */
+static size_t _readBlocks(int fd, off_t offset, uint8_t *buf, size_t len, size_t blockSize) {
+    IOStats::Op op(IOPath::FILE_READ);
+    size_t readBytes = 0;
+    while (len > 0) {
+        ssize_t x = ::pread(fd, buf + readBytes, len, offset + (off_t) readBytes);
+        op.syscall(len, x);
+        if (x == -1) throw ErrnoRuntimeError();
+        if (x == 0) break;
+        readBytes += x;
+        len -= x;
+        if (x % blockSize != 0) break;
+    }
+    return readBytes;
+}
+
+// OutputFileSerializer ////////////////////////////////////////////////////////
+
+void OutputFileSerializer::_startDirect() {
+    _f.setDirect();
+    size_t bs = _f.info().blockSize();
+    size_t size = _roundUp(_bufSize, bs);
+
+    uint8_t *buf = _alignedAlloc(size, bs);
+    try {
+        _bounce = _alignedAlloc(size + bs, bs);
+    }
+    catch (...) {
+        free(buf);
+        throw;
+    }
+
+    if (_allocated) delete[] _buf;
+    _allocated = false;
+    _buf = _cursor = _gatherCursor = buf;
+    _bufSize = _remaining = size;
+    _bounceSize = size + bs;
+    _blockSize = bs;
+    _end = _f.info().length();
+}
+
+OutputFileSerializer::~OutputFileSerializer() {
+    if (_blockSize != 0) {
+        free(_buf);
+        free(_bounce);
+    }
+}
+
+void OutputFileSerializer::_writeDirect(size_t position, const void *data, size_t len) {
+    const uint8_t *src = (const uint8_t *) data;
+    size_t bs = _blockSize;
+    size_t end = position + len;
+    size_t written = 0;
+
+    if (position % bs == 0 && len % bs == 0 && (uintptr_t) src % bs == 0) {
+        _f.write(position, src, len);
+        written = end;
+    }
+    else while (len > 0) {
+        size_t start = position / bs * bs;
+        size_t head = position - start;
+        size_t l = std::min(len, _bounceSize - head);
+        size_t span = _roundUp(head + l, bs);
+
+        // keep the existing contents of partially overwritten blocks
+        if (head != 0) {
+            size_t n = start < _end ? _readBlocks(_f.fd(), start, _bounce, bs, bs) : 0;
+            memset(_bounce + n, 0, bs - n);
+        }
+        if ((head + l) % bs != 0 && (head == 0 || span > bs)) {
+            size_t last = start + span - bs;
+            size_t n = last < _end ? _readBlocks(_f.fd(), last, _bounce + span - bs, bs, bs) : 0;
+            memset(_bounce + span - bs + n, 0, bs - n);
+        }
+
+        memcpy(_bounce + head, src, l);
+        _f.write(start, _bounce, span);
+        written = start + span;
+
+        position += l;
+        src += l;
+        len -= l;
+    }
+
+    if (end > _end) _end = end;
+    // drop the padding of the last block
+    if (written > _end) _f.truncate(_end);
+}
+
+// InputFileSerializer /////////////////////////////////////////////////////////
+
+struct InputFileSerializer::Readahead {
+    InputFileSerializer &s;
+    uint8_t *buf;
+    size_t capacity;
+    size_t offset = 0;
+    size_t len = 0;
+    bool pending = false;
+    bool stop = false;
+    Semaphore request;
+    Semaphore done;
+    Thread worker;
+
+    Readahead(InputFileSerializer &s, size_t capacity)
+    :   s(s),
+        buf(_alignedAlloc(capacity, s._blockSize != 0 ? s._blockSize : alignof(std::max_align_t))),
+        capacity(capacity),
+        worker([this] { run(); })
+    { }
+
+    ~Readahead() {
+        wait();
+        stop = true;
+        request.notify();
+        worker.join();
+        free(buf);
+    }
+
+    void run() {
+        while (true) {
+            request.wait();
+            if (stop) break;
+            try {
+                len = s._readFile(offset, buf, len);
+            }
+            catch (...) {
+                // nothing prefetched; the synchronous read reports the error
+                len = 0;
+            }
+            done.notify();
+        }
+    }
+
+    void wait() {
+        if (pending) {
+            done.wait();
+            pending = false;
+        }
+    }
+
+    void issue(size_t position, size_t length) {
+        offset = position;
+        len = length;
+        pending = true;
+        request.notify();
+    }
+
+    bool take(size_t position, void *data, size_t length) {
+        wait();
+        if (position < offset || position + length > offset + len) return false;
+        memcpy(data, buf + (position - offset), length);
+        return true;
+    }
+};
+
+void InputFileSerializer::_startReadahead() {
+    _f.open();
+    _f.advise(POSIX_FADV_SEQUENTIAL);
+    _readahead = new Readahead(*this, _bufSize);
+}
+
+void InputFileSerializer::_startDirect() {
+    _f.setDirect();
+    size_t bs = _f.info().blockSize();
+    size_t size = _roundUp(_bufSize, bs);
+
+    uint8_t *buf = _alignedAlloc(size, bs);
+    try {
+        _bounce = _alignedAlloc(size + bs, bs);
+    }
+    catch (...) {
+        free(buf);
+        throw;
+    }
+
+    if (_allocated) delete[] _buf;
+    _allocated = false;
+    _buf = buf;
+    _bufSize = size;
+    _bounceSize = size + bs;
+    _blockSize = bs;
+}
+
+InputFileSerializer::~InputFileSerializer() {
+    delete _readahead;
+    if (_blockSize != 0) {
+        free(_buf);
+        free(_bounce);
+    }
+}
+
+size_t InputFileSerializer::_readFile(size_t position, void *data, size_t len) {
+    size_t bs = _blockSize;
+    if (bs == 0) return _f.read(position, data, len);
+
+    uint8_t *dst = (uint8_t *) data;
+    if (position % bs == 0 && len % bs == 0 && (uintptr_t) dst % bs == 0) {
+        return _readBlocks(_f.fd(), position, dst, len, bs);
+    }
+
+    // the bounce buffer is shared with the readahead thread, which only runs
+    // while the serializer waits for it
+    size_t readBytes = 0;
+    while (readBytes < len) {
+        size_t start = position / bs * bs;
+        size_t head = position - start;
+        size_t l = std::min(len - readBytes, _bounceSize - head);
+
+        size_t n = _readBlocks(_f.fd(), start, _bounce, _roundUp(head + l, bs), bs);
+        if (n <= head) break;
+        n = std::min(n - head, l);
+        memcpy(dst + readBytes, _bounce + head, n);
+
+        readBytes += n;
+        position += n;
+        if (n < l) break;
+    }
+    return readBytes;
+}
+
+void InputFileSerializer::_readAt(size_t position, void *data, size_t len) {
+    if (_readahead == nullptr || ! _readahead->take(position, data, len)) {
+        if (_readFile(position, data, len) != len) {
+            throw RuntimeError("Failed to read the required bytes from file");
+        }
+    }
+
+    if (_readahead != nullptr) {
+        size_t next = position + len;
+        size_t end = length();
+        if (next < end) {
+            _readahead->issue(next, std::min(_readahead->capacity, end - next));
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <interned_string.h>
+#include <arena.h>
+#include <hash.h>
+#include <hash_set.h>
+#include <mutex>
+
+using namespace spl;
+
+using core::InternedEntry;
+
+namespace {
+
+struct Probe {
+    size_t hash;
+    const char *str;
+    size_t length;
+};
+
+struct EntryHash {
+    size_t operator()(const InternedEntry *entry) const {
+        return entry->hash;
+    }
+
+    size_t operator()(const Probe &probe) const {
+        return probe.hash;
+    }
+};
+
+struct EntryEqual {
+    bool operator()(const InternedEntry *lhs, const InternedEntry *rhs) const {
+        return lhs == rhs;
+    }
+
+    bool operator()(const InternedEntry *lhs, const Probe &rhs) const {
+        return lhs->hash == rhs.hash
+            && lhs->length == rhs.length
+            && memcmp(lhs->str, rhs.str, rhs.length) == 0;
+    }
+};
+
+struct InternTable {
+    std::mutex mtx;
+    Arena arena;
+    HashSet<const InternedEntry *, EntryHash, EntryEqual> entries;
+};
+
+// intentionally leaked, so that interned strings outlive static destructors
+InternTable & __table() {
+    static InternTable *table = new InternTable();
+    return *table;
+}
+
+const InternedEntry & __empty() {
+    static const InternedEntry empty = { hash("", 0), 0, { '\0' } };
+    return empty;
+}
+
+} // namespace
+
+const InternedEntry * InternedString::_intern(const char *str, size_t len) {
+    if (len == 0) return &__empty();
+
+    Probe probe = { spl::hash(str, len), str, len };
+    InternTable &table = __table();
+
+    std::lock_guard<std::mutex> lock(table.mtx);
+    const InternedEntry *entry = table.entries.getOr(probe, nullptr);
+    if (entry != nullptr) return entry;
+
+    InternedEntry *e = static_cast<InternedEntry *>(table.arena.allocate(
+        offsetof(InternedEntry, str) + len + 1,
+        alignof(InternedEntry)
+    ));
+    e->hash = probe.hash;
+    e->length = len;
+    memcpy(e->str, str, len);
+    e->str[len] = '\0';
+
+    table.entries.put(e);
+    return e;
+}
+
+size_t InternedString::count() {
+    InternTable &table = __table();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    return table.entries.size() + 1;
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <io_ring.h>
+#include <exception.h>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+using namespace spl;
+
+IORing::IORing(unsigned entries, bool synchronous) {
+    if (! synchronous) _setup(entries);
+}
+
+IORing::~IORing() {
+    // the kernel may still write into buffers of in-flight operations
+    if (_fd != -1) {
+        while (_inFlight > 0 || _queued > 0) {
+            _enter(_queued, 1);
+            _reap();
+        }
+    }
+    _release();
+}
+
+void IORing::_setup(unsigned entries) {
+    io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    int fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (fd == -1) return;   // not available, run synchronously
+    _fd = fd;
+
+    _sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    _cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) {
+        _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+    }
+
+    _sqRing = mmap(
+        nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        _fd, IORING_OFF_SQ_RING
+    );
+    if (_sqRing == MAP_FAILED) {
+        _sqRing = nullptr;
+        _release();
+        throw ErrnoRuntimeError();
+    }
+
+    if (single) {
+        _cqRing = _sqRing;
+    }
+    else {
+        _cqRing = mmap(
+            nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            _fd, IORING_OFF_CQ_RING
+        );
+        if (_cqRing == MAP_FAILED) {
+            _cqRing = nullptr;
+            _release();
+            throw ErrnoRuntimeError();
+        }
+    }
+
+    _sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(
+        nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        _fd, IORING_OFF_SQES
+    );
+    if (sqes == MAP_FAILED) {
+        _release();
+        throw ErrnoRuntimeError();
+    }
+    _sqes = (io_uring_sqe *) sqes;
+
+    uint8_t *sq = (uint8_t *) _sqRing;
+    uint8_t *cq = (uint8_t *) _cqRing;
+
+    _entries = p.sq_entries;
+    _cqEntries = p.cq_entries;
+    _sqHead = (unsigned *) (sq + p.sq_off.head);
+    _sqTail = (unsigned *) (sq + p.sq_off.tail);
+    _sqMask = *(unsigned *) (sq + p.sq_off.ring_mask);
+    _sqArray = (unsigned *) (sq + p.sq_off.array);
+    _cqHead = (unsigned *) (cq + p.cq_off.head);
+    _cqTail = (unsigned *) (cq + p.cq_off.tail);
+    _cqMask = *(unsigned *) (cq + p.cq_off.ring_mask);
+    _cqes = (io_uring_cqe *) (cq + p.cq_off.cqes);
+}
+
+void IORing::_release() {
+    if (_sqes != nullptr) munmap(_sqes, _sqesSize);
+    if (_cqRing != nullptr && _cqRing != _sqRing) munmap(_cqRing, _cqRingSize);
+    if (_sqRing != nullptr) munmap(_sqRing, _sqRingSize);
+    if (_fd != -1) close(_fd);
+
+    _sqes = nullptr;
+    _cqRing = nullptr;
+    _sqRing = nullptr;
+    _fd = -1;
+}
+
+unsigned IORing::_enter(unsigned submit, unsigned minComplete) {
+    unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+    while (true) {
+        int ret = syscall(__NR_io_uring_enter, _fd, submit, minComplete, flags, nullptr, 0);
+        if (ret >= 0) {
+            _queued -= ret;
+            _inFlight += ret;
+            return ret;
+        }
+
+        switch (errno) {
+        case EINTR:
+            break;
+
+        case EAGAIN:
+        case EBUSY:
+            // the completion queue is full, make room and retry
+            _reap();
+            break;
+
+        default:
+            throw ErrnoRuntimeError();
+        }
+    }
+}
+
+void IORing::_reap() {
+    unsigned head = *_cqHead;
+    unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        io_uring_cqe &cqe = _cqes[head & _cqMask];
+        _completed.push_back({ (uint64_t) cqe.user_data, (ssize_t) cqe.res });
+        --_inFlight;
+        ++head;
+    }
+
+    __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+}
+
+void IORing::_enqueue(const Operation &op) {
+    if (_fd == -1) {
+        _deferred.push_back(op);
+        return;
+    }
+
+    // keep the number of outstanding operations within the completion queue
+    while (_inFlight + _queued >= _cqEntries) {
+        _enter(_queued, 1);
+        _reap();
+    }
+
+    unsigned tail = *_sqTail;
+    if (tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _entries) {
+        _enter(_queued, 0);
+    }
+
+    unsigned index = tail & _sqMask;
+    io_uring_sqe &sqe = _sqes[index];
+    memset(&sqe, 0, sizeof(sqe));
+
+    sqe.opcode = op.opcode;
+    sqe.fd = op.fd;
+    sqe.off = op.offset;
+    sqe.user_data = op.tag;
+
+    switch (op.opcode) {
+    case IORING_OP_FSYNC:
+        sqe.fsync_flags = op.flags;
+        break;
+
+    case IORING_OP_FALLOCATE:
+        sqe.addr = op.len;
+        sqe.len = op.flags;
+        break;
+
+    default:
+        sqe.addr = (uint64_t) (uintptr_t) op.buf;
+        sqe.len = op.len;
+        break;
+    }
+
+    _sqArray[index] = index;
+    __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++_queued;
+}
+
+static ssize_t execute(uint8_t opcode, int fd, off_t offset, void *buf, size_t len, int flags) {
+    ssize_t ret;
+
+    switch (opcode) {
+    case IORING_OP_READ:
+        ret = pread(fd, buf, len, offset);
+        break;
+
+    case IORING_OP_WRITE:
+        ret = pwrite(fd, buf, len, offset);
+        break;
+
+    case IORING_OP_FSYNC:
+        ret = (flags & IORING_FSYNC_DATASYNC) ? fdatasync(fd) : fsync(fd);
+        break;
+
+    case IORING_OP_FALLOCATE:
+        ret = fallocate(fd, flags, offset, len);
+        break;
+
+    default:
+        errno = EINVAL;
+        ret = -1;
+    }
+
+    return ret == -1 ? -errno : ret;
+}
+
+size_t IORing::_take(IOCompletion *out, size_t maxCount) {
+    size_t n = std::min(maxCount, _completed.size());
+    if (n > 0) {
+        memcpy(out, _completed.data(), n * sizeof(IOCompletion));
+        _completed.erase(_completed.begin(), _completed.begin() + n);
+    }
+    return n;
+}
+
+IORing & IORing::read(int fd, off_t offset, void *buf, size_t len, uint64_t tag) {
+    _enqueue({ IORING_OP_READ, fd, offset, buf, len, 0, tag });
+    return *this;
+}
+
+IORing & IORing::write(int fd, off_t offset, const void *buf, size_t len, uint64_t tag) {
+    _enqueue({ IORING_OP_WRITE, fd, offset, const_cast<void *>(buf), len, 0, tag });
+    return *this;
+}
+
+IORing & IORing::sync(int fd, bool dataOnly, uint64_t tag) {
+    _enqueue({ IORING_OP_FSYNC, fd, 0, nullptr, 0, dataOnly ? (int) IORING_FSYNC_DATASYNC : 0, tag });
+    return *this;
+}
+
+IORing & IORing::allocate(int fd, int mode, off_t offset, off_t len, uint64_t tag) {
+    _enqueue({ IORING_OP_FALLOCATE, fd, offset, nullptr, (size_t) len, mode, tag });
+    return *this;
+}
+
+size_t IORing::submit() {
+    if (_fd == -1) {
+        size_t n = _deferred.size();
+        for (auto &op : _deferred) {
+            _completed.push_back({
+                op.tag,
+                execute(op.opcode, op.fd, op.offset, op.buf, op.len, op.flags)
+            });
+        }
+        _deferred.clear();
+        return n;
+    }
+
+    size_t n = 0;
+    while (_queued > 0) n += _enter(_queued, 0);
+    return n;
+}
+
+size_t IORing::poll(IOCompletion *out, size_t maxCount) {
+    if (_fd != -1) _reap();
+    return _take(out, maxCount);
+}
+
+size_t IORing::wait(IOCompletion *out, size_t maxCount, size_t minCount) {
+    submit();
+
+    if (_fd != -1) {
+        _reap();
+        while (_completed.size() < minCount && _inFlight > 0) {
+            _enter(0, 1);
+            _reap();
+        }
+    }
+
+    return _take(out, maxCount);
+}
+
+IORing & IORing::local() {
+    static thread_local IORing ring;
+    return ring;
+}
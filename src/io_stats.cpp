@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <io_stats.h>
+#include <json.h>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+using namespace spl;
+
+using core::IOPathCounters;
+
+std::atomic_bool IOStats::_enabled(false);
+
+namespace {
+
+// the counters of one thread, aligned so that threads do not share cache
+// lines
+struct alignas(64) ThreadCounters {
+    IOPathCounters paths[IOStats::PATHS];
+
+    ThreadCounters();
+
+    ~ThreadCounters();
+};
+
+struct Registry {
+    std::mutex mtx;
+    std::vector<ThreadCounters *> live;
+    IOStats::Snapshot exited;
+};
+
+// intentionally leaked, so that threads exiting during static destruction
+// still find it
+Registry & __registry() {
+    static Registry *registry = new Registry();
+    return *registry;
+}
+
+ThreadCounters::ThreadCounters() {
+    Registry &r = __registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    r.live.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+    Registry &r = __registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    for (size_t p = 0; p < IOStats::PATHS; ++p) {
+        IOPathStats s;
+        paths[p].snapshot(s);
+        r.exited.paths[p].merge(s);
+    }
+    r.live.erase(std::find(r.live.begin(), r.live.end(), this));
+}
+
+} // namespace
+
+void IOPathCounters::snapshot(IOPathStats &s) const {
+    s.operations = operations.load(std::memory_order_relaxed);
+    s.bytes = bytes.load(std::memory_order_relaxed);
+    s.syscalls = syscalls.load(std::memory_order_relaxed);
+    s.partial = partial.load(std::memory_order_relaxed);
+    s.retries = retries.load(std::memory_order_relaxed);
+    s.waits = waits.load(std::memory_order_relaxed);
+    s.blockedNanos = blockedNanos.load(std::memory_order_relaxed);
+    s.backoffs = backoffs.load(std::memory_order_relaxed);
+    latency.snapshot(s.latency);
+}
+
+IOPathCounters * IOStats::_local(IOPath path) {
+    static thread_local ThreadCounters counters;
+    return &counters.paths[(int) path];
+}
+
+const char * IOStats::name(IOPath path) {
+    switch (path) {
+    case IOPath::FILE_READ: return "file-read";
+    case IOPath::FILE_WRITE: return "file-write";
+    case IOPath::TCP_SEND: return "tcp-send";
+    case IOPath::TCP_RECV: return "tcp-recv";
+    case IOPath::SERIALIZER_FLUSH: return "serializer-flush";
+    case IOPath::SERIALIZER_FILL: return "serializer-fill";
+    }
+    return "unknown";
+}
+
+IOStats::Snapshot IOStats::snapshot() {
+    Registry &r = __registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+
+    Snapshot s = r.exited;
+    for (const ThreadCounters *t : r.live) {
+        for (size_t p = 0; p < PATHS; ++p) {
+            IOPathStats x;
+            t->paths[p].snapshot(x);
+            s.paths[p].merge(x);
+        }
+    }
+    return s;
+}
+
+std::string IOStats::dump() {
+    Snapshot s = snapshot();
+
+    std::string out;
+    JSONWriter w(out);
+    w.beginObject();
+    w.key("enabled").value(enabled());
+    for (size_t p = 0; p < PATHS; ++p) {
+        const IOPathStats &x = s.paths[p];
+        w.key(name((IOPath) p)).beginObject()
+            .key("operations").value(x.operations)
+            .key("bytes").value(x.bytes)
+            .key("syscalls").value(x.syscalls)
+            .key("partial").value(x.partial)
+            .key("retries").value(x.retries)
+            .key("waits").value(x.waits)
+            .key("blocked_ns").value(x.blockedNanos)
+            .key("backoffs").value(x.backoffs)
+            .key("latency").beginObject()
+                .key("count").value(x.latency.count())
+                .key("mean_ns").value(x.latency.mean())
+                .key("p50_ns").value(x.latency.percentile(50))
+                .key("p90_ns").value(x.latency.percentile(90))
+                .key("p99_ns").value(x.latency.percentile(99))
+                .key("p999_ns").value(x.latency.percentile(99.9))
+                .key("max_ns").value(x.latency.max())
+            .endObject()
+        .endObject();
+    }
+    w.endObject();
+    return out;
+}
@@ -4,6 +4,13 @@
 */
 
 #include <json.h>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 using namespace spl;
 
@@ -13,7 +20,7 @@ static constexpr char _UNESCAPED[] = {
     '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0',
     '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0',
     '\0', '\0', '\"', '\0', '\0', '\0', '\0', '\0',
-    '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0',
+    '\0', '\0', '\0', '\0', '\0', '\0', '\0', '/',
     '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0',
     '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0',
     '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0',
@@ -42,6 +49,278 @@ static constexpr char _UNESCAPED[] = {
     '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0',
 };
 
+/**
+ * @brief Byte-parallel primitives for scanning JSON text a block at a time.
+ * A mask has one bit per byte of a block (SHIFT = 0), or, on NEON, four bits
+ * per byte (SHIFT = 2).
+ */
+struct Block {
+
+#if defined(__AVX2__)
+    static constexpr size_t WIDTH = 32;
+    static constexpr int SHIFT = 0;
+    typedef __m256i Vector;
+
+    static Vector load(const char *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+
+    static Vector eq(Vector v, char c) {
+        return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+    }
+
+    static Vector below(Vector v, uint8_t c) {
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(static_cast<char>(c - 1))), v);
+    }
+
+    static Vector any(Vector a, Vector b) {
+        return _mm256_or_si256(a, b);
+    }
+
+    static Vector none(Vector v) {
+        return _mm256_xor_si256(v, _mm256_set1_epi8(-1));
+    }
+
+    static uint64_t mask(Vector v) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+    }
+#elif defined(__SSE2__)
+    static constexpr size_t WIDTH = 16;
+    static constexpr int SHIFT = 0;
+    typedef __m128i Vector;
+
+    static Vector load(const char *p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    }
+
+    static Vector eq(Vector v, char c) {
+        return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+    }
+
+    static Vector below(Vector v, uint8_t c) {
+        return _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(static_cast<char>(c - 1))), v);
+    }
+
+    static Vector any(Vector a, Vector b) {
+        return _mm_or_si128(a, b);
+    }
+
+    static Vector none(Vector v) {
+        return _mm_xor_si128(v, _mm_set1_epi8(-1));
+    }
+
+    static uint64_t mask(Vector v) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(v));
+    }
+#elif defined(__ARM_NEON)
+    static constexpr size_t WIDTH = 16;
+    static constexpr int SHIFT = 2;
+    typedef uint8x16_t Vector;
+
+    static Vector load(const char *p) {
+        return vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    }
+
+    static Vector eq(Vector v, char c) {
+        return vceqq_u8(v, vdupq_n_u8(static_cast<uint8_t>(c)));
+    }
+
+    static Vector below(Vector v, uint8_t c) {
+        return vcltq_u8(v, vdupq_n_u8(c));
+    }
+
+    static Vector any(Vector a, Vector b) {
+        return vorrq_u8(a, b);
+    }
+
+    static Vector none(Vector v) {
+        return vmvnq_u8(v);
+    }
+
+    static uint64_t mask(Vector v) {
+        // narrow each byte to a nibble, since NEON has no movemask
+        uint8x8_t n = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(n), 0);
+    }
+#else
+    static constexpr size_t WIDTH = 1;
+    static constexpr int SHIFT = 0;
+#endif
+
+    static size_t index(uint64_t mask) {
+        return __builtin_ctzll(mask) >> SHIFT;
+    }
+};
+
+/**
+ * @brief Bytes that must be escaped in a JSON string.
+ */
+struct EscapeStop {
+
+    static bool test(char c) {
+        return c == '"' || c == '\\' || (uint8_t) c < 0x20;
+    }
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    static uint64_t mask(Block::Vector v) {
+        return Block::mask(Block::any(Block::any(Block::eq(v, '"'), Block::eq(v, '\\')), Block::below(v, 0x20)));
+    }
+#endif
+};
+
+/**
+ * @brief Bytes that end an unescaped run in a JSON string. The terminator is
+ * included for scanning null-terminated input.
+ */
+struct StringStop {
+
+    static bool test(char c) {
+        return c == '"' || c == '\\' || c == '\0';
+    }
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    static uint64_t mask(Block::Vector v) {
+        return Block::mask(Block::any(Block::any(Block::eq(v, '"'), Block::eq(v, '\\')), Block::eq(v, '\0')));
+    }
+#endif
+};
+
+/**
+ * @brief Bytes that are not JSON whitespace.
+ */
+struct WhitespaceStop {
+
+    static bool test(char c) {
+        return c != ' ' && c != '\n' && c != '\r' && c != '\t';
+    }
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    static uint64_t mask(Block::Vector v) {
+        return Block::mask(Block::none(Block::any(
+            Block::any(Block::eq(v, ' '), Block::eq(v, '\n')),
+            Block::any(Block::eq(v, '\r'), Block::eq(v, '\t'))
+        )));
+    }
+#endif
+};
+
+/**
+ * @return The first byte in [p, end) matching Stop, or end if there is none.
+ */
+template <typename Stop>
+static const char * _scan(const char *p, const char *end) {
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    for (; end - p >= (ptrdiff_t) Block::WIDTH; p += Block::WIDTH) {
+        uint64_t mask = Stop::mask(Block::load(p));
+        if (mask != 0) return p + Block::index(mask);
+    }
+#endif
+    while (p < end && ! Stop::test(*p)) ++p;
+    return p;
+}
+
+/**
+ * @return The first byte from p matching Stop, which must match the null
+ * terminator.
+ */
+template <typename Stop>
+static const char * _scan(const char *p) {
+    // bound each block scan by the terminator, found a chunk at a time so
+    // that nothing past it is read and long inputs are not measured whole
+    static constexpr size_t CHUNK = 256;
+    while (true) {
+        const char *end = p + strnlen(p, CHUNK);
+        const char *q = _scan<Stop>(p, end);
+        if (q < end || *end == '\0') return q;
+        p = end;
+    }
+}
+
+static int _hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool _hex4(const char *str, const char *end, uint32_t &val) {
+    if (end - str < 4) return false;
+    val = 0;
+    for (int i = 0; i < 4; ++i) {
+        int d = _hexDigit(str[i]);
+        if (d < 0) return false;
+        val = (val << 4) | d;
+    }
+    return true;
+}
+
+static void _appendUtf8(std::string &s, uint32_t cp) {
+    if (cp < 0x80) {
+        s += (char) cp;
+    }
+    else if (cp < 0x800) {
+        s += (char) (0xc0 | (cp >> 6));
+        s += (char) (0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000) {
+        s += (char) (0xe0 | (cp >> 12));
+        s += (char) (0x80 | ((cp >> 6) & 0x3f));
+        s += (char) (0x80 | (cp & 0x3f));
+    }
+    else {
+        s += (char) (0xf0 | (cp >> 18));
+        s += (char) (0x80 | ((cp >> 12) & 0x3f));
+        s += (char) (0x80 | ((cp >> 6) & 0x3f));
+        s += (char) (0x80 | (cp & 0x3f));
+    }
+}
+
+/**
+ * @brief Appends the unescaped contents of a JSON string (without the
+ * surrounding quotes) to s.
+ */
+static bool _unescape(std::string &s, const char *str, size_t len) {
+    const char *end = str + len;
+
+    while (str < end) {
+        const char *p = (const char *) memchr(str, '\\', end - str);
+        if (p == nullptr) {
+            s.append(str, end - str);
+            break;
+        }
+        s.append(str, p - str);
+
+        str = p + 1;
+        if (str == end) return false;
+
+        if (*str == 'u') {
+            uint32_t cp;
+            if (! _hex4(str + 1, end, cp)) return false;
+            str += 5;
+
+            if (cp >= 0xd800 && cp < 0xdc00) {
+                uint32_t lo;
+                if (end - str < 2 || str[0] != '\\' || str[1] != 'u') return false;
+                if (! _hex4(str + 2, end, lo) || lo < 0xdc00 || lo >= 0xe000) return false;
+                str += 6;
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+            }
+            else if (cp >= 0xdc00 && cp < 0xe000) {
+                return false;
+            }
+
+            _appendUtf8(s, cp);
+        }
+        else {
+            if (! _UNESCAPED[(uint8_t) *str]) return false;
+            s += _UNESCAPED[(uint8_t) *str];
+            ++str;
+        }
+    }
+
+    return true;
+}
+
 static constexpr const char * _ESCAPED[] = {
     nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
     "\\b", "\\t", "\\n", nullptr, "\\f", "\\r", nullptr, nullptr,
@@ -77,62 +356,280 @@ static constexpr const char * _ESCAPED[] = {
     nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
 };
 
-const char *JSON::_WHITE_SPACE = " \n\t";
-
-const char *JSON::_NUM_STOP = " \n\t,";
+const char *JSON::_NUM_STOP = " \n\r\t,]}";
 
-std::string JSON::_indent(const std::string &str, int spaces) {
-    std::string in = "";
-    in.resize(spaces, ' ');
+const char * JSON::_findNonWhitespace(const char *str) {
+    return _scan<WhitespaceStop>(str);
+}
 
-    std::stringstream s;
+static void _escape(std::string &s, const char *str, size_t len) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    auto end = str + len;
 
-    const char *p = str.c_str();
-    while (*p != '\0') {
-        s << *p;
+    while (true) {
+        // copy unescaped runs in bulk
+        auto p = _scan<EscapeStop>(str, end);
+        s.append(str, p - str);
+        if (p == end) break;
 
-        if (*p == '\n' && *(p + 1) != '\0') {
-            s << in;
+        auto c = (uint8_t) *p;
+        if (_ESCAPED[c]) {
+            s += _ESCAPED[c];
+        }
+        else {
+            char u[] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xf] };
+            s.append(u, sizeof(u));
         }
+        str = p + 1;
+    }
+}
+
+void JSONWriter::_beforeValue() {
+    if (_serializer != nullptr && _own.size() >= _flushThreshold) flush();
 
-        ++p;
+    if (_afterKey) {
+        _afterKey = false;
+        return;
     }
+    if (_depth == 0) return;
 
-    return s.str();
+    if (! _first) *_buf += ',';
+    _first = false;
+    *_buf += '\n';
+    _buf->append(2 * _depth, ' ');
 }
 
-std::string JSON::_extractString(char const * &str) {
-    auto start = str;
-    while (*str != '"' && *str != '\0') {
-        if (*str == '\\') {
-            ++str;
-            if (*str == '\0') return std::string();
+void JSONWriter::_begin(char token) {
+    _beforeValue();
+    *_buf += token;
+    ++_depth;
+    _first = true;
+}
+
+void JSONWriter::_end(char token) {
+    --_depth;
+    if (_first) {
+        *_buf += ' ';
+    }
+    else {
+        *_buf += '\n';
+        _buf->append(2 * _depth, ' ');
+    }
+    *_buf += token;
+    _first = false;
+}
+
+void JSONWriter::_string(const char *str, size_t len) {
+    *_buf += '"';
+    _escape(*_buf, str, len);
+    *_buf += '"';
+}
+
+bool JSON::_decode(char const * &str, std::string &val) {
+    if (! _consumeToken(str, '"')) return false;
+
+    auto end = _scan<StringStop>(str);
+    while (*end == '\\') {
+        if (end[1] == '\0') return false;
+        end = _scan<StringStop>(end + 2);
+    }
+    if (*end != '"') return false;
+
+    val.clear();
+    if (! _unescape(val, str, end - str)) return false;
+    str = end + 1;
+    return true;
+}
+
+JSONReader & JSONReader::feed(const char *data, size_t len) {
+    size_t left = _end - _pos;
+
+    if (left == 0) {
+        _inCarry = false;
+        _pos = data;
+        _end = data + len;
+    }
+    else {
+        if (_inCarry) _carry.erase(0, _pos - _carry.data());
+        else _carry.assign(_pos, left);
+
+        _carryPrefix = _carry.size();
+        _carry.append(data, len);
+        _inCarry = true;
+        _pos = _carry.data();
+        _end = _pos + _carry.size();
+    }
+
+    _chunk = data;
+    _chunkLen = len;
+    return *this;
+}
+
+void JSONReader::_leaveCarry() {
+    // once past the leftover of the previous chunk, continue directly on the
+    // current chunk
+    size_t offset = _pos - _carry.data();
+    if (offset >= _carryPrefix) {
+        _inCarry = false;
+        _pos = _chunk + (offset - _carryPrefix);
+        _end = _chunk + _chunkLen;
+    }
+}
+
+void JSONReader::_skipWhitespaces() {
+    if (_pos < _end && WhitespaceStop::test(*_pos)) return;
+    _pos = _scan<WhitespaceStop>(_pos, _end);
+}
+
+JSONReader::Event JSONReader::_incomplete() {
+    if (_last) throw JSONDecodeError("Unexpected end of JSON input");
+    return NEED_MORE;
+}
+
+JSONReader::Event JSONReader::_afterValue(Event e) {
+    _state = _stack.empty() ? _DONE : _COMMA_OR_END;
+    return e;
+}
+
+JSONReader::Event JSONReader::_close(char token) {
+    if (_stack.empty() || _stack.back() != token) throw JSONDecodeError("Mismatched JSON bracket");
+    _stack.pop_back();
+    ++_pos;
+    return _afterValue(token == '{' ? END_OBJECT : END_ARRAY);
+}
+
+JSONReader::Event JSONReader::_string(Event e) {
+    auto start = _pos + 1;
+    auto p = _scan<StringStop>(start, _end);
+    while (p < _end && *p == '\0') p = _scan<StringStop>(p + 1, _end);
+    if (p == _end) return _incomplete();
+
+    if (*p == '"') {
+        _value.data = start;
+        _value.len = p - start;
+    }
+    else {
+        auto q = p;
+        while (q < _end && *q != '"') {
+            q = _scan<StringStop>(*q == '\\' ? q + 2 : q + 1, _end);
         }
-        ++str;
+        if (q >= _end) return _incomplete();
+
+        _scratch.assign(start, p - start);
+        if (! _unescape(_scratch, p, q - p)) throw JSONDecodeError("Invalid JSON escape sequence");
+        _value.data = _scratch.data();
+        _value.len = _scratch.size();
+        p = q;
+    }
+
+    _pos = p + 1;
+    if (e == KEY) {
+        _state = _COLON;
+        return KEY;
     }
-    return std::string(start, str - start);
+    return _afterValue(e);
 }
 
-void JSON::_escape(std::stringstream &s, const char *str) {
-    while (*str != '\0') {
-        if (_ESCAPED[(size_t) *str]) s << _ESCAPED[(size_t) *str];
-        else s << *str;
-        ++str;
+JSONReader::Event JSONReader::_number() {
+    auto p = _pos;
+    while (p < _end && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E')) ++p;
+    if (p == _end && ! _last) return NEED_MORE;
+
+    _value.data = _pos;
+    _value.len = p - _pos;
+    _pos = p;
+    return _afterValue(NUMBER);
+}
+
+JSONReader::Event JSONReader::_literal(const char *token, size_t len, Event e) {
+    size_t avail = _end - _pos;
+    if (avail < len) {
+        if (strncmp(_pos, token, avail) != 0) throw JSONDecodeError("Invalid JSON literal");
+        return _incomplete();
     }
+    if (strncmp(_pos, token, len) != 0) throw JSONDecodeError("Invalid JSON literal");
+
+    _pos += len;
+    return _afterValue(e);
 }
 
-bool JSON::_unescape(std::stringstream &s, const char *str) {
-    while (*str != '\0') {
-        if (*str == '\\') {
-            ++str;
-            if (! _UNESCAPED[(size_t) *str]) return false;
-            s << _UNESCAPED[(size_t) *str];
+JSONReader::Event JSONReader::next() {
+    if (_inCarry) _leaveCarry();
+
+    while (true) {
+        _skipWhitespaces();
+
+        if (_pos == _end) {
+            if (_state == _DONE && _last) return END;
+            return _incomplete();
         }
-        else {
-            s << *str;
+
+        char c = *_pos;
+
+        switch (_state) {
+        case _DONE:
+            throw JSONDecodeError("Unexpected characters after JSON value");
+
+        case _COLON:
+            if (c != ':') throw JSONDecodeError("Expected ':'");
+            ++_pos;
+            _state = _VALUE;
+            continue;
+
+        case _COMMA_OR_END:
+            if (c == ',') {
+                ++_pos;
+                _state = _stack.back() == '{' ? _KEY : _VALUE;
+                continue;
+            }
+            if (c == '}') return _close('{');
+            if (c == ']') return _close('[');
+            throw JSONDecodeError("Expected ',' or closing bracket");
+
+        case _FIRST_KEY_OR_END:
+            if (c == '}') return _close('{');
+            // fall through
+
+        case _KEY:
+            if (c != '"') throw JSONDecodeError("Expected object key");
+            return _string(KEY);
+
+        case _FIRST_VALUE_OR_END:
+            if (c == ']') return _close('[');
+            // fall through
+
+        case _VALUE:
+            switch (c) {
+            case '{':
+                ++_pos;
+                _stack.push_back('{');
+                _state = _FIRST_KEY_OR_END;
+                return BEGIN_OBJECT;
+
+            case '[':
+                ++_pos;
+                _stack.push_back('[');
+                _state = _FIRST_VALUE_OR_END;
+                return BEGIN_ARRAY;
+
+            case '"':
+                return _string(STRING);
+
+            case 't':
+                _boolean = true;
+                return _literal("true", 4, BOOLEAN);
+
+            case 'f':
+                _boolean = false;
+                return _literal("false", 5, BOOLEAN);
+
+            case 'n':
+                return _literal("null", 4, NULL_VALUE);
+
+            default:
+                if (c == '-' || (c >= '0' && c <= '9')) return _number();
+                throw JSONDecodeError("Unexpected character in JSON input");
+            }
         }
-        ++str;
     }
-
-    return true;
 }
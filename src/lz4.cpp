@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <lz4.h>
+#include <exception.h>
+#include <cstring>
+#include <stdint.h>
+
+using namespace spl;
+
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t LAST_LITERALS = 5;      // the block always ends with literals
+static constexpr size_t MATCH_LIMIT = 12;       // the last match starts this far from the end
+static constexpr size_t MAX_OFFSET = 65535;
+static constexpr int HASH_BITS = 12;
+static constexpr int SKIP_TRIGGER = 6;
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline uint32_t hash(uint32_t x) {
+    return (x * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static inline uint8_t * putLength(uint8_t *op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t) len;
+    return op;
+}
+
+static inline uint8_t * putLiterals(uint8_t *op, const uint8_t *literals, size_t len, uint8_t matchToken) {
+    if (len >= 15) {
+        *op++ = (15 << 4) | matchToken;
+        op = putLength(op, len - 15);
+    }
+    else {
+        *op++ = (uint8_t) (len << 4) | matchToken;
+    }
+    // literals may be null for empty input, which memcpy does not allow
+    if (len > 0) memcpy(op, literals, len);
+    return op + len;
+}
+
+size_t LZ4::compress(const void *data, size_t inputLength, void *output, size_t outputCapacity) {
+    const uint8_t *src = (const uint8_t *) data;
+    const uint8_t *end = src + inputLength;
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    uint8_t *op = (uint8_t *) output;
+    uint8_t *oend = op + outputCapacity;
+
+    if (inputLength > MATCH_LIMIT) {
+        uint32_t table[1 << HASH_BITS] = { 0 };
+        const uint8_t *mflimit = end - MATCH_LIMIT;
+        const uint8_t *matchlimit = end - LAST_LITERALS;
+
+        ++ip;
+        while (ip < mflimit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = hash(seq);
+            const uint8_t *ref = src + table[h];
+            table[h] = (uint32_t) (ip - src);
+
+            if (ref >= ip || (size_t) (ip - ref) > MAX_OFFSET || read32(ref) != seq) {
+                ip += 1 + ((ip - anchor) >> SKIP_TRIGGER);
+                continue;
+            }
+
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+
+            const uint8_t *m = ip + MIN_MATCH;
+            const uint8_t *r = ref + MIN_MATCH;
+            while (m < matchlimit && *m == *r) {
+                ++m;
+                ++r;
+            }
+
+            size_t literals = ip - anchor;
+            size_t matchLen = m - ip - MIN_MATCH;
+
+            if (
+                (size_t) (oend - op)
+                < 1 + literals / 255 + 1 + literals + 2 + matchLen / 255 + 1
+            ) {
+                return 0;
+            }
+
+            op = putLiterals(op, anchor, literals, matchLen >= 15 ? 15 : (uint8_t) matchLen);
+
+            size_t offset = ip - ref;
+            *op++ = (uint8_t) offset;
+            *op++ = (uint8_t) (offset >> 8);
+            if (matchLen >= 15) op = putLength(op, matchLen - 15);
+
+            ip = m;
+            anchor = ip;
+            if (ip - 2 > src) table[hash(read32(ip - 2))] = (uint32_t) (ip - 2 - src);
+        }
+    }
+
+    size_t literals = end - anchor;
+    if ((size_t) (oend - op) < 1 + literals / 255 + 1 + literals) return 0;
+    op = putLiterals(op, anchor, literals, 0);
+
+    return op - (uint8_t *) output;
+}
+
+size_t LZ4::decompress(const void *data, size_t inputLength, void *output, size_t outputCapacity) {
+    const uint8_t *ip = (const uint8_t *) data;
+    const uint8_t *iend = ip + inputLength;
+    uint8_t *dst = (uint8_t *) output;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + outputCapacity;
+
+    while (true) {
+        if (ip >= iend) throw InvalidArgument("Malformed LZ4 block");
+        uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) throw InvalidArgument("Malformed LZ4 block");
+                b = *ip++;
+                literals += b;
+            } while (b == 255);
+        }
+
+        if (literals > (size_t) (iend - ip) || literals > (size_t) (oend - op)) {
+            throw InvalidArgument("Malformed LZ4 block");
+        }
+        if (literals > 0) memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+
+        if (ip == iend) break;
+
+        if (iend - ip < 2) throw InvalidArgument("Malformed LZ4 block");
+        size_t offset = ip[0] | ((size_t) ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t) (op - dst)) {
+            throw InvalidArgument("Malformed LZ4 block");
+        }
+
+        size_t matchLen = token & 15;
+        if (matchLen == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) throw InvalidArgument("Malformed LZ4 block");
+                b = *ip++;
+                matchLen += b;
+            } while (b == 255);
+        }
+        matchLen += MIN_MATCH;
+
+        if (matchLen > (size_t) (oend - op)) throw InvalidArgument("Malformed LZ4 block");
+
+        const uint8_t *m = op - offset;
+        if (offset >= matchLen) {
+            memcpy(op, m, matchLen);
+            op += matchLen;
+        }
+        else {
+            for (size_t i = 0; i < matchLen; ++i) *op++ = *m++;
+        }
+    }
+
+    return op - dst;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <core/numa.h>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include <linux/mempolicy.h>
+
+using namespace spl::core;
+
+#define SYSFS_NODE_DIR "/sys/devices/system/node"
+
+namespace {
+
+struct Topology {
+    std::vector<int> ids;                   // kernel node ids
+    std::vector<std::vector<int>> cpus;     // CPUs of every node
+
+    Topology() {
+        std::vector<int> online = _readList(SYSFS_NODE_DIR "/online");
+        for (int id : online) {
+            char path[128];
+            snprintf(path, sizeof(path), SYSFS_NODE_DIR "/node%d/cpulist", id);
+            std::vector<int> c = _readList(path);
+            // memory-only nodes have no CPUs to run workers on
+            if (c.empty()) continue;
+            ids.push_back(id);
+            cpus.push_back(std::move(c));
+        }
+
+        if (ids.empty()) {
+            ids.push_back(0);
+            cpus.emplace_back();
+            for (int i = 0, n = get_nprocs_conf(); i < n; ++i) cpus.back().push_back(i);
+        }
+    }
+
+    /**
+     * @brief Parses a kernel list file, such as "0-3,8-11".
+     */
+    static std::vector<int> _readList(const char *path) {
+        std::vector<int> list;
+        FILE *f = fopen(path, "r");
+        if (f == nullptr) return list;
+
+        int first, last;
+        while (fscanf(f, "%d", &first) == 1) {
+            last = first;
+            int c = fgetc(f);
+            if (c == '-') {
+                if (fscanf(f, "%d", &last) != 1) break;
+                c = fgetc(f);
+            }
+            for (int i = first; i <= last; ++i) list.push_back(i);
+            if (c != ',') break;
+        }
+
+        fclose(f);
+        return list;
+    }
+};
+
+const Topology & topology() {
+    static Topology t;
+    return t;
+}
+
+}
+
+size_t Numa::nodes() {
+    return topology().ids.size();
+}
+
+const std::vector<int> & Numa::cpus(size_t node) {
+    return topology().cpus[node];
+}
+
+size_t Numa::currentNode() {
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return 0;
+
+    const Topology &t = topology();
+    for (size_t i = 0; i < t.ids.size(); ++i) {
+        if (t.ids[i] == (int) node) return i;
+    }
+    return 0;
+}
+
+void Numa::bind(void *mem, size_t len, size_t node) {
+    const Topology &t = topology();
+    if (t.ids.size() < 2) return;
+
+    int id = t.ids[node];
+    if (id >= (int) (8 * sizeof(unsigned long))) return;
+
+    unsigned long mask = 1ul << id;
+    syscall(SYS_mbind, mem, len, MPOL_PREFERRED, &mask, 8 * sizeof(mask), 0);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <reactor.h>
+#include <exception.h>
+#include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+
+using namespace spl;
+
+#define MAX_EVENTS_PER_WAIT (256)
+
+Reactor::Reactor() {
+    _fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_fd == -1) throw ErrnoRuntimeError();
+}
+
+Reactor::~Reactor() {
+    if (_fd != -1) ::close(_fd);
+}
+
+Reactor & Reactor::operator=(Reactor &&rhs) {
+    if (this != &rhs) {
+        if (_fd != -1) ::close(_fd);
+        _fd = rhs._fd;
+        rhs._fd = -1;
+    }
+    return *this;
+}
+
+void Reactor::_control(int op, int fd, uint32_t events, uint64_t tag) {
+    epoll_event e;
+    e.events = events;
+    e.data.u64 = tag;
+    if (epoll_ctl(_fd, op, fd, &e) != 0) throw ErrnoRuntimeError();
+}
+
+Reactor & Reactor::arm(int fd, uint32_t events, uint64_t tag) {
+    epoll_event e;
+    e.events = events;
+    e.data.u64 = tag;
+    if (epoll_ctl(_fd, EPOLL_CTL_MOD, fd, &e) != 0) {
+        if (errno != ENOENT || epoll_ctl(_fd, EPOLL_CTL_ADD, fd, &e) != 0) {
+            throw ErrnoRuntimeError();
+        }
+    }
+    return *this;
+}
+
+Reactor & Reactor::remove(int fd) {
+    if (epoll_ctl(_fd, EPOLL_CTL_DEL, fd, nullptr) != 0 && errno != ENOENT) {
+        throw ErrnoRuntimeError();
+    }
+    return *this;
+}
+
+size_t Reactor::wait(Event *events, size_t maxCount, int timeoutMillis) {
+    epoll_event e[MAX_EVENTS_PER_WAIT];
+    int n = epoll_wait(_fd, e, (int) std::min(maxCount, (size_t) MAX_EVENTS_PER_WAIT), timeoutMillis);
+    if (n == -1) {
+        if (errno == EINTR) return 0;
+        throw ErrnoRuntimeError();
+    }
+
+    for (int i = 0; i < n; ++i) {
+        events[i].tag = e[i].data.u64;
+        events[i].events = e[i].events;
+    }
+    return n;
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <shm_channel.h>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+using namespace spl;
+
+#define CHANNEL_MAGIC (0x6c6e6e6168636d73ull)   // "smchannl"
+
+/**
+ * @brief The shared state at the start of the mapping. The producer and
+ * consumer fields are on separate cache lines so that the two ends do not
+ * contend on them. The sequence words are futexes, bumped on every update so
+ * that a peer going to sleep notices updates it raced with.
+ */
+struct alignas(64) SharedMemoryChannel::Header {
+    uint64_t magic;
+    uint64_t capacity;
+
+    alignas(64) std::atomic<uint64_t> head;
+    std::atomic<uint32_t> dataSeq;
+    std::atomic<uint32_t> consumerWaiting;
+
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<uint32_t> spaceSeq;
+    std::atomic<uint32_t> producerWaiting;
+
+    alignas(64) std::atomic<uint32_t> closed;
+};
+
+static void _futexWait(std::atomic<uint32_t> &word, uint32_t expected) {
+    // shared (non-private) futexes, since the peer is another process
+    syscall(SYS_futex, &word, FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+static void _futexWake(std::atomic<uint32_t> &word, int count) {
+    syscall(SYS_futex, &word, FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+static size_t _pageSize() {
+    return sysconf(_SC_PAGESIZE);
+}
+
+SharedMemoryChannel::SharedMemoryChannel(size_t capacity) {
+    size_t page = _pageSize();
+    _capacity = page;
+    while (_capacity < capacity) _capacity <<= 1;
+
+    _fd = memfd_create("spl-shm-channel", MFD_CLOEXEC);
+    if (_fd == -1) throw ErrnoRuntimeError();
+
+    try {
+        File f(_fd);
+        f.truncate(page + _capacity);
+        _mapping = f.map(0, page + _capacity);
+    }
+    catch (...) {
+        ::close(_fd);
+        throw;
+    }
+
+    _header = new (_mapping.ptr()) Header();
+    _header->magic = CHANNEL_MAGIC;
+    _header->capacity = _capacity;
+    _data = (uint8_t *) _mapping.ptr() + page;
+}
+
+SharedMemoryChannel::SharedMemoryChannel(const char *path) {
+    _fd = ::open(path, O_RDWR | O_CLOEXEC);
+    if (_fd == -1) throw ErrnoRuntimeError();
+
+    try {
+        _attach();
+    }
+    catch (...) {
+        ::close(_fd);
+        throw;
+    }
+}
+
+void SharedMemoryChannel::_attach() {
+    size_t page = _pageSize();
+    File f(_fd);
+
+    size_t size = lseek(_fd, 0, SEEK_END);
+    if (size < page) throw InvalidArgument("Not a shared memory channel");
+
+    _mapping = f.map(0, size);
+    _header = (Header *) _mapping.ptr();
+    if (_header->magic != CHANNEL_MAGIC || _header->capacity != size - page) {
+        throw InvalidArgument("Not a shared memory channel");
+    }
+
+    _capacity = _header->capacity;
+    _data = (uint8_t *) _mapping.ptr() + page;
+}
+
+SharedMemoryChannel::~SharedMemoryChannel() {
+    if (_fd != -1) ::close(_fd);
+}
+
+std::string SharedMemoryChannel::path() const {
+    return "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(_fd);
+}
+
+size_t SharedMemoryChannel::available() const {
+    return _header->head.load(std::memory_order_acquire) - _header->tail.load(std::memory_order_acquire);
+}
+
+bool SharedMemoryChannel::closed() const {
+    return _header->closed.load(std::memory_order_acquire) != 0;
+}
+
+SharedMemoryChannel & SharedMemoryChannel::close() {
+    _header->closed.store(1);
+    ++_header->dataSeq;
+    ++_header->spaceSeq;
+    _futexWake(_header->dataSeq, INT32_MAX);
+    _futexWake(_header->spaceSeq, INT32_MAX);
+    return *this;
+}
+
+void SharedMemoryChannel::_waitData(size_t minLen) {
+    Header *h = _header;
+    uint64_t tail = h->tail.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < __SPIN_COUNT; ++i) {
+        if (h->head.load(std::memory_order_acquire) - tail >= minLen) return;
+    }
+
+    while (h->head.load() - tail < minLen && ! h->closed.load()) {
+        uint32_t seq = h->dataSeq.load();
+        h->consumerWaiting.store(1);
+        if (h->head.load() - tail < minLen && ! h->closed.load()) {
+            _futexWait(h->dataSeq, seq);
+        }
+        h->consumerWaiting.store(0);
+    }
+}
+
+void SharedMemoryChannel::_waitSpace() {
+    Header *h = _header;
+    uint64_t head = h->head.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < __SPIN_COUNT; ++i) {
+        if (head - h->tail.load(std::memory_order_acquire) < _capacity) return;
+    }
+
+    while (head - h->tail.load() >= _capacity && ! h->closed.load()) {
+        uint32_t seq = h->spaceSeq.load();
+        h->producerWaiting.store(1);
+        if (head - h->tail.load() >= _capacity && ! h->closed.load()) {
+            _futexWait(h->spaceSeq, seq);
+        }
+        h->producerWaiting.store(0);
+    }
+}
+
+void SharedMemoryChannel::write(const void *data, size_t len) {
+    Header *h = _header;
+    size_t mask = _capacity - 1;
+
+    while (len > 0) {
+        if (h->closed.load(std::memory_order_acquire)) throw ChannelClosedError();
+
+        uint64_t head = h->head.load(std::memory_order_relaxed);
+        size_t space = _capacity - (head - h->tail.load(std::memory_order_acquire));
+        if (space == 0) {
+            _waitSpace();
+            continue;
+        }
+
+        size_t n = std::min(space, len);
+        size_t offset = head & mask;
+        size_t first = std::min(n, _capacity - offset);
+        memcpy(_data + offset, data, first);
+        memcpy(_data, (const uint8_t *) data + first, n - first);
+
+        h->head.store(head + n);
+        ++h->dataSeq;
+        if (h->consumerWaiting.load()) _futexWake(h->dataSeq, 1);
+
+        data = (const uint8_t *) data + n;
+        len -= n;
+    }
+}
+
+size_t SharedMemoryChannel::read(void *data, size_t minLen, size_t maxLen) {
+    Header *h = _header;
+    size_t mask = _capacity - 1;
+    size_t total = 0;
+
+    do {
+        uint64_t tail = h->tail.load(std::memory_order_relaxed);
+        size_t avail = h->head.load(std::memory_order_acquire) - tail;
+        if (avail == 0) {
+            if (h->closed.load(std::memory_order_acquire)) throw ChannelClosedError();
+            // wait for what is still needed, but for no more than the ring
+            // can hold
+            _waitData(std::min(std::max(minLen - total, (size_t) 1), _capacity));
+            continue;
+        }
+
+        size_t n = std::min(avail, maxLen - total);
+        size_t offset = tail & mask;
+        size_t first = std::min(n, _capacity - offset);
+        memcpy((uint8_t *) data + total, _data + offset, first);
+        memcpy((uint8_t *) data + total + first, _data, n - first);
+
+        h->tail.store(tail + n);
+        ++h->spaceSeq;
+        if (h->producerWaiting.load()) _futexWake(h->spaceSeq, 1);
+
+        total += n;
+    } while (total < minLen);
+
+    return total;
+}
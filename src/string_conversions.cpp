@@ -4,6 +4,9 @@
 */
 
 #include <string_conversions.h>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
 
 using namespace spl;
 
@@ -50,5 +53,666 @@ const char StringConversions::_valToDigit[] = {
     'W', 'X', 'Y', 'Z'
 };
 
+const char StringConversions::_digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
 thread_local char StringConversions::_numBuf[__NUMBER_BUFFER_SIZE];
 thread_local char StringConversions::_expBuf[__NUMBER_BUFFER_SIZE];
+
+// Shortest round-trip floating point formatting, following Ryu (Ulf Adams,
+// "Ryu: fast float-to-string conversion", PLDI 2018). The 125-bit tables of
+// powers of 5 and their inverses are computed once on first use.
+
+#define POW5_BITCOUNT (125)
+#define POW5_INV_BITCOUNT (125)
+#define POW5_TABLE_SIZE (326)
+#define POW5_INV_TABLE_SIZE (342)
+
+__extension__ typedef unsigned __int128 uint128;
+
+namespace {
+
+/**
+ * @return ceil(log2(5^e)) for e > 0, and 1 for e = 0.
+ */
+inline int _pow5bits(int e) {
+    return (int) (((uint32) e * 1217359) >> 19) + 1;
+}
+
+/**
+ * @return floor(log10(2^e)).
+ */
+inline uint32 _log10Pow2(int e) {
+    return ((uint32) e * 78913) >> 18;
+}
+
+/**
+ * @return floor(log10(5^e)).
+ */
+inline uint32 _log10Pow5(int e) {
+    return ((uint32) e * 732923) >> 20;
+}
+
+inline bool _multipleOfPowerOf5(uint64 val, uint32 p) {
+    uint32 count = 0;
+    while (val % 5 == 0) {
+        val /= 5;
+        ++count;
+    }
+    return count >= p;
+}
+
+inline bool _multipleOfPowerOf2(uint64 val, uint32 p) {
+    return (val & ((1ull << p) - 1)) == 0;
+}
+
+/**
+ * @brief A little-endian unsigned big integer, only large enough to build the
+ * tables.
+ */
+template <int N>
+struct BigInt {
+    static constexpr int WORDS = N;
+
+    uint64 w[WORDS] = { };
+
+    void mul(uint32 m) {
+        uint128 carry = 0;
+        for (int i = 0; i < WORDS; ++i) {
+            carry += (uint128) w[i] * m;
+            w[i] = (uint64) carry;
+            carry >>= 64;
+        }
+    }
+
+    void div(uint32 d) {
+        uint128 rem = 0;
+        for (int i = WORDS - 1; i >= 0; --i) {
+            rem = (rem << 64) | w[i];
+            w[i] = (uint64) (rem / d);
+            rem %= d;
+        }
+    }
+
+    /**
+     * @return The low 128 bits of this number shifted right by `shift` bits
+     * (left, if negative).
+     */
+    uint128 bits(int shift) const {
+        uint128 r = 0;
+        for (int i = 0; i < 128; i += 64) {
+            int pos = shift + i;
+            uint64 word = 0;
+            int q = pos >> 6, o = pos & 63;     // floor division
+            if (q >= 0 && q < WORDS) word = w[q] >> o;
+            if (o != 0 && q + 1 >= 0 && q + 1 < WORDS) word |= w[q + 1] << (64 - o);
+            r |= (uint128) word << i;
+        }
+        return r;
+    }
+
+    /**
+     * @return The position of the highest set bit, or -1 if zero.
+     */
+    int highestBit() const {
+        for (int i = WORDS - 1; i >= 0; --i) {
+            if (w[i] != 0) return 64 * i + 63 - __builtin_clzll(w[i]);
+        }
+        return -1;
+    }
+
+    void shiftRight(int shift) {
+        for (int i = 0; i < WORDS; i += 2) {
+            uint128 v = bits(shift + 64 * i);
+            w[i] = (uint64) v;
+            if (i + 1 < WORDS) w[i + 1] = (uint64) (v >> 64);
+        }
+    }
+
+    void increment() {
+        for (int i = 0; i < WORDS && ++w[i] == 0; ++i);
+    }
+};
+
+struct Pow5Tables {
+    uint64 pow5[POW5_TABLE_SIZE][2];
+    uint64 pow5Inv[POW5_INV_TABLE_SIZE][2];
+
+    Pow5Tables() {
+        // pow5[i] = floor(5^i / 2^(pow5bits(i) - POW5_BITCOUNT))
+        BigInt<20> p;
+        p.w[0] = 1;
+        for (int i = 0; i < POW5_TABLE_SIZE; ++i) {
+            uint128 v = p.bits(_pow5bits(i) - POW5_BITCOUNT);
+            pow5[i][0] = (uint64) v;
+            pow5[i][1] = (uint64) (v >> 64);
+            p.mul(5);
+        }
+
+        // pow5Inv[i] = floor(2^(pow5bits(i) - 1 + POW5_INV_BITCOUNT) / 5^i) + 1,
+        // taken from floor(2^M / 5^i) by repeated division, since nested
+        // floor divisions compose
+        constexpr int M = 64 * BigInt<20>::WORDS - 64;
+        BigInt<20> q;
+        q.w[M / 64] = 1;
+        for (int i = 0; i < POW5_INV_TABLE_SIZE; ++i) {
+            uint128 v = q.bits(M - (_pow5bits(i) - 1 + POW5_INV_BITCOUNT)) + 1;
+            pow5Inv[i][0] = (uint64) v;
+            pow5Inv[i][1] = (uint64) (v >> 64);
+            q.div(5);
+        }
+    }
+};
+
+const Pow5Tables & _pow5Tables() {
+    static Pow5Tables tables;
+    return tables;
+}
+
+inline uint64 _mulShift(uint64 m, const uint64 *mul, int j) {
+    uint128 b0 = (uint128) m * mul[0];
+    uint128 b2 = (uint128) m * mul[1];
+    return (uint64) (((b0 >> 64) + b2) >> (j - 64));
+}
+
+/**
+ * @brief Computes the shortest decimal digits and exponent of a binary
+ * floating point value m2 * 2^e2, given in Ryu's representation.
+ */
+void _shortest(uint64 m2, int e2, bool mmShift, uint64 &digits, int &exponent) {
+    const Pow5Tables &tables = _pow5Tables();
+
+    bool even = (m2 & 1) == 0;
+    bool acceptBounds = even;
+
+    uint64 mv = 4 * m2;
+    uint64 mp = 4 * m2 + 2;
+    uint64 mm = 4 * m2 - 1 - mmShift;
+
+    uint64 vr, vp, vm;
+    int e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+
+    if (e2 >= 0) {
+        uint32 q = _log10Pow2(e2) - (e2 > 3);
+        e10 = (int) q;
+        int k = POW5_INV_BITCOUNT + _pow5bits(q) - 1;
+        int i = -e2 + (int) q + k;
+        vr = _mulShift(mv, tables.pow5Inv[q], i);
+        vp = _mulShift(mp, tables.pow5Inv[q], i);
+        vm = _mulShift(mm, tables.pow5Inv[q], i);
+
+        if (q <= 21) {
+            if (mv % 5 == 0) vrIsTrailingZeros = _multipleOfPowerOf5(mv, q);
+            else if (acceptBounds) vmIsTrailingZeros = _multipleOfPowerOf5(mm, q);
+            else vp -= _multipleOfPowerOf5(mp, q);
+        }
+    }
+    else {
+        uint32 q = _log10Pow5(-e2) - (-e2 > 1);
+        e10 = (int) q + e2;
+        int i = -e2 - (int) q;
+        int k = _pow5bits(i) - POW5_BITCOUNT;
+        int j = (int) q - k;
+        vr = _mulShift(mv, tables.pow5[i], j);
+        vp = _mulShift(mp, tables.pow5[i], j);
+        vm = _mulShift(mm, tables.pow5[i], j);
+
+        if (q <= 1) {
+            vrIsTrailingZeros = true;
+            if (acceptBounds) vmIsTrailingZeros = mmShift;
+            else --vp;
+        }
+        else if (q < 63) {
+            vrIsTrailingZeros = _multipleOfPowerOf2(mv, q);
+        }
+    }
+
+    int removed = 0;
+    uint8 lastRemovedDigit = 0;
+    uint64 output;
+
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = (uint8) (vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = (uint8) (vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            // round half to even
+            lastRemovedDigit = 4;
+        }
+        output = vr + ((vr == vm && (! acceptBounds || ! vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    }
+    else {
+        bool roundUp = false;
+        while (vp / 10 > vm / 10) {
+            roundUp = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || roundUp);
+    }
+
+    digits = output;
+    exponent = e10 + removed;
+}
+
+/**
+ * @brief Formats decimal digits d * 10^exponent.
+ */
+char * _formatDecimal(char *buf, uint64 d, int exponent) {
+    char digits[20];
+    char *end = digits + 20;
+    char *start = end;
+    do {
+        *--start = (char) (d % 10) + '0';
+        d /= 10;
+    } while (d);
+    int n = (int) (end - start);
+
+    // position of the decimal point relative to the first digit
+    int point = n + exponent;
+
+    if (point > -6 && point <= 21) {
+        if (point <= 0) {
+            *buf++ = '0';
+            *buf++ = '.';
+            memset(buf, '0', -point);
+            buf += -point;
+            memcpy(buf, start, n);
+            buf += n;
+        }
+        else if (point >= n) {
+            memcpy(buf, start, n);
+            buf += n;
+            memset(buf, '0', point - n);
+            buf += point - n;
+        }
+        else {
+            memcpy(buf, start, point);
+            buf += point;
+            *buf++ = '.';
+            memcpy(buf, start + point, n - point);
+            buf += n - point;
+        }
+    }
+    else {
+        *buf++ = *start;
+        if (n > 1) {
+            *buf++ = '.';
+            memcpy(buf, start + 1, n - 1);
+            buf += n - 1;
+        }
+        *buf++ = 'e';
+        buf = StringConversions::int_to_chars(buf, point - 1);
+    }
+
+    return buf;
+}
+
+/**
+ * @brief Formats a floating point value with the given IEEE-754 layout.
+ */
+char * _floatToShortestChars(char *buf, uint64 bits, int mantissaBits, int exponentBits) {
+    int bias = (1 << (exponentBits - 1)) - 1;
+    bool sign = (bits >> (mantissaBits + exponentBits)) & 1;
+    uint64 mantissa = bits & ((1ull << mantissaBits) - 1);
+    uint32 ieeeExponent = (uint32) ((bits >> mantissaBits) & ((1u << exponentBits) - 1));
+
+    if (ieeeExponent == (1u << exponentBits) - 1) {
+        if (mantissa != 0) {
+            memcpy(buf, "nan", 3);
+            return buf + 3;
+        }
+        if (sign) *buf++ = '-';
+        memcpy(buf, "inf", 3);
+        return buf + 3;
+    }
+
+    if (sign) *buf++ = '-';
+
+    if (ieeeExponent == 0 && mantissa == 0) {
+        *buf++ = '0';
+        return buf;
+    }
+
+    uint64 m2;
+    int e2;
+    if (ieeeExponent == 0) {
+        m2 = mantissa;
+        e2 = 1 - bias - mantissaBits - 2;
+    }
+    else {
+        m2 = (1ull << mantissaBits) | mantissa;
+        e2 = (int) ieeeExponent - bias - mantissaBits - 2;
+    }
+
+    uint64 digits;
+    int exponent;
+    _shortest(m2, e2, mantissa != 0 || ieeeExponent <= 1, digits, exponent);
+    return _formatDecimal(buf, digits, exponent);
+}
+
+}   // namespace
+
+char * StringConversions::float_to_shortest_chars(char *buf, float64 val) {
+    uint64 bits;
+    memcpy(&bits, &val, sizeof(bits));
+    return _floatToShortestChars(buf, bits, 52, 11);
+}
+
+char * StringConversions::float_to_shortest_chars(char *buf, float32 val) {
+    uint32 bits;
+    memcpy(&bits, &val, sizeof(bits));
+    return _floatToShortestChars(buf, bits, 23, 8);
+}
+
+// Correctly rounded decimal parsing, following Eisel-Lemire (Daniel Lemire,
+// "Number Parsing at a Gigabyte per Second", Software: Practice and
+// Experience 51(8), 2021). The truncated 128-bit powers of 5 are computed
+// once on first use.
+
+#define POW5_128_MIN_EXPONENT (-342)
+#define POW5_128_MAX_EXPONENT (308)
+
+namespace {
+
+struct Pow5x128Table {
+    // high and low words of the truncated 128-bit power of 5, indexed by
+    // exponent - POW5_128_MIN_EXPONENT
+    uint64 pow5[POW5_128_MAX_EXPONENT - POW5_128_MIN_EXPONENT + 1][2];
+
+    Pow5x128Table() {
+        // 5^q, normalized so that its most significant bit is bit 127
+        BigInt<30> p;
+        p.w[0] = 1;
+        for (int q = 0; q <= POW5_128_MAX_EXPONENT; ++q) {
+            _set(q, p.bits(p.highestBit() - 127));
+            p.mul(5);
+        }
+
+        // for q < 0, floor(2^b / 5^-q) + 1 truncated to 128 bits, where
+        // b = z + 127 for q >= -27 and b = 2z + 128 otherwise, and z is the
+        // bit length of 5^-q
+        constexpr int M = 64 * BigInt<30>::WORDS - 64;
+        BigInt<30> inv;
+        inv.w[M / 64] = 1;
+        p = BigInt<30>();
+        p.w[0] = 1;
+        for (int q = -1; q >= POW5_128_MIN_EXPONENT; --q) {
+            inv.div(5);
+            p.mul(5);
+            int z = p.highestBit() + 1;
+            int b = q >= -27 ? z + 127 : 2 * z + 128;
+            BigInt<30> c = inv;
+            c.shiftRight(M - b);
+            c.increment();
+            int hb = c.highestBit();
+            _set(q, c.bits(hb > 127 ? hb - 127 : 0));
+        }
+    }
+
+private:
+
+    void _set(int q, uint128 v) {
+        pow5[q - POW5_128_MIN_EXPONENT][0] = (uint64) (v >> 64);
+        pow5[q - POW5_128_MIN_EXPONENT][1] = (uint64) v;
+    }
+};
+
+const Pow5x128Table & _pow5x128Table() {
+    static Pow5x128Table table;
+    return table;
+}
+
+/**
+ * @brief Parameters of a binary floating point format.
+ */
+struct BinaryFormat {
+    int mantissaBits;
+    int minimumExponent;
+    int infinitePower;
+    int64 minRoundToEven;
+    int64 maxRoundToEven;
+};
+
+constexpr BinaryFormat _FLOAT64_FORMAT = { 52, -1023, 0x7ff, -4, 23 };
+constexpr BinaryFormat _FLOAT32_FORMAT = { 23, -127, 0xff, -17, 10 };
+
+/**
+ * @brief Converts w * 10^q to the nearest binary floating point number.
+ *
+ * @return The biased exponent and mantissa bits of the result, without sign.
+ */
+uint64 _eiselLemire(uint64 w, int64 q, const BinaryFormat &f) {
+    if (w == 0 || q < POW5_128_MIN_EXPONENT) return 0;
+    if (q > POW5_128_MAX_EXPONENT) return (uint64) f.infinitePower << f.mantissaBits;
+
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+
+    // the upper half of the product with the first word suffices unless its
+    // low bits, which are dropped, are all ones
+    const uint64 *pow5 = _pow5x128Table().pow5[q - POW5_128_MIN_EXPONENT];
+    uint128 product = (uint128) w * pow5[0];
+    uint64 hi = (uint64) (product >> 64), lo = (uint64) product;
+    uint64 precisionMask = ~0ull >> (f.mantissaBits + 3);
+    if ((hi & precisionMask) == precisionMask) {
+        uint64 carry = (uint64) (((uint128) w * pow5[1]) >> 64);
+        lo += carry;
+        if (carry > lo) ++hi;
+    }
+
+    int upperBit = (int) (hi >> 63);
+    int shift = upperBit + 64 - f.mantissaBits - 3;
+    uint64 mantissa = hi >> shift;
+    // floor(log2(10^q)) + 63, and thus the unbiased exponent of the product
+    int power2 = (int) ((((152170 + 65536) * q) >> 16) + 63) + upperBit - lz - f.minimumExponent;
+
+    if (power2 <= 0) {
+        // subnormal, or zero if too far below the minimum exponent
+        if (-power2 + 1 >= 64) return 0;
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        // rounding up can carry into the smallest normal number
+        power2 = mantissa < (1ull << f.mantissaBits) ? 0 : 1;
+        return ((uint64) power2 << f.mantissaBits) | (mantissa & ((1ull << f.mantissaBits) - 1));
+    }
+
+    // exactly halfway between two floats; only possible for small exponents,
+    // where the product is exact
+    if (lo <= 1 && q >= f.minRoundToEven && q <= f.maxRoundToEven
+        && (mantissa & 3) == 1 && (mantissa << shift) == hi
+    ) {
+        mantissa &= ~1ull;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ull << f.mantissaBits)) {
+        mantissa = 1ull << f.mantissaBits;
+        ++power2;
+    }
+    mantissa &= ~(1ull << f.mantissaBits);
+    if (power2 >= f.infinitePower) return (uint64) f.infinitePower << f.mantissaBits;
+    return ((uint64) power2 << f.mantissaBits) | mantissa;
+}
+
+/**
+ * @brief Parses str with the C library, for inputs whose significant digits
+ * were truncated too close to a rounding boundary.
+ */
+template <typename T>
+T _parseFallback(const char *str, size_t len, T (*conv)(const char *, char **)) {
+    char buf[64];
+    if (len < sizeof(buf)) {
+        memcpy(buf, str, len);
+        buf[len] = '\0';
+        return conv(buf, nullptr);
+    }
+    return conv(std::string(str, len).c_str(), nullptr);
+}
+
+const float64 _POW10_FLOAT64[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+const float32 _POW10_FLOAT32[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+const float128 _POW10_FLOAT128[] = {
+    1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L,
+    1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L,
+    1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L,
+};
+
+}   // namespace
+
+const char * StringConversions::_scanDecimal(const char *str, const char *end, _Decimal &d) {
+    if (str < end && *str == '-') {
+        d.neg = true;
+        ++str;
+    }
+
+    // leading zeros are not significant
+    while (str < end && *str == '0') ++str;
+    const char *significand = str;
+    uint64 w = 0;
+    str = _accumulateDecimal(str, end, w);
+    int64 digits = str - significand;
+    int64 q = 0;
+
+    if (str < end && *str == '.') {
+        const char *fraction = ++str;
+        if (digits == 0) {
+            while (str < end && *str == '0') ++str;
+            significand = str;
+        }
+        const char *p = str;
+        str = _accumulateDecimal(str, end, w);
+        digits += str - p;
+        q = fraction - str;
+    }
+
+    if (digits > 19) {
+        // keep the first 19 significant digits; any nonzero digit beyond
+        // them makes the value inexact
+        w = 0;
+        int64 n = 0;
+        for (const char *p = significand; p < str; ++p) {
+            if (*p == '.') continue;
+            if (n < 19) {
+                w = w * 10 + (uint64) (*p - '0');
+                ++n;
+            }
+            else if (*p != '0') {
+                d.truncated = true;
+                break;
+            }
+        }
+        q += digits - 19;
+    }
+
+    if (str < end && (*str == 'e' || *str == 'E')) {
+        ++str;
+        bool neg = false;
+        if (str < end && (*str == '-' || *str == '+')) {
+            neg = *str == '-';
+            ++str;
+        }
+        int64 e = 0;
+        while (str < end && (uint8) (*str - '0') < 10) {
+            if (e < 0x10000000) e = e * 10 + (*str - '0');
+            ++str;
+        }
+        q += neg ? -e : e;
+    }
+
+    d.w = w;
+    d.q = q;
+    return str;
+}
+
+void StringConversions::_decimalToFloat(const _Decimal &d, const char *str, size_t len, float32 &x) {
+    // exact operands give a correctly rounded result in a single operation
+    if (! d.truncated && d.q >= -10 && d.q <= 10 && d.w <= (1ull << 24)) {
+        x = (float32) d.w;
+        x = d.q < 0 ? x / _POW10_FLOAT32[-d.q] : x * _POW10_FLOAT32[d.q];
+        if (d.neg) x = -x;
+        return;
+    }
+
+    uint32 bits = (uint32) _eiselLemire(d.w, d.q, _FLOAT32_FORMAT);
+    if (d.truncated && bits != (uint32) _eiselLemire(d.w + 1, d.q, _FLOAT32_FORMAT)) {
+        x = _parseFallback<float32>(str, len, strtof);
+        return;
+    }
+    bits |= (uint32) d.neg << 31;
+    memcpy(&x, &bits, sizeof(x));
+}
+
+void StringConversions::_decimalToFloat(const _Decimal &d, const char *str, size_t len, float64 &x) {
+    if (! d.truncated && d.q >= -22 && d.q <= 22 && d.w <= (1ull << 53)) {
+        x = (float64) d.w;
+        x = d.q < 0 ? x / _POW10_FLOAT64[-d.q] : x * _POW10_FLOAT64[d.q];
+        if (d.neg) x = -x;
+        return;
+    }
+
+    uint64 bits = _eiselLemire(d.w, d.q, _FLOAT64_FORMAT);
+    if (d.truncated && bits != _eiselLemire(d.w + 1, d.q, _FLOAT64_FORMAT)) {
+        x = _parseFallback<float64>(str, len, strtod);
+        return;
+    }
+    bits |= (uint64) d.neg << 63;
+    memcpy(&x, &bits, sizeof(x));
+}
+
+void StringConversions::_decimalToFloat(const _Decimal &d, const char *str, size_t len, float128 &x) {
+    constexpr int maxExponent = LDBL_MANT_DIG >= 64 ? 27 : 22;
+    constexpr int mantissaBits = LDBL_MANT_DIG >= 64 ? 64 : LDBL_MANT_DIG;
+
+    if (d.w == 0) {
+        x = d.neg ? -0.0L : 0.0L;
+        return;
+    }
+    if (! d.truncated && d.q >= -maxExponent && d.q <= maxExponent
+        && (mantissaBits >= 64 || d.w <= (1ull << (mantissaBits & 63)))
+    ) {
+        x = (float128) d.w;
+        x = d.q < 0 ? x / _POW10_FLOAT128[-d.q] : x * _POW10_FLOAT128[d.q];
+        if (d.neg) x = -x;
+        return;
+    }
+    x = _parseFallback<float128>(str, len, strtold);
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <tcp_connection_pool.h>
+#include <hash.h>
+#include <cstring>
+
+using namespace spl;
+
+// TCPConnectionPool ///////////////////////////////////////////////////////////
+
+size_t TCPConnectionPool::AddressHash::operator()(const SocketAddress &addr) const {
+    if (addr.family == SocketFamily::IPV4) {
+        return hash_combine(
+            hash(&addr.v4.sin_addr, sizeof(addr.v4.sin_addr)),
+            addr.v4.sin_port
+        );
+    }
+    else {
+        return hash_combine(
+            hash(&addr.v6.sin6_addr, sizeof(addr.v6.sin6_addr)),
+            addr.v6.sin6_port
+        );
+    }
+}
+
+bool TCPConnectionPool::AddressEqual::operator()(const SocketAddress &lhs, const SocketAddress &rhs) const {
+    if (lhs.family != rhs.family) return false;
+    if (lhs.family == SocketFamily::IPV4) {
+        return lhs.v4.sin_port == rhs.v4.sin_port
+            && memcmp(&lhs.v4.sin_addr, &rhs.v4.sin_addr, sizeof(lhs.v4.sin_addr)) == 0;
+    }
+    else {
+        return lhs.v6.sin6_port == rhs.v6.sin6_port
+            && memcmp(&lhs.v6.sin6_addr, &rhs.v6.sin6_addr, sizeof(lhs.v6.sin6_addr)) == 0;
+    }
+}
+
+bool TCPConnectionPool::_usable(Entry *e, std::chrono::steady_clock::time_point now) {
+    if (now - e->lastUsed >= _idleTimeout) return false;
+
+    // an idle connection has nothing to read, so readiness means the peer
+    // closed it, reset it, or sent unsolicited data
+    if (e->socket.waitReady(Reactor::READ, 0)) return false;
+
+    return ! _healthCheck || _healthCheck(e->socket);
+}
+
+void TCPConnectionPool::_release(const SocketAddress &addr, Entry *e) {
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        auto &idle = _idle[addr];
+        if (idle.size() < _maxIdlePerAddress) {
+            e->lastUsed = std::chrono::steady_clock::now();
+            idle.enqueueFront(e);
+            ++_numIdle;
+            return;
+        }
+    }
+    delete e;
+}
+
+TCPConnectionPool::Connection TCPConnectionPool::acquire(const SocketAddress &addr) {
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        auto &idle = _idle[addr];
+        auto now = std::chrono::steady_clock::now();
+
+        // most recently used first, as those are the least likely to have
+        // been closed by the peer
+        while (idle.nonEmpty()) {
+            Entry *e = idle.dequeue();
+            --_numIdle;
+            if (_usable(e, now)) return Connection(this, e, addr);
+            delete e;
+        }
+
+        ++_numConnects;
+    }
+
+    return Connection(this, new Entry(addr, _bufferSize), addr);
+}
+
+TCPConnectionPool & TCPConnectionPool::evictIdle() {
+    std::lock_guard<std::mutex> lk(_mtx);
+    auto now = std::chrono::steady_clock::now();
+
+    for (auto it = _idle.begin(); it != _idle.end(); ++it) {
+        auto &idle = (*it).v;
+        for (auto e = idle.begin(); e != idle.end(); ) {
+            if (now - (*e)->lastUsed >= _idleTimeout) {
+                delete *e;
+                idle.erase(e);
+                --_numIdle;
+            }
+            else {
+                ++e;
+            }
+        }
+    }
+    return *this;
+}
+
+TCPConnectionPool & TCPConnectionPool::clear() {
+    std::lock_guard<std::mutex> lk(_mtx);
+    for (auto it = _idle.begin(); it != _idle.end(); ++it) {
+        for (auto e : (*it).v) delete e;
+    }
+    _idle.clear();
+    _numIdle = 0;
+    return *this;
+}
+
+// TCPConnectionPool::Connection ///////////////////////////////////////////////
+
+void TCPConnectionPool::Connection::release() {
+    if (_entry == nullptr) return;
+
+    if (_pending > 0) {
+        discard();
+        return;
+    }
+
+    _pool->_release(_addr, _entry);
+    _entry = nullptr;
+}
+
+void TCPConnectionPool::Connection::discard() {
+    delete _entry;
+    _entry = nullptr;
+    _pending = 0;
+}
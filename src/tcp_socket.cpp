@@ -4,34 +4,75 @@
 */
 
 #include <tcp_socket.h>
+#include <io_stats.h>
 #include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/errqueue.h>
+#include <algorithm>
+#include <limits.h>
+#include <cstring>
 
 using namespace spl;
 
-// TCPSocket ///////////////////////////////////////////////////////////////////
+/**
+ * @brief Sums the lengths of n iovec entries.
+ */
+static size_t _length(const iovec *v, size_t n) {
+    size_t len = 0;
+    for (size_t i = 0; i < n; ++i) len += v[i].iov_len;
+    return len;
+}
 
-size_t TCPSocket::_MTU = _MAX_MTU;
+/**
+ * @brief Consumes n bytes from the front of an iovec sequence, starting at
+ * index i.
+ */
+static void _consume(std::vector<iovec> &v, size_t &i, size_t n) {
+    while (i < v.size() && n >= v[i].iov_len) {
+        n -= v[i].iov_len;
+        ++i;
+    }
+    if (n > 0) {
+        v[i].iov_base = (uint8_t *) v[i].iov_base + n;
+        v[i].iov_len -= n;
+    }
+}
 
-void TCPSocket::_resizeMTU(size_t oldMTU) {
+// TCPSocket ///////////////////////////////////////////////////////////////////
 
-    if (oldMTU > _MTU) return;
+size_t TCPSocket::_sendChunkSize() {
+    if (_chunkSize > 0) return _chunkSize;
 
-    size_t newMTU = _MTU;
-    if (
-        (newMTU <= _MAX_MTU && newMTU > 8000)
-        || (newMTU <= 512)
-    ) {
-        --newMTU;
+    int sndbuf = 0, mss = 0;
+    socklen_t len = sizeof(sndbuf);
+    if (getsockopt(_fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, &len) != 0 || sndbuf <= 0) {
+        return _INITIAL_SYSCALL_SIZE;
     }
-    else {
-        newMTU = 512;
+    size_t minChunk = _MIN_CHUNK_SIZE, maxChunk = _MAX_CHUNK_SIZE;
+    _chunkSize = std::max(std::min((size_t) sndbuf, maxChunk), minChunk);
+
+    // send whole segments to avoid a small trailing segment per chunk
+    len = sizeof(mss);
+    if (getsockopt(_fd, IPPROTO_TCP, TCP_MAXSEG, &mss, &len) == 0 && mss > 0 && (size_t) mss < _chunkSize) {
+        _chunkSize -= _chunkSize % mss;
     }
-    _MTU = newMTU;
+    return _chunkSize;
 }
 
-void TCPSocket::_send(const void *data, size_t len, int flags) {
+void TCPSocket::_shrinkChunkSize() {
+    if (_chunkSize <= _MIN_CHUNK_SIZE) {
+        throw CustomMessageErrnoRuntimeError("Error sending data");
+    }
+    size_t minChunk = _MIN_CHUNK_SIZE;
+    _chunkSize = std::max(_chunkSize / 2, minChunk);
+}
 
-    size_t maxLen = _INITIAL_SYSCALL_SIZE;
+void TCPSocket::_send(const void *data, size_t len, int flags, const Waiter *waiter) {
+
+    IOStats::Op op(IOPath::TCP_SEND);
+    size_t maxLen = _sendChunkSize();
 
     while (len > 0) {
         ssize_t sent;
@@ -41,16 +82,36 @@ void TCPSocket::_send(const void *data, size_t len, int flags) {
         else {
             sent = ::send(_fd, data, maxLen, flags | MSG_MORE);
         }
+        op.syscall(std::min(len, maxLen), sent);
 
         if (sent != -1) {
             len -= sent;
             data = (uint8_t *) data + sent;
+            if (flags & MSG_ZEROCOPY) ++_zeroCopySent;
         }
         else {
             switch (errno) {
-            case EAGAIN:
+            case EAGAIN: {
+                op.retry();
+                uint64_t since = op.waitBegin();
+                _wait(Reactor::WRITE, waiter);
+                op.blocked(since);
+                break;
+            }
+
             case EINTR:
-                sched_yield();
+                op.retry();
+                break;
+
+            case ENOBUFS:
+                // out of memory for pinned pages; wait for completions to
+                // release some, or copy this chunk if none are pending
+                if (! (flags & MSG_ZEROCOPY)) {
+                    throw CustomMessageErrnoRuntimeError("Error sending data");
+                }
+                if (zeroCopyPending() > 0) awaitZeroCopy();
+                else flags &= ~MSG_ZEROCOPY;
+                op.retry();
                 break;
 
             case ECONNRESET:
@@ -58,8 +119,9 @@ void TCPSocket::_send(const void *data, size_t len, int flags) {
                 throw ConnectionTerminatedError();
 
             case EMSGSIZE:
-                _resizeMTU(maxLen);
-                maxLen = _MTU;
+                op.backoff();
+                _shrinkChunkSize();
+                maxLen = _chunkSize;
                 break;
 
             default:
@@ -69,7 +131,59 @@ void TCPSocket::_send(const void *data, size_t len, int flags) {
     }
 }
 
-ssize_t TCPSocket::_recv(void *data, size_t len, bool returnOnBlock, int flags) {
+void TCPSocket::_send(const iovec *iov, int count, int flags, const Waiter *waiter) {
+
+    IOStats::Op op(IOPath::TCP_SEND);
+    std::vector<iovec> v(iov, iov + count);
+    size_t i = 0;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+
+    while (i < v.size()) {
+        msg.msg_iov = &v[i];
+        msg.msg_iovlen = std::min(v.size() - i, (size_t) IOV_MAX);
+
+        ssize_t sent = ::sendmsg(_fd, &msg, msg.msg_iovlen < v.size() - i ? flags | MSG_MORE : flags);
+        op.syscall(op.active() ? _length(&v[i], msg.msg_iovlen) : 0, sent);
+
+        if (sent != -1) {
+            _consume(v, i, sent);
+        }
+        else {
+            switch (errno) {
+            case EAGAIN: {
+                op.retry();
+                uint64_t since = op.waitBegin();
+                _wait(Reactor::WRITE, waiter);
+                op.blocked(since);
+                break;
+            }
+
+            case EINTR:
+                op.retry();
+                break;
+
+            case ECONNRESET:
+            case EPIPE:
+                throw ConnectionTerminatedError();
+
+            case EMSGSIZE:
+                // fall back to sending the blocks one at a time
+                for (; i < v.size(); ++i) {
+                    _send(v[i].iov_base, v[i].iov_len, flags, waiter);
+                }
+                break;
+
+            default:
+                throw CustomMessageErrnoRuntimeError("Error sending data");
+            }
+        }
+    }
+}
+
+ssize_t TCPSocket::_recv(void *data, size_t len, bool returnOnBlock, int flags, const Waiter *waiter) {
+    IOStats::Op op(IOPath::TCP_RECV);
     size_t maxLen = _INITIAL_SYSCALL_SIZE;
 
     size_t requestSize = len;
@@ -80,6 +194,7 @@ ssize_t TCPSocket::_recv(void *data, size_t len, bool returnOnBlock, int flags)
             len < maxLen ? len : maxLen,
             flags
         );
+        op.syscall(len < maxLen ? len : maxLen, recvd);
         if (recvd == 0) {
             if (requestSize - len > 0) break;
             throw ConnectionTerminatedError();
@@ -90,10 +205,18 @@ ssize_t TCPSocket::_recv(void *data, size_t len, bool returnOnBlock, int flags)
         }
         else {
             switch (errno) {
-            case EAGAIN:
+            case EAGAIN: {
+                if (returnOnBlock) return requestSize - len;
+                op.retry();
+                uint64_t since = op.waitBegin();
+                _wait(Reactor::READ, waiter);
+                op.blocked(since);
+                break;
+            }
+
             case EINTR:
                 if (returnOnBlock) return requestSize - len;
-                else sched_yield();
+                op.retry();
                 break;
 
             default:
@@ -116,17 +239,38 @@ TCPSocket::TCPSocket(int fd)
     }
 }
 
-TCPSocket::TCPSocket(const SocketAddress &addr) {
-    _fd = socket((int) addr.family, SOCK_STREAM, 0);
-    _addr = addr;
+TCPSocket::TCPSocket(const SocketAddress &addr)
+:   _fd(_connect(addr, nullptr)),
+    _addr(addr)
+{ }
 
-    if (_fd == -1) {
+int TCPSocket::_connect(const SocketAddress &addr, const Waiter *waiter) {
+    // with a waiter, connect without blocking and wait for the outcome
+    int fd = socket((int) addr.family, waiter != nullptr ? SOCK_STREAM | SOCK_NONBLOCK : SOCK_STREAM, 0);
+
+    if (fd == -1) {
         throw CustomMessageErrnoRuntimeError("Error creating socket");
     }
 
-    if (connect(_fd, (sockaddr *) &addr, sizeof(SocketAddress)) == -1) {
-        int err = errno;
-        ::close(_fd);
+    int err = 0;
+    if (connect(fd, (sockaddr *) &addr, sizeof(SocketAddress)) == -1) {
+        err = errno;
+        if (err == EINPROGRESS && waiter != nullptr) {
+            try {
+                (*waiter)(fd, Reactor::WRITE);
+            }
+            catch (...) {
+                ::close(fd);
+                throw;
+            }
+            socklen_t len = sizeof(err);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1) err = errno;
+        }
+    }
+
+    if (err != 0) {
+        ::close(fd);
+        errno = err;
 
         switch (err) {
         case ETIMEDOUT:
@@ -142,6 +286,82 @@ TCPSocket::TCPSocket(const SocketAddress &addr) {
             throw CustomMessageErrnoRuntimeError("Error connecting to target");
         }
     }
+
+    return fd;
+}
+
+bool TCPSocket::waitReady(uint32_t events, int timeoutMillis) {
+    if (timeoutMillis < 0 && _waiter) {
+        _waiter(_fd, events);
+        return true;
+    }
+
+    pollfd pfd;
+    pfd.fd = _fd;
+    pfd.events = ((events & Reactor::READ) ? POLLIN : 0) | ((events & Reactor::WRITE) ? POLLOUT : 0);
+    pfd.revents = 0;
+
+    while (true) {
+        int n = ::poll(&pfd, 1, timeoutMillis);
+        if (n > 0) return true;
+        else if (n == 0) return false;
+        else if (errno != EINTR) throw CustomMessageErrnoRuntimeError("Error waiting on socket");
+    }
+}
+
+TCPSocket & TCPSocket::setZeroCopy(bool enable, size_t threshold) {
+    int opt = enable ? 1 : 0;
+    if (setsockopt(_fd, SOL_SOCKET, SO_ZEROCOPY, &opt, sizeof(opt)) != 0 && enable) {
+        throw CustomMessageErrnoRuntimeError("Error enabling zero-copy sending");
+    }
+    _zeroCopyThreshold = enable ? std::max(threshold, (size_t) 1) : 0;
+    return *this;
+}
+
+size_t TCPSocket::zeroCopyPending() {
+    while (_zeroCopyDone != _zeroCopySent) {
+        char control[128];
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+            if (errno == EAGAIN || errno == EINTR) break;
+            throw CustomMessageErrnoRuntimeError("Error reading zero-copy completions");
+        }
+
+        for (cmsghdr *c = CMSG_FIRSTHDR(&msg); c != nullptr; c = CMSG_NXTHDR(&msg, c)) {
+            if (
+                ! (c->cmsg_level == SOL_IP && c->cmsg_type == IP_RECVERR)
+                && ! (c->cmsg_level == SOL_IPV6 && c->cmsg_type == IPV6_RECVERR)
+            ) {
+                continue;
+            }
+
+            auto e = (const sock_extended_err *) CMSG_DATA(c);
+            if (e->ee_errno == 0 && e->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                // notifications cover the inclusive range of send calls
+                // [ee_info, ee_data]
+                _zeroCopyDone += e->ee_data - e->ee_info + 1;
+            }
+        }
+    }
+    return _zeroCopySent - _zeroCopyDone;
+}
+
+TCPSocket & TCPSocket::awaitZeroCopy() {
+    while (zeroCopyPending() > 0) {
+        // completions are signaled as errors, which poll always reports
+        pollfd pfd;
+        pfd.fd = _fd;
+        pfd.events = 0;
+        pfd.revents = 0;
+        if (::poll(&pfd, 1, -1) == -1 && errno != EINTR) {
+            throw CustomMessageErrnoRuntimeError("Error waiting on socket");
+        }
+    }
+    return *this;
 }
 
 void TCPSocket::close() {
@@ -154,9 +374,12 @@ void TCPSocket::close() {
 // TCPServerSocket /////////////////////////////////////////////////////////////
 
 TCPServerSocket::TCPServerSocket(in_port_t port, int maxWaitingQueueLength, SocketFamily family)
-:   TCPSocket()
+:   TCPSocket(),
+    _accepting(false)
 {
-    _fd = socket((int) family, SOCK_STREAM, 0);
+    // non-blocking, so that asyncAccept() and pollOrAccept() never block in
+    // accept4 when another thread takes the pending connection first
+    _fd = socket((int) family, SOCK_STREAM | SOCK_NONBLOCK, 0);
 
     if (_fd == -1) {
         throw CustomMessageErrnoRuntimeError("Error creating socket");
@@ -201,14 +424,29 @@ void TCPServerSocket::close() {
         if (conn.v != nullptr) delete conn.v;
     }
     _connections.clear();
-    _pollfds.clear();
+    _accepting = false;
 }
 
-TCPSocket TCPServerSocket::accept() {
+TCPSocket TCPServerSocket::_accept(const Waiter *waiter) {
     SocketAddress addr;
-    socklen_t len = sizeof(addr);
-    int incoming = ::accept4(_fd, (sockaddr *) &addr, &len, SOCK_NONBLOCK);
-    return TCPSocket(incoming, addr);
+    while (true) {
+        socklen_t len = sizeof(addr);
+        int incoming = ::accept4(_fd, (sockaddr *) &addr, &len, SOCK_NONBLOCK);
+        if (incoming != -1) return TCPSocket(incoming, addr);
+
+        switch (errno) {
+        case EAGAIN:
+            _wait(Reactor::READ, waiter);
+            break;
+
+        case EINTR:
+        case ECONNABORTED:
+            break;
+
+        default:
+            throw CustomMessageErrnoRuntimeError("Error accepting connection");
+        }
+    }
 }
 
 TCPSocket * TCPServerSocket::poll() {
@@ -238,3 +476,76 @@ TCPSocket * TCPServerSocket::pollOrAccept() {
     }
     return ptr;
 }
+
+// TCPServerGroup //////////////////////////////////////////////////////////////
+
+TCPServerGroup::TCPServerGroup(in_port_t port, size_t size, int maxWaitingQueueLength, SocketFamily family)
+:   _running(false)
+{
+    try {
+        for (size_t i = 0; i < size; ++i) {
+            _servers.push_back(new TCPServerSocket(port, maxWaitingQueueLength, family));
+            if (port == 0) {
+                const SocketAddress &addr = _servers[0]->address();
+                port = ntohs(family == SocketFamily::IPV4 ? addr.v4.sin_port : addr.v6.sin6_port);
+            }
+        }
+    }
+    catch (...) {
+        for (auto s : _servers) delete s;
+        throw;
+    }
+}
+
+TCPServerGroup::~TCPServerGroup() {
+    try {
+        stop();
+    }
+    catch (...) { }
+
+    for (auto s : _servers) delete s;
+}
+
+void TCPServerGroup::_serve(TCPServerSocket &server, const Handler &handler) {
+    try {
+        while (_running) {
+            server.pollOrAccept(
+                [&server, &handler] (TCPSocket *conn) { handler(server, conn); },
+                __POLL_TIMEOUT_MILLIS
+            );
+        }
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lk(_errorMtx);
+        if (! _error) _error = std::current_exception();
+    }
+}
+
+TCPServerGroup & TCPServerGroup::start(const Handler &handler, const std::vector<ThreadAffinitySet> &affinity) {
+    if (_running) throw Error("The server group is already running");
+
+    _running = true;
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        TCPServerSocket *server = _servers[i];
+        _threads.emplace_back([this, server, handler] { _serve(*server, handler); });
+        if (! affinity.empty()) {
+            _threads.back().setAffinity(affinity[i % affinity.size()]);
+        }
+    }
+    return *this;
+}
+
+TCPServerGroup & TCPServerGroup::stop() {
+    _running = false;
+    for (auto &t : _threads) {
+        if (t.joinable()) t.join();
+    }
+    _threads.clear();
+
+    if (_error) {
+        std::exception_ptr e = _error;
+        _error = nullptr;
+        std::rethrow_exception(e);
+    }
+    return *this;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <udp_socket.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+using namespace spl;
+
+UDPSocket::UDPSocket(in_port_t port, SocketFamily family, bool reusePort) {
+    _fd = socket((int) family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+    if (_fd == -1) {
+        throw CustomMessageErrnoRuntimeError("Error creating socket");
+    }
+
+    int opt = 1;
+    if (reusePort && setsockopt(_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+        ::close(_fd);
+        throw CustomMessageErrnoRuntimeError("Error setting socket options");
+    }
+
+    memset(&_addr, 0, sizeof(_addr));
+    if (family == SocketFamily::IPV4) {
+        _addr.v4.sin_family = AF_INET;
+        _addr.v4.sin_addr.s_addr = INADDR_ANY;
+        _addr.v4.sin_port = htons(port);
+    }
+    else {
+        _addr.v6.sin6_family = AF_INET6;
+        _addr.v6.sin6_addr = IN6ADDR_ANY_INIT;
+        _addr.v6.sin6_port = htons(port);
+    }
+
+    if (bind(_fd, (sockaddr *) &_addr, sizeof(_addr)) == -1) {
+        ::close(_fd);
+        throw CustomMessageErrnoRuntimeError("Error binding socket to port");
+    }
+
+    socklen_t len = sizeof(_addr);
+    if (getsockname(_fd, (sockaddr *) &_addr, &len) == -1 || len > sizeof(_addr)) {
+        ::close(_fd);
+        throw CustomMessageErrnoRuntimeError("Error getting socket address");
+    }
+}
+
+UDPSocket & UDPSocket::connect(const SocketAddress &addr) {
+    if (::connect(_fd, (const sockaddr *) &addr, sizeof(addr)) == -1) {
+        throw CustomMessageErrnoRuntimeError("Error connecting socket");
+    }
+    return *this;
+}
+
+void UDPSocket::sendTo(const void *data, size_t len, const SocketAddress &addr) {
+    while (::sendto(_fd, data, len, MSG_NOSIGNAL, (const sockaddr *) &addr, sizeof(addr)) == -1) {
+        if (errno == EAGAIN) waitReady(Reactor::WRITE);
+        else if (errno != EINTR) throw CustomMessageErrnoRuntimeError("Error sending datagram");
+    }
+}
+
+void UDPSocket::send(const void *data, size_t len) {
+    while (::send(_fd, data, len, MSG_NOSIGNAL) == -1) {
+        if (errno == EAGAIN) waitReady(Reactor::WRITE);
+        else if (errno != EINTR) throw CustomMessageErrnoRuntimeError("Error sending datagram");
+    }
+}
+
+ssize_t UDPSocket::recvFrom(void *data, size_t len, SocketAddress *from, bool block) {
+    while (true) {
+        socklen_t addrLen = sizeof(SocketAddress);
+        ssize_t n = ::recvfrom(
+            _fd,
+            data,
+            len,
+            block ? 0 : MSG_DONTWAIT,
+            (sockaddr *) from,
+            from == nullptr ? nullptr : &addrLen
+        );
+        if (n != -1) return n;
+
+        switch (errno) {
+        case EAGAIN:
+            if (! block) return -1;
+            waitReady(Reactor::READ);
+            break;
+
+        case EINTR:
+            if (! block) return -1;
+            break;
+
+        default:
+            throw CustomMessageErrnoRuntimeError("Error receiving datagram");
+        }
+    }
+}
+
+void UDPSocket::sendBatch(const Datagram *datagrams, size_t count) {
+    mmsghdr msgs[BATCH_SIZE];
+    iovec iov[BATCH_SIZE];
+
+    while (count > 0) {
+        size_t n = count < BATCH_SIZE ? count : BATCH_SIZE;
+
+        memset(msgs, 0, n * sizeof(mmsghdr));
+        for (size_t i = 0; i < n; ++i) {
+            iov[i].iov_base = datagrams[i].data;
+            iov[i].iov_len = datagrams[i].len;
+            msgs[i].msg_hdr.msg_name = (void *) &datagrams[i].addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(SocketAddress);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent = ::sendmmsg(_fd, msgs, n, MSG_NOSIGNAL);
+        if (sent == -1) {
+            if (errno == EAGAIN) waitReady(Reactor::WRITE);
+            else if (errno != EINTR) throw CustomMessageErrnoRuntimeError("Error sending datagrams");
+            continue;
+        }
+
+        datagrams += sent;
+        count -= sent;
+    }
+}
+
+size_t UDPSocket::recvBatch(Datagram *datagrams, size_t count, bool block) {
+    static constexpr size_t controlSize = CMSG_SPACE(sizeof(int));
+
+    mmsghdr msgs[BATCH_SIZE];
+    iovec iov[BATCH_SIZE];
+    alignas(cmsghdr) char control[BATCH_SIZE][controlSize];
+
+    size_t n = count < BATCH_SIZE ? count : BATCH_SIZE;
+    if (n == 0) return 0;
+
+    memset(msgs, 0, n * sizeof(mmsghdr));
+    for (size_t i = 0; i < n; ++i) {
+        iov[i].iov_base = datagrams[i].data;
+        iov[i].iov_len = datagrams[i].len;
+        msgs[i].msg_hdr.msg_name = &datagrams[i].addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(SocketAddress);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i];
+        msgs[i].msg_hdr.msg_controllen = controlSize;
+    }
+
+    int recvd;
+    while ((recvd = ::recvmmsg(_fd, msgs, n, block ? MSG_WAITFORONE : MSG_DONTWAIT, nullptr)) == -1) {
+        switch (errno) {
+        case EAGAIN:
+            if (! block) return 0;
+            waitReady(Reactor::READ);
+            break;
+
+        case EINTR:
+            if (! block) return 0;
+            break;
+
+        default:
+            throw CustomMessageErrnoRuntimeError("Error receiving datagrams");
+        }
+    }
+
+    for (int i = 0; i < recvd; ++i) {
+        datagrams[i].len = msgs[i].msg_len;
+        datagrams[i].segmentSize = 0;
+
+        msghdr &h = msgs[i].msg_hdr;
+        for (cmsghdr *c = CMSG_FIRSTHDR(&h); c != nullptr; c = CMSG_NXTHDR(&h, c)) {
+            if (c->cmsg_level == SOL_UDP && c->cmsg_type == UDP_GRO) {
+                int size;
+                memcpy(&size, CMSG_DATA(c), sizeof(size));
+                datagrams[i].segmentSize = (uint16_t) size;
+            }
+        }
+    }
+    return recvd;
+}
+
+UDPSocket & UDPSocket::setSendSegmentSize(uint16_t size) {
+    int opt = size;
+    if (setsockopt(_fd, SOL_UDP, UDP_SEGMENT, &opt, sizeof(opt)) == -1) {
+        throw CustomMessageErrnoRuntimeError("Error setting segmentation offload");
+    }
+    return *this;
+}
+
+UDPSocket & UDPSocket::setReceiveCoalescing(bool enable) {
+    int opt = enable ? 1 : 0;
+    if (setsockopt(_fd, SOL_UDP, UDP_GRO, &opt, sizeof(opt)) == -1) {
+        throw CustomMessageErrnoRuntimeError("Error setting receive offload");
+    }
+    return *this;
+}
+
+bool UDPSocket::waitReady(uint32_t events, int timeoutMillis) {
+    pollfd pfd;
+    pfd.fd = _fd;
+    pfd.events = ((events & Reactor::READ) ? POLLIN : 0) | ((events & Reactor::WRITE) ? POLLOUT : 0);
+    pfd.revents = 0;
+
+    while (true) {
+        int n = ::poll(&pfd, 1, timeoutMillis);
+        if (n > 0) return true;
+        else if (n == 0) return false;
+        else if (errno != EINTR) throw CustomMessageErrnoRuntimeError("Error waiting on socket");
+    }
+}
+
+void UDPSocket::close() {
+    if (_fd != -1) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
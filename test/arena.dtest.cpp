@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+
+#include <arena.h>
+#include <list.h>
+#include <deque.h>
+#include <heap.h>
+#include <hash_map.h>
+#include <hash_set.h>
+
+module("arena")
+.dependsOn({
+    "exception"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (1024)
+#define PERFORMANCE_TEST_SIZE (400 * 1024)
+#define PERFORMANCE_MARGIN (0.99)
+
+unit("arena", "allocate")
+.body([] {
+    Arena arena(1024);
+
+    char *a = (char *) arena.allocate(1, 1);
+    char *b = (char *) arena.allocate(1, 1);
+    assert(b == a + 1);
+
+    for (size_t align = 1; align <= 256; align *= 2) {
+        void *p = arena.allocate(3, align);
+        assert((uintptr_t) p % align == 0);
+    }
+
+    // larger than a chunk
+    char *big = (char *) arena.allocate(10000, 64);
+    assert((uintptr_t) big % 64 == 0);
+    memset(big, 1, 10000);
+
+    // the current chunk remains usable after a dedicated allocation
+    char *c = (char *) arena.allocate(1, 1);
+    assert(c > b && c < a + 1024);
+
+    assert(arena.allocated() >= 10000 + 3);
+});
+
+unit("arena", "reset")
+.body([] {
+    Arena arena(4096);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        arena.allocate(64);
+    }
+    size_t capacity = arena.capacity();
+    assert(capacity >= TEST_SIZE * 64);
+
+    arena.reset();
+    assert(arena.allocated() == 0);
+    assert(arena.capacity() == capacity);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        arena.allocate(64);
+    }
+    assert(arena.capacity() == capacity);
+
+    arena.release();
+    assert(arena.capacity() == 0);
+});
+
+unit("arena", "scope")
+.body([] {
+    Arena a, b;
+
+    assert(Arena::current() == nullptr);
+    {
+        Arena::Scope s1(a);
+        assert(Arena::current() == &a);
+        {
+            Arena::Scope s2(b);
+            assert(Arena::current() == &b);
+        }
+        assert(Arena::current() == &a);
+    }
+    assert(Arena::current() == nullptr);
+});
+
+unit("arena", "no-scope")
+.expect(Status::FAIL)
+.body([] {
+    List<int, ArenaAllocator> l;
+    l << 1;
+});
+
+unit("arena", "containers")
+.dependsOn({ "list", "deque", "heap", "hash-map", "hash-set" })
+.body([] {
+    Arena arena;
+    Arena::Scope scope(arena);
+
+    {
+        List<int, ArenaAllocator> l;
+        Deque<int, ArenaAllocator> q;
+        Heap<int, std::less<int>, 2, ArenaAllocator> h;
+        HashMap<int, int, Hash<int>, std::equal_to<int>, ArenaAllocator> m;
+        HashSet<int, Hash<int>, std::equal_to<int>, ArenaAllocator> s;
+
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            l << i;
+            q << i;
+            h << i;
+            m.put(i, 2 * i);
+            s.put(i);
+        }
+
+        assert(l.size() == TEST_SIZE);
+        assert(q.size() == TEST_SIZE);
+        assert(h.size() == TEST_SIZE);
+        assert(m.size() == TEST_SIZE);
+        assert(s.size() == TEST_SIZE);
+
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            assert(q.dequeue() == i);
+            assert(h.pop() == TEST_SIZE - 1 - i);
+            assert(m[i] == 2 * i);
+            assert(s.contains(i));
+        }
+
+        auto l2 = l.map([] (int x) { return x + 1; });
+        int i = 1;
+        for (auto &x : l2) {
+            assert(x == i++);
+        }
+    }
+
+    assert(arena.allocated() > TEST_SIZE * sizeof(int) * 5);
+    arena.reset();
+    assert(arena.allocated() == 0);
+});
+
+perf("arena", "list-append(p)")
+.performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
+.body([] {
+    Arena arena;
+    Arena::Scope scope(arena);
+    {
+        List<int, ArenaAllocator> l;
+        for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+            l << i;
+        }
+    }
+    arena.reset();
+})
+.baseline([] {
+    List<int, core::HeapAllocator> l;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        l << i;
+    }
+});
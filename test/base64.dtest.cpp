@@ -5,12 +5,20 @@
 
 #include <dtest.h>
 #include <base64.h>
+#include <string>
+#include "test_serializers.cpp"
 
 module("base64")
 .dependsOn({
     "exception"
 });
 
+module("base64-serializer")
+.dependsOn({
+    "base64",
+    "stream-serializer"
+});
+
 using namespace spl;
 
 unit("base64", "encode")
@@ -37,3 +45,129 @@ unit("base64", "decode")
     free(encoded);
     free(decoded);
 });
+
+unit("base64", "vectors")
+.body([] {
+    static const char *vectors[][2] = {
+        { "", "" },
+        { "f", "Zg==" },
+        { "fo", "Zm8=" },
+        { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" },
+        { "fooba", "Zm9vYmE=" },
+        { "foobar", "Zm9vYmFy" },
+    };
+
+    for (auto &v : vectors) {
+        char encoded[16], decoded[16];
+        size_t len = Base64::encode(v[0], strlen(v[0]), encoded);
+        assert(len == Base64::encodedLength(strlen(v[0])));
+        assert(std::string(encoded, len) == v[1]);
+        assert(Base64::decode(encoded, len, decoded) == strlen(v[0]));
+        assert(memcmp(decoded, v[0], strlen(v[0])) == 0);
+    }
+});
+
+unit("base64", "round-trip")
+.body([] {
+    std::string data;
+    for (int i = 0; i < 4096; ++i) data.push_back((char) (i * 7919 >> 3));
+
+    // lengths around the vector block sizes exercise every tail
+    for (size_t len = 0; len < 300; ++len) {
+        std::string encoded(Base64::encodedLength(len), '\0');
+        std::string decoded(Base64::maxDecodedLength(encoded.size()), '\0');
+        assert(Base64::encode(data.data(), len, &encoded[0]) == encoded.size());
+        assert(Base64::decode(encoded.data(), encoded.size(), &decoded[0]) == len);
+        assert(decoded.compare(0, len, data, 0, len) == 0);
+    }
+});
+
+unit("base64", "invalid")
+.body([] {
+    std::string encoded(Base64::encodedLength(300), '\0');
+    std::string decoded(300, '\0');
+    std::string data(300, 'x');
+    Base64::encode(data.data(), data.size(), &encoded[0]);
+
+    for (size_t i = 0; i < encoded.size(); i += 7) {
+        for (char c : { '*', '=', '\n', (char) 0xc3 }) {
+            // padding is valid at the end
+            if (c == '=' && i >= encoded.size() - 2) continue;
+            std::string bad = encoded;
+            bad[i] = c;
+            bool thrown = false;
+            try { Base64::decode(bad.data(), bad.size(), &decoded[0]); }
+            catch (const InvalidArgument &) { thrown = true; }
+            assert(thrown);
+        }
+    }
+
+    bool thrown = false;
+    try { Base64::decode("Zm9", 3, &decoded[0]); }
+    catch (const InvalidArgument &) { thrown = true; }
+    assert(thrown);
+});
+
+unit("base64-serializer", "primitive-types")
+.body([] {
+    MemoryOutputStreamSerializer sink;
+    OutputBase64Serializer out(sink);
+    out << 1 << 2l << (short) 3;
+    out.finish();
+
+    auto &source = *sink.toInput();
+    InputBase64Serializer in(source);
+
+    int x;
+    long y;
+    short z;
+    in >> x >> y >> z;
+    assert(x == 1);
+    assert(y == 2);
+    assert(z == 3);
+
+    delete &source;
+});
+
+unit("base64-serializer", "large-serialization")
+.body([] {
+    MemoryOutputStreamSerializer sink;
+    OutputBase64Serializer out(sink);
+    for (int i = 0; i < 10000; ++i) {
+        out << (char) i;
+        if (i % 3 == 0) out << i;
+    }
+    out.finish();
+
+    // the text matches a one-shot encoding of the same bytes
+    std::string plain;
+    for (int i = 0; i < 10000; ++i) {
+        plain.push_back((char) i);
+        if (i % 3 == 0) plain.append((const char *) &i, sizeof(i));
+    }
+    assert(sink.totalByteCount() == Base64::encodedLength(plain.size()));
+
+    auto &source = *sink.toInput();
+    InputBase64Serializer in(source);
+    for (int i = 0; i < 10000; ++i) {
+        char c;
+        in >> c;
+        assert(c == (char) i);
+        if (i % 3 == 0) {
+            int x;
+            in >> x;
+            assert(x == i);
+        }
+    }
+
+    bool thrown = false;
+    try {
+        char c;
+        in >> c;
+    }
+    catch (const Error &) { thrown = true; }
+    assert(thrown);
+
+    delete &source;
+});
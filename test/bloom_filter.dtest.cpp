@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <bloom_filter.h>
+#include <hash_set.h>
+#include <hash_map.h>
+#include <string>
+#include "test_serializers.cpp"
+
+module("bloom-filter")
+.dependsOn({
+    "hash-set",
+    "hash-map"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (100000)
+#define PERFORMANCE_ITERATIONS (1000000)
+
+template <typename Filter>
+static double falsePositives(const Filter &f, int from, int to) {
+    size_t n = 0;
+    for (int i = from; i < to; ++i) {
+        if (f.mightContain(i)) ++n;
+    }
+    return (double) n / (to - from);
+}
+
+unit("bloom-filter", "no-false-negatives")
+.body([] {
+    BloomFilter<int> f(TEST_SIZE);
+    assert(f.empty());
+
+    for (int i = 0; i < TEST_SIZE; ++i) f.add(i);
+    assert(f.size() == TEST_SIZE);
+
+    for (int i = 0; i < TEST_SIZE; ++i) assert(f.mightContain(i));
+    assert(falsePositives(f, TEST_SIZE, 2 * TEST_SIZE) < 0.02);
+
+    f.clear();
+    assert(f.empty());
+    assert(falsePositives(f, 0, TEST_SIZE) == 0);
+});
+
+unit("bloom-filter", "false-positive-rate")
+.body([] {
+    BloomFilter<int> f(TEST_SIZE, 0.001);
+    for (int i = 0; i < TEST_SIZE; ++i) f.add(i);
+    assert(falsePositives(f, TEST_SIZE, 11 * TEST_SIZE) < 0.002);
+
+    bool thrown = false;
+    try {
+        BloomFilter<int> g(TEST_SIZE, 1.5);
+    }
+    catch (const InvalidArgument &) {
+        thrown = true;
+    }
+    assert(thrown);
+});
+
+unit("bloom-filter", "from-container")
+.body([] {
+    HashSet<std::string> s;
+    HashMap<int, int> m;
+    for (int i = 0; i < 1000; ++i) {
+        s.put(std::to_string(i));
+        m.put(i, -i);
+    }
+
+    BloomFilter<std::string> fs(s);
+    BloomFilter<int> fm(m);
+    for (int i = 0; i < 1000; ++i) {
+        assert(fs.mightContain(std::to_string(i)));
+        assert(fm.mightContain(i));
+    }
+
+    // erased keys are dropped on rebuild
+    for (int i = 0; i < 1000; ++i) m.erase(i);
+    m.put(-1, 1);
+    fm.rebuild(m);
+    assert(fm.size() == 1);
+    assert(fm.mightContain(-1));
+    assert(falsePositives(fm, 0, 1000) < 0.01);
+});
+
+unit("bloom-filter", "merge")
+.body([] {
+    BloomFilter<int> a(TEST_SIZE), b(TEST_SIZE), c(10);
+    for (int i = 0; i < TEST_SIZE / 2; ++i) a.add(i);
+    for (int i = TEST_SIZE / 2; i < TEST_SIZE; ++i) b.add(i);
+
+    a.merge(b);
+    assert(a.size() == TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) assert(a.mightContain(i));
+
+    bool thrown = false;
+    try {
+        a.merge(c);
+    }
+    catch (const InvalidArgument &) {
+        thrown = true;
+    }
+    assert(thrown);
+});
+
+unit("bloom-filter", "serialization")
+.body([] {
+    BloomFilter<int> f(TEST_SIZE), g(1);
+    for (int i = 0; i < TEST_SIZE; ++i) f.add(i);
+
+    MemoryOutputStreamSerializer out;
+    out << f;
+    out.flush();
+
+    auto in = out.toInput();
+    *in >> g;
+    delete in;
+
+    assert(g.size() == f.size());
+    assert(g.sizeInBytes() == f.sizeInBytes());
+    for (int i = 0; i < TEST_SIZE; ++i) assert(g.mightContain(i));
+    for (int i = TEST_SIZE; i < 2 * TEST_SIZE; ++i) {
+        assert(g.mightContain(i) == f.mightContain(i));
+    }
+});
+
+perf("bloom-filter", "negative-lookup")
+.body([] {
+    HashSet<int> s((size_t) TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) s.put(i);
+    BloomFilter<int> f(s);
+
+    size_t found = 0;
+    for (int i = TEST_SIZE; i < TEST_SIZE + PERFORMANCE_ITERATIONS; ++i) {
+        if (f.mightContain(i) && s.contains(i)) ++found;
+    }
+    assert(found == 0);
+})
+.baseline([] {
+    HashSet<int> s((size_t) TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) s.put(i);
+
+    size_t found = 0;
+    for (int i = TEST_SIZE; i < TEST_SIZE + PERFORMANCE_ITERATIONS; ++i) {
+        if (s.contains(i)) ++found;
+    }
+    assert(found == 0);
+});
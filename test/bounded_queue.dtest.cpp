@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+
+#include <bounded_queue.h>
+#include <thread.h>
+#include <list.h>
+#include <deque.h>
+
+module("parallel::bounded-queue")
+.dependsOn({
+    "exception"
+});
+
+using namespace spl;
+
+#define TEST_SIZE 1000
+#define PARALLEL_TEST_SIZE 1000000
+
+unit("parallel::bounded-queue", "capacity")
+.body([] {
+    parallel::BoundedQueue<int> q(100);
+    assert(q.capacity() == 128);
+    assert(q.empty());
+});
+
+unit("parallel::bounded-queue", "fifo")
+.body([] {
+    parallel::BoundedQueue<int> q(TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) q.enqueue(i);
+    assert(q.size() == TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) assert(q.dequeue() == i);
+    assert(q.empty());
+});
+
+unit("parallel::bounded-queue", "full")
+.body([] {
+    parallel::BoundedQueue<int> q(4);
+    for (int i = 0; i < 4; ++i) assert(q.tryEnqueue(i));
+    assert(! q.tryEnqueue(4));
+    assert(q.dequeue() == 0);
+    assert(q.tryEnqueue(4));
+    for (int i = 1; i <= 4; ++i) assert(q.tryDequeue(-1) == i);
+    assert(q.tryDequeue(-1) == -1);
+});
+
+unit("parallel::bounded-queue", "wrap-around")
+.body([] {
+    parallel::BoundedQueue<int> q(8);
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        q << i << i + 1;
+        int x, y;
+        q >> x >> y;
+        assert(x == i && y == i + 1);
+    }
+});
+
+unit("parallel::bounded-queue", "non-trivial-elements")
+.dependsOn({ "list" })
+.body([] {
+    List<int> l = { 1, 2, 3 };
+    {
+        parallel::BoundedQueue<List<int>> q(4);
+        q.enqueue(l);
+        q.enqueue(l);
+        assert(q.dequeue().size() == 3);
+        // the remaining element is destroyed with the queue
+    }
+    assert(l.size() == 3);
+});
+
+unit("parallel::bounded-queue", "dequeueOrTimeout")
+.body([] {
+    parallel::BoundedQueue<int> q(4);
+    bool timedOut = false;
+    try {
+        q.dequeueOrTimeout(1000000);
+    }
+    catch (TimeoutError &) {
+        timedOut = true;
+    }
+    assert(timedOut);
+
+    q.enqueue(1);
+    assert(q.dequeueOrTimeout(1000000) == 1);
+});
+
+unit("parallel::bounded-queue", "tryDequeueFor")
+.body([] {
+    parallel::BoundedQueue<int> q(4);
+    int x = -1;
+    assert(! q.tryDequeueFor(x, 1000000));
+
+    q.enqueue(1);
+    assert(q.tryDequeueFor(x, 1000000) && x == 1);
+});
+
+unit("parallel::bounded-queue", "blocking-enqueue")
+.dependsOn({ "thread" })
+.body([] {
+    parallel::BoundedQueue<int> q(2);
+    Thread producer([&q] {
+        for (int i = 0; i < TEST_SIZE; ++i) q.enqueue(i);
+    });
+    for (int i = 0; i < TEST_SIZE; ++i) assert(q.dequeue() == i);
+    producer.join();
+});
+
+static void producer_consumer(int numProducers, int numConsumers) {
+    parallel::BoundedQueue<long> q(1024);
+    std::atomic_long sum(0);
+    std::atomic_long count(0);
+
+    List<Thread> producers;
+    for (int i = 0; i < numProducers; ++i) {
+        producers.insert(Thread([&q, i, numProducers] {
+            long start = PARALLEL_TEST_SIZE / numProducers * i;
+            long end = (i == numProducers - 1)
+                ? PARALLEL_TEST_SIZE
+                : PARALLEL_TEST_SIZE / numProducers * (i + 1);
+
+            for (long j = start; j < end; ++j) {
+                q.enqueue(j);
+            }
+        }));
+    }
+
+    volatile bool running = true;
+
+    List<Thread> consumers;
+    for (int i = 0; i < numConsumers; ++i) {
+        consumers.insert(Thread([&q, &sum, &count, &running] {
+            while (running || q.nonEmpty()) {
+                try {
+                    sum += q.dequeueOrTimeout(1000000);
+                    ++count;
+                }
+                catch (TimeoutError &) { }
+            }
+        }));
+    }
+
+    producers.foreach([] (Thread &t) { t.join(); });
+    running = false;
+    consumers.foreach([] (Thread &t) { t.join(); });
+
+    assert(q.size() == 0);
+    assert(count == PARALLEL_TEST_SIZE);
+    assert(sum == (long) PARALLEL_TEST_SIZE * (PARALLEL_TEST_SIZE - 1) / 2);
+}
+
+unit("parallel::bounded-queue", "producer-consumer(1-1)")
+.dependsOn({ "list", "thread" })
+.body([] {
+    producer_consumer(1, 1);
+});
+
+unit("parallel::bounded-queue", "producer-consumer(2-2)")
+.dependsOn({ "list", "thread" })
+.body([] {
+    producer_consumer(2, 2);
+});
+
+unit("parallel::bounded-queue", "producer-consumer(4-2)")
+.dependsOn({ "list", "thread" })
+.body([] {
+    producer_consumer(4, 2);
+});
+
+unit("parallel::bounded-queue", "producer-consumer(4-4)")
+.dependsOn({ "list", "thread" })
+.body([] {
+    producer_consumer(4, 4);
+});
+
+perf("parallel::bounded-queue", "producer-consumer(4-4)")
+.body([] {
+    producer_consumer(4, 4);
+})
+.baseline([] {
+    parallel::Deque<long> q;
+    List<Thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.insert(Thread([&q] {
+            for (long j = 0; j < PARALLEL_TEST_SIZE / 4; ++j) q.enqueue(j);
+        }));
+        threads.insert(Thread([&q] {
+            for (long j = 0; j < PARALLEL_TEST_SIZE / 4; ++j) q.dequeue();
+        }));
+    }
+    threads.foreach([] (Thread &t) { t.join(); });
+});
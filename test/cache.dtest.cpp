@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <cache.h>
+#include <hash_map.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+module("cache")
+.dependsOn({
+    "parallel::hash-map"
+});
+
+using namespace spl;
+
+#define NUM_THREADS (8)
+#define TEST_SIZE (100000)
+#define PERFORMANCE_ITERATIONS (1000000)
+
+template <typename F>
+static void runThreads(F f) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) threads.emplace_back(f, t);
+    for (auto &t : threads) t.join();
+}
+
+struct StringWeigher {
+    size_t operator()(int, const std::string &v) const {
+        return v.size();
+    }
+};
+
+unit("cache", "put-get")
+.body([] {
+    Cache<int, long> c(TEST_SIZE);
+    assert(c.empty());
+
+    for (int i = 0; i < 1000; ++i) c.put(i, -i);
+    c.put(7, 8);
+
+    assert(c.size() == 1000);
+    assert(c.weight() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+        assert(c.get(i) == (i == 7 ? 8 : -i));
+    }
+    assert(c.hits() == 1000);
+
+    assert(! c.contains(-1));
+    assert(c.getOr(-1, 5) == 5);
+    long v;
+    assert(! c.tryGet(-1, v));
+    assert(c.misses() == 2);
+
+    bool thrown = false;
+    try {
+        c.get(-1);
+    }
+    catch (const ElementNotFoundError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    assert(c.erase(0));
+    assert(! c.erase(0));
+    assert(c.size() == 999);
+
+    assert(c.getOrLoad(0, [] (int k) { return 42l; }) == 42);
+    assert(c.getOrLoad(0, [] (int k) { return 43l; }) == 42);
+
+    c.clear();
+    assert(c.empty() && c.weight() == 0);
+    assert(c.evictions() == 0);
+});
+
+unit("cache", "eviction")
+.body([] {
+    Cache<int, int> c(1024);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        c.put(i, i);
+        assert(c.weight() <= c.capacity() + c.shards());
+    }
+    assert(c.evictions() == TEST_SIZE - c.size());
+
+    // the most recent insertions are still there
+    assert(c.contains(TEST_SIZE - 1));
+});
+
+unit("cache", "recency")
+.body([] {
+    Cache<int, int> c(256, 1);
+
+    for (int i = 0; i < 256; ++i) c.put(i, i);
+
+    // a scan of new keys does not flush keys that keep being hit
+    for (int i = 256; i < 10 * 256; ++i) {
+        for (int k = 0; k < 16; ++k) assert(c.get(k) == k);
+        c.put(i, i);
+    }
+    for (int k = 0; k < 16; ++k) assert(c.contains(k));
+    assert(! c.contains(100));
+});
+
+unit("cache", "weighted")
+.body([] {
+    Cache<int, std::string, Hash<int>, std::equal_to<int>, StringWeigher> c(1000, 1);
+
+    for (int i = 0; i < 100; ++i) {
+        c.put(i, std::string(i % 20, 'x'));
+    }
+    assert(c.weight() <= 1000);
+    assert(c.get(99) == std::string(19, 'x'));
+
+    // heavier than the whole cache
+    c.put(1000, std::string(2000, 'y'));
+    assert(! c.contains(1000));
+    assert(c.weight() <= 1000);
+});
+
+unit("cache", "concurrent")
+.body([] {
+    Cache<int, long> c(TEST_SIZE / 4);
+
+    runThreads([&c] (int t) {
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            int k = (i * 7 + t) % TEST_SIZE;
+            long v;
+            if (c.tryGet(k, v)) {
+                assert(v == 3l * k);
+            }
+            else {
+                c.put(k, 3l * k);
+            }
+            if (i % 1000 == 0) c.erase(k + 1);
+        }
+    });
+
+    assert(c.hits() + c.misses() == (size_t) NUM_THREADS * TEST_SIZE);
+    assert(c.size() <= c.capacity() + c.shards());
+});
+
+perf("cache", "get")
+.body([] {
+    // room to spare, since shards fill unevenly
+    Cache<int, long> c(2 * TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) c.put(i, i);
+
+    runThreads([&c] (int t) {
+        for (int i = 0; i < PERFORMANCE_ITERATIONS / NUM_THREADS; ++i) {
+            c.get((i * 31 + t) % TEST_SIZE);
+        }
+    });
+})
+.baseline([] {
+    HashMap<int, long> m;
+    std::mutex mtx;
+    for (int i = 0; i < TEST_SIZE; ++i) m.put(i, i);
+
+    runThreads([&] (int t) {
+        for (int i = 0; i < PERFORMANCE_ITERATIONS / NUM_THREADS; ++i) {
+            std::lock_guard<std::mutex> lock(mtx);
+            m.get((i * 31 + t) % TEST_SIZE);
+        }
+    });
+});
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <compressed_serialization.h>
+#include <list.h>
+#include <hash_map.h>
+#include "test_serializers.cpp"
+
+module("compressed-serializer")
+.dependsOn({
+    "lz4",
+    "stream-serializer",
+    "thread"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (16 * 1024)
+
+unit("compressed-serializer", "primitive-types")
+.body([] {
+    MemoryOutputStreamSerializer sink;
+    {
+        OutputCompressedSerializer out(sink);
+        out << 1 << 2l << (short) 3;
+        out.sync();
+    }
+
+    auto &source = *sink.toInput();
+    InputCompressedSerializer in(source);
+
+    int x;
+    long y;
+    short z;
+    in >> x >> y >> z;
+    assert(x == 1);
+    assert(y == 2);
+    assert(z == 3);
+
+    delete &source;
+});
+
+unit("compressed-serializer", "large-serialization")
+.body([] {
+    for (int pipelined = 0; pipelined < 2; ++pipelined) {
+        MemoryOutputStreamSerializer sink;
+        {
+            OutputCompressedSerializer out(sink, 4096, pipelined);
+            for (int i = 0; i < TEST_SIZE; ++i) {
+                out << i / 16;
+            }
+            out.sync();
+            assert(sink.totalByteCount() < TEST_SIZE * sizeof(int) / 4);
+        }
+
+        auto &source = *sink.toInput();
+        InputCompressedSerializer in(source);
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            int x;
+            in >> x;
+            assert(x == i / 16);
+        }
+
+        try {
+            int x;
+            in >> x;
+            delete &source;
+            fail("got data beyond the end of the stream");
+        }
+        catch (const OutOfRangeError &) { }
+
+        delete &source;
+    }
+});
+
+unit("compressed-serializer", "bulk-serialization")
+.body([] {
+    int *a = new int[TEST_SIZE];
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        a[i] = dtest_random() * TEST_SIZE;
+    }
+
+    MemoryOutputStreamSerializer sink;
+    {
+        OutputCompressedSerializer out(sink, 4096);
+        out.put(a, TEST_SIZE * sizeof(int));
+        out << -1;
+        out.flush();
+    }
+    sink.flush();
+
+    auto &source = *sink.toInput();
+    InputCompressedSerializer in(source);
+
+    int *b = new int[TEST_SIZE];
+    in.get(b, TEST_SIZE * sizeof(int));
+    assert(memcmp(a, b, TEST_SIZE * sizeof(int)) == 0);
+
+    int x;
+    in >> x;
+    assert(x == -1);
+
+    delete &source;
+    delete[] a;
+    delete[] b;
+});
+
+unit("compressed-serializer", "containers")
+.dependsOn({ "list", "hash-map" })
+.body([] {
+    List<int> l;
+    HashMap<int, int> m;
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l << i;
+        m.put(i, i % 7);
+    }
+
+    MemoryOutputStreamSerializer sink;
+    {
+        OutputCompressedSerializer out(sink);
+        out << l << m;
+        out.sync();
+    }
+
+    auto &source = *sink.toInput();
+    InputCompressedSerializer in(source);
+
+    List<int> l2;
+    HashMap<int, int> m2;
+    in >> l2 >> m2;
+
+    assert(l2.size() == l.size());
+    int i = 0;
+    for (auto &x : l2) {
+        assert(x == i++);
+    }
+    assert(m2.size() == m.size());
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(m2[i] == i % 7);
+    }
+
+    delete &source;
+});
@@ -46,6 +46,37 @@ unit("container-serialization", "list<int>")
     }
 });
 
+unit("container-serialization", "list<pod>")
+.dependsOn("list")
+.body([] {
+    struct Point {
+        int x, y, z;
+    };
+
+    auto l = List<Point>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l.append({ i, 2 * i, 3 * i });
+    }
+
+    MemoryOutputStreamSerializer out;
+    out << l;
+    out.flush();
+
+    List<Point> l2;
+    auto &in = *out.toInput();
+    in >> l2;
+    delete &in;
+
+    assert(l2.size() == TEST_SIZE);
+
+    int i = 0;
+    for (auto &p : l2) {
+        assert(p.x == i && p.y == 2 * i && p.z == 3 * i);
+        ++i;
+    }
+});
+
 unit("container-serialization", "list<serializable>")
 .dependsOn("list")
 .body([] {
@@ -167,6 +198,50 @@ unit("container-serialization", "parallel::list<serializable>")
     }
 });
 
+// unrolled-list ///////////////
+
+#include <unrolled_list.h>
+
+unit("container-serialization", "unrolled-list<int>")
+.dependsOn("unrolled-list")
+.body([] {
+    auto l = UnrolledList<int>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l.insert(dtest_random() * TEST_SIZE);
+    }
+
+    MemoryOutputStreamSerializer out;
+    out << l;
+    out.flush();
+
+    UnrolledList<int> l2;
+    auto &in = *out.toInput();
+    in >> l2;
+    delete &in;
+
+    assert(l.size() == l2.size());
+
+    for (auto it1 = l.begin(), it2 = l2.begin(); it1 != l.end(); ++it1, ++it2) {
+        assert(*it1 == *it2);
+    }
+});
+
+unit("container-serialization", "unrolled-list<non-serializable>")
+.dependsOn("unrolled-list")
+.expect(Status::FAIL)
+.body([] {
+    auto l = UnrolledList<StreamSerializable_NotCopyAssignable>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l.insert(StreamSerializable_NotCopyAssignable());
+    }
+
+    MemoryOutputStreamSerializer out;
+    out << l;
+    err("Object should not be serialized");
+});
+
 // deque ///////////////////////
 
 #include <deque.h>
@@ -319,6 +394,8 @@ unit("container-serialization", "parallel::deque<serializable>")
 // hash-map ////////////////////
 
 #include <hash_map.h>
+#include <file.h>
+#include <std_serialization.h>
 #include "test_hashable.cpp"
 
 unit("container-serialization", "hashmap<int,int>")
@@ -347,6 +424,34 @@ unit("container-serialization", "hashmap<int,int>")
     }
 });
 
+unit("container-serialization", "hashmap<string,list<int>>")
+.dependsOn("hash-map")
+.body([] {
+    HashMap<std::string, List<int>> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        auto &l = m["key-" + std::to_string(i)];
+        for (int j = 0; j <= i % 8; ++j) l.append(i * j);
+    }
+
+    MemoryOutputStreamSerializer out;
+    out << m;
+    out.flush();
+
+    HashMap<std::string, List<int>> m2;
+    auto &in = *out.toInput();
+    in >> m2;
+    delete &in;
+
+    assert(m.size() == m2.size());
+
+    for (auto &n : m) {
+        assert(m2.contains(n.k));
+        assert(m2.get(n.k).size() == n.v.size());
+        assert(m2.get(n.k).back() == n.v.back());
+    }
+});
+
 unit("container-serialization", "hashmap<int,serializable>")
 .dependsOn("hash-map")
 .body([] {
@@ -498,6 +603,84 @@ unit("container-serialization", "parallel::hashmap<hashableserializable,serializ
     }
 });
 
+unit("container-serialization", "hashmap<int,int>-chunked")
+.dependsOn("hash-map")
+.body([] {
+    // spans several chunks
+    auto m = HashMap<int, int>();
+    for (int i = 0; i < 256 * TEST_SIZE; ++i) {
+        m.put(i, -i);
+    }
+
+    for (auto level : { SerializationLevel::PLAIN, SerializationLevel::COMPACTED }) {
+        File f("./test-chunked-file");
+        f.open(File::READ_WRITE | File::CREATE);
+        f.close();
+
+        OutputFileSerializer out(f);
+        out.setLevel(level).setIntegerEncoding(IntegerEncoding::VARINT);
+        out << 7;
+        m.parallelWriteObject(out, 4);
+        out << 8;
+        out.flush();
+
+        // any number of threads reads it back
+        for (size_t threads : { 1, 3 }) {
+            InputFileSerializer in(f);
+            in.setLevel(level).setIntegerEncoding(IntegerEncoding::VARINT);
+
+            HashMap<int, int> m2;
+            m2.put(-1, 1);
+            int x;
+            in >> x;
+            assert(x == 7);
+            m2.parallelReadObject(in, threads);
+            in >> x;
+            assert(x == 8);
+
+            assert(m2.size() == m.size());
+            assert(! m2.contains(-1));
+            for (auto &n : m) {
+                assert(m2.get(n.k) == n.v);
+            }
+        }
+
+        remove("./test-chunked-file");
+    }
+});
+
+unit("container-serialization", "parallel::hashmap<hashableserializable,serializable>-chunked")
+.dependsOn("parallel::hash-map")
+.body([] {
+    auto m = parallel::HashMap<HashableSerializableObj, StreamSerializable>();
+
+    #pragma omp parallel for
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, StreamSerializable());
+    }
+
+    MemoryOutputRandomAccessSerializer out;
+    m.parallelWriteObject(out);
+    out.flush();
+
+    for (auto &x : m) {
+        assert(x.k.serialized);
+        assert(x.v.serialized());
+    }
+
+    parallel::HashMap<HashableSerializableObj, StreamSerializable> m2;
+    auto &in = *out.toInput();
+    m2.parallelReadObject(in);
+    delete &in;
+
+    assert(m.size() == m2.size());
+
+    for (auto &n : m) {
+        assert(m2.contains(n.k));
+        assert(m2.get(n.k).deserialized());
+    }
+});
+
 unit("container-serialization", "hashmultimap<int,int>")
 .dependsOn("hash-multimap")
 .body([] {
@@ -585,6 +768,32 @@ unit("container-serialization", "hashmultimap<hashableserializable,serializable>
     }
 });
 
+unit("container-serialization", "grouped-hashmultimap<int,int>")
+.dependsOn("hash-multimap")
+.body([] {
+    auto m = GroupedHashMultiMap<int, int>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i % 10, dtest_random() * TEST_SIZE);
+    }
+
+    MemoryOutputStreamSerializer out;
+    out << m;
+    out.flush();
+
+    GroupedHashMultiMap<int, int> m2;
+    auto &in = *out.toInput();
+    in >> m2;
+    delete &in;
+
+    assert(m.size() == m2.size());
+    assert(m.keyCount() == m2.keyCount());
+
+    for (auto &n : m) {
+        assert(*m2.values(n.k) == n.v);
+    }
+});
+
 unit("container-serialization", "parallel::hashmultimap<int,int>")
 .dependsOn("parallel::hash-multimap")
 .body([] {
@@ -734,6 +943,32 @@ unit("container-serialization", "hashset<hashableserializable>")
     }
 });
 
+unit("container-serialization", "grouped-hashmultiset<int>")
+.dependsOn("hash-multiset")
+.body([] {
+    auto s = GroupedHashMultiSet<int>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        s.put(i % 10);
+    }
+
+    MemoryOutputStreamSerializer out;
+    out << s;
+    out.flush();
+
+    GroupedHashMultiSet<int> s2;
+    auto &in = *out.toInput();
+    in >> s2;
+    delete &in;
+
+    assert(s.size() == s2.size());
+    assert(s.keyCount() == s2.keyCount());
+
+    for (auto &n : s) {
+        assert(s2.count(n.k) == n.v);
+    }
+});
+
 unit("container-serialization", "parallel::hashset<int>")
 .dependsOn("parallel::hash-set")
 .body([] {
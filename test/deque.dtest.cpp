@@ -9,6 +9,8 @@
 #include <forward_list>
 #include <thread.h>
 #include <list.h>
+#include <vector>
+#include <atomic>
 
 module("deque")
 .dependsOn({
@@ -508,6 +510,75 @@ unit("deque", "reduce")
     assert(sum2 == sum);
 });
 
+unit("deque", "enqueueAll-dequeueUpTo")
+.body([] {
+    auto q = Deque<int>({ 0 });
+    auto l = List<int>();
+
+    for (int i = 1; i < TEST_SIZE; ++i) {
+        l << i;
+    }
+
+    q.enqueueAll(l.begin(), l.end());
+    assert(q.size() == TEST_SIZE);
+    assert(DequeTester<Deque<int>>::validTail(q));
+
+    int out[TEST_SIZE];
+    assert(q.dequeueUpTo(out, TEST_SIZE / 2) == TEST_SIZE / 2);
+    assert(q.size() == TEST_SIZE / 2);
+    assert(q.dequeueUpTo(out + TEST_SIZE / 2, TEST_SIZE) == TEST_SIZE / 2);
+    assert(q.empty());
+    assert(q.begin() == q.end());
+    assert(q.dequeueUpTo(out, TEST_SIZE) == 0);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(out[i] == i);
+    }
+
+    q.enqueueAll(l.begin(), l.begin());
+    assert(q.empty());
+    q.enqueueAll(l.begin(), l.end());
+    q << -1;
+    assert(q.size() == TEST_SIZE);
+    assert(q.back() == -1);
+});
+
+unit("parallel::deque", "enqueueAll-dequeueUpTo")
+.body([] {
+    auto q = parallel::Deque<int>();
+    std::vector<int> batch;
+
+    for (int i = 0; i < 256; ++i) {
+        batch.push_back(i);
+    }
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE / 256; ++i) {
+        q.enqueueAll(batch.begin(), batch.end());
+    }
+
+    assert(q.size() == PARALLEL_TEST_SIZE / 256 * 256);
+    assert(parallel::DequeTester<parallel::Deque<int>>::validTail(q));
+
+    std::atomic_long sum(0);
+    std::atomic_size_t count(0);
+
+    #pragma omp parallel
+    {
+        std::vector<int> out;
+        size_t n;
+        while ((n = q.dequeueUpTo(std::back_inserter(out), 100)) > 0) {
+            count += n;
+        }
+        for (auto x : out) sum += x;
+    }
+
+    assert(q.empty());
+    assert(q.begin() == q.end());
+    assert(count == PARALLEL_TEST_SIZE / 256 * 256);
+    assert(sum == PARALLEL_TEST_SIZE / 256 * (255 * 256 / 2));
+});
+
 static void producer_consumer(int numProducers, int numConsumers) {
     parallel::Deque<long> q;
     parallel::List<long> values;
@@ -551,6 +622,25 @@ static void producer_consumer(int numProducers, int numConsumers) {
     assert(sum == (PARALLEL_TEST_SIZE * (PARALLEL_TEST_SIZE - 1) / 2));
 }
 
+unit("parallel::deque", "tryDequeueFor")
+.body([] {
+    parallel::Deque<int> d;
+    int x = -1;
+    assert(! d.tryDequeueFor(x, 1000000) && x == -1);
+
+    d.enqueue(1);
+    assert(d.tryDequeueFor(x, 1000000) && x == 1);
+
+    bool timedOut = false;
+    try {
+        d.dequeueOrTimeout(1000000);
+    }
+    catch (TimeoutError &) {
+        timedOut = true;
+    }
+    assert(timedOut);
+});
+
 unit("parallel::deque", "producer-consumer(1-1)")
 .dependsOn({ "parallel::list", "list", "thread" })
 .body([] {
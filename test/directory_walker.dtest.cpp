@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <directory_walker.h>
+#include <atomic>
+
+module("directory-walker")
+.dependsOn({
+    "exception",
+    "file",
+    "thread-pool"
+});
+
+using namespace spl;
+
+#define FANOUT (8)
+#define FILES_PER_DIR (16)
+
+// tree of FANOUT directories with FANOUT subdirectories each, every directory
+// holding FILES_PER_DIR files; returns the number of entries below root
+static size_t makeTree(const char *root) {
+    size_t count = 0;
+    for (int i = 0; i < FANOUT; ++i) {
+        for (int j = 0; j < FANOUT; ++j) {
+            Path dir = Path(root).append(std::to_string(i).c_str(), std::to_string(j).c_str());
+            File::mkdirs(dir);
+            ++count;
+            for (int k = 0; k < FILES_PER_DIR; ++k) {
+                File(dir.append(std::to_string(k).c_str())).open(File::READ_WRITE | File::CREATE);
+                ++count;
+            }
+        }
+        ++count;
+    }
+    if (symlink(".", Path(root).append("link").get()) != 0) throw ErrnoRuntimeError();
+    ++count;
+    return count;
+}
+
+unit("directory-walker", "walk")
+.body([] {
+    size_t expected = makeTree("./test-walk");
+
+    for (size_t threads = 0; threads <= 4; threads += 4) {
+        DirectoryWalker w(threads);
+        assert(w.threads() == threads);
+
+        std::atomic<size_t> entries(0), dirs(0), files(0);
+        w.walk("./test-walk", [&] (const PathInfo &info) {
+            ++entries;
+            if (info.isDir()) ++dirs;
+            else if (info.isFile()) ++files;
+            return true;
+        });
+
+        assert(entries == expected);
+        // the link points to a directory, but is not descended into
+        assert(dirs == FANOUT * FANOUT + FANOUT + 1);
+        assert(files == FANOUT * FANOUT * FILES_PER_DIR);
+    }
+
+    File::rmdirs("./test-walk");
+});
+
+unit("directory-walker", "walk-prune")
+.body([] {
+    makeTree("./test-walk");
+
+    DirectoryWalker w(4);
+    std::atomic<size_t> entries(0);
+    w.walk("./test-walk", [&] (const PathInfo &info) {
+        ++entries;
+        // only descend into the first top-level directory
+        return info.path() == Path("./test-walk/0") || info.path().parent() == Path("./test-walk/0");
+    });
+
+    assert(entries == FANOUT + 1 + FANOUT + FANOUT * FILES_PER_DIR);
+
+    File::rmdirs("./test-walk");
+});
+
+unit("directory-walker", "remove")
+.body([] {
+    for (size_t threads = 0; threads <= 4; threads += 4) {
+        makeTree("./test-walk");
+
+        DirectoryWalker w(threads);
+        w.remove("./test-walk/0/0/0");
+        assert(access("./test-walk/0/0/0", F_OK) != 0);
+        assert(access("./test-walk/0/0/1", F_OK) == 0);
+
+        w.remove("./test-walk");
+        assert(access("./test-walk", F_OK) != 0);
+    }
+});
+
+unit("directory-walker", "visitor-error")
+.expect(Status::FAIL)
+.body([] {
+    makeTree("./test-walk");
+
+    DirectoryWalker w(4);
+    try {
+        w.walk("./test-walk", [] (const PathInfo &info) -> bool {
+            if (info.isFile()) throw Error("Visitor error");
+            return true;
+        });
+    }
+    catch (...) {
+        File::rmdirs("./test-walk");
+        throw;
+    }
+});
+
+unit("directory-walker", "walk-missing")
+.expect(Status::FAIL)
+.body([] {
+    DirectoryWalker(4).walk("./test-walk-missing", [] (const PathInfo &) { return true; });
+});
@@ -180,3 +180,49 @@ unit("exception", "FunctionUnsupportedError-4")
         fail("Unknown object thrown");
     }
 });
+
+unit("exception", "callstack-capture")
+.body([] {
+    auto saved = CallStack::capture();
+
+    CallStack::setCapture(CallStack::Capture::FULL);
+    assert(! CallStack::trace().empty());
+    assert(std::string(RuntimeError("msg").what()).find("Callstack:") != std::string::npos);
+
+    CallStack::setCapture(CallStack::Capture::NONE);
+    assert(CallStack::trace().empty());
+    assert(std::string(RuntimeError("msg").what()).find("Callstack:") == std::string::npos);
+
+    CallStack::setCapture(CallStack::Capture::SAMPLED, 4);
+    size_t captured = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (! CallStack::trace().empty()) ++captured;
+    }
+    assert(captured == 16);
+
+    CallStack::setCapture(saved);
+});
+
+perf("exception", "throw-RuntimeError")
+.body([] {
+    auto saved = CallStack::capture();
+    CallStack::setCapture(CallStack::Capture::NONE);
+    for (int i = 0; i < 10000; ++i) {
+        try {
+            throw RuntimeError("msg");
+        }
+        catch (const TraceableError &) { }
+    }
+    CallStack::setCapture(saved);
+})
+.baseline([] {
+    auto saved = CallStack::capture();
+    CallStack::setCapture(CallStack::Capture::FULL);
+    for (int i = 0; i < 10000; ++i) {
+        try {
+            throw RuntimeError("msg");
+        }
+        catch (const TraceableError &) { }
+    }
+    CallStack::setCapture(saved);
+});
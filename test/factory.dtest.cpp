@@ -5,10 +5,11 @@
 
 #include <dtest.h>
 #include <factory.h>
+#include <exception.h>
 
 module("factory")
 .dependsOn({
-    "hash-map"
+    "exception"
 });
 
 using namespace spl;
@@ -156,3 +157,98 @@ unit("factory", "multiple-factory")
 
     assert(intFactoryCalled);
 });
+
+unit("factory", "function-pointer")
+.ignoreMemoryLeak()         // registerFactory() allocates memory
+.body([] {
+    struct A {
+        int x;
+
+        static void * create() {
+            auto a = new A();
+            a->x = 7;
+            return a;
+        }
+
+        static void * createWith(int x) {
+            auto a = new A();
+            a->x = x;
+            return a;
+        }
+    };
+
+    Factory::registerFactory(typeid(A), &A::create);
+    Factory::registerFactory(typeid(A), &A::createWith);
+
+    auto a = Factory::createObject<A>();
+    assert(a->x == 7);
+    delete a;
+
+    a = Factory::createObject<A>(typeid(A), 9);
+    assert(a->x == 9);
+    delete a;
+
+    bool thrown = false;
+    try {
+        Factory::registerFactory(typeid(A), &A::create);
+    }
+    catch (const TraceableError &) {
+        thrown = true;
+    }
+    assert(thrown);
+});
+
+unit("factory", "cache")
+.ignoreMemoryLeak()         // registerFactory() allocates memory
+.body([] {
+    struct A {
+        virtual ~A() = default;
+        virtual char f() {
+            return 'A';
+        }
+    };
+
+    struct B : A {
+        char f() {
+            return 'B';
+        }
+    };
+
+    Factory::registerFactory(typeid(A), [] { return new A(); });
+    Factory::registerFactory(typeid(B), [] { return new B(); });
+
+    core::FactoryCache cache;
+    for (int i = 0; i < 16; ++i) {
+        A *a = cache.createObject<A>(i % 2 ? typeid(A).hash_code() : typeid(B).hash_code());
+        assert(a->f() == (i % 2 ? 'A' : 'B'));
+        delete a;
+    }
+
+    bool thrown = false;
+    try {
+        cache.createObject<A>(typeid(int).hash_code());
+    }
+    catch (const InvalidArgument &) {
+        thrown = true;
+    }
+    assert(thrown);
+});
+
+perf("factory", "createObject")
+.body([] {
+    struct A : WithFactory<A> {
+        int x = 0;
+    };
+
+    A x;
+    core::FactoryCache cache;
+    size_t code = typeid(A).hash_code();
+    for (int i = 0; i < 1000000; ++i) delete cache.createObject<A>(code);
+})
+.baseline([] {
+    struct A {
+        int x = 0;
+    };
+
+    for (int i = 0; i < 1000000; ++i) delete new A();
+});
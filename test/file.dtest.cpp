@@ -61,6 +61,65 @@ unit("path", "append")
     assert(strcmp(Path("/abc/def/").append("ghi/", "jkl").get(), "/abc/def/ghi/jkl") == 0);
 });
 
+unit("path", "push-pop")
+.body([] {
+    Path p("/abc");
+    p.push("def").push("ghi/", "jkl");
+    assert(strcmp(p.get(), "/abc/def/ghi/jkl") == 0);
+    assert(p.length() == strlen("/abc/def/ghi/jkl"));
+
+    p.pop();
+    assert(strcmp(p.get(), "/abc/def/ghi") == 0);
+    p.pop().pop().pop();
+    assert(strcmp(p.get(), "/") == 0);
+
+    Path q("abc");
+    assert(strcmp(q.pop().get(), ".") == 0);
+});
+
+unit("path", "long")
+.body([] {
+    std::string s;
+    Path p("/");
+    for (int i = 0; i < 100; ++i) {
+        p.push("component");
+        s += "/component";
+        assert(p.get() == s);
+    }
+    assert(p.length() > Path::INLINE_CAPACITY);
+
+    Path copy(p);
+    assert(copy == p);
+    Path moved(std::move(copy));
+    assert(moved == p);
+    assert(copy.get() == nullptr);
+
+    Path shorter("/a");
+    moved = shorter;
+    assert(strcmp(moved.get(), "/a") == 0);
+    moved = std::move(p);
+    assert(moved.get() == s);
+
+    for (int i = 0; i < 100; ++i) moved.pop();
+    assert(strcmp(moved.get(), "/") == 0);
+});
+
+unit("path", "view")
+.body([] {
+    Path p("/abc/def/");
+    PathView v = p.view();
+    assert(v.length() == p.length());
+    assert(v.parent() == PathView("/abc"));
+    assert(v.base() == PathView("def"));
+    assert(v.parent().parent() == PathView("/"));
+    assert(v.parent().parent().parent() == PathView("/"));
+    assert(PathView("abc").parent() == PathView("."));
+    assert(PathView("/").base() == PathView("/"));
+    assert(PathView("").base() == PathView("."));
+    assert(Path(v.parent()) == Path("/abc"));
+    assert(v.base().str() == "def");
+});
+
 unit("file", "uniquePath")
 .body([] {
     auto p = File::uniquePath(".");
@@ -367,6 +426,97 @@ unit("file", "map-sync")
     remove("./test-file");
 });
 
+unit("file", "map-hints")
+.body([] {
+    File f("./test-file");
+
+    f.open(File::READ_WRITE | File::CREATE);
+
+    int *a = new int[TEST_SIZE];
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        a[i] = dtest_random() * i;
+    }
+
+    f.write(a, sizeof(int) * TEST_SIZE);
+    f.close();
+
+    {
+        auto m = f.map(false, true);
+        f.close();
+        assert(! m.writeable());
+        m.advise(MemoryMapping::RANDOM)
+            .advise(MemoryMapping::WILL_NEED, 100, 1000)
+            .advise(MemoryMapping::SEQUENTIAL, sizeof(int) * TEST_SIZE - 1)
+            .prefault()
+            .lock(10, 100)
+            .unlock(10, 100);
+        assert(memcmp(a, m.ptr(), sizeof(int) * TEST_SIZE) == 0);
+    }
+
+    {
+        auto m = f.map(true);
+        f.close();
+        assert(m.writeable());
+        m.prefault(sizeof(int));
+        assert(memcmp(a, m.ptr(), sizeof(int) * TEST_SIZE) == 0);
+    }
+
+    delete[] a;
+
+    remove("./test-file");
+});
+
+unit("file", "map-hints-out-of-range")
+.expect(Status::FAIL)
+.body([] {
+    File f("./test-file");
+
+    f.open(File::READ_WRITE | File::CREATE);
+    f.allocate(0, 4096);
+    f.close();
+
+    auto m = f.map();
+    f.close();
+    remove("./test-file");
+
+    m.advise(MemoryMapping::WILL_NEED, 4097);
+});
+
+unit("file", "map-resize")
+.body([] {
+    File f("./test-file");
+
+    f.open(File::READ_WRITE | File::CREATE);
+    f.allocate(0, sizeof(int) * TEST_SIZE);
+
+    auto m = f.map();
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        ((int *) m.ptr())[i] = i;
+    }
+
+    f.allocate(0, sizeof(int) * 4 * TEST_SIZE);
+    m.resize(sizeof(int) * 4 * TEST_SIZE);
+    assert(m.size() == sizeof(int) * 4 * TEST_SIZE);
+    for (int i = TEST_SIZE; i < 4 * TEST_SIZE; ++i) {
+        ((int *) m.ptr())[i] = i;
+    }
+    for (int i = 0; i < 4 * TEST_SIZE; ++i) {
+        assert(((int *) m.ptr())[i] == i);
+    }
+
+    m.resize(sizeof(int) * TEST_SIZE);
+    assert(m.size() == sizeof(int) * TEST_SIZE);
+    m.sync(true);
+    f.close();
+
+    int x;
+    f.read(sizeof(int) * 3 * TEST_SIZE, &x, sizeof(int));
+    assert(x == 3 * TEST_SIZE);
+    f.close();
+
+    remove("./test-file");
+});
+
 unit("file", "lock")
 .body([] {
     File f("./test-file");
@@ -515,3 +665,253 @@ unit("file-serializer", "bulk-serialization")
 
     remove("./test-file");
 });
+
+unit("file-serializer", "readahead")
+.body([] {
+    File f("./test-file");
+
+    f.open(File::READ_WRITE | File::CREATE);
+    f.close();
+
+    OutputFileSerializer out(f);
+    for (auto i = 0; i < 16 * TEST_SIZE; ++i) {
+        out << i;
+    }
+    out.flush();
+
+    {
+        InputFileSerializer in(f, 4096, true);
+        for (auto i = 0; i < 16 * TEST_SIZE; ++i) {
+            int x;
+            in >> x;
+            assert(x == i);
+        }
+        assert(in.remaining() == 0);
+    }
+
+    {
+        // seeking discards the prefetched block
+        InputFileSerializer in(f, 4096, true);
+        int x;
+        in >> x;
+        in.seekTo(sizeof(int) * 8 * TEST_SIZE);
+        in >> x;
+        assert(x == 8 * TEST_SIZE);
+
+        int *a = new int[2 * TEST_SIZE];
+        in.get(a, sizeof(int) * 2 * TEST_SIZE);
+        for (int i = 0; i < 2 * TEST_SIZE; ++i) {
+            assert(a[i] == 8 * TEST_SIZE + 1 + i);
+        }
+        delete[] a;
+
+        in.seekTo(0);
+        in >> x;
+        assert(x == 0);
+    }
+
+    remove("./test-file");
+});
+
+unit("file-serializer", "direct")
+.body([] {
+    File f("./test-file");
+
+    f.open(File::READ_WRITE | File::CREATE);
+    f.close();
+
+    {
+        // 1000 is not a multiple of the block size
+        OutputFileSerializer out(f, SIZE_MAX, 1000, true);
+        assert(out.direct());
+        for (auto i = 0; i < 16 * TEST_SIZE; ++i) {
+            out << i;
+            // unaligned partial flushes
+            if (i % 1000 == 0) out.flush();
+        }
+        int *a = new int[3 * TEST_SIZE + 1];
+        for (int i = 0; i < 3 * TEST_SIZE + 1; ++i) a[i] = 16 * TEST_SIZE + i;
+        out.put(a, sizeof(int) * (3 * TEST_SIZE + 1));
+        delete[] a;
+        out.flush();
+    }
+    assert(f.info().length() == sizeof(int) * (19 * TEST_SIZE + 1));
+
+    for (int readahead = 0; readahead < 2; ++readahead) {
+        InputFileSerializer in(f, 1000, readahead, true);
+        for (auto i = 0; i < 16 * TEST_SIZE; ++i) {
+            int x;
+            in >> x;
+            assert(x == i);
+        }
+        int *a = new int[3 * TEST_SIZE + 1];
+        in.get(a, sizeof(int) * (3 * TEST_SIZE + 1));
+        for (int i = 0; i < 3 * TEST_SIZE + 1; ++i) {
+            assert(a[i] == 16 * TEST_SIZE + i);
+        }
+        delete[] a;
+        assert(in.remaining() == 0);
+
+        in.seekTo(sizeof(int) * 7);
+        int x;
+        in >> x;
+        assert(x == 7);
+    }
+
+    {
+        // overwriting a region keeps the surrounding data
+        OutputFileSerializer out(f, SIZE_MAX, 4096, true);
+        out.seekTo(sizeof(int) * 5);
+        out << -1 << -2;
+        out.flush();
+    }
+    assert(f.info().length() == sizeof(int) * (19 * TEST_SIZE + 1));
+
+    {
+        InputFileSerializer in(f, 4096, false, true);
+        for (auto i = 0; i < 16 * TEST_SIZE; ++i) {
+            int x;
+            in >> x;
+            assert(x == (i == 5 ? -1 : i == 6 ? -2 : i));
+        }
+    }
+
+    remove("./test-file");
+});
+
+unit("file-serializer", "gather")
+.body([] {
+    File f("./test-file");
+
+    f.open(File::READ_WRITE | File::CREATE);
+    f.close();
+
+    std::vector<std::vector<int>> blobs(8);
+    for (size_t i = 0; i < blobs.size(); ++i) {
+        for (int j = 0; j < TEST_SIZE; ++j) {
+            blobs[i].push_back(dtest_random() * TEST_SIZE);
+        }
+    }
+
+    OutputFileSerializer out(f);
+    out.setGatherThreshold(1024);
+    for (auto &b : blobs) {
+        out << (int) (&b - blobs.data());
+        out.put(b.data(), b.size() * sizeof(int));
+    }
+    assert(out.tell() == blobs.size() * (TEST_SIZE + 1) * sizeof(int));
+    out.flush();
+
+    InputFileSerializer in(f);
+    for (auto &b : blobs) {
+        int x;
+        in >> x;
+        assert(x == &b - blobs.data());
+        std::vector<int> c(TEST_SIZE);
+        in.get(c.data(), c.size() * sizeof(int));
+        assert(c == b);
+    }
+    assert(in.remaining() == 0);
+
+    remove("./test-file");
+});
+
+unit("file-serializer", "mapped-primitive-types")
+.body([] {
+    File f("./test-file");
+    f.open(File::READ_WRITE | File::CREATE);
+
+    int x = 1;
+    long y = 2;
+    short z = 3;
+
+    {
+        OutputMappedSerializer out(f, sizeof(x) + sizeof(y) + sizeof(z));
+        out << x << y << z;
+        out.flush();
+        assert(out.remaining() == 0);
+    }
+    f.close();
+
+    int x1;
+    long y1;
+    short z1;
+
+    InputMappedSerializer in(f);
+    in >> x1 >> y1 >> z1;
+
+    assert(x == x1);
+    assert(y == y1);
+    assert(z == z1);
+    assert(in.remaining() == 0);
+
+    remove("./test-file");
+});
+
+unit("file-serializer", "mapped-view")
+.body([] {
+    File f("./test-file");
+    f.open(File::READ_WRITE | File::CREATE);
+
+    {
+        OutputMappedSerializer out(f, sizeof(size_t) + TEST_SIZE * sizeof(int) + sizeof(int));
+        out << (size_t) TEST_SIZE;
+        int *a = out.reserve<int>(TEST_SIZE);
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            a[i] = i;
+        }
+        out << -1;
+        out.flush();
+    }
+    f.close();
+
+    InputMappedSerializer in(f);
+
+    size_t n;
+    in >> n;
+    assert(n == TEST_SIZE);
+
+    const int *b = in.view<int>(n);
+    assert((const void *) b == (const uint8_t *) in.mapping().ptr() + sizeof(size_t));
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(b[i] == i);
+    }
+
+    int last;
+    in >> last;
+    assert(last == -1);
+    assert(in.remaining() == 0);
+
+    remove("./test-file");
+});
+
+unit("file-serializer", "mapped-view-beyond-end")
+.expect(Status::FAIL)
+.body([] {
+    File f("./test-file");
+    f.open(File::READ_WRITE | File::CREATE);
+
+    {
+        OutputMappedSerializer out(f, 4 * sizeof(int));
+        out << 1 << 2 << 3 << 4;
+        out.flush();
+    }
+    f.close();
+
+    InputMappedSerializer in(f);
+    remove("./test-file");
+
+    in.view<int>(5);
+});
+
+unit("file-serializer", "mapped-write-beyond-end")
+.expect(Status::FAIL)
+.body([] {
+    File f("./test-file");
+    f.open(File::READ_WRITE | File::CREATE);
+    OutputMappedSerializer out(f, sizeof(int));
+    remove("./test-file");
+
+    out << 1 << 2;
+    out.flush();
+});
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <thread_pool.h>
+#include <future.h>
+#include <string>
+#include <vector>
+
+module("future")
+.dependsOn({
+    "thread-pool"
+});
+
+using namespace spl;
+
+#define MANY_TASKS 10000
+
+unit("future", "promise")
+.body([] {
+    Promise<std::string> p;
+    Future<std::string> f = p.future();
+    assert(f.valid() && ! f.ready());
+
+    Thread t([&p] () { p.set("hello"); });
+    assert(f.get() == "hello");
+    assert(f.ready());
+    t.join();
+
+    bool thrown = false;
+    try {
+        p.set("again");
+    }
+    catch (const TraceableError &) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(f.get() == "hello");
+});
+
+unit("future", "exception")
+.body([] {
+    ThreadPool<> pool(2);
+
+    auto f = pool.submit([] (ExecutionContext &) -> int {
+        throw ElementNotFoundError();
+    });
+
+    bool thrown = false;
+    try {
+        f.get();
+    }
+    catch (const ElementNotFoundError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    pool.terminate();
+});
+
+unit("future", "submit")
+.body([] {
+    ThreadPool<> pool(4);
+
+    std::vector<Future<size_t>> results;
+    for (size_t i = 0; i < 100; ++i) {
+        results.push_back(pool.submit([i] (ExecutionContext &) { return i * i; }));
+    }
+    for (size_t i = 0; i < 100; ++i) {
+        assert(results[i].get() == i * i);
+    }
+
+    Future<void> done = pool.submit([] (ExecutionContext &) { });
+    done.get();
+
+    pool.terminate();
+});
+
+unit("future", "get-suspends")
+.body([] {
+    // a single worker would deadlock if waiting blocked the thread
+    ThreadPool<> pool(1);
+
+    auto outer = pool.submit([&pool] (ExecutionContext &ctx) {
+        size_t sum = 0;
+        for (size_t i = 0; i < 100; ++i) {
+            sum += pool.submit([i] (ExecutionContext &) { return i; }).get(ctx);
+        }
+        return sum;
+    });
+
+    assert(outer.get() == 4950);
+    pool.terminate();
+});
+
+unit("future", "recursive")
+.body([] {
+    ThreadPool<> pool(4, ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+
+    std::function<size_t(ExecutionContext &, size_t)> fib;
+    fib = [&] (ExecutionContext &ctx, size_t n) -> size_t {
+        if (n < 2) return n;
+        auto a = pool.submit([&, n] (ExecutionContext &c) { return fib(c, n - 1); });
+        size_t b = fib(ctx, n - 2);
+        return a.get(ctx) + b;
+    };
+
+    auto f = pool.submit([&] (ExecutionContext &ctx) { return fib(ctx, 16); });
+    assert(f.get() == 987);
+    pool.terminate(5000);
+});
+
+unit("future", "then")
+.body([] {
+    ThreadPool<> pool(2);
+
+    Promise<int> p;
+    auto f = p.future()
+        .then(pool, [] (ExecutionContext &, const Future<int> &f) { return f.get() + 1; })
+        .then(pool, [] (ExecutionContext &, const Future<int> &f) { return std::to_string(f.get()); });
+
+    p.set(41);
+    assert(f.get() == "42");
+
+    // continuations added to a ready future are scheduled right away
+    auto g = f.then(pool, [] (ExecutionContext &, const Future<std::string> &f) {
+        return f.get().size();
+    });
+    assert(g.get() == 2);
+
+    // exceptions propagate through get()
+    Promise<void> q;
+    auto h = q.future().then(pool, [] (ExecutionContext &, const Future<void> &f) {
+        f.get();
+        return 1;
+    });
+    q.setException(std::make_exception_ptr(ElementNotFoundError()));
+
+    bool thrown = false;
+    try {
+        h.get();
+    }
+    catch (const ElementNotFoundError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    pool.terminate();
+});
+
+unit("future", "when-all")
+.body([] {
+    ThreadPool<> pool(4);
+
+    std::atomic_size_t count(0);
+    std::vector<Future<void>> futures;
+    for (size_t i = 0; i < 1000; ++i) {
+        futures.push_back(pool.submit([&count] (ExecutionContext &ctx) {
+            ctx.waitMicros(10);
+            ++count;
+        }));
+    }
+    whenAll(futures).get();
+    assert(count == 1000);
+
+    auto a = pool.submit([] (ExecutionContext &) { return 1; });
+    auto b = pool.submit([] (ExecutionContext &) { return std::string("b"); });
+    auto all = pool.submit([&] (ExecutionContext &ctx) {
+        whenAll(a, b).get(ctx);
+        return a.get() + b.get().size();
+    });
+    assert(all.get() == 2);
+
+    whenAll(std::vector<Future<int>>()).get();
+
+    pool.terminate();
+});
+
+unit("future", "notify-before-suspend")
+.body([] {
+    ThreadPool<> pool(1);
+    std::atomic_bool done(false);
+
+    pool.run([&done] (ExecutionContext &ctx) {
+        // resume before suspending; the suspension must end right away
+        ctx.resumeHandle()();
+        ctx.suspend();
+        done = true;
+    });
+
+    while (! done);
+    pool.terminate();
+});
+
+perf("future", "get-suspends")
+.body([] {
+    ThreadPool<> pool(Thread::availableCPUs(), ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+    auto f = pool.submit([&pool] (ExecutionContext &ctx) {
+        std::vector<Future<size_t>> results;
+        for (size_t i = 0; i < MANY_TASKS; ++i) {
+            results.push_back(pool.submit([i] (ExecutionContext &) { return i; }));
+        }
+        size_t sum = 0;
+        for (auto &r : results) sum += r.get(ctx);
+        return sum;
+    });
+    f.get();
+    pool.terminate(5000);
+})
+.baseline([] {
+    ThreadPool<> pool(Thread::availableCPUs(), ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+    std::atomic_size_t sum(0);
+    pool.run([&] (ExecutionContext &) {
+        for (size_t i = 0; i < MANY_TASKS; ++i) {
+            pool.run([&sum, i] (ExecutionContext &) { sum += i; });
+        }
+    });
+    pool.terminate(5000);
+});
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <hash.h>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+using namespace spl;
+
+#define TEST_SIZE (64 * 1024)
+#define PERFORMANCE_ITERATIONS 1000000
+
+unit("hash", "djb2")
+.body([] {
+    assert(( hash<Djb2>("") == 5381 ));
+    assert(( hash<Djb2>("a") == 5381 * 33 + 'a' ));
+    assert(( hash<Djb2>("hello", 5) == hash<Djb2>("hello") ));
+});
+
+unit("hash", "wyhash")
+.body([] {
+    std::string data;
+    for (int i = 0; i < 256; ++i) data.push_back((char) (i * 31 + 7));
+
+    // every length takes a different path through the short, medium, and
+    // long input cases; none of the prefixes may collide
+    std::unordered_set<size_t> seen;
+    for (size_t len = 0; len <= data.size(); ++len) {
+        size_t h = hash(data.data(), len);
+        assert(h == WyHash::hash(data.data(), len));
+        assert(h == hash(std::string(data, 0, len).data(), len));
+        assert(seen.insert(h).second);
+    }
+
+    assert(( hash("hello") == hash("hello", 5) ));
+    assert(( WyHash::hash("hello", 5, 1) != WyHash::hash("hello", 5, 2) ));
+});
+
+unit("hash", "avalanche")
+.body([] {
+    // flipping any input bit flips about half of the output bits
+    char key[24] = "avalanche test key";
+    size_t base = hash(key, sizeof(key));
+    size_t flipped = 0;
+    for (size_t bit = 0; bit < 8 * sizeof(key); ++bit) {
+        key[bit / 8] ^= (char) (1 << (bit % 8));
+        flipped += __builtin_popcountl(base ^ hash(key, sizeof(key)));
+        key[bit / 8] ^= (char) (1 << (bit % 8));
+    }
+    double mean = (double) flipped / (8 * sizeof(key));
+    assert(mean > 24 && mean < 40);
+});
+
+unit("hash", "low-bits")
+.body([] {
+    // sequential keys and short strings spread evenly over buckets selected
+    // by the low bits, as hash tables do with h % nBuckets
+    constexpr size_t buckets = 1024;
+    std::vector<size_t> ints(buckets), strings(buckets);
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        ++ints[Hash<int>{}(i << 10) % buckets];
+        ++strings[Hash<std::string>{}("key-" + std::to_string(i)) % buckets];
+    }
+
+    size_t expected = TEST_SIZE / buckets;
+    for (size_t i = 0; i < buckets; ++i) {
+        assert(ints[i] < 2 * expected);
+        assert(strings[i] < 2 * expected);
+    }
+});
+
+unit("hash", "fnv1a")
+.body([] {
+    static_assert(const_hash("") == 0xcbf29ce484222325ull, "FNV-1a offset basis");
+    static_assert(const_hash("a") == 0xaf63dc4c8601ec8cull, "FNV-1a reference value");
+
+    // usable where a constant expression is required
+    switch (hash<Fnv1a>("beta")) {
+    case const_hash("alpha"):
+        assert(false);
+        break;
+    case const_hash("beta"):
+        break;
+    default:
+        assert(false);
+    }
+
+    assert(( const_hash("hello") == hash<Fnv1a>("hello", 5) ));
+    assert(( const_hash("hello") != const_hash("hellp") ));
+});
+
+unit("hash", "hash<T>")
+.body([] {
+    std::string s = "some string";
+    assert(( Hash<std::string>{}(s) == hash(s.data(), s.size()) ));
+    assert(( Hash<long>{}(42) == hash_mix(42) ));
+    assert(( Hash<long>{}(42) != Hash<long>{}(43) ));
+
+    int x;
+    assert(( Hash<int *>{}(&x) == hash_mix((uint64_t) (uintptr_t) &x) ));
+    assert(( Hash<double>{}(1.5) == std::hash<double>{}(1.5) ));
+});
+
+perf("hash", "hash(long-key)")
+.body([] {
+    std::string key(256, 'x');
+    size_t h = 0;
+    for (int i = 0; i < PERFORMANCE_ITERATIONS; ++i) {
+        key[i & 255] = (char) i;
+        h ^= hash(key.data(), key.size());
+    }
+    printf("%lu", h);
+})
+.baseline([] {
+    std::string key(256, 'x');
+    size_t h = 0;
+    for (int i = 0; i < PERFORMANCE_ITERATIONS; ++i) {
+        key[i & 255] = (char) i;
+        h ^= hash<Djb2>(key.data(), key.size());
+    }
+    printf("%lu", h);
+});
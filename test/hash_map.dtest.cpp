@@ -6,6 +6,10 @@
 #include <dtest.h>
 #include <hash_map.h>
 #include <unordered_map>
+#include <vector>
+#include <iterator>
+#include <atomic>
+#include <thread>
 #include <list.h>
 #include "test_hashable.cpp"
 
@@ -53,6 +57,10 @@ struct HashMapTester {
     static size_t numBuckets(HashMapType &m) {
         return m._controller.nBuckets;
     }
+
+    static bool resizing(HashMapType &m) {
+        return m._old != nullptr;
+    }
 };
 
 namespace parallel
@@ -129,6 +137,187 @@ unit("hash-map", "unique-dense-keys")
     assert(count == TEST_SIZE);
 });
 
+unit("hash-map", "incremental-resize")
+.body([] {
+    using Map = HashMap<int, std::string>;
+    Map m;
+
+    bool resized = false;
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        m.put(i, std::to_string(i));
+
+        if (HashMapTester<Map>::resizing(m)) {
+            resized = true;
+
+            // both tables must be visible while migrating
+            assert(m.get(i / 2) == std::to_string(i / 2));
+            assert(m.contains(i));
+
+            size_t count = 0;
+            for (auto &x : m) {
+                assert(x.v == std::to_string(x.k));
+                ++count;
+            }
+            assert(count == m.size());
+        }
+    }
+    assert(resized);
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; i += 2) {
+        assert(m.erase(i));
+    }
+    assert(m.size() == PARALLEL_TEST_SIZE / 2);
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        assert(m.contains(i) == (i % 2 == 1));
+    }
+});
+
+unit("hash-map", "high-load")
+.body([] {
+    using Map = HashMap<uint64_t, uint64_t>;
+    Map m;
+
+    // scattered keys fill most of the table before it grows
+    size_t tableSize = HashMapTester<Map>::tableSize(m);
+    size_t minLoad = (size_t) -1;
+    for (uint64_t i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        size_t sz = m.size();
+        m.put(i * 0x9e3779b97f4a7c15lu, i);
+        if (HashMapTester<Map>::tableSize(m) != tableSize) {
+            if (tableSize >= 1024) minLoad = std::min(minLoad, 100 * sz / tableSize);
+            tableSize = HashMapTester<Map>::tableSize(m);
+        }
+    }
+    assert(minLoad >= 75);
+    assert(HashMapTester<Map>::bucketSize(m) == 1);
+
+    // churn does not grow the table or lose elements
+    for (uint64_t i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        assert(m.erase(i * 0x9e3779b97f4a7c15lu));
+        m.put((i + PARALLEL_TEST_SIZE) * 0x9e3779b97f4a7c15lu, i);
+    }
+    assert(HashMapTester<Map>::tableSize(m) <= 2 * tableSize);
+    for (uint64_t i = PARALLEL_TEST_SIZE; i < 2 * PARALLEL_TEST_SIZE; ++i) {
+        assert(m.get(i * 0x9e3779b97f4a7c15lu) == i - PARALLEL_TEST_SIZE);
+    }
+});
+
+unit("hash-map", "small")
+.body([] {
+    using Map = HashMap<int, std::string>;
+
+    // empty maps share a table until their first insertion
+    Map a, b;
+    assert(a.empty() && ! a.contains(1) && a.find(1) == nullptr);
+    assert(a.begin() == a.end());
+    assert(a.erase(1) == false);
+
+    Map c(a);
+    assert(c.empty());
+
+    for (int i = 0; i < 8; ++i) a.put(i, std::to_string(i));
+    assert(HashMapTester<Map>::tableSize(a) == 8);
+    assert(b.empty() && c.empty());
+
+    // moved-from and cleared maps are empty and usable
+    Map d(std::move(a));
+    assert(a.empty());
+    a.put(1, "1");
+    assert(a.get(1) == "1");
+
+    d.clear();
+    assert(d.empty());
+    d.put(2, "2");
+    assert(d.size() == 1 && d.get(2) == "2");
+});
+
+unit("hash-map", "reserve")
+.body([] {
+    using Tester = HashMapTester<HashMap<int, int>>;
+
+    HashMap<int, int> m;
+    m.put(-1, -1);
+    m.reserve(4 * TEST_SIZE);
+
+    size_t tableSize = Tester::tableSize(m);
+    assert(tableSize >= 4 * TEST_SIZE);
+    assert(m.get(-1) == -1);
+
+    for (int i = 0; i < 4 * TEST_SIZE; ++i) {
+        m.put(i, i * 2);
+    }
+    assert(Tester::tableSize(m) == tableSize);
+    assert(! Tester::resizing(m));
+
+    for (int i = 0; i < 4 * TEST_SIZE; ++i) {
+        if (i % 64 != 0) m.erase(i);
+    }
+    m.shrinkToFit();
+
+    assert(Tester::tableSize(m) < tableSize / 16);
+    assert(m.size() == 4 * TEST_SIZE / 64 + 1);
+    for (int i = 0; i < 4 * TEST_SIZE; ++i) {
+        assert(m.contains(i) == (i % 64 == 0));
+    }
+    assert(m.get(-1) == -1);
+});
+
+unit("hash-map", "stats")
+.body([] {
+    using Tester = HashMapTester<HashMap<int, int>>;
+
+    HashMap<int, int> m;
+    for (int i = 0; i < TEST_SIZE; ++i) m.put(i, i);
+
+    HashTableStats s = m.stats();
+    assert(s.size == TEST_SIZE);
+    assert(s.tableSize == Tester::tableSize(m));
+    assert(s.buckets == Tester::numBuckets(m));
+    assert(s.loadFactor == (double) TEST_SIZE / s.tableSize);
+    assert(s.duplicateHashes == 0);
+    assert(s.maxSameHash == 1);
+    assert(! s.recorded);
+
+    size_t probed = 0, loaded = 0, buckets = 0;
+    for (size_t d = 0; d < s.probeLengths.size(); ++d) probed += s.probeLengths[d];
+    for (size_t k = 0; k < s.bucketLoads.size(); ++k) {
+        loaded += k * s.bucketLoads[k];
+        buckets += s.bucketLoads[k];
+    }
+    assert(probed == TEST_SIZE);
+    assert(loaded == TEST_SIZE);
+    assert(buckets == s.buckets);
+    assert(s.maxProbeLength == s.probeLengths.size() - 1);
+
+    struct ConstantHash {
+        size_t operator()(int) const {
+            return 7;
+        }
+    };
+
+    HashMap<int, int, ConstantHash> c;
+    for (int i = 0; i < 100; ++i) c.put(i, i);
+
+    s = c.stats();
+    assert(s.duplicateHashes == 100);
+    assert(s.maxSameHash == 100);
+    assert(s.maxBucketLoad == 100);
+    assert(s.bucketSize >= 100);
+
+    assert((HashMap<int, int>().stats().size == 0));
+});
+
+unit("parallel::hash-map", "stats")
+.body([] {
+    parallel::HashMap<int, int> m;
+    for (int i = 0; i < TEST_SIZE; ++i) m.put(i, i);
+
+    HashTableStats s = m.stats();
+    assert(s.size == TEST_SIZE);
+    assert(s.duplicateHashes == 0);
+});
+
 unit("parallel::hash-map", "unique-dense-keys")
 .body([] {
     parallel::HashMap<HashableObj, HashableObj> m;
@@ -180,6 +369,237 @@ unit("parallel::hash-map", "unique-dense-keys-2")
     assert(count == PARALLEL_TEST_SIZE);
 });
 
+unit("parallel::hash-map", "striped-controller")
+.body([] {
+    parallel::HashMap<
+        int,
+        std::string,
+        Hash<int>,
+        std::equal_to<int>,
+        core::StripedHashTableController<>
+    > m;
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        m.put(i, std::to_string(i));
+        m.put(i / 2, std::to_string(i / 2));
+        if (i % 3 == 0) m.erase_l(-1);
+    }
+
+    assert(m.size() == PARALLEL_TEST_SIZE);
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        assert(m.get(i) == std::to_string(i));
+    }
+
+    size_t count = 0;
+    for (auto &x : m) {
+        assert(x.v == std::to_string(x.k));
+        ++count;
+    }
+    assert(count == PARALLEL_TEST_SIZE);
+});
+
+unit("parallel::hash-map", "read-during-resize")
+.body([] {
+    parallel::HashMap<int, std::string> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, std::to_string(i));
+    }
+
+    std::atomic_size_t missing(0);
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        m.put(TEST_SIZE + i, std::to_string(TEST_SIZE + i));
+
+        int k = i % TEST_SIZE;
+        if (! m.contains(k) || m.get(k) != std::to_string(k)) ++missing;
+        if (m.getOr(-1, "none") != "none") ++missing;
+    }
+
+    assert(missing == 0);
+    assert(m.size() == TEST_SIZE + PARALLEL_TEST_SIZE);
+
+    for (int i = 0; i < TEST_SIZE + PARALLEL_TEST_SIZE; ++i) {
+        assert(m.get(i) == std::to_string(i));
+    }
+});
+
+unit("parallel::hash-map", "read-during-update")
+.body([] {
+    parallel::HashMap<int, std::string> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, std::string(64, 'a'));
+    }
+
+    std::atomic_size_t bad(0);
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        int k = i % TEST_SIZE;
+        m.put(k, std::string(64, 'a' + i % 2));
+
+        std::string v = m.get(k);
+        if (v.size() != 64 || v.find_first_not_of(v[0]) != std::string::npos) ++bad;
+        if (! m.tryGet(k, v) || v.size() != 64) ++bad;
+    }
+
+    assert(bad == 0);
+    assert(m.size() == TEST_SIZE);
+});
+
+unit("parallel::hash-map", "scan")
+.body([] {
+    parallel::HashMap<int, int> m;
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        m.put(i, i);
+    }
+
+    std::vector<std::atomic<int>> seen(PARALLEL_TEST_SIZE);
+    for (auto &x : seen) x = 0;
+    std::atomic_size_t bad(0);
+    std::atomic_bool scanning(true);
+
+    std::thread writer([&m, &scanning] {
+        // grows the map through several resizes, and churns transient keys
+        for (int i = 0; scanning || i < 16 * PARALLEL_TEST_SIZE; ++i) {
+            m.put(PARALLEL_TEST_SIZE + i, i);
+            if (i >= 100) m.erase(PARALLEL_TEST_SIZE + i - 100);
+            m.update(i % PARALLEL_TEST_SIZE, [] (int &v) { v = v; });
+        }
+    });
+
+    for (int pass = 0; pass < 4; ++pass) {
+        for (auto &x : seen) x = 0;
+        m.scan([&seen, &bad] (const MapNode<int, int> &x) {
+            if (x.k < PARALLEL_TEST_SIZE) {
+                ++seen[x.k];
+                if (x.v != x.k) ++bad;
+            }
+        });
+        for (auto &x : seen) {
+            if (x != 1) ++bad;
+        }
+    }
+    scanning = false;
+    writer.join();
+
+    assert(bad == 0);
+});
+
+unit("parallel::hash-map", "scan-during-update")
+.body([] {
+    parallel::HashMap<int, std::string> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, std::string(64, 'a'));
+    }
+
+    std::vector<std::atomic<int>> seen(TEST_SIZE);
+    std::atomic_size_t bad(0);
+    std::atomic_bool scanning(true);
+
+    std::thread writer([&m, &scanning] {
+        // replaces the values of existing keys, and grows the map
+        for (int i = 0; scanning || i < 4 * TEST_SIZE; ++i) {
+            m.put(i % TEST_SIZE, std::string(64, 'a' + i % 2));
+            if (i % 4 == 0) m.put(TEST_SIZE + i, std::string(64, 'c'));
+        }
+    });
+
+    for (int pass = 0; pass < 4; ++pass) {
+        for (auto &x : seen) x = 0;
+        m.scan([&seen, &bad] (const MapNode<int, std::string> &x) {
+            if (x.v.size() != 64 || x.v.find_first_not_of(x.v[0]) != std::string::npos) ++bad;
+            if (x.k < TEST_SIZE) ++seen[x.k];
+        });
+        for (auto &x : seen) {
+            if (x != 1) ++bad;
+        }
+    }
+    scanning = false;
+    writer.join();
+
+    assert(bad == 0);
+});
+
+unit("hash-map", "batch")
+.body([] {
+    HashMap<int, int> m;
+
+    std::vector<MapNode<int, int>> nodes;
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        nodes.push_back({ i, i * 2 });
+    }
+    m.putBatch(nodes);
+    m.putBatch(nodes.begin(), nodes.begin() + TEST_SIZE / 2);
+
+    assert(m.size() == TEST_SIZE);
+
+    std::vector<int> keys;
+    for (int i = 0; i < 2 * TEST_SIZE; ++i) {
+        keys.push_back(i);
+    }
+
+    std::vector<int> values;
+    m.getBatch(keys, std::back_inserter(values), -1);
+    assert(values.size() == keys.size());
+    for (int i = 0; i < 2 * TEST_SIZE; ++i) {
+        assert(values[i] == (i < TEST_SIZE ? i * 2 : -1));
+    }
+
+    keys.resize(TEST_SIZE);
+    values.assign(TEST_SIZE, 0);
+    auto end = m.getBatch(keys, values.begin());
+    assert(end == values.end());
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(values[i] == i * 2);
+    }
+});
+
+unit("hash-map", "batch-missing-key")
+.expect(Status::FAIL)
+.body([] {
+    HashMap<int, int> m;
+    m.put(1, 1);
+
+    std::vector<int> keys = { 1, 2 };
+    std::vector<int> values;
+    m.getBatch(keys, std::back_inserter(values));
+});
+
+unit("parallel::hash-map", "batch")
+.body([] {
+    parallel::HashMap<int, int> m;
+
+    std::vector<MapNode<int, int>> nodes;
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        nodes.push_back({ i, i * 2 });
+    }
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; i += 128) {
+        m.putBatch(nodes.begin() + i, nodes.begin() + std::min(i + 128, PARALLEL_TEST_SIZE));
+    }
+
+    assert(m.size() == PARALLEL_TEST_SIZE);
+
+    std::vector<int> keys;
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        keys.push_back(i);
+    }
+
+    std::vector<int> values;
+    m.getBatch(keys, std::back_inserter(values));
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        assert(values[i] == i * 2);
+    }
+});
+
 unit("hash-map", "dense-keys")
 .body([] {
 
@@ -232,6 +652,173 @@ unit("hash-map", "colliding-keys")
 });
 
 
+unit("hash-map", "missing-keys")
+.body([] {
+
+    HashMap<int, int> m;
+
+    for (int i = 0; i < 2 * TEST_SIZE; i += 2) {
+        m.put(i, i);
+    }
+
+    for (int i = 0; i < 2 * TEST_SIZE; ++i) {
+        assert(m.contains(i) == (i % 2 == 0));
+        assert(m.getOr(i, -1) == (i % 2 == 0 ? i : -1));
+    }
+
+    for (int i = 0; i < 2 * TEST_SIZE; i += 4) {
+        m.erase(i);
+    }
+
+    for (int i = 0; i < 2 * TEST_SIZE; ++i) {
+        assert(m.contains(i) == (i % 4 == 2));
+    }
+    assert(m.size() == TEST_SIZE / 2);
+});
+
+unit("hash-map", "find")
+.body([] {
+    HashMap<int, int> m;
+    parallel::HashMap<int, int> pm;
+    HashMultiMap<int, int> mm;
+    parallel::HashMultiMap<int, int> pmm;
+
+    for (int i = 0; i < TEST_SIZE; i += 2) {
+        m.put(i, i);
+        pm.put(i, i);
+        mm.put(i, i);
+        pmm.put(i, i);
+    }
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        int v = -1, pv = -1;
+        if (i % 2 == 0) {
+            assert(*m.find(i) == i);
+            assert(*mm.find(i) == i);
+            assert(pm.tryGet(i, v) && v == i);
+            assert(pmm.tryGet(i, pv) && pv == i);
+        }
+        else {
+            assert(m.find(i) == nullptr);
+            assert(mm.find(i) == nullptr);
+            assert(! pm.tryGet(i, v) && v == -1);
+            assert(! pmm.tryGet(i, pv) && pv == -1);
+        }
+    }
+
+    *m.find(0) = 42;
+    assert(m.get(0) == 42);
+
+    const HashMap<int, int> &cm = m;
+    assert(*cm.find(0) == 42);
+});
+
+unit("hash-map", "in-place")
+.body([] {
+    HashMap<int, std::vector<int>> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(m.tryEmplace(i, 3, i));
+    }
+    assert(! m.tryEmplace(0, 1, -1));
+    assert(m.size() == TEST_SIZE);
+    assert(m.get(0).size() == 3);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(m.update(i, [i] (std::vector<int> &v) { v.push_back(-i); }));
+    }
+    assert(! m.update(-1, [] (std::vector<int> &v) { v.clear(); }));
+
+    m.emplace(0, 1, 7);
+    m.emplace(-1, 2, 7);
+    assert(m.size() == TEST_SIZE + 1);
+    assert(m.get(0).size() == 1 && m.get(-1).size() == 2);
+
+    m.compute(-2, [] (std::vector<int> &v) { v.push_back(1); });
+    m.compute(-2, [] (std::vector<int> &v) { v.push_back(2); });
+    assert(m.size() == TEST_SIZE + 2);
+
+    size_t n = 0;
+    assert(m.visit(-2, [&n] (const std::vector<int> &v) { n = v.size(); }));
+    assert(n == 2);
+    assert(! m.visit(-3, [&n] (const std::vector<int> &v) { n = 0; }));
+    assert(n == 2);
+
+    for (int i = 1; i < TEST_SIZE; ++i) {
+        const std::vector<int> *v = m.find(i);
+        assert(v != nullptr && v->size() == 4 && (*v)[0] == i && (*v)[3] == -i);
+    }
+});
+
+unit("parallel::hash-map", "in-place")
+.body([] {
+    parallel::HashMap<int, long> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.emplace(i, 0);
+    }
+
+    std::atomic_size_t inserted(0);
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        int k = i % TEST_SIZE;
+        assert(m.update(k, [] (long &v) { ++v; }));
+        m.compute(TEST_SIZE + k, [] (long &v) { v += 2; });
+        if (m.tryEmplace(2 * TEST_SIZE + k, i)) ++inserted;
+        m.put(3 * TEST_SIZE + i, i);
+    }
+
+    assert(inserted == TEST_SIZE);
+    assert(m.size() == 3 * TEST_SIZE + PARALLEL_TEST_SIZE);
+
+    long total = 0, computed = 0;
+    for (int k = 0; k < TEST_SIZE; ++k) {
+        assert(m.visit(k, [&total] (long v) { total += v; }));
+        computed += m.get(TEST_SIZE + k);
+    }
+    assert(total == PARALLEL_TEST_SIZE);
+    assert(computed == 2 * PARALLEL_TEST_SIZE);
+    assert(! m.update(-1, [] (long &v) { v = 0; }));
+    assert(! m.visit(-1, [] (long) { }));
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        assert(m.get(3 * TEST_SIZE + i) == i);
+    }
+});
+
+unit("hash-map", "large-values")
+.body([] {
+
+    struct Large {
+        int v;
+        char payload[196];
+    };
+
+    HashMap<int, Large> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        Large x;
+        x.v = i;
+        m.put(i, x);
+    }
+
+    for (int i = 0; i < TEST_SIZE; i += 2) {
+        m.erase(i);
+    }
+
+    HashMap<int, Large> copy = m;
+
+    size_t count = 0;
+    for (auto &x : copy) {
+        assert(x.k % 2 == 1);
+        assert(x.v.v == x.k);
+        ++count;
+    }
+    assert(count == TEST_SIZE / 2);
+    assert(count == m.size());
+});
+
 unit("hash-map", "foreach")
 .body([] {
 
@@ -335,6 +922,82 @@ unit("hash-map", "to-list")
     assert(count == TEST_SIZE);
 });
 
+unit("hash-map", "parallel-foreach")
+.body([] {
+
+    HashMap<HashableObj, HashableObj> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, i * 2);
+    }
+
+    std::atomic<size_t> count(0);
+    m.parallelForeach([&count] (MapNode<HashableObj, HashableObj> &n) {
+        n.v.v += 1;
+        ++count;
+    });
+    assert(count == TEST_SIZE);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(m.get(i).v == i * 2 + 1);
+    }
+});
+
+unit("hash-map", "parallel-map")
+.dependsOn("list")
+.body([] {
+
+    HashMap<HashableObj, HashableObj> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, i * 2);
+    }
+
+    auto m2 = m.parallelMap([] (const MapNode<HashableObj, HashableObj> &n) -> MapNode<HashableObj, HashableObj> {
+        return { n.k.v + 1, n.v.v * 2 };
+    });
+
+    assert(m2.size() == TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(m2.get(i + 1).v == i * 4);
+    }
+
+    auto l = m.parallelMap<List<HashableObj>>([] (const MapNode<HashableObj, HashableObj> &n) -> HashableObj {
+        return n.k;
+    });
+
+    assert(l.size() == TEST_SIZE);
+    for (auto &x : l) {
+        assert(m.contains(x));
+    }
+});
+
+unit("hash-map", "parallel-reduce")
+.body([] {
+
+    HashMap<HashableObj, HashableObj> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, i * 2);
+    }
+
+    auto sum = m.parallelReduce<long>(
+        [] (const MapNode<HashableObj, HashableObj> &n) { return (long) n.v.v; },
+        [] (long acc, const MapNode<HashableObj, HashableObj> &n) { return acc + n.v.v; },
+        [] (long x, long y) { return x + y; }
+    );
+    assert(sum == (long) TEST_SIZE * (TEST_SIZE - 1));
+
+    // a single thread takes the same path as any other thread count
+    auto sum2 = m.parallelReduce<long>(
+        [] (const MapNode<HashableObj, HashableObj> &n) { return (long) n.v.v; },
+        [] (long acc, const MapNode<HashableObj, HashableObj> &n) { return acc + n.v.v; },
+        [] (long x, long y) { return x + y; },
+        1
+    );
+    assert(sum2 == sum);
+});
+
 perf("hash-map", "put(p)")
 .performanceMarginMillis(PERFORMANCE_MARGIN_MILLIS)
 .body([] {
@@ -380,6 +1043,26 @@ unit("hash-multimap", "unique-dense-keys")
     assert(count == TEST_SIZE);
 });
 
+unit("hash-multimap", "batch")
+.body([] {
+    HashMultiMap<int, int> m;
+
+    std::vector<MapNode<int, int>> nodes;
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        nodes.push_back({ i / 2, i });
+    }
+    m.putBatch(nodes);
+
+    assert(m.size() == TEST_SIZE);
+
+    std::vector<int> keys = { 0, 1, TEST_SIZE };
+    std::vector<int> values;
+    m.getBatch(keys, std::back_inserter(values), -1);
+    assert(values[0] == 0 || values[0] == 1);
+    assert(values[1] == 2 || values[1] == 3);
+    assert(values[2] == -1);
+});
+
 unit("parallel::hash-multimap", "unique-dense-keys")
 .body([] {
 
@@ -546,3 +1229,116 @@ unit("parallel::hash-multimap", "colliding-keys")
     }
     assert(count == PARALLEL_TEST_SIZE);
 });
+
+unit("hash-multimap", "grouped")
+.body([] {
+
+    GroupedHashMultiMap<int, int> m;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i % 10, i);
+    }
+    m.put(-1, -1);
+
+    assert(m.size() == TEST_SIZE + 1);
+    assert(m.keyCount() == 11);
+    assert(m.count(3) == TEST_SIZE / 10 + (3 < TEST_SIZE % 10 ? 1 : 0));
+    assert(m.count(-2) == 0 && ! m.contains(-2));
+    assert(m.get(3) == 3 && m.getOr(-2, 7) == 7);
+
+    // values of a key are visited in insertion order
+    int last = -1;
+    size_t n = 0;
+    m.foreach(3, [&last, &n] (int v) {
+        assert(v % 10 == 3 && v > last);
+        last = v;
+        ++n;
+    });
+    assert(n == m.count(3));
+    assert(m.values(3)->size() == n);
+
+    m.foreach(4, [] (int &v) { v = -v; });
+    assert(m.get(4) == -4);
+
+    size_t total = 0;
+    for (const auto &x : m) total += x.v.size();
+    assert(total == m.size());
+
+    assert(m.remove(-1) == -1);
+    assert(! m.contains(-1) && m.keyCount() == 10);
+    assert(m.erase(3));
+    assert(m.count(3) == n - 1);
+    assert(m.erase(5, [] (int v) { return v == 5; }));
+    assert(! m.erase(5, [] (int v) { return v == 5; }));
+    size_t large = m.count(6) - 10;
+    assert(m.eraseAll(6, [] (int v) { return v > 100; }) == large);
+    assert(m.count(6) == 10);
+    assert(m.eraseAll(7) == TEST_SIZE / 10 + (7 < TEST_SIZE % 10 ? 1 : 0));
+    assert(! m.contains(7));
+
+    total = 0;
+    for (const auto &x : m) total += x.v.size();
+    assert(total == m.size());
+
+    GroupedHashMultiMap<int, int> copy(m), moved(std::move(copy));
+    assert(moved.size() == m.size() && copy.empty());
+
+    GroupedHashMultiMap<int, int> g = { { 1, 1 }, { 1, 2 }, { 2, 3 } };
+    assert(g.size() == 3 && g.keyCount() == 2 && g.count(1) == 2);
+    g.clear();
+    assert(g.empty() && ! g.contains(1));
+});
+
+unit("hash-multimap", "grouped-hot-keys")
+.body([] {
+
+    GroupedHashMultiMap<HashableObj, HashableObj> m;
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        m.put(i % 4, i);
+    }
+
+    // a handful of hot keys take a handful of slots
+    assert((HashMapTester<GroupedHashMultiMap<HashableObj, HashableObj>>::tableSize(m)) <= 16);
+    assert(m.count(0) == PARALLEL_TEST_SIZE / 4);
+
+    size_t count = 0;
+    for (const auto &x : m) {
+        for (const auto &v : x.v) {
+            assert(v.v % 4 == x.k.v);
+            ++count;
+        }
+    }
+    assert(count == PARALLEL_TEST_SIZE);
+});
+
+perf("hash-multimap", "grouped-foreach(p)")
+.performanceMarginMillis(PERFORMANCE_MARGIN_MILLIS)
+.body([] {
+
+    GroupedHashMultiMap<int, int> m;
+
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        m.put(i % 16, i);
+    }
+
+    long sum = 0;
+    for (int k = 0; k < 16; ++k) {
+        m.foreach(k, [&sum] (int v) { sum += v; });
+    }
+    assert(sum > 0);
+})
+.baseline([] {
+
+    HashMultiMap<int, int> m;
+
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        m.put(i % 16, i);
+    }
+
+    long sum = 0;
+    for (int k = 0; k < 16; ++k) {
+        m.foreach(k, [&sum] (const MapNode<int, int> &x) { sum += x.v; });
+    }
+    assert(sum > 0);
+});
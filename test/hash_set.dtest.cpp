@@ -6,6 +6,10 @@
 #include <dtest.h>
 #include <hash_set.h>
 #include <unordered_set>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <iterator>
 #include <list.h>
 #include "test_hashable.cpp"
 
@@ -121,6 +125,31 @@ unit("hash-set", "unique-dense-keys")
     assert(count == TEST_SIZE);
 });
 
+unit("hash-set", "reserve")
+.body([] {
+    using Tester = HashSetTester<HashMultiSet<int>>;
+
+    HashMultiSet<int> s;
+    s.reserve(TEST_SIZE);
+
+    size_t tableSize = Tester::tableSize(s);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        s.put(i % 16);
+    }
+    assert(s.size() == TEST_SIZE);
+
+    s.shrinkToFit();
+    assert(Tester::tableSize(s) <= tableSize);
+
+    size_t count = 0;
+    for (auto &x : s) {
+        assert(x < 16);
+        ++count;
+    }
+    assert(count == TEST_SIZE);
+});
+
 unit("parallel::hash-set", "unique-dense-keys")
 .body([] {
 
@@ -146,6 +175,113 @@ unit("parallel::hash-set", "unique-dense-keys")
     assert(count == PARALLEL_TEST_SIZE);
 });
 
+unit("parallel::hash-set", "striped-controller")
+.body([] {
+
+    parallel::HashSet<
+        HashableObj,
+        Hash<HashableObj>,
+        std::equal_to<HashableObj>,
+        core::StripedHashTableController<8>
+    > s;
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        s.put(i);
+        s.put(i / 2);
+    }
+
+    assert(s.size() == PARALLEL_TEST_SIZE);
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        assert(s.contains(i));
+    }
+
+    size_t count = 0;
+    for (auto &x : s) {
+        assert(x.v < PARALLEL_TEST_SIZE);
+        ++count;
+    }
+    assert(count == PARALLEL_TEST_SIZE);
+});
+
+unit("parallel::hash-set", "scan")
+.body([] {
+    parallel::HashSet<int> m;
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        m.put(i);
+    }
+
+    std::vector<std::atomic<int>> seen(PARALLEL_TEST_SIZE);
+    std::atomic_size_t bad(0);
+    std::atomic_bool scanning(true);
+
+    std::thread writer([&m, &scanning] {
+        for (int i = 0; scanning || i < 16 * PARALLEL_TEST_SIZE; ++i) {
+            m.put(PARALLEL_TEST_SIZE + i);
+            if (i >= 100) m.erase(PARALLEL_TEST_SIZE + i - 100);
+        }
+    });
+
+    for (int pass = 0; pass < 4; ++pass) {
+        for (auto &x : seen) x = 0;
+        m.scan([&seen] (int k) {
+            if (k < PARALLEL_TEST_SIZE) ++seen[k];
+        });
+        for (auto &x : seen) {
+            if (x != 1) ++bad;
+        }
+    }
+    scanning = false;
+    writer.join();
+
+    assert(bad == 0);
+});
+
+unit("hash-set", "batch")
+.body([] {
+    HashSet<int> s;
+
+    std::vector<int> keys;
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        keys.push_back(i);
+    }
+    s.putBatch(keys);
+    s.putBatch(keys.begin(), keys.begin() + TEST_SIZE / 2);
+
+    assert(s.size() == TEST_SIZE);
+
+    keys.push_back(-5);
+    std::vector<int> found;
+    s.getBatch(keys, std::back_inserter(found), -1);
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(found[i] == i);
+    }
+    assert(found[TEST_SIZE] == -1);
+});
+
+unit("parallel::hash-multiset", "batch")
+.body([] {
+    parallel::HashMultiSet<int> s;
+
+    std::vector<int> keys;
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        keys.push_back(i % 100);
+    }
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; i += 128) {
+        s.putBatch(keys.begin() + i, keys.begin() + std::min(i + 128, PARALLEL_TEST_SIZE));
+    }
+
+    assert(s.size() == PARALLEL_TEST_SIZE);
+
+    std::vector<int> found;
+    s.getBatch(HashSet<int>({ 0, 50, 99 }), std::back_inserter(found));
+    assert(found.size() == 3);
+});
+
 unit("hash-set", "dense-keys")
 .body([] {
 
@@ -483,3 +619,36 @@ unit("parallel::hash-multiset", "colliding-keys")
     }
     assert(count == PARALLEL_TEST_SIZE);
 });
+
+unit("hash-multiset", "grouped")
+.body([] {
+
+    GroupedHashMultiSet<HashableObj> s;
+
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        s.put(i % 4);
+    }
+    s.put(-1, 3);
+
+    assert(s.size() == PARALLEL_TEST_SIZE + 3);
+    assert(s.keyCount() == 5);
+    assert((HashSetTester<GroupedHashMultiSet<HashableObj>>::tableSize(s)) <= 16);
+    assert(s.count(0) == PARALLEL_TEST_SIZE / 4);
+    assert(s.count(-1) == 3 && s.get(-1).v == -1);
+    assert(! s.contains(4) && s.count(4) == 0);
+
+    size_t total = 0;
+    for (const auto &x : s) total += x.v;
+    assert(total == s.size());
+
+    assert(s.erase(-1));
+    assert(s.count(-1) == 2);
+    assert(s.eraseAll(-1) == 2);
+    assert(! s.contains(-1) && ! s.erase(-1));
+    assert(s.size() == PARALLEL_TEST_SIZE && s.keyCount() == 4);
+
+    GroupedHashMultiSet<int> t = { 1, 1, 2 };
+    assert(t.size() == 3 && t.count(1) == 2);
+    t.clear();
+    assert(t.empty() && ! t.contains(1));
+});
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#define SPL_HASH_TABLE_STATS
+
+#include <dtest.h>
+#include <hash_map.h>
+#include <hash_set.h>
+
+module("hash-table-stats")
+.dependsOn({
+    "hash-map",
+    "hash-set"
+});
+
+using namespace spl;
+
+// tests of different modules are loaded into the same process, so the
+// recording tables must not share their template arguments with the plain
+// tables of other tests
+struct StatsHash {
+    size_t operator()(int x) const {
+        return Hash<int>()(x);
+    }
+};
+
+unit("hash-table-stats", "resizes")
+.body([] {
+    HashMap<int, int, StatsHash> m;
+    for (int i = 0; i < 100000; ++i) m.put(i, i);
+
+    HashTableStats s = m.stats();
+    assert(s.recorded);
+    assert(s.resizes > 0);
+    assert(s.resizes == s.bucketSizeIncreases + s.bucketCountIncreases);
+    assert(s.rehashNanos > 0);
+    assert(! s.history.empty());
+    assert(s.history.size() <= core::HashTableStatsRecorder::HISTORY);
+    assert(s.history.back().buckets == s.buckets);
+    assert(s.history.back().bucketSize == s.bucketSize);
+    for (size_t i = 1; i < s.history.size(); ++i) {
+        assert(s.history[i].time >= s.history[i - 1].time);
+        assert(s.history[i].size >= s.history[i - 1].size);
+    }
+
+    // moves carry the history along, copies start their own
+    HashMap<int, int, StatsHash> moved(std::move(m));
+    assert(moved.stats().resizes == s.resizes);
+    assert(m.stats().resizes == 0);
+    HashMap<int, int, StatsHash> copied(moved);
+    assert(copied.stats().resizes == 0);
+
+    copied.shrinkToFit();
+    copied.reserve(1000000);
+    assert(copied.stats().resizes == 1);
+    assert(copied.stats().history.back().size == 100000);
+});
+
+unit("hash-table-stats", "colliding-hashes")
+.body([] {
+    struct ConstantHash {
+        size_t operator()(int) const {
+            return 7;
+        }
+    };
+
+    HashSet<int, ConstantHash> set;
+    for (int i = 0; i < 100; ++i) set.put(i);
+
+    HashTableStats s = set.stats();
+    assert(s.bucketSizeIncreases > 0);
+    assert(s.duplicateHashes == 100);
+    assert(s.history.back().bucketSize == s.bucketSize);
+});
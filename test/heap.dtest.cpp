@@ -5,15 +5,29 @@
 
 #include <dtest.h>
 #include <heap.h>
+#include <thread.h>
+#include <list.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <mutex>
 
 module("heap")
 .dependsOn({
     "exception"
 });
 
+module("parallel::heap")
+.dependsOn({
+    "heap"
+});
+
 using namespace spl;
 
 #define TEST_SIZE (1024)
+#define PARALLEL_TEST_SIZE (10 * 1024)
+#define PERFORMANCE_TEST_SIZE (200 * 1024)
+#define PERFORMANCE_MARGIN (0.99)
 
 unit("heap", "initializer-list")
 .body([] {
@@ -146,3 +160,354 @@ unit("heap", "move")
     assert(h.size() == 0);
     assert(h.begin() == h.end());
 });
+
+template <size_t Arity>
+static void dary_push_pop() {
+    auto h = Heap<int, std::less<int>, Arity>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        h.push((int) (dtest_random() * TEST_SIZE));
+    }
+    assert(h.size() == TEST_SIZE);
+
+    int prev = h.top();
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        int x = h.pop();
+        assert(x <= prev);
+        prev = x;
+    }
+    assert(h.empty());
+}
+
+unit("heap", "4-ary")
+.body([] {
+    dary_push_pop<4>();
+});
+
+unit("heap", "8-ary")
+.body([] {
+    dary_push_pop<8>();
+});
+
+unit("heap", "3-ary")
+.body([] {
+    dary_push_pop<3>();
+});
+
+unit("heap", "cache-aligned-children")
+.body([] {
+    auto h = Heap<int, std::less<int>, 16>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        h << i;
+    }
+
+    // the children of the root start on a cache line boundary
+    assert((uintptr_t) (&*h.begin() + 1) % 64 == 0);
+    assert(h.top() == TEST_SIZE - 1);
+});
+
+unit("heap", "heapify")
+.body([] {
+    std::vector<int> buf;
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        buf.push_back((int) (dtest_random() * TEST_SIZE));
+    }
+    auto sorted = buf;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto h = Heap<int, std::less<int>, 4>(std::move(buf));
+    assert(h.size() == TEST_SIZE);
+
+    for (int i = TEST_SIZE - 1; i >= 0; --i) {
+        assert(h.pop() == sorted[i]);
+    }
+});
+
+unit("heap", "pushAll")
+.body([] {
+    auto h = Heap<int>();
+    std::vector<int> small = { 5, 1, 7 };
+    std::vector<int> large;
+    for (int i = 0; i < TEST_SIZE; ++i) large.push_back(i);
+
+    h.pushAll(large.begin(), large.end());
+    assert(h.size() == TEST_SIZE);
+    h.pushAll(small.begin(), small.end());
+    assert(h.size() == TEST_SIZE + 3);
+    h.pushAll(large.begin(), large.begin());
+    assert(h.size() == TEST_SIZE + 3);
+
+    int prev = h.pop();
+    assert(prev == TEST_SIZE - 1);
+    while (h.nonEmpty()) {
+        int x = h.pop();
+        assert(x <= prev);
+        prev = x;
+    }
+});
+
+unit("heap", "popN")
+.body([] {
+    auto h = Heap<int>();
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        h << i;
+    }
+
+    std::vector<int> out;
+    assert(h.popN(10, std::back_inserter(out)) == 10);
+    assert(h.size() == TEST_SIZE - 10);
+    for (int i = 0; i < 10; ++i) {
+        assert(out[i] == TEST_SIZE - 1 - i);
+    }
+
+    int rest[TEST_SIZE];
+    assert(h.popN(TEST_SIZE, rest) == TEST_SIZE - 10);
+    assert(h.empty());
+    assert(rest[0] == TEST_SIZE - 11);
+    assert(rest[TEST_SIZE - 11] == 0);
+    assert(h.popN(1, rest) == 0);
+});
+
+unit("heap", "parallel-foreach-reduce")
+.body([] {
+    Heap<int> h;
+    for (int i = 0; i < TEST_SIZE; ++i) h.push(i);
+
+    std::atomic<long> sum(0);
+    h.parallelForeach([&sum] (int x) { sum += x; });
+    assert(sum == (long) TEST_SIZE * (TEST_SIZE - 1) / 2);
+
+    auto max = h.parallelReduce<int>([] (int x, int y) { return std::max(x, y); });
+    assert(max == TEST_SIZE - 1);
+});
+
+perf("heap", "pushAll(p)")
+.performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
+.body([] {
+    std::vector<int> buf;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        buf.push_back((int) (dtest_random() * PERFORMANCE_TEST_SIZE));
+    }
+    auto h = Heap<int>();
+    h.pushAll(buf.begin(), buf.end());
+})
+.baseline([] {
+    std::vector<int> buf;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        buf.push_back((int) (dtest_random() * PERFORMANCE_TEST_SIZE));
+    }
+    auto h = Heap<int>();
+    for (auto x : buf) h.push(x);
+});
+
+unit("heap", "addressable-push-pop")
+.body([] {
+    auto h = AddressableHeap<int, std::greater<int>>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        h.push((int) (dtest_random() * TEST_SIZE));
+    }
+
+    int prev = h.top();
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        int x = h.pop();
+        assert(x >= prev);
+        prev = x;
+    }
+    assert(h.empty());
+});
+
+unit("heap", "addressable-update")
+.body([] {
+    auto h = AddressableHeap<int, std::greater<int>>();
+    std::vector<AddressableHeap<int, std::greater<int>>::Handle> handles;
+    std::vector<int> values;
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        values.push_back(TEST_SIZE + i);
+        handles.push_back(h.push(TEST_SIZE + i));
+    }
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        size_t k = (size_t) (dtest_random() * TEST_SIZE);
+        if (i % 2 == 0) {
+            values[k] -= (int) (dtest_random() * TEST_SIZE);
+            h.decreaseKey(handles[k], values[k]);
+        }
+        else {
+            values[k] = (int) (dtest_random() * 2 * TEST_SIZE);
+            h.update(handles[k], values[k]);
+        }
+        assert(h.get(handles[k]) == values[k]);
+    }
+
+    h.erase(handles[0]);
+    assert(! h.contains(handles[0]));
+    assert(h.remove(handles[1]) == values[1]);
+    assert(h.size() == TEST_SIZE - 2);
+
+    std::sort(values.begin() + 2, values.end());
+    for (int i = 2; i < TEST_SIZE; ++i) {
+        auto t = h.topHandle();
+        assert(h.pop() == values[i]);
+        assert(! h.contains(t));
+    }
+    assert(h.empty());
+});
+
+unit("heap", "addressable-invalid-handle")
+.expect(Status::FAIL)
+.body([] {
+    auto h = AddressableHeap<int>();
+    auto handle = h.push(1);
+    h.pop();
+    h.update(handle, 2);
+});
+
+perf("heap", "4-ary(p)")
+.performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
+.body([] {
+    auto h = Heap<int, std::less<int>, 4>();
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        h.push((int) (dtest_random() * PERFORMANCE_TEST_SIZE));
+    }
+    while (h.nonEmpty()) h.pop();
+})
+.baseline([] {
+    auto h = Heap<int>();
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        h.push((int) (dtest_random() * PERFORMANCE_TEST_SIZE));
+    }
+    while (h.nonEmpty()) h.pop();
+});
+
+unit("parallel::heap", "push-pop(single-lane)")
+.body([] {
+    parallel::RelaxedHeap<int> h(1);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        h.push((int) (dtest_random() * TEST_SIZE));
+    }
+
+    assert(h.size() == TEST_SIZE);
+
+    int prev = h.top();
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        int x = h.pop();
+        assert(x <= prev);
+        prev = x;
+    }
+
+    assert(h.empty());
+    int x = -1;
+    assert(! h.tryPop(x));
+    assert(x == -1);
+});
+
+unit("parallel::heap", "pop-empty")
+.expect(Status::FAIL)
+.body([] {
+    parallel::RelaxedHeap<int> h;
+    h.pop();
+});
+
+unit("parallel::heap", "top")
+.body([] {
+    parallel::RelaxedHeap<int> h(8);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        h << i;
+    }
+
+    assert(h.top() == TEST_SIZE - 1);
+});
+
+unit("parallel::heap", "push-pop")
+.body([] {
+    parallel::RelaxedHeap<long> h;
+
+    #pragma omp parallel for
+    for (int i = 0; i < PARALLEL_TEST_SIZE; ++i) {
+        h.push(i);
+    }
+
+    assert(h.size() == PARALLEL_TEST_SIZE);
+
+    std::atomic_long sum(0);
+    std::atomic_long count(0);
+
+    #pragma omp parallel
+    {
+        long x;
+        while (h.tryPop(x)) {
+            sum += x;
+            ++count;
+        }
+    }
+
+    assert(h.empty());
+    assert(count == PARALLEL_TEST_SIZE);
+    assert(sum == (long) PARALLEL_TEST_SIZE * (PARALLEL_TEST_SIZE - 1) / 2);
+});
+
+unit("parallel::heap", "producer-consumer")
+.dependsOn({ "list", "thread" })
+.body([] {
+    parallel::RelaxedHeap<long> h;
+    std::atomic_long sum(0);
+    std::atomic_long count(0);
+    volatile bool running = true;
+
+    List<Thread> producers;
+    for (int i = 0; i < 4; ++i) {
+        producers.insert(Thread([&h, i] {
+            for (long j = i; j < PARALLEL_TEST_SIZE; j += 4) {
+                h << j;
+            }
+        }));
+    }
+
+    List<Thread> consumers;
+    for (int i = 0; i < 4; ++i) {
+        consumers.insert(Thread([&h, &sum, &count, &running] {
+            long x;
+            while (running || h.nonEmpty()) {
+                if (h.tryPop(x)) {
+                    sum += x;
+                    ++count;
+                }
+            }
+        }));
+    }
+
+    producers.foreach([] (Thread &t) { t.join(); });
+    running = false;
+    consumers.foreach([] (Thread &t) { t.join(); });
+
+    assert(count == PARALLEL_TEST_SIZE);
+    assert(sum == (long) PARALLEL_TEST_SIZE * (PARALLEL_TEST_SIZE - 1) / 2);
+});
+
+perf("parallel::heap", "push-pop(p)")
+.performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
+.body([] {
+    parallel::RelaxedHeap<int> h;
+
+    #pragma omp parallel for
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        h.push(i);
+        if (i % 2 == 1) h.pop();
+    }
+})
+.baseline([] {
+    auto h = Heap<int>();
+    std::mutex mtx;
+
+    #pragma omp parallel for
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        std::lock_guard<std::mutex> lk(mtx);
+        h.push(i);
+        if (i % 2 == 1) h.pop();
+    }
+});
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <interned_string.h>
+#include <hash_map.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+module("interned-string")
+.dependsOn({
+    "hash",
+    "hash-map"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (10000)
+#define PERFORMANCE_TEST_SIZE (1000)
+#define PERFORMANCE_ITERATIONS (10000)
+
+unit("interned-string", "identity")
+.body([] {
+    InternedString a("some name"), b(std::string("some name")), c("some other name");
+    assert(a == b);
+    assert(a.c_str() == b.c_str());
+    assert(a != c);
+    assert(a.str() == "some name");
+    assert(a.size() == 9 && ! a.empty());
+
+    // hash codes agree with those of equal std::string keys
+    assert(( a.hash() == Hash<std::string>{}("some name") ));
+    assert(( Hash<InternedString>{}(a) == a.hash() ));
+
+    InternedString e, f("");
+    assert(e == f && e.empty() && e.size() == 0);
+    assert(*e.c_str() == '\0');
+
+    // embedded nulls are part of the contents
+    InternedString g("x\0y", 3), h("x");
+    assert(g != h && g.size() == 3);
+});
+
+unit("interned-string", "concurrent")
+.body([] {
+    size_t before = InternedString::count();
+    std::vector<std::vector<InternedString>> interned(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < interned.size(); ++t) {
+        threads.emplace_back([&interned, t] {
+            for (int i = 0; i < TEST_SIZE; ++i) {
+                interned[t].emplace_back("concurrent-" + std::to_string(i));
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        for (size_t t = 1; t < interned.size(); ++t) {
+            assert(interned[t][i] == interned[0][i]);
+        }
+        assert(interned[0][i].str() == "concurrent-" + std::to_string(i));
+    }
+    assert(InternedString::count() == before + TEST_SIZE);
+});
+
+unit("interned-string", "hash-map")
+.body([] {
+    HashMap<InternedString, int> m;
+    for (int i = 0; i < TEST_SIZE; ++i) m.put(InternedString("key-" + std::to_string(i)), i);
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(m.get(InternedString("key-" + std::to_string(i))) == i);
+    }
+    assert(! m.contains(InternedString("key-missing")));
+
+    static const InternedString key("key-17");
+    m[key] += 100;
+    assert(m.get(key) == 117);
+});
+
+perf("interned-string", "get(p)")
+.body([] {
+    HashMap<InternedString, int> m;
+    std::vector<InternedString> keys;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        keys.emplace_back("a fairly long parameter name " + std::to_string(i));
+        m.put(keys.back(), i);
+    }
+    long sum = 0;
+    for (int k = 0; k < PERFORMANCE_ITERATIONS; ++k) {
+        for (const auto &key : keys) sum += m.get(key);
+    }
+    assert(sum > 0);
+})
+.baseline([] {
+    HashMap<std::string, int> m;
+    std::vector<std::string> keys;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        keys.emplace_back("a fairly long parameter name " + std::to_string(i));
+        m.put(keys.back(), i);
+    }
+    long sum = 0;
+    for (int k = 0; k < PERFORMANCE_ITERATIONS; ++k) {
+        for (const auto &key : keys) sum += m.get(key);
+    }
+    assert(sum > 0);
+});
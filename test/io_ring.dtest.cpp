@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <io_ring.h>
+#include <file.h>
+#include <vector>
+
+module("io-ring")
+.dependsOn({
+    "exception",
+    "file"
+});
+
+using namespace spl;
+
+#define BLOCK_SIZE (4096)
+#define BLOCK_COUNT (256)
+
+static void writeAndReadBack(IORing &ring) {
+    File f("./test-io-ring");
+    f.open(File::READ_WRITE | File::CREATE);
+
+    std::vector<std::vector<int>> blocks(BLOCK_COUNT);
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+        blocks[i].assign(BLOCK_SIZE / sizeof(int), (int) i);
+        f.writeAsync(i * BLOCK_SIZE, blocks[i].data(), BLOCK_SIZE, i, ring);
+    }
+    f.syncAsync(BLOCK_COUNT, true, ring);
+
+    std::vector<bool> done(BLOCK_COUNT + 1, false);
+    IOCompletion c[16];
+    size_t count = 0;
+    while (count < BLOCK_COUNT + 1) {
+        size_t n = ring.wait(c, 16);
+        assert(n > 0);
+        for (size_t i = 0; i < n; ++i) {
+            assert(! done[c[i].tag]);
+            done[c[i].tag] = true;
+            assert(c[i].result == (c[i].tag == BLOCK_COUNT ? 0 : BLOCK_SIZE));
+        }
+        count += n;
+    }
+    assert(ring.pending() == 0);
+    assert(f.info().length() == BLOCK_COUNT * BLOCK_SIZE);
+
+    // random reads, submitted in one batch
+    std::vector<size_t> order;
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) order.push_back((i * 37) % BLOCK_COUNT);
+    std::vector<std::vector<int>> in(BLOCK_COUNT, std::vector<int>(BLOCK_SIZE / sizeof(int)));
+    for (auto i : order) {
+        f.readAsync(i * BLOCK_SIZE, in[i].data(), BLOCK_SIZE, i, ring);
+    }
+    ring.submit();
+
+    count = 0;
+    while (count < BLOCK_COUNT) {
+        size_t n = ring.wait(c, 16, 4);
+        for (size_t i = 0; i < n; ++i) {
+            assert(c[i].result == BLOCK_SIZE);
+            assert(in[c[i].tag] == blocks[c[i].tag]);
+        }
+        count += n;
+    }
+    assert(ring.poll(c, 16) == 0);
+
+    f.close();
+    remove("./test-io-ring");
+}
+
+unit("io-ring", "read-write")
+.body([] {
+    IORing ring(16);
+    writeAndReadBack(ring);
+});
+
+unit("io-ring", "read-write-synchronous")
+.body([] {
+    IORing ring(16, true);
+    assert(! ring.asynchronous());
+    writeAndReadBack(ring);
+});
+
+unit("io-ring", "local")
+.body([] {
+    assert(&IORing::local() == &IORing::local());
+    writeAndReadBack(IORing::local());
+});
+
+unit("io-ring", "allocate")
+.body([] {
+    File f("./test-io-ring");
+    f.open(File::READ_WRITE | File::CREATE);
+
+    IORing ring;
+    f.allocateAsync(0, 1024 * 1024, 7, ring);
+
+    IOCompletion c;
+    assert(ring.wait(&c, 1) == 1);
+    assert(c.tag == 7);
+    assert(c.result == 0);
+    assert(f.info().length() == 1024 * 1024);
+
+    f.close();
+    remove("./test-io-ring");
+});
+
+unit("io-ring", "error")
+.body([] {
+    for (int synchronous = 0; synchronous < 2; ++synchronous) {
+        IORing ring(8, synchronous);
+        char buf[16];
+        ring.read(-1, 0, buf, sizeof(buf), 1);
+
+        IOCompletion c;
+        assert(ring.wait(&c, 1) == 1);
+        assert(c.tag == 1);
+        assert(c.result == -EBADF);
+    }
+});
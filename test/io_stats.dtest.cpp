@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <io_stats.h>
+#include <file.h>
+#include <tcp_socket.h>
+#include <json.h>
+#include <cstring>
+#include <thread>
+
+module("io-stats")
+.dependsOn({
+    "file",
+    "file-serializer",
+    "tcp-socket",
+    "json",
+});
+
+using namespace spl;
+
+#define TEST_SIZE (10240)
+
+// other tests may do I/O concurrently, so only lower bounds on the change in
+// the counters are checked
+
+unit("io-stats", "file")
+.body([] {
+    IOStats::setEnabled(true);
+    IOStats::Snapshot before = IOStats::snapshot();
+
+    File f("./test-io-stats");
+    f.open(File::READ_WRITE | File::CREATE);
+
+    char *a = new char[TEST_SIZE];
+    memset(a, 1, TEST_SIZE);
+    f.write(a, TEST_SIZE);
+    f.close();
+
+    char *b = new char[TEST_SIZE];
+    assert(f.read(b, TEST_SIZE) == TEST_SIZE);
+    f.close();
+
+    IOStats::Snapshot after = IOStats::snapshot();
+    IOStats::setEnabled(false);
+
+    const IOPathStats &w0 = before[IOPath::FILE_WRITE], &w1 = after[IOPath::FILE_WRITE];
+    assert(w1.operations >= w0.operations + 1);
+    assert(w1.syscalls >= w0.syscalls + 1);
+    assert(w1.bytes >= w0.bytes + TEST_SIZE);
+    assert(w1.latency.count() >= w0.latency.count() + 1);
+
+    const IOPathStats &r0 = before[IOPath::FILE_READ], &r1 = after[IOPath::FILE_READ];
+    assert(r1.operations >= r0.operations + 1);
+    assert(r1.bytes >= r0.bytes + TEST_SIZE);
+
+    delete[] a;
+    delete[] b;
+    remove("./test-io-stats");
+});
+
+unit("io-stats", "disabled")
+.body([] {
+    IOStats::setEnabled(false);
+    IOStats::Snapshot before = IOStats::snapshot();
+
+    // counters of this thread only change while enabled, and are folded into
+    // the totals when the thread exits
+    std::thread t([] {
+        File f("./test-io-stats-disabled");
+        f.open(File::READ_WRITE | File::CREATE);
+        int x = 1;
+        f.write(&x, sizeof(x));
+        remove("./test-io-stats-disabled");
+    });
+    t.join();
+
+    IOStats::Snapshot after = IOStats::snapshot();
+    assert(! IOStats::enabled());
+    assert(after[IOPath::FILE_WRITE].operations >= before[IOPath::FILE_WRITE].operations);
+});
+
+unit("io-stats", "tcp")
+.body([] {
+    IOStats::setEnabled(true);
+    IOStats::Snapshot before = IOStats::snapshot();
+
+    TCPServerSocket s(0, 128);
+    TCPSocket c(s.address());
+    auto conn = s.accept();
+
+    char *a = new char[TEST_SIZE];
+    memset(a, 2, TEST_SIZE);
+    c.send(a, TEST_SIZE);
+
+    char *b = new char[TEST_SIZE];
+    conn.recv(b, TEST_SIZE);
+    assert(memcmp(a, b, TEST_SIZE) == 0);
+
+    IOStats::Snapshot after = IOStats::snapshot();
+    IOStats::setEnabled(false);
+
+    const IOPathStats &s0 = before[IOPath::TCP_SEND], &s1 = after[IOPath::TCP_SEND];
+    assert(s1.operations >= s0.operations + 1);
+    assert(s1.bytes >= s0.bytes + TEST_SIZE);
+
+    const IOPathStats &r0 = before[IOPath::TCP_RECV], &r1 = after[IOPath::TCP_RECV];
+    assert(r1.operations >= r0.operations + 1);
+    assert(r1.syscalls >= r0.syscalls + 1);
+    assert(r1.bytes >= r0.bytes + TEST_SIZE);
+
+    delete[] a;
+    delete[] b;
+});
+
+unit("io-stats", "serializer")
+.body([] {
+    IOStats::setEnabled(true);
+    IOStats::Snapshot before = IOStats::snapshot();
+
+    File f("./test-io-stats-serializer");
+    f.open(File::READ_WRITE | File::CREATE);
+    f.close();
+
+    OutputFileSerializer out(f);
+    for (int i = 0; i < TEST_SIZE; ++i) out << i;
+    out.flush();
+
+    InputFileSerializer in(f);
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        int x;
+        in >> x;
+        assert(x == i);
+    }
+
+    IOStats::Snapshot after = IOStats::snapshot();
+    IOStats::setEnabled(false);
+
+    const IOPathStats &f0 = before[IOPath::SERIALIZER_FLUSH], &f1 = after[IOPath::SERIALIZER_FLUSH];
+    assert(f1.operations >= f0.operations + 1);
+    assert(f1.bytes >= f0.bytes + sizeof(int) * TEST_SIZE);
+
+    const IOPathStats &r0 = before[IOPath::SERIALIZER_FILL], &r1 = after[IOPath::SERIALIZER_FILL];
+    assert(r1.operations >= r0.operations + 1);
+    assert(r1.bytes >= r0.bytes + sizeof(int) * TEST_SIZE);
+
+    remove("./test-io-stats-serializer");
+});
+
+unit("io-stats", "dump")
+.body([] {
+    std::string s = IOStats::dump();
+    assert(s.find("\"enabled\"") != std::string::npos);
+    for (size_t p = 0; p < IOStats::PATHS; ++p) {
+        std::string name = std::string("\"") + IOStats::name((IOPath) p) + "\"";
+        assert(s.find(name) != std::string::npos);
+    }
+    assert(s.find("\"p99_ns\"") != std::string::npos);
+    assert(s.find("\"blocked_ns\"") != std::string::npos);
+});
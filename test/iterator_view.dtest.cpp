@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <iterator_view.h>
+#include <list.h>
+#include <hash_map.h>
+#include <vector>
+
+module("iterator-view")
+.dependsOn({
+    "list",
+    "hash-map"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (1024)
+
+unit("iterator-view", "filter")
+.body([] {
+    std::vector<int> v;
+    for (int i = 0; i < TEST_SIZE; ++i) v.push_back(i);
+
+    int i = 0;
+    view(v.begin(), v.end())
+        .filter([] (int x) { return x % 3 == 0; })
+        .foreach([&i] (int x) { assert(x == i); i += 3; });
+    assert(i == TEST_SIZE + 2);
+
+    assert(view(v.begin(), v.end()).filter([] (int) { return false; }).count() == 0);
+});
+
+unit("iterator-view", "transform")
+.body([] {
+    List<int> l;
+    for (int i = 0; i < TEST_SIZE; ++i) l.append(i);
+
+    int i = 0;
+    for (auto x : l.view().transform([] (int x) { return 2 * x; })) {
+        assert(x == 2 * i++);
+    }
+    assert(i == TEST_SIZE);
+
+    // elements can be updated through a non-const view
+    l.view().foreach([] (int &x) { ++x; });
+    assert(l.front() == 1);
+});
+
+unit("iterator-view", "take")
+.body([] {
+    List<int> l;
+    for (int i = 0; i < TEST_SIZE; ++i) l.append(i);
+
+    assert(l.view().take(10).count() == 10);
+    assert(l.view().take(0).count() == 0);
+    assert(l.view().take(2 * TEST_SIZE).count() == TEST_SIZE);
+
+    auto sum = l.view().filter([] (int x) { return x % 2 == 1; }).take(3).reduce<int>(
+        [] (int acc, int x) { return acc + x; }
+    );
+    assert(sum == 1 + 3 + 5);
+});
+
+unit("iterator-view", "zip")
+.body([] {
+    List<int> a, b;
+    for (int i = 0; i < TEST_SIZE; ++i) a.append(i);
+    for (int i = 0; i < TEST_SIZE / 2; ++i) b.append(-i);
+
+    size_t count = 0;
+    a.view().zip(b).foreach([&count] (std::pair<const int &, const int &> p) {
+        assert(p.first == -p.second);
+        ++count;
+    });
+    assert(count == TEST_SIZE / 2);
+
+    assert(b.view().zip(a).count() == TEST_SIZE / 2);
+});
+
+unit("iterator-view", "chunk")
+.body([] {
+    std::vector<int> v;
+    for (int i = 0; i < 10; ++i) v.push_back(i);
+
+    std::vector<size_t> sizes;
+    int next = 0;
+    for (auto c : view(v.begin(), v.end()).chunk(4)) {
+        sizes.push_back(c.count());
+        for (int x : c) assert(x == next++);
+    }
+    assert(next == 10);
+    assert(sizes.size() == 3);
+    assert(sizes[0] == 4 && sizes[1] == 4 && sizes[2] == 2);
+
+    assert(view(v.begin(), v.begin()).chunk(4).count() == 0);
+});
+
+unit("iterator-view", "hash-map-pipeline")
+.body([] {
+    HashMap<int, int> m;
+    for (int i = 0; i < TEST_SIZE; ++i) m.put(i, i);
+
+    auto sum = m.view()
+        .filter([] (const MapNode<int, int> &n) { return n.k % 2 == 0; })
+        .transform([] (const MapNode<int, int> &n) { return (long) n.v * 10; })
+        .reduce<long>([] (long acc, long x) { return acc + x; });
+
+    long expected = 0;
+    for (int i = 0; i < TEST_SIZE; i += 2) expected += 10L * i;
+    assert(sum == expected);
+
+    auto l = m.view().filter([] (const MapNode<int, int> &n) { return n.k < 10; })
+        .transform([] (const MapNode<int, int> &n) { return n.k; })
+        .to<List<int>>();
+    assert(l.size() == 10);
+});
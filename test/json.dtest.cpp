@@ -5,6 +5,7 @@
 
 #include <dtest.h>
 #include <json.h>
+#include "test_serializers.cpp"
 
 module("json")
 .dependsOn({
@@ -16,6 +17,15 @@ module("json")
 
 using namespace spl;
 
+// hash maps encode their entries in iteration order, which depends on the hash
+// function, so maps of several entries may match any of a few encodings
+static bool __encodedAsOneOf(const std::string &s, std::initializer_list<const char *> options) {
+    for (const char *o : options) {
+        if (s == o) return true;
+    }
+    return false;
+}
+
 unit("json", "encode-uint32")
 .body([] {
     assert(JSON::encode((uint32) 123) == "123");
@@ -38,6 +48,13 @@ unit("json", "decode-uint32")
     catch (const JSONDecodeError &e) { }
 });
 
+unit("json", "encode-float64")
+.body([] {
+    assert(JSON::encode((float64) 0.1) == "0.1");
+    assert(JSON::encode((float64) -2.5e-7) == "-2.5e-7");
+    assert(JSON::decode<float64>(JSON::encode((float64) 123.25)) == 123.25);
+});
+
 unit("json", "encode-bool")
 .body([] {
     assert(JSON::encode(true) == "true");
@@ -118,7 +135,7 @@ unit("json", "encode-list")
         "]"
     );
 
-    assert(JSON::encode(List<HashMap<std::string, int>>({
+    assert(__encodedAsOneOf(JSON::encode(List<HashMap<std::string, int>>({
         {
             { "prop1", 1 },
             { "prop2", 2 },
@@ -129,7 +146,7 @@ unit("json", "encode-list")
         {
             { "prop2", 2 },
         }
-    })) == 
+    })), {
         "[\n"
         "  {\n"
         "    \"prop1\": 1,\n"
@@ -139,8 +156,18 @@ unit("json", "encode-list")
         "  {\n"
         "    \"prop2\": 2\n"
         "  }\n"
+        "]",
+        "[\n"
+        "  {\n"
+        "    \"prop2\": 2,\n"
+        "    \"prop1\": 1\n"
+        "  },\n"
+        "  { },\n"
+        "  {\n"
+        "    \"prop2\": 2\n"
+        "  }\n"
         "]"
-    );
+    }));
 });
 
 unit("json", "decode-list")
@@ -208,20 +235,24 @@ unit("json", "encode-map")
         { "prop1", 1 }
     })) == "{\n  \"prop1\": 1\n}");
 
-    assert(JSON::encode(HashMap<std::string, int>({
+    assert(__encodedAsOneOf(JSON::encode(HashMap<std::string, int>({
         { "prop1", 1 },
         { "prop2", 2 }
-    })) == 
+    })), {
         "{\n"
         "  \"prop1\": 1,\n"
         "  \"prop2\": 2\n"
+        "}",
+        "{\n"
+        "  \"prop2\": 2,\n"
+        "  \"prop1\": 1\n"
         "}"
-    );
+    }));
 
-    assert(JSON::encode(HashMap<std::string, List<int>>({
+    assert(__encodedAsOneOf(JSON::encode(HashMap<std::string, List<int>>({
         { "prop1", { 1 } },
         { "prop2", { 1, 2 } }
-    })) == 
+    })), {
         "{\n"
         "  \"prop1\": [\n"
         "    1\n"
@@ -230,8 +261,17 @@ unit("json", "encode-map")
         "    1,\n"
         "    2\n"
         "  ]\n"
+        "}",
+        "{\n"
+        "  \"prop2\": [\n"
+        "    1,\n"
+        "    2\n"
+        "  ],\n"
+        "  \"prop1\": [\n"
+        "    1\n"
+        "  ]\n"
         "}"
-    );
+    }));
 });
 
 unit("json", "decode-map")
@@ -287,3 +327,192 @@ unit("json", "decode-map")
     }
     catch (const JSONDecodeError &) { }
 });
+
+unit("json", "reader")
+.body([] {
+    JSONReader r("{ \"a\": [ 1, -2.5, true, null ], \"b\": \"x\\\"y\", \"c\": { } }");
+
+    assert(r.next() == JSONReader::BEGIN_OBJECT);
+    assert(r.next() == JSONReader::KEY);
+    assert(r.value() == "a");
+    assert(r.next() == JSONReader::BEGIN_ARRAY);
+    assert(r.depth() == 2);
+    assert(r.next() == JSONReader::NUMBER);
+    assert(r.number<int>() == 1);
+    assert(r.next() == JSONReader::NUMBER);
+    assert(r.number<double>() == -2.5);
+    assert(r.next() == JSONReader::BOOLEAN);
+    assert(r.boolean());
+    assert(r.next() == JSONReader::NULL_VALUE);
+    assert(r.next() == JSONReader::END_ARRAY);
+    assert(r.next() == JSONReader::KEY);
+    assert(r.value() == "b");
+    assert(r.next() == JSONReader::STRING);
+    assert(r.value() == "x\"y");
+    assert(r.next() == JSONReader::KEY);
+    assert(r.value() == "c");
+    assert(r.next() == JSONReader::BEGIN_OBJECT);
+    assert(r.next() == JSONReader::END_OBJECT);
+    assert(r.next() == JSONReader::END_OBJECT);
+    assert(r.depth() == 0);
+    assert(r.next() == JSONReader::END);
+});
+
+unit("json", "reader-zero-copy")
+.body([] {
+    const char *str = "[ \"hello\", \"a\\u00e9\\ud83d\\ude00\" ]";
+    JSONReader r(str);
+
+    assert(r.next() == JSONReader::BEGIN_ARRAY);
+    assert(r.next() == JSONReader::STRING);
+    assert(r.value().data == str + 3);
+    assert(r.value().len == 5);
+
+    assert(r.next() == JSONReader::STRING);
+    assert(r.value() == "a\xc3\xa9\xf0\x9f\x98\x80");
+});
+
+unit("json", "reader-chunks")
+.body([] {
+    std::string str = "{ \"key\": [ 12345, \"a\\nb\", false, null ], \"k2\": -7 }";
+
+    // feed one byte at a time, so that every token is split
+    JSONReader r;
+    std::string events;
+    size_t i = 0;
+    while (true) {
+        auto e = r.next();
+        if (e == JSONReader::NEED_MORE) {
+            if (i == str.size()) {
+                r.end();
+            }
+            else {
+                r.feed(str.data() + i++, 1);
+            }
+            continue;
+        }
+        if (e == JSONReader::END) break;
+
+        switch (e) {
+        case JSONReader::KEY:
+        case JSONReader::STRING:
+        case JSONReader::NUMBER:
+            events += r.value().str() + ";";
+            break;
+        default:
+            events += std::to_string(e) + ";";
+        }
+    }
+
+    assert(events == "0;key;2;12345;a\nb;7;8;3;k2;-7;1;");
+});
+
+unit("json", "reader-errors")
+.body([] {
+    const char *bad[] = {
+        "",
+        "[ 1, ]",
+        "{ \"a\" 1 }",
+        "{ 1: 2 }",
+        "[ 1 }",
+        "[ tru ]",
+        "\"a\\x\"",
+        "1 2",
+        "[ 1",
+    };
+
+    for (auto str : bad) {
+        try {
+            JSONReader r(str);
+            while (r.next() != JSONReader::END);
+            fail("Invalid JSON parsed");
+        }
+        catch (const JSONDecodeError &) { }
+    }
+});
+
+unit("json", "long-strings")
+.body([] {
+    // escapes at every offset of a block, so that each lane of the bulk
+    // scan is exercised
+    for (size_t i = 0; i < 100; ++i) {
+        std::string str(100, 'a');
+        str[i] = (i % 3 == 0) ? '"' : (i % 3 == 1) ? '\\' : '\x01';
+
+        auto encoded = JSON::encode(str);
+        assert(JSON::decode<std::string>(encoded) == str);
+
+        JSONReader r(encoded.c_str());
+        assert(r.next() == JSONReader::STRING);
+        assert(r.value().str() == str);
+    }
+
+    assert(JSON::encode(std::string("\x1f\0", 2)) == "\"\\u001f\\u0000\"");
+
+    std::string indented = "[" + std::string(100, ' ') + "1" + std::string(100, '\n') + "]";
+    auto l = JSON::decode<List<int>>(indented);
+    assert(l.size() == 1);
+    assert(*l.begin() == 1);
+});
+
+unit("json", "writer")
+.body([] {
+    std::string out = "prefix ";
+    JSONWriter w(out);
+    w.beginObject()
+        .key("a").value(1)
+        .key("b").beginArray()
+            .value("x")
+            .value(true)
+            .null()
+            .beginObject().endObject()
+        .endArray()
+        .key("c").value(HashMap<std::string, List<int>>({ { "d", { 2 } } }))
+    .endObject();
+
+    assert(out ==
+        "prefix {\n"
+        "  \"a\": 1,\n"
+        "  \"b\": [\n"
+        "    \"x\",\n"
+        "    true,\n"
+        "    null,\n"
+        "    { }\n"
+        "  ],\n"
+        "  \"c\": {\n"
+        "    \"d\": [\n"
+        "      2\n"
+        "    ]\n"
+        "  }\n"
+        "}"
+    );
+
+    std::string appended;
+    JSON::encode(List<int>({ 1, 2 }), appended);
+    JSON::encode("s", appended);
+    assert(appended == JSON::encode(List<int>({ 1, 2 })) + "\"s\"");
+});
+
+unit("json", "writer-serializer")
+.body([] {
+    List<std::string> l;
+    for (int i = 0; i < 1000; ++i) l.append(std::to_string(i));
+
+    MemoryOutputStreamSerializer out;
+    {
+        // a small threshold so that output is put into the serializer while
+        // it is produced
+        JSONWriter w(out, 64);
+        w.value(l);
+    }
+    out.flush();
+
+    auto expected = JSON::encode(l);
+    auto in = out.toInput();
+    std::string str(expected.size(), '\0');
+    in->get(&str[0], str.size());
+    delete in;
+
+    assert(str == expected);
+    assert(JSON::decode<List<std::string>>(str).size() == 1000);
+});
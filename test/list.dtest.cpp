@@ -6,8 +6,11 @@
 #include <dtest.h>
 
 #include <list.h>
+#include <thread.h>
 #include <forward_list>
 #include <list>
+#include <random>
+#include <utility>
 
 module("list")
 .dependsOn({
@@ -787,3 +790,154 @@ unit("list", "reduce")
     assert(typeid(sum2) == typeid(long));
     assert(sum2 == sum);
 });
+
+unit("list", "parallel-foreach-map-reduce")
+.body([] {
+    auto l = List<int>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        i >> l;
+    }
+
+    l.parallelForeach([] (int &x) { x *= 2; });
+
+    int i = TEST_SIZE - 1;
+    l.foreach([&i] (int x) { assert(x == i-- * 2); });
+    assert(i == -1);
+
+    auto l2 = l.parallelMap([] (int x) { return x / 2; });
+    assert(l2.size() == TEST_SIZE);
+
+    // partitions are mapped in order, so the element order is preserved
+    i = TEST_SIZE - 1;
+    l2.foreach([&i] (int x) { assert(x == i--); });
+    assert(i == -1);
+
+    auto sum = l2.parallelReduce<long>([] (long x, long y) { return x + y; });
+    assert(sum == (long)(TEST_SIZE * (TEST_SIZE - 1) / 2));
+
+    auto sum2 = l2.parallelReduce<long>(
+        [] (int x) { return (long) x; },
+        [] (long acc, int x) { return acc + x; },
+        [] (long x, long y) { return x + y; },
+        3
+    );
+    assert(sum2 == sum);
+
+    assert(List<int>().parallelReduce<long>([] (long x, long y) { return x + y; }) == 0);
+});
+
+unit("list", "node-reuse")
+.body([] {
+    auto l = List<long>();
+    for (long i = 0; i < TEST_SIZE; ++i) l.append(i);
+    const long *first = &l.front();
+    l.clear();
+
+    // freed nodes are handed out again, most recently freed first
+    bool reused = false;
+    for (long i = 0; i < TEST_SIZE; ++i) {
+        l.prepend(i);
+        if (&l.front() == first) reused = true;
+    }
+    assert(reused);
+});
+
+unit("list", "cross-thread-nodes")
+.dependsOn({ "thread" })
+.body([] {
+    for (int round = 0; round < 10; ++round) {
+        List<long> *l = new List<long>();
+        Thread([l] {
+            for (long i = 0; i < TEST_SIZE; ++i) l->append(i);
+        }).join();
+
+        long sum = 0;
+        Thread([l, &sum] {
+            for (auto &x : *l) sum += x;
+            delete l;
+        }).join();
+
+        assert(sum == (long)(TEST_SIZE * (TEST_SIZE - 1) / 2));
+    }
+});
+
+unit("list", "sort")
+.body([] {
+    auto l = List<std::pair<int, int>>();
+    std::mt19937 rng(1);
+    for (int i = 0; i < TEST_SIZE; ++i) l.append(std::make_pair((int) (rng() % 64), i));
+    const std::pair<int, int> *first = &l.front();
+
+    l.sort([] (const std::pair<int, int> &x, const std::pair<int, int> &y) {
+        return x.first < y.first;
+    });
+    assert(l.size() == TEST_SIZE);
+    assert((ListTester<List<std::pair<int, int>>>::validTail(l)));
+
+    // equal keys keep their order, and elements stay in their nodes
+    bool found = false;
+    const std::pair<int, int> *prev = nullptr;
+    for (const auto &x : l) {
+        if (prev != nullptr) {
+            assert(prev->first < x.first || (prev->first == x.first && prev->second < x.second));
+        }
+        if (&x == first) found = true;
+        prev = &x;
+    }
+    assert(found);
+
+    l.append(std::make_pair(-1, 0));
+    assert(l.back().first == -1);
+
+    auto empty = List<int>();
+    empty.sort();
+    assert(empty.empty());
+
+    auto one = List<int>({ 1 });
+    one.sort().append(2);
+    assert(one.front() == 1 && one.back() == 2);
+});
+
+unit("parallel::list", "sort")
+.body([] {
+    auto l = parallel::List<int>();
+    for (int i = 0; i < TEST_SIZE + 3; ++i) l.append((i * 7919) % (TEST_SIZE + 3));
+
+    l.sort(std::greater<int>());
+    int expected = TEST_SIZE + 2;
+    for (int x : l) assert(x == expected--);
+    assert(expected == -1);
+    assert(parallel::ListTester<parallel::List<int>>::validTail(l));
+    assert(l.back() == 0);
+});
+
+perf("list", "sort(p)")
+.body([] {
+    auto l = List<long>();
+    std::mt19937 rng(3);
+    for (long i = 0; i < PERFORMANCE_TEST_SIZE; ++i) l.append(rng());
+    l.sort();
+})
+.baseline([] {
+    auto l = std::list<long>();
+    std::mt19937 rng(3);
+    for (long i = 0; i < PERFORMANCE_TEST_SIZE; ++i) l.push_back(rng());
+    l.sort();
+});
+
+perf("list", "append-clear")
+.body([] {
+    auto l = List<long>();
+    for (int r = 0; r < 100; ++r) {
+        for (long i = 0; i < TEST_SIZE; ++i) l.append(i);
+        l.clear();
+    }
+})
+.baseline([] {
+    auto l = std::forward_list<long>();
+    for (int r = 0; r < 100; ++r) {
+        for (long i = 0; i < TEST_SIZE; ++i) l.push_front(i);
+        l.clear();
+    }
+});
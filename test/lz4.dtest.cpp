@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <lz4.h>
+#include <vector>
+#include <string>
+#include <cstring>
+
+module("lz4")
+.dependsOn({
+    "exception"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (64 * 1024)
+
+static std::vector<uint8_t> roundTrip(const std::vector<uint8_t> &data, size_t &compressedSize) {
+    std::vector<uint8_t> packed(LZ4::compressBound(data.size()));
+    compressedSize = LZ4::compress(data.data(), data.size(), packed.data(), packed.size());
+    assert(compressedSize > 0);
+
+    std::vector<uint8_t> out(data.size());
+    size_t len = LZ4::decompress(packed.data(), compressedSize, out.data(), out.size());
+    assert(len == data.size());
+    return out;
+}
+
+unit("lz4", "small")
+.body([] {
+    for (size_t n = 0; n < 64; ++n) {
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < n; ++i) data.push_back(i % 3);
+
+        size_t compressedSize;
+        assert(roundTrip(data, compressedSize) == data);
+    }
+});
+
+unit("lz4", "compressible")
+.body([] {
+    std::vector<uint8_t> data;
+    std::string word = "the quick brown fox jumps over the lazy dog ";
+    while (data.size() < TEST_SIZE) {
+        data.insert(data.end(), word.begin(), word.end());
+        data.push_back('0' + dtest_random() * 10);
+    }
+
+    size_t compressedSize;
+    assert(roundTrip(data, compressedSize) == data);
+    assert(compressedSize < data.size() / 4);
+});
+
+unit("lz4", "runs")
+.body([] {
+    std::vector<uint8_t> data(TEST_SIZE, 'a');
+    for (size_t i = 0; i < data.size(); i += 1000) data[i] = 'b';
+
+    size_t compressedSize;
+    assert(roundTrip(data, compressedSize) == data);
+    assert(compressedSize < data.size() / 50);
+});
+
+unit("lz4", "incompressible")
+.body([] {
+    std::vector<uint8_t> data;
+    for (size_t i = 0; i < TEST_SIZE; ++i) data.push_back(dtest_random() * 256);
+
+    size_t compressedSize;
+    assert(roundTrip(data, compressedSize) == data);
+    assert(compressedSize <= LZ4::compressBound(data.size()));
+
+    std::vector<uint8_t> packed(data.size());
+    assert(LZ4::compress(data.data(), data.size(), packed.data(), data.size() / 2) == 0);
+});
+
+unit("lz4", "malformed")
+.expect(Status::FAIL)
+.body([] {
+    std::vector<uint8_t> data(TEST_SIZE, 'a');
+    std::vector<uint8_t> packed(LZ4::compressBound(data.size()));
+    size_t compressedSize = LZ4::compress(data.data(), data.size(), packed.data(), packed.size());
+
+    std::vector<uint8_t> out(data.size() / 2);
+    LZ4::decompress(packed.data(), compressedSize, out.data(), out.size());
+});
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <mapped_hash_map.h>
+#include <hash_map.h>
+#include <cstdio>
+
+module("mapped-hash-map")
+.dependsOn({
+    "file",
+    "hash-map"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (64 * 1024)
+#define PERFORMANCE_ITERATIONS (1024 * 1024)
+
+static File emptyFile(const char *path) {
+    File f(path);
+    f.open(File::READ_WRITE | File::CREATE);
+    f.truncate(0);
+    f.close();
+    return f;
+}
+
+unit("mapped-hash-map", "put-get")
+.body([] {
+    File f = emptyFile("./test-mapped-map");
+
+    MappedHashMap<int, long> m(f);
+    assert(m.empty());
+
+    // grows through several resizes
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, -i);
+    }
+    m.put(7, 8);
+
+    assert(m.size() == TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        assert(m.get(i) == (i == 7 ? 8 : -i));
+    }
+    assert(! m.contains(-1));
+    assert(m.find(-1) == nullptr);
+    assert(m.getOr(-1, 5) == 5);
+
+    bool thrown = false;
+    try {
+        m.get(-1);
+    }
+    catch (const ElementNotFoundError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    for (int i = 0; i < TEST_SIZE; i += 2) {
+        assert(m.erase(i));
+    }
+    assert(! m.erase(0));
+    assert(m.size() == TEST_SIZE / 2);
+
+    size_t count = 0;
+    m.foreach([&] (const MapNode<int, long> &n) {
+        assert(n.k % 2 == 1);
+        assert(n.v == (n.k == 7 ? 8 : -n.k));
+        ++count;
+    });
+    assert(count == TEST_SIZE / 2);
+
+    remove("./test-mapped-map");
+});
+
+unit("mapped-hash-map", "reopen")
+.body([] {
+    File f = emptyFile("./test-mapped-map");
+
+    {
+        MappedHashMap<int, long> m(f);
+        m.reserve(TEST_SIZE);
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            m.put(i, 2 * i);
+        }
+        m.erase(0);
+        m.sync(true);
+    }
+
+    {
+        MappedHashMap<int, long> m(f);
+        assert(m.size() == TEST_SIZE - 1);
+        assert(! m.contains(0));
+        for (int i = 1; i < TEST_SIZE; ++i) {
+            assert(*m.find(i) == 2 * i);
+        }
+        m.put(-1, -1);
+    }
+
+    // read-only replicas share the file
+    MappedHashMap<int, long> r1(f, false), r2(f, false);
+    assert(! r1.writeable());
+    assert(r1.size() == TEST_SIZE && r2.size() == TEST_SIZE);
+    assert(r1.get(-1) == -1 && r2.get(TEST_SIZE - 1) == 2 * (TEST_SIZE - 1));
+
+    bool thrown = false;
+    try {
+        r1.put(1, 1);
+    }
+    catch (const UnsupportedError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    remove("./test-mapped-map");
+});
+
+unit("mapped-hash-map", "invalid-file")
+.body([] {
+    File f = emptyFile("./test-mapped-map");
+
+    {
+        MappedHashMap<int, long> m(f);
+        m.put(1, 1);
+    }
+
+    bool thrown = false;
+    try {
+        MappedHashMap<int, int> m(f);
+    }
+    catch (const InvalidArgument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    f.open();
+    f.write(0, "garbage", 7);
+    f.close();
+
+    thrown = false;
+    try {
+        MappedHashMap<int, long> m(f);
+    }
+    catch (const InvalidArgument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    remove("./test-mapped-map");
+});
+
+perf("mapped-hash-map", "reopen")
+.body([] {
+    File f = emptyFile("./test-mapped-map");
+    {
+        MappedHashMap<int, long> m(f);
+        for (int i = 0; i < PERFORMANCE_ITERATIONS; ++i) m.put(i, i);
+    }
+
+    // opening is a mapping; only the looked up pages are read
+    MappedHashMap<int, long> m(f, false);
+    for (int i = 0; i < 1000; ++i) assert(m.get(i * 997) == i * 997);
+
+    remove("./test-mapped-map");
+})
+.baseline([] {
+    HashMap<int, long> m;
+    for (int i = 0; i < PERFORMANCE_ITERATIONS; ++i) m.put(i, i);
+
+    HashMap<int, long> m2(m);
+    for (int i = 0; i < 1000; ++i) assert(m2.get(i * 997) == i * 997);
+});
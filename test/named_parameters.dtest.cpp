@@ -43,3 +43,62 @@ unit("named-parameters", "reset")
     assert(p.get<std::string>("a") == "default");
     assert(! p.isSet("a"));
 });
+
+unit("named-parameters", "bind")
+.body([] {
+    NamedParameters p;
+    p.addParameter("a", 1);
+    p.addParameter("b", "default");
+
+    auto a = p.bind<int>("a");
+    auto b = p.bind<std::string>("b");
+    assert(a.get() == 1);
+    assert(b.get() == "default");
+
+    p.set("a", 2);
+    assert(a.get() == 2);
+    p.reset("a");
+    assert(a == 1);
+
+    NamedParameters q;
+    q.addParameter("a", 3);
+    q.addParameter("b", "other");
+    p = q;
+    assert(a.get() == 3);
+    assert(b.get() == "other");
+
+    bool thrown = false;
+    try {
+        p.bind<int>("c");
+    }
+    catch (const ElementNotFoundError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    thrown = false;
+    try {
+        p.bind<int>("b");
+    }
+    catch (const InvalidArgument &) {
+        thrown = true;
+    }
+    assert(thrown);
+});
+
+perf("named-parameters", "bound-get(p)")
+.body([] {
+    NamedParameters p;
+    p.addParameter("timeout", 30);
+    auto timeout = p.bind<int>("timeout");
+    long sum = 0;
+    for (int i = 0; i < 1000000; ++i) sum += timeout.get();
+    assert(sum == 30000000);
+})
+.baseline([] {
+    NamedParameters p;
+    p.addParameter("timeout", 30);
+    long sum = 0;
+    for (int i = 0; i < 1000000; ++i) sum += p.get<int>("timeout");
+    assert(sum == 30000000);
+});
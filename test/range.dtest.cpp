@@ -5,9 +5,38 @@
 
 #include <dtest.h>
 #include <range.h>
+#include <vector>
+#include <cstdlib>
 
 using namespace spl;
 
+#define TEST_SIZE (4096)
+
+static std::vector<Interval<int>> randomIntervals(size_t n, int domain) {
+    std::vector<Interval<int>> v;
+    for (size_t i = 0; i < n; ++i) {
+        int start = rand() % domain;
+        v.push_back({ start, start + 1 + rand() % 16 });
+    }
+    return v;
+}
+
+template <typename F>
+static bool matches(const Range<int> &r, int domain, F f) {
+    // intervals are sorted, disjoint, and not adjacent, and cover exactly the
+    // values accepted by f
+    const Interval<int> *prev = nullptr;
+    for (const auto &i : r) {
+        if (! (i.start < i.end)) return false;
+        if (prev != nullptr && ! (prev->end < i.start)) return false;
+        prev = &i;
+    }
+    for (int x = -1; x < domain + 32; ++x) {
+        if (r.contains(x) != f(x)) return false;
+    }
+    return true;
+}
+
 unit("range", "insert")
 .body([] {
 
@@ -619,3 +648,47 @@ unit("range", "difference-6")
 
     assert(it == r.end());
 });
+
+unit("range", "insert-all")
+.body([] {
+    constexpr int domain = 8 * TEST_SIZE;
+    auto batch1 = randomIntervals(TEST_SIZE, domain);
+    auto batch2 = randomIntervals(TEST_SIZE, domain);
+
+    Range<int> r1, r2;
+    for (const auto &i : batch1) r1.insert(i);
+    for (const auto &i : batch2) r1.insert(i);
+    r2.insertAll(batch1.begin(), batch1.end());
+    r2.insertAll(batch2.begin(), batch2.end());
+
+    assert(r1.size() == r2.size());
+    auto it1 = r1.begin(), it2 = r2.begin();
+    for (; it1 != r1.end(); ++it1, ++it2) {
+        assert(it1->start == it2->start);
+        assert(it1->end == it2->end);
+    }
+    assert(it2 == r2.end());
+});
+
+unit("range", "union-difference-random")
+.body([] {
+    constexpr int domain = 4 * TEST_SIZE;
+    auto batch1 = randomIntervals(TEST_SIZE / 4, domain);
+    auto batch2 = randomIntervals(TEST_SIZE / 4, domain);
+
+    Range<int> r1, r2;
+    r1.insertAll(batch1.begin(), batch1.end());
+    r2.insertAll(batch2.begin(), batch2.end());
+
+    std::vector<bool> in1(domain + 32), in2(domain + 32);
+    for (const auto &i : batch1) for (int x = i.start; x < i.end; ++x) in1[x] = true;
+    for (const auto &i : batch2) for (int x = i.start; x < i.end; ++x) in2[x] = true;
+
+    auto at = [] (const std::vector<bool> &v, int x) {
+        return x >= 0 && x < (int) v.size() && v[x];
+    };
+
+    assert(matches(r1 | r2, domain, [&] (int x) { return at(in1, x) || at(in2, x); }));
+    assert(matches(r1 - r2, domain, [&] (int x) { return at(in1, x) && ! at(in2, x); }));
+    assert(matches(r2 - r1, domain, [&] (int x) { return at(in2, x) && ! at(in1, x); }));
+});
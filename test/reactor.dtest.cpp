@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <reactor.h>
+#include <thread.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+
+module("reactor")
+.dependsOn({
+    "exception",
+    "thread"
+});
+
+using namespace spl;
+
+#define NUM_PIPES (64)
+
+unit("reactor", "level")
+.body([] {
+    int p[2];
+    assert(pipe(p) == 0);
+
+    Reactor r;
+    r.add(p[0], Reactor::READ, 42);
+
+    Reactor::Event e[4];
+    assert(r.wait(e, 4, 0) == 0);
+
+    assert(write(p[1], "x", 1) == 1);
+    for (int i = 0; i < 2; ++i) {
+        assert(r.wait(e, 4, 100) == 1);
+        assert(e[0].tag == 42);
+        assert(e[0].events & Reactor::READ);
+    }
+
+    r.remove(p[0]).remove(p[0]);
+    assert(r.wait(e, 4, 0) == 0);
+
+    close(p[0]);
+    close(p[1]);
+});
+
+unit("reactor", "edge-oneshot")
+.body([] {
+    int p[2];
+    assert(pipe(p) == 0);
+
+    Reactor r;
+    Reactor::Event e[4];
+
+    r.add(p[0], Reactor::READ | Reactor::EDGE, 1);
+    assert(write(p[1], "x", 1) == 1);
+    assert(r.wait(e, 4, 100) == 1);
+    // not reported again until new data arrives
+    assert(r.wait(e, 4, 0) == 0);
+    assert(write(p[1], "x", 1) == 1);
+    assert(r.wait(e, 4, 100) == 1);
+
+    r.modify(p[0], Reactor::READ | Reactor::ONESHOT, 2);
+    assert(r.wait(e, 4, 100) == 1);
+    assert(e[0].tag == 2);
+    assert(write(p[1], "x", 1) == 1);
+    assert(r.wait(e, 4, 0) == 0);
+
+    // re-arming reports pending data
+    r.arm(p[0], Reactor::READ | Reactor::EDGE | Reactor::ONESHOT, 3);
+    assert(r.wait(e, 4, 100) == 1);
+    assert(e[0].tag == 3);
+
+    // arming registers unknown descriptors
+    r.arm(p[1], Reactor::WRITE, 4);
+    assert(r.wait(e, 4, 100) == 1);
+    assert(e[0].tag == 4);
+    assert(e[0].events & Reactor::WRITE);
+
+    close(p[0]);
+    close(p[1]);
+});
+
+unit("reactor", "hangup")
+.body([] {
+    int p[2];
+    assert(pipe(p) == 0);
+
+    Reactor r;
+    r.add(p[0], Reactor::READ, 7);
+    close(p[1]);
+
+    Reactor::Event e[4];
+    assert(r.wait(e, 4, 100) == 1);
+    assert(e[0].events & Reactor::HANGUP);
+
+    close(p[0]);
+});
+
+unit("reactor", "shared")
+.body([] {
+    Reactor r;
+    int p[NUM_PIPES][2];
+    for (int i = 0; i < NUM_PIPES; ++i) {
+        assert(pipe(p[i]) == 0);
+        r.add(p[i][0], Reactor::READ | Reactor::EDGE | Reactor::ONESHOT, i);
+        assert(write(p[i][1], "x", 1) == 1);
+    }
+
+    std::atomic<int> seen[NUM_PIPES];
+    for (auto &s : seen) s = 0;
+    std::atomic<int> total(0);
+
+    std::vector<Thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            Reactor::Event e[8];
+            while (total < NUM_PIPES) {
+                size_t n = r.wait(e, 8, 10);
+                for (size_t i = 0; i < n; ++i) {
+                    ++seen[e[i].tag];
+                    ++total;
+                }
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+
+    // each notification went to exactly one thread
+    for (auto &s : seen) assert(s == 1);
+
+    for (int i = 0; i < NUM_PIPES; ++i) {
+        close(p[i][0]);
+        close(p[i][1]);
+    }
+});
@@ -7,6 +7,8 @@
 #include <serialization.h>
 #include "test_serializers.cpp"
 #include <algorithm>
+#include <string>
+#include <vector>
 
 module("stream-serializer")
 .dependsOn({
@@ -293,6 +295,203 @@ unit("stream-serializer", "lock")
     delete &in;
 });
 
+unit("stream-serializer", "range")
+.body([] {
+    struct Triple {
+        int a, b, c;
+    };
+
+    std::vector<Triple> v;
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        v.push_back({ i, -i, 2 * i });
+    }
+
+    // 12-byte objects straddle the 1 KiB buffer boundary
+    MemoryOutputStreamSerializer out, expected;
+    out.putRange<Triple>(v.begin(), v.size());
+    for (auto &t : v) expected << t;
+    out.flush();
+    expected.flush();
+    assert(out.totalByteCount() == expected.totalByteCount());
+
+    auto &in = *out.toInput();
+    auto &expectedIn = *expected.toInput();
+    size_t i = 0;
+    in.getRange<Triple>(v.size(), [&] (const Triple &t) {
+        Triple t2;
+        expectedIn >> t2;
+        assert(t.a == v[i].a && t.b == v[i].b && t.c == v[i].c);
+        assert(memcmp(&t, &t2, sizeof(Triple)) == 0);
+        ++i;
+    });
+    assert(i == v.size());
+    delete &in;
+    delete &expectedIn;
+});
+
+unit("stream-serializer", "varint")
+.body([] {
+
+    struct StreamSerializable
+    :   Serializable,
+        WithFactory<StreamSerializable>
+    {
+        long data = 0;
+
+        void writeObject(OutputStreamSerializer &serializer) const override {
+            serializer << data;
+        }
+
+        void writeObject(OutputRandomAccessSerializer &serializer) const override {
+            assert(false);
+        }
+
+        void readObject(InputStreamSerializer &serializer) override {
+            serializer >> data;
+        }
+
+        void readObject(InputRandomAccessSerializer &serializer) override {
+            assert(false);
+        }
+    };
+
+    std::vector<long> values = { 0, 1, -1, 63, -64, 64, 300, -300, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN };
+    for (int i = 0; i < TEST_SIZE; ++i) values.push_back((long) i * i * (i % 2 ? -1 : 1));
+
+    MemoryOutputStreamSerializer out;
+    out.setIntegerEncoding(IntegerEncoding::VARINT);
+    for (long v : values) {
+        out << v << (int) v << (unsigned) v << (size_t) v << (short) v << (char) v << (double) v;
+    }
+    out.putRange<long>(values.begin(), values.size());
+    StreamSerializable obj;
+    obj.data = -42;
+    out << obj << (const StreamSerializable *) nullptr;
+    out.flush();
+
+    auto &in = *out.toInput();
+    in.setIntegerEncoding(IntegerEncoding::VARINT);
+    for (long v : values) {
+        long a;
+        int b;
+        unsigned c;
+        size_t d;
+        short e;
+        char f;
+        double g;
+        in >> a >> b >> c >> d >> e >> f >> g;
+        assert(a == v);
+        assert(b == (int) v);
+        assert(c == (unsigned) v);
+        assert(d == (size_t) v);
+        assert(e == (short) v);
+        assert(f == (char) v);
+        assert(g == (double) v);
+    }
+    size_t i = 0;
+    in.getRange<long>(values.size(), [&] (long v) {
+        assert(v == values[i++]);
+    });
+    assert(i == values.size());
+
+    StreamSerializable obj2;
+    StreamSerializable *p = nullptr;
+    in >> obj2 >> p;
+    assert(obj2.data == -42);
+    assert(p == nullptr);
+    delete &in;
+
+    // small values take a single byte
+    MemoryOutputStreamSerializer small;
+    small.setIntegerEncoding(IntegerEncoding::VARINT);
+    small << 1 << -1 << (size_t) 127 << (long) -64;
+    assert(small.totalByteCount() == 4);
+    small << (size_t) 128;
+    assert(small.totalByteCount() == 6);
+});
+
+unit("stream-serializer", "gather")
+.body([] {
+    struct CountingSerializer : public MemoryOutputStreamSerializer {
+        size_t writes = 0, vectoredWrites = 0;
+
+        void _write(const void *data, size_t len) override {
+            ++writes;
+            MemoryOutputStreamSerializer::_write(data, len);
+        }
+
+        void _writev(const iovec *iov, int count) override {
+            ++vectoredWrites;
+            OutputStreamSerializer::_writev(iov, count);
+            writes -= count;
+        }
+    };
+
+    std::vector<std::string> blobs;
+    for (int i = 0; i < 16; ++i) {
+        blobs.push_back(std::string(512 + i, 'a' + i));
+    }
+
+    CountingSerializer out;
+    out.setGatherThreshold(256);
+    assert(out.gatherThreshold() == 256);
+
+    for (auto &b : blobs) {
+        out << b.size();
+        out.put(b.data(), b.size());
+    }
+    out << -1;
+    out.flush();
+
+    assert(out.writes == 0);
+    assert(out.vectoredWrites == 1);
+
+    auto &in = *out.toInput();
+    for (auto &b : blobs) {
+        size_t len;
+        in >> len;
+        assert(len == b.size());
+        std::string s(len, 0);
+        in.get(&s[0], len);
+        assert(s == b);
+    }
+    int x;
+    in >> x;
+    assert(x == -1);
+    delete &in;
+});
+
+unit("stream-serializer", "gather-lock")
+.body([] {
+    std::string blob(1024, 'x');
+
+    MemoryOutputStreamSerializer out;
+    out.setGatherThreshold(256);
+    out << 1;
+    out.put(blob.data(), blob.size());
+    out.lock();
+    out << 2;
+    out.put(blob.data(), 300);
+    out.flush();
+
+    auto &in = *out.toInput();
+    int x;
+    in >> x;
+    assert(x == 1);
+    std::string s(blob.size(), 0);
+    in.get(&s[0], s.size());
+    assert(s == blob);
+
+    try {
+        in >> x;
+        delete &in;
+        fail("got data beyond lock position");
+    }
+    catch (const OutOfRangeError &) { }
+
+    delete &in;
+});
+
 unit("random-access-serializer", "primitive-types")
 .body([] {
     int x = 1;
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <sharded_counter.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+using namespace spl;
+
+#define NUM_THREADS (32)
+#define TEST_SIZE (100000)
+
+template <typename F>
+static void runThreads(F f) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) threads.emplace_back(f, t);
+    for (auto &t : threads) t.join();
+}
+
+unit("sharded-counter", "single-thread")
+.body([] {
+    ShardedCounter<> c;
+    assert(c.load() == 0);
+
+    ++c;
+    c += 10;
+    --c;
+    c -= 3;
+    assert(c.load() == 7);
+    assert((size_t) c == 7);
+
+    c = 42;
+    assert(c.load() == 42);
+
+    ShardedCounter<> d = c;
+    assert(d.load() == 42);
+});
+
+unit("sharded-counter", "concurrent")
+.body([] {
+    ShardedCounter<4> c;
+
+    // more threads than slots, so that some share a slot
+    runThreads([&c] (int t) {
+        for (int i = 0; i < TEST_SIZE; ++i) ++c;
+        for (int i = 0; i < TEST_SIZE / 2; ++i) --c;
+    });
+    assert(c.load() == (int64_t) NUM_THREADS * TEST_SIZE / 2);
+});
+
+unit("sharded-counter", "cross-thread")
+.body([] {
+    ShardedCounter<> c;
+
+    // increments and decrements on different threads still add up
+    std::thread([&c] { for (int i = 0; i < TEST_SIZE; ++i) ++c; }).join();
+    std::thread([&c] { for (int i = 0; i < TEST_SIZE; ++i) --c; }).join();
+    assert(c.load() == 0);
+    assert((size_t) c == 0);
+});
+
+unit("sharded-counter", "accumulator")
+.body([] {
+    ThreadLocalAccumulator<double> sum;
+    ThreadLocalAccumulator<long, const long &(*)(const long &, const long &)> max(
+        0,
+        [] (const long &a, const long &b) -> const long & { return std::max(a, b); }
+    );
+
+    runThreads([&sum, &max] (int t) {
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            sum.add(0.5);
+            max.add((long) t * TEST_SIZE + i);
+        }
+    });
+
+    assert(sum.get() == 0.5 * NUM_THREADS * TEST_SIZE);
+    assert(max.get() == (long) NUM_THREADS * TEST_SIZE - 1);
+
+    sum.reset();
+    assert(sum.get() == 0);
+});
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <shm_channel.h>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "test_serializable.cpp"
+
+module("shm-channel")
+.dependsOn({
+    "file",
+    "exception",
+});
+
+module("shm-channel-serializer")
+.dependsOn({
+    "shm-channel",
+    "stream-serializer"
+});
+
+using namespace spl;
+
+#define TEST_SIZE (10240)
+
+unit("shm-channel", "read-write")
+.body([] {
+    SharedMemoryChannel c(4096);
+    assert(c.capacity() >= 4096);
+    assert(c.available() == 0);
+
+    int x = 42, y;
+    c.write(&x, sizeof(x));
+    assert(c.available() == sizeof(x));
+    assert(c.read(&y, sizeof(y), sizeof(y)) == sizeof(y));
+    assert(y == 42);
+    assert(c.available() == 0);
+});
+
+unit("shm-channel", "wrap-around")
+.body([] {
+    SharedMemoryChannel c(4096);
+
+    std::vector<int> out(TEST_SIZE), in(TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) out[i] = i;
+
+    // a consumer thread keeps up with a producer writing more than the ring
+    // holds, so that both ends wait and the data wraps around several times
+    std::thread consumer([&c, &in] {
+        size_t len = in.size() * sizeof(int);
+        size_t total = 0;
+        while (total < len) {
+            total += c.read((uint8_t *) in.data() + total, 1, len - total);
+        }
+    });
+    c.write(out.data(), out.size() * sizeof(int));
+    consumer.join();
+
+    assert(in == out);
+});
+
+unit("shm-channel", "close")
+.body([] {
+    SharedMemoryChannel c(4096);
+
+    int x = 1, y;
+    c.write(&x, sizeof(x));
+    c.close();
+    assert(c.closed());
+
+    // data written before closing is still readable
+    assert(c.read(&y, sizeof(y), sizeof(y)) == sizeof(y));
+    assert(y == 1);
+
+    bool thrown = false;
+    try { c.read(&y, sizeof(y), sizeof(y)); }
+    catch (const ChannelClosedError &) { thrown = true; }
+    assert(thrown);
+
+    thrown = false;
+    try { c.write(&x, sizeof(x)); }
+    catch (const ChannelClosedError &) { thrown = true; }
+    assert(thrown);
+});
+
+unit("shm-channel", "close-wakes-peer")
+.body([] {
+    SharedMemoryChannel c(4096);
+
+    std::thread closer([&c] {
+        usleep(100000);
+        c.close();
+    });
+
+    int y;
+    bool thrown = false;
+    try { c.read(&y, sizeof(y), sizeof(y)); }
+    catch (const ChannelClosedError &) { thrown = true; }
+    closer.join();
+    assert(thrown);
+});
+
+unit("shm-channel", "attach")
+.body([] {
+    SharedMemoryChannel c(4096);
+    SharedMemoryChannel peer(c.path());
+    assert(peer.capacity() == c.capacity());
+
+    int x = 7, y;
+    peer.write(&x, sizeof(x));
+    assert(c.read(&y, sizeof(y), sizeof(y)) == sizeof(y));
+    assert(y == 7);
+
+    bool thrown = false;
+    try { SharedMemoryChannel bad("/dev/null"); }
+    catch (const InvalidArgument &) { thrown = true; }
+    assert(thrown);
+});
+
+unit("shm-channel", "cross-process")
+.body([] {
+    SharedMemoryChannel c(4096);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        SharedMemoryChannel peer(c.path());
+        for (int i = 0; i < TEST_SIZE; ++i) {
+            peer.write(&i, sizeof(i));
+        }
+        _exit(0);
+    }
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        int x;
+        c.read(&x, sizeof(x), sizeof(x));
+        assert(x == i);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+});
+
+unit("shm-channel-serializer", "primitive-types")
+.body([] {
+    SharedMemoryChannel c(4096);
+    OutputSharedMemorySerializer out(&c);
+    InputSharedMemorySerializer in(&c);
+
+    int x = 1;
+    long y = 2;
+    short z = 3;
+    out << x << y << z;
+    out.flush();
+
+    x = y = z = 0;
+    in >> x >> y >> z;
+    assert(x == 1);
+    assert(y == 2);
+    assert(z == 3);
+});
+
+unit("shm-channel-serializer", "serializable-type")
+.body([] {
+    SharedMemoryChannel c(4096);
+    OutputSharedMemorySerializer out(&c);
+    InputSharedMemorySerializer in(&c);
+
+    auto elem = StreamSerializable();
+    out << elem;
+    out.flush();
+    assert(elem.serialized());
+
+    auto elem2 = StreamSerializable();
+    in >> elem2;
+    assert(elem2.deserialized());
+});
+
+unit("shm-channel-serializer", "large-serialization")
+.body([] {
+    SharedMemoryChannel c(4096);
+
+    std::thread producer([&c] {
+        OutputSharedMemorySerializer out(&c);
+        for (auto i = 0; i < TEST_SIZE; ++i) {
+            out << i;
+        }
+        out.flush();
+    });
+
+    InputSharedMemorySerializer in(&c);
+    for (auto i = 0; i < TEST_SIZE; ++i) {
+        int x;
+        in >> x;
+        assert(x == i);
+    }
+    producer.join();
+});
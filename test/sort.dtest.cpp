@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+
+#include <sort.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+module("sort");
+
+using namespace spl;
+
+#define TEST_SIZE (1000000)
+#define PERFORMANCE_TEST_SIZE (8 * 1000 * 1000)
+
+template <typename T>
+static std::vector<T> randomVector(size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<T> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i) v.push_back((T) rng());
+    return v;
+}
+
+unit("sort", "parallel-sort")
+.body([] {
+    auto v = randomVector<double>(TEST_SIZE, 1);
+    auto expected = v;
+    std::sort(expected.begin(), expected.end());
+    parallelSort(v.begin(), v.end());
+    assert(v == expected);
+
+    // an odd number of runs leaves one unmerged in some rounds
+    v = randomVector<double>(TEST_SIZE + 7, 2);
+    expected = v;
+    std::sort(expected.begin(), expected.end(), std::greater<double>());
+    parallelSort(v, std::greater<double>(), 3);
+    assert(v == expected);
+
+    std::vector<std::string> s;
+    for (int i = 0; i < TEST_SIZE / 10; ++i) s.push_back(std::to_string((i * 7919) % (TEST_SIZE / 10)));
+    auto sorted = s;
+    std::sort(sorted.begin(), sorted.end());
+    parallelSort(s, std::less<std::string>(), 4);
+    assert(s == sorted);
+
+    std::vector<double> empty;
+    parallelSort(empty);
+    assert(empty.empty());
+});
+
+unit("sort", "radix-sort")
+.body([] {
+    auto i64 = randomVector<int64_t>(TEST_SIZE, 3);
+    auto expected64 = i64;
+    std::sort(expected64.begin(), expected64.end());
+    radixSort(i64.begin(), i64.end());
+    assert(i64 == expected64);
+
+    // sign bits order negative keys first, and shared high bytes are skipped
+    std::vector<int> small;
+    for (int i = 0; i < TEST_SIZE; ++i) small.push_back((int) ((i * 7919L) % 2001) - 1000);
+    auto expected = small;
+    std::sort(expected.begin(), expected.end());
+    parallelSort(small);
+    assert(small == expected);
+
+    auto u16 = randomVector<uint16_t>(TEST_SIZE / 3, 4);
+    auto expected16 = u16;
+    std::sort(expected16.begin(), expected16.end());
+    radixSort(u16.begin(), u16.end(), 2);
+    assert(u16 == expected16);
+
+    std::vector<unsigned> same(1000, 5);
+    radixSort(same.begin(), same.end());
+    assert(std::all_of(same.begin(), same.end(), [] (unsigned x) { return x == 5; }));
+});
+
+unit("sort", "radix-sort-stability")
+.body([] {
+    std::vector<std::pair<int8_t, int>> v;
+    std::mt19937 rng(5);
+    for (int i = 0; i < TEST_SIZE; ++i) v.push_back(std::make_pair((int8_t) rng(), i));
+    radixSort(v.begin(), v.end(), [] (const std::pair<int8_t, int> &x) { return x.first; });
+
+    for (size_t i = 1; i < v.size(); ++i) {
+        assert(v[i - 1].first < v[i].first || (v[i - 1].first == v[i].first && v[i - 1].second < v[i].second));
+    }
+});
+
+unit("sort", "parallel-merge")
+.body([] {
+    auto a = randomVector<int>(TEST_SIZE, 6);
+    auto b = randomVector<int>(TEST_SIZE / 3, 7);
+    for (auto &x : a) x %= 100;
+    for (auto &x : b) x %= 100;
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+
+    std::vector<int> expected(a.size() + b.size());
+    std::merge(a.begin(), a.end(), b.begin(), b.end(), expected.begin());
+
+    std::vector<int> out(a.size() + b.size());
+    auto end = parallelMerge(a.begin(), a.end(), b.begin(), b.end(), out.begin());
+    assert(end == out.end());
+    assert(out == expected);
+
+    // of equal elements, those of the first range come first
+    std::vector<std::pair<int, int>> x, y, merged(2 * TEST_SIZE / 10);
+    for (int i = 0; i < TEST_SIZE / 10; ++i) {
+        x.push_back(std::make_pair(i / 100, 0));
+        y.push_back(std::make_pair(i / 100, 1));
+    }
+    auto byFirst = [] (const std::pair<int, int> &l, const std::pair<int, int> &r) {
+        return l.first < r.first;
+    };
+    parallelMerge(x.begin(), x.end(), y.begin(), y.end(), merged.begin(), byFirst, 8);
+    for (size_t i = 1; i < merged.size(); ++i) {
+        assert(merged[i - 1].first < merged[i].first
+            || (merged[i - 1].first == merged[i].first && merged[i - 1].second <= merged[i].second)
+        );
+    }
+
+    std::vector<int> none;
+    assert(parallelMerge(none.begin(), none.end(), b.begin(), b.end(), out.begin()) == out.begin() + b.size());
+});
+
+perf("sort", "parallel-sort(p)")
+.body([] {
+    auto v = randomVector<double>(PERFORMANCE_TEST_SIZE, 8);
+    parallelSort(v);
+})
+.baseline([] {
+    auto v = randomVector<double>(PERFORMANCE_TEST_SIZE, 8);
+    std::sort(v.begin(), v.end());
+});
+
+perf("sort", "radix-sort(p)")
+.body([] {
+    auto v = randomVector<uint64_t>(PERFORMANCE_TEST_SIZE, 9);
+    parallelSort(v);
+})
+.baseline([] {
+    auto v = randomVector<uint64_t>(PERFORMANCE_TEST_SIZE, 9);
+    std::sort(v.begin(), v.end());
+});
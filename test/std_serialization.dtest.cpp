@@ -109,6 +109,31 @@ unit("std-serialization", "string")
 
 // std::pair ////////////////////////////////////////////////////////////////////
 
+unit("std-serialization", "varint")
+.body([] {
+    std::vector<int> v(TEST_SIZE);
+    for (auto i = 0; i < TEST_SIZE; ++i) v[i] = i % 128 - 64;
+    std::string s(200, 'x');
+
+    MemoryOutputStreamSerializer out;
+    out.setIntegerEncoding(IntegerEncoding::VARINT);
+    out << v << s;
+    out.flush();
+
+    // one byte per element plus two-byte length prefixes
+    assert(out.totalByteCount() == TEST_SIZE + 2 + s.size() + 2);
+
+    std::vector<int> v2;
+    std::string s2;
+    auto &in = *out.toInput();
+    in.setIntegerEncoding(IntegerEncoding::VARINT);
+    in >> v2 >> s2;
+    delete &in;
+
+    assert(v == v2);
+    assert(s == s2);
+});
+
 unit("std-serialization", "pair<int,int>")
 .body([] {
     std::pair<int, int> p{ 3, 4 };
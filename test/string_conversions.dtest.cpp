@@ -80,6 +80,59 @@ unit("string-conversions", "parse<float64>")
     assert(( StringConversions::parse<float64>( "1.23e-7") == (float64)  1.23e-7 ));
 });
 
+unit("string-conversions", "parse<int64>(long)")
+.body([] {
+    assert(( StringConversions::parse<int64>(  "1234567890123456789") ==  1234567890123456789l ));
+    assert(( StringConversions::parse<int64>( "-9223372036854775808") == numeric_type_info<int64>::min ));
+    assert(( StringConversions::parse<uint64>("18446744073709551615") == numeric_type_info<uint64>::max ));
+    assert(( StringConversions::parse<uint32>("0000000000004294967295") == 4294967295u ));
+
+    const char *str = "12345678901234567xyz";
+    assert(( StringConversions::parse<int64>(str, 17) == 12345678901234567l ));
+    assert(( StringConversions::parse_unprotected<int64>(str) == 12345678901234567l ));
+
+    bool thrown = false;
+    try { StringConversions::parse<int64>(str); }
+    catch (const StringNotNumeric &) { thrown = true; }
+    assert(thrown);
+});
+
+unit("string-conversions", "parse<float64>(exact)")
+.body([] {
+    char buf[64];
+    uint64 bits = 0x0123456789abcdef;
+    for (int i = 0; i < 100000; ++i) {
+        bits = bits * 6364136223846793005ul + 1442695040888963407ul;
+        float64 x;
+        memcpy(&x, &bits, sizeof(x));
+        if (std::isnan(x) || std::isinf(x)) continue;
+
+        snprintf(buf, sizeof(buf), "%.17g", x);
+        assert(( StringConversions::parse<float64>(buf) == x ));
+        snprintf(buf, sizeof(buf), "%.*e", i % 20, x);
+        assert(( StringConversions::parse<float64>(buf) == strtod(buf, nullptr) ));
+        assert(( StringConversions::parse<float32>(buf) == strtof(buf, nullptr) ));
+    }
+
+    assert(( StringConversions::parse<float64>("2.2250738585072013e-308") == 2.2250738585072013e-308 ));
+    assert(( StringConversions::parse<float64>("4.9406564584124654e-324") == 4.9406564584124654e-324 ));
+    assert(( StringConversions::parse<float64>("1.7976931348623157e308") == 1.7976931348623157e308 ));
+    assert(( StringConversions::parse<float64>("9007199254740993") == 9007199254740992.0 ));
+    assert(( StringConversions::parse<float64>("9007199254740993.0000000000001") == 9007199254740994.0 ));
+    assert(( StringConversions::parse<float64>("1e400") == HUGE_VAL ));
+    assert(( StringConversions::parse<float64>("1e-400") == 0 ));
+    assert(( StringConversions::parse<float32>("1.00000005960464477539062501") == 1.00000012f ));
+    assert(( StringConversions::parse<float32>("3.4028235e38") == 3.4028235e38f ));
+    assert(( StringConversions::parse<float64>("0.1") == 0.1 ));
+    assert(( StringConversions::parse<float64>("1E+2") == 100 ));
+    assert(( StringConversions::parse<float128>("0.1") == 0.1l ));
+
+    bool thrown = false;
+    try { StringConversions::parse<float64>("1.5x"); }
+    catch (const StringParseError &) { thrown = true; }
+    assert(thrown);
+});
+
 perf("string-conversions", "parse<int64>(p)")
 .performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
 .body([] {
@@ -192,6 +245,78 @@ unit("string-conversions", "toStr<float64>")
     assert(( strcmp(StringConversions::toStr<6, 5>((float64) 11000000            ),       "1.10000e7"       ) == 0 ));
 });
 
+unit("string-conversions", "toChars(int)")
+.body([] {
+    char buf[StringConversions::MAX_CHARS];
+    char *end;
+
+    end = StringConversions::toChars(buf, (uint64) 0);
+    assert(std::string(buf, end) == "0");
+
+    end = StringConversions::toChars(buf, (uint64) 18446744073709551615ul);
+    assert(std::string(buf, end) == "18446744073709551615");
+
+    end = StringConversions::toChars(buf, (int64) (-9223372036854775807l - 1));
+    assert(std::string(buf, end) == "-9223372036854775808");
+
+    end = StringConversions::toChars(buf, (int8) -128);
+    assert(std::string(buf, end) == "-128");
+
+    // several numbers into one buffer
+    char line[4 * StringConversions::MAX_CHARS];
+    end = StringConversions::toChars(line, (int32) 12);
+    *end++ = ',';
+    end = StringConversions::toChars(end, (uint16) 3456);
+    *end++ = ',';
+    end = StringConversions::toChars(end, (float64) 0.5);
+    assert(std::string(line, end) == "12,3456,0.5");
+
+    for (int64 i = -100000; i <= 100000; i += 7) {
+        end = StringConversions::toChars(buf, i);
+        assert(std::string(buf, end) == std::to_string(i));
+        assert(strcmp(StringConversions::toStr(i), std::to_string(i).c_str()) == 0);
+    }
+});
+
+unit("string-conversions", "toChars(float)")
+.body([] {
+    char buf[StringConversions::MAX_CHARS];
+
+    auto str = [&buf] (float64 x) {
+        return std::string(buf, StringConversions::toChars(buf, x));
+    };
+
+    assert(str(0) == "0");
+    assert(str(-0.0) == "-0");
+    assert(str(1) == "1");
+    assert(str(0.1) == "0.1");
+    assert(str(0.3) == "0.3");
+    assert(str(-123.45) == "-123.45");
+    assert(str(1e20) == "100000000000000000000");
+    assert(str(1e21) == "1e21");
+    assert(str(0.000001) == "0.000001");
+    assert(str(1e-7) == "1e-7");
+    assert(str(5e-324) == "5e-324");
+    assert(str(1.7976931348623157e308) == "1.7976931348623157e308");
+    assert(str(INFINITY) == "inf");
+    assert(str(NAN) == "nan");
+
+    assert(std::string(buf, StringConversions::toChars(buf, 0.1f)) == "0.1");
+    assert(strcmp(StringConversions::float_to_shortest_str(2.5), "2.5") == 0);
+
+    // every output parses back to the same value
+    uint64 bits = 0x9e3779b97f4a7c15ul;
+    for (int i = 0; i < 100000; ++i) {
+        bits = bits * 6364136223846793005ul + 1442695040888963407ul;
+        float64 x;
+        memcpy(&x, &bits, sizeof(x));
+        if (std::isnan(x)) continue;
+
+        *StringConversions::toChars(buf, x) = '\0';
+        assert(strtod(buf, nullptr) == x);
+    }
+});
+
 perf("string-conversions", "toStr<int64>(p)")
 .performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
 .body([] {
@@ -233,3 +358,18 @@ perf("string-conversions", "toStr<float64>(p)")
         snprintf(buf, 20, "%lf", (float64) i);
     }
 });
+
+perf("string-conversions", "toChars<float64>(p)")
+.performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
+.body([] {
+    char buf[StringConversions::MAX_CHARS];
+    for (uint64 i = 0; i < PERFORMANCE_ITERATIONS; ++i) {
+        StringConversions::toChars(buf, (float64) i / 7);
+    }
+})
+.baseline([] {
+    char buf[32];
+    for (uint64 i = 0; i < PERFORMANCE_ITERATIONS; ++i) {
+        snprintf(buf, 32, "%.17g", (float64) i / 7);
+    }
+});
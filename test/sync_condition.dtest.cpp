@@ -35,3 +35,29 @@ unit("sync-condition", "wait")
     assert(count == 0);
     usleep(100000);     // make sure all threads have terminated
 });
+
+unit("sync-condition", "threshold")
+.dependsOn("thread")
+.body([] {
+    SynchronizationCondition cond(10);
+
+    cond.increase(100);
+
+    std::atomic<size_t> done(0);
+    Thread t([&cond, &done] {
+        for (int i = 0; i < 90; ++i) {
+            ++done;
+            cond.decrease();
+        }
+    });
+
+    cond.wait();
+    assert(done == 90);
+    t.join();
+
+    cond.decrease(10);
+    bool thrown = false;
+    try { cond.decrease(); }
+    catch (const TraceableError &) { thrown = true; }
+    assert(thrown);
+});
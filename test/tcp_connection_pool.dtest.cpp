@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <tcp_connection_pool.h>
+#include <unistd.h>
+
+module("tcp-connection-pool")
+.dependsOn({
+    "tcp-socket",
+    "tcp-socket-serializer",
+});
+
+using namespace spl;
+
+#define NUM_REQUESTS (1000)
+#define CLOSE_REQUEST (-1)
+
+// replies to every int with its successor, and closes the connection on
+// CLOSE_REQUEST
+static void echo(TCPServerSocket &s, TCPSocket *c) {
+    int x;
+    try {
+        while (c->recv(&x, sizeof(x), false) == sizeof(x)) {
+            if (x == CLOSE_REQUEST) {
+                s.closeConnection(c);
+                return;
+            }
+            ++x;
+            c->send(&x, sizeof(x));
+        }
+    }
+    catch (const ConnectionTerminatedError &) {
+        s.closeConnection(c);
+        return;
+    }
+    s.returnConnection(c);
+}
+
+unit("tcp-connection-pool", "reuse")
+.body([] {
+    TCPServerGroup server(0, 1, 128);
+    server.start(echo);
+
+    TCPConnectionPool pool;
+    for (int i = 0; i < 10; ++i) {
+        auto conn = pool.acquire(server.address());
+        assert(conn.valid());
+        assert(pool.idle() == 0);
+
+        int y;
+        conn.request(i).response(y);
+        assert(y == i + 1);
+        assert(conn.pending() == 0);
+    }
+    assert(pool.connects() == 1);
+    assert(pool.idle() == 1);
+
+    {
+        auto a = pool.acquire(server.address());
+        auto b = pool.acquire(server.address());
+        assert(pool.connects() == 2);
+    }
+    assert(pool.idle() == 2);
+
+    pool.clear();
+    assert(pool.idle() == 0);
+});
+
+unit("tcp-connection-pool", "pipelining")
+.body([] {
+    TCPServerGroup server(0, 1, 128);
+    server.start(echo);
+
+    TCPConnectionPool pool;
+    auto conn = pool.acquire(server.address());
+
+    for (int i = 0; i < NUM_REQUESTS; ++i) conn.request(i);
+    assert(conn.pending() == NUM_REQUESTS);
+
+    for (int i = 0; i < NUM_REQUESTS; ++i) {
+        int y;
+        conn.response(y);
+        assert(y == i + 1);
+    }
+    assert(conn.pending() == 0);
+});
+
+unit("tcp-connection-pool", "outstanding-requests")
+.body([] {
+    TCPServerGroup server(0, 1, 128);
+    server.start(echo);
+
+    TCPConnectionPool pool;
+    {
+        auto conn = pool.acquire(server.address());
+        conn.request(1);
+    }
+    // the unread response would be mistaken for the next one
+    assert(pool.idle() == 0);
+});
+
+unit("tcp-connection-pool", "idle-timeout")
+.body([] {
+    TCPServerGroup server(0, 1, 128);
+    server.start(echo);
+
+    TCPConnectionPool pool(8, std::chrono::milliseconds(50));
+
+    pool.acquire(server.address());
+    assert(pool.idle() == 1);
+    usleep(100000);
+    pool.acquire(server.address());
+    assert(pool.connects() == 2);
+
+    usleep(100000);
+    pool.evictIdle();
+    assert(pool.idle() == 0);
+});
+
+unit("tcp-connection-pool", "health-check")
+.body([] {
+    TCPServerGroup server(0, 1, 128);
+    server.start(echo);
+
+    TCPConnectionPool pool;
+
+    // closed by the peer while idle
+    {
+        auto conn = pool.acquire(server.address());
+        int x = CLOSE_REQUEST;
+        conn->send(&x, sizeof(x));
+    }
+    usleep(100000);
+    pool.acquire(server.address());
+    assert(pool.connects() == 2);
+
+    // rejected by a custom check
+    int checks = 0;
+    pool.setHealthCheck([&checks] (TCPSocket &) {
+        ++checks;
+        return false;
+    });
+    pool.acquire(server.address());
+    assert(checks == 1);
+    assert(pool.connects() == 3);
+});
+
+unit("tcp-connection-pool", "response-without-request")
+.expect(Status::FAIL)
+.body([] {
+    TCPServerGroup server(0, 1, 128);
+    server.start(echo);
+
+    TCPConnectionPool pool;
+    int y;
+    pool.acquire(server.address()).response(y);
+});
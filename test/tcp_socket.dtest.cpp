@@ -5,6 +5,13 @@
 
 #include <dtest.h>
 #include <tcp_socket.h>
+#include <thread_pool.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <time.h>
 #include "test_serializable.cpp"
 
 module("tcp-socket")
@@ -332,6 +339,178 @@ dunit("tcp-socket", "poll()")
     }
 });
 
+dunit("tcp-socket", "server-group")
+.workers(4)
+.driver([] {
+    TCPServerGroup g(0, 4, 128);
+    assert(g.size() == 4);
+    dtest_send_msg(g.address());
+
+    std::atomic<int> handled(0);
+    g.start([&handled] (TCPServerSocket &s, TCPSocket *c) {
+        int x;
+        try {
+            if (c->recv(&x, sizeof(x), false) != sizeof(x)) {
+                s.returnConnection(c);
+                return;
+            }
+        }
+        catch (const ConnectionTerminatedError &) {
+            s.closeConnection(c);
+            return;
+        }
+        ++x;
+        c->send(&x, sizeof(x));
+        ++handled;
+        s.returnConnection(c);
+    });
+    assert(g.running());
+
+    while (handled < 4 * 4 * TEST_SIZE / 16) std::this_thread::yield();
+    g.stop();
+    assert(! g.running());
+})
+.worker([] {
+    SocketAddress addr;
+    dtest_recv_msg(addr);
+
+    std::vector<TCPSocket> conn;
+    for (int i = 0; i < 4; ++i) conn.emplace_back(addr);
+
+    for (int i = 0; i < TEST_SIZE / 16; ++i) {
+        for (auto &c : conn) {
+            int x = i, y;
+            c.send(&x, sizeof(x));
+            c.recv(&y, sizeof(y));
+            assert(y == i + 1);
+        }
+    }
+});
+
+dunit("tcp-socket", "waiter")
+.workers(1)
+.driver([] {
+    TCPServerSocket s(0, 128);
+    dtest_send_msg(s.address());
+
+    auto conn = s.accept();
+    assert(! conn.waitReady(Reactor::READ, 0));
+
+    int waits = 0;
+    conn.setWaiter([&waits] (int fd, uint32_t events) {
+        assert(events == Reactor::READ);
+        ++waits;
+        pollfd pfd = { fd, POLLIN, 0 };
+        ::poll(&pfd, 1, -1);
+    });
+
+    int data;
+    conn.recv(&data, sizeof(data));
+    assert(data == 42);
+    assert(waits > 0);
+    assert(conn.waitReady(Reactor::WRITE, 0));
+})
+.worker([] {
+    SocketAddress addr;
+    dtest_recv_msg(addr);
+    TCPSocket s(addr);
+
+    usleep(100000);
+    int data = 42;
+    s.send(&data, sizeof(data));
+});
+
+unit("tcp-socket", "async")
+.dependsOn({ "thread-pool" })
+.body([] {
+    static constexpr int clients = 64;
+    static constexpr int messages = 100;
+
+    // far more connections than workers, each served by a task that suspends
+    // on I/O instead of blocking its worker
+    ThreadPool<> pool(2);
+    TCPServerSocket s(0, clients);
+    std::atomic_int served(0), done(0);
+
+    pool.run([&] (ExecutionContext &) {
+        for (int c = 0; c < clients; ++c) {
+            std::shared_ptr<TCPSocket> conn = std::make_shared<TCPSocket>(s.asyncAccept(pool));
+            pool.run([&, conn] (ExecutionContext &) {
+                for (int i = 0; i < messages; ++i) {
+                    int x;
+                    conn->asyncRecv(pool, &x, sizeof(x));
+                    ++x;
+                    conn->asyncSend(pool, &x, sizeof(x));
+                }
+                ++served;
+            });
+        }
+    });
+
+    for (int c = 0; c < clients; ++c) {
+        pool.run([&, c] (ExecutionContext &) {
+            TCPSocket conn = TCPSocket::asyncConnect(pool, s.address());
+            for (int i = 0; i < messages; ++i) {
+                int x = c * messages + i, y = 0;
+                conn.asyncSend(pool, &x, sizeof(x));
+                assert(conn.asyncRecv(pool, &y, sizeof(y), false) == sizeof(y));
+                assert(y == x + 1);
+            }
+            ++done;
+        });
+    }
+
+    while (done < clients || served < clients) usleep(1000);
+    pool.terminate();
+
+    // outside of the pool's tasks, the operations block
+    bool refused = false;
+    try {
+        SocketAddress addr = s.address();
+        s.close();
+        TCPSocket::asyncConnect(pool, addr);
+    }
+    catch (const ConnectionRefusedError &) {
+        refused = true;
+    }
+    assert(refused);
+});
+
+dunit("tcp-socket", "zero-copy")
+.workers(1)
+.driver([] {
+    TCPServerSocket s(0, 128);
+    dtest_send_msg(s.address());
+
+    auto conn = s.accept();
+    std::vector<int> data(2 * TEST_SIZE * TEST_SIZE / 1024);
+    for (int k = 0; k < 2; ++k) {
+        conn.recv(data.data(), data.size() * sizeof(int));
+        for (size_t i = 0; i < data.size(); ++i) assert(data[i] == (int) i + k);
+    }
+})
+.worker([] {
+    SocketAddress addr;
+    dtest_recv_msg(addr);
+    TCPSocket s(addr);
+
+    assert(s.sendChunkSize() > 0);
+    assert(! s.zeroCopy());
+    s.setZeroCopy();
+    assert(s.zeroCopy());
+
+    std::vector<int> data(2 * TEST_SIZE * TEST_SIZE / 1024);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = i;
+    s.send(data.data(), data.size() * sizeof(int));
+    assert(s.zeroCopyPending() == 0);
+
+    std::vector<int> data2(data.size());
+    for (size_t i = 0; i < data2.size(); ++i) data2[i] = i + 1;
+    s.sendZeroCopy(data2.data(), data2.size() * sizeof(int));
+    s.awaitZeroCopy();
+    assert(s.zeroCopyPending() == 0);
+});
+
 dunit("tcp-socket-serializer", "primitive-types")
 .workers(1)
 .driver([] {
@@ -361,6 +540,77 @@ dunit("tcp-socket-serializer", "primitive-types")
     serializer.flush();
 });
 
+dunit("tcp-socket-serializer", "gather")
+.workers(1)
+.driver([] {
+    TCPServerSocket s(0, 128);
+    dtest_send_msg(s.address());
+
+    InputTCPSocketSerializer serializer(s.accept());
+    for (int i = 0; i < 64; ++i) {
+        int x;
+        serializer >> x;
+        assert(x == i);
+        std::vector<int> v(TEST_SIZE);
+        serializer.get(v.data(), v.size() * sizeof(int));
+        for (int j = 0; j < TEST_SIZE; ++j) {
+            assert(v[j] == i + j);
+        }
+    }
+})
+.worker([] {
+    SocketAddress addr;
+    dtest_recv_msg(addr);
+
+    std::vector<std::vector<int>> blobs(64);
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < TEST_SIZE; ++j) {
+            blobs[i].push_back(i + j);
+        }
+    }
+
+    OutputTCPSocketSerializer serializer{TCPSocket(addr)};
+    serializer.setGatherThreshold(1024);
+    for (int i = 0; i < 64; ++i) {
+        serializer << i;
+        serializer.put(blobs[i].data(), blobs[i].size() * sizeof(int));
+    }
+    serializer.flush();
+});
+
+dunit("tcp-socket-serializer", "slow-peer")
+.workers(1)
+.driver([] {
+    TCPServerSocket s(0, 128);
+    dtest_send_msg(s.address());
+
+    InputTCPSocketSerializer serializer(s.accept());
+
+    timespec start, end;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    int x, y;
+    serializer >> x >> y;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+
+    assert(x == 1);
+    assert(y == 2);
+
+    // waiting for the peer must block rather than spin
+    long cpuMillis = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+    assert(cpuMillis < 100);
+})
+.worker([] {
+    SocketAddress addr;
+    dtest_recv_msg(addr);
+
+    OutputTCPSocketSerializer serializer{TCPSocket(addr)};
+    serializer << 1;
+    serializer.flush();
+    usleep(300000);
+    serializer << 2;
+    serializer.flush();
+});
+
 dunit("tcp-socket-serializer", "serializable-type")
 .workers(1)
 .driver([] {
@@ -8,6 +8,8 @@
 #include <thread.h>
 #include <list.h>
 #include <atomic>
+#include <chrono>
+#include <unistd.h>
 
 module("thread")
 .dependsOn({
@@ -104,3 +106,52 @@ unit("thread", "list-of-threads")
 
     threads.foreach([] (Thread &t) { t.requestTerminate().join(); });
 });
+
+unit("thread", "semaphore")
+.body([] {
+    Semaphore sem(2);
+
+    assert(sem.tryWait());
+    assert(sem.tryWait());
+    assert(! sem.tryWait());
+
+    sem.notify(5);
+    assert(sem.tryWait(3) == 3);
+    assert(sem.tryWait(3) == 2);
+    assert(sem.tryWait(3) == 0);
+
+    // ping-pong between two threads, so that both sides sleep and wake
+    Semaphore ping, pong;
+    std::atomic<int> rounds(0);
+    Thread t([&] {
+        for (int i = 0; i < 10000; ++i) {
+            ping.wait();
+            ++rounds;
+            pong.notify();
+        }
+    });
+    for (int i = 0; i < 10000; ++i) {
+        ping.notify();
+        pong.wait();
+    }
+    t.join();
+    assert(rounds == 10000);
+});
+
+unit("thread", "semaphore-timeout")
+.body([] {
+    Semaphore sem;
+
+    // the timeout is relative to the call
+    auto start = std::chrono::steady_clock::now();
+    assert(! sem.wait(50000000lu));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert(elapsed >= std::chrono::milliseconds(50));
+
+    Thread t([&sem] {
+        usleep(10000);
+        sem.notify();
+    });
+    assert(sem.wait(10000000000lu));
+    t.join();
+});
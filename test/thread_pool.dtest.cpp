@@ -5,14 +5,15 @@
 
 #include <dtest.h>
 #include <thread_pool.h>
+#include <atomic>
 #include <chrono>
+#include <vector>
 
 module("thread-pool")
 .dependsOn({
     "exception",
     "list",
     "deque",
-    "heap",
     "thread"
 });
 
@@ -110,6 +111,72 @@ unit("thread-pool", "ExecutionContext::wait-4")
     assert(count2 == 1);
 });
 
+unit("thread-pool", "ExecutionContext::wait-any-worker")
+.body([] {
+    std::atomic_int state(0);
+    ThreadPool<> pool(2);
+
+    pool.run([&state] (ExecutionContext &ctx) {
+        state = 1;
+        ctx.waitMillis(5);
+        state = 2;
+    });
+    while (state == 0);
+
+    // occupies one of the workers until the waiting task is done, which must
+    // then resume on the other one
+    pool.run([&state] (ExecutionContext &) {
+        auto timeout = std::chrono::high_resolution_clock::now() + std::chrono::seconds(1);
+        while (state != 2 && std::chrono::high_resolution_clock::now() < timeout);
+        if (state == 2) state = 3;
+    });
+
+    pool.terminate(2000);
+    assert(state == 3);
+});
+
+unit("thread-pool", "ExecutionContext::wait-many")
+.body([] {
+    std::atomic_size_t count(0);
+    ThreadPool<> pool(4);
+    for (size_t i = 0; i < MANY_TASKS; ++i) {
+        pool.run([&count, i] (ExecutionContext &ctx) {
+            auto duration = std::chrono::microseconds(i % 5000);
+            auto start = std::chrono::high_resolution_clock::now();
+            ctx.wait(duration);
+            auto end = std::chrono::high_resolution_clock::now();
+            assert(end - start >= duration);
+            ++count;
+        });
+    }
+    pool.terminate(5000);
+    assert(count == MANY_TASKS);
+});
+
+unit("thread-pool", "ExecutionContext::wait-preserves-state")
+.body([] {
+    std::atomic_int failures(0);
+    ThreadPool<> pool(4);
+    for (int t = 0; t < 64; ++t) {
+        pool.run([&failures, t] (ExecutionContext &ctx) {
+            volatile double x = t * 0.5;
+            uint64_t a = t, b = t * 7, c = t * 13;
+            for (int i = 0; i < 20; ++i) {
+                ctx.waitMicros(i % 3);
+                x = x * 1.5;
+                a += 1; b += 7; c += 13;
+            }
+            double expected = t * 0.5;
+            for (int i = 0; i < 20; ++i) expected *= 1.5;
+            if (x != expected || a != (uint64_t) t + 20 || b != (uint64_t) t * 7 + 140 || c != (uint64_t) t * 13 + 260) {
+                ++failures;
+            }
+        });
+    }
+    pool.terminate(5000);
+    assert(failures == 0);
+});
+
 unit("thread-pool", "ExecutionContext::suspend")
 .body([] {
     volatile int count = 0;
@@ -140,6 +207,50 @@ unit("thread-pool", "ExecutionContext::suspend")
     assert(count == 2);
 });
 
+unit("thread-pool", "ExecutionContext::suspend-many")
+.body([] {
+    static constexpr size_t n = 1000;
+    std::atomic_size_t count(0);
+    ThreadPool<> pool(4);
+
+    std::function<void(ExecutionContext &)> *tasks[n];
+    for (size_t i = 0; i < n; ++i) {
+        tasks[i] = new std::function<void(ExecutionContext &)>([&count] (ExecutionContext &ctx) {
+            ctx.suspend();
+            ctx.waitMicros(10);
+            ++count;
+        });
+        pool.run(tasks[i]);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        bool resumed = false;
+        do {
+            try {
+                pool.resume(tasks[i]);
+                resumed = true;
+            }
+            catch (...) {}
+        } while (! resumed);
+    }
+
+    pool.terminate(5000);
+    assert(count == n);
+});
+
+unit("thread-pool", "stack-overflow")
+.expect(Status::FAIL)
+.body([] {
+    ThreadPool<> pool(1);
+    std::function<size_t(size_t)> recurse = [&recurse] (size_t depth) -> size_t {
+        volatile char buf[1024];
+        buf[0] = (char) depth;
+        return buf[0] + recurse(depth + 1);
+    };
+    pool.run([&recurse] (ExecutionContext &) { recurse(0); });
+    pool.terminate();
+});
+
 unit("thread-pool", "ExecutionContext::resched-1")
 .body([] {
     volatile int count = 0;
@@ -220,3 +331,267 @@ unit("thread-pool", "randomized-multi-thread")
     }
     pool.terminate();
 });
+
+unit("thread-pool", "work-stealing-run")
+.body([] {
+    volatile bool ran = false;
+    ThreadPool<> pool(2, ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+    pool.run([&ran] (ExecutionContext &) { ran = true; });
+    pool.terminate();
+    assert(ran);
+});
+
+unit("thread-pool", "work-stealing-spawn")
+.body([] {
+    std::atomic_size_t count(0);
+    ThreadPool<> pool(4, ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+
+    std::function<void(size_t)> spawn = [&] (size_t depth) {
+        pool.run([&, depth] (ExecutionContext &) {
+            ++count;
+            if (depth > 0) {
+                spawn(depth - 1);
+                spawn(depth - 1);
+            }
+        });
+    };
+    spawn(12);
+
+    pool.terminate();
+    assert(count == (1 << 13) - 1);
+});
+
+unit("thread-pool", "work-stealing-randomized-multi-thread")
+.body([] {
+    ThreadPool<> pool(4, ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+    for (auto i = 0; i < 1000; ++i) {
+        pool.run([] (ExecutionContext &ctx) {
+            auto rnd = dtest_random();
+            if (rnd < 0.3) {
+                auto start = std::chrono::high_resolution_clock::now();
+                ctx.waitMillis(1);
+                auto end = std::chrono::high_resolution_clock::now();
+                assert(end - start >= std::chrono::milliseconds(1));
+            }
+            else if (rnd < 0.6) {
+                ctx.setTimeoutMillis(1);
+            }
+            else if (rnd < 0.8) {
+                ctx.resched();
+            }
+            else {
+                return;
+            }
+        });
+    }
+    pool.terminate();
+});
+
+unit("thread-pool", "numa-spawn")
+.body([] {
+    std::atomic_size_t count(0);
+    ThreadPool<> pool(4, ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::NUMA_WORK_STEALING);
+    assert(pool.numaNodes() >= 1 && pool.numaNodes() <= 4);
+
+    std::function<void(size_t)> spawn = [&] (size_t depth) {
+        pool.run([&, depth] (ExecutionContext &) {
+            ++count;
+            if (depth > 0) {
+                spawn(depth - 1);
+                spawn(depth - 1);
+            }
+        });
+    };
+    spawn(12);
+
+    pool.terminate();
+    assert(count == (1 << 13) - 1);
+});
+
+unit("thread-pool", "run-on-node")
+.body([] {
+    std::atomic_size_t count(0);
+    ThreadPool<> pool(4, ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::NUMA_WORK_STEALING);
+    for (size_t i = 0; i < 1000; ++i) {
+        pool.runOnNode([&count] (ExecutionContext &) { ++count; }, i % pool.numaNodes());
+    }
+    pool.terminate();
+    assert(count == 1000);
+
+    // the hint is ignored by pools not scheduling per node
+    ThreadPool<> plain(2);
+    plain.runOnNode([&count] (ExecutionContext &) { ++count; }, 3);
+    plain.terminate();
+    assert(count == 1001);
+});
+
+unit("thread-pool", "priority")
+.body([] {
+    std::atomic_bool started(false), go(false);
+    std::vector<int> order;
+    ThreadPool<> pool(1);
+
+    // hold the only worker until all tasks are queued
+    pool.run([&] (ExecutionContext &) {
+        started = true;
+        while (! go);
+    });
+    while (! started);
+
+    for (int i = 0; i < 4; ++i) {
+        pool.run([&order] (ExecutionContext &) { order.push_back(2); }, TaskPriority::BACKGROUND);
+        pool.run([&order] (ExecutionContext &) { order.push_back(1); });
+        pool.run([&order] (ExecutionContext &) { order.push_back(0); }, TaskPriority::INTERACTIVE);
+    }
+    go = true;
+    pool.terminate();
+
+    assert(order == std::vector<int>({ 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2 }));
+});
+
+unit("thread-pool", "background-starvation")
+.body([] {
+    std::atomic_bool started(false), go(false);
+    std::atomic_size_t count(0);
+    size_t backgroundAt = 0;
+    ThreadPool<> pool(1);
+
+    pool.run([&] (ExecutionContext &) {
+        started = true;
+        while (! go);
+    });
+    while (! started);
+
+    pool.run([&] (ExecutionContext &) { backgroundAt = count++; }, TaskPriority::BACKGROUND);
+    for (int i = 0; i < 1000; ++i) {
+        pool.run([&count] (ExecutionContext &) { ++count; }, i % 2 == 0 ? TaskPriority::INTERACTIVE : TaskPriority::NORMAL);
+    }
+    go = true;
+    pool.terminate();
+
+    assert(count == 1001);
+    assert(backgroundAt < 100);
+});
+
+unit("thread-pool", "run-all")
+.body([] {
+    std::atomic_size_t count(0);
+    std::vector<ThreadPool<>::Task> tasks(MANY_TASKS, [&count] (ExecutionContext &) { ++count; });
+
+    ThreadPool<> pool(4);
+    pool.runAll(tasks);
+    pool.runAll(tasks.begin(), tasks.begin() + 100, TaskPriority::INTERACTIVE);
+    pool.runAll(tasks.begin(), tasks.begin() + 100, TaskPriority::BACKGROUND);
+
+    std::vector<ThreadPool<>::Task *> owned;
+    for (int i = 0; i < 10; ++i) owned.push_back(new ThreadPool<>::Task(tasks.front()));
+    pool.runAll(owned);
+    pool.runAll(owned.end(), owned.end());
+    pool.terminate();
+    assert(count == MANY_TASKS + 210);
+
+    bool thrown = false;
+    try {
+        pool.runAll(tasks);
+    }
+    catch (const TaskRejectedError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // fan-out from within a task goes to the worker's own deque
+    count = 0;
+    ThreadPool<> stealing(4, ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+    stealing.run([&] (ExecutionContext &) {
+        stealing.runAll(tasks);
+    });
+    stealing.terminate();
+    assert(count == MANY_TASKS);
+});
+
+unit("thread-pool", "metrics")
+.body([] {
+    ThreadPool<> pool(1);
+    std::atomic_bool release(false);
+    std::atomic_bool started(false);
+
+    pool.run([&] (ExecutionContext &) {
+        started = true;
+        while (! release);
+    });
+    while (! started);
+    for (int i = 0; i < 10; ++i) pool.run([] (ExecutionContext &) { });
+    pool.run([] (ExecutionContext &) { }, TaskPriority::BACKGROUND);
+
+    ThreadPoolMetrics m = pool.metrics();
+    assert(! m.enabled);
+    assert(m.workers.empty());
+    assert(m.ready == 10);
+    assert(m.background == 1);
+    assert(m.interactive == 0);
+
+    release = true;
+    pool.terminate();
+    assert(pool.metrics().ready == 0);
+});
+
+perf("thread-pool", "run-all")
+.body([] {
+    ThreadPool<> pool(Thread::availableCPUs());
+    std::vector<ThreadPool<>::Task> tasks(MANY_TASKS, [] (ExecutionContext &) { });
+    pool.runAll(tasks);
+    pool.terminate();
+})
+.baseline([] {
+    ThreadPool<> pool(Thread::availableCPUs());
+    std::vector<ThreadPool<>::Task> tasks(MANY_TASKS, [] (ExecutionContext &) { });
+    for (const auto &t : tasks) pool.run(t);
+    pool.terminate();
+});
+
+perf("thread-pool", "work-stealing-many-tasks")
+.body([] {
+    ThreadPool<> pool(Thread::availableCPUs(), ThreadPool<>::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+    pool.run([&pool] (ExecutionContext &) {
+        for (size_t i = 0; i < MANY_TASKS; ++i) {
+            pool.run([] (ExecutionContext &) { });
+        }
+    });
+    pool.terminate();
+})
+.baseline([] {
+    ThreadPool<> pool(Thread::availableCPUs());
+    for (size_t i = 0; i < MANY_TASKS; ++i) {
+        pool.run([] (ExecutionContext &) { });
+    }
+    pool.terminate();
+});
+
+perf("thread-pool", "suspend-resume")
+.body([] {
+    static constexpr size_t n = 100000;
+    std::atomic_size_t count(0);
+    ThreadPool<> pool(1);
+
+    auto f = new std::function<void(ExecutionContext &)>([&count] (ExecutionContext &ctx) {
+        for (size_t i = 0; i < n; ++i) {
+            count = i + 1;
+            ctx.suspend();
+        }
+    });
+    pool.run(f);
+
+    for (size_t i = 0; i < n; ++i) {
+        while (count != i + 1);
+        bool resumed = false;
+        do {
+            try {
+                pool.resume(f);
+                resumed = true;
+            }
+            catch (...) {}
+        } while (! resumed);
+    }
+
+    pool.terminate();
+});
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#define SPL_THREAD_POOL_METRICS
+
+#include <dtest.h>
+#include <thread_pool.h>
+#include <atomic>
+#include <vector>
+
+module("thread-pool-metrics")
+.dependsOn({
+    "thread-pool"
+});
+
+using namespace spl;
+
+// tests of different modules are loaded into the same process, so the
+// instrumented pool must not share its template arguments with the plain
+// ThreadPool<> of other tests
+class MetricsContext : public ExecutionContext { };
+
+using Pool = ThreadPool<MetricsContext>;
+
+unit("thread-pool-metrics", "counters")
+.body([] {
+    Pool pool(2);
+    std::atomic_size_t done(0);
+    for (size_t i = 0; i < 1000; ++i) {
+        pool.run([&done] (ExecutionContext &) { ++done; });
+    }
+    pool.terminate();
+
+    ThreadPoolMetrics m = pool.metrics();
+    assert(m.enabled);
+    assert(m.workers.size() == 2);
+
+    WorkerMetrics total = m.total();
+    assert(total.executed == 1000);
+    assert(total.completed == 1000);
+    assert(total.resumed == 0);
+    assert(total.waitTime.count() == 1000);
+    assert(total.runTime.count() == 1000);
+    assert(total.runTime.percentile(50) <= total.runTime.percentile(99));
+    assert(total.runTime.percentile(99) <= total.runTime.max());
+    assert(m.ready == 0);
+});
+
+unit("thread-pool-metrics", "suspend-resume")
+.body([] {
+    Pool pool(1, Pool::DEFAULT_STACK_SIZE, TaskScheduling::WORK_STEALING);
+    std::atomic_int count(0);
+
+    auto f = new std::function<void(ExecutionContext &)>([&count] (ExecutionContext &ctx) {
+        ++count;
+        ctx.waitMicros(10);
+        ++count;
+        ctx.suspend();
+        ++count;
+    });
+
+    pool.run(f);
+    while (count < 2);
+    while (pool.metrics().suspendedTasks == 0);
+    pool.notify(f);
+    while (count < 3);
+    pool.terminate();
+
+    WorkerMetrics total = pool.metrics().total();
+    assert(total.executed == 3);
+    assert(total.resumed == 2);
+    assert(total.deferred == 1);
+    assert(total.suspended == 1);
+    assert(total.completed == 1);
+    assert(total.busyNanos > 0);
+});
+
+unit("thread-pool-metrics", "trace")
+.body([] {
+    Pool pool(2);
+    pool.setTracing(true);
+
+    std::atomic_size_t done(0);
+    for (size_t i = 0; i < 100; ++i) {
+        pool.run([&done] (ExecutionContext &ctx) {
+            ctx.waitMicros(1);
+            ++done;
+        });
+    }
+    while (done < 100);
+    pool.terminate();
+
+    size_t starts = 0, resumes = 0, defers = 0, ends = 0;
+    uint64_t last[2] = { 0, 0 };
+    bool ordered = true;
+    size_t n = pool.drainTrace([&] (const TraceEvent &e) {
+        if (e.time < last[e.worker]) ordered = false;
+        last[e.worker] = e.time;
+        switch (e.type) {
+        case TraceEvent::Type::START: ++starts; break;
+        case TraceEvent::Type::RESUME: ++resumes; break;
+        case TraceEvent::Type::DEFER: ++defers; break;
+        case TraceEvent::Type::END: ++ends; break;
+        default: break;
+        }
+    });
+
+    assert(n == 400);
+    assert(ordered);
+    assert(starts == 100);
+    assert(resumes == 100);
+    assert(defers == 100);
+    assert(ends == 100);
+    assert(pool.drainTrace([] (const TraceEvent &) { }) == 0);
+});
+
+unit("thread-pool-metrics", "trace-overflow")
+.body([] {
+    Pool pool(1);
+    pool.setTracing(true);
+
+    size_t tasks = core::PoolRecorder::TRACE_CAPACITY;
+    std::atomic_size_t done(0);
+    for (size_t i = 0; i < tasks; ++i) {
+        pool.run([&done] (ExecutionContext &) { ++done; });
+    }
+    while (done < tasks);
+    pool.terminate();
+
+    // two events per task, half of which fit
+    assert(pool.metrics().total().traceDropped == tasks);
+    assert(pool.drainTrace([] (const TraceEvent &) { }) == tasks);
+});
+
+unit("thread-pool-metrics", "histogram")
+.body([] {
+    LatencyHistogram h;
+    assert(h.percentile(50) == 0);
+
+    for (uint64_t i = 1; i <= 1000; ++i) h.record(i);
+    assert(h.count() == 1000);
+    assert(h.sum() == 500500);
+    assert(h.max() == 1000);
+    assert(h.percentile(50) >= 500 && h.percentile(50) < 1024);
+    assert(h.percentile(100) == 1000);
+
+    LatencyHistogram g;
+    g.record(0);
+    g.merge(h);
+    assert(g.count() == 1001);
+    assert(g.bucketCount(0) == 1);
+});
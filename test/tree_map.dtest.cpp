@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <std_serialization.h>
+#include <tree_map.h>
+#include <tree_set.h>
+#include <hash_map.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "test_serializers.cpp"
+
+module("tree-map")
+.dependsOn({
+    "hash-map"
+});
+
+namespace spl
+{
+
+template <typename TreeType>
+struct BTreeTester {
+
+    using Node = typename TreeType::base::Node;
+    using Leaf = typename TreeType::base::Leaf;
+    using Inner = typename TreeType::base::Inner;
+
+    // checks ordering, occupancy and uniform depth, returning the depth
+    static size_t check(const TreeType &t, const Node *node, bool root) {
+        if (node->leaf) {
+            const Leaf *leaf = static_cast<const Leaf *>(node);
+            assert(leaf->n <= TreeType::base::__LEAF_CAPACITY);
+            assert(root || leaf->n >= TreeType::base::__LEAF_CAPACITY / 4);
+            return 1;
+        }
+        const Inner *in = static_cast<const Inner *>(node);
+        assert(in->n <= TreeType::base::__INNER_CAPACITY);
+        assert(in->n >= (root ? 1 : TreeType::base::__INNER_CAPACITY / 4));
+        size_t depth = check(t, in->children[0], false);
+        for (size_t i = 0; i < in->n; ++i) {
+            if (i > 0) {
+                assert(t._lt(*in->key(i - 1), *in->key(i)));
+            }
+            assert(! t._lt(TreeType::base::_minKey(in->children[i + 1]), *in->key(i)));
+            assert(check(t, in->children[i + 1], false) == depth);
+        }
+        return depth + 1;
+    }
+
+    static bool valid(const TreeType &t) {
+        if (t._root == nullptr) return t._head == nullptr && t._tail == nullptr && t._size == 0;
+        check(t, t._root, true);
+
+        size_t n = 0;
+        const Leaf *prev = nullptr;
+        for (const Leaf *leaf = t._head; leaf != nullptr; prev = leaf, leaf = leaf->next) {
+            assert(leaf->prev == prev);
+            assert(leaf->n > 0);
+            for (size_t i = 0; i < leaf->n; ++i) {
+                if (i > 0) {
+                    assert(t._lt(leaf->key(i - 1), leaf->key(i)));
+                }
+            }
+            if (prev != nullptr) {
+                assert(t._lt(prev->key(prev->n - 1), leaf->key(0)));
+            }
+            n += leaf->n;
+        }
+        assert(prev == t._tail);
+        return n == t._size;
+    }
+};
+
+} // namespace spl
+
+using namespace spl;
+
+#define TEST_SIZE (100000)
+#define PERFORMANCE_TEST_SIZE (1000000)
+
+template <typename M>
+static bool validTree(const M &m) {
+    return BTreeTester<M>::valid(m);
+}
+
+unit("tree-map", "put-get")
+.body([] {
+    TreeMap<int, long> m;
+    assert(m.empty());
+    assert(validTree(m));
+
+    std::mt19937 rng(7);
+    std::map<int, long> ref;
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        int k = rng() % (TEST_SIZE * 2);
+        m.put(k, -k);
+        ref[k] = -k;
+    }
+    m.put(ref.begin()->first, 1);
+    ref[ref.begin()->first] = 1;
+
+    assert(validTree(m));
+    assert(m.size() == ref.size());
+    for (const auto &x : ref) {
+        assert(m.get(x.first) == x.second);
+        assert(*m.find(x.first) == x.second);
+    }
+    assert(! m.contains(-1));
+    assert(m.find(-1) == nullptr);
+    assert(m.getOr(-1, 5) == 5);
+
+    bool thrown = false;
+    try {
+        m.get(-1);
+    }
+    catch (const ElementNotFoundError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    m[-1] += 3;
+    assert(m[-1] == 3);
+    assert(m.first().k == -1);
+    assert(m.last().k == ref.rbegin()->first);
+});
+
+unit("tree-map", "order")
+.body([] {
+    TreeMap<int, int> m;
+    for (int i = TEST_SIZE - 1; i >= 0; --i) m.put(i * 2, i);
+
+    int expected = 0;
+    for (const auto &x : m) {
+        assert(x.k == expected);
+        expected += 2;
+    }
+    assert(expected == 2 * TEST_SIZE);
+
+    assert(m.lowerBound(7)->k == 8);
+    assert(m.lowerBound(8)->k == 8);
+    assert(m.upperBound(8)->k == 10);
+    assert(m.lowerBound(2 * TEST_SIZE) == m.end());
+
+    long sum = 0;
+    size_t n = 0;
+    m.foreach(100, 200, [&sum, &n] (const MapNode<int, int> &x) {
+        sum += x.k;
+        ++n;
+    });
+    assert(n == 50);
+    assert(sum == (100 + 198) * 50 / 2);
+
+    // values are mutable through iterators
+    for (auto &x : m) x.v = -x.k;
+    assert(m.get(10) == -10);
+});
+
+unit("tree-map", "erase")
+.body([] {
+    TreeMap<int, int> m;
+    std::map<int, int> ref;
+    std::mt19937 rng(11);
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        m.put(i, i);
+        ref[i] = i;
+    }
+
+    for (int i = 0; i < 4 * TEST_SIZE; ++i) {
+        int k = rng() % TEST_SIZE;
+        if (rng() % 3 == 0) {
+            m.put(k, k);
+            ref[k] = k;
+        }
+        else {
+            assert(m.erase(k) == (ref.erase(k) == 1));
+        }
+    }
+    assert(validTree(m));
+    assert(m.size() == ref.size());
+
+    auto it = ref.begin();
+    for (const auto &x : m) {
+        assert(x.k == it->first);
+        ++it;
+    }
+
+    assert(m.remove(ref.begin()->first) == ref.begin()->first);
+    bool thrown = false;
+    try {
+        m.remove(-1);
+    }
+    catch (const ElementNotFoundError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    for (int i = 0; i < TEST_SIZE; ++i) m.erase(i);
+    assert(m.empty());
+    assert(validTree(m));
+    assert(m.begin() == m.end());
+
+    m.put(1, 1);
+    assert(m.get(1) == 1);
+});
+
+unit("tree-map", "bulk-load")
+.body([] {
+    std::vector<MapNode<int, int>> sorted;
+    for (int i = 0; i < TEST_SIZE; ++i) sorted.emplace_back(i, i);
+
+    TreeMap<int, int> m(sorted);
+    assert(validTree(m));
+    assert(m.size() == TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; ++i) assert(m.get(i) == i);
+
+    // out of order input past some point is inserted one by one
+    sorted.emplace_back(-1, -1);
+    sorted.emplace_back(5, 50);
+    TreeMap<int, int> n(sorted);
+    assert(validTree(n));
+    assert(n.size() == TEST_SIZE + 1);
+    assert(n.get(-1) == -1 && n.get(5) == 50);
+
+    // bulk-loaded trees take further updates
+    for (int i = 0; i < TEST_SIZE; i += 2) m.erase(i);
+    for (int i = TEST_SIZE; i < 2 * TEST_SIZE; ++i) m.put(i, i);
+    assert(validTree(m));
+    assert(m.size() == TEST_SIZE + TEST_SIZE / 2);
+
+    for (int len = 0; len < 100; ++len) {
+        TreeMap<int, int> small(sorted.begin(), sorted.begin() + len);
+        assert(validTree(small));
+        assert(small.size() == (size_t) len);
+    }
+});
+
+unit("tree-map", "containers")
+.body([] {
+    HashMap<int, int> h;
+    for (int i = 0; i < 1000; ++i) h.put(i, -i);
+
+    TreeMap<int, int> m(h);
+    assert(validTree(m));
+    assert(m.size() == 1000);
+
+    TreeMap<int, int> copy(m), moved;
+    moved = std::move(copy);
+    assert(moved.size() == 1000);
+    assert(copy.empty());
+
+    auto doubled = m.map([] (const MapNode<int, int> &x) {
+        return MapNode<int, int>(x.k, 2 * x.v);
+    });
+    assert(doubled.get(10) == -20);
+
+    HashMap<int, int> back = m.to<HashMap<int, int>>();
+    assert(back.size() == 1000 && back.get(7) == -7);
+
+    long sum = 0;
+    std::mutex mtx;
+    m.parallelForeach([&sum, &mtx] (const MapNode<int, int> &x) {
+        std::lock_guard<std::mutex> lock(mtx);
+        sum += x.k;
+    }, 4);
+    assert(sum == 999 * 1000 / 2);
+
+    TreeMap<std::string, int> s = { { "b", 2 }, { "a", 1 }, { "c", 3 } };
+    assert(s.first().k == "a" && s.last().k == "c");
+});
+
+unit("tree-map", "serialization")
+.body([] {
+    TreeMap<int, std::string> m, n;
+    for (int i = 0; i < TEST_SIZE / 10; ++i) m.put(i * 3, std::to_string(i));
+
+    MemoryOutputStreamSerializer out;
+    out << m;
+    out.flush();
+
+    auto in = out.toInput();
+    *in >> n;
+    delete in;
+
+    assert(validTree(n));
+    assert(n.size() == m.size());
+    for (int i = 0; i < TEST_SIZE / 10; ++i) assert(n.get(i * 3) == std::to_string(i));
+});
+
+unit("tree-map", "set")
+.body([] {
+    TreeSet<int> s;
+    for (int i = TEST_SIZE - 1; i >= 0; --i) s.put(i);
+    s.put(5);
+    assert(s.size() == TEST_SIZE);
+    assert(validTree(s));
+
+    int expected = 0;
+    for (int k : s) assert(k == expected++);
+
+    for (int i = 0; i < TEST_SIZE; i += 2) assert(s.erase(i));
+    assert(validTree(s));
+    assert(! s.contains(2) && s.contains(3));
+    assert(*s.lowerBound(2) == 3);
+    assert(s.first() == 1 && s.last() == TEST_SIZE - 1);
+
+    size_t n = 0;
+    s.foreach(0, 100, [&n] (int) { ++n; });
+    assert(n == 50);
+
+    MemoryOutputStreamSerializer out;
+    out << s;
+    out.flush();
+    TreeSet<int> t;
+    auto in = out.toInput();
+    *in >> t;
+    delete in;
+    assert(validTree(t));
+    assert(t.size() == s.size() && t.contains(TEST_SIZE - 1));
+});
+
+perf("tree-map", "put(p)")
+.body([] {
+    std::mt19937 rng(3);
+    TreeMap<int, int> m;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) m.put((int) rng(), i);
+})
+.baseline([] {
+    std::mt19937 rng(3);
+    std::map<int, int> m;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) m[(int) rng()] = i;
+});
+
+perf("tree-map", "get(p)")
+.body([] {
+    TreeMap<int, int> m;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) m.put(i, i);
+    std::mt19937 rng(5);
+    long sum = 0;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) sum += *m.find((int) (rng() % PERFORMANCE_TEST_SIZE));
+    assert(sum > 0);
+})
+.baseline([] {
+    std::map<int, int> m;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) m[i] = i;
+    std::mt19937 rng(5);
+    long sum = 0;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) sum += m.find((int) (rng() % PERFORMANCE_TEST_SIZE))->second;
+    assert(sum > 0);
+});
+
+perf("tree-map", "scan(p)")
+.body([] {
+    TreeMap<int, int> m;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) m.put(i, i);
+    long sum = 0;
+    for (int k = 0; k < 10; ++k) {
+        for (const auto &x : m) sum += x.v;
+    }
+    assert(sum > 0);
+})
+.baseline([] {
+    std::map<int, int> m;
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) m[i] = i;
+    long sum = 0;
+    for (int k = 0; k < 10; ++k) {
+        for (const auto &x : m) sum += x.second;
+    }
+    assert(sum > 0);
+});
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+#include <udp_socket.h>
+#include <arpa/inet.h>
+#include <vector>
+
+module("udp-socket")
+.dependsOn({
+    "socket",
+    "exception",
+    "reactor",
+});
+
+using namespace spl;
+
+#define NUM_DATAGRAMS (200)
+#define SEGMENT_SIZE (100)
+#define NUM_SEGMENTS (10)
+
+static SocketAddress loopback(const UDPSocket &s) {
+    return str_to_addr("127.0.0.1", ntohs(s.address().v4.sin_port));
+}
+
+unit("udp-socket", "send-recv")
+.body([] {
+    UDPSocket a, b;
+    int x = 42, y;
+
+    assert(b.recvFrom(&y, sizeof(y), nullptr, false) == -1);
+
+    a.sendTo(&x, sizeof(x), loopback(b));
+    SocketAddress from;
+    assert(b.recvFrom(&y, sizeof(y), &from) == sizeof(y));
+    assert(y == 42);
+    assert(from.v4.sin_port == a.address().v4.sin_port);
+
+    a.connect(loopback(b));
+    x = 43;
+    a.send(&x, sizeof(x));
+    assert(b.waitReady(Reactor::READ, 1000));
+    assert(b.recvFrom(&y, sizeof(y)) == sizeof(y));
+    assert(y == 43);
+});
+
+unit("udp-socket", "batch")
+.body([] {
+    UDPSocket a, b;
+
+    int out[NUM_DATAGRAMS];
+    std::vector<Datagram> d(NUM_DATAGRAMS);
+    for (int i = 0; i < NUM_DATAGRAMS; ++i) {
+        out[i] = i;
+        d[i].data = &out[i];
+        d[i].len = sizeof(int);
+        d[i].addr = loopback(b);
+    }
+    a.sendBatch(d.data(), d.size());
+
+    int in[NUM_DATAGRAMS];
+    std::vector<bool> seen(NUM_DATAGRAMS, false);
+    size_t received = 0;
+    while (received < NUM_DATAGRAMS) {
+        for (size_t i = 0; i < UDPSocket::BATCH_SIZE; ++i) {
+            d[i].data = &in[i];
+            d[i].len = sizeof(int);
+        }
+        size_t n = b.recvBatch(d.data(), UDPSocket::BATCH_SIZE);
+        assert(n > 0);
+        assert(n <= UDPSocket::BATCH_SIZE);
+        for (size_t i = 0; i < n; ++i) {
+            assert(d[i].len == sizeof(int));
+            assert(d[i].segmentSize == 0);
+            assert(d[i].addr.v4.sin_port == a.address().v4.sin_port);
+            assert(! seen[in[i]]);
+            seen[in[i]] = true;
+        }
+        received += n;
+    }
+
+    assert(b.recvBatch(d.data(), d.size(), false) == 0);
+});
+
+unit("udp-socket", "segmentation-offload")
+.body([] {
+    UDPSocket a, b;
+    a.setSendSegmentSize(SEGMENT_SIZE);
+    b.setReceiveCoalescing();
+
+    uint8_t out[SEGMENT_SIZE * NUM_SEGMENTS];
+    for (size_t i = 0; i < sizeof(out); ++i) out[i] = i / SEGMENT_SIZE;
+    a.sendTo(out, sizeof(out), loopback(b));
+
+    // datagrams may arrive separately or coalesced, but keep their boundaries
+    uint8_t in[sizeof(out)];
+    size_t received = 0;
+    while (received < sizeof(out)) {
+        Datagram d;
+        d.data = in + received;
+        d.len = sizeof(in) - received;
+        assert(b.recvBatch(&d, 1) == 1);
+        assert(d.segmentSize == 0 || d.segmentSize == SEGMENT_SIZE);
+        assert(d.segmentSize != 0 || d.len == SEGMENT_SIZE);
+        received += d.len;
+    }
+
+    for (size_t i = 0; i < sizeof(in); ++i) assert(in[i] == i / SEGMENT_SIZE);
+});
+
+unit("udp-socket", "bind-in-use")
+.expect(Status::FAIL)
+.body([] {
+    UDPSocket a;
+    UDPSocket b(ntohs(a.address().v4.sin_port));
+});
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2021-2023 Noah Orensa.
+ * Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <dtest.h>
+
+#include <unrolled_list.h>
+#include <list.h>
+
+module("unrolled-list")
+.dependsOn({
+    "exception"
+});
+
+namespace spl
+{
+
+template <typename ListType>
+struct UnrolledListTester {
+
+    static size_t chunks(ListType &l) {
+        size_t n = 0;
+        for (auto c = l._head; c != nullptr; c = c->next) ++n;
+        return n;
+    }
+
+    static bool validTail(ListType &l) {
+        return l._tail == nullptr ? l._head == nullptr : l._tail->next == nullptr;
+    }
+};
+
+} // namespace spl
+
+using namespace spl;
+
+#define TEST_SIZE (1024)
+#define PERFORMANCE_TEST_SIZE (400 * 1024)
+#define PERFORMANCE_MARGIN (0.99)
+
+using SmallChunkList = UnrolledList<int, 8>;
+using SmallChunkTester = UnrolledListTester<SmallChunkList>;
+
+unit("unrolled-list", "initializer-list")
+.body([] {
+    auto l = UnrolledList<int>({ 1, 2, 3 });
+
+    assert(! l.empty());
+    assert(l.nonEmpty());
+    assert(l.size() == 3);
+    assert(l.begin() != l.end());
+
+    auto it = l.begin();
+    assert(*it++ == 1);
+    assert(*it++ == 2);
+    assert(*it++ == 3);
+    assert(it == l.end());
+});
+
+unit("unrolled-list", "append")
+.body([] {
+    auto l = SmallChunkList();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l << i;
+    }
+
+    assert(l.size() == TEST_SIZE);
+    assert(SmallChunkTester::chunks(l) == TEST_SIZE / 8);
+    assert(SmallChunkTester::validTail(l));
+    assert(l.front() == 0);
+    assert(l.back() == TEST_SIZE - 1);
+
+    int i = 0;
+    for (auto &x : l) {
+        assert(x == i++);
+    }
+    assert(i == TEST_SIZE);
+});
+
+unit("unrolled-list", "prepend")
+.body([] {
+    auto l = SmallChunkList();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        i >> l;
+    }
+
+    assert(l.size() == TEST_SIZE);
+    assert(SmallChunkTester::chunks(l) == TEST_SIZE / 8);
+    assert(SmallChunkTester::validTail(l));
+
+    int i = TEST_SIZE - 1;
+    for (auto &x : l) {
+        assert(x == i--);
+    }
+    assert(i == -1);
+});
+
+unit("unrolled-list", "prepend-append")
+.body([] {
+    auto l = SmallChunkList();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        if (i % 2 == 0) l << i;
+        else i >> l;
+    }
+
+    assert(l.size() == TEST_SIZE);
+    assert(SmallChunkTester::validTail(l));
+
+    int expected = TEST_SIZE - 1;
+    for (auto &x : l) {
+        assert(x == expected);
+        if (expected == 1) expected = 0;
+        else if (expected % 2 == 1) expected -= 2;
+        else expected += 2;
+    }
+});
+
+unit("unrolled-list", "copy")
+.body([] {
+    auto l = UnrolledList<int>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l.insert(dtest_random() * TEST_SIZE);
+    }
+
+    auto l2 = l;
+    assert(l2.size() == l.size());
+    for (auto it1 = l.begin(), it2 = l2.begin(); it1 != l.end(); ++it1, ++it2) {
+        assert(*it1 == *it2);
+    }
+});
+
+unit("unrolled-list", "move")
+.body([] {
+    auto l = UnrolledList<int>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l << i;
+    }
+
+    auto l2 = std::move(l);
+
+    assert(l.empty());
+    assert(l.begin() == l.end());
+    assert(UnrolledListTester<UnrolledList<int>>::chunks(l) == 0);
+
+    assert(l2.size() == TEST_SIZE);
+    int i = 0;
+    for (auto &x : l2) {
+        assert(x == i++);
+    }
+    assert(i == TEST_SIZE);
+});
+
+unit("unrolled-list", "clear")
+.body([] {
+    auto l = UnrolledList<std::string>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l << std::to_string(i);
+    }
+
+    l.clear();
+    assert(l.empty());
+    assert(l.begin() == l.end());
+    assert(UnrolledListTester<UnrolledList<std::string>>::chunks(l) == 0);
+
+    l << "a";
+    assert(l.size() == 1);
+    assert(l.front() == "a");
+});
+
+unit("unrolled-list", "erase")
+.body([] {
+    auto l = SmallChunkList();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l << i;
+    }
+
+    for (auto it = l.begin(); it != l.end(); ) {
+        if (*it % 2 == 0) ++it;
+        else l.erase(it);
+    }
+
+    assert(l.size() == TEST_SIZE / 2);
+    assert(SmallChunkTester::validTail(l));
+
+    int i = 0;
+    for (auto &x : l) {
+        assert(x == i);
+        i += 2;
+    }
+    assert(i == TEST_SIZE);
+
+    for (auto it = l.begin(); it != l.end(); ) {
+        l.erase(it);
+    }
+
+    assert(l.empty());
+    assert(SmallChunkTester::chunks(l) == 0);
+    assert(SmallChunkTester::validTail(l));
+
+    l << 1;
+    assert(l.size() == 1);
+    assert(l.back() == 1);
+});
+
+unit("unrolled-list", "remove")
+.body([] {
+    auto l = UnrolledList<int, 4>({ 1, 2, 3, 4, 5 });
+
+    auto it = l.begin();
+    ++it;
+    assert(l.remove(it) == 2);
+    assert(*it == 3);
+    assert(l.takeFront() == 1);
+    assert(l.front() == 3);
+    assert(l.size() == 3);
+
+    int sum = 0;
+    for (auto &x : l) sum += x;
+    assert(sum == 12);
+});
+
+unit("unrolled-list", "remove-empty")
+.expect(Status::FAIL)
+.body([] {
+    auto l = UnrolledList<int>();
+    l.takeFront();
+});
+
+unit("unrolled-list", "map-reduce")
+.body([] {
+    auto l = UnrolledList<int>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        l << i;
+    }
+
+    auto l2 = l.map([] (int x) { return x * 2; });
+    assert(l2.size() == TEST_SIZE);
+
+    int i = 0;
+    for (auto &x : l2) {
+        assert(x == 2 * i++);
+    }
+
+    auto sum = l.reduce<int>([] (int x, int y) { return x + y; });
+    assert(sum == TEST_SIZE * (TEST_SIZE - 1) / 2);
+
+    auto l3 = l.to<List<int>>();
+    assert(l3.size() == TEST_SIZE);
+});
+
+unit("unrolled-list", "foreach")
+.body([] {
+    auto l = UnrolledList<int, 16>();
+
+    for (int i = 0; i < TEST_SIZE; ++i) {
+        i >> l;
+    }
+
+    l.foreach([] (int &x) { x *= 3; });
+
+    long sum = 0;
+    const auto &cl = l;
+    cl.foreach([&sum] (const int &x) { sum += x; });
+    assert(sum == 3l * TEST_SIZE * (TEST_SIZE - 1) / 2);
+});
+
+perf("unrolled-list", "append(p)")
+.performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
+.body([] {
+    auto l = UnrolledList<int>();
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        l << i;
+    }
+})
+.baseline([] {
+    auto l = List<int>();
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        l << i;
+    }
+});
+
+perf("unrolled-list", "foreach(p)")
+.performanceMarginAsBaselineRatio(PERFORMANCE_MARGIN)
+.body([] {
+    auto l = UnrolledList<int>();
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        l << i;
+    }
+    long sum = 0;
+    for (int k = 0; k < 10; ++k) {
+        l.foreach([&sum] (int x) { sum += x; });
+    }
+    assert(sum != 0);
+})
+.baseline([] {
+    auto l = List<int>();
+    for (int i = 0; i < PERFORMANCE_TEST_SIZE; ++i) {
+        l << i;
+    }
+    long sum = 0;
+    for (int k = 0; k < 10; ++k) {
+        l.foreach([&sum] (int x) { sum += x; });
+    }
+    assert(sum != 0);
+});